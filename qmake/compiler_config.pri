@@ -17,6 +17,9 @@ else {
     DEFINES += QT_NO_DEBUG_OUTPUT
 }
 
+# Profile zones (cpptools/profiling.h) are compiled in with CONFIG += profiling
+CONFIG(profiling): DEFINES *= CPPTOOLS_ENABLE_PROFILING
+
 CONFIG(warn_on) {
     *-g++*:QMAKE_CXXFLAGS *= -Wextra
 }
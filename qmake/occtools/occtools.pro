@@ -9,6 +9,8 @@ CONFIG(dll):DEFINES += OCCTOOLS_DLL OCCTOOLS_MAKE_DLL
 
 include(../../src/occtools/occtools.pri)
 
+qttools_task:LIBS += -L$$QTTOOLS_LIB_PATH -lqttools_task$$TARGET_SUFFIX
+
 QMAKE_RPATHDIR += $$CASCADE_LIB_PATH
 
 occtools_occpri.path  = $$PREFIX_DIR/qmake
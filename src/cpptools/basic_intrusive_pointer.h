@@ -0,0 +1,226 @@
+/****************************************************************************
+**  FougTools
+**  Copyright Fougue (1 Mar. 2011)
+**  contact@fougue.pro
+**
+** This software is a computer program whose purpose is to provide utility
+** tools for the C++ language and the Qt toolkit.
+**
+** This software is governed by the CeCILL-C license under French law and
+** abiding by the rules of distribution of free software.  You can  use,
+** modify and/ or redistribute the software under the terms of the CeCILL-C
+** license as circulated by CEA, CNRS and INRIA at the following URL
+** "http://www.cecill.info".
+****************************************************************************/
+
+#pragma once
+
+#include "basic_shared_pointer.h"
+
+namespace cpp {
+
+/*! \brief Base class providing the reference count used by
+ *         BasicIntrusivePointer
+ *
+ *  Copying a BasicRefCounted object does not copy its reference count: the
+ *  new object is not referenced yet
+ *
+ *  \headerfile basic_intrusive_pointer.h <cpptools/basic_intrusive_pointer.h>
+ *  \ingroup cpptools
+ */
+template<typename REFCOUNT_POLICY = BasicRefCountPolicy>
+class BasicRefCounted
+{
+public:
+    void basicRefCountIncrement() const
+    { REFCOUNT_POLICY::increment(m_refCount); }
+
+    //! Returns true if there is no more reference to this object
+    bool basicRefCountDecrement() const
+    { return REFCOUNT_POLICY::decrement(m_refCount); }
+
+protected:
+    BasicRefCounted()
+        : m_refCount(0)
+    { }
+
+    BasicRefCounted(const BasicRefCounted&)
+        : m_refCount(0)
+    { }
+
+    BasicRefCounted& operator=(const BasicRefCounted&)
+    { return *this; }
+
+private:
+    mutable typename REFCOUNT_POLICY::Counter m_refCount;
+};
+
+/*! \brief Reference counting operations of BasicIntrusivePointer on type T
+ *
+ *  By default T has to inherit from BasicRefCounted, specialize this template
+ *  to use a reference count already provided by T
+ *
+ *  \headerfile basic_intrusive_pointer.h <cpptools/basic_intrusive_pointer.h>
+ *  \ingroup cpptools
+ */
+template<typename T>
+struct BasicIntrusiveTraits
+{
+    static void increment(const T* object)
+    { object->basicRefCountIncrement(); }
+
+    //! Returns true if \p object has to be deleted
+    static bool decrement(const T* object)
+    { return object->basicRefCountDecrement(); }
+};
+
+template<typename T, typename TRAITS = BasicIntrusiveTraits<T>>
+class BasicIntrusivePointer
+{
+public:
+    BasicIntrusivePointer(T* data = NULL);
+    BasicIntrusivePointer(const BasicIntrusivePointer& other);
+    BasicIntrusivePointer(BasicIntrusivePointer&& other);
+    ~BasicIntrusivePointer();
+
+    T& operator*() const;
+    T* operator->() const;
+    T* data() const;
+
+    bool isNull() const;
+
+    BasicIntrusivePointer& operator=(const BasicIntrusivePointer& other);
+    BasicIntrusivePointer& operator=(BasicIntrusivePointer&& other);
+
+private:
+    void addRef();
+    void releaseRef();
+
+    T* m_data;
+};
+
+//
+// Implementation
+//
+
+/*!
+ * \class BasicIntrusivePointer
+ * \brief Shared pointer whose reference count is stored in the pointee
+ *
+ * BasicIntrusivePointer has the same interface as BasicSharedPointer, but it
+ * is one pointer wide and needs no allocation other than the pointee itself.
+ *
+ * The reference count is accessed through TRAITS (see BasicIntrusiveTraits), by
+ * default T has to inherit from BasicRefCounted. Thread-safety depends on the
+ * reference counting policy of BasicRefCounted.
+ *
+ * A BasicIntrusivePointer can be created at any time from a raw pointer to an
+ * object already referenced by other BasicIntrusivePointer objects.
+ *
+ * \headerfile basic_intrusive_pointer.h <cpptools/basic_intrusive_pointer.h>
+ * \ingroup cpptools
+ */
+
+template<typename T, typename TRAITS>
+BasicIntrusivePointer<T, TRAITS>::BasicIntrusivePointer(T* data)
+    : m_data(data)
+{
+    this->addRef();
+}
+
+template<typename T, typename TRAITS>
+BasicIntrusivePointer<T, TRAITS>::BasicIntrusivePointer(
+        const BasicIntrusivePointer& other)
+    : m_data(other.m_data)
+{
+    this->addRef();
+}
+
+/*! Takes over the reference of \p other (no reference count change), \p other
+ *  becomes null
+ */
+template<typename T, typename TRAITS>
+BasicIntrusivePointer<T, TRAITS>::BasicIntrusivePointer(
+        BasicIntrusivePointer&& other)
+    : m_data(other.m_data)
+{
+    other.m_data = NULL;
+}
+
+template<typename T, typename TRAITS>
+BasicIntrusivePointer<T, TRAITS>::~BasicIntrusivePointer()
+{
+    this->releaseRef();
+}
+
+template<typename T, typename TRAITS>
+T& BasicIntrusivePointer<T, TRAITS>::operator*() const
+{
+    return *m_data;
+}
+
+template<typename T, typename TRAITS>
+T* BasicIntrusivePointer<T, TRAITS>::operator->() const
+{
+    return m_data;
+}
+
+template<typename T, typename TRAITS>
+T* BasicIntrusivePointer<T, TRAITS>::data() const
+{
+    return m_data;
+}
+
+template<typename T, typename TRAITS>
+bool BasicIntrusivePointer<T, TRAITS>::isNull() const
+{
+    return m_data == NULL;
+}
+
+/*! Releases the current reference and shares the pointer of \p other
+ */
+template<typename T, typename TRAITS>
+BasicIntrusivePointer<T, TRAITS>&
+BasicIntrusivePointer<T, TRAITS>::operator=(const BasicIntrusivePointer& other)
+{
+    if (this != &other) {
+        // Add the new reference first, in case both share the same pointer
+        if (other.m_data != NULL)
+            TRAITS::increment(other.m_data);
+        this->releaseRef();
+        m_data = other.m_data;
+    }
+    return *this;
+}
+
+/*! Releases the current reference and takes over the reference of \p other
+ *  (no reference count change), \p other becomes null
+ */
+template<typename T, typename TRAITS>
+BasicIntrusivePointer<T, TRAITS>&
+BasicIntrusivePointer<T, TRAITS>::operator=(BasicIntrusivePointer&& other)
+{
+    if (this != &other) {
+        this->releaseRef();
+        m_data = other.m_data;
+        other.m_data = NULL;
+    }
+    return *this;
+}
+
+template<typename T, typename TRAITS>
+void BasicIntrusivePointer<T, TRAITS>::addRef()
+{
+    if (m_data != NULL)
+        TRAITS::increment(m_data);
+}
+
+template<typename T, typename TRAITS>
+void BasicIntrusivePointer<T, TRAITS>::releaseRef()
+{
+    if (m_data != NULL && TRAITS::decrement(m_data))
+        delete m_data;
+    m_data = NULL;
+}
+
+} // namespace cpp
@@ -15,16 +15,100 @@
 
 #pragma once
 
+#include <atomic>
 #include <cstddef>
+#include <utility>
 
 namespace cpp {
 
-template <typename T>
+/*! \brief Reference counting policy of BasicSharedPointer with a plain integer
+ *
+ *  This is the default policy, BasicSharedPointer objects sharing the same
+ *  pointer must not be copied or destroyed concurrently
+ *
+ *  \headerfile basic_shared_pointer.h <cpptools/basic_shared_pointer.h>
+ *  \ingroup cpptools
+ */
+struct BasicRefCountPolicy
+{
+    typedef unsigned Counter;
+
+    static void increment(Counter& counter)
+    { ++counter; }
+
+    //! Returns true if \p counter reached zero
+    static bool decrement(Counter& counter)
+    { return --counter == 0; }
+};
+
+/*! \brief Thread-safe reference counting policy of BasicSharedPointer
+ *
+ *  BasicSharedPointer objects sharing the same pointer can be copied and
+ *  destroyed concurrently by several threads (as for std::shared_ptr, a single
+ *  BasicSharedPointer object must not be modified concurrently).
+ *
+ *  Increments are relaxed, decrements are acquire-release so the deletion of
+ *  the shared object happens after the last access from any thread
+ *
+ *  \headerfile basic_shared_pointer.h <cpptools/basic_shared_pointer.h>
+ *  \ingroup cpptools
+ */
+struct AtomicRefCountPolicy
+{
+    typedef std::atomic<unsigned> Counter;
+
+    static void increment(Counter& counter)
+    { counter.fetch_add(1, std::memory_order_relaxed); }
+
+    static bool decrement(Counter& counter)
+    { return counter.fetch_sub(1, std::memory_order_acq_rel) == 1; }
+};
+
+namespace internal {
+
+//! Reference count of BasicSharedPointer objects sharing the same pointer
+template<typename REFCOUNT_POLICY>
+struct BasicSharedRefCount
+{
+    BasicSharedRefCount()
+        : count(1), isCoAllocated(false)
+    { }
+
+    typename REFCOUNT_POLICY::Counter count;
+    bool isCoAllocated; // True if this is a BasicSharedBlock<>
+};
+
+//! Reference count and object in a single heap block (see makeBasicShared())
+template<typename T, typename REFCOUNT_POLICY>
+struct BasicSharedBlock : public BasicSharedRefCount<REFCOUNT_POLICY>
+{
+    template<typename... ARGS>
+    BasicSharedBlock(ARGS&&... args)
+        : object(std::forward<ARGS>(args)...)
+    {
+        this->isCoAllocated = true;
+    }
+
+    T object;
+};
+
+struct BasicSharedBlockTag { };
+
+} // namespace internal
+
+template<typename T, typename REFCOUNT_POLICY = BasicRefCountPolicy>
+class BasicSharedPointer;
+
+template<typename T, typename REFCOUNT_POLICY = BasicRefCountPolicy, typename... ARGS>
+BasicSharedPointer<T, REFCOUNT_POLICY> makeBasicShared(ARGS&&... args);
+
+template<typename T, typename REFCOUNT_POLICY>
 class BasicSharedPointer
 {
 public:
     BasicSharedPointer(T* data = NULL);
-    BasicSharedPointer(const BasicSharedPointer<T>& other);
+    BasicSharedPointer(const BasicSharedPointer& other);
+    BasicSharedPointer(BasicSharedPointer&& other);
     ~BasicSharedPointer();
 
     T& operator*() const;
@@ -33,14 +117,23 @@ public:
 
     bool isNull() const;
 
-    BasicSharedPointer<T>& operator=(const BasicSharedPointer<T>& other);
+    BasicSharedPointer& operator=(const BasicSharedPointer& other);
+    BasicSharedPointer& operator=(BasicSharedPointer&& other);
 
 private:
+    typedef internal::BasicSharedRefCount<REFCOUNT_POLICY> RefCount;
+    typedef internal::BasicSharedBlock<T, REFCOUNT_POLICY> Block;
+
+    template<typename U, typename POLICY, typename... ARGS>
+    friend BasicSharedPointer<U, POLICY> makeBasicShared(ARGS&&... args);
+
+    BasicSharedPointer(Block* block, internal::BasicSharedBlockTag);
+
     void addRef();
     void releaseRef();
 
     T* m_data;
-    unsigned* m_refCount;
+    RefCount* m_refCount;
 };
 
 //
@@ -57,85 +150,158 @@ private:
  * BasicSharedPointer will delete the pointer it is holding when it goes out of
  * scope, provided no other BasicSharedPointer objects are referencing it.
  *
- * "Basic" means that there is no thread-safety or any sophisticated management.
- * It aims to stay light for simple uses.
+ * "Basic" means that there is no sophisticated management (weak references,
+ * custom deleters, ...). It aims to stay light for simple uses.
+ *
+ * By default there is no thread-safety, reference counting can be made atomic
+ * with the AtomicRefCountPolicy template parameter.
+ *
+ * A null BasicSharedPointer allocates nothing. Prefer makeBasicShared() to
+ * create the pointee, it needs one heap allocation instead of two.
  *
  * \headerfile basic_shared_pointer.h <cpptools/basic_shared_pointer.h>
  * \ingroup cpptools
  */
 
-template<typename T>
-BasicSharedPointer<T>::BasicSharedPointer(T* data)
+template<typename T, typename REFCOUNT_POLICY>
+BasicSharedPointer<T, REFCOUNT_POLICY>::BasicSharedPointer(T* data)
     : m_data(data),
-      m_refCount(new unsigned(1))
+      m_refCount(data != NULL ? new RefCount : NULL)
 {
 }
 
-template<typename T>
-BasicSharedPointer<T>::BasicSharedPointer(const BasicSharedPointer<T>& other)
+template<typename T, typename REFCOUNT_POLICY>
+BasicSharedPointer<T, REFCOUNT_POLICY>::BasicSharedPointer(const BasicSharedPointer& other)
     : m_data(other.m_data),
       m_refCount(other.m_refCount)
 {
     this->addRef();
 }
 
-template<typename T>
-BasicSharedPointer<T>::~BasicSharedPointer()
+/*! Takes over the reference of \p other (no reference count change), \p other
+ *  becomes null
+ */
+template<typename T, typename REFCOUNT_POLICY>
+BasicSharedPointer<T, REFCOUNT_POLICY>::BasicSharedPointer(BasicSharedPointer&& other)
+    : m_data(other.m_data),
+      m_refCount(other.m_refCount)
+{
+    other.m_data = NULL;
+    other.m_refCount = NULL;
+}
+
+template<typename T, typename REFCOUNT_POLICY>
+BasicSharedPointer<T, REFCOUNT_POLICY>::BasicSharedPointer(
+        Block* block, internal::BasicSharedBlockTag)
+    : m_data(&block->object),
+      m_refCount(block)
+{
+}
+
+template<typename T, typename REFCOUNT_POLICY>
+BasicSharedPointer<T, REFCOUNT_POLICY>::~BasicSharedPointer()
 {
     this->releaseRef();
 }
 
-template<typename T>
-T& BasicSharedPointer<T>::operator*() const
+template<typename T, typename REFCOUNT_POLICY>
+T& BasicSharedPointer<T, REFCOUNT_POLICY>::operator*() const
 {
     return *m_data;
 }
 
-template<typename T>
-T* BasicSharedPointer<T>::operator->() const
+template<typename T, typename REFCOUNT_POLICY>
+T* BasicSharedPointer<T, REFCOUNT_POLICY>::operator->() const
 {
     return m_data;
 }
 
-template<typename T>
-T* BasicSharedPointer<T>::data() const
+template<typename T, typename REFCOUNT_POLICY>
+T* BasicSharedPointer<T, REFCOUNT_POLICY>::data() const
 {
     return m_data;
 }
 
-template<typename T>
-bool BasicSharedPointer<T>::isNull() const
+template<typename T, typename REFCOUNT_POLICY>
+bool BasicSharedPointer<T, REFCOUNT_POLICY>::isNull() const
 {
     return m_data == NULL;
 }
 
-template<typename T>
-BasicSharedPointer<T>& BasicSharedPointer<T>::operator=(const BasicSharedPointer<T>& other)
+/*! Releases the current reference and shares the pointer of \p other
+ */
+template<typename T, typename REFCOUNT_POLICY>
+BasicSharedPointer<T, REFCOUNT_POLICY>&
+BasicSharedPointer<T, REFCOUNT_POLICY>::operator=(const BasicSharedPointer& other)
+{
+    if (this != &other) {
+        // Add the new reference first, in case both share the same pointer
+        if (other.m_refCount != NULL)
+            REFCOUNT_POLICY::increment(other.m_refCount->count);
+        this->releaseRef();
+        m_data = other.m_data;
+        m_refCount = other.m_refCount;
+    }
+    return *this;
+}
+
+/*! Releases the current reference and takes over the reference of \p other
+ *  (no reference count change), \p other becomes null
+ */
+template<typename T, typename REFCOUNT_POLICY>
+BasicSharedPointer<T, REFCOUNT_POLICY>&
+BasicSharedPointer<T, REFCOUNT_POLICY>::operator=(BasicSharedPointer&& other)
 {
     if (this != &other) {
+        this->releaseRef();
         m_data = other.m_data;
         m_refCount = other.m_refCount;
-        this->addRef();
+        other.m_data = NULL;
+        other.m_refCount = NULL;
     }
     return *this;
 }
 
-template<typename T>
-void BasicSharedPointer<T>::addRef()
+template<typename T, typename REFCOUNT_POLICY>
+void BasicSharedPointer<T, REFCOUNT_POLICY>::addRef()
 {
-    ++(*m_refCount);
+    if (m_refCount != NULL)
+        REFCOUNT_POLICY::increment(m_refCount->count);
 }
 
-template<typename T>
-void BasicSharedPointer<T>::releaseRef()
+template<typename T, typename REFCOUNT_POLICY>
+void BasicSharedPointer<T, REFCOUNT_POLICY>::releaseRef()
 {
-    --(*m_refCount);
-    if (*m_refCount == 0) {
-        delete m_data;
-        delete m_refCount;
-        m_data = NULL;
-        m_refCount = NULL;
+    if (m_refCount == NULL)
+        return;
+    if (REFCOUNT_POLICY::decrement(m_refCount->count)) {
+        if (m_refCount->isCoAllocated) {
+            delete static_cast<Block*>(m_refCount);
+        }
+        else {
+            delete m_data;
+            delete m_refCount;
+        }
     }
+    m_data = NULL;
+    m_refCount = NULL;
+}
+
+/*! \brief Creates an object of type T constructed with \p args, shared by the
+ *         returned BasicSharedPointer
+ *
+ *  The object and its reference count are allocated in one single heap block
+ *  (one allocation instead of two, and better memory locality)
+ *
+ *  \relates BasicSharedPointer
+ */
+template<typename T, typename REFCOUNT_POLICY, typename... ARGS>
+BasicSharedPointer<T, REFCOUNT_POLICY> makeBasicShared(ARGS&&... args)
+{
+    return BasicSharedPointer<T, REFCOUNT_POLICY>(
+                new internal::BasicSharedBlock<T, REFCOUNT_POLICY>(
+                    std::forward<ARGS>(args)...),
+                internal::BasicSharedBlockTag());
 }
 
 } // namespace cpp
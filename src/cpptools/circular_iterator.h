@@ -15,8 +15,34 @@
 
 #pragma once
 
+#include <iterator>
+#include <type_traits>
+
 namespace cpp {
 
+namespace internal {
+
+// Arithmetic types (ex: indexes) are handled as random access iterators
+template<typename ITERATOR, bool IS_ARITHMETIC = std::is_arithmetic<ITERATOR>::value>
+struct CircularIteratorCategory
+{ typedef typename std::iterator_traits<ITERATOR>::iterator_category type; };
+
+template<typename ITERATOR>
+struct CircularIteratorCategory<ITERATOR, true>
+{ typedef std::random_access_iterator_tag type; };
+
+template<typename BI_ITERATOR, typename DISTANCE>
+BI_ITERATOR circularAdvance(
+        BI_ITERATOR iBegin, BI_ITERATOR iEnd, BI_ITERATOR iCurr, DISTANCE d,
+        std::bidirectional_iterator_tag);
+
+template<typename RA_ITERATOR, typename DISTANCE>
+RA_ITERATOR circularAdvance(
+        RA_ITERATOR iBegin, RA_ITERATOR iEnd, RA_ITERATOR iCurr, DISTANCE d,
+        std::random_access_iterator_tag);
+
+} // namespace internal
+
 /*! \brief Iterator next to \p iCurr bounded between \p iBegin and \p iEnd
  *
  *  \retval ++iCurr when \p iCurr \c != \p iEnd
@@ -49,13 +75,26 @@ BI_ITERATOR circularPrior(BI_ITERATOR iBegin, BI_ITERATOR iEnd, BI_ITERATOR iCur
 
 /*! \brief Iterator advanced by \p d bounded between \p iBegin and \p iEnd
  *
- *  \todo Improve performance (direct calculation instead of a \c for loop)
+ *  Random access iterators (and arithmetic types) are advanced in constant
+ *  time with modular arithmetic, other iterators by |d| calls to
+ *  circularNext()/circularPrior()
  *
  *  \ingroup cpptools
  */
 template<typename BI_ITERATOR, typename DISTANCE>
 BI_ITERATOR circularAdvance(BI_ITERATOR iBegin, BI_ITERATOR iEnd,
                             BI_ITERATOR iCurr, DISTANCE d)
+{
+    typedef typename internal::CircularIteratorCategory<BI_ITERATOR>::type Category_t;
+    return internal::circularAdvance(iBegin, iEnd, iCurr, d, Category_t());
+}
+
+namespace internal {
+
+template<typename BI_ITERATOR, typename DISTANCE>
+BI_ITERATOR circularAdvance(
+        BI_ITERATOR iBegin, BI_ITERATOR iEnd, BI_ITERATOR iCurr, DISTANCE d,
+        std::bidirectional_iterator_tag)
 {
     const DISTANCE absD = d < 0 ? -d : d;
     for (DISTANCE i = 0; i < absD; ++i) {
@@ -65,4 +104,27 @@ BI_ITERATOR circularAdvance(BI_ITERATOR iBegin, BI_ITERATOR iEnd,
     return iCurr;
 }
 
+template<typename RA_ITERATOR, typename DISTANCE>
+RA_ITERATOR circularAdvance(
+        RA_ITERATOR iBegin, RA_ITERATOR iEnd, RA_ITERATOR iCurr, DISTANCE d,
+        std::random_access_iterator_tag)
+{
+    // Offsets are computed in a signed type : iEnd - iBegin is unsigned for
+    // unsigned indexes, where a negative d would wrap around
+    typedef decltype(iEnd - iBegin) Diff_t;
+    const long long size = static_cast<long long>(iEnd - iBegin);
+    if (size <= 0)
+        return iCurr;
+    // pos is in ]-size, 2*size[
+    long long pos = static_cast<long long>(iCurr - iBegin)
+            + static_cast<long long>(d) % size;
+    if (pos >= size)
+        pos -= size;
+    else if (pos < 0)
+        pos += size;
+    return iBegin + static_cast<Diff_t>(pos);
+}
+
+} // namespace internal
+
 } // namespace cpp
@@ -0,0 +1,50 @@
+/****************************************************************************
+**  FougTools
+**  Copyright Fougue (30 Mar. 2015)
+**  contact@fougue.pro
+**
+** This software is a computer program whose purpose is to provide utility
+** tools for the C++ language and the Qt toolkit.
+**
+** This software is governed by the CeCILL-C license under French law and
+** abiding by the rules of distribution of free software.  You can  use,
+** modify and/ or redistribute the software under the terms of the CeCILL-C
+** license as circulated by CEA, CNRS and INRIA at the following URL
+** "http://www.cecill.info".
+****************************************************************************/
+
+
+#pragma once
+
+// MSVC supports C++11 constexpr and user-defined literals from Visual Studio
+// 2015 (_MSC_VER 1900)
+#if defined(_MSC_VER) && _MSC_VER < 1900
+#  define CPPTOOLS_CONSTEXPR
+#else
+#  define CPPTOOLS_HAVE_CONSTEXPR
+#  define CPPTOOLS_CONSTEXPR constexpr
+#endif
+
+// alignas is supported by MSVC from Visual Studio 2015 too, before that the
+// natural alignment is used
+#if defined(_MSC_VER) && _MSC_VER < 1900
+#  define CPPTOOLS_ALIGNAS(alignment)
+#else
+#  define CPPTOOLS_HAVE_ALIGNAS
+#  define CPPTOOLS_ALIGNAS(alignment) alignas(alignment)
+#endif
+
+// noexcept is also missing before Visual Studio 2015
+#if defined(_MSC_VER) && _MSC_VER < 1900
+#  define CPPTOOLS_NOEXCEPT throw()
+#else
+#  define CPPTOOLS_NOEXCEPT noexcept
+#endif
+
+// thread_local arrives with Visual Studio 2015 as well, __declspec(thread) is
+// the equivalent for POD variables
+#if defined(_MSC_VER) && _MSC_VER < 1900
+#  define CPPTOOLS_THREAD_LOCAL __declspec(thread)
+#else
+#  define CPPTOOLS_THREAD_LOCAL thread_local
+#endif
@@ -17,6 +17,8 @@
 
 #include "hash_fnv.h"
 
+#include <cstdint>
+#include <type_traits>
 #include <unordered_map>
 #include <vector>
 
@@ -39,6 +41,10 @@ namespace cpp {
  *      assert(std::strcmp(statusStrMap.string(Status::Running), "status_running") == 0);
  *  \endcode
  *
+ *  When the mapped enum values are dense (most of the integer range
+ *  [min value, max value] is mapped), string() and index() use a table
+ *  directly indexed by the enum values, otherwise a linear search.
+ *
  *  \headerfile enum_string_map.h <cpptools/enum_string_map.h>
  *  \ingroup cpptools
  */
@@ -57,22 +63,47 @@ public:
 
     ENUM valueAt(std::size_t i) const;
     ENUM value(const char* str) const;
+    ENUM value(const char* str, std::size_t len) const;
     const char* string(ENUM eval) const;
 
     Mapping mapping(std::size_t i) const;
 
 private:
+    //! Non NUL-terminated string
+    struct StrRef
+    {
+        StrRef(const char* pData, std::size_t pLen)
+            : data(pData), len(pLen)
+        { }
+
+        const char* data;
+        std::size_t len;
+    };
+
+    struct StrHash
+    {
+        std::size_t operator()(const StrRef& str) const;
+    };
+
     struct StrEqual
     {
-        bool operator()(const char* lhs, const char* rhs) const;
+        bool operator()(const StrRef& lhs, const StrRef& rhs) const;
     };
+    typedef typename std::underlying_type<ENUM>::type EnumInt;
 
-    typedef cpp::hash_fnv_1a<> StrHash;
+    static const std::size_t npos = static_cast<std::size_t>(-1);
 
-    typename std::vector<Mapping>::const_iterator findCppSql(ENUM eval) const;
+    static std::uintmax_t offset(EnumInt value, EnumInt minValue);
+    void updateDenseIndex(ENUM eval, std::size_t i);
+    std::size_t findIndex(ENUM eval) const;
 
-    std::unordered_map<const char*, ENUM, StrHash, StrEqual> m_strEnumMap;
+    std::unordered_map<StrRef, ENUM, StrHash, StrEqual> m_strEnumMap;
     std::vector<Mapping> m_mappingVec;
+
+    // Mapping index of enum value (m_minValue + i), empty if values not dense
+    std::vector<std::size_t> m_denseIndexVec;
+    EnumInt m_minValue;
+    EnumInt m_maxValue;
 };
 
 } // namespace cpp
@@ -87,16 +118,22 @@ private:
 
 namespace cpp {
 
+template<typename ENUM>
+const std::size_t EnumStringMap<ENUM>::npos;
+
 template<typename ENUM>
 EnumStringMap<ENUM>::EnumStringMap()
+    : m_minValue(0),
+      m_maxValue(0)
 {
 }
 
 template<typename ENUM>
 void EnumStringMap<ENUM>::map(ENUM eval, const char* str)
 {
-    m_strEnumMap.emplace(str, eval);
+    m_strEnumMap.emplace(StrRef(str, std::strlen(str)), eval);
     m_mappingVec.emplace_back(eval, str);
+    this->updateDenseIndex(eval, m_mappingVec.size() - 1);
 }
 
 template<typename ENUM>
@@ -108,7 +145,7 @@ std::size_t EnumStringMap<ENUM>::size() const
 template<typename ENUM>
 std::size_t EnumStringMap<ENUM>::index(ENUM eval) const
 {
-    return this->findCppSql(eval) - m_mappingVec.begin();
+    return this->findIndex(eval);
 }
 
 template<typename ENUM>
@@ -121,7 +158,19 @@ ENUM EnumStringMap<ENUM>::valueAt(std::size_t i) const
 template<typename ENUM>
 ENUM EnumStringMap<ENUM>::value(const char *str) const
 {
-    auto it = m_strEnumMap.find(str);
+    return this->value(str, std::strlen(str));
+}
+
+/*! Returns the enum value mapped to the string of \p len characters starting
+ *  at \p str
+ *
+ *  \p str does not have to be NUL-terminated, so tokens can be looked up in
+ *  place (ex: in a file buffer)
+ */
+template<typename ENUM>
+ENUM EnumStringMap<ENUM>::value(const char *str, std::size_t len) const
+{
+    auto it = m_strEnumMap.find(StrRef(str, len));
     assert(it != m_strEnumMap.cend());
     return (*it).second;
 }
@@ -129,8 +178,7 @@ ENUM EnumStringMap<ENUM>::value(const char *str) const
 template<typename ENUM>
 const char *EnumStringMap<ENUM>::string(ENUM eval) const
 {
-    auto it = this->findCppSql(eval);
-    return (*it).second;
+    return m_mappingVec.at(this->findIndex(eval)).second;
 }
 
 template<typename ENUM>
@@ -140,20 +188,94 @@ typename EnumStringMap<ENUM>::Mapping EnumStringMap<ENUM>::mapping(std::size_t i
     return m_mappingVec.at(i);
 }
 
+//! Position of \p value in the range starting at \p minValue (value >= minValue)
 template<typename ENUM>
-typename std::vector<typename EnumStringMap<ENUM>::Mapping>::const_iterator
-EnumStringMap<ENUM>::findCppSql(ENUM eval) const
+std::uintmax_t EnumStringMap<ENUM>::offset(EnumInt value, EnumInt minValue)
 {
+    // Modular arithmetic, no overflow even for large ranges of signed values
+    return static_cast<std::uintmax_t>(value) - static_cast<std::uintmax_t>(minValue);
+}
+
+/*! Keeps m_denseIndexVec up to date after mapping \p eval at index \p i
+ *
+ *  Values are considered dense if the range [min value, max value] is at most
+ *  twice the count of mappings
+ */
+template<typename ENUM>
+void EnumStringMap<ENUM>::updateDenseIndex(ENUM eval, std::size_t i)
+{
+    const EnumInt value = static_cast<EnumInt>(eval);
+    const bool wasDense = !m_denseIndexVec.empty();
+    if (i == 0) {
+        m_minValue = value;
+        m_maxValue = value;
+    }
+    else {
+        m_minValue = std::min(m_minValue, value);
+        m_maxValue = std::max(m_maxValue, value);
+    }
+
+    const std::uintmax_t range = offset(m_maxValue, m_minValue) + 1;
+    if (range == 0 || range > 2 * static_cast<std::uintmax_t>(m_mappingVec.size())) {
+        m_denseIndexVec.clear();
+        return;
+    }
+
+    const std::size_t rangeSize = static_cast<std::size_t>(range);
+    if (wasDense && m_denseIndexVec.size() == rangeSize) {
+        // Value inside the current range
+    }
+    else if (wasDense && offset(value, m_minValue) == rangeSize - 1) {
+        // Range extended at its end
+        m_denseIndexVec.resize(rangeSize, npos);
+    }
+    else {
+        // Range extended at its beginning or values just became dense
+        m_denseIndexVec.assign(rangeSize, npos);
+        for (std::size_t j = 0; j < i; ++j) {
+            std::size_t& id = m_denseIndexVec.at(
+                        offset(static_cast<EnumInt>(m_mappingVec.at(j).first), m_minValue));
+            if (id == npos)
+                id = j;
+        }
+    }
+
+    std::size_t& id = m_denseIndexVec.at(offset(value, m_minValue));
+    if (id == npos)
+        id = i; // Keep the first mapping of eval
+}
+
+template<typename ENUM>
+std::size_t EnumStringMap<ENUM>::findIndex(ENUM eval) const
+{
+    if (!m_denseIndexVec.empty()) {
+        const EnumInt value = static_cast<EnumInt>(eval);
+        if (m_minValue <= value && value <= m_maxValue) {
+            const std::size_t id = m_denseIndexVec[offset(value, m_minValue)];
+            if (id != npos)
+                return id;
+        }
+        assert(false); // eval not mapped
+        return m_mappingVec.size();
+    }
+
     auto it = std::find_if(m_mappingVec.cbegin(), m_mappingVec.cend(),
                            [=] (const Mapping& map) { return map.first == eval; } );
     assert(it != m_mappingVec.cend());
-    return it;
+    return it - m_mappingVec.cbegin();
+}
+
+template<typename ENUM>
+std::size_t EnumStringMap<ENUM>::StrHash::operator()(const StrRef& str) const
+{
+    return cpp::hash_fnv_1a<>()(str.data, str.len);
 }
 
 template<typename ENUM>
-bool EnumStringMap<ENUM>::StrEqual::operator()(const char *lhs, const char *rhs) const
+bool EnumStringMap<ENUM>::StrEqual::operator()(
+        const StrRef& lhs, const StrRef& rhs) const
 {
-    return std::strcmp(lhs, rhs) == 0;
+    return lhs.len == rhs.len && std::memcmp(lhs.data, rhs.data, lhs.len) == 0;
 }
 
 } // namespace cpp
@@ -15,17 +15,20 @@
 
 #pragma once
 
+#include "config.h"
+
 #include <cstddef>
 #include <algorithm>
 #include <iterator>
+#include <type_traits>
 
 namespace cpp {
 
-template<typename T, unsigned S>
+template<typename T, unsigned S, std::size_t ALIGN = 0>
 class FixedArray
 {
 private:
-    typedef FixedArray<T, S> Self_t;
+    typedef FixedArray<T, S, ALIGN> Self_t;
 
 public:
     // STL compatibility
@@ -40,9 +43,9 @@ public:
     typedef T* iterator;
     typedef const T* const_iterator;
 
-    // Ctor
-    FixedArray<T, S>();
-    FixedArray<T, S>(const Self_t& other);
+    //! Alignment of the items storage : ALIGN, or alignment of T if stricter
+    static const std::size_t alignment =
+            ALIGN > std::alignment_of<T>::value ? ALIGN : std::alignment_of<T>::value;
 
     // Iteration
     const_iterator begin() const;
@@ -65,16 +68,48 @@ public:
 
     // Element change
     void set(unsigned i, const T& coord);
-    Self_t& operator=(const Self_t& other);
+    void fill(const T& value);
+
+    // Element-wise arithmetic
+    Self_t& operator+=(const Self_t& other);
+    Self_t& operator-=(const Self_t& other);
+    Self_t& operator*=(const T& scalar);
+    Self_t& operator/=(const T& scalar);
 
 protected:
     // Attributes
-    T m_vector[S];
+    CPPTOOLS_ALIGNAS(alignment) T m_vector[S];
 };
 
 //! \relates FixedArray
-template<typename TEXT_STREAM, typename T, unsigned S>
-TEXT_STREAM& operator<<(TEXT_STREAM& os, const FixedArray<T, S>& coords);
+template<typename TEXT_STREAM, typename T, unsigned S, std::size_t ALIGN>
+TEXT_STREAM& operator<<(TEXT_STREAM& os, const FixedArray<T, S, ALIGN>& coords);
+
+//! \relates FixedArray
+template<typename T, unsigned S, std::size_t ALIGN>
+FixedArray<T, S, ALIGN> operator+(
+        const FixedArray<T, S, ALIGN>& lhs, const FixedArray<T, S, ALIGN>& rhs);
+
+//! \relates FixedArray
+template<typename T, unsigned S, std::size_t ALIGN>
+FixedArray<T, S, ALIGN> operator-(
+        const FixedArray<T, S, ALIGN>& lhs, const FixedArray<T, S, ALIGN>& rhs);
+
+//! \relates FixedArray
+template<typename T, unsigned S, std::size_t ALIGN>
+FixedArray<T, S, ALIGN> operator-(const FixedArray<T, S, ALIGN>& array);
+
+//! \relates FixedArray
+template<typename T, unsigned S, std::size_t ALIGN>
+FixedArray<T, S, ALIGN> operator*(const FixedArray<T, S, ALIGN>& array, const T& scalar);
+
+//! \relates FixedArray
+template<typename T, unsigned S, std::size_t ALIGN>
+FixedArray<T, S, ALIGN> operator*(const T& scalar, const FixedArray<T, S, ALIGN>& array);
+
+//! \relates FixedArray
+template<typename T, unsigned S, std::size_t ALIGN>
+FixedArray<T, S, ALIGN> operator/(const FixedArray<T, S, ALIGN>& array, const T& scalar);
 
 //
 // Implementation
@@ -84,121 +119,157 @@ TEXT_STREAM& operator<<(TEXT_STREAM& os, const FixedArray<T, S>& coords);
  * \class FixedArray
  * \brief Provides a generic fixed-size array of items
  *
+ * Items are stored inline. Copy construction and assignment are the implicit
+ * ones, so FixedArray is trivially copyable (copied as with memcpy) when T is.
+ *
+ * \p ALIGN forces a stricter alignment of the items storage, ex: 16 or 32 for
+ * aligned SIMD loads of float/double items (ignored with MSVC < 2015).
+ *
+ * Element-wise arithmetic operators are simple loops over the S items, that
+ * compilers can unroll and vectorize. Arguments are passed by reference since
+ * some ABIs can't pass over-aligned objects by value.
+ *
+ * FixedArray can be used as a vector type by mathtools (ex: math::Norm) by
+ * including <mathtools/cpp_fixed_array_traits.h>
+ *
  * \headerfile fixed_array.h <cpptools/fixed_array.h>
  * \ingroup cpptools
  */
 
-template<typename T, unsigned S>
-FixedArray<T, S>::FixedArray()
-{
-}
-
-template<typename T, unsigned S>
-FixedArray<T, S>::FixedArray(const Self_t& other)
-{
-    std::copy(other.begin(), other.end(), this->begin());
-}
+template<typename T, unsigned S, std::size_t ALIGN>
+const std::size_t FixedArray<T, S, ALIGN>::alignment;
 
-template<typename T, unsigned S>
-typename FixedArray<T, S>::const_iterator
-FixedArray<T, S>::begin() const
+template<typename T, unsigned S, std::size_t ALIGN>
+typename FixedArray<T, S, ALIGN>::const_iterator
+FixedArray<T, S, ALIGN>::begin() const
 {
     return m_vector;
 }
 
-template<typename T, unsigned S>
-typename FixedArray<T, S>::iterator
-FixedArray<T, S>::begin()
+template<typename T, unsigned S, std::size_t ALIGN>
+typename FixedArray<T, S, ALIGN>::iterator
+FixedArray<T, S, ALIGN>::begin()
 {
     return m_vector;
 }
 
-template<typename T, unsigned S>
-typename FixedArray<T, S>::const_iterator
-FixedArray<T, S>::end() const
+template<typename T, unsigned S, std::size_t ALIGN>
+typename FixedArray<T, S, ALIGN>::const_iterator
+FixedArray<T, S, ALIGN>::end() const
 {
     return m_vector + S;
 }
 
-template<typename T, unsigned S>
-typename FixedArray<T, S>::iterator
-FixedArray<T, S>::end()
+template<typename T, unsigned S, std::size_t ALIGN>
+typename FixedArray<T, S, ALIGN>::iterator
+FixedArray<T, S, ALIGN>::end()
 {
     return m_vector + S;
 }
 
-template<typename T, unsigned S>
-bool FixedArray<T, S>::empty() const
+template<typename T, unsigned S, std::size_t ALIGN>
+bool FixedArray<T, S, ALIGN>::empty() const
 {
     return false;
 }
 
-template<typename T, unsigned S>
-typename FixedArray<T, S>::size_type
-FixedArray<T, S>::max_size() const
+template<typename T, unsigned S, std::size_t ALIGN>
+typename FixedArray<T, S, ALIGN>::size_type
+FixedArray<T, S, ALIGN>::max_size() const
 {
     return S;
 }
 
-template<typename T, unsigned S>
-typename FixedArray<T, S>::size_type
-FixedArray<T, S>::size() const
+template<typename T, unsigned S, std::size_t ALIGN>
+typename FixedArray<T, S, ALIGN>::size_type
+FixedArray<T, S, ALIGN>::size() const
 {
-    return this->max_size();;
+    return this->max_size();
 }
 
-template<typename T, unsigned S>
-T& FixedArray<T, S>::get(unsigned i)
+template<typename T, unsigned S, std::size_t ALIGN>
+T& FixedArray<T, S, ALIGN>::get(unsigned i)
 {
     return m_vector[i];
 }
 
-template<typename T, unsigned S>
-const T& FixedArray<T, S>::get(unsigned i) const
+template<typename T, unsigned S, std::size_t ALIGN>
+const T& FixedArray<T, S, ALIGN>::get(unsigned i) const
 {
     return m_vector[i];
 }
 
-template<typename T, unsigned S>
-T& FixedArray<T, S>::operator[](unsigned i)
+template<typename T, unsigned S, std::size_t ALIGN>
+T& FixedArray<T, S, ALIGN>::operator[](unsigned i)
 {
     return this->get(i);
 }
 
-template<typename T, unsigned S>
-const T& FixedArray<T, S>::operator[](unsigned i) const
+template<typename T, unsigned S, std::size_t ALIGN>
+const T& FixedArray<T, S, ALIGN>::operator[](unsigned i) const
 {
     return this->get(i);
 }
 
-template<typename T, unsigned S>
-const T* FixedArray<T, S>::cArray() const
+template<typename T, unsigned S, std::size_t ALIGN>
+const T* FixedArray<T, S, ALIGN>::cArray() const
 {
     return &(m_vector[0]);
 }
 
-template<typename T, unsigned S>
-T* FixedArray<T, S>::cArray()
+template<typename T, unsigned S, std::size_t ALIGN>
+T* FixedArray<T, S, ALIGN>::cArray()
 {
-    return const_cast<T*>(static_cast<const FixedArray<T, S>*>(this)->cArray());
+    return const_cast<T*>(static_cast<const Self_t*>(this)->cArray());
 }
 
-template<typename T, unsigned S>
-void FixedArray<T, S>::set(unsigned i, const T& coord)
+template<typename T, unsigned S, std::size_t ALIGN>
+void FixedArray<T, S, ALIGN>::set(unsigned i, const T& coord)
 {
     m_vector[i] = coord;
 }
 
-template<typename T, unsigned S>
-FixedArray<T, S>& FixedArray<T, S>::operator=(const Self_t & other)
+template<typename T, unsigned S, std::size_t ALIGN>
+void FixedArray<T, S, ALIGN>::fill(const T& value)
+{
+    for (unsigned i = 0; i < S; ++i)
+        m_vector[i] = value;
+}
+
+template<typename T, unsigned S, std::size_t ALIGN>
+FixedArray<T, S, ALIGN>& FixedArray<T, S, ALIGN>::operator+=(const Self_t& other)
+{
+    for (unsigned i = 0; i < S; ++i)
+        m_vector[i] += other.m_vector[i];
+    return *this;
+}
+
+template<typename T, unsigned S, std::size_t ALIGN>
+FixedArray<T, S, ALIGN>& FixedArray<T, S, ALIGN>::operator-=(const Self_t& other)
+{
+    for (unsigned i = 0; i < S; ++i)
+        m_vector[i] -= other.m_vector[i];
+    return *this;
+}
+
+template<typename T, unsigned S, std::size_t ALIGN>
+FixedArray<T, S, ALIGN>& FixedArray<T, S, ALIGN>::operator*=(const T& scalar)
+{
+    for (unsigned i = 0; i < S; ++i)
+        m_vector[i] *= scalar;
+    return *this;
+}
+
+template<typename T, unsigned S, std::size_t ALIGN>
+FixedArray<T, S, ALIGN>& FixedArray<T, S, ALIGN>::operator/=(const T& scalar)
 {
-    if (this != &other)
-        std::copy(other.begin(), other.end(), this->begin());
+    for (unsigned i = 0; i < S; ++i)
+        m_vector[i] /= scalar;
     return *this;
 }
 
-template<typename TEXT_STREAM, typename T, unsigned S>
-TEXT_STREAM& operator<<(TEXT_STREAM& os, const FixedArray<T, S>& coords)
+template<typename TEXT_STREAM, typename T, unsigned S, std::size_t ALIGN>
+TEXT_STREAM& operator<<(TEXT_STREAM& os, const FixedArray<T, S, ALIGN>& coords)
 {
     os << "(";
     for (unsigned i = 0; i < S; i++) {
@@ -209,4 +280,50 @@ TEXT_STREAM& operator<<(TEXT_STREAM& os, const FixedArray<T, S>& coords)
     return os << ")";
 }
 
+template<typename T, unsigned S, std::size_t ALIGN>
+FixedArray<T, S, ALIGN> operator+(
+        const FixedArray<T, S, ALIGN>& lhs, const FixedArray<T, S, ALIGN>& rhs)
+{
+    FixedArray<T, S, ALIGN> result(lhs);
+    return result += rhs;
+}
+
+template<typename T, unsigned S, std::size_t ALIGN>
+FixedArray<T, S, ALIGN> operator-(
+        const FixedArray<T, S, ALIGN>& lhs, const FixedArray<T, S, ALIGN>& rhs)
+{
+    FixedArray<T, S, ALIGN> result(lhs);
+    return result -= rhs;
+}
+
+template<typename T, unsigned S, std::size_t ALIGN>
+FixedArray<T, S, ALIGN> operator-(const FixedArray<T, S, ALIGN>& array)
+{
+    FixedArray<T, S, ALIGN> result;
+    for (unsigned i = 0; i < S; ++i)
+        result[i] = -array[i];
+    return result;
+}
+
+template<typename T, unsigned S, std::size_t ALIGN>
+FixedArray<T, S, ALIGN> operator*(const FixedArray<T, S, ALIGN>& array, const T& scalar)
+{
+    FixedArray<T, S, ALIGN> result(array);
+    return result *= scalar;
+}
+
+template<typename T, unsigned S, std::size_t ALIGN>
+FixedArray<T, S, ALIGN> operator*(const T& scalar, const FixedArray<T, S, ALIGN>& array)
+{
+    FixedArray<T, S, ALIGN> result(array);
+    return result *= scalar;
+}
+
+template<typename T, unsigned S, std::size_t ALIGN>
+FixedArray<T, S, ALIGN> operator/(const FixedArray<T, S, ALIGN>& array, const T& scalar)
+{
+    FixedArray<T, S, ALIGN> result(array);
+    return result /= scalar;
+}
+
 } // namespace cpp
@@ -15,6 +15,8 @@
 
 #pragma once
 
+#include "config.h"
+
 #include <cstddef>
 #include <cstdint>
 
@@ -56,6 +58,16 @@ struct hash_fnv_1a_traits<64>
  *
  *  See http://www.isthe.com/chongo/tech/comp/fnv
  *
+ *  The static functions compute() can be evaluated at compile time (when
+ *  CPPTOOLS_HAVE_CONSTEXPR is defined), so hashes of string literals can be
+ *  used as constants, ex: in switch statements
+ *  \code
+ *      switch (cpp::hash_fnv_1a<>()(str)) {
+ *      case cpp::hash_fnv_1a<>::compute("started"): break;
+ *      case "running"_fnv: break; // using namespace cpp::literals
+ *      }
+ *  \endcode
+ *
  *  \ingroup cpptools
  */
 template<unsigned SIZE = sizeof(std::size_t)*8> // Target arch bit size by default
@@ -65,6 +77,7 @@ struct hash_fnv_1a
 
 private:
     typedef hash_fnv_1a_traits<SIZE> traits_t;
+    template<unsigned> friend class hash_fnv_1a_stream;
 
 public:
     typedef typename traits_t::uint_type uint_type;
@@ -99,7 +112,34 @@ public:
         return hash;
     }
 
+    //! Same as operator()(str), constexpr
+    static CPPTOOLS_CONSTEXPR uint_type compute(const char* str)
+    { return computeStep(str, traits_t::offsetBasis); }
+
+    //! Same as operator()(str, len), constexpr
+    static CPPTOOLS_CONSTEXPR uint_type compute(const char* str, std::size_t len)
+    { return computeStep(str, len, traits_t::offsetBasis); }
+
 private:
+    // C++11 constexpr functions are limited to one return statement, hence
+    // recursion instead of loops (recursion depth is the string length)
+    static CPPTOOLS_CONSTEXPR uint_type computeStep(const char* str, uint_type hash)
+    {
+        return *str == 0 ?
+                    hash :
+                    computeStep(str + 1, (hash ^ static_cast<uint_type>(*str)) * traits_t::prime);
+    }
+
+    static CPPTOOLS_CONSTEXPR uint_type computeStep(
+            const char* str, std::size_t len, uint_type hash)
+    {
+        return len == 0 ?
+                    hash :
+                    computeStep(str + 1,
+                                len - 1,
+                                (hash ^ static_cast<uint_type>(*str)) * traits_t::prime);
+    }
+
     template<typename BYTE>
     static inline void hashStep(uint_type& hash, BYTE byte)
     {
@@ -109,7 +149,97 @@ private:
     }
 };
 
+/*! Incremental 32/64b FNV-1a hashing
+ *
+ *  Byte sequences given to successive calls of update() are hashed as one
+ *  single sequence, so large or multi-part inputs can be hashed chunk by
+ *  chunk without being concatenated first :
+ *  \code
+ *      cpp::hash_fnv_1a_stream<> hasher;
+ *      hasher.update(chunk1, chunk1Len);
+ *      hasher.update(chunk2, chunk2Len);
+ *      assert(hasher.digest() == cpp::hash_fnv_1a<>()(chunk1And2, chunk1And2Len));
+ *  \endcode
+ *
+ *  \headerfile hash_fnv.h <cpptools/hash_fnv.h>
+ *  \ingroup cpptools
+ */
+template<unsigned SIZE = sizeof(std::size_t)*8>
+class hash_fnv_1a_stream
+{
+private:
+    typedef hash_fnv_1a<SIZE> hash_t;
+
+public:
+    typedef typename hash_t::uint_type uint_type;
+
+    hash_fnv_1a_stream()
+        : m_hash(hash_t::traits_t::offsetBasis)
+    { }
+
+    //! Hashes byte sequence \p byteSeq of length \p len
+    template<typename BYTE>
+    hash_fnv_1a_stream& update(const BYTE* byteSeq, std::size_t len)
+    {
+        auto hash = m_hash; // Local copy helps keeping the hash in a register
+        for (std::size_t i = 0; i < len; ++i)
+            hash_t::hashStep(hash, *(byteSeq + i));
+        m_hash = hash;
+        return *this;
+    }
+
+    //! Hashes byte sequence \p byteSeq which must be null terminated
+    template<typename BYTE>
+    hash_fnv_1a_stream& update(const BYTE* byteSeq)
+    {
+        auto hash = m_hash;
+        for (; *byteSeq != 0; ++byteSeq)
+            hash_t::hashStep(hash, *byteSeq);
+        m_hash = hash;
+        return *this;
+    }
+
+    //! Hashes byte sequence delimited by begin/end iterators
+    template<typename ITERATOR>
+    hash_fnv_1a_stream& update(ITERATOR begin, ITERATOR end)
+    {
+        auto hash = m_hash;
+        for (; begin != end; ++begin)
+            hash_t::hashStep(hash, *begin);
+        m_hash = hash;
+        return *this;
+    }
+
+    //! Hash of all the byte sequences given to update() since construction or
+    //! last reset()
+    uint_type digest() const
+    { return m_hash; }
+
+    void reset()
+    { m_hash = hash_t::traits_t::offsetBasis; }
+
+private:
+    uint_type m_hash;
+};
+
 typedef hash_fnv_1a<32> hash32_fnv_1a;
 typedef hash_fnv_1a<64> hash64_fnv_1a;
+typedef hash_fnv_1a_stream<32> hash32_fnv_1a_stream;
+typedef hash_fnv_1a_stream<64> hash64_fnv_1a_stream;
+
+#ifdef CPPTOOLS_HAVE_CONSTEXPR
+namespace literals {
+
+/*! Compile-time FNV-1a hash of a string literal, same as hash_fnv_1a<>()(str)
+ *
+ *  \ingroup cpptools
+ */
+constexpr hash_fnv_1a<>::uint_type operator"" _fnv(const char* str, std::size_t len)
+{
+    return hash_fnv_1a<>::compute(str, len);
+}
+
+} // namespace literals
+#endif // CPPTOOLS_HAVE_CONSTEXPR
 
 } // namespace cpp
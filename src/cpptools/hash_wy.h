@@ -0,0 +1,182 @@
+/****************************************************************************
+**  FougTools
+**  Copyright Fougue (30 Mar. 2015)
+**  contact@fougue.pro
+**
+** This software is a computer program whose purpose is to provide utility
+** tools for the C++ language and the Qt toolkit.
+**
+** This software is governed by the CeCILL-C license under French law and
+** abiding by the rules of distribution of free software.  You can  use,
+** modify and/ or redistribute the software under the terms of the CeCILL-C
+** license as circulated by CEA, CNRS and INRIA at the following URL
+** "http://www.cecill.info".
+****************************************************************************/
+
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+
+#if defined(_MSC_VER) \
+    || (defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+#  define CPPTOOLS_HASH_WY_LITTLE_ENDIAN
+#endif
+
+namespace cpp {
+
+namespace internal {
+
+//! 64x64 -> 128b multiplication folded to 64b (high part XOR low part)
+inline std::uint64_t hashMum(std::uint64_t a, std::uint64_t b)
+{
+#if defined(__SIZEOF_INT128__)
+    const unsigned __int128 r = static_cast<unsigned __int128>(a) * b;
+    return static_cast<std::uint64_t>(r >> 64) ^ static_cast<std::uint64_t>(r);
+#else
+    const std::uint64_t aLo = a & 0xFFFFFFFFULL;
+    const std::uint64_t aHi = a >> 32;
+    const std::uint64_t bLo = b & 0xFFFFFFFFULL;
+    const std::uint64_t bHi = b >> 32;
+    const std::uint64_t loLo = aLo * bLo;
+    const std::uint64_t hiLo = aHi * bLo;
+    const std::uint64_t loHi = aLo * bHi;
+    const std::uint64_t hiHi = aHi * bHi;
+    const std::uint64_t cross = (loLo >> 32) + (hiLo & 0xFFFFFFFFULL) + loHi;
+    const std::uint64_t hi = hiHi + (hiLo >> 32) + (cross >> 32);
+    const std::uint64_t lo = (cross << 32) | (loLo & 0xFFFFFFFFULL);
+    return hi ^ lo;
+#endif
+}
+
+} // namespace internal
+
+/*! Fast 64b string hashing processing 16 bytes per step (wyhash-like)
+ *
+ *  Each step mixes two 64b little-endian words with one 64x64 -> 128b
+ *  multiplication, which is several times faster than the byte-per-step
+ *  hash_fnv_1a on strings longer than a few bytes.
+ *
+ *  It provides the same functor interface as hash_fnv_1a and the three
+ *  overloads give the same hash for the same byte sequence. This is not a
+ *  cryptographic hash.
+ *
+ *  \headerfile hash_wy.h <cpptools/hash_wy.h>
+ *  \ingroup cpptools
+ */
+struct hash_wy
+{
+    typedef std::uint64_t uint_type;
+
+    explicit hash_wy(uint_type seed = 0)
+        : m_initialState(seed ^ internal::hashMum(seed ^ secret0, secret1))
+    { }
+
+    //! Hash on byte sequence \p byteSeq of length \p len
+    template<typename BYTE>
+    uint_type operator()(const BYTE* byteSeq, std::size_t len) const
+    {
+        static_assert(sizeof(BYTE) == 1, "valid BYTE type");
+        uint_type state = m_initialState;
+        std::size_t i = 0;
+        for (; i + 16 <= len; i += 16)
+            state = step(state, readWord(byteSeq + i, 8), readWord(byteSeq + i + 8, 8));
+        const std::size_t tailLen = len - i;
+        const uint_type tail0 = readWord(byteSeq + i, tailLen < 8 ? tailLen : 8);
+        const uint_type tail1 =
+                tailLen > 8 ? readWord(byteSeq + i + 8, tailLen - 8) : 0;
+        return finalize(state, tail0, tail1, len);
+    }
+
+    //! Hash on byte sequence \p byteSeq which must be null terminated
+    template<typename BYTE>
+    uint_type operator()(const BYTE* byteSeq) const
+    {
+        std::size_t len = 0;
+        while (byteSeq[len] != 0)
+            ++len;
+        return (*this)(byteSeq, len);
+    }
+
+    //! Hash on byte sequence delimited by begin/end iterators
+    template<typename ITERATOR>
+    uint_type operator()(ITERATOR begin, ITERATOR end) const
+    {
+        static_assert(
+                sizeof(typename std::iterator_traits<ITERATOR>::value_type) == 1,
+                "valid BYTE type");
+        uint_type state = m_initialState;
+        uint_type words[2] = { 0, 0 };
+        std::size_t len = 0;
+        for (; begin != end; ++begin, ++len) {
+            const std::size_t pos = len & 15;
+            if (pos == 0 && len != 0) {
+                state = step(state, words[0], words[1]);
+                words[0] = words[1] = 0;
+            }
+            words[pos >> 3] |= static_cast<uint_type>(static_cast<unsigned char>(*begin))
+                    << (8 * (pos & 7));
+        }
+        if (len != 0 && (len & 15) == 0) {
+            // Last block is full, the tail is empty
+            state = step(state, words[0], words[1]);
+            words[0] = words[1] = 0;
+        }
+        return finalize(state, words[0], words[1], len);
+    }
+
+private:
+    static const uint_type secret0 = 0xA0761D6478BD642FULL;
+    static const uint_type secret1 = 0xE7037ED1A0B428DBULL;
+
+    static uint_type step(uint_type state, uint_type word0, uint_type word1)
+    { return internal::hashMum(word0 ^ secret1, word1 ^ state); }
+
+    static uint_type finalize(
+            uint_type state, uint_type tail0, uint_type tail1, std::size_t len)
+    {
+        return internal::hashMum(
+                    secret1 ^ static_cast<uint_type>(len),
+                    step(state, tail0, tail1));
+    }
+
+    //! Little-endian word of \p count bytes (count <= 8), zero padded
+    template<typename BYTE>
+    static uint_type readWord(const BYTE* bytes, std::size_t count)
+    {
+        uint_type word = 0;
+#ifdef CPPTOOLS_HASH_WY_LITTLE_ENDIAN
+        // Fixed-size copies compile to single unaligned loads
+        if (count == 8) {
+            std::memcpy(&word, bytes, 8);
+            return word;
+        }
+        std::size_t pos = 0;
+        if (count & 4) {
+            std::uint32_t word32;
+            std::memcpy(&word32, bytes, 4);
+            word = word32;
+            pos = 4;
+        }
+        if (count & 2) {
+            std::uint16_t word16;
+            std::memcpy(&word16, bytes + pos, 2);
+            word |= static_cast<uint_type>(word16) << (8 * pos);
+            pos += 2;
+        }
+        if (count & 1)
+            word |= static_cast<uint_type>(static_cast<unsigned char>(bytes[pos])) << (8 * pos);
+#else
+        for (std::size_t i = 0; i < count; ++i)
+            word |= static_cast<uint_type>(static_cast<unsigned char>(bytes[i])) << (8 * i);
+#endif
+        return word;
+    }
+
+    uint_type m_initialState;
+};
+
+} // namespace cpp
@@ -0,0 +1,588 @@
+/****************************************************************************
+**  FougTools
+**  Copyright Fougue (30 Mar. 2015)
+**  contact@fougue.pro
+**
+** This software is a computer program whose purpose is to provide utility
+** tools for the C++ language and the Qt toolkit.
+**
+** This software is governed by the CeCILL-C license under French law and
+** abiding by the rules of distribution of free software.  You can  use,
+** modify and/ or redistribute the software under the terms of the CeCILL-C
+** license as circulated by CEA, CNRS and INRIA at the following URL
+** "http://www.cecill.info".
+****************************************************************************/
+
+
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace cpp {
+
+namespace internal {
+
+//! Type with the strictest alignment of fundamental types
+union MemoryMaxAlign
+{
+    long double ld;
+    long long ll;
+    double d;
+    void* ptr;
+    void (*fn)();
+};
+
+static const std::size_t memoryMaxAlignment =
+        std::alignment_of<MemoryMaxAlign>::value;
+
+inline std::size_t memoryAlignedSize(std::size_t size, std::size_t alignment)
+{
+    return (size + alignment - 1) & ~(alignment - 1);
+}
+
+} // namespace internal
+
+/*! \brief Statistics of memory given by MonotonicArena and FixedSizePool
+ *
+ *  \headerfile memory_arena.h <cpptools/memory_arena.h>
+ *  \ingroup cpptools
+ */
+struct MemoryStats
+{
+    MemoryStats()
+        : allocationCount(0),
+          bytesInUse(0),
+          peakBytesInUse(0),
+          bytesReserved(0),
+          peakBytesReserved(0)
+    { }
+
+    std::size_t allocationCount;   //!< Count of allocations served
+    std::size_t bytesInUse;        //!< Bytes currently handed out
+    std::size_t peakBytesInUse;    //!< Maximum of bytesInUse
+    std::size_t bytesReserved;     //!< Bytes currently obtained from the heap
+    std::size_t peakBytesReserved; //!< Maximum of bytesReserved
+};
+
+/*! \brief Monotonic (bump pointer) memory arena
+ *
+ *  Allocations are carved out of large heap blocks, they are not freed
+ *  individually but all at once by release() or at destruction. This suits
+ *  scratch objects living for a known period (ex: one import, one frame) and
+ *  avoids contention on the global allocator.
+ *
+ *  After release() the first block is kept, so an arena reused in a loop does
+ *  heap allocations only when it has to grow.
+ *
+ *  \note Destructors of objects created with create() are not called
+ *  \note MonotonicArena is not thread-safe, use one arena per thread
+ *
+ *  \headerfile memory_arena.h <cpptools/memory_arena.h>
+ *  \ingroup cpptools
+ */
+class MonotonicArena
+{
+public:
+    explicit MonotonicArena(std::size_t blockSize = 4096);
+    ~MonotonicArena();
+
+    void* allocate(
+            std::size_t size,
+            std::size_t alignment = internal::memoryMaxAlignment);
+
+    template<typename T, typename... ARGS>
+    T* create(ARGS&&... args);
+
+    void release();
+
+    std::size_t blockSize() const;
+    const MemoryStats& stats() const;
+
+private:
+    MonotonicArena(const MonotonicArena&);
+    MonotonicArena& operator=(const MonotonicArena&);
+
+    struct Block
+    {
+        Block* next;
+        std::size_t size; // Including this header
+    };
+
+    // Block header padded so the first allocation has the maximum alignment
+    static const std::size_t blockHeaderSize =
+            (sizeof(Block) + internal::memoryMaxAlignment - 1)
+            & ~(internal::memoryMaxAlignment - 1);
+
+    void addBlock(std::size_t minFreeSize);
+    void freeBlocks(Block* block);
+
+    Block* m_headBlock;
+    char* m_cursor;
+    char* m_end;
+    const std::size_t m_blockSize;
+    MemoryStats m_stats;
+};
+
+/*! \brief Pool of fixed-size memory slots
+ *
+ *  Slots are taken from a MonotonicArena and recycled through a free list, so
+ *  allocate() and deallocate() are O(1) and heap allocations happen only when
+ *  all slots are in use.
+ *
+ *  \note FixedSizePool is not thread-safe, use one pool per thread
+ *
+ *  \headerfile memory_arena.h <cpptools/memory_arena.h>
+ *  \ingroup cpptools
+ */
+class FixedSizePool
+{
+public:
+    explicit FixedSizePool(std::size_t slotSize, std::size_t slotsPerBlock = 64);
+
+    void* allocate();
+    void deallocate(void* slot);
+
+    std::size_t slotSize() const;
+    const MemoryStats& stats() const;
+
+private:
+    FixedSizePool(const FixedSizePool&);
+    FixedSizePool& operator=(const FixedSizePool&);
+
+    struct FreeSlot
+    {
+        FreeSlot* next;
+    };
+
+    const std::size_t m_slotSize;
+    MonotonicArena m_arena;
+    FreeSlot* m_freeSlot;
+    MemoryStats m_stats;
+};
+
+/*! \brief Pool of objects of type T (see FixedSizePool)
+ *
+ *  \headerfile memory_arena.h <cpptools/memory_arena.h>
+ *  \ingroup cpptools
+ */
+template<typename T>
+class ObjectPool
+{
+public:
+    explicit ObjectPool(std::size_t objectsPerBlock = 64);
+
+    template<typename... ARGS>
+    T* create(ARGS&&... args);
+    void destroy(T* object);
+
+    const MemoryStats& stats() const;
+
+private:
+    FixedSizePool m_pool;
+};
+
+/*! \brief STL allocator taking memory from a MonotonicArena
+ *
+ *  deallocate() does nothing, memory is reclaimed by MonotonicArena::release()
+ *  \code
+ *      cpp::MonotonicArena arena;
+ *      std::vector<int, cpp::ArenaAllocator<int>> vec((cpp::ArenaAllocator<int>(arena)));
+ *  \endcode
+ *
+ *  \headerfile memory_arena.h <cpptools/memory_arena.h>
+ *  \ingroup cpptools
+ */
+template<typename T>
+class ArenaAllocator
+{
+public:
+    typedef T value_type;
+    template<typename U> struct rebind { typedef ArenaAllocator<U> other; };
+
+    ArenaAllocator(MonotonicArena& arena);
+    template<typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other);
+
+    T* allocate(std::size_t n);
+    void deallocate(T* ptr, std::size_t n);
+
+    MonotonicArena* arena() const;
+
+private:
+    MonotonicArena* m_arena;
+};
+
+/*! \brief STL allocator taking single objects from a FixedSizePool
+ *
+ *  Suited for node-based containers (std::list, std::map, std::set, ...).
+ *  Allocations of one object that fits in a slot of the pool are served by the
+ *  pool, others (ex: bucket arrays of std::unordered_map) by the global heap.
+ *  The slot size of the pool has to be chosen according to the size of
+ *  container nodes (ex: sizeof(T) + 2 pointers for std::list<T>).
+ *
+ *  \headerfile memory_arena.h <cpptools/memory_arena.h>
+ *  \ingroup cpptools
+ */
+template<typename T>
+class PoolAllocator
+{
+public:
+    typedef T value_type;
+    template<typename U> struct rebind { typedef PoolAllocator<U> other; };
+
+    PoolAllocator(FixedSizePool& pool);
+    template<typename U>
+    PoolAllocator(const PoolAllocator<U>& other);
+
+    T* allocate(std::size_t n);
+    void deallocate(T* ptr, std::size_t n);
+
+    FixedSizePool* pool() const;
+
+private:
+    bool isPoolAllocation(std::size_t n) const;
+
+    FixedSizePool* m_pool;
+};
+
+template<typename T, typename U>
+bool operator==(const ArenaAllocator<T>& lhs, const ArenaAllocator<U>& rhs);
+template<typename T, typename U>
+bool operator!=(const ArenaAllocator<T>& lhs, const ArenaAllocator<U>& rhs);
+template<typename T, typename U>
+bool operator==(const PoolAllocator<T>& lhs, const PoolAllocator<U>& rhs);
+template<typename T, typename U>
+bool operator!=(const PoolAllocator<T>& lhs, const PoolAllocator<U>& rhs);
+
+
+
+// --
+// -- Implementation
+// --
+
+namespace internal {
+
+inline void memoryStatsAllocate(MemoryStats* stats, std::size_t bytes)
+{
+    ++stats->allocationCount;
+    stats->bytesInUse += bytes;
+    if (stats->bytesInUse > stats->peakBytesInUse)
+        stats->peakBytesInUse = stats->bytesInUse;
+}
+
+inline void memoryStatsReserve(MemoryStats* stats, std::size_t bytes)
+{
+    stats->bytesReserved += bytes;
+    if (stats->bytesReserved > stats->peakBytesReserved)
+        stats->peakBytesReserved = stats->bytesReserved;
+}
+
+} // namespace internal
+
+// MonotonicArena
+
+/*! Constructs an arena allocating heap blocks of \p blockSize bytes (larger
+ *  blocks are allocated for requests that do not fit)
+ *
+ *  No heap allocation is done until the first call to allocate()
+ */
+inline MonotonicArena::MonotonicArena(std::size_t blockSize)
+    : m_headBlock(NULL),
+      m_cursor(NULL),
+      m_end(NULL),
+      m_blockSize(blockSize)
+{
+}
+
+inline MonotonicArena::~MonotonicArena()
+{
+    this->freeBlocks(m_headBlock);
+}
+
+/*! Returns \p size bytes of memory aligned to \p alignment (which must be a
+ *  power of two)
+ */
+inline void* MonotonicArena::allocate(std::size_t size, std::size_t alignment)
+{
+    assert(alignment != 0 && (alignment & (alignment - 1)) == 0);
+    std::size_t padding =
+            internal::memoryAlignedSize(reinterpret_cast<std::size_t>(m_cursor), alignment)
+            - reinterpret_cast<std::size_t>(m_cursor);
+    if (m_cursor == NULL || size + padding > static_cast<std::size_t>(m_end - m_cursor)) {
+        this->addBlock(size + alignment);
+        padding = internal::memoryAlignedSize(reinterpret_cast<std::size_t>(m_cursor), alignment)
+                - reinterpret_cast<std::size_t>(m_cursor);
+    }
+    char* ptr = m_cursor + padding;
+    m_cursor = ptr + size;
+    internal::memoryStatsAllocate(&m_stats, size);
+    return ptr;
+}
+
+//! Returns a new object of type T constructed with \p args and allocated in
+//! this arena
+template<typename T, typename... ARGS>
+T* MonotonicArena::create(ARGS&&... args)
+{
+    void* ptr = this->allocate(sizeof(T), std::alignment_of<T>::value);
+    return new (ptr) T(std::forward<ARGS>(args)...);
+}
+
+/*! Frees all the memory allocated, first block excepted which is reused
+ *
+ *  All pointers given by allocate() and create() become invalid
+ */
+inline void MonotonicArena::release()
+{
+    if (m_headBlock == NULL)
+        return;
+
+    // Blocks are pushed at front, so the first block is the last of the list
+    Block* firstBlock = m_headBlock;
+    Block* prevBlock = NULL;
+    while (firstBlock->next != NULL) {
+        prevBlock = firstBlock;
+        firstBlock = firstBlock->next;
+    }
+    if (prevBlock != NULL) {
+        prevBlock->next = NULL;
+        this->freeBlocks(m_headBlock);
+    }
+
+    m_headBlock = firstBlock;
+    m_cursor = reinterpret_cast<char*>(firstBlock) + blockHeaderSize;
+    m_end = reinterpret_cast<char*>(firstBlock) + firstBlock->size;
+    m_stats.bytesInUse = 0;
+    m_stats.bytesReserved = firstBlock->size;
+}
+
+inline std::size_t MonotonicArena::blockSize() const
+{
+    return m_blockSize;
+}
+
+inline const MemoryStats& MonotonicArena::stats() const
+{
+    return m_stats;
+}
+
+inline void MonotonicArena::addBlock(std::size_t minFreeSize)
+{
+    const std::size_t size =
+            blockHeaderSize + (minFreeSize > m_blockSize ? minFreeSize : m_blockSize);
+    Block* block = static_cast<Block*>(::operator new(size));
+    block->next = m_headBlock;
+    block->size = size;
+    m_headBlock = block;
+    m_cursor = reinterpret_cast<char*>(block) + blockHeaderSize;
+    m_end = reinterpret_cast<char*>(block) + size;
+    internal::memoryStatsReserve(&m_stats, size);
+}
+
+inline void MonotonicArena::freeBlocks(Block* block)
+{
+    while (block != NULL) {
+        Block* nextBlock = block->next;
+        m_stats.bytesReserved -= block->size;
+        ::operator delete(block);
+        block = nextBlock;
+    }
+}
+
+// FixedSizePool
+
+//! Constructs a pool of slots of (at least) \p slotSize bytes, heap blocks
+//! hold \p slotsPerBlock slots
+inline FixedSizePool::FixedSizePool(std::size_t slotSize, std::size_t slotsPerBlock)
+    : m_slotSize(internal::memoryAlignedSize(
+                     slotSize > sizeof(FreeSlot) ? slotSize : sizeof(FreeSlot),
+                     internal::memoryMaxAlignment)),
+      m_arena(m_slotSize * slotsPerBlock),
+      m_freeSlot(NULL)
+{
+}
+
+//! Returns a memory slot of slotSize() bytes
+inline void* FixedSizePool::allocate()
+{
+    void* slot = m_freeSlot;
+    if (m_freeSlot != NULL)
+        m_freeSlot = m_freeSlot->next;
+    else
+        slot = m_arena.allocate(m_slotSize);
+    internal::memoryStatsAllocate(&m_stats, m_slotSize);
+    m_stats.bytesReserved = m_arena.stats().bytesReserved;
+    m_stats.peakBytesReserved = m_arena.stats().peakBytesReserved;
+    return slot;
+}
+
+//! Gives back to the pool \p slot, which must come from allocate()
+inline void FixedSizePool::deallocate(void* slot)
+{
+    if (slot == NULL)
+        return;
+    FreeSlot* freeSlot = static_cast<FreeSlot*>(slot);
+    freeSlot->next = m_freeSlot;
+    m_freeSlot = freeSlot;
+    m_stats.bytesInUse -= m_slotSize;
+}
+
+inline std::size_t FixedSizePool::slotSize() const
+{
+    return m_slotSize;
+}
+
+inline const MemoryStats& FixedSizePool::stats() const
+{
+    return m_stats;
+}
+
+// ObjectPool
+
+template<typename T>
+ObjectPool<T>::ObjectPool(std::size_t objectsPerBlock)
+    : m_pool(sizeof(T), objectsPerBlock)
+{
+    static_assert(std::alignment_of<T>::value <= internal::memoryMaxAlignment,
+                  "Over-aligned types are not supported");
+}
+
+//! Returns a new object of type T constructed with \p args
+template<typename T>
+template<typename... ARGS>
+T* ObjectPool<T>::create(ARGS&&... args)
+{
+    void* slot = m_pool.allocate();
+    try {
+        return new (slot) T(std::forward<ARGS>(args)...);
+    }
+    catch (...) {
+        m_pool.deallocate(slot);
+        throw;
+    }
+}
+
+//! Destroys \p object (which must come from create()) and recycles its memory
+template<typename T>
+void ObjectPool<T>::destroy(T* object)
+{
+    if (object != NULL) {
+        object->~T();
+        m_pool.deallocate(object);
+    }
+}
+
+template<typename T>
+const MemoryStats& ObjectPool<T>::stats() const
+{
+    return m_pool.stats();
+}
+
+// ArenaAllocator
+
+template<typename T>
+ArenaAllocator<T>::ArenaAllocator(MonotonicArena& arena)
+    : m_arena(&arena)
+{
+}
+
+template<typename T>
+template<typename U>
+ArenaAllocator<T>::ArenaAllocator(const ArenaAllocator<U>& other)
+    : m_arena(other.arena())
+{
+}
+
+template<typename T>
+T* ArenaAllocator<T>::allocate(std::size_t n)
+{
+    return static_cast<T*>(
+                m_arena->allocate(n * sizeof(T), std::alignment_of<T>::value));
+}
+
+template<typename T>
+void ArenaAllocator<T>::deallocate(T* /*ptr*/, std::size_t /*n*/)
+{
+}
+
+template<typename T>
+MonotonicArena* ArenaAllocator<T>::arena() const
+{
+    return m_arena;
+}
+
+template<typename T, typename U>
+bool operator==(const ArenaAllocator<T>& lhs, const ArenaAllocator<U>& rhs)
+{
+    return lhs.arena() == rhs.arena();
+}
+
+template<typename T, typename U>
+bool operator!=(const ArenaAllocator<T>& lhs, const ArenaAllocator<U>& rhs)
+{
+    return lhs.arena() != rhs.arena();
+}
+
+// PoolAllocator
+
+template<typename T>
+PoolAllocator<T>::PoolAllocator(FixedSizePool& pool)
+    : m_pool(&pool)
+{
+}
+
+template<typename T>
+template<typename U>
+PoolAllocator<T>::PoolAllocator(const PoolAllocator<U>& other)
+    : m_pool(other.pool())
+{
+}
+
+template<typename T>
+T* PoolAllocator<T>::allocate(std::size_t n)
+{
+    if (this->isPoolAllocation(n))
+        return static_cast<T*>(m_pool->allocate());
+    return static_cast<T*>(::operator new(n * sizeof(T)));
+}
+
+template<typename T>
+void PoolAllocator<T>::deallocate(T* ptr, std::size_t n)
+{
+    if (this->isPoolAllocation(n))
+        m_pool->deallocate(ptr);
+    else
+        ::operator delete(ptr);
+}
+
+template<typename T>
+FixedSizePool* PoolAllocator<T>::pool() const
+{
+    return m_pool;
+}
+
+template<typename T>
+bool PoolAllocator<T>::isPoolAllocation(std::size_t n) const
+{
+    return n == 1
+            && sizeof(T) <= m_pool->slotSize()
+            && std::alignment_of<T>::value <= internal::memoryMaxAlignment;
+}
+
+template<typename T, typename U>
+bool operator==(const PoolAllocator<T>& lhs, const PoolAllocator<U>& rhs)
+{
+    return lhs.pool() == rhs.pool();
+}
+
+template<typename T, typename U>
+bool operator!=(const PoolAllocator<T>& lhs, const PoolAllocator<U>& rhs)
+{
+    return lhs.pool() != rhs.pool();
+}
+
+} // namespace cpp
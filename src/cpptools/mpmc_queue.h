@@ -0,0 +1,201 @@
+/****************************************************************************
+**  FougTools
+**  Copyright Fougue (30 Mar. 2015)
+**  contact@fougue.pro
+**
+** This software is a computer program whose purpose is to provide utility
+** tools for the C++ language and the Qt toolkit.
+**
+** This software is governed by the CeCILL-C license under French law and
+** abiding by the rules of distribution of free software.  You can  use,
+** modify and/ or redistribute the software under the terms of the CeCILL-C
+** license as circulated by CEA, CNRS and INRIA at the following URL
+** "http://www.cecill.info".
+****************************************************************************/
+
+
+#pragma once
+
+#include "ring_buffer.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace cpp {
+
+/*! \brief Bounded lock-free queue for any count of producer and consumer
+ *         threads
+ *
+ *  \headerfile mpmc_queue.h <cpptools/mpmc_queue.h>
+ *  \ingroup cpptools
+ */
+template<typename T>
+class MpmcQueue
+{
+public:
+    typedef std::size_t size_type;
+
+    explicit MpmcQueue(size_type minCapacity);
+
+    size_type capacity() const;
+    size_type sizeApprox() const;
+
+    bool tryPush(const T& value);
+    bool tryPush(T&& value);
+    bool tryPop(T* value);
+
+private:
+    MpmcQueue(const MpmcQueue&);
+    MpmcQueue& operator=(const MpmcQueue&);
+
+    struct Cell
+    {
+        std::atomic<size_type> sequence;
+        T value;
+    };
+
+    template<typename VALUE>
+    bool pushValue(VALUE&& value);
+
+    // Enqueue and dequeue positions are written by different threads, padding
+    // keeps them in separate cache lines (no false sharing)
+    static const std::size_t cacheLineSize = 64;
+
+    std::vector<Cell> m_cells;
+    const size_type m_mask;
+    char m_padding0[cacheLineSize];
+    std::atomic<size_type> m_enqueuePos;
+    char m_padding1[cacheLineSize];
+    std::atomic<size_type> m_dequeuePos;
+    char m_padding2[cacheLineSize];
+};
+
+/*! \brief Bounded lock-free queue for one producer thread and one consumer
+ *         thread
+ *
+ *  Same as SpscRingBuffer, with tryPush()/tryPop() functions with the
+ *  semantics of MpmcQueue. Prefer it over MpmcQueue when there is a single
+ *  producer and a single consumer : no compare-and-swap is needed.
+ */
+template<typename T>
+using SpscQueue = SpscRingBuffer<T>;
+
+
+
+// --
+// -- Implementation
+// --
+
+/*!
+ * \class MpmcQueue
+ *
+ * Each cell of the ring carries a sequence number telling whether it is ready
+ * to be written or read at some enqueue/dequeue position (D. Vyukov's bounded
+ * MPMC queue). Producers (resp. consumers) only compete on a compare-and-swap
+ * of the enqueue (resp. dequeue) position, then access their cell without
+ * any lock.
+ *
+ * Capacity is fixed and rounded up to a power of two (at least 2). T must be
+ * default constructible, popped items are moved out of their cells.
+ */
+
+template<typename T>
+MpmcQueue<T>::MpmcQueue(size_type minCapacity)
+    : m_cells(internal::ringBufferCapacity(std::max(minCapacity, size_type(2)))),
+      m_mask(m_cells.size() - 1),
+      m_enqueuePos(0),
+      m_dequeuePos(0)
+{
+    for (size_type i = 0; i < m_cells.size(); ++i)
+        m_cells[i].sequence.store(i, std::memory_order_relaxed);
+}
+
+template<typename T>
+typename MpmcQueue<T>::size_type MpmcQueue<T>::capacity() const
+{
+    return m_cells.size();
+}
+
+//! Count of items, already outdated if other threads are active
+template<typename T>
+typename MpmcQueue<T>::size_type MpmcQueue<T>::sizeApprox() const
+{
+    const size_type dequeuePos = m_dequeuePos.load(std::memory_order_acquire);
+    const size_type enqueuePos = m_enqueuePos.load(std::memory_order_acquire);
+    const std::ptrdiff_t size = static_cast<std::ptrdiff_t>(enqueuePos - dequeuePos);
+    return size > 0 ? static_cast<size_type>(size) : 0;
+}
+
+//! Appends \p value if the queue is not full, can be called by any thread
+template<typename T>
+bool MpmcQueue<T>::tryPush(const T& value)
+{
+    return this->pushValue(value);
+}
+
+template<typename T>
+bool MpmcQueue<T>::tryPush(T&& value)
+{
+    return this->pushValue(std::move(value));
+}
+
+/*! Removes the oldest item into \p value if the queue is not empty, can be
+ *  called by any thread
+ */
+template<typename T>
+bool MpmcQueue<T>::tryPop(T* value)
+{
+    Cell* cell = NULL;
+    size_type pos = m_dequeuePos.load(std::memory_order_relaxed);
+    for (;;) {
+        cell = &m_cells[pos & m_mask];
+        const size_type seq = cell->sequence.load(std::memory_order_acquire);
+        const std::ptrdiff_t diff =
+                static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos + 1);
+        if (diff == 0) {
+            if (m_dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                break;
+        }
+        else if (diff < 0) {
+            return false; // Empty
+        }
+        else {
+            pos = m_dequeuePos.load(std::memory_order_relaxed);
+        }
+    }
+    *value = std::move(cell->value);
+    cell->sequence.store(pos + m_mask + 1, std::memory_order_release);
+    return true;
+}
+
+template<typename T>
+template<typename VALUE>
+bool MpmcQueue<T>::pushValue(VALUE&& value)
+{
+    Cell* cell = NULL;
+    size_type pos = m_enqueuePos.load(std::memory_order_relaxed);
+    for (;;) {
+        cell = &m_cells[pos & m_mask];
+        const size_type seq = cell->sequence.load(std::memory_order_acquire);
+        const std::ptrdiff_t diff =
+                static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos);
+        if (diff == 0) {
+            if (m_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                break;
+        }
+        else if (diff < 0) {
+            return false; // Full
+        }
+        else {
+            pos = m_enqueuePos.load(std::memory_order_relaxed);
+        }
+    }
+    cell->value = std::forward<VALUE>(value);
+    cell->sequence.store(pos + 1, std::memory_order_release);
+    return true;
+}
+
+} // namespace cpp
@@ -0,0 +1,116 @@
+/****************************************************************************
+**  FougTools
+**  Copyright Fougue (30 Mar. 2015)
+**  contact@fougue.pro
+**
+** This software is a computer program whose purpose is to provide utility
+** tools for the C++ language and the Qt toolkit.
+**
+** This software is governed by the CeCILL-C license under French law and
+** abiding by the rules of distribution of free software.  You can  use,
+** modify and/ or redistribute the software under the terms of the CeCILL-C
+** license as circulated by CEA, CNRS and INRIA at the following URL
+** "http://www.cecill.info".
+****************************************************************************/
+
+#pragma once
+
+#include <cstddef>
+#include <exception>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+namespace cpp {
+
+/*! Returns the count of threads used by default in parallel algorithms
+ *
+ *  This is the number of concurrent threads supported by the hardware, or 1
+ *  if this value is not computable.
+ *
+ *  \ingroup cpptools
+ */
+inline unsigned parallelThreadCount()
+{
+    const unsigned hwThreadCount = std::thread::hardware_concurrency();
+    return hwThreadCount > 0 ? hwThreadCount : 1;
+}
+
+/*! \brief Partitions [0, \p count) into contiguous chunks and calls
+ *         \p fn(chunkBegin, chunkEnd) for each of them concurrently
+ *
+ *  The first chunk is processed in the calling thread, other chunks are each
+ *  processed in a dedicated std::thread. The function returns when all chunks
+ *  are processed.
+ *
+ *  If \p fn throws, the first exception caught (in chunk order) is rethrown
+ *  in the calling thread once all threads are joined.
+ *
+ *  \param count  Count of items to process
+ *  \param fn  Callable with signature void(std::size_t, std::size_t), must be
+ *             safe to call concurrently on disjoint chunks
+ *  \param threadCount  Maximum count of threads to use (0 means
+ *                      parallelThreadCount())
+ *  \param minChunkSize  Minimum count of items per chunk, prevents spawning
+ *                       threads for tiny workloads
+ *
+ *  \ingroup cpptools
+ */
+template<typename FUNC>
+void parallelForRanges(
+        std::size_t count,
+        FUNC fn,
+        unsigned threadCount = 0,
+        std::size_t minChunkSize = 1)
+{
+    if (count == 0)
+        return;
+    if (threadCount == 0)
+        threadCount = cpp::parallelThreadCount();
+    if (minChunkSize == 0)
+        minChunkSize = 1;
+
+    const std::size_t maxChunkCount = (count + minChunkSize - 1) / minChunkSize;
+    const std::size_t chunkCount =
+            threadCount < maxChunkCount ? threadCount : maxChunkCount;
+    if (chunkCount <= 1) {
+        fn(std::size_t(0), count);
+        return;
+    }
+
+    std::vector<std::exception_ptr> errors(chunkCount);
+    auto fnChunk = [&] (std::size_t iChunk) {
+        // Spread the remainder on the first chunks
+        const std::size_t baseSize = count / chunkCount;
+        const std::size_t remainder = count % chunkCount;
+        const std::size_t chunkBegin =
+                iChunk * baseSize + (iChunk < remainder ? iChunk : remainder);
+        const std::size_t chunkEnd =
+                chunkBegin + baseSize + (iChunk < remainder ? 1 : 0);
+        try {
+            fn(chunkBegin, chunkEnd);
+        } catch (...) {
+            errors.at(iChunk) = std::current_exception();
+        }
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(chunkCount - 1);
+    for (std::size_t iChunk = 1; iChunk < chunkCount; ++iChunk) {
+        try {
+            threads.emplace_back(fnChunk, iChunk);
+        } catch (const std::system_error&) {
+            fnChunk(iChunk); // Thread creation failed, fallback to serial
+        }
+    }
+    fnChunk(0);
+    for (std::thread& thread : threads)
+        thread.join();
+
+    for (const std::exception_ptr& error : errors) {
+        if (error)
+            std::rethrow_exception(error);
+    }
+}
+
+} // namespace cpp
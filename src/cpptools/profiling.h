@@ -0,0 +1,390 @@
+/****************************************************************************
+**  FougTools
+**  Copyright Fougue (30 Mar. 2015)
+**  contact@fougue.pro
+**
+** This software is a computer program whose purpose is to provide utility
+** tools for the C++ language and the Qt toolkit.
+**
+** This software is governed by the CeCILL-C license under French law and
+** abiding by the rules of distribution of free software.  You can  use,
+** modify and/ or redistribute the software under the terms of the CeCILL-C
+** license as circulated by CEA, CNRS and INRIA at the following URL
+** "http://www.cecill.info".
+****************************************************************************/
+
+
+#pragma once
+
+#include "config.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+/*! \def CPPTOOLS_PROFILE_ZONE(name)
+ *  Measures the time spent until the end of the current scope and accounts it
+ *  to the zone \p name (a string literal)
+ *
+ *  Expands to nothing unless CPPTOOLS_ENABLE_PROFILING is defined (qmake :
+ *  CONFIG += profiling), so zones can stay in production code.
+ *
+ *  \code
+ *      TopoDS_Shape IO::loadPartFile(const char* fileName)
+ *      {
+ *          CPPTOOLS_PROFILE_ZONE("occ::IO::loadPartFile");
+ *          // ...
+ *      }
+ *  \endcode
+ *
+ *  \ingroup cpptools
+ */
+#ifdef CPPTOOLS_ENABLE_PROFILING
+#  define CPPTOOLS_PROFILE_CONCAT_IMPL(a, b) a##b
+#  define CPPTOOLS_PROFILE_CONCAT(a, b) CPPTOOLS_PROFILE_CONCAT_IMPL(a, b)
+#  define CPPTOOLS_PROFILE_ZONE(name) \
+    const cpp::ProfileZone CPPTOOLS_PROFILE_CONCAT(cppProfileZone_, __LINE__)(name)
+#else
+#  define CPPTOOLS_PROFILE_ZONE(name) (void)0
+#endif
+
+namespace cpp {
+
+/*! \brief Aggregated timings of a profile zone
+ *
+ *  Durations are counted in a log-linear histogram (4 buckets per power of
+ *  two), so percentile() is an upper bound within 25% of the exact value
+ *  while memory stays fixed whatever the count of samples.
+ *
+ *  \headerfile profiling.h <cpptools/profiling.h>
+ *  \ingroup cpptools
+ */
+struct ProfileZoneStats
+{
+    static const unsigned histogramSubBits = 2;
+    static const unsigned histogramSize = 64 << histogramSubBits;
+
+    explicit ProfileZoneStats(const char* zoneName = nullptr);
+
+    void record(std::uint64_t nsec);
+    void merge(const ProfileZoneStats& other);
+
+    double meanNSec() const;
+    std::uint64_t percentileNSec(double p) const;
+
+    static unsigned histogramBucket(std::uint64_t nsec);
+    static std::uint64_t histogramBucketUpperBound(unsigned bucket);
+
+    const char* name;
+    std::uint64_t count;
+    std::uint64_t totalNSec;
+    std::uint64_t minNSec;
+    std::uint64_t maxNSec;
+    std::uint32_t histogram[histogramSize];
+};
+
+/*! \brief Aggregation buffer of the profile zones ended in one thread
+ *
+ *  Each thread records in its own buffer (see current()), so recording never
+ *  contends with other threads. Buffers are chained in a global list that
+ *  profileSnapshot() walks, they are never deleted (their count is bounded by
+ *  the count of threads that ever ran a zone).
+ *
+ *  \headerfile profiling.h <cpptools/profiling.h>
+ *  \ingroup cpptools
+ */
+class ProfileThreadBuffer
+{
+public:
+    static ProfileThreadBuffer* current();
+    static ProfileThreadBuffer* first();
+    ProfileThreadBuffer* next() const;
+
+    void record(const char* zoneName, std::uint64_t nsec);
+    void collect(std::vector<ProfileZoneStats>* zones) const;
+    void reset();
+
+private:
+    ProfileThreadBuffer();
+    ProfileThreadBuffer(const ProfileThreadBuffer&) = delete;
+    ProfileThreadBuffer& operator=(const ProfileThreadBuffer&) = delete;
+
+    static std::atomic<ProfileThreadBuffer*>& listHead();
+    void lock() const;
+    void unlock() const;
+
+    // Only contended while a snapshot is taken
+    mutable std::atomic<bool> m_isLocked;
+    std::vector<ProfileZoneStats> m_zones;
+    ProfileThreadBuffer* m_next;
+};
+
+/*! \brief Measures the lifetime of a scope and records it in the
+ *         ProfileThreadBuffer of the current thread
+ *
+ *  Prefer macro CPPTOOLS_PROFILE_ZONE(), which compiles to nothing when
+ *  profiling is disabled
+ *
+ *  \headerfile profiling.h <cpptools/profiling.h>
+ *  \ingroup cpptools
+ */
+class ProfileZone
+{
+public:
+    typedef std::chrono::steady_clock Clock;
+
+    explicit ProfileZone(const char* name)
+        : m_name(name),
+          m_start(Clock::now())
+    { }
+
+    ~ProfileZone()
+    {
+        const auto duration = Clock::now() - m_start;
+        const auto nsec =
+                std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+        ProfileThreadBuffer::current()->record(
+                    m_name, static_cast<std::uint64_t>(nsec));
+    }
+
+private:
+    ProfileZone(const ProfileZone&) = delete;
+    ProfileZone& operator=(const ProfileZone&) = delete;
+
+    const char* m_name;
+    const Clock::time_point m_start;
+};
+
+std::vector<ProfileZoneStats> profileSnapshot();
+void profileReset();
+
+
+
+// --
+// -- Implementation
+// --
+
+namespace internal {
+
+inline unsigned log2Floor(std::uint64_t value)
+{
+    unsigned result = 0;
+    for (unsigned shift = 32; shift > 0; shift /= 2) {
+        if (value >> shift) {
+            value >>= shift;
+            result += shift;
+        }
+    }
+    return result;
+}
+
+} // namespace internal
+
+inline ProfileZoneStats::ProfileZoneStats(const char* zoneName)
+    : name(zoneName),
+      count(0),
+      totalNSec(0),
+      minNSec(std::numeric_limits<std::uint64_t>::max()),
+      maxNSec(0)
+{
+    std::memset(this->histogram, 0, sizeof(this->histogram));
+}
+
+inline void ProfileZoneStats::record(std::uint64_t nsec)
+{
+    ++this->count;
+    this->totalNSec += nsec;
+    this->minNSec = nsec < this->minNSec ? nsec : this->minNSec;
+    this->maxNSec = nsec > this->maxNSec ? nsec : this->maxNSec;
+    ++this->histogram[ProfileZoneStats::histogramBucket(nsec)];
+}
+
+inline void ProfileZoneStats::merge(const ProfileZoneStats& other)
+{
+    this->count += other.count;
+    this->totalNSec += other.totalNSec;
+    this->minNSec = other.minNSec < this->minNSec ? other.minNSec : this->minNSec;
+    this->maxNSec = other.maxNSec > this->maxNSec ? other.maxNSec : this->maxNSec;
+    for (unsigned i = 0; i < histogramSize; ++i)
+        this->histogram[i] += other.histogram[i];
+}
+
+inline double ProfileZoneStats::meanNSec() const
+{
+    return this->count > 0 ?
+                static_cast<double>(this->totalNSec) / this->count :
+                0.;
+}
+
+/*! Duration (upper bound) below which are \p p of the samples, \p p in
+ *  [0, 1]. Never greater than maxNSec
+ */
+inline std::uint64_t ProfileZoneStats::percentileNSec(double p) const
+{
+    if (this->count == 0)
+        return 0;
+    const double rank = p * this->count;
+    std::uint64_t cumulated = 0;
+    for (unsigned i = 0; i < histogramSize; ++i) {
+        cumulated += this->histogram[i];
+        if (cumulated > 0 && cumulated >= rank) {
+            const std::uint64_t bound = ProfileZoneStats::histogramBucketUpperBound(i);
+            return bound < this->maxNSec ? bound : this->maxNSec;
+        }
+    }
+    return this->maxNSec;
+}
+
+inline unsigned ProfileZoneStats::histogramBucket(std::uint64_t nsec)
+{
+    const std::uint64_t subCount = 1 << histogramSubBits;
+    if (nsec < subCount)
+        return static_cast<unsigned>(nsec);
+    const unsigned msb = internal::log2Floor(nsec);
+    const unsigned shift = msb - histogramSubBits;
+    const unsigned sub = static_cast<unsigned>((nsec >> shift) & (subCount - 1));
+    return ((shift + 1) << histogramSubBits) + sub;
+}
+
+inline std::uint64_t ProfileZoneStats::histogramBucketUpperBound(unsigned bucket)
+{
+    const std::uint64_t subCount = 1 << histogramSubBits;
+    if (bucket < subCount)
+        return bucket;
+    const unsigned shift = (bucket >> histogramSubBits) - 1;
+    const std::uint64_t sub = bucket & (subCount - 1);
+    const std::uint64_t upperBound = ((subCount + sub + 1) << shift) - 1;
+    return upperBound;
+}
+
+//! Buffer of the calling thread, created (and chained) on first call
+inline ProfileThreadBuffer* ProfileThreadBuffer::current()
+{
+    // POD thread-local, constant-initialized : no dynamic TLS initialization
+    static CPPTOOLS_THREAD_LOCAL ProfileThreadBuffer* threadBuffer = nullptr;
+    if (threadBuffer == nullptr) {
+        ProfileThreadBuffer* buffer = new ProfileThreadBuffer;
+        std::atomic<ProfileThreadBuffer*>& head = ProfileThreadBuffer::listHead();
+        buffer->m_next = head.load();
+        while (!head.compare_exchange_weak(buffer->m_next, buffer)) { }
+        threadBuffer = buffer;
+    }
+    return threadBuffer;
+}
+
+//! First buffer of the global list, iterate with next()
+inline ProfileThreadBuffer* ProfileThreadBuffer::first()
+{
+    return ProfileThreadBuffer::listHead().load();
+}
+
+inline ProfileThreadBuffer* ProfileThreadBuffer::next() const
+{
+    return m_next;
+}
+
+inline void ProfileThreadBuffer::record(const char* zoneName, std::uint64_t nsec)
+{
+    this->lock();
+    // Zones are few per thread and identified by their name literal, a linear
+    // search on pointers is the fastest lookup
+    ProfileZoneStats* zone = nullptr;
+    for (ProfileZoneStats& candidate : m_zones) {
+        if (candidate.name == zoneName) {
+            zone = &candidate;
+            break;
+        }
+    }
+    if (zone == nullptr) {
+        m_zones.push_back(ProfileZoneStats(zoneName));
+        zone = &m_zones.back();
+    }
+    zone->record(nsec);
+    this->unlock();
+}
+
+/*! Merges the zones of this buffer into \p zones
+ *
+ *  Zones are merged by name string, as a literal may have distinct addresses
+ *  in distinct translation units
+ */
+inline void ProfileThreadBuffer::collect(std::vector<ProfileZoneStats>* zones) const
+{
+    this->lock();
+    for (const ProfileZoneStats& zone : m_zones) {
+        bool isMerged = false;
+        for (ProfileZoneStats& other : *zones) {
+            if (other.name == zone.name || std::strcmp(other.name, zone.name) == 0) {
+                other.merge(zone);
+                isMerged = true;
+                break;
+            }
+        }
+        if (!isMerged)
+            zones->push_back(zone);
+    }
+    this->unlock();
+}
+
+inline void ProfileThreadBuffer::reset()
+{
+    this->lock();
+    m_zones.clear();
+    this->unlock();
+}
+
+inline ProfileThreadBuffer::ProfileThreadBuffer()
+    : m_isLocked(false),
+      m_next(nullptr)
+{
+}
+
+inline std::atomic<ProfileThreadBuffer*>& ProfileThreadBuffer::listHead()
+{
+    // Zero-initialized before any dynamic initialization takes place
+    static std::atomic<ProfileThreadBuffer*> head(nullptr);
+    return head;
+}
+
+inline void ProfileThreadBuffer::lock() const
+{
+    while (m_isLocked.exchange(true, std::memory_order_acquire)) { }
+}
+
+inline void ProfileThreadBuffer::unlock() const
+{
+    m_isLocked.store(false, std::memory_order_release);
+}
+
+/*! Timings of all zones, merged over all threads
+ *  \relates ProfileThreadBuffer
+ */
+inline std::vector<ProfileZoneStats> profileSnapshot()
+{
+    std::vector<ProfileZoneStats> zones;
+    for (const ProfileThreadBuffer* buffer = ProfileThreadBuffer::first();
+         buffer != nullptr;
+         buffer = buffer->next())
+    {
+        buffer->collect(&zones);
+    }
+    return zones;
+}
+
+/*! Clears the timings recorded so far, in all threads
+ *  \relates ProfileThreadBuffer
+ */
+inline void profileReset()
+{
+    for (ProfileThreadBuffer* buffer = ProfileThreadBuffer::first();
+         buffer != nullptr;
+         buffer = buffer->next())
+    {
+        buffer->reset();
+    }
+}
+
+} // namespace cpp
@@ -15,10 +15,85 @@
 
 #pragma once
 
+#include <cstddef>
 #include <iterator>
+#include <type_traits>
+#include <utility>
 
 namespace cpp {
 
+namespace internal {
+
+// Picks CONTAINER::push(), or CONTAINER::push_back() if push() is missing
+template<typename CONTAINER, typename VALUE>
+auto pusherPushValue(CONTAINER* cnter, VALUE&& value, int)
+    -> decltype(cnter->push(std::forward<VALUE>(value)), void())
+{
+    cnter->push(std::forward<VALUE>(value));
+}
+
+template<typename CONTAINER, typename VALUE>
+void pusherPushValue(CONTAINER* cnter, VALUE&& value, long)
+{
+    cnter->push_back(std::forward<VALUE>(value));
+}
+
+// Grows capacity once for the \p count items to come. Capacity is at least
+// doubled, so repeated bulk pushes keep an amortized constant cost
+template<typename CONTAINER>
+auto pusherReserve(CONTAINER* cnter, std::size_t count, int)
+    -> decltype(cnter->reserve(cnter->capacity()), void())
+{
+    const std::size_t minCapacity = cnter->size() + count;
+    if (minCapacity > cnter->capacity()) {
+        const std::size_t grownCapacity = 2 * cnter->capacity();
+        cnter->reserve(minCapacity > grownCapacity ? minCapacity : grownCapacity);
+    }
+}
+
+template<typename CONTAINER>
+void pusherReserve(CONTAINER*, std::size_t, long)
+{
+}
+
+template<typename CONTAINER, typename INPUT_ITERATOR>
+void pusherReserveRange(
+        CONTAINER* cnter, INPUT_ITERATOR first, INPUT_ITERATOR last,
+        std::forward_iterator_tag)
+{
+    internal::pusherReserve(
+                cnter, static_cast<std::size_t>(std::distance(first, last)), 0);
+}
+
+template<typename CONTAINER, typename INPUT_ITERATOR>
+void pusherReserveRange(
+        CONTAINER*, INPUT_ITERATOR, INPUT_ITERATOR, std::input_iterator_tag)
+{
+}
+
+// Picks range insertion at the end of the container if available, otherwise
+// pushes items one by one after a single reserve
+template<typename CONTAINER, typename INPUT_ITERATOR>
+auto pusherPushRange(
+        CONTAINER* cnter, INPUT_ITERATOR first, INPUT_ITERATOR last, int)
+    -> decltype(cnter->insert(cnter->end(), first, last), void())
+{
+    cnter->insert(cnter->end(), first, last);
+}
+
+template<typename CONTAINER, typename INPUT_ITERATOR>
+void pusherPushRange(
+        CONTAINER* cnter, INPUT_ITERATOR first, INPUT_ITERATOR last, long)
+{
+    typedef typename std::iterator_traits<INPUT_ITERATOR>::iterator_category
+            IteratorCategory;
+    internal::pusherReserveRange(cnter, first, last, IteratorCategory());
+    for (; first != last; ++first)
+        internal::pusherPushValue(cnter, *first, 0);
+}
+
+} // namespace internal
+
 /*! Push iterator
  *
  *  A push_iterator is a special type of output iterator designed to allow
@@ -26,7 +101,8 @@ namespace cpp {
  *  new elements automatically into the container.
  *
  *  The container needs to have a push() member function (such as the standard
- *  containers queue and stack).
+ *  containers queue and stack), or else a push_back() member function (such
+ *  as std::vector).
  *
  *  Using the assignment operator on the returned iterator (either dereferenced
  *  or not), causes the container to expand by one element, which is
@@ -36,6 +112,11 @@ namespace cpp {
  *  iterators but have no effect: all values assigned are pushed into the
  *  container.
  *
+ *  Ranges of items are better added with push(first, last) or
+ *  cpp::pushRange() : they are inserted with one call to the range insert()
+ *  of the container if any, otherwise capacity is reserved once (if the
+ *  container provides reserve()) before items are pushed one by one.
+ *
  *  \ingroup cpptools
  */
 template <typename CONTAINER>
@@ -54,13 +135,21 @@ public:
 
     push_iterator<CONTAINER>& operator=(const typename CONTAINER::value_type& value)
     {
-        m_container->push(value);
+        internal::pusherPushValue(m_container, value, 0);
         return *this;
     }
 
     push_iterator<CONTAINER>& operator=(typename CONTAINER::value_type&& value)
     {
-        m_container->push(std::move(value));
+        internal::pusherPushValue(m_container, std::move(value), 0);
+        return *this;
+    }
+
+    //! Pushes all items of range [\p first, \p last) into the container
+    template<typename INPUT_ITERATOR>
+    push_iterator<CONTAINER>& push(INPUT_ITERATOR first, INPUT_ITERATOR last)
+    {
+        internal::pusherPushRange(m_container, first, last, 0);
         return *this;
     }
 
@@ -87,4 +176,32 @@ push_iterator<CONTAINER> pusher(CONTAINER& x)
     return push_iterator<CONTAINER>(x);
 }
 
+/*! \brief Writes items of range [\p first, \p last) to output iterator
+ *         \p out
+ *
+ *  Same as std::copy(first, last, out), but when \p out is a push_iterator
+ *  the items are pushed in bulk (see push_iterator::push()).
+ *
+ *  \returns Output iterator past the last item written
+ *
+ *  \ingroup cpptools
+ */
+template<typename INPUT_ITERATOR, typename OUTPUT_ITERATOR>
+OUTPUT_ITERATOR pushRange(
+        OUTPUT_ITERATOR out, INPUT_ITERATOR first, INPUT_ITERATOR last)
+{
+    for (; first != last; ++first) {
+        *out = *first;
+        ++out;
+    }
+    return out;
+}
+
+template<typename INPUT_ITERATOR, typename CONTAINER>
+push_iterator<CONTAINER> pushRange(
+        push_iterator<CONTAINER> out, INPUT_ITERATOR first, INPUT_ITERATOR last)
+{
+    return out.push(first, last);
+}
+
 } // namespace cpp
@@ -15,8 +15,55 @@
 
 #pragma once
 
+#include "config.h"
+
+#include <type_traits>
+
 namespace cpp {
 
+template<typename NUMERIC_TRAITS, typename TRAIT> class Quantity;
+
+/*! \brief Physical dimension of a Quantity, as exponents of base dimensions
+ *
+ *  When used as the TRAIT of Quantity, products and quotients of quantities
+ *  give quantities of a new dimension (exponents are added or subtracted at
+ *  compile-time) :
+ *
+ *  \code
+ *      typedef cpp::QuantityDimension<1, 0> LengthDim; // Length, Time
+ *      typedef cpp::Quantity<cpp::DoubleNumericTraits, LengthDim> Length;
+ *      typedef cpp::Quantity<cpp::DoubleNumericTraits, cpp::QuantityDimension<2, 0>> Area;
+ *      const Area area = Length(2.) * Length(3.);
+ *  \endcode
+ *
+ *  The meaning of each exponent is up to the user, but the count of exponents
+ *  must be the same for quantities combined together.
+ *
+ *  \headerfile quantity.h <cpptools/quantity.h>
+ *  \ingroup cpptools
+ */
+template<int... EXPONENTS>
+struct QuantityDimension {};
+
+namespace internal {
+
+template<typename TRAIT>
+struct IsQuantityDimension : std::false_type {};
+
+template<int... EXPONENTS>
+struct IsQuantityDimension<QuantityDimension<EXPONENTS...>> : std::true_type {};
+
+// Product/quotient of quantities of same TRAIT keeps TRAIT, unless TRAIT is a
+// QuantityDimension
+template<typename NUMERIC_TRAITS, typename TRAIT>
+struct QuantitySameTraitResult :
+        std::enable_if<
+            !IsQuantityDimension<TRAIT>::value,
+            const Quantity<NUMERIC_TRAITS, TRAIT>>
+{};
+
+} // namespace internal
+
 template<typename NUMERIC_TRAITS, typename TRAIT = void>
 class Quantity
 {
@@ -24,24 +71,22 @@ public:
     typedef typename NUMERIC_TRAITS::Type NumericType;
     typedef Quantity<NUMERIC_TRAITS, TRAIT> QuantityType;
 
-    Quantity();
-    explicit Quantity(NumericType v);
-    Quantity(const QuantityType& other);
+    CPPTOOLS_CONSTEXPR Quantity() CPPTOOLS_NOEXCEPT;
+    CPPTOOLS_CONSTEXPR explicit Quantity(NumericType v) CPPTOOLS_NOEXCEPT;
 
     //operator NumericType() const;
-    NumericType value() const;
-    void setValue(NumericType v);
+    CPPTOOLS_CONSTEXPR NumericType value() const CPPTOOLS_NOEXCEPT;
+    void setValue(NumericType v) CPPTOOLS_NOEXCEPT;
 
-    QuantityType& operator=(const QuantityType& other);
-    QuantityType& operator+=(const QuantityType& other);
-    QuantityType& operator-=(const QuantityType& other);
-    QuantityType& operator*=(const QuantityType& other);
-    QuantityType& operator/=(const QuantityType& other);
+    QuantityType& operator+=(const QuantityType& other) CPPTOOLS_NOEXCEPT;
+    QuantityType& operator-=(const QuantityType& other) CPPTOOLS_NOEXCEPT;
+    QuantityType& operator*=(const QuantityType& other) CPPTOOLS_NOEXCEPT;
+    QuantityType& operator/=(const QuantityType& other) CPPTOOLS_NOEXCEPT;
 
-    QuantityType& operator+=(NumericType v);
-    QuantityType& operator-=(NumericType v);
-    QuantityType& operator*=(NumericType v);
-    QuantityType& operator/=(NumericType v);
+    QuantityType& operator+=(NumericType v) CPPTOOLS_NOEXCEPT;
+    QuantityType& operator-=(NumericType v) CPPTOOLS_NOEXCEPT;
+    QuantityType& operator*=(NumericType v) CPPTOOLS_NOEXCEPT;
+    QuantityType& operator/=(NumericType v) CPPTOOLS_NOEXCEPT;
 
 private:
     NumericType m_value;
@@ -49,83 +94,103 @@ private:
 
 // Operator <
 template<typename NUMERIC_TRAITS, typename TRAIT>
-bool operator<(const Quantity<NUMERIC_TRAITS, TRAIT>& lhs,
-               const Quantity<NUMERIC_TRAITS, TRAIT>& rhs);
+CPPTOOLS_CONSTEXPR bool operator<(
+        const Quantity<NUMERIC_TRAITS, TRAIT>& lhs,
+        const Quantity<NUMERIC_TRAITS, TRAIT>& rhs) CPPTOOLS_NOEXCEPT;
 
 // Operator >
 template<typename NUMERIC_TRAITS, typename TRAIT>
-bool operator>(const Quantity<NUMERIC_TRAITS, TRAIT>& lhs,
-               const Quantity<NUMERIC_TRAITS, TRAIT>& rhs);
+CPPTOOLS_CONSTEXPR bool operator>(
+        const Quantity<NUMERIC_TRAITS, TRAIT>& lhs,
+        const Quantity<NUMERIC_TRAITS, TRAIT>& rhs) CPPTOOLS_NOEXCEPT;
 
 // Operator +
 template<typename NUMERIC_TRAITS, typename TRAIT>
-const Quantity<NUMERIC_TRAITS, TRAIT> operator+(
+CPPTOOLS_CONSTEXPR const Quantity<NUMERIC_TRAITS, TRAIT> operator+(
         const Quantity<NUMERIC_TRAITS, TRAIT>& lhs,
-        const Quantity<NUMERIC_TRAITS, TRAIT>& rhs);
+        const Quantity<NUMERIC_TRAITS, TRAIT>& rhs) CPPTOOLS_NOEXCEPT;
 
 template<typename NUMERIC_TRAITS, typename TRAIT>
-const Quantity<NUMERIC_TRAITS, TRAIT> operator+(
+CPPTOOLS_CONSTEXPR const Quantity<NUMERIC_TRAITS, TRAIT> operator+(
         const Quantity<NUMERIC_TRAITS, TRAIT>& lhs,
-        typename NUMERIC_TRAITS::Type k);
+        typename NUMERIC_TRAITS::Type k) CPPTOOLS_NOEXCEPT;
 
 template<typename NUMERIC_TRAITS, typename TRAIT>
-const Quantity<NUMERIC_TRAITS, TRAIT> operator+(
+CPPTOOLS_CONSTEXPR const Quantity<NUMERIC_TRAITS, TRAIT> operator+(
         typename NUMERIC_TRAITS::Type k,
-        const Quantity<NUMERIC_TRAITS, TRAIT>& rhs);
+        const Quantity<NUMERIC_TRAITS, TRAIT>& rhs) CPPTOOLS_NOEXCEPT;
 
 // Operator -
 template<typename NUMERIC_TRAITS, typename TRAIT>
-const Quantity<NUMERIC_TRAITS, TRAIT> operator-(
+CPPTOOLS_CONSTEXPR const Quantity<NUMERIC_TRAITS, TRAIT> operator-(
         const Quantity<NUMERIC_TRAITS, TRAIT>& lhs,
-        const Quantity<NUMERIC_TRAITS, TRAIT>& rhs);
+        const Quantity<NUMERIC_TRAITS, TRAIT>& rhs) CPPTOOLS_NOEXCEPT;
 
 template<typename NUMERIC_TRAITS, typename TRAIT>
-const Quantity<NUMERIC_TRAITS, TRAIT> operator-(
+CPPTOOLS_CONSTEXPR const Quantity<NUMERIC_TRAITS, TRAIT> operator-(
         const Quantity<NUMERIC_TRAITS, TRAIT>& lhs,
-        typename NUMERIC_TRAITS::Type k);
+        typename NUMERIC_TRAITS::Type k) CPPTOOLS_NOEXCEPT;
 
 template<typename NUMERIC_TRAITS, typename TRAIT>
-const Quantity<NUMERIC_TRAITS, TRAIT> operator-(
+CPPTOOLS_CONSTEXPR const Quantity<NUMERIC_TRAITS, TRAIT> operator-(
         typename NUMERIC_TRAITS::Type k,
-        const Quantity<NUMERIC_TRAITS, TRAIT>& rhs);
+        const Quantity<NUMERIC_TRAITS, TRAIT>& rhs) CPPTOOLS_NOEXCEPT;
 
 // Operator *
 template<typename NUMERIC_TRAITS, typename TRAIT>
-const Quantity<NUMERIC_TRAITS, TRAIT> operator*(
+CPPTOOLS_CONSTEXPR typename internal::QuantitySameTraitResult<NUMERIC_TRAITS, TRAIT>::type
+operator*(
         const Quantity<NUMERIC_TRAITS, TRAIT>& lhs,
-        const Quantity<NUMERIC_TRAITS, TRAIT>& rhs);
+        const Quantity<NUMERIC_TRAITS, TRAIT>& rhs) CPPTOOLS_NOEXCEPT;
 
 template<typename NUMERIC_TRAITS, typename TRAIT>
-const Quantity<NUMERIC_TRAITS, TRAIT> operator*(
+CPPTOOLS_CONSTEXPR const Quantity<NUMERIC_TRAITS, TRAIT> operator*(
         const Quantity<NUMERIC_TRAITS, TRAIT>& lhs,
-        typename NUMERIC_TRAITS::Type k);
+        typename NUMERIC_TRAITS::Type k) CPPTOOLS_NOEXCEPT;
 
 template<typename NUMERIC_TRAITS, typename TRAIT>
-const Quantity<NUMERIC_TRAITS, TRAIT> operator*(
+CPPTOOLS_CONSTEXPR const Quantity<NUMERIC_TRAITS, TRAIT> operator*(
         typename NUMERIC_TRAITS::Type k,
-        const Quantity<NUMERIC_TRAITS, TRAIT>& rhs);
+        const Quantity<NUMERIC_TRAITS, TRAIT>& rhs) CPPTOOLS_NOEXCEPT;
+
+// Operator * (dimensioned quantities)
+template<typename NUMERIC_TRAITS, int... LHS_EXPONENTS, int... RHS_EXPONENTS>
+CPPTOOLS_CONSTEXPR const Quantity<
+    NUMERIC_TRAITS, QuantityDimension<(LHS_EXPONENTS + RHS_EXPONENTS)...>>
+operator*(
+        const Quantity<NUMERIC_TRAITS, QuantityDimension<LHS_EXPONENTS...>>& lhs,
+        const Quantity<NUMERIC_TRAITS, QuantityDimension<RHS_EXPONENTS...>>& rhs) CPPTOOLS_NOEXCEPT;
 
 // Operator /
 template<typename NUMERIC_TRAITS, typename TRAIT>
-const Quantity<NUMERIC_TRAITS, TRAIT> operator/(
+CPPTOOLS_CONSTEXPR typename internal::QuantitySameTraitResult<NUMERIC_TRAITS, TRAIT>::type
+operator/(
         const Quantity<NUMERIC_TRAITS, TRAIT>& lhs,
-        const Quantity<NUMERIC_TRAITS, TRAIT>& rhs);
+        const Quantity<NUMERIC_TRAITS, TRAIT>& rhs) CPPTOOLS_NOEXCEPT;
 
 template<typename NUMERIC_TRAITS, typename TRAIT>
-const Quantity<NUMERIC_TRAITS, TRAIT> operator/(
+CPPTOOLS_CONSTEXPR const Quantity<NUMERIC_TRAITS, TRAIT> operator/(
         const Quantity<NUMERIC_TRAITS, TRAIT>& lhs,
-        typename NUMERIC_TRAITS::Type k);
+        typename NUMERIC_TRAITS::Type k) CPPTOOLS_NOEXCEPT;
 
 template<typename NUMERIC_TRAITS, typename TRAIT>
-const Quantity<NUMERIC_TRAITS, TRAIT> operator/(
+CPPTOOLS_CONSTEXPR const Quantity<NUMERIC_TRAITS, TRAIT> operator/(
         typename NUMERIC_TRAITS::Type k,
-        const Quantity<NUMERIC_TRAITS, TRAIT>& rhs);
+        const Quantity<NUMERIC_TRAITS, TRAIT>& rhs) CPPTOOLS_NOEXCEPT;
+
+// Operator / (dimensioned quantities)
+template<typename NUMERIC_TRAITS, int... LHS_EXPONENTS, int... RHS_EXPONENTS>
+CPPTOOLS_CONSTEXPR const Quantity<
+    NUMERIC_TRAITS, QuantityDimension<(LHS_EXPONENTS - RHS_EXPONENTS)...>>
+operator/(
+        const Quantity<NUMERIC_TRAITS, QuantityDimension<LHS_EXPONENTS...>>& lhs,
+        const Quantity<NUMERIC_TRAITS, QuantityDimension<RHS_EXPONENTS...>>& rhs) CPPTOOLS_NOEXCEPT;
 
 template<typename TYPE>
 struct NumericTraits
 {
     typedef TYPE Type;
-    static TYPE zero()
+    static CPPTOOLS_CONSTEXPR TYPE zero() CPPTOOLS_NOEXCEPT
     { return static_cast<TYPE>(0); }
 };
 
@@ -141,28 +206,26 @@ typedef NumericTraits<int> IntNumericTraits;
  * \class Quantity
  * \brief Represents an amount of a certain unit
  *
+ * Quantity has the size and copy semantics of its NumericType (it is
+ * trivially copyable), and its operations are inline constexpr functions :
+ * arrays of quantities are processed as fast as arrays of raw numbers.
+ *
  * \headerfile quantity.h <cpptools/quantity.h>
  * \ingroup cpptools
  */
 
 template<typename NUMERIC_TRAITS, typename TRAIT>
-Quantity<NUMERIC_TRAITS, TRAIT>::Quantity()
+CPPTOOLS_CONSTEXPR Quantity<NUMERIC_TRAITS, TRAIT>::Quantity() CPPTOOLS_NOEXCEPT
     : m_value(NUMERIC_TRAITS::zero())
 {
 }
 
 template<typename NUMERIC_TRAITS, typename TRAIT>
-Quantity<NUMERIC_TRAITS, TRAIT>::Quantity(NumericType v)
+CPPTOOLS_CONSTEXPR Quantity<NUMERIC_TRAITS, TRAIT>::Quantity(NumericType v) CPPTOOLS_NOEXCEPT
     : m_value(v)
 {
 }
 
-template<typename NUMERIC_TRAITS, typename TRAIT>
-Quantity<NUMERIC_TRAITS, TRAIT>::Quantity(const QuantityType& other)
-    : m_value(other.value())
-{
-}
-
 //template<typename NUMERIC_TRAITS, typename TRAIT>
 //Quantity<NUMERIC_TRAITS, TRAIT>::operator typename NUMERIC_TRAITS::Type() const
 //{
@@ -170,65 +233,57 @@ Quantity<NUMERIC_TRAITS, TRAIT>::Quantity(const QuantityType& other)
 //}
 
 template<typename NUMERIC_TRAITS, typename TRAIT>
-typename NUMERIC_TRAITS::Type Quantity<NUMERIC_TRAITS, TRAIT>::value() const
+CPPTOOLS_CONSTEXPR typename NUMERIC_TRAITS::Type
+Quantity<NUMERIC_TRAITS, TRAIT>::value() const CPPTOOLS_NOEXCEPT
 {
     return m_value;
 }
 
 template<typename NUMERIC_TRAITS, typename TRAIT>
-void Quantity<NUMERIC_TRAITS, TRAIT>::setValue(NumericType v)
+void Quantity<NUMERIC_TRAITS, TRAIT>::setValue(NumericType v) CPPTOOLS_NOEXCEPT
 {
     m_value = v;
 }
 
 template<typename NUMERIC_TRAITS, typename TRAIT>
 Quantity<NUMERIC_TRAITS, TRAIT>&
-Quantity<NUMERIC_TRAITS, TRAIT>::operator=(const QuantityType& other)
+Quantity<NUMERIC_TRAITS, TRAIT>::operator+=(const QuantityType& other) CPPTOOLS_NOEXCEPT
 {
-    if (this != &other)
-        m_value = other.value();
+    m_value += other.value();
     return *this;
 }
 
 template<typename NUMERIC_TRAITS, typename TRAIT>
 Quantity<NUMERIC_TRAITS, TRAIT>&
-Quantity<NUMERIC_TRAITS, TRAIT>::operator+=(const QuantityType& other)
+Quantity<NUMERIC_TRAITS, TRAIT>::operator-=(const QuantityType& other) CPPTOOLS_NOEXCEPT
 {
-    if (this != &other)
-        m_value += other.value();
+    m_value -= other.value();
     return *this;
 }
 
 template<typename NUMERIC_TRAITS, typename TRAIT>
 Quantity<NUMERIC_TRAITS, TRAIT>&
-Quantity<NUMERIC_TRAITS, TRAIT>::operator-=(const QuantityType& other)
+Quantity<NUMERIC_TRAITS, TRAIT>::operator*=(const QuantityType& other) CPPTOOLS_NOEXCEPT
 {
-    if (this != &other)
-        m_value -= other.value();
+    static_assert(!internal::IsQuantityDimension<TRAIT>::value,
+                  "Product of dimensioned quantities has another dimension");
+    m_value *= other.value();
     return *this;
 }
 
 template<typename NUMERIC_TRAITS, typename TRAIT>
 Quantity<NUMERIC_TRAITS, TRAIT>&
-Quantity<NUMERIC_TRAITS, TRAIT>::operator*=(const QuantityType& other)
+Quantity<NUMERIC_TRAITS, TRAIT>::operator/=(const QuantityType& other) CPPTOOLS_NOEXCEPT
 {
-    if (this != &other)
-        m_value *= other.value();
+    static_assert(!internal::IsQuantityDimension<TRAIT>::value,
+                  "Quotient of dimensioned quantities has another dimension");
+    m_value /= other.value();
     return *this;
 }
 
 template<typename NUMERIC_TRAITS, typename TRAIT>
 Quantity<NUMERIC_TRAITS, TRAIT>&
-Quantity<NUMERIC_TRAITS, TRAIT>::operator/=(const QuantityType& other)
-{
-    if (this != &other)
-        m_value /= other.value();
-    return *this;
-}
-
-template<typename NUMERIC_TRAITS, typename TRAIT>
-Quantity<NUMERIC_TRAITS, TRAIT>&
-Quantity<NUMERIC_TRAITS, TRAIT>::operator+=(NumericType v)
+Quantity<NUMERIC_TRAITS, TRAIT>::operator+=(NumericType v) CPPTOOLS_NOEXCEPT
 {
     m_value += v;
     return *this;
@@ -236,7 +291,7 @@ Quantity<NUMERIC_TRAITS, TRAIT>::operator+=(NumericType v)
 
 template<typename NUMERIC_TRAITS, typename TRAIT>
 Quantity<NUMERIC_TRAITS, TRAIT>&
-Quantity<NUMERIC_TRAITS, TRAIT>::operator-=(NumericType v)
+Quantity<NUMERIC_TRAITS, TRAIT>::operator-=(NumericType v) CPPTOOLS_NOEXCEPT
 {
     m_value -= v;
     return *this;
@@ -244,14 +299,15 @@ Quantity<NUMERIC_TRAITS, TRAIT>::operator-=(NumericType v)
 
 template<typename NUMERIC_TRAITS, typename TRAIT>
 Quantity<NUMERIC_TRAITS, TRAIT>&
-Quantity<NUMERIC_TRAITS, TRAIT>::operator*=(NumericType v)
+Quantity<NUMERIC_TRAITS, TRAIT>::operator*=(NumericType v) CPPTOOLS_NOEXCEPT
 {
     m_value *= v;
     return *this;
 }
 
 template<typename NUMERIC_TRAITS, typename TRAIT>
-Quantity<NUMERIC_TRAITS, TRAIT>& Quantity<NUMERIC_TRAITS, TRAIT>::operator/=(NumericType v)
+Quantity<NUMERIC_TRAITS, TRAIT>&
+Quantity<NUMERIC_TRAITS, TRAIT>::operator/=(NumericType v) CPPTOOLS_NOEXCEPT
 {
     m_value /= v;
     return *this;
@@ -260,22 +316,20 @@ Quantity<NUMERIC_TRAITS, TRAIT>& Quantity<NUMERIC_TRAITS, TRAIT>::operator/=(Num
 // Operator <
 //! \relates Quantity
 template<typename NUMERIC_TRAITS, typename TRAIT>
-bool operator<(const Quantity<NUMERIC_TRAITS, TRAIT>& lhs,
-               const Quantity<NUMERIC_TRAITS, TRAIT>& rhs)
+CPPTOOLS_CONSTEXPR bool operator<(
+        const Quantity<NUMERIC_TRAITS, TRAIT>& lhs,
+        const Quantity<NUMERIC_TRAITS, TRAIT>& rhs) CPPTOOLS_NOEXCEPT
 {
-    if (&lhs == &rhs)
-        return false;
     return lhs.value() < rhs.value();
 }
 
 // Operator >
 //! \relates Quantity
 template<typename NUMERIC_TRAITS, typename TRAIT>
-bool operator>(const Quantity<NUMERIC_TRAITS, TRAIT>& lhs,
-               const Quantity<NUMERIC_TRAITS, TRAIT>& rhs)
+CPPTOOLS_CONSTEXPR bool operator>(
+        const Quantity<NUMERIC_TRAITS, TRAIT>& lhs,
+        const Quantity<NUMERIC_TRAITS, TRAIT>& rhs) CPPTOOLS_NOEXCEPT
 {
-    if (&lhs == &rhs)
-        return false;
     return lhs.value() > rhs.value();
 }
 
@@ -283,116 +337,148 @@ bool operator>(const Quantity<NUMERIC_TRAITS, TRAIT>& lhs,
 
 //! \relates Quantity
 template<typename NUMERIC_TRAITS, typename TRAIT>
-const Quantity<NUMERIC_TRAITS, TRAIT> operator+(
+CPPTOOLS_CONSTEXPR const Quantity<NUMERIC_TRAITS, TRAIT> operator+(
         const Quantity<NUMERIC_TRAITS, TRAIT>& lhs,
-        const Quantity<NUMERIC_TRAITS, TRAIT>& rhs)
+        const Quantity<NUMERIC_TRAITS, TRAIT>& rhs) CPPTOOLS_NOEXCEPT
 {
-    return Quantity<NUMERIC_TRAITS, TRAIT>(lhs) += rhs;
+    return Quantity<NUMERIC_TRAITS, TRAIT>(lhs.value() + rhs.value());
 }
 
 //! \relates Quantity
 template<typename NUMERIC_TRAITS, typename TRAIT>
-const Quantity<NUMERIC_TRAITS, TRAIT> operator+(
+CPPTOOLS_CONSTEXPR const Quantity<NUMERIC_TRAITS, TRAIT> operator+(
         const Quantity<NUMERIC_TRAITS, TRAIT>& lhs,
-        typename NUMERIC_TRAITS::Type k)
+        typename NUMERIC_TRAITS::Type k) CPPTOOLS_NOEXCEPT
 {
-    return Quantity<NUMERIC_TRAITS, TRAIT>(lhs) += k;
+    return Quantity<NUMERIC_TRAITS, TRAIT>(lhs.value() + k);
 }
 
 //! \relates Quantity
 template<typename NUMERIC_TRAITS, typename TRAIT>
-const Quantity<NUMERIC_TRAITS, TRAIT> operator+(
+CPPTOOLS_CONSTEXPR const Quantity<NUMERIC_TRAITS, TRAIT> operator+(
         typename NUMERIC_TRAITS::Type k,
-        const Quantity<NUMERIC_TRAITS, TRAIT>& rhs)
+        const Quantity<NUMERIC_TRAITS, TRAIT>& rhs) CPPTOOLS_NOEXCEPT
 {
-    return Quantity<NUMERIC_TRAITS, TRAIT>(rhs) += k;
+    return Quantity<NUMERIC_TRAITS, TRAIT>(rhs.value() + k);
 }
 
 // Operator -
 
 //! \relates Quantity
 template<typename NUMERIC_TRAITS, typename TRAIT>
-const Quantity<NUMERIC_TRAITS, TRAIT> operator-(
+CPPTOOLS_CONSTEXPR const Quantity<NUMERIC_TRAITS, TRAIT> operator-(
         const Quantity<NUMERIC_TRAITS, TRAIT>& lhs,
-        const Quantity<NUMERIC_TRAITS, TRAIT>& rhs)
+        const Quantity<NUMERIC_TRAITS, TRAIT>& rhs) CPPTOOLS_NOEXCEPT
 {
-    return Quantity<NUMERIC_TRAITS, TRAIT>(lhs) -= rhs;
+    return Quantity<NUMERIC_TRAITS, TRAIT>(lhs.value() - rhs.value());
 }
 
 //! \relates Quantity
 template<typename NUMERIC_TRAITS, typename TRAIT>
-const Quantity<NUMERIC_TRAITS, TRAIT> operator-(
+CPPTOOLS_CONSTEXPR const Quantity<NUMERIC_TRAITS, TRAIT> operator-(
         const Quantity<NUMERIC_TRAITS, TRAIT>& lhs,
-        typename NUMERIC_TRAITS::Type k)
+        typename NUMERIC_TRAITS::Type k) CPPTOOLS_NOEXCEPT
 {
-    return Quantity<NUMERIC_TRAITS, TRAIT>(lhs) -= k;
+    return Quantity<NUMERIC_TRAITS, TRAIT>(lhs.value() - k);
 }
 
 //! \relates Quantity
 template<typename NUMERIC_TRAITS, typename TRAIT>
-const Quantity<NUMERIC_TRAITS, TRAIT> operator-(
+CPPTOOLS_CONSTEXPR const Quantity<NUMERIC_TRAITS, TRAIT> operator-(
         typename NUMERIC_TRAITS::Type k,
-        const Quantity<NUMERIC_TRAITS, TRAIT>& rhs)
+        const Quantity<NUMERIC_TRAITS, TRAIT>& rhs) CPPTOOLS_NOEXCEPT
 {
-    return Quantity<NUMERIC_TRAITS, TRAIT>(rhs) -= k;
+    return Quantity<NUMERIC_TRAITS, TRAIT>(rhs.value() - k);
 }
 
 // Operator *
 
 //! \relates Quantity
 template<typename NUMERIC_TRAITS, typename TRAIT>
-const Quantity<NUMERIC_TRAITS, TRAIT> operator*(
+CPPTOOLS_CONSTEXPR typename internal::QuantitySameTraitResult<NUMERIC_TRAITS, TRAIT>::type
+operator*(
         const Quantity<NUMERIC_TRAITS, TRAIT>& lhs,
-        const Quantity<NUMERIC_TRAITS, TRAIT>& rhs)
+        const Quantity<NUMERIC_TRAITS, TRAIT>& rhs) CPPTOOLS_NOEXCEPT
 {
-    return Quantity<NUMERIC_TRAITS, TRAIT>(lhs) *= rhs;
+    return Quantity<NUMERIC_TRAITS, TRAIT>(lhs.value() * rhs.value());
 }
 
 //! \relates Quantity
 template<typename NUMERIC_TRAITS, typename TRAIT>
-const Quantity<NUMERIC_TRAITS, TRAIT> operator*(
+CPPTOOLS_CONSTEXPR const Quantity<NUMERIC_TRAITS, TRAIT> operator*(
         const Quantity<NUMERIC_TRAITS, TRAIT>& lhs,
-        typename NUMERIC_TRAITS::Type k)
+        typename NUMERIC_TRAITS::Type k) CPPTOOLS_NOEXCEPT
 {
-    return Quantity<NUMERIC_TRAITS, TRAIT>(lhs) *= k;
+    return Quantity<NUMERIC_TRAITS, TRAIT>(lhs.value() * k);
 }
 
 //! \relates Quantity
 template<typename NUMERIC_TRAITS, typename TRAIT>
-const Quantity<NUMERIC_TRAITS, TRAIT> operator*(
+CPPTOOLS_CONSTEXPR const Quantity<NUMERIC_TRAITS, TRAIT> operator*(
         typename NUMERIC_TRAITS::Type k,
-        const Quantity<NUMERIC_TRAITS, TRAIT>& rhs)
+        const Quantity<NUMERIC_TRAITS, TRAIT>& rhs) CPPTOOLS_NOEXCEPT
 {
-    return Quantity<NUMERIC_TRAITS, TRAIT>(rhs) *= k;
+    return Quantity<NUMERIC_TRAITS, TRAIT>(rhs.value() * k);
+}
+
+// Operator * (dimensioned quantities)
+
+//! \relates Quantity
+template<typename NUMERIC_TRAITS, int... LHS_EXPONENTS, int... RHS_EXPONENTS>
+CPPTOOLS_CONSTEXPR const Quantity<
+    NUMERIC_TRAITS, QuantityDimension<(LHS_EXPONENTS + RHS_EXPONENTS)...>>
+operator*(
+        const Quantity<NUMERIC_TRAITS, QuantityDimension<LHS_EXPONENTS...>>& lhs,
+        const Quantity<NUMERIC_TRAITS, QuantityDimension<RHS_EXPONENTS...>>& rhs) CPPTOOLS_NOEXCEPT
+{
+    return Quantity<
+            NUMERIC_TRAITS, QuantityDimension<(LHS_EXPONENTS + RHS_EXPONENTS)...>>(
+                lhs.value() * rhs.value());
 }
 
 // Operator /
 
 //! \relates Quantity
 template<typename NUMERIC_TRAITS, typename TRAIT>
-const Quantity<NUMERIC_TRAITS, TRAIT> operator/(
+CPPTOOLS_CONSTEXPR typename internal::QuantitySameTraitResult<NUMERIC_TRAITS, TRAIT>::type
+operator/(
         const Quantity<NUMERIC_TRAITS, TRAIT>& lhs,
-        const Quantity<NUMERIC_TRAITS, TRAIT>& rhs)
+        const Quantity<NUMERIC_TRAITS, TRAIT>& rhs) CPPTOOLS_NOEXCEPT
 {
-    return Quantity<NUMERIC_TRAITS, TRAIT>(lhs) /= rhs;
+    return Quantity<NUMERIC_TRAITS, TRAIT>(lhs.value() / rhs.value());
 }
 
 //! \relates Quantity
 template<typename NUMERIC_TRAITS, typename TRAIT>
-const Quantity<NUMERIC_TRAITS, TRAIT> operator/(
+CPPTOOLS_CONSTEXPR const Quantity<NUMERIC_TRAITS, TRAIT> operator/(
         const Quantity<NUMERIC_TRAITS, TRAIT>& lhs,
-        typename NUMERIC_TRAITS::Type k)
+        typename NUMERIC_TRAITS::Type k) CPPTOOLS_NOEXCEPT
 {
-    return Quantity<NUMERIC_TRAITS, TRAIT>(lhs) /= k;
+    return Quantity<NUMERIC_TRAITS, TRAIT>(lhs.value() / k);
 }
 
 //! \relates Quantity
 template<typename NUMERIC_TRAITS, typename TRAIT>
-const Quantity<NUMERIC_TRAITS, TRAIT> operator/(
+CPPTOOLS_CONSTEXPR const Quantity<NUMERIC_TRAITS, TRAIT> operator/(
         typename NUMERIC_TRAITS::Type k,
-        const Quantity<NUMERIC_TRAITS, TRAIT>& rhs)
+        const Quantity<NUMERIC_TRAITS, TRAIT>& rhs) CPPTOOLS_NOEXCEPT
+{
+    return Quantity<NUMERIC_TRAITS, TRAIT>(rhs.value() / k);
+}
+
+// Operator / (dimensioned quantities)
+
+//! \relates Quantity
+template<typename NUMERIC_TRAITS, int... LHS_EXPONENTS, int... RHS_EXPONENTS>
+CPPTOOLS_CONSTEXPR const Quantity<
+    NUMERIC_TRAITS, QuantityDimension<(LHS_EXPONENTS - RHS_EXPONENTS)...>>
+operator/(
+        const Quantity<NUMERIC_TRAITS, QuantityDimension<LHS_EXPONENTS...>>& lhs,
+        const Quantity<NUMERIC_TRAITS, QuantityDimension<RHS_EXPONENTS...>>& rhs) CPPTOOLS_NOEXCEPT
 {
-    return Quantity<NUMERIC_TRAITS, TRAIT>(rhs) /= k;
+    return Quantity<
+            NUMERIC_TRAITS, QuantityDimension<(LHS_EXPONENTS - RHS_EXPONENTS)...>>(
+                lhs.value() / rhs.value());
 }
 
 } // namespace cpp
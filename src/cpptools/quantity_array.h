@@ -0,0 +1,183 @@
+/****************************************************************************
+**  FougTools
+**  Copyright Fougue (1 Mar. 2011)
+**  contact@fougue.pro
+**
+** This software is a computer program whose purpose is to provide utility
+** tools for the C++ language and the Qt toolkit.
+**
+** This software is governed by the CeCILL-C license under French law and
+** abiding by the rules of distribution of free software.  You can  use,
+** modify and/ or redistribute the software under the terms of the CeCILL-C
+** license as circulated by CEA, CNRS and INRIA at the following URL
+** "http://www.cecill.info".
+****************************************************************************/
+
+
+#pragma once
+
+#include "quantity.h"
+
+#include <cstddef>
+#include <vector>
+
+namespace cpp {
+
+/*! \brief Contiguous array of Quantity values stored as raw numbers
+ *
+ *  Values are kept in one buffer of NumericType (see data()), so batch
+ *  operations such as unit conversions run as a single loop the compiler can
+ *  vectorize. Items are read and written as QUANTITY objects (by value), which
+ *  keeps the unit type safety of Quantity.
+ *
+ *  \headerfile quantity_array.h <cpptools/quantity_array.h>
+ *  \ingroup cpptools
+ */
+template<typename QUANTITY>
+class QuantityArray
+{
+public:
+    typedef QUANTITY QuantityType;
+    typedef typename QUANTITY::NumericType NumericType;
+    typedef std::size_t size_type;
+
+    QuantityArray();
+    explicit QuantityArray(size_type count, QuantityType qty = QuantityType());
+
+    // Measurement
+    bool empty() const;
+    size_type size() const;
+
+    // Access
+    QuantityType operator[](size_type i) const;
+    QuantityType at(size_type i) const;
+    void set(size_type i, QuantityType qty);
+
+    const NumericType* data() const;
+    NumericType* data();
+
+    // Element change
+    void push_back(QuantityType qty);
+    void resize(size_type count, QuantityType qty = QuantityType());
+    void reserve(size_type count);
+    void clear();
+
+    // Batch operations
+    void scale(NumericType factor);
+    void scaledCopy(NumericType factor, NumericType* out) const;
+
+private:
+    std::vector<NumericType> m_values;
+};
+
+
+// --
+// -- Implementation
+// --
+
+template<typename QUANTITY>
+QuantityArray<QUANTITY>::QuantityArray()
+{
+}
+
+template<typename QUANTITY>
+QuantityArray<QUANTITY>::QuantityArray(size_type count, QuantityType qty)
+    : m_values(count, qty.value())
+{
+}
+
+template<typename QUANTITY>
+bool QuantityArray<QUANTITY>::empty() const
+{
+    return m_values.empty();
+}
+
+template<typename QUANTITY>
+typename QuantityArray<QUANTITY>::size_type QuantityArray<QUANTITY>::size() const
+{
+    return m_values.size();
+}
+
+template<typename QUANTITY>
+QUANTITY QuantityArray<QUANTITY>::operator[](size_type i) const
+{
+    return QuantityType(m_values[i]);
+}
+
+//! Same as operator[] but throws std::out_of_range if \p i is invalid
+template<typename QUANTITY>
+QUANTITY QuantityArray<QUANTITY>::at(size_type i) const
+{
+    return QuantityType(m_values.at(i));
+}
+
+template<typename QUANTITY>
+void QuantityArray<QUANTITY>::set(size_type i, QuantityType qty)
+{
+    m_values[i] = qty.value();
+}
+
+//! Underlying buffer of raw numbers, size() items
+template<typename QUANTITY>
+const typename QuantityArray<QUANTITY>::NumericType*
+QuantityArray<QUANTITY>::data() const
+{
+    return m_values.data();
+}
+
+template<typename QUANTITY>
+typename QuantityArray<QUANTITY>::NumericType* QuantityArray<QUANTITY>::data()
+{
+    return m_values.data();
+}
+
+template<typename QUANTITY>
+void QuantityArray<QUANTITY>::push_back(QuantityType qty)
+{
+    m_values.push_back(qty.value());
+}
+
+template<typename QUANTITY>
+void QuantityArray<QUANTITY>::resize(size_type count, QuantityType qty)
+{
+    m_values.resize(count, qty.value());
+}
+
+template<typename QUANTITY>
+void QuantityArray<QUANTITY>::reserve(size_type count)
+{
+    m_values.reserve(count);
+}
+
+template<typename QUANTITY>
+void QuantityArray<QUANTITY>::clear()
+{
+    m_values.clear();
+}
+
+//! Multiplies all values by \p factor, in place
+template<typename QUANTITY>
+void QuantityArray<QUANTITY>::scale(NumericType factor)
+{
+    NumericType* values = m_values.data();
+    const size_type count = m_values.size();
+    for (size_type i = 0; i < count; ++i)
+        values[i] *= factor;
+}
+
+/*! Writes all values multiplied by \p factor into \p out, which must have
+ *  room for size() numbers
+ *
+ *  Typical use is the conversion of values into some display unit, \p factor
+ *  being the amount of display unit in one unit of the array values.
+ */
+template<typename QUANTITY>
+void QuantityArray<QUANTITY>::scaledCopy(NumericType factor, NumericType* out) const
+{
+    const NumericType* values = m_values.data();
+    const size_type count = m_values.size();
+    for (size_type i = 0; i < count; ++i)
+        out[i] = values[i] * factor;
+}
+
+} // namespace cpp
@@ -0,0 +1,526 @@
+/****************************************************************************
+**  FougTools
+**  Copyright Fougue (30 Mar. 2015)
+**  contact@fougue.pro
+**
+** This software is a computer program whose purpose is to provide utility
+** tools for the C++ language and the Qt toolkit.
+**
+** This software is governed by the CeCILL-C license under French law and
+** abiding by the rules of distribution of free software.  You can  use,
+** modify and/ or redistribute the software under the terms of the CeCILL-C
+** license as circulated by CEA, CNRS and INRIA at the following URL
+** "http://www.cecill.info".
+****************************************************************************/
+
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+#include <vector>
+
+namespace cpp {
+
+namespace internal {
+
+inline std::size_t ringBufferCapacity(std::size_t minCapacity)
+{
+    std::size_t capacity = 1;
+    while (capacity < minCapacity)
+        capacity *= 2;
+    return capacity;
+}
+
+/*! Copies \p count items of \p values in \p ring starting at counter
+ *  \p pos : at most two contiguous copies, no per-item wrap-around test
+ */
+template<typename T, typename RANDOM_ACCESS_ITERATOR>
+void ringBufferWrite(
+        std::vector<T>* ring,
+        std::size_t pos,
+        RANDOM_ACCESS_ITERATOR values,
+        std::size_t count)
+{
+    static_assert(
+            std::is_base_of<
+                std::random_access_iterator_tag,
+                typename std::iterator_traits<RANDOM_ACCESS_ITERATOR>::iterator_category>::value,
+            "values must be a random access iterator");
+    const std::size_t capacity = ring->size();
+    const std::size_t slotId = pos & (capacity - 1);
+    const std::size_t countOne = std::min(count, capacity - slotId);
+    std::copy(values, values + countOne, ring->begin() + slotId);
+    std::copy(values + countOne, values + count, ring->begin());
+}
+
+//! Inverse of ringBufferWrite()
+template<typename T, typename OUTPUT_ITERATOR>
+OUTPUT_ITERATOR ringBufferRead(
+        std::vector<T>* ring, std::size_t pos, OUTPUT_ITERATOR out, std::size_t count)
+{
+    const std::size_t capacity = ring->size();
+    const std::size_t slotId = pos & (capacity - 1);
+    const std::size_t countOne = std::min(count, capacity - slotId);
+    out = std::move(ring->begin() + slotId, ring->begin() + slotId + countOne, out);
+    return std::move(ring->begin(), ring->begin() + (count - countOne), out);
+}
+
+} // namespace internal
+
+template<typename T>
+class RingBuffer
+{
+public:
+    template<typename VALUE, typename RING_BUFFER>
+    class Iterator;
+
+    // STL compatibility
+    typedef T value_type;
+    typedef T& reference;
+    typedef const T& const_reference;
+    typedef std::size_t size_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef Iterator<T, RingBuffer<T>> iterator;
+    typedef Iterator<const T, const RingBuffer<T>> const_iterator;
+
+    explicit RingBuffer(size_type minCapacity);
+
+    // Iteration (from oldest to newest item)
+    const_iterator begin() const;
+    iterator begin();
+    const_iterator end() const;
+    iterator end();
+
+    // Measurement
+    bool empty() const;
+    bool full() const;
+    size_type size() const;
+    size_type capacity() const;
+
+    // Access (index 0 is the oldest item)
+    T& operator[](size_type i);
+    const T& operator[](size_type i) const;
+    T& front();
+    const T& front() const;
+    T& back();
+    const T& back() const;
+
+    // Element change
+    void push_back(const T& value);
+    void push_back(T&& value);
+    void pushOverwrite(const T& value);
+    void pop_front();
+    void clear();
+
+    template<typename RANDOM_ACCESS_ITERATOR>
+    size_type push(RANDOM_ACCESS_ITERATOR values, size_type count);
+    template<typename OUTPUT_ITERATOR>
+    size_type pop(OUTPUT_ITERATOR out, size_type count);
+
+    //! Random access iterator over the items of a RingBuffer
+    template<typename VALUE, typename RING_BUFFER>
+    class Iterator
+    {
+    public:
+        typedef std::random_access_iterator_tag iterator_category;
+        typedef typename std::remove_const<VALUE>::type value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef VALUE* pointer;
+        typedef VALUE& reference;
+
+        Iterator()
+            : m_ringBuffer(NULL), m_pos(0)
+        { }
+
+        Iterator(RING_BUFFER* ringBuffer, std::size_t pos)
+            : m_ringBuffer(ringBuffer), m_pos(pos)
+        { }
+
+        // const_iterator from iterator
+        template<typename OTHER_VALUE, typename OTHER_RING_BUFFER>
+        Iterator(const Iterator<OTHER_VALUE, OTHER_RING_BUFFER>& other)
+            : m_ringBuffer(other.m_ringBuffer), m_pos(other.m_pos)
+        { }
+
+        VALUE& operator*() const
+        { return m_ringBuffer->slot(m_pos); }
+        VALUE* operator->() const
+        { return &m_ringBuffer->slot(m_pos); }
+        VALUE& operator[](std::ptrdiff_t d) const
+        { return m_ringBuffer->slot(m_pos + d); }
+
+        Iterator& operator++() { ++m_pos; return *this; }
+        Iterator& operator--() { --m_pos; return *this; }
+        Iterator operator++(int) { Iterator it(*this); ++m_pos; return it; }
+        Iterator operator--(int) { Iterator it(*this); --m_pos; return it; }
+        Iterator& operator+=(std::ptrdiff_t d) { m_pos += d; return *this; }
+        Iterator& operator-=(std::ptrdiff_t d) { m_pos -= d; return *this; }
+        Iterator operator+(std::ptrdiff_t d) const { return Iterator(m_ringBuffer, m_pos + d); }
+        Iterator operator-(std::ptrdiff_t d) const { return Iterator(m_ringBuffer, m_pos - d); }
+
+        std::ptrdiff_t operator-(const Iterator& other) const
+        { return static_cast<std::ptrdiff_t>(m_pos - other.m_pos); }
+
+        // Counters may wrap around, so comparison is on the distance
+        bool operator==(const Iterator& other) const { return m_pos == other.m_pos; }
+        bool operator!=(const Iterator& other) const { return m_pos != other.m_pos; }
+        bool operator<(const Iterator& other) const { return (*this - other) < 0; }
+        bool operator>(const Iterator& other) const { return (*this - other) > 0; }
+        bool operator<=(const Iterator& other) const { return (*this - other) <= 0; }
+        bool operator>=(const Iterator& other) const { return (*this - other) >= 0; }
+
+    private:
+        template<typename, typename> friend class Iterator;
+
+        RING_BUFFER* m_ringBuffer;
+        std::size_t m_pos;
+    };
+
+private:
+    T& slot(size_type pos);
+    const T& slot(size_type pos) const;
+
+    std::vector<T> m_slots;
+    size_type m_mask;
+    size_type m_head; // Counter of the oldest item
+    size_type m_tail; // Counter past the newest item
+};
+
+/*! \brief Lock-free ring buffer for one producer thread and one consumer thread
+ *
+ *  The producer thread calls only tryPush(), the consumer thread only
+ *  tryPop(), without any lock. Capacity is fixed and rounded up to a power of
+ *  two.
+ *
+ *  \headerfile ring_buffer.h <cpptools/ring_buffer.h>
+ *  \ingroup cpptools
+ */
+template<typename T>
+class SpscRingBuffer
+{
+public:
+    typedef std::size_t size_type;
+
+    explicit SpscRingBuffer(size_type minCapacity);
+
+    size_type capacity() const;
+    size_type sizeApprox() const;
+
+    // Producer
+    bool tryPush(const T& value);
+    bool tryPush(T&& value);
+    template<typename RANDOM_ACCESS_ITERATOR>
+    size_type tryPush(RANDOM_ACCESS_ITERATOR values, size_type count);
+
+    // Consumer
+    bool tryPop(T* value);
+    template<typename OUTPUT_ITERATOR>
+    size_type tryPop(OUTPUT_ITERATOR out, size_type count);
+
+private:
+    SpscRingBuffer(const SpscRingBuffer&);
+    SpscRingBuffer& operator=(const SpscRingBuffer&);
+
+    // Head and tail are written by different threads, padding keeps them in
+    // separate cache lines (no false sharing)
+    static const std::size_t cacheLineSize = 64;
+
+    std::vector<T> m_slots;
+    const size_type m_mask;
+    char m_padding0[cacheLineSize];
+    std::atomic<size_type> m_head; // Written by the consumer
+    char m_padding1[cacheLineSize];
+    std::atomic<size_type> m_tail; // Written by the producer
+    char m_padding2[cacheLineSize];
+};
+
+//
+// Implementation
+//
+
+/*!
+ * \class RingBuffer
+ * \brief Fixed-capacity circular queue
+ *
+ * Capacity is rounded up to a power of two, so the slot of an item is found
+ * with a bit mask on unbounded head/tail counters : no wrap-around branches
+ * as with circularNext()/circularPrior() over a std::vector.
+ *
+ * push()/pop() copy ranges of items with at most two contiguous copies.
+ *
+ * T must be default constructible, popped items are moved out of their slots.
+ *
+ * \headerfile ring_buffer.h <cpptools/ring_buffer.h>
+ * \ingroup cpptools
+ */
+
+template<typename T>
+RingBuffer<T>::RingBuffer(size_type minCapacity)
+    : m_slots(internal::ringBufferCapacity(minCapacity)),
+      m_mask(m_slots.size() - 1),
+      m_head(0),
+      m_tail(0)
+{
+}
+
+template<typename T>
+typename RingBuffer<T>::const_iterator RingBuffer<T>::begin() const
+{
+    return const_iterator(this, m_head);
+}
+
+template<typename T>
+typename RingBuffer<T>::iterator RingBuffer<T>::begin()
+{
+    return iterator(this, m_head);
+}
+
+template<typename T>
+typename RingBuffer<T>::const_iterator RingBuffer<T>::end() const
+{
+    return const_iterator(this, m_tail);
+}
+
+template<typename T>
+typename RingBuffer<T>::iterator RingBuffer<T>::end()
+{
+    return iterator(this, m_tail);
+}
+
+template<typename T>
+bool RingBuffer<T>::empty() const
+{
+    return m_head == m_tail;
+}
+
+template<typename T>
+bool RingBuffer<T>::full() const
+{
+    return this->size() == this->capacity();
+}
+
+template<typename T>
+typename RingBuffer<T>::size_type RingBuffer<T>::size() const
+{
+    return m_tail - m_head;
+}
+
+template<typename T>
+typename RingBuffer<T>::size_type RingBuffer<T>::capacity() const
+{
+    return m_slots.size();
+}
+
+template<typename T>
+T& RingBuffer<T>::operator[](size_type i)
+{
+    assert(i < this->size());
+    return this->slot(m_head + i);
+}
+
+template<typename T>
+const T& RingBuffer<T>::operator[](size_type i) const
+{
+    assert(i < this->size());
+    return this->slot(m_head + i);
+}
+
+template<typename T>
+T& RingBuffer<T>::front()
+{
+    return (*this)[0];
+}
+
+template<typename T>
+const T& RingBuffer<T>::front() const
+{
+    return (*this)[0];
+}
+
+template<typename T>
+T& RingBuffer<T>::back()
+{
+    return (*this)[this->size() - 1];
+}
+
+template<typename T>
+const T& RingBuffer<T>::back() const
+{
+    return (*this)[this->size() - 1];
+}
+
+//! Appends \p value, the buffer must not be full
+template<typename T>
+void RingBuffer<T>::push_back(const T& value)
+{
+    assert(!this->full());
+    this->slot(m_tail) = value;
+    ++m_tail;
+}
+
+template<typename T>
+void RingBuffer<T>::push_back(T&& value)
+{
+    assert(!this->full());
+    this->slot(m_tail) = std::move(value);
+    ++m_tail;
+}
+
+//! Appends \p value, the oldest item is dropped if the buffer is full
+template<typename T>
+void RingBuffer<T>::pushOverwrite(const T& value)
+{
+    if (this->full())
+        ++m_head;
+    this->slot(m_tail) = value;
+    ++m_tail;
+}
+
+template<typename T>
+void RingBuffer<T>::pop_front()
+{
+    assert(!this->empty());
+    ++m_head;
+}
+
+template<typename T>
+void RingBuffer<T>::clear()
+{
+    m_head = m_tail;
+}
+
+/*! Appends at most \p count items of the random access range starting at
+ *  \p values, as many as free slots allow
+ *
+ *  \returns The count of items actually appended
+ */
+template<typename T>
+template<typename RANDOM_ACCESS_ITERATOR>
+typename RingBuffer<T>::size_type
+RingBuffer<T>::push(RANDOM_ACCESS_ITERATOR values, size_type count)
+{
+    const size_type pushCount = std::min(count, this->capacity() - this->size());
+    internal::ringBufferWrite(&m_slots, m_tail, values, pushCount);
+    m_tail += pushCount;
+    return pushCount;
+}
+
+/*! Removes at most \p count oldest items, they are moved to \p out
+ *
+ *  \returns The count of items actually removed
+ */
+template<typename T>
+template<typename OUTPUT_ITERATOR>
+typename RingBuffer<T>::size_type
+RingBuffer<T>::pop(OUTPUT_ITERATOR out, size_type count)
+{
+    const size_type popCount = std::min(count, this->size());
+    internal::ringBufferRead(&m_slots, m_head, out, popCount);
+    m_head += popCount;
+    return popCount;
+}
+
+template<typename T>
+T& RingBuffer<T>::slot(size_type pos)
+{
+    return m_slots[pos & m_mask];
+}
+
+template<typename T>
+const T& RingBuffer<T>::slot(size_type pos) const
+{
+    return m_slots[pos & m_mask];
+}
+
+// SpscRingBuffer
+
+template<typename T>
+SpscRingBuffer<T>::SpscRingBuffer(size_type minCapacity)
+    : m_slots(internal::ringBufferCapacity(minCapacity)),
+      m_mask(m_slots.size() - 1),
+      m_head(0),
+      m_tail(0)
+{
+}
+
+template<typename T>
+typename SpscRingBuffer<T>::size_type SpscRingBuffer<T>::capacity() const
+{
+    return m_slots.size();
+}
+
+//! Count of items, already outdated if the other thread is active
+template<typename T>
+typename SpscRingBuffer<T>::size_type SpscRingBuffer<T>::sizeApprox() const
+{
+    return m_tail.load(std::memory_order_acquire) - m_head.load(std::memory_order_acquire);
+}
+
+//! Appends \p value if the buffer is not full, to be called by the producer
+template<typename T>
+bool SpscRingBuffer<T>::tryPush(const T& value)
+{
+    return this->tryPush(&value, 1) == 1;
+}
+
+template<typename T>
+bool SpscRingBuffer<T>::tryPush(T&& value)
+{
+    const size_type tail = m_tail.load(std::memory_order_relaxed);
+    const size_type head = m_head.load(std::memory_order_acquire);
+    if (tail - head >= this->capacity())
+        return false;
+    m_slots[tail & m_mask] = std::move(value);
+    m_tail.store(tail + 1, std::memory_order_release);
+    return true;
+}
+
+/*! Appends at most \p count items of the random access range starting at
+ *  \p values, to be called by the producer
+ *
+ *  \returns The count of items actually appended
+ */
+template<typename T>
+template<typename RANDOM_ACCESS_ITERATOR>
+typename SpscRingBuffer<T>::size_type
+SpscRingBuffer<T>::tryPush(RANDOM_ACCESS_ITERATOR values, size_type count)
+{
+    const size_type tail = m_tail.load(std::memory_order_relaxed);
+    const size_type head = m_head.load(std::memory_order_acquire);
+    const size_type pushCount = std::min(count, this->capacity() - (tail - head));
+    internal::ringBufferWrite(&m_slots, tail, values, pushCount);
+    m_tail.store(tail + pushCount, std::memory_order_release);
+    return pushCount;
+}
+
+//! Removes the oldest item into \p value if any, to be called by the consumer
+template<typename T>
+bool SpscRingBuffer<T>::tryPop(T* value)
+{
+    return this->tryPop(value, 1) == 1;
+}
+
+/*! Removes at most \p count oldest items, they are moved to \p out. To be
+ *  called by the consumer
+ *
+ *  \returns The count of items actually removed
+ */
+template<typename T>
+template<typename OUTPUT_ITERATOR>
+typename SpscRingBuffer<T>::size_type
+SpscRingBuffer<T>::tryPop(OUTPUT_ITERATOR out, size_type count)
+{
+    const size_type head = m_head.load(std::memory_order_relaxed);
+    const size_type tail = m_tail.load(std::memory_order_acquire);
+    const size_type popCount = std::min(count, tail - head);
+    internal::ringBufferRead(&m_slots, head, out, popCount);
+    m_head.store(head + popCount, std::memory_order_release);
+    return popCount;
+}
+
+} // namespace cpp
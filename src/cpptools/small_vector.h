@@ -0,0 +1,512 @@
+/****************************************************************************
+**  FougTools
+**  Copyright Fougue (30 Mar. 2015)
+**  contact@fougue.pro
+**
+** This software is a computer program whose purpose is to provide utility
+** tools for the C++ language and the Qt toolkit.
+**
+** This software is governed by the CeCILL-C license under French law and
+** abiding by the rules of distribution of free software.  You can  use,
+** modify and/ or redistribute the software under the terms of the CeCILL-C
+** license as circulated by CEA, CNRS and INRIA at the following URL
+** "http://www.cecill.info".
+****************************************************************************/
+
+
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace cpp {
+
+template<typename T, std::size_t N>
+class SmallVector
+{
+private:
+    typedef SmallVector<T, N> Self_t;
+
+public:
+    // STL compatibility
+    typedef T value_type;
+    typedef T* pointer;
+    typedef T& reference;
+    typedef const T* const_pointer;
+    typedef const T& const_reference;
+    typedef std::size_t size_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef T* iterator;
+    typedef const T* const_iterator;
+
+    // Ctor
+    SmallVector();
+    explicit SmallVector(size_type count, const T& value = T());
+    SmallVector(std::initializer_list<T> values);
+    // Disabled for integral types, SmallVector(3, 5) is (count, value)
+    template<typename INPUT_ITERATOR,
+             typename = typename std::enable_if<
+                 !std::is_integral<INPUT_ITERATOR>::value>::type>
+    SmallVector(INPUT_ITERATOR first, INPUT_ITERATOR last);
+    SmallVector(const Self_t& other);
+    SmallVector(Self_t&& other);
+    ~SmallVector();
+
+    Self_t& operator=(const Self_t& other);
+    Self_t& operator=(Self_t&& other);
+
+    // Iteration
+    const_iterator begin() const;
+    iterator begin();
+    const_iterator end() const;
+    iterator end();
+
+    // Measurement
+    bool empty() const;
+    size_type size() const;
+    size_type capacity() const;
+    bool isInline() const;
+    static size_type inlineCapacity();
+
+    // Access
+    T& operator[](size_type i);
+    const T& operator[](size_type i) const;
+    T& front();
+    const T& front() const;
+    T& back();
+    const T& back() const;
+    T* data();
+    const T* data() const;
+
+    // Element change
+    void push_back(const T& value);
+    void push_back(T&& value);
+    template<typename... ARGS>
+    T& emplace_back(ARGS&&... args);
+    void pop_back();
+    iterator erase(const_iterator pos);
+    iterator erase(const_iterator first, const_iterator last);
+    void clear();
+    void resize(size_type count);
+    void resize(size_type count, const T& value);
+    void reserve(size_type newCapacity);
+    void swap(Self_t& other);
+
+private:
+    typedef typename std::aligned_storage<
+        sizeof(T), std::alignment_of<T>::value>::type Storage;
+
+    T* inlineData();
+    void growFor(size_type minCapacity);
+    void reallocate(size_type newCapacity);
+    void destroyAll();
+    void moveFrom(Self_t& other);
+
+    T* m_data;
+    size_type m_size;
+    size_type m_capacity;
+    Storage m_inlineStorage[N > 0 ? N : 1];
+};
+
+template<typename T, std::size_t N>
+bool operator==(const SmallVector<T, N>& lhs, const SmallVector<T, N>& rhs);
+template<typename T, std::size_t N>
+bool operator!=(const SmallVector<T, N>& lhs, const SmallVector<T, N>& rhs);
+
+//
+// Implementation
+//
+
+/*!
+ * \class SmallVector
+ * \brief Dynamic array storing up to N items inline, without heap allocation
+ *
+ * SmallVector has the interface of std::vector (subset), items are stored in
+ * a buffer inside the object while there are at most N of them, beyond that
+ * they are moved to heap memory (which is kept until destruction, as with
+ * std::vector).
+ *
+ * This suits temporary collections that are small most of the time (ex:
+ * faces around a vertex, neighbours in graph explorations).
+ *
+ * \note Unlike std::vector, the move of an inline SmallVector moves the items,
+ *       so iterators and pointers on items are invalidated
+ *
+ * \headerfile small_vector.h <cpptools/small_vector.h>
+ * \ingroup cpptools
+ */
+
+template<typename T, std::size_t N>
+SmallVector<T, N>::SmallVector()
+    : m_data(inlineData()),
+      m_size(0),
+      m_capacity(N)
+{
+}
+
+template<typename T, std::size_t N>
+SmallVector<T, N>::SmallVector(size_type count, const T& value)
+    : m_data(inlineData()),
+      m_size(0),
+      m_capacity(N)
+{
+    this->resize(count, value);
+}
+
+template<typename T, std::size_t N>
+SmallVector<T, N>::SmallVector(std::initializer_list<T> values)
+    : m_data(inlineData()),
+      m_size(0),
+      m_capacity(N)
+{
+    this->reserve(values.size());
+    for (const T& value : values)
+        this->push_back(value);
+}
+
+template<typename T, std::size_t N>
+template<typename INPUT_ITERATOR, typename>
+SmallVector<T, N>::SmallVector(INPUT_ITERATOR first, INPUT_ITERATOR last)
+    : m_data(inlineData()),
+      m_size(0),
+      m_capacity(N)
+{
+    for (; first != last; ++first)
+        this->emplace_back(*first);
+}
+
+template<typename T, std::size_t N>
+SmallVector<T, N>::SmallVector(const Self_t& other)
+    : m_data(inlineData()),
+      m_size(0),
+      m_capacity(N)
+{
+    this->reserve(other.size());
+    for (const T& value : other)
+        this->push_back(value);
+}
+
+template<typename T, std::size_t N>
+SmallVector<T, N>::SmallVector(Self_t&& other)
+    : m_data(inlineData()),
+      m_size(0),
+      m_capacity(N)
+{
+    this->moveFrom(other);
+}
+
+template<typename T, std::size_t N>
+SmallVector<T, N>::~SmallVector()
+{
+    this->destroyAll();
+    if (!this->isInline())
+        ::operator delete(m_data);
+}
+
+template<typename T, std::size_t N>
+SmallVector<T, N>& SmallVector<T, N>::operator=(const Self_t& other)
+{
+    if (this != &other) {
+        this->clear();
+        this->reserve(other.size());
+        for (const T& value : other)
+            this->push_back(value);
+    }
+    return *this;
+}
+
+template<typename T, std::size_t N>
+SmallVector<T, N>& SmallVector<T, N>::operator=(Self_t&& other)
+{
+    if (this != &other) {
+        this->clear();
+        if (!this->isInline()) {
+            ::operator delete(m_data);
+            m_data = inlineData();
+            m_capacity = N;
+        }
+        this->moveFrom(other);
+    }
+    return *this;
+}
+
+template<typename T, std::size_t N>
+typename SmallVector<T, N>::const_iterator SmallVector<T, N>::begin() const
+{
+    return m_data;
+}
+
+template<typename T, std::size_t N>
+typename SmallVector<T, N>::iterator SmallVector<T, N>::begin()
+{
+    return m_data;
+}
+
+template<typename T, std::size_t N>
+typename SmallVector<T, N>::const_iterator SmallVector<T, N>::end() const
+{
+    return m_data + m_size;
+}
+
+template<typename T, std::size_t N>
+typename SmallVector<T, N>::iterator SmallVector<T, N>::end()
+{
+    return m_data + m_size;
+}
+
+template<typename T, std::size_t N>
+bool SmallVector<T, N>::empty() const
+{
+    return m_size == 0;
+}
+
+template<typename T, std::size_t N>
+typename SmallVector<T, N>::size_type SmallVector<T, N>::size() const
+{
+    return m_size;
+}
+
+template<typename T, std::size_t N>
+typename SmallVector<T, N>::size_type SmallVector<T, N>::capacity() const
+{
+    return m_capacity;
+}
+
+//! Returns true if items are stored in the inline buffer (no heap memory)
+template<typename T, std::size_t N>
+bool SmallVector<T, N>::isInline() const
+{
+    return m_data == reinterpret_cast<const T*>(m_inlineStorage);
+}
+
+template<typename T, std::size_t N>
+typename SmallVector<T, N>::size_type SmallVector<T, N>::inlineCapacity()
+{
+    return N;
+}
+
+template<typename T, std::size_t N>
+T& SmallVector<T, N>::operator[](size_type i)
+{
+    assert(i < m_size);
+    return m_data[i];
+}
+
+template<typename T, std::size_t N>
+const T& SmallVector<T, N>::operator[](size_type i) const
+{
+    assert(i < m_size);
+    return m_data[i];
+}
+
+template<typename T, std::size_t N>
+T& SmallVector<T, N>::front()
+{
+    return (*this)[0];
+}
+
+template<typename T, std::size_t N>
+const T& SmallVector<T, N>::front() const
+{
+    return (*this)[0];
+}
+
+template<typename T, std::size_t N>
+T& SmallVector<T, N>::back()
+{
+    return (*this)[m_size - 1];
+}
+
+template<typename T, std::size_t N>
+const T& SmallVector<T, N>::back() const
+{
+    return (*this)[m_size - 1];
+}
+
+template<typename T, std::size_t N>
+T* SmallVector<T, N>::data()
+{
+    return m_data;
+}
+
+template<typename T, std::size_t N>
+const T* SmallVector<T, N>::data() const
+{
+    return m_data;
+}
+
+template<typename T, std::size_t N>
+void SmallVector<T, N>::push_back(const T& value)
+{
+    this->emplace_back(value);
+}
+
+template<typename T, std::size_t N>
+void SmallVector<T, N>::push_back(T&& value)
+{
+    this->emplace_back(std::move(value));
+}
+
+template<typename T, std::size_t N>
+template<typename... ARGS>
+T& SmallVector<T, N>::emplace_back(ARGS&&... args)
+{
+    if (m_size == m_capacity) {
+        // Construct first, args may refer to an item of this vector
+        T value(std::forward<ARGS>(args)...);
+        this->growFor(m_size + 1);
+        new (m_data + m_size) T(std::move(value));
+    }
+    else {
+        new (m_data + m_size) T(std::forward<ARGS>(args)...);
+    }
+    ++m_size;
+    return this->back();
+}
+
+template<typename T, std::size_t N>
+void SmallVector<T, N>::pop_back()
+{
+    assert(m_size > 0);
+    --m_size;
+    m_data[m_size].~T();
+}
+
+template<typename T, std::size_t N>
+typename SmallVector<T, N>::iterator SmallVector<T, N>::erase(const_iterator pos)
+{
+    return this->erase(pos, pos + 1);
+}
+
+template<typename T, std::size_t N>
+typename SmallVector<T, N>::iterator SmallVector<T, N>::erase(
+        const_iterator first, const_iterator last)
+{
+    iterator itFirst = m_data + (first - m_data);
+    if (first != last) {
+        iterator itNewEnd = std::move(m_data + (last - m_data), this->end(), itFirst);
+        while (this->end() != itNewEnd)
+            this->pop_back();
+    }
+    return itFirst;
+}
+
+template<typename T, std::size_t N>
+void SmallVector<T, N>::clear()
+{
+    this->destroyAll();
+    m_size = 0;
+}
+
+template<typename T, std::size_t N>
+void SmallVector<T, N>::resize(size_type count)
+{
+    this->reserve(count);
+    while (m_size > count)
+        this->pop_back();
+    while (m_size < count)
+        this->emplace_back();
+}
+
+template<typename T, std::size_t N>
+void SmallVector<T, N>::resize(size_type count, const T& value)
+{
+    this->reserve(count);
+    while (m_size > count)
+        this->pop_back();
+    while (m_size < count)
+        this->emplace_back(value);
+}
+
+template<typename T, std::size_t N>
+void SmallVector<T, N>::reserve(size_type newCapacity)
+{
+    if (newCapacity > m_capacity)
+        this->reallocate(newCapacity);
+}
+
+template<typename T, std::size_t N>
+void SmallVector<T, N>::swap(Self_t& other)
+{
+    if (this != &other) {
+        Self_t tmp(std::move(other));
+        other = std::move(*this);
+        *this = std::move(tmp);
+    }
+}
+
+template<typename T, std::size_t N>
+T* SmallVector<T, N>::inlineData()
+{
+    return reinterpret_cast<T*>(m_inlineStorage);
+}
+
+template<typename T, std::size_t N>
+void SmallVector<T, N>::growFor(size_type minCapacity)
+{
+    const size_type doubleCapacity = 2 * m_capacity;
+    this->reallocate(std::max(minCapacity, doubleCapacity));
+}
+
+//! Moves the items to new heap memory of \p newCapacity items
+template<typename T, std::size_t N>
+void SmallVector<T, N>::reallocate(size_type newCapacity)
+{
+    T* newData = static_cast<T*>(::operator new(newCapacity * sizeof(T)));
+    for (size_type i = 0; i < m_size; ++i) {
+        new (newData + i) T(std::move_if_noexcept(m_data[i]));
+        m_data[i].~T();
+    }
+    if (!this->isInline())
+        ::operator delete(m_data);
+    m_data = newData;
+    m_capacity = newCapacity;
+}
+
+template<typename T, std::size_t N>
+void SmallVector<T, N>::destroyAll()
+{
+    for (size_type i = 0; i < m_size; ++i)
+        m_data[i].~T();
+}
+
+//! Takes over the items of \p other, this vector must be empty and inline
+template<typename T, std::size_t N>
+void SmallVector<T, N>::moveFrom(Self_t& other)
+{
+    if (other.isInline()) {
+        for (size_type i = 0; i < other.m_size; ++i)
+            new (m_data + i) T(std::move(other.m_data[i]));
+        m_size = other.m_size;
+        other.clear();
+    }
+    else {
+        // Steal the heap memory
+        m_data = other.m_data;
+        m_size = other.m_size;
+        m_capacity = other.m_capacity;
+        other.m_data = other.inlineData();
+        other.m_size = 0;
+        other.m_capacity = N;
+    }
+}
+
+template<typename T, std::size_t N>
+bool operator==(const SmallVector<T, N>& lhs, const SmallVector<T, N>& rhs)
+{
+    return lhs.size() == rhs.size() && std::equal(lhs.begin(), lhs.end(), rhs.begin());
+}
+
+template<typename T, std::size_t N>
+bool operator!=(const SmallVector<T, N>& lhs, const SmallVector<T, N>& rhs)
+{
+    return !(lhs == rhs);
+}
+
+} // namespace cpp
@@ -0,0 +1,373 @@
+/****************************************************************************
+**  FougTools
+**  Copyright Fougue (1 Mar. 2011)
+**  contact@fougue.pro
+**
+** This software is a computer program whose purpose is to provide utility
+** tools for the C++ language and the Qt toolkit.
+**
+** This software is governed by the CeCILL-C license under French law and
+** abiding by the rules of distribution of free software.  You can  use,
+** modify and/ or redistribute the software under the terms of the CeCILL-C
+** license as circulated by CEA, CNRS and INRIA at the following URL
+** "http://www.cecill.info".
+****************************************************************************/
+
+
+#pragma once
+
+#include "hash_fnv.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+
+namespace cpp {
+
+namespace internal {
+
+//! Smallest power of two greater or equal to N
+template<std::size_t N, std::size_t POW2 = 1, bool DONE = (POW2 >= N)>
+struct NextPowerOfTwo
+{ static const std::size_t value = NextPowerOfTwo<N, POW2 * 2>::value; };
+
+template<std::size_t N, std::size_t POW2>
+struct NextPowerOfTwo<N, POW2, true>
+{ static const std::size_t value = POW2; };
+
+} // namespace internal
+
+/*! \brief Fixed-size mapping between a C++ enum type values and C strings
+ *
+ *  StaticEnumStringMap provides the same lookup functions as EnumStringMap but
+ *  the N mappings are all given at construction and no heap allocation is
+ *  done :
+ *    \li value() uses a perfect hash of the strings (hash and displace
+ *        scheme over FNV-1a) : one hashing of the input string and one string
+ *        comparison
+ *    \li string() and index() use a table sorted by enum values. When enum
+ *        values are contiguous this is a direct access, otherwise a binary
+ *        search
+ *
+ *  Strings are not copied, they must outlive the StaticEnumStringMap object.
+ *  Typical use is a static constant object :
+ *  \code
+ *      enum class Status { Started, Running, Finished };
+ *
+ *      const cpp::StaticEnumStringMap<Status, 3>& statusStrMap()
+ *      {
+ *          static const cpp::StaticEnumStringMap<Status, 3>::Mapping mappings[] = {
+ *              { Status::Started,  "status_started" },
+ *              { Status::Running,  "status_running" },
+ *              { Status::Finished, "status_finished" }
+ *          };
+ *          static const cpp::StaticEnumStringMap<Status, 3> strMap(mappings);
+ *          return strMap;
+ *      }
+ *  \endcode
+ *
+ *  \headerfile static_enum_string_map.h <cpptools/static_enum_string_map.h>
+ *  \ingroup cpptools
+ */
+template<typename ENUM, std::size_t N>
+class StaticEnumStringMap
+{
+public:
+    static_assert(N > 0, "At least one mapping is required");
+
+    typedef std::pair<ENUM, const char*> Mapping;
+
+    explicit StaticEnumStringMap(const Mapping (&mappings)[N]);
+
+    std::size_t size() const;
+    std::size_t index(ENUM eval) const;
+
+    ENUM valueAt(std::size_t i) const;
+    ENUM value(const char* str) const;
+    ENUM value(const char* str, std::size_t len) const;
+    const char* string(ENUM eval) const;
+
+    Mapping mapping(std::size_t i) const;
+
+    bool contains(const char* str) const;
+    bool contains(const char* str, std::size_t len) const;
+    bool hasContiguousValues() const;
+
+private:
+    typedef typename std::underlying_type<ENUM>::type EnumInt;
+    typedef std::uint64_t HashValue;
+
+    // Twice as many slots as mappings keeps the search of displacements short
+    static const std::size_t slotCount =
+            internal::NextPowerOfTwo<2 * N>::value;
+    static const std::uint32_t emptySlot = static_cast<std::uint32_t>(-1);
+    static const std::uint32_t maxDisplacement = 1u << 20;
+
+    static HashValue strHash(const char* str, std::size_t len);
+    static std::size_t slotOf(HashValue hash, std::uint32_t displacement);
+    static EnumInt toInt(ENUM eval);
+
+    void buildPerfectHash();
+    void buildEnumIndex();
+    std::size_t findIndex(const char* str, std::size_t len) const;
+    std::size_t findEnumPos(ENUM eval) const;
+
+    Mapping m_mappings[N];
+    HashValue m_strHashes[N];
+    std::size_t m_strLengths[N];
+    std::uint32_t m_bucketDisplacement[slotCount];
+    std::uint32_t m_slotMappingId[slotCount];
+    std::uint32_t m_enumSortedMappingId[N]; // Mapping ids sorted by enum value
+    bool m_hasContiguousValues;
+};
+
+} // namespace cpp
+
+// --
+// -- Implementation
+// --
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+namespace cpp {
+
+template<typename ENUM, std::size_t N>
+const std::size_t StaticEnumStringMap<ENUM, N>::slotCount;
+
+template<typename ENUM, std::size_t N>
+const std::uint32_t StaticEnumStringMap<ENUM, N>::emptySlot;
+
+template<typename ENUM, std::size_t N>
+const std::uint32_t StaticEnumStringMap<ENUM, N>::maxDisplacement;
+
+template<typename ENUM, std::size_t N>
+StaticEnumStringMap<ENUM, N>::StaticEnumStringMap(const Mapping (&mappings)[N])
+    : m_hasContiguousValues(false)
+{
+    std::copy(mappings, mappings + N, m_mappings);
+    this->buildPerfectHash();
+    this->buildEnumIndex();
+}
+
+template<typename ENUM, std::size_t N>
+std::size_t StaticEnumStringMap<ENUM, N>::size() const
+{
+    return N;
+}
+
+template<typename ENUM, std::size_t N>
+std::size_t StaticEnumStringMap<ENUM, N>::index(ENUM eval) const
+{
+    return m_enumSortedMappingId[this->findEnumPos(eval)];
+}
+
+template<typename ENUM, std::size_t N>
+ENUM StaticEnumStringMap<ENUM, N>::valueAt(std::size_t i) const
+{
+    assert(i < N);
+    return m_mappings[i].first;
+}
+
+template<typename ENUM, std::size_t N>
+ENUM StaticEnumStringMap<ENUM, N>::value(const char* str) const
+{
+    return this->value(str, std::strlen(str));
+}
+
+/*! Returns the enum value mapped to the string of \p len characters starting
+ *  at \p str (which does not have to be NUL-terminated)
+ */
+template<typename ENUM, std::size_t N>
+ENUM StaticEnumStringMap<ENUM, N>::value(const char* str, std::size_t len) const
+{
+    const std::size_t id = this->findIndex(str, len);
+    assert(id < N);
+    return m_mappings[id].first;
+}
+
+template<typename ENUM, std::size_t N>
+const char* StaticEnumStringMap<ENUM, N>::string(ENUM eval) const
+{
+    return m_mappings[this->index(eval)].second;
+}
+
+template<typename ENUM, std::size_t N>
+typename StaticEnumStringMap<ENUM, N>::Mapping
+StaticEnumStringMap<ENUM, N>::mapping(std::size_t i) const
+{
+    assert(i < N);
+    return m_mappings[i];
+}
+
+//! Returns true if \p str is mapped to an enum value
+template<typename ENUM, std::size_t N>
+bool StaticEnumStringMap<ENUM, N>::contains(const char* str) const
+{
+    return this->contains(str, std::strlen(str));
+}
+
+template<typename ENUM, std::size_t N>
+bool StaticEnumStringMap<ENUM, N>::contains(const char* str, std::size_t len) const
+{
+    return this->findIndex(str, len) < N;
+}
+
+//! Returns true if string() and index() are direct accesses
+template<typename ENUM, std::size_t N>
+bool StaticEnumStringMap<ENUM, N>::hasContiguousValues() const
+{
+    return m_hasContiguousValues;
+}
+
+template<typename ENUM, std::size_t N>
+typename StaticEnumStringMap<ENUM, N>::HashValue
+StaticEnumStringMap<ENUM, N>::strHash(const char* str, std::size_t len)
+{
+    return cpp::hash64_fnv_1a()(str, len);
+}
+
+template<typename ENUM, std::size_t N>
+std::size_t StaticEnumStringMap<ENUM, N>::slotOf(
+        HashValue hash, std::uint32_t displacement)
+{
+    // Remix the string hash with the displacement (finalizer of MurmurHash3)
+    HashValue h = hash ^ (displacement * 0x9E3779B97F4A7C15ULL);
+    h ^= h >> 33;
+    h *= 0xFF51AFD7ED558CCDULL;
+    h ^= h >> 33;
+    h *= 0xC4CEB9FE1A85EC53ULL;
+    h ^= h >> 33;
+    return static_cast<std::size_t>(h & (slotCount - 1));
+}
+
+template<typename ENUM, std::size_t N>
+typename StaticEnumStringMap<ENUM, N>::EnumInt
+StaticEnumStringMap<ENUM, N>::toInt(ENUM eval)
+{
+    return static_cast<EnumInt>(eval);
+}
+
+/*! Hash and displace: strings are grouped in buckets by their hash, then
+ *  buckets are processed by decreasing size to find for each one a
+ *  displacement that sends all its strings to free slots
+ */
+template<typename ENUM, std::size_t N>
+void StaticEnumStringMap<ENUM, N>::buildPerfectHash()
+{
+    std::uint32_t bucketSize[slotCount] = {};
+    for (std::size_t i = 0; i < N; ++i) {
+        m_strLengths[i] = std::strlen(m_mappings[i].second);
+        m_strHashes[i] = strHash(m_mappings[i].second, m_strLengths[i]);
+        ++bucketSize[m_strHashes[i] & (slotCount - 1)];
+    }
+
+    std::uint32_t bucketOrder[slotCount];
+    for (std::size_t b = 0; b < slotCount; ++b)
+        bucketOrder[b] = static_cast<std::uint32_t>(b);
+    std::stable_sort(
+                bucketOrder, bucketOrder + slotCount,
+                [&] (std::uint32_t lhs, std::uint32_t rhs) {
+        return bucketSize[lhs] > bucketSize[rhs];
+    });
+
+    std::fill(m_bucketDisplacement, m_bucketDisplacement + slotCount, 0);
+    std::fill(m_slotMappingId, m_slotMappingId + slotCount, emptySlot);
+    for (std::uint32_t bucket : bucketOrder) {
+        if (bucketSize[bucket] == 0)
+            break;
+        std::uint32_t bucketIds[N];
+        std::size_t bucketIdCount = 0;
+        for (std::size_t i = 0; i < N; ++i) {
+            if ((m_strHashes[i] & (slotCount - 1)) == bucket)
+                bucketIds[bucketIdCount++] = static_cast<std::uint32_t>(i);
+        }
+
+        // Only duplicate strings can exhaust the displacements, they are then
+        // left unmapped
+        for (std::uint32_t displacement = 1;
+             displacement < maxDisplacement;
+             ++displacement)
+        {
+            std::size_t bucketSlots[N];
+            bool isFree = true;
+            for (std::size_t j = 0; j < bucketIdCount && isFree; ++j) {
+                bucketSlots[j] =
+                        slotOf(m_strHashes[bucketIds[j]], displacement);
+                isFree = m_slotMappingId[bucketSlots[j]] == emptySlot
+                        && std::find(bucketSlots, bucketSlots + j, bucketSlots[j])
+                           == bucketSlots + j;
+            }
+            if (isFree) {
+                m_bucketDisplacement[bucket] = displacement;
+                for (std::size_t j = 0; j < bucketIdCount; ++j)
+                    m_slotMappingId[bucketSlots[j]] = bucketIds[j];
+                break;
+            }
+        }
+        assert(m_bucketDisplacement[bucket] != 0); // Duplicate strings ?
+    }
+}
+
+template<typename ENUM, std::size_t N>
+void StaticEnumStringMap<ENUM, N>::buildEnumIndex()
+{
+    for (std::size_t i = 0; i < N; ++i)
+        m_enumSortedMappingId[i] = static_cast<std::uint32_t>(i);
+    std::stable_sort(
+                m_enumSortedMappingId, m_enumSortedMappingId + N,
+                [=] (std::uint32_t lhs, std::uint32_t rhs) {
+        return toInt(m_mappings[lhs].first) < toInt(m_mappings[rhs].first);
+    });
+
+    m_hasContiguousValues = true;
+    for (std::size_t i = 1; i < N && m_hasContiguousValues; ++i) {
+        const EnumInt prev = toInt(m_mappings[m_enumSortedMappingId[i - 1]].first);
+        const EnumInt curr = toInt(m_mappings[m_enumSortedMappingId[i]].first);
+        m_hasContiguousValues = curr - prev == 1;
+    }
+}
+
+//! Returns the index of the mapping of string (\p str, \p len), or N if not found
+template<typename ENUM, std::size_t N>
+std::size_t StaticEnumStringMap<ENUM, N>::findIndex(
+        const char* str, std::size_t len) const
+{
+    const HashValue hash = strHash(str, len);
+    const std::uint32_t displacement =
+            m_bucketDisplacement[hash & (slotCount - 1)];
+    if (displacement == 0)
+        return N;
+    const std::uint32_t id = m_slotMappingId[slotOf(hash, displacement)];
+    if (id != emptySlot
+            && m_strHashes[id] == hash
+            && m_strLengths[id] == len
+            && std::memcmp(m_mappings[id].second, str, len) == 0)
+    {
+        return id;
+    }
+    return N;
+}
+
+//! Returns the position of \p eval in m_enumSortedMappingId
+template<typename ENUM, std::size_t N>
+std::size_t StaticEnumStringMap<ENUM, N>::findEnumPos(ENUM eval) const
+{
+    const EnumInt evalInt = toInt(eval);
+    if (m_hasContiguousValues) {
+        const EnumInt minInt = toInt(m_mappings[m_enumSortedMappingId[0]].first);
+        assert(minInt <= evalInt && evalInt - minInt < static_cast<EnumInt>(N));
+        return static_cast<std::size_t>(evalInt - minInt);
+    }
+    const std::uint32_t* it = std::lower_bound(
+                m_enumSortedMappingId, m_enumSortedMappingId + N, evalInt,
+                [=] (std::uint32_t id, EnumInt value) {
+        return toInt(m_mappings[id].first) < value;
+    });
+    assert(it != m_enumSortedMappingId + N && toInt(m_mappings[*it].first) == evalInt);
+    return it - m_enumSortedMappingId;
+}
+
+} // namespace cpp
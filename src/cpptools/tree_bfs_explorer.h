@@ -15,9 +15,11 @@
 
 #pragma once
 
-#include <queue>
 #include "pusher.h"
 
+#include <cstddef>
+#include <vector>
+
 namespace cpp {
 
 /*! Generic class for the exploration of trees using BFS (breadth-first search)
@@ -38,6 +40,17 @@ namespace cpp {
  *     };
  * \endcode
  *
+ * The output iterator given to enqueueChildren() is a cpp::push_iterator,
+ * children available as a range are better pushed with cpp::pushRange().
+ *
+ * Pending nodes are kept in a contiguous vector consumed from a moving front
+ * index, their storage is not released by begin() : once warmed up, an
+ * explorer reused for many trees performs no memory allocation.
+ *
+ * Children of a node are enqueued only when moving past it, so calling
+ * skipChildren() prunes the subtree of current() : its nodes are neither
+ * visited nor enqueued.
+ *
  * \headerfile tree_bfs_explorer.h <cpptools/tree_bfs_explorer.h>
  * \ingroup cpptools
  */
@@ -54,10 +67,16 @@ public:
     NODE* current() const;
     unsigned depth() const;
 
+    void skipChildren();
+
+    void reserve(std::size_t nodeCount);
+
 private:
     NODE* m_current;
-    std::queue<NODE*> m_levelNodes;
+    std::vector<NODE*> m_levelNodes;
+    std::size_t m_levelNodesFront;
     unsigned m_depth;
+    bool m_isCurrentPruned;
 };
 
 
@@ -68,7 +87,9 @@ private:
 template<typename NODE, typename TREE_MODEL>
 TreeBfsExplorer<NODE, TREE_MODEL>::TreeBfsExplorer()
     : m_current(nullptr),
-      m_depth(0)
+      m_levelNodesFront(0),
+      m_depth(0),
+      m_isCurrentPruned(false)
 {
 }
 
@@ -76,15 +97,16 @@ TreeBfsExplorer<NODE, TREE_MODEL>::TreeBfsExplorer()
 template<typename NODE, typename TREE_MODEL>
 void TreeBfsExplorer<NODE, TREE_MODEL>::begin(NODE* node)
 {
-    while (!m_levelNodes.empty())
-        m_levelNodes.pop();
+    m_levelNodes.clear();
+    m_levelNodesFront = 0;
     m_current = nullptr;
     m_depth = 0;
+    m_isCurrentPruned = false;
 
     if (node == nullptr)
         TREE_MODEL::enqueueChildren(cpp::pusher(m_levelNodes), node);
     else
-        m_levelNodes.push(node);
+        m_levelNodes.push_back(node);
 
     this->goNext();
 }
@@ -93,15 +115,27 @@ void TreeBfsExplorer<NODE, TREE_MODEL>::begin(NODE* node)
 template<typename NODE, typename TREE_MODEL>
 void TreeBfsExplorer<NODE, TREE_MODEL>::goNext()
 {
-    if (m_levelNodes.empty()) {
+    if (m_current != nullptr && !m_isCurrentPruned)
+        TREE_MODEL::enqueueChildren(cpp::pusher(m_levelNodes), m_current);
+    m_isCurrentPruned = false;
+
+    if (m_levelNodesFront == m_levelNodes.size()) {
         m_current = nullptr;
         return;
     }
 
     const NODE* previous = m_current;
 
-    m_current = m_levelNodes.front();
-    m_levelNodes.pop();
+    m_current = m_levelNodes[m_levelNodesFront];
+    ++m_levelNodesFront;
+
+    // Drop consumed nodes once they fill half of the queue, so memory stays
+    // bounded by the width of the tree (amortized constant time)
+    if (m_levelNodesFront >= 64 && 2 * m_levelNodesFront >= m_levelNodes.size()) {
+        m_levelNodes.erase(
+                    m_levelNodes.begin(), m_levelNodes.begin() + m_levelNodesFront);
+        m_levelNodesFront = 0;
+    }
 
     if (previous != nullptr
             && m_current != nullptr
@@ -109,9 +143,6 @@ void TreeBfsExplorer<NODE, TREE_MODEL>::goNext()
     {
         ++m_depth;
     }
-
-    if (m_current != nullptr)
-        TREE_MODEL::enqueueChildren(cpp::pusher(m_levelNodes), m_current);
 }
 
 //! Is exploration beyond the last tree node (ended) ?
@@ -135,4 +166,22 @@ unsigned TreeBfsExplorer<NODE, TREE_MODEL>::depth() const
     return m_depth;
 }
 
+/*! Excludes the children of the current node (and so all its subtree) from
+ *  the exploration
+ *
+ *  Must be called before goNext()
+ */
+template<typename NODE, typename TREE_MODEL>
+void TreeBfsExplorer<NODE, TREE_MODEL>::skipChildren()
+{
+    m_isCurrentPruned = true;
+}
+
+//! Preallocates the queue of pending nodes for \p nodeCount nodes
+template<typename NODE, typename TREE_MODEL>
+void TreeBfsExplorer<NODE, TREE_MODEL>::reserve(std::size_t nodeCount)
+{
+    m_levelNodes.reserve(nodeCount);
+}
+
 } // namespace cpp
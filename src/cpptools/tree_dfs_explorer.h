@@ -0,0 +1,163 @@
+/****************************************************************************
+**  FougTools
+**  Copyright Fougue (1 Mar. 2011)
+**  contact@fougue.pro
+**
+** This software is a computer program whose purpose is to provide utility
+** tools for the C++ language and the Qt toolkit.
+**
+** This software is governed by the CeCILL-C license under French law and
+** abiding by the rules of distribution of free software.  You can  use,
+** modify and/ or redistribute the software under the terms of the CeCILL-C
+** license as circulated by CEA, CNRS and INRIA at the following URL
+** "http://www.cecill.info".
+****************************************************************************/
+
+
+#pragma once
+
+#include "pusher.h"
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace cpp {
+
+/*! Generic class for the exploration of trees using DFS (depth-first search)
+ *  algorithm, nodes are visited in pre-order (parent before its children)
+ *
+ * TREE_MODEL type must be a model of TreeDfsConcept :
+ *
+ * \code
+ *     struct TreeDfsConcept
+ *     {
+ *         // Enqueue all first-level (direct) children of tree node parentNode
+ *         // using output iterator
+ *         template<typename OUTPUT_ITERATOR>
+ *         static void enqueueChildren(OUTPUT_ITERATOR out, NODE* parentNode);
+ *     };
+ * \endcode
+ *
+ * The output iterator given to enqueueChildren() is a cpp::push_iterator,
+ * children available as a range are better pushed with cpp::pushRange().
+ *
+ * Any model of TreeBfsConcept is also a model of TreeDfsConcept.
+ *
+ * Pending nodes are kept in an explicit stack (no recursion), so deep trees
+ * cannot overflow the call stack. As with TreeBfsExplorer, the stack storage
+ * is reused by begin().
+ *
+ * \headerfile tree_dfs_explorer.h <cpptools/tree_dfs_explorer.h>
+ * \ingroup cpptools
+ */
+template<typename NODE, typename TREE_MODEL>
+class TreeDfsExplorer
+{
+public:
+    TreeDfsExplorer();
+
+    void begin(NODE* node = nullptr);
+    void goNext();
+    bool atEnd() const;
+
+    NODE* current() const;
+    unsigned depth() const;
+
+    void reserve(std::size_t nodeCount);
+
+private:
+    void pushChildren(NODE* parentNode, unsigned depth);
+
+    typedef std::pair<NODE*, unsigned> NodeDepth;
+
+    NODE* m_current;
+    std::vector<NODE*> m_children;
+    std::vector<NodeDepth> m_stack;
+    unsigned m_depth;
+};
+
+
+// --
+// -- Implementation
+// --
+
+template<typename NODE, typename TREE_MODEL>
+TreeDfsExplorer<NODE, TREE_MODEL>::TreeDfsExplorer()
+    : m_current(nullptr),
+      m_depth(0)
+{
+}
+
+//! Prepares exploration to start from tree \p node
+template<typename NODE, typename TREE_MODEL>
+void TreeDfsExplorer<NODE, TREE_MODEL>::begin(NODE* node)
+{
+    m_stack.clear();
+    m_current = nullptr;
+    m_depth = 0;
+
+    if (node == nullptr)
+        this->pushChildren(node, 0);
+    else
+        m_stack.push_back(NodeDepth(node, 0));
+
+    this->goNext();
+}
+
+//! Move exploration to the next tree node
+template<typename NODE, typename TREE_MODEL>
+void TreeDfsExplorer<NODE, TREE_MODEL>::goNext()
+{
+    if (m_stack.empty()) {
+        m_current = nullptr;
+        return;
+    }
+
+    m_current = m_stack.back().first;
+    m_depth = m_stack.back().second;
+    m_stack.pop_back();
+
+    if (m_current != nullptr)
+        this->pushChildren(m_current, m_depth + 1);
+}
+
+//! Is exploration beyond the last tree node (ended) ?
+template<typename NODE, typename TREE_MODEL>
+bool TreeDfsExplorer<NODE, TREE_MODEL>::atEnd() const
+{
+    return m_current == nullptr;
+}
+
+//! Current explored tree node
+template<typename NODE, typename TREE_MODEL>
+NODE* TreeDfsExplorer<NODE, TREE_MODEL>::current() const
+{
+    return m_current;
+}
+
+//! Depth of the current tree node
+template<typename NODE, typename TREE_MODEL>
+unsigned TreeDfsExplorer<NODE, TREE_MODEL>::depth() const
+{
+    return m_depth;
+}
+
+//! Preallocates the stack of pending nodes for \p nodeCount nodes
+template<typename NODE, typename TREE_MODEL>
+void TreeDfsExplorer<NODE, TREE_MODEL>::reserve(std::size_t nodeCount)
+{
+    m_stack.reserve(nodeCount);
+}
+
+//! Pushes children of \p parentNode so the first child is on top of the stack
+template<typename NODE, typename TREE_MODEL>
+void TreeDfsExplorer<NODE, TREE_MODEL>::pushChildren(NODE* parentNode, unsigned depth)
+{
+    m_children.clear();
+    TREE_MODEL::enqueueChildren(cpp::pusher(m_children), parentNode);
+    for (auto it = m_children.rbegin(); it != m_children.rend(); ++it)
+        m_stack.push_back(NodeDepth(*it, depth));
+}
+
+} // namespace cpp
@@ -0,0 +1,101 @@
+/****************************************************************************
+**  FougTools
+**  Copyright Fougue (1 Mar. 2011)
+**  contact@fougue.pro
+**
+** This software is a computer program whose purpose is to provide utility
+** tools for the C++ language and the Qt toolkit.
+**
+** This software is governed by the CeCILL-C license under French law and
+** abiding by the rules of distribution of free software.  You can  use,
+** modify and/ or redistribute the software under the terms of the CeCILL-C
+** license as circulated by CEA, CNRS and INRIA at the following URL
+** "http://www.cecill.info".
+****************************************************************************/
+
+
+#pragma once
+
+#include "parallel_utils.h"
+#include "pusher.h"
+
+#include <cstddef>
+#include <vector>
+
+namespace cpp {
+
+/*! \brief Level-synchronous parallel BFS (breadth-first search) of the tree
+ *         starting from \p node
+ *
+ *  The nodes of one depth level (the frontier) are split in contiguous chunks
+ *  processed concurrently : \p fn(node, depth) is called on each node, then
+ *  children are collected with TREE_MODEL::enqueueChildren() in a buffer per
+ *  chunk. Chunk buffers are concatenated in chunk order to form the next
+ *  frontier, so nodes of a level are the same (and in the same order) as with
+ *  TreeBfsExplorer. The function returns once all levels are processed.
+ *
+ *  If \p node is nullptr then exploration starts from the nodes enqueued by
+ *  TREE_MODEL::enqueueChildren(out, nullptr), at depth 0.
+ *
+ *  TREE_MODEL type must be a model of TreeDfsConcept (see TreeDfsExplorer),
+ *  enqueueChildren() and \p fn must be safe to call concurrently on distinct
+ *  nodes. If \p fn throws, exploration stops after the current level and the
+ *  exception is rethrown in the calling thread.
+ *
+ *  \param threadCount  Maximum count of threads to use (0 means
+ *                      parallelThreadCount())
+ *  \param minChunkSize  Minimum count of nodes per chunk, small levels are
+ *                       processed serially
+ *
+ *  \ingroup cpptools
+ */
+template<typename TREE_MODEL, typename NODE, typename FUNC>
+void parallelTreeBfs(
+        NODE* node,
+        FUNC fn,
+        unsigned threadCount = 0,
+        std::size_t minChunkSize = 64)
+{
+    if (threadCount == 0)
+        threadCount = cpp::parallelThreadCount();
+    if (minChunkSize == 0)
+        minChunkSize = 1;
+
+    std::vector<NODE*> frontier;
+    if (node == nullptr)
+        TREE_MODEL::enqueueChildren(cpp::pusher(frontier), node);
+    else
+        frontier.push_back(node);
+
+    std::vector<std::vector<NODE*>> chunkChildren(threadCount);
+    unsigned depth = 0;
+    while (!frontier.empty()) {
+        const std::size_t nodeCount = frontier.size();
+        const std::size_t maxChunkCount = (nodeCount + minChunkSize - 1) / minChunkSize;
+        const std::size_t chunkCount =
+                threadCount < maxChunkCount ? threadCount : maxChunkCount;
+        // One item per chunk, so each chunk owns chunkChildren[iChunk]
+        auto fnChunks = [&] (std::size_t iChunkBegin, std::size_t iChunkEnd) {
+            for (std::size_t iChunk = iChunkBegin; iChunk < iChunkEnd; ++iChunk) {
+                const std::size_t iBegin = iChunk * nodeCount / chunkCount;
+                const std::size_t iEnd = (iChunk + 1) * nodeCount / chunkCount;
+                std::vector<NODE*>& children = chunkChildren[iChunk];
+                children.clear();
+                for (std::size_t i = iBegin; i < iEnd; ++i) {
+                    fn(frontier[i], depth);
+                    TREE_MODEL::enqueueChildren(cpp::pusher(children), frontier[i]);
+                }
+            }
+        };
+        cpp::parallelForRanges(chunkCount, fnChunks, threadCount);
+
+        frontier.clear();
+        for (std::size_t iChunk = 0; iChunk < chunkCount; ++iChunk) {
+            const std::vector<NODE*>& children = chunkChildren[iChunk];
+            frontier.insert(frontier.end(), children.begin(), children.end());
+        }
+        ++depth;
+    }
+}
+
+} // namespace cpp
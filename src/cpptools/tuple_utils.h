@@ -13,9 +13,15 @@
 ** "http://www.cecill.info".
 ****************************************************************************/
 
+
 #pragma once
 
+#include "parallel_utils.h"
+
+#include <cstddef>
 #include <tuple>
+#include <type_traits>
+#include <utility>
 
 namespace cpp {
 
@@ -27,83 +33,184 @@ void tuple_for_each(const TUPLE& t, FUNC f);
 template<typename TUPLE, typename FUNC>
 void tuple_reversed_for_each(const TUPLE& t, FUNC f);
 
+template<typename TUPLE, typename FUNC>
+void tuple_parallel_for_each(const TUPLE& t, FUNC f, unsigned threadCount = 0);
+
+template<typename TUPLE, typename FUNC>
+struct tuple_transform_result;
+
+template<typename TUPLE, typename FUNC>
+typename tuple_transform_result<TUPLE, FUNC>::type
+tuple_parallel_transform(const TUPLE& t, FUNC f, unsigned threadCount = 0);
+
 // --
 // -- Implementation
 // --
 
 namespace internal {
 
-template<std::size_t N, std::size_t I, typename TUPLE, typename FUNC>
-struct impl_tuple_for_each
+// std::index_sequence is C++14
+template<std::size_t... I>
+struct IndexSequence
 {
-    static void call(const TUPLE& t, FUNC f)
-    {
-        f(std::get<N - I>(t));
-        impl_tuple_for_each<N, I - 1, TUPLE, FUNC>::call(t, f);
-    }
+    typedef IndexSequence<I...> type;
 };
 
-template<std::size_t N, typename TUPLE, typename FUNC>
-struct impl_tuple_for_each<N, 1, TUPLE, FUNC>
+template<typename SEQ1, typename SEQ2>
+struct ConcatIndexSequence;
+
+template<std::size_t... I1, std::size_t... I2>
+struct ConcatIndexSequence<IndexSequence<I1...>, IndexSequence<I2...>>
+        : IndexSequence<I1..., (sizeof...(I1) + I2)...>
+{};
+
+// Built in logarithmic depth of template instantiations
+template<std::size_t N>
+struct MakeIndexSequence
+        : ConcatIndexSequence<
+            typename MakeIndexSequence<N / 2>::type,
+            typename MakeIndexSequence<N - N / 2>::type>
+{};
+
+template<>
+struct MakeIndexSequence<0> : IndexSequence<> {};
+
+template<>
+struct MakeIndexSequence<1> : IndexSequence<0> {};
+
+template<typename TUPLE>
+struct TupleIndexSequence
+        : MakeIndexSequence<std::tuple_size<TUPLE>::value>
+{};
+
+// Comma operator expansion in array initializer : elements are visited in
+// order, without recursion. Leading 0 keeps the array non-empty
+template<typename TUPLE, typename FUNC, std::size_t... I>
+void impl_tuple_for_each(const TUPLE& t, FUNC& f, IndexSequence<I...>)
 {
-    static void call(const TUPLE& t, FUNC f)
-    {
-        f(std::get<N - 1>(t));
-    }
-};
+    const int visit[] = { 0, (f(std::get<I>(t)), 0)... };
+    (void)visit;
+}
 
-// Empty tuple
-template<typename TUPLE, typename FUNC>
-struct impl_tuple_for_each<0, 0, TUPLE, FUNC>
+template<typename TUPLE, typename FUNC, std::size_t... I>
+void impl_tuple_reversed_for_each(const TUPLE& t, FUNC& f, IndexSequence<I...>)
 {
-    static void call(const TUPLE&, FUNC)
-    { }
-};
+    const int visit[] = {
+        0, (f(std::get<std::tuple_size<TUPLE>::value - 1 - I>(t)), 0)... };
+    (void)visit;
+}
 
-template<std::size_t N, std::size_t I, typename TUPLE, typename FUNC>
-struct impl_tuple_reversed_for_each
+// Calls f on element I, the tuple index being only known at run time
+template<std::size_t I, typename TUPLE, typename FUNC>
+void impl_tuple_call_at(const TUPLE& t, FUNC& f)
 {
-    static void call(const TUPLE& t, FUNC f)
-    {
-        f(std::get<N - I - 1>(t));
-        impl_tuple_reversed_for_each<N, I + 1, TUPLE, FUNC>::call(t, f);
-    }
-};
+    f(std::get<I>(t));
+}
 
-template<std::size_t N, typename TUPLE, typename FUNC>
-struct impl_tuple_reversed_for_each<N, N, TUPLE, FUNC>
+template<typename TUPLE, typename FUNC, std::size_t... I>
+void impl_tuple_parallel_for_each(
+        const TUPLE& t, FUNC& f, unsigned threadCount, IndexSequence<I...>)
 {
-    static void call(const TUPLE&, FUNC)
-    { }
-};
+    // Leading nullptr keeps the array non-empty
+    typedef void (*CallAt)(const TUPLE&, FUNC&);
+    const CallAt callAt[] = { nullptr, &impl_tuple_call_at<I, TUPLE, FUNC>... };
+    auto fnRange = [&] (std::size_t iBegin, std::size_t iEnd) {
+        for (std::size_t i = iBegin; i < iEnd; ++i)
+            callAt[i + 1](t, f);
+    };
+    cpp::parallelForRanges(sizeof...(I), fnRange, threadCount);
+}
 
-// Empty tuple
-template<typename TUPLE, typename FUNC>
-struct impl_tuple_reversed_for_each<0, 0, TUPLE, FUNC>
+template<typename TUPLE, typename FUNC, typename SEQ>
+struct impl_tuple_transform_result;
+
+template<typename TUPLE, typename FUNC, std::size_t... I>
+struct impl_tuple_transform_result<TUPLE, FUNC, IndexSequence<I...>>
 {
-    static void call(const TUPLE&, FUNC)
-    { }
+    typedef std::tuple<
+        typename std::decay<
+            decltype(std::declval<FUNC&>()(
+                         std::get<I>(std::declval<const TUPLE&>())))>::type...> type;
 };
 
+template<std::size_t I, typename TUPLE, typename FUNC, typename RESULT>
+void impl_tuple_transform_at(const TUPLE& t, FUNC& f, RESULT* result)
+{
+    std::get<I>(*result) = f(std::get<I>(t));
+}
+
+template<typename TUPLE, typename FUNC, typename RESULT, std::size_t... I>
+void impl_tuple_parallel_transform(
+        const TUPLE& t, FUNC& f, RESULT* result, unsigned threadCount, IndexSequence<I...>)
+{
+    typedef void (*TransformAt)(const TUPLE&, FUNC&, RESULT*);
+    const TransformAt transformAt[] = {
+        nullptr, &impl_tuple_transform_at<I, TUPLE, FUNC, RESULT>... };
+    auto fnRange = [&] (std::size_t iBegin, std::size_t iEnd) {
+        for (std::size_t i = iBegin; i < iEnd; ++i)
+            transformAt[i + 1](t, f, result);
+    };
+    cpp::parallelForRanges(sizeof...(I), fnRange, threadCount);
+}
+
 } // namespace internal
 
 template<typename TUPLE, typename FUNC>
 void tuple_for_each(const TUPLE& t, FUNC f)
 {
-    internal::impl_tuple_for_each<
-            std::tuple_size<TUPLE>::value,
-            std::tuple_size<TUPLE>::value,
-            TUPLE,
-            FUNC>
-            ::call(t, f);
+    internal::impl_tuple_for_each(
+                t, f, typename internal::TupleIndexSequence<TUPLE>::type());
 }
 
 template<typename TUPLE, typename FUNC>
 void tuple_reversed_for_each(const TUPLE& t, FUNC f)
 {
-    internal::impl_tuple_reversed_for_each<
-            std::tuple_size<TUPLE>::value, 0, TUPLE, FUNC>
-            ::call(t, f);
+    internal::impl_tuple_reversed_for_each(
+                t, f, typename internal::TupleIndexSequence<TUPLE>::type());
+}
+
+/*! \brief Apply function \p f concurrently to each element in tuple \p t
+ *
+ *  Elements are dispatched to threads with cpp::parallelForRanges(), one
+ *  element per chunk : typically each element is an independent pipeline
+ *  stage. \p f is shared by all threads and must be safe to call
+ *  concurrently. If \p f throws, the first exception caught (in element
+ *  order) is rethrown once all calls are finished.
+ *
+ *  \param threadCount  Maximum count of threads to use (0 means
+ *                      parallelThreadCount())
+ */
+template<typename TUPLE, typename FUNC>
+void tuple_parallel_for_each(const TUPLE& t, FUNC f, unsigned threadCount)
+{
+    internal::impl_tuple_parallel_for_each(
+                t, f, threadCount, typename internal::TupleIndexSequence<TUPLE>::type());
+}
+
+/*! Type of the tuple of results of \p FUNC applied to each element of
+ *  \p TUPLE
+ */
+template<typename TUPLE, typename FUNC>
+struct tuple_transform_result
+        : internal::impl_tuple_transform_result<
+            TUPLE, FUNC, typename internal::TupleIndexSequence<TUPLE>::type>
+{};
+
+/*! \brief Same as tuple_parallel_for_each() but results of \p f are gathered
+ *         into a tuple
+ *
+ *  Element I of the returned tuple is the result of \p f applied to element I
+ *  of \p t. Result types must be default constructible and move assignable.
+ */
+template<typename TUPLE, typename FUNC>
+typename tuple_transform_result<TUPLE, FUNC>::type
+tuple_parallel_transform(const TUPLE& t, FUNC f, unsigned threadCount)
+{
+    typename tuple_transform_result<TUPLE, FUNC>::type result;
+    internal::impl_tuple_parallel_transform(
+                t, f, &result, threadCount,
+                typename internal::TupleIndexSequence<TUPLE>::type());
+    return result;
 }
 
 } // namespace cpp
@@ -0,0 +1,26 @@
+/****************************************************************************
+**  FougTools
+**  Copyright Fougue (30 Mar. 2015)
+**  contact@fougue.pro
+**
+** This software is a computer program whose purpose is to provide utility
+** tools for the C++ language and the Qt toolkit.
+**
+** This software is governed by the CeCILL-C license under French law and
+** abiding by the rules of distribution of free software.  You can  use,
+** modify and/ or redistribute the software under the terms of the CeCILL-C
+** license as circulated by CEA, CNRS and INRIA at the following URL
+** "http://www.cecill.info".
+****************************************************************************/
+
+#ifndef MATHTOOLS_CONFIG_H
+#define MATHTOOLS_CONFIG_H
+
+// MSVC supports C++11 constexpr from Visual Studio 2015 (_MSC_VER 1900)
+#if defined(_MSC_VER) && _MSC_VER < 1900
+#  define MATHTOOLS_CONSTEXPR
+#else
+#  define MATHTOOLS_CONSTEXPR constexpr
+#endif
+
+#endif // MATHTOOLS_CONFIG_H
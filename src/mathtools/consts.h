@@ -15,9 +15,11 @@
 
 #pragma once
 
+#include "config.h"
+
 namespace math {
 
-const double pi = 3.1415926535897932384626433832795;
-const double pi2 = 6.283185307179586476925286766559;
+MATHTOOLS_CONSTEXPR const double pi = 3.1415926535897932384626433832795;
+MATHTOOLS_CONSTEXPR const double pi2 = 6.283185307179586476925286766559;
 
 } // namespace math
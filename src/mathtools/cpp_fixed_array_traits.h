@@ -0,0 +1,46 @@
+/****************************************************************************
+**  FougTools
+**  Copyright Fougue (30 Mar. 2015)
+**  contact@fougue.pro
+**
+** This software is a computer program whose purpose is to provide utility
+** tools for the C++ language and the Qt toolkit.
+**
+** This software is governed by the CeCILL-C license under French law and
+** abiding by the rules of distribution of free software.  You can  use,
+** modify and/ or redistribute the software under the terms of the CeCILL-C
+** license as circulated by CEA, CNRS and INRIA at the following URL
+** "http://www.cecill.info".
+****************************************************************************/
+
+#ifndef MATHTOOLS_CPP_FIXED_ARRAY_TRAITS_H
+#define MATHTOOLS_CPP_FIXED_ARRAY_TRAITS_H
+
+#include "vec_traits.h"
+#include "../cpptools/fixed_array.h"
+
+namespace math {
+
+//! \cond
+template<typename T, unsigned S, std::size_t ALIGN>
+struct VecTraits< cpp::FixedArray<T, S, ALIGN> >
+{
+  typedef PointerVecAccessTag AccessCategory;
+  typedef T CoordType;
+  enum { Arity = S };
+};
+
+template<typename T, unsigned S, std::size_t ALIGN>
+struct VecAccess< cpp::FixedArray<T, S, ALIGN> >
+{
+  static T* pointer(cpp::FixedArray<T, S, ALIGN>& vec)
+  { return vec.cArray(); }
+
+  static const T* pointer(const cpp::FixedArray<T, S, ALIGN>& vec)
+  { return vec.cArray(); }
+};
+//! \endcond
+
+} // namespace math
+
+#endif // MATHTOOLS_CPP_FIXED_ARRAY_TRAITS_H
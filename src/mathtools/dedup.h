@@ -0,0 +1,130 @@
+/****************************************************************************
+**  FougTools
+**  Copyright Fougue (30 Mar. 2015)
+**  contact@fougue.pro
+**
+** This software is a computer program whose purpose is to provide utility
+** tools for the C++ language and the Qt toolkit.
+**
+** This software is governed by the CeCILL-C license under French law and
+** abiding by the rules of distribution of free software.  You can  use,
+** modify and/ or redistribute the software under the terms of the CeCILL-C
+** license as circulated by CEA, CNRS and INRIA at the following URL
+** "http://www.cecill.info".
+****************************************************************************/
+
+#ifndef MATHTOOLS_DEDUP_H
+#define MATHTOOLS_DEDUP_H
+
+#include "utils.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace math {
+
+//! \cond internal
+namespace __impl {
+
+template<std::size_t N>
+struct DedupCellKeyHash
+{
+  std::size_t operator()(const std::array<std::int64_t, N>& key) const
+  {
+    std::uint64_t hash = 14695981039346656037ULL; // FNV-1a offset basis
+    for (std::size_t k = 0; k < N; ++k) {
+      hash ^= static_cast<std::uint64_t>(key[k]);
+      hash *= 1099511628211ULL; // FNV-1a prime
+    }
+    return static_cast<std::size_t>(hash);
+  }
+};
+
+inline std::int64_t floorDiv(std::int64_t a, std::int64_t b)
+{
+  const std::int64_t q = a / b;
+  return (a % b != 0 && a < 0) ? q - 1 : q;
+}
+
+} // namespace __impl
+//! \endcond
+
+/*! \brief Finds the duplicates among \p count points of N coordinates packed at \p coords
+ *
+ *  Two points are duplicates when each pair of their coordinates is equal in the sense of
+ *  equalByIntDiff(), ie less than \p maxDistInts representable values apart.\n
+ *  Points are processed in order: \p representatives[i] receives the index of the first unique
+ *  point found equal to point i, or i itself if there is none (point i is then unique).
+ *
+ *  Points are bucketed in a spatial hash whose cells are \p maxDistInts + 1 ULPs wide, so each
+ *  point is compared only to the unique points of the 3^N neighbour cells.
+ *
+ *  \returns The count of unique points
+ *
+ *  \tparam N Count of coordinates per point
+ */
+template<std::size_t N, typename T>
+std::size_t dedupByIntDiff(const T* coords,
+                           std::size_t count,
+                           std::size_t* representatives,
+                           typename __impl::TypeTraits<T>::IntegralType_t maxDistInts = 10)
+{
+  typedef std::array<std::int64_t, N> CellKey;
+  typedef std::unordered_map< CellKey, std::vector<std::size_t>, __impl::DedupCellKeyHash<N> >
+      CellMap;
+
+  assert(0 < maxDistInts && "positive_and_small_enough");
+  const std::uint64_t maxDist = static_cast<std::uint64_t>(maxDistInts);
+  const std::int64_t cellWidth = static_cast<std::int64_t>(maxDistInts) + 1;
+  std::size_t neighbourCount = 1;
+  for (std::size_t k = 0; k < N; ++k)
+    neighbourCount *= 3;
+
+  CellMap cells;
+  cells.reserve(count);
+  std::size_t uniqueCount = 0;
+  for (std::size_t i = 0; i < count; ++i) {
+    const T* point = coords + i * N;
+    CellKey key;
+    for (std::size_t k = 0; k < N; ++k)
+      key[k] = __impl::floorDiv(static_cast<std::int64_t>(__impl::orderedIntBits(point[k])), cellWidth);
+
+    bool isFound = false;
+    for (std::size_t iNeighbour = 0; iNeighbour < neighbourCount && !isFound; ++iNeighbour) {
+      CellKey neighbourKey = key;
+      std::size_t offsets = iNeighbour;
+      for (std::size_t k = 0; k < N; ++k) {
+        neighbourKey[k] += static_cast<std::int64_t>(offsets % 3) - 1;
+        offsets /= 3;
+      }
+      const auto itCell = cells.find(neighbourKey);
+      if (itCell == cells.end())
+        continue;
+      for (std::size_t j : itCell->second) {
+        const T* other = coords + j * N;
+        bool isEqual = true;
+        for (std::size_t k = 0; k < N; ++k)
+          isEqual = isEqual && __impl::ulpDistance(point[k], other[k]) <= maxDist;
+        if (isEqual) {
+          representatives[i] = j;
+          isFound = true;
+          break;
+        }
+      }
+    }
+
+    if (!isFound) {
+      representatives[i] = i;
+      cells[key].push_back(i);
+      ++uniqueCount;
+    }
+  }
+  return uniqueCount;
+}
+
+} // namespace math
+
+#endif // MATHTOOLS_DEDUP_H
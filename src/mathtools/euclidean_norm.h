@@ -22,22 +22,28 @@
 namespace math {
 namespace internal {
 
-struct EuclideanFunc
+template<typename SUMMATION_TAG>
+struct BasicEuclideanFunc
 {
+  typedef BasicSqrEuclideanFunc<SUMMATION_TAG> SqrFunc;
+
   template<typename COORD_ITERATOR>
   static auto fromRange(COORD_ITERATOR begin, COORD_ITERATOR end) -> decltype(typeHelper(*begin))
-  { return std::sqrt(SqrEuclideanFunc::fromRange(begin, end)); }
+  { return std::sqrt(SqrFunc::fromRange(begin, end)); }
 
   template<std::size_t N, typename COORD_TYPE>
   static typename NumTraits<COORD_TYPE>::Real fromPtr(const COORD_TYPE* coordPtr)
-  { return std::sqrt(SqrEuclideanFunc::fromPtr<N, COORD_TYPE>(coordPtr)); }
+  { return std::sqrt(SqrFunc::template fromPtr<N, COORD_TYPE>(coordPtr)); }
 };
 
-template<> struct NormTraits<internal::EuclideanFunc>
+template<typename SUMMATION_TAG> struct NormTraits< BasicEuclideanFunc<SUMMATION_TAG> >
 {
   typedef ArityNormSpecializationTag NormCategory;
+  typedef SUMMATION_TAG SummationCategory;
 };
 
+typedef BasicEuclideanFunc<SimpleSummationTag> EuclideanFunc;
+
 } // namespace internal
 
 /*! \brief Provides computation of the
@@ -49,6 +55,20 @@ template<> struct NormTraits<internal::EuclideanFunc>
  */
 typedef Norm<math::internal::EuclideanFunc> EuclideanNorm;
 
+/*! \brief Same as EuclideanNorm, with sums computed by 4 independent accumulators
+ *
+ *  \headerfile euclidean_norm.h <mathtools/euclidean_norm.h>
+ *  \ingroup mathtools
+ */
+typedef Norm< math::internal::BasicEuclideanFunc<BlockedSummationTag> > BlockedEuclideanNorm;
+
+/*! \brief Same as EuclideanNorm, with sums computed by Kahan compensated summation
+ *
+ *  \headerfile euclidean_norm.h <mathtools/euclidean_norm.h>
+ *  \ingroup mathtools
+ */
+typedef Norm< math::internal::BasicEuclideanFunc<KahanSummationTag> > KahanEuclideanNorm;
+
 } // namespace math
 
 #endif // MATHTOOLS_EUCLIDEAN_NORM_H
@@ -17,6 +17,7 @@
 #define MATHTOOLS_MANHATTAN_NORM_H
 
 #include "norm.h"
+#include "summation.h"
 #include <cmath>
 
 namespace math {
@@ -33,38 +34,65 @@ auto ManhattanFunc_value(COORD_ITERATOR begin, COORD_ITERATOR end) -> decltype(t
   return result;
 }
 
+struct AbsFunc
+{
+  template<typename T> T operator()(const T& x) const { return std::fabs(x); }
+};
+
+template<typename COORD_ITERATOR, typename SUMMATION_TAG>
+auto ManhattanFunc_value(COORD_ITERATOR begin, COORD_ITERATOR end, SUMMATION_TAG tag)
+  -> decltype(typeHelper(*begin))
+{ return summation(begin, end, AbsFunc(), tag); }
+
 template<std::size_t N, typename COORD_TYPE>
 struct ManhattanFuncArity
 {
-  static typename NumTraits<COORD_TYPE>::Real value(const COORD_TYPE* coordPtr)
+  static MATHTOOLS_CONSTEXPR typename NumTraits<COORD_TYPE>::Real value(const COORD_TYPE* coordPtr)
   {
-    return ManhattanFuncArity<N - 1, COORD_TYPE>::value(coordPtr) + std::fabs(*(coordPtr + N - 1));
+    return ManhattanFuncArity<N - 1, COORD_TYPE>::value(coordPtr) + absConstexpr(*(coordPtr + N - 1));
   }
 };
 
 template<typename COORD_TYPE>
 struct ManhattanFuncArity<1, COORD_TYPE>
 {
-  static typename NumTraits<COORD_TYPE>::Real value(const COORD_TYPE* coordPtr)
-  { return std::fabs(*coordPtr); }
+  static MATHTOOLS_CONSTEXPR typename NumTraits<COORD_TYPE>::Real value(const COORD_TYPE* coordPtr)
+  { return absConstexpr(*coordPtr); }
 };
 
-struct ManhattanFunc
+template<typename SUMMATION_TAG>
+struct BasicManhattanFunc
 {
+  typedef typename NormTraits<BasicManhattanFunc>::SummationCategory SummationCategory;
+
   template<typename COORD_ITERATOR>
   static auto fromRange(COORD_ITERATOR begin, COORD_ITERATOR end) -> decltype(typeHelper(*begin))
-  { return ManhattanFunc_value(begin, end); }
+  { return ManhattanFunc_value(begin, end, SummationCategory()); }
 
   template<std::size_t N, typename COORD_TYPE>
-  static typename NumTraits<COORD_TYPE>::Real fromPtr(const COORD_TYPE* coordPtr)
+  static MATHTOOLS_CONSTEXPR typename NumTraits<COORD_TYPE>::Real fromPtr(const COORD_TYPE* coordPtr)
+  { return BasicManhattanFunc::fromPtrDispatch<N>(coordPtr, SummationCategory()); }
+
+private:
+  template<std::size_t N, typename COORD_TYPE>
+  static MATHTOOLS_CONSTEXPR typename NumTraits<COORD_TYPE>::Real fromPtrDispatch(const COORD_TYPE* coordPtr,
+                                                              SimpleSummationTag)
   { return ManhattanFuncArity<N, COORD_TYPE>::value(coordPtr); }
+
+  template<std::size_t N, typename COORD_TYPE, typename OTHER_SUMMATION_TAG>
+  static typename NumTraits<COORD_TYPE>::Real fromPtrDispatch(const COORD_TYPE* coordPtr,
+                                                              OTHER_SUMMATION_TAG tag)
+  { return ManhattanFunc_value(coordPtr, coordPtr + N, tag); }
 };
 
-template<> struct NormTraits<internal::ManhattanFunc>
+template<typename SUMMATION_TAG> struct NormTraits< BasicManhattanFunc<SUMMATION_TAG> >
 {
   typedef ArityNormSpecializationTag NormCategory;
+  typedef SUMMATION_TAG SummationCategory;
 };
 
+typedef BasicManhattanFunc<SimpleSummationTag> ManhattanFunc;
+
 } // namespace internal
 
 /*! \brief Provides computation of the
@@ -76,6 +104,20 @@ template<> struct NormTraits<internal::ManhattanFunc>
  */
 typedef Norm<internal::ManhattanFunc> ManhattanNorm;
 
+/*! \brief Same as ManhattanNorm, with sums computed by 4 independent accumulators
+ *
+ *  \headerfile manhattan_norm.h <mathtools/manhattan_norm.h>
+ *  \ingroup mathtools
+ */
+typedef Norm< internal::BasicManhattanFunc<BlockedSummationTag> > BlockedManhattanNorm;
+
+/*! \brief Same as ManhattanNorm, with sums computed by Kahan compensated summation
+ *
+ *  \headerfile manhattan_norm.h <mathtools/manhattan_norm.h>
+ *  \ingroup mathtools
+ */
+typedef Norm< internal::BasicManhattanFunc<KahanSummationTag> > KahanManhattanNorm;
+
 } // namespace math
 
 #endif // MATHTOOLS_NORMS_MANHATTAN_H
@@ -17,31 +17,41 @@
 #define MATHTOOLS_MAXIMUM_NORM_H
 
 #include "norm.h"
-#include <algorithm>
 
 namespace math {
 namespace internal {
 
+/*! Returns the maximum absolute value of the coordinates in [ \p begin , \p end ], or zero for
+ *  an empty range
+ *
+ *  The loop body is a select (no branch), compiled to max instructions
+ */
 template<typename COORD_ITERATOR>
 auto MaximumFunc_value(COORD_ITERATOR begin, COORD_ITERATOR end) -> decltype(typeHelper(*begin))
 {
-  return *std::max_element(begin, end);
+  decltype(typeHelper(*begin)) result = 0;
+  while (begin != end) {
+    result = maxConstexpr(absConstexpr(*begin), result);
+    ++begin;
+  }
+  return result;
 }
 
 template<std::size_t N, typename COORD_TYPE>
 struct MaximumFuncArity
 {
-  static typename NumTraits<COORD_TYPE>::Real value(const COORD_TYPE* coordPtr)
+  static MATHTOOLS_CONSTEXPR typename NumTraits<COORD_TYPE>::Real value(const COORD_TYPE* coordPtr)
   {
-    return std::max(*(coordPtr + N - 1), MaximumFuncArity<N - 1, COORD_TYPE>::value(coordPtr));
+    return maxConstexpr(absConstexpr(*(coordPtr + N - 1)),
+                        MaximumFuncArity<N - 1, COORD_TYPE>::value(coordPtr));
   }
 };
 
 template<typename COORD_TYPE>
 struct MaximumFuncArity<1, COORD_TYPE>
 {
-  static typename NumTraits<COORD_TYPE>::Real value(const COORD_TYPE* coordPtr)
-  { return *coordPtr; }
+  static MATHTOOLS_CONSTEXPR typename NumTraits<COORD_TYPE>::Real value(const COORD_TYPE* coordPtr)
+  { return absConstexpr(*coordPtr); }
 };
 
 struct MaximumFunc
@@ -51,7 +61,7 @@ struct MaximumFunc
   { return MaximumFunc_value(begin, end); }
 
   template<std::size_t N, typename COORD_TYPE>
-  static typename NumTraits<COORD_TYPE>::Real fromPtr(const COORD_TYPE* coordPtr)
+  static MATHTOOLS_CONSTEXPR typename NumTraits<COORD_TYPE>::Real fromPtr(const COORD_TYPE* coordPtr)
   { return MaximumFuncArity<N, COORD_TYPE>::value(coordPtr); }
 };
 
@@ -66,7 +76,7 @@ template<> struct NormTraits<internal::MaximumFunc>
  *         <a href="http://en.wikipedia.org/wiki/Norm_%28mathematics%29#Maximum_norm_.28special_case_of:_infinity_norm.2C_uniform_norm.2C_or_supremum_norm.29">
  *         maximum norm</a>
  *
- *  \headerfile euclidean_norm.h <mathtools/euclidean_norm.h>
+ *  \headerfile maximum_norm.h <mathtools/maximum_norm.h>
  *  \ingroup mathtools
  */
 typedef Norm<internal::MaximumFunc> MaximumNorm;
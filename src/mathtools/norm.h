@@ -18,6 +18,7 @@
 
 #include "norm_traits.h"
 #include "vec_traits.h"
+#include <type_traits>
 
 namespace math {
 
@@ -84,35 +85,114 @@ struct Norm
    */
   template<std::size_t N, typename COORD_TYPE>
 #ifndef DOXYGEN
-  static typename NumTraits<COORD_TYPE>::Real fromPtr(const COORD_TYPE* coordPtr)
+  static MATHTOOLS_CONSTEXPR typename NumTraits<COORD_TYPE>::Real fromPtr(const COORD_TYPE* coordPtr)
   {
-    typename internal::NormTraits<FUNC>::NormCategory normCategory;
-    return Norm::fromPtrDispatch<N, COORD_TYPE>(coordPtr, normCategory);
+    typedef typename internal::NormTraits<FUNC>::NormCategory NormCategory;
+    return Norm::fromPtrDispatch<N, COORD_TYPE>(coordPtr, NormCategory());
   }
 #else
   static CompatibleRealType fromPtr(const COORD_TYPE* coordPtr);
 #endif
 
   template<std::size_t N, typename COORD_TYPE>
-  static bool isNullPtr(const COORD_TYPE* coordPtr)
-  { return Norm::fromPtr(coordPtr) < NumTraits<COORD_TYPE>::precision(); }
+  static MATHTOOLS_CONSTEXPR bool isNullPtr(const COORD_TYPE* coordPtr)
+  { return Norm::fromPtr<N, COORD_TYPE>(coordPtr) < NumTraits<COORD_TYPE>::precision(); }
 
 
   /*! \brief Returns the norm of the vector with its N coordinates stored in array \p coordArray
+   *
+   *  This is a constant expression (constexpr) for norms whose computation is specialized by
+   *  arity (squared euclidean, manhattan and maximum with default summation), so that norms of
+   *  constexpr arrays can be used at compile time
    */
   template<std::size_t N, typename COORD_TYPE>
 #ifndef DOXYGEN
-  static typename NumTraits<COORD_TYPE>::Real fromArray(const COORD_TYPE (&coordArray)[N])
+  static MATHTOOLS_CONSTEXPR typename NumTraits<COORD_TYPE>::Real fromArray(const COORD_TYPE (&coordArray)[N])
   { return Norm::fromPtr<N, COORD_TYPE>(&coordArray[0]); }
 #else
   static CompatibleRealType fromArray(const COORD_TYPE (&coordArray)[N]);
 #endif
 
   template<std::size_t N, typename COORD_TYPE>
-  static bool isNullArray(const COORD_TYPE (&coordArray)[N])
+  static MATHTOOLS_CONSTEXPR bool isNullArray(const COORD_TYPE (&coordArray)[N])
   { return Norm::fromArray(coordArray) < NumTraits<COORD_TYPE>::precision(); }
 
 
+  /*! \brief Computes the norms of \p count vectors of N coordinates packed contiguously in memory
+   *         at \p coords, the norm of the i-th vector is written at \p out[i]
+   *
+   *  This is the same as calling fromPtr<N>(coords + i*N) for each vector, but in a single loop
+   *  with no call left once fromPtr() is inlined, so it can be vectorized by the compiler.
+   *
+   *  \tparam N Size of the vectors (count of coordinates)
+   */
+  template<std::size_t N, typename COORD_TYPE>
+#ifndef DOXYGEN
+  static void fromPackedArray(const COORD_TYPE* coords,
+                              std::size_t count,
+                              typename NumTraits<COORD_TYPE>::Real* out)
+  {
+    typename internal::NormTraits<FUNC>::NormCategory normCategory;
+    for (std::size_t i = 0; i < count; ++i)
+      out[i] = Norm::fromPtrDispatch<N, COORD_TYPE>(coords + i * N, normCategory);
+  }
+#else
+  static void fromPackedArray(const COORD_TYPE* coords, std::size_t count, CompatibleRealType* out);
+#endif
+
+
+  /*! \brief Same as fromPackedArray() but the i-th vector starts at \p coords + i * \p stride
+   *
+   *  This is for interleaved storage, where the N coordinates of each vector are followed by other
+   *  attributes (eg x, y, z, nx, ny, nz with N = 3 and \p stride = 6)
+   *
+   *  \tparam N Size of the vectors (count of coordinates)
+   *  \param stride Distance (in count of COORD_TYPE items) between two consecutive vectors
+   */
+  template<std::size_t N, typename COORD_TYPE>
+#ifndef DOXYGEN
+  static void fromStridedArray(const COORD_TYPE* coords,
+                               std::size_t stride,
+                               std::size_t count,
+                               typename NumTraits<COORD_TYPE>::Real* out)
+  {
+    typename internal::NormTraits<FUNC>::NormCategory normCategory;
+    for (std::size_t i = 0; i < count; ++i)
+      out[i] = Norm::fromPtrDispatch<N, COORD_TYPE>(coords + i * stride, normCategory);
+  }
+#else
+  static void fromStridedArray(const COORD_TYPE* coords, std::size_t stride, std::size_t count,
+                               CompatibleRealType* out);
+#endif
+
+
+  /*! \brief Computes the norms of \p count vectors stored as N separate coordinate arrays
+   *         (structure of arrays), the norm of the i-th vector is written at \p out[i]
+   *
+   *  The k-th coordinate of the i-th vector is \p coordArrays[k][i]
+   *
+   *  \tparam N Size of the vectors (count of coordinates)
+   */
+  template<std::size_t N, typename COORD_TYPE>
+#ifndef DOXYGEN
+  static void fromSoaArrays(const COORD_TYPE* const (&coordArrays)[N],
+                            std::size_t count,
+                            typename NumTraits<COORD_TYPE>::Real* out)
+  {
+    typename internal::NormTraits<FUNC>::NormCategory normCategory;
+    for (std::size_t i = 0; i < count; ++i) {
+      COORD_TYPE coords[N];
+      for (std::size_t k = 0; k < N; ++k)
+        coords[k] = coordArrays[k][i];
+      out[i] = Norm::fromPtrDispatch<N, COORD_TYPE>(&coords[0], normCategory);
+    }
+  }
+#else
+  static void fromSoaArrays(const COORD_TYPE* const (&coordArrays)[N], std::size_t count,
+                            CompatibleRealType* out);
+#endif
+
+
   /*! \brief Returns the norm of the vector object \p vec
    */
   template<typename VEC>
@@ -144,11 +224,27 @@ private:
 
 
   template<std::size_t N, typename COORD_TYPE>
-  static typename NumTraits<COORD_TYPE>::Real fromPtrDispatch(const COORD_TYPE* coordPtr,
+  static MATHTOOLS_CONSTEXPR typename NumTraits<COORD_TYPE>::Real fromPtrDispatch(const COORD_TYPE* coordPtr,
                                                               internal::ArityNormSpecializationTag)
+  {
+    typedef std::integral_constant<bool, (N <= internal::maxUnrolledArity)> IsUnrolled;
+    return Norm::fromPtrArity<N, COORD_TYPE>(coordPtr, IsUnrolled());
+  }
+
+
+  // Arity recursion would exceed the template instantiation depth for large N
+  template<std::size_t N, typename COORD_TYPE>
+  static MATHTOOLS_CONSTEXPR typename NumTraits<COORD_TYPE>::Real fromPtrArity(const COORD_TYPE* coordPtr,
+                                                                           std::true_type)
   { return FUNC::template fromPtr<N, COORD_TYPE>(coordPtr); }
 
 
+  template<std::size_t N, typename COORD_TYPE>
+  static typename NumTraits<COORD_TYPE>::Real fromPtrArity(const COORD_TYPE* coordPtr,
+                                                           std::false_type)
+  { return Norm::fromRange(coordPtr, coordPtr + N); }
+
+
   template<typename VEC>
   static typename internal::VecTraitsHelper<VEC>::Real fromObjectDispatch(const VEC& vec,
                                                                           StlIteratorVecAccessTag)
@@ -178,6 +274,19 @@ private:
     return Norm::fromRange(array.cbegin(), array.cend());
   }
 
+
+  template<typename VEC>
+  static typename internal::VecTraitsHelper<VEC>::Real fromObjectDispatch(const VEC& vec,
+                                                                          IndexedVecAccessTag)
+  {
+    typedef typename VecTraits<VEC>::CoordType CoordType;
+    const std::size_t arity = VecTraits<VEC>::Arity;
+    CoordType coords[arity];
+    for (std::size_t k = 0; k < arity; ++k)
+      coords[k] = VecAccess<VEC>::coord(vec, k);
+    return Norm::fromPtr<arity, CoordType>(&coords[0]);
+  }
+
 #endif // !DOXYGEN
 };
 
@@ -20,10 +20,49 @@
 #include "num_traits.h"
 
 namespace math {
+
+/*! \brief Tag for sums accumulated in order, in one single variable
+ *  \headerfile norm_traits.h <mathtools/norm_traits.h>
+ *  \ingroup mathtools
+ */
+struct SimpleSummationTag { };
+
+/*! \brief Tag for sums accumulated in several independent partial sums
+ *
+ *  Faster on long vectors (no loop-carried dependency) and slightly more accurate than
+ *  SimpleSummationTag
+ *
+ *  \headerfile norm_traits.h <mathtools/norm_traits.h>
+ *  \ingroup mathtools
+ */
+struct BlockedSummationTag { };
+
+/*! \brief Tag for sums accumulated with Kahan compensated summation
+ *
+ *  Accurate on long vectors, whatever their count of coordinates
+ *
+ *  \headerfile norm_traits.h <mathtools/norm_traits.h>
+ *  \ingroup mathtools
+ */
+struct KahanSummationTag { };
+
 namespace internal {
 
 template<typename T> typename NumTraits<T>::Real typeHelper(const T&) { return 0; }
 
+//! Same as std::fabs(), but usable in constant expressions
+template<typename T>
+MATHTOOLS_CONSTEXPR T absConstexpr(const T& x)
+{ return x < T(0) ? -x : x; }
+
+//! Same as std::max(), which is constexpr only since C++14
+template<typename T>
+MATHTOOLS_CONSTEXPR T maxConstexpr(const T& a, const T& b)
+{ return a < b ? b : a; }
+
+//! Vectors with more coordinates are not computed with FUNC::fromPtr<N>() (arity recursion)
+const std::size_t maxUnrolledArity = 32;
+
 struct NormSpecializationTag { };
 struct DefaultNormSpecializationTag { };
 struct ArityNormSpecializationTag { };
@@ -32,6 +71,7 @@ template<typename FUNC>
 struct NormTraits
 {
   typedef NormSpecializationTag NormCategory;
+  typedef SimpleSummationTag SummationCategory;
 };
 
 } // namespace internal
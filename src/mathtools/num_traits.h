@@ -16,6 +16,8 @@
 #ifndef MATHTOOLS_NUM_TRAITS_H
 #define MATHTOOLS_NUM_TRAITS_H
 
+#include "config.h"
+
 namespace math {
 
 /*! \brief Type traits on real numerical types (float, double, ...)
@@ -27,7 +29,7 @@ struct BaseNumTraits
 {
   typedef T Real;
 
-  static Real precision() { return Real(0); }
+  static MATHTOOLS_CONSTEXPR Real precision() { return Real(0); }
 };
 
 template<typename T>
@@ -40,7 +42,7 @@ struct NumTraits : public BaseNumTraits<T>
  */
 template<> struct NumTraits<float> : public BaseNumTraits<float>
 {
-  static Real precision() { return 1e-5f; }
+  static MATHTOOLS_CONSTEXPR Real precision() { return 1e-5f; }
 };
 
 /*! \brief Specialization for double
@@ -49,7 +51,7 @@ template<> struct NumTraits<float> : public BaseNumTraits<float>
  */
 template<> struct NumTraits<double> : public BaseNumTraits<double>
 {
-  static Real precision() { return 1e-12; }
+  static MATHTOOLS_CONSTEXPR Real precision() { return 1e-12; }
 };
 
 /*! \brief Specialization for long double
@@ -58,7 +60,7 @@ template<> struct NumTraits<double> : public BaseNumTraits<double>
  */
 template<> struct NumTraits<long double> : public BaseNumTraits<long double>
 {
-  static Real precision() { return 1e-15l; }
+  static MATHTOOLS_CONSTEXPR Real precision() { return 1e-15l; }
 };
 
 } // namespace math
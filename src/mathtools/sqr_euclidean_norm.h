@@ -17,6 +17,7 @@
 #define MATHTOOLS_SQR_EUCLIDEAN_NORM_H
 
 #include "norm.h"
+#include "summation.h"
 
 namespace math {
 namespace internal {
@@ -32,39 +33,66 @@ auto SqrEuclideanFunc_value(COORD_ITERATOR begin, COORD_ITERATOR end) -> decltyp
   return result;
 }
 
+struct SqrFunc
+{
+  template<typename T> T operator()(const T& x) const { return x * x; }
+};
+
+template<typename COORD_ITERATOR, typename SUMMATION_TAG>
+auto SqrEuclideanFunc_value(COORD_ITERATOR begin, COORD_ITERATOR end, SUMMATION_TAG tag)
+  -> decltype(typeHelper(*begin))
+{ return summation(begin, end, SqrFunc(), tag); }
+
 template<std::size_t N, typename COORD_TYPE>
 struct SqrEuclideanFuncArity
 {
-  static typename NumTraits<COORD_TYPE>::Real value(const COORD_TYPE* coordPtr)
+  static MATHTOOLS_CONSTEXPR typename NumTraits<COORD_TYPE>::Real value(const COORD_TYPE* coordPtr)
   {
-    const COORD_TYPE& coord = *(coordPtr + N - 1);
-    return SqrEuclideanFuncArity<N - 1, COORD_TYPE>::value(coordPtr) + coord*coord;
+    return SqrEuclideanFuncArity<N - 1, COORD_TYPE>::value(coordPtr)
+        + *(coordPtr + N - 1) * *(coordPtr + N - 1);
   }
 };
 
 template<typename COORD_TYPE>
 struct SqrEuclideanFuncArity<1, COORD_TYPE>
 {
-  static typename NumTraits<COORD_TYPE>::Real value(const COORD_TYPE* coordPtr)
+  static MATHTOOLS_CONSTEXPR typename NumTraits<COORD_TYPE>::Real value(const COORD_TYPE* coordPtr)
   { return (*coordPtr) * (*coordPtr); }
 };
 
-struct SqrEuclideanFunc
+template<typename SUMMATION_TAG>
+struct BasicSqrEuclideanFunc
 {
+  typedef typename NormTraits<BasicSqrEuclideanFunc>::SummationCategory SummationCategory;
+
   template<typename COORD_ITERATOR>
   static auto fromRange(COORD_ITERATOR begin, COORD_ITERATOR end) -> decltype(typeHelper(*begin))
-  { return SqrEuclideanFunc_value(begin, end); }
+  { return SqrEuclideanFunc_value(begin, end, SummationCategory()); }
 
   template<std::size_t N, typename COORD_TYPE>
-  static typename NumTraits<COORD_TYPE>::Real fromPtr(const COORD_TYPE* coordPtr)
+  static MATHTOOLS_CONSTEXPR typename NumTraits<COORD_TYPE>::Real fromPtr(const COORD_TYPE* coordPtr)
+  { return BasicSqrEuclideanFunc::fromPtrDispatch<N>(coordPtr, SummationCategory()); }
+
+private:
+  template<std::size_t N, typename COORD_TYPE>
+  static MATHTOOLS_CONSTEXPR typename NumTraits<COORD_TYPE>::Real fromPtrDispatch(const COORD_TYPE* coordPtr,
+                                                              SimpleSummationTag)
   { return SqrEuclideanFuncArity<N, COORD_TYPE>::value(coordPtr); }
+
+  template<std::size_t N, typename COORD_TYPE, typename OTHER_SUMMATION_TAG>
+  static typename NumTraits<COORD_TYPE>::Real fromPtrDispatch(const COORD_TYPE* coordPtr,
+                                                              OTHER_SUMMATION_TAG tag)
+  { return SqrEuclideanFunc_value(coordPtr, coordPtr + N, tag); }
 };
 
-template<> struct NormTraits<internal::SqrEuclideanFunc>
+template<typename SUMMATION_TAG> struct NormTraits< BasicSqrEuclideanFunc<SUMMATION_TAG> >
 {
   typedef ArityNormSpecializationTag NormCategory;
+  typedef SUMMATION_TAG SummationCategory;
 };
 
+typedef BasicSqrEuclideanFunc<SimpleSummationTag> SqrEuclideanFunc;
+
 } // namespace internal
 
 /*! \brief Provides computation of the squared euclidean norm
@@ -74,6 +102,22 @@ template<> struct NormTraits<internal::SqrEuclideanFunc>
  */
 typedef Norm<internal::SqrEuclideanFunc> SqrEuclideanNorm;
 
+/*! \brief Same as SqrEuclideanNorm, with sums computed by 4 independent accumulators
+ *
+ *  Prefer it for vectors with many coordinates (higher throughput, smaller rounding error)
+ *
+ *  \headerfile sqr_euclidean_norm.h <mathtools/sqr_euclidean_norm.h>
+ *  \ingroup mathtools
+ */
+typedef Norm< internal::BasicSqrEuclideanFunc<BlockedSummationTag> > BlockedSqrEuclideanNorm;
+
+/*! \brief Same as SqrEuclideanNorm, with sums computed by Kahan compensated summation
+ *
+ *  \headerfile sqr_euclidean_norm.h <mathtools/sqr_euclidean_norm.h>
+ *  \ingroup mathtools
+ */
+typedef Norm< internal::BasicSqrEuclideanFunc<KahanSummationTag> > KahanSqrEuclideanNorm;
+
 } // namespace math
 
 #endif // MATHTOOLS_NORMS_SQR_EUCLIDEAN_H
@@ -0,0 +1,117 @@
+/****************************************************************************
+**  FougTools
+**  Copyright Fougue (30 Mar. 2015)
+**  contact@fougue.pro
+**
+** This software is a computer program whose purpose is to provide utility
+** tools for the C++ language and the Qt toolkit.
+**
+** This software is governed by the CeCILL-C license under French law and
+** abiding by the rules of distribution of free software.  You can  use,
+** modify and/ or redistribute the software under the terms of the CeCILL-C
+** license as circulated by CEA, CNRS and INRIA at the following URL
+** "http://www.cecill.info".
+****************************************************************************/
+
+#ifndef MATHTOOLS_SUMMATION_H
+#define MATHTOOLS_SUMMATION_H
+
+#include "norm_traits.h"
+#include <iterator>
+
+namespace math {
+namespace internal {
+
+/*! \brief Sum of fn(x) for x in iterator range [ \p begin , \p end ], accumulated in order
+ */
+template<typename COORD_ITERATOR, typename FUNC>
+auto summation(COORD_ITERATOR begin, COORD_ITERATOR end, FUNC fn, SimpleSummationTag)
+  -> decltype(typeHelper(*begin))
+{
+  decltype(typeHelper(*begin)) result = 0;
+  while (begin != end) {
+    result += fn(*begin);
+    ++begin;
+  }
+  return result;
+}
+
+template<typename COORD_ITERATOR, typename FUNC>
+auto blockedSummation(COORD_ITERATOR begin, COORD_ITERATOR end, FUNC fn,
+                      std::random_access_iterator_tag)
+  -> decltype(typeHelper(*begin))
+{
+  typedef decltype(typeHelper(*begin)) Real;
+  Real acc0 = 0, acc1 = 0, acc2 = 0, acc3 = 0;
+  const auto count = end - begin;
+  decltype(end - begin) i = 0;
+  for (; i + 4 <= count; i += 4) {
+    acc0 += fn(begin[i]);
+    acc1 += fn(begin[i + 1]);
+    acc2 += fn(begin[i + 2]);
+    acc3 += fn(begin[i + 3]);
+  }
+  for (; i < count; ++i)
+    acc0 += fn(begin[i]);
+  return (acc0 + acc1) + (acc2 + acc3);
+}
+
+template<typename COORD_ITERATOR, typename FUNC>
+auto blockedSummation(COORD_ITERATOR begin, COORD_ITERATOR end, FUNC fn,
+                      std::input_iterator_tag)
+  -> decltype(typeHelper(*begin))
+{
+  typedef decltype(typeHelper(*begin)) Real;
+  Real acc[4] = { 0, 0, 0, 0 };
+  unsigned i = 0;
+  while (begin != end) {
+    acc[i & 3] += fn(*begin);
+    ++begin;
+    ++i;
+  }
+  return (acc[0] + acc[1]) + (acc[2] + acc[3]);
+}
+
+/*! \brief Sum of fn(x) for x in iterator range [ \p begin , \p end ], accumulated in 4
+ *         independent partial sums
+ *
+ *  Breaks the dependency between consecutive additions, so they can be pipelined (or
+ *  vectorized) by the compiler. As a side effect the rounding error grows with N/4 instead of N.
+ */
+template<typename COORD_ITERATOR, typename FUNC>
+auto summation(COORD_ITERATOR begin, COORD_ITERATOR end, FUNC fn, BlockedSummationTag)
+  -> decltype(typeHelper(*begin))
+{
+  typename std::iterator_traits<COORD_ITERATOR>::iterator_category itCategory;
+  return blockedSummation(begin, end, fn, itCategory);
+}
+
+/*! \brief Sum of fn(x) for x in iterator range [ \p begin , \p end ], with Kahan compensated
+ *         summation
+ *
+ *  The rounding error is independent of the count of terms, at the price of 4 floating-point
+ *  operations per term.
+ *
+ *  \warning Compensation is optimized out by "fast math" compiler options (eg -ffast-math)
+ */
+template<typename COORD_ITERATOR, typename FUNC>
+auto summation(COORD_ITERATOR begin, COORD_ITERATOR end, FUNC fn, KahanSummationTag)
+  -> decltype(typeHelper(*begin))
+{
+  typedef decltype(typeHelper(*begin)) Real;
+  Real result = 0;
+  Real compensation = 0;
+  while (begin != end) {
+    const Real y = fn(*begin) - compensation;
+    const Real t = result + y;
+    compensation = (t - result) - y;
+    result = t;
+    ++begin;
+  }
+  return result;
+}
+
+} // namespace internal
+} // namespace math
+
+#endif // MATHTOOLS_SUMMATION_H
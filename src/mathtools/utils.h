@@ -17,6 +17,8 @@
 #define BITS_MATH_UTILS_H
 
 #include <cmath>
+#include <cstddef>
+#include <cstdint>
 #include <limits>
 #include "consts.h"
 #include "utils_helpers.h"
@@ -51,26 +53,57 @@ bool equalByIntDiff(const T& a, const T& b,
                     ComparisonCheckFlags checkFlags = NoCheck);
 
 template<typename T>
-T clamped(const T& v, const T& min, const T& max);
+MATHTOOLS_CONSTEXPR T clamped(const T& v, const T& min, const T& max);
+
+// ---- Batch comparison
+
+inline std::size_t comparisonMaskWordCount(std::size_t count);
+
+template<typename T>
+void equalByAbsErrorMask(const T* a, const T* b, std::size_t count, std::uint64_t* mask,
+                         const T& tol = static_cast<T>(1e-6));
+
+template<typename T>
+void equalByRelErrorMask(const T* a, const T* b, std::size_t count, std::uint64_t* mask,
+                         const T& maxRelError = static_cast<T>(1e-5),
+                         const T& maxAbsError = std::numeric_limits<T>::epsilon());
+
+template<typename T>
+void equalByIntDiffMask(const T* a, const T* b, std::size_t count, std::uint64_t* mask,
+                        typename __impl::TypeTraits<T>::IntegralType_t maxDistInts = 10);
 
 // ---- Conversion
 
 template<typename T>
-double radianToDegree(const T& angle);
+MATHTOOLS_CONSTEXPR double radianToDegree(const T& angle);
 
 template<typename T>
-double degreeToRadian(const T& angle);
+MATHTOOLS_CONSTEXPR double degreeToRadian(const T& angle);
+
+MATHTOOLS_CONSTEXPR float radianToDegree(float angle);
+MATHTOOLS_CONSTEXPR float degreeToRadian(float angle);
+MATHTOOLS_CONSTEXPR long double radianToDegree(long double angle);
+MATHTOOLS_CONSTEXPR long double degreeToRadian(long double angle);
+
+template<typename T>
+void radianToDegree(const T* angles, std::size_t count, T* out);
+
+template<typename T>
+void degreeToRadian(const T* angles, std::size_t count, T* out);
 
 // ---- Misceallenous
 
 template<typename T>
-int sign(const T& v);
+MATHTOOLS_CONSTEXPR int sign(const T& v);
+
+template<typename T>
+MATHTOOLS_CONSTEXPR T square(const T& x);
 
 template<typename T>
-T square(const T& x);
+MATHTOOLS_CONSTEXPR T zero();
 
 template<typename T>
-T zero();
+MATHTOOLS_CONSTEXPR T sqrtConstexpr(const T& x);
 
 // ---- Status Report
 
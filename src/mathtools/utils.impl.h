@@ -52,9 +52,6 @@ bool equalByIntDiff(const T& a, const T& b,
                     typename __impl::TypeTraits<T>::IntegralType_t maxDistInts,
                     ComparisonCheckFlags checkFlags)
 {
-  typedef typename __impl::TypeTraits<T> Traits_t;
-  typedef typename __impl::TypeTraits<T>::IntegralType_t TraitsInt_t;
-
   assert(0 < maxDistInts && "positive_and_small_enough");
 
   // Comparison flags handling.
@@ -79,22 +76,83 @@ bool equalByIntDiff(const T& a, const T& b,
     }
   }
 
-  // Perform the general case comparison.
-  TraitsInt_t aAsInt = *(TraitsInt_t*)(&a);
-  if (aAsInt < 0) {
-    // Make aAsInt lexicographically ordered as a twos-complement int.
-    aAsInt = Traits_t::twoComplementValue() - aAsInt;
-  }
-  TraitsInt_t bAsInt = *(TraitsInt_t*)(&b);
-  if (bAsInt < 0) {
-    // Make bAsInt lexicographically ordered as a twos-complement int.
-    bAsInt = Traits_t::twoComplementValue() - bAsInt;
+  // Perform the general case comparison, on floating-point bits made lexicographically ordered
+  // as twos-complement ints
+  return __impl::ulpDistance(a, b) <= static_cast<std::uint64_t>(maxDistInts);
+}
+
+// ---- Batch comparison
+
+//! \cond internal
+namespace __impl {
+
+template<typename T, typename PREDICATE>
+void comparisonMask(const T* a, const T* b, std::size_t count, std::uint64_t* mask,
+                    PREDICATE pred)
+{
+  for (std::size_t iWord = 0; iWord * 64 < count; ++iWord) {
+    const T* wordA = a + iWord * 64;
+    const T* wordB = b + iWord * 64;
+    const std::size_t bitCount = count - iWord * 64 < 64 ? count - iWord * 64 : 64;
+    std::uint64_t bits = 0;
+    for (std::size_t i = 0; i < bitCount; ++i)
+      bits |= static_cast<std::uint64_t>(pred(wordA[i], wordB[i]) ? 1 : 0) << i;
+    mask[iWord] = bits;
   }
-  return std::abs(static_cast<double>(aAsInt - bAsInt)) <= maxDistInts;
 }
 
+} // namespace __impl
+//! \endcond
+
+/*! \brief Count of 64-bit words needed by the masks of \p count comparisons
+ */
+inline std::size_t comparisonMaskWordCount(std::size_t count)
+{
+  return (count + 63) / 64;
+}
+
+/*! \brief Compares \p a[i] and \p b[i] with equalByAbsError() for i in [0, \p count[
+ *
+ *  Bit (i % 64) of \p mask[i / 64] is set when \p a[i] and \p b[i] are equal.
+ *  \p mask must have comparisonMaskWordCount(count) words, unused bits of the last word are 0
+ */
+template<typename T>
+void equalByAbsErrorMask(const T* a, const T* b, std::size_t count, std::uint64_t* mask,
+                         const T& tol)
+{
+  assert(tol >= zero<T>() && "positive_tolerance");
+  __impl::comparisonMask(a, b, count, mask, [=](const T& x, const T& y) {
+    return std::abs(x - y) <= tol;
+  });
+}
+
+/*! \brief Same as equalByAbsErrorMask() but with equalByRelError()
+ */
+template<typename T>
+void equalByRelErrorMask(const T* a, const T* b, std::size_t count, std::uint64_t* mask,
+                         const T& maxRelError,
+                         const T& maxAbsError)
+{
+  __impl::comparisonMask(a, b, count, mask, [=](const T& x, const T& y) {
+    return equalByRelError(x, y, maxRelError, maxAbsError);
+  });
+}
+
+/*! \brief Same as equalByAbsErrorMask() but with equalByIntDiff() and no check flags
+ */
 template<typename T>
-T clamped(const T& v, const T& min, const T& max)
+void equalByIntDiffMask(const T* a, const T* b, std::size_t count, std::uint64_t* mask,
+                        typename __impl::TypeTraits<T>::IntegralType_t maxDistInts)
+{
+  assert(0 < maxDistInts && "positive_and_small_enough");
+  const std::uint64_t maxDist = static_cast<std::uint64_t>(maxDistInts);
+  __impl::comparisonMask(a, b, count, mask, [=](const T& x, const T& y) {
+    return __impl::ulpDistance(x, y) <= maxDist;
+  });
+}
+
+template<typename T>
+MATHTOOLS_CONSTEXPR T clamped(const T& v, const T& min, const T& max)
 {
   return v < min ? min : (v > max ? max : v);
 }
@@ -102,45 +160,131 @@ T clamped(const T& v, const T& min, const T& max)
 // ---- Conversion
 
 template<typename T>
-double radianToDegree(const T& angle)
+MATHTOOLS_CONSTEXPR double radianToDegree(const T& angle)
 {
   return (static_cast<double>(angle) * 180.) / math::pi;
 }
 
 template<typename T>
-double degreeToRadian(const T& angle)
+MATHTOOLS_CONSTEXPR double degreeToRadian(const T& angle)
 {
   return (math::pi * static_cast<double>(angle)) / 180.;
 }
 
+/*! \brief Overload for float, the computation is done in float (no round-trip to double)
+ */
+inline MATHTOOLS_CONSTEXPR float radianToDegree(float angle)
+{
+  return angle * static_cast<float>(180. / math::pi);
+}
+
+/*! \brief Overload for float, the computation is done in float (no round-trip to double)
+ */
+inline MATHTOOLS_CONSTEXPR float degreeToRadian(float angle)
+{
+  return angle * static_cast<float>(math::pi / 180.);
+}
+
+/*! \brief Overload for long double, the result keeps the long double type
+ */
+inline MATHTOOLS_CONSTEXPR long double radianToDegree(long double angle)
+{
+  return (angle * 180.l) / 3.1415926535897932384626433832795l;
+}
+
+/*! \brief Overload for long double, the result keeps the long double type
+ */
+inline MATHTOOLS_CONSTEXPR long double degreeToRadian(long double angle)
+{
+  return (3.1415926535897932384626433832795l * angle) / 180.l;
+}
+
+/*! \brief Converts the \p count angles in radians at \p angles into degrees written at \p out
+ *
+ *  Computation is done in type T, with a multiplication by a constant factor so the loop can be
+ *  vectorized. \p out can be \p angles
+ */
+template<typename T>
+void radianToDegree(const T* angles, std::size_t count, T* out)
+{
+  const T factor = static_cast<T>(180. / math::pi);
+  for (std::size_t i = 0; i < count; ++i)
+    out[i] = angles[i] * factor;
+}
+
+/*! \brief Converts the \p count angles in degrees at \p angles into radians written at \p out
+ *
+ *  \sa radianToDegree(const T*, std::size_t, T*)
+ */
+template<typename T>
+void degreeToRadian(const T* angles, std::size_t count, T* out)
+{
+  const T factor = static_cast<T>(math::pi / 180.);
+  for (std::size_t i = 0; i < count; ++i)
+    out[i] = angles[i] * factor;
+}
+
 // ---- Misceallenous
 
 template<typename T>
-int sign(const T& v)
+MATHTOOLS_CONSTEXPR int sign(const T& v)
 {
-  if (v == zero<T>())
-    return 0;
-  typedef typename __impl::TypeTraits<T> Traits_t;
-  typedef typename __impl::TypeTraits<T>::IntegralType_t TraitsInt_t;
-  if (Traits_t::isNativeIntegralType())
-    return v > 0 ? 1 : -1;
-  else
-    return ((*(TraitsInt_t*)&v) & Traits_t::twoComplementValue()) >= 0
-        ? 1 : -1;
+  return v == zero<T>() ? 0 : (v > zero<T>() ? 1 : -1);
 }
 
 template<typename T>
-T square(const T& x)
+MATHTOOLS_CONSTEXPR T square(const T& x)
 {
   return x * x;
 }
 
 template<typename T>
-T zero()
+MATHTOOLS_CONSTEXPR T zero()
 {
   return static_cast<T>(0);
 }
 
+//! \cond internal
+namespace __impl {
+
+template<typename T>
+MATHTOOLS_CONSTEXPR T sqrtNewton(const T& x, const T& guess, int iterCount)
+{
+  return iterCount == 0 ? guess : sqrtNewton(x, (guess + x / guess) / T(2), iterCount - 1);
+}
+
+// Scales x by powers of 4 (exact) down to [0.25, 4], where 8 Newton iterations from 1 converge
+template<typename T>
+MATHTOOLS_CONSTEXPR T sqrtScaled(const T& x)
+{
+  return x > T(4) ?
+        (x > T(18446744073709551616.) ?
+           T(4294967296.) * sqrtScaled(x / T(18446744073709551616.)) :
+           T(2) * sqrtScaled(x / T(4))) :
+        (x < T(0.25) ?
+           (x < T(1) / T(18446744073709551616.) ?
+              sqrtScaled(x * T(18446744073709551616.)) / T(4294967296.) :
+              sqrtScaled(x * T(4)) / T(2)) :
+           sqrtNewton(x, T(1), 8));
+}
+
+} // namespace __impl
+//! \endcond
+
+/*! \brief Square root of \p x, usable in constant expressions (eg to compute tolerances at
+ *         compile time)
+ *
+ *  The result is within one ulp of std::sqrt(x). Do not use it at runtime, std::sqrt() is
+ *  much faster.
+ */
+template<typename T>
+MATHTOOLS_CONSTEXPR T sqrtConstexpr(const T& x)
+{
+  return x < T(0) ?
+        std::numeric_limits<T>::quiet_NaN() :
+        (x == T(0) || x == std::numeric_limits<T>::infinity() ? x : __impl::sqrtScaled(x));
+}
+
 // ---- Status Report
 
 // 
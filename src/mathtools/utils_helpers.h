@@ -2,7 +2,9 @@
 # define BITS_MATH_UTILS_HELPERS_H
 
 // Requires at least Visual C++ 2010
-//# include <cstdint>
+# include <cstdint>
+# include <cstring>
+# include <limits>
 
 namespace math {
 
@@ -71,6 +73,43 @@ public:
   }
 }; // class TypeTraits<double>
 */
+
+/*! Returns the bits of \p v as an integer, ordered like the floating-point values
+ *  (-0 and +0 both map to 0)
+ */
+inline std::int32_t orderedIntBits(float v)
+{
+  std::int32_t bits;
+  std::memcpy(&bits, &v, sizeof(bits));
+  return bits < 0 ? std::numeric_limits<std::int32_t>::min() - bits : bits;
+}
+
+inline std::int64_t orderedIntBits(double v)
+{
+  std::int64_t bits;
+  std::memcpy(&bits, &v, sizeof(bits));
+  return bits < 0 ? std::numeric_limits<std::int64_t>::min() - bits : bits;
+}
+
+template<typename INT>
+std::uint64_t orderedIntDistance(INT a, INT b)
+{
+  return a >= b ?
+        static_cast<std::uint64_t>(a) - static_cast<std::uint64_t>(b) :
+        static_cast<std::uint64_t>(b) - static_cast<std::uint64_t>(a);
+}
+
+//! Count of representable values between \p a and \p b ("units in the last place")
+inline std::uint64_t ulpDistance(float a, float b)
+{ return orderedIntDistance(orderedIntBits(a), orderedIntBits(b)); }
+
+inline std::uint64_t ulpDistance(double a, double b)
+{ return orderedIntDistance(orderedIntBits(a), orderedIntBits(b)); }
+
+template<typename T>
+std::uint64_t ulpDistance(T a, T b)
+{ return orderedIntDistance(static_cast<std::int64_t>(a), static_cast<std::int64_t>(b)); }
+
 } // namespace __impl
 //! \endcond
 } // namespace math
@@ -132,6 +132,33 @@ struct PointerVecAccessTag : public VecAccessTag { };
  */
 struct StdArrayVecAccessTag : public VecAccessTag { };
 
+/*! \brief Tag dispatch for vector coordinates to be accessed by index with a static coord() function
+ *
+ *  This is for coordinates that are not contiguous in memory, like the ones of StridedVecView and
+ *  SoaVecView. The coordinates are gathered in a temporary C array of VecTraits<>::Arity items.
+ *
+ *  Example :
+ *  \code
+ *  struct MyVector2D
+ *  {
+ *    double* x;
+ *    double* y;
+ *  };
+ *
+ *  namespace math {
+ *    template<> struct VecAccess<MyVector2D>
+ *    {
+ *      static double coord(const MyVector2D& vec, std::size_t i)
+ *      { return i == 0 ? *vec.x : *vec.y; }
+ *    };
+ *  }
+ *  \endcode
+ *
+ *  \headerfile vec_traits.h <mathtools/vec_traits.h>
+ *  \ingroup mathtools
+ */
+struct IndexedVecAccessTag : public VecAccessTag { };
+
 
 /*! \brief Type traits on vector types
  *
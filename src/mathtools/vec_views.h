@@ -0,0 +1,107 @@
+/****************************************************************************
+**  FougTools
+**  Copyright Fougue (30 Mar. 2015)
+**  contact@fougue.pro
+**
+** This software is a computer program whose purpose is to provide utility
+** tools for the C++ language and the Qt toolkit.
+**
+** This software is governed by the CeCILL-C license under French law and
+** abiding by the rules of distribution of free software.  You can  use,
+** modify and/ or redistribute the software under the terms of the CeCILL-C
+** license as circulated by CEA, CNRS and INRIA at the following URL
+** "http://www.cecill.info".
+****************************************************************************/
+
+#ifndef MATHTOOLS_VEC_VIEWS_H
+#define MATHTOOLS_VEC_VIEWS_H
+
+#include "vec_traits.h"
+#include <cstddef>
+
+namespace math {
+
+/*! \brief Read-only view on a vector whose N coordinates are spaced by a stride in memory
+ *
+ *  The k-th coordinate is \p ptr[k * \p stride]. For example, x and y of the i-th point in an
+ *  interleaved x,y,z array are a StridedVecView<double, 2>(coords + 3*i, 1), and the x
+ *  coordinates of 4 points a StridedVecView<double, 4>(coords, 3)
+ *
+ *  Norms are computed with Norm::fromObject() without copying the coordinates first.
+ *
+ *  \headerfile vec_views.h <mathtools/vec_views.h>
+ *  \ingroup mathtools
+ */
+template<typename T, std::size_t N>
+struct StridedVecView
+{
+  StridedVecView(const T* ptr_, std::size_t stride_ = 1)
+    : ptr(ptr_), stride(stride_)
+  { }
+
+  const T& operator[](std::size_t k) const
+  { return ptr[k * stride]; }
+
+  const T* ptr;
+  std::size_t stride;
+};
+
+/*! \brief Read-only view on the i-th vector in N separate coordinate arrays (structure of arrays)
+ *
+ *  The k-th coordinate is \p arrays[k][\p index]
+ *
+ *  Example :
+ *  \code
+ *  const double* xyz[] = { xArray, yArray, zArray };
+ *  for (std::size_t i = 0; i < count; ++i)
+ *    norms[i] = math::EuclideanNorm::fromObject(math::SoaVecView<double, 3>(xyz, i));
+ *  \endcode
+ *
+ *  \headerfile vec_views.h <mathtools/vec_views.h>
+ *  \ingroup mathtools
+ */
+template<typename T, std::size_t N>
+struct SoaVecView
+{
+  SoaVecView(const T* const* arrays_, std::size_t index_)
+    : arrays(arrays_), index(index_)
+  { }
+
+  const T& operator[](std::size_t k) const
+  { return arrays[k][index]; }
+
+  const T* const* arrays;
+  std::size_t index;
+};
+
+//! \cond
+template<typename T, std::size_t N> struct VecTraits< StridedVecView<T, N> >
+{
+  typedef IndexedVecAccessTag AccessCategory;
+  typedef T CoordType;
+  enum { Arity = N };
+};
+
+template<typename T, std::size_t N> struct VecAccess< StridedVecView<T, N> >
+{
+  static const T& coord(const StridedVecView<T, N>& vec, std::size_t k)
+  { return vec[k]; }
+};
+
+template<typename T, std::size_t N> struct VecTraits< SoaVecView<T, N> >
+{
+  typedef IndexedVecAccessTag AccessCategory;
+  typedef T CoordType;
+  enum { Arity = N };
+};
+
+template<typename T, std::size_t N> struct VecAccess< SoaVecView<T, N> >
+{
+  static const T& coord(const SoaVecView<T, N>& vec, std::size_t k)
+  { return vec[k]; }
+};
+//! \endcond
+
+} // namespace math
+
+#endif // MATHTOOLS_VEC_VIEWS_H
@@ -0,0 +1,200 @@
+/****************************************************************************
+**  FougTools
+**  Copyright Fougue (30 Mar. 2015)
+**  contact@fougue.pro
+**
+** This software is a computer program whose purpose is to provide utility
+** tools for the C++ language and the Qt toolkit.
+**
+** This software is governed by the CeCILL-C license under French law and
+** abiding by the rules of distribution of free software.  You can  use,
+** modify and/ or redistribute the software under the terms of the CeCILL-C
+** license as circulated by CEA, CNRS and INRIA at the following URL
+** "http://www.cecill.info".
+****************************************************************************/
+
+
+#include "ais_scene_bounds.h"
+
+#include "shape_properties_cache.h"
+
+#include <AIS_InteractiveObject.hxx>
+#include <AIS_Shape.hxx>
+#include <BRepBndLib.hxx>
+#include <TopLoc_Location.hxx>
+
+#include <unordered_map>
+
+namespace occ {
+
+//! AisSceneBounds's pimpl
+class AisSceneBounds::Private
+{
+public:
+    Private()
+        : m_isUnionValid(true),
+          m_cache(NULL)
+    { }
+
+    void updateUnion()
+    {
+        if (!m_isUnionValid) {
+            m_union.SetVoid();
+            for (const auto& entry : m_objectBoxes)
+                m_union.Add(entry.second);
+            m_isUnionValid = true;
+        }
+    }
+
+    std::unordered_map<const AIS_InteractiveObject*, Bnd_Box> m_objectBoxes;
+    Bnd_Box m_union;
+    bool m_isUnionValid;
+    ShapePropertiesCache* m_cache;
+};
+
+/*! \class AisSceneBounds
+ *  \brief Incrementally maintained bounding box of the interactive objects
+ *         displayed in a scene
+ *
+ *  V3d_View::FitAll() asks the viewer to recompute the bounds of every
+ *  displayed presentation each time it is called. AisSceneBounds instead keeps
+ *  one box per tracked object : add() merges the object's box into the scene
+ *  box in constant time, remove() just marks the scene box as outdated, it is
+ *  then rebuilt from the per-object boxes (not from the presentations) on the
+ *  next call to box().
+ *
+ *  Objects are tracked by address and are not owned, so an object must be
+ *  removed before being destroyed. AisUtils::displayObjects(),
+ *  AisUtils::eraseObjects() and friends keep an AisSceneBounds up to date when
+ *  one is passed to them, and QtView::fitAll() uses the one given with
+ *  QtView::setSceneBounds().
+ *
+ *  AisSceneBounds is not thread-safe, it is meant to be used from the GUI
+ *  thread like the AIS context itself.
+ *
+ *  \headerfile ais_scene_bounds.h <occtools/ais_scene_bounds.h>
+ *  \ingroup occtools
+ */
+
+AisSceneBounds::AisSceneBounds()
+    : d(new Private)
+{ }
+
+AisSceneBounds::~AisSceneBounds()
+{
+    delete d;
+}
+
+/*! Starts tracking \p object, its box being computed with objectBox()
+ *
+ *  If \p object is already tracked then its box is recomputed (ex: after a
+ *  redisplay)
+ */
+void AisSceneBounds::add(const Handle_AIS_InteractiveObject& object)
+{
+    if (!object.IsNull())
+        this->add(object, AisSceneBounds::objectBox(object, d->m_cache));
+}
+
+/*! Starts tracking \p object with the explicit bounding \p box
+ *
+ *  Useful for objects that are not AIS_Shape, whose bounds are known by the
+ *  caller
+ */
+void AisSceneBounds::add(
+        const Handle_AIS_InteractiveObject& object, const Bnd_Box& box)
+{
+    if (object.IsNull())
+        return;
+    auto it = d->m_objectBoxes.find(object.operator->());
+    if (it != d->m_objectBoxes.end()) {
+        it->second = box;
+        d->m_isUnionValid = false; // The previous box may be larger
+    }
+    else {
+        d->m_objectBoxes.emplace(object.operator->(), box);
+        if (d->m_isUnionValid)
+            d->m_union.Add(box);
+    }
+}
+
+//! Stops tracking \p object, does nothing if \p object is not tracked
+void AisSceneBounds::remove(const Handle_AIS_InteractiveObject& object)
+{
+    if (!object.IsNull() && d->m_objectBoxes.erase(object.operator->()) > 0)
+        d->m_isUnionValid = false;
+}
+
+void AisSceneBounds::clear()
+{
+    d->m_objectBoxes.clear();
+    d->m_union.SetVoid();
+    d->m_isUnionValid = true;
+}
+
+bool AisSceneBounds::contains(const Handle_AIS_InteractiveObject& object) const
+{
+    return !object.IsNull()
+            && d->m_objectBoxes.find(object.operator->()) != d->m_objectBoxes.end();
+}
+
+//! Count of tracked objects
+std::size_t AisSceneBounds::count() const
+{
+    return d->m_objectBoxes.size();
+}
+
+//! Union of the boxes of all the tracked objects
+Bnd_Box AisSceneBounds::box() const
+{
+    d->updateUnion();
+    return d->m_union;
+}
+
+bool AisSceneBounds::isVoid() const
+{
+    d->updateUnion();
+    return d->m_union.IsVoid() == Standard_True;
+}
+
+//! Cache used to compute the boxes of AIS_Shape objects, NULL by default
+ShapePropertiesCache* AisSceneBounds::shapePropertiesCache() const
+{
+    return d->m_cache;
+}
+
+/*! Sets the \p cache used by add() to compute the boxes of AIS_Shape objects
+ *
+ *  Boxes of shapes that are displayed, erased and displayed again are then
+ *  computed once. \p cache is not owned
+ */
+void AisSceneBounds::setShapePropertiesCache(ShapePropertiesCache* cache)
+{
+    d->m_cache = cache;
+}
+
+/*! Bounding box of the interactive \p object, in world coordinates
+ *
+ *  Only AIS_Shape objects are supported, the box of any other kind of object
+ *  is void (use add() with an explicit box instead).
+ *  If \p cache is not NULL then the box of the underlying shape is queried
+ *  from it.
+ */
+Bnd_Box AisSceneBounds::objectBox(
+        const Handle_AIS_InteractiveObject& object, ShapePropertiesCache* cache)
+{
+    Bnd_Box box;
+    const Handle_AIS_Shape aisShape = Handle_AIS_Shape::DownCast(object);
+    if (aisShape.IsNull() || aisShape->Shape().IsNull())
+        return box;
+
+    if (cache != NULL)
+        box = cache->boundingBox(aisShape->Shape());
+    else
+        BRepBndLib::Add(aisShape->Shape(), box);
+    if (!box.IsVoid() && aisShape->HasLocation())
+        box = box.Transformed(aisShape->Location().Transformation());
+    return box;
+}
+
+} // namespace occ
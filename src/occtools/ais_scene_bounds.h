@@ -0,0 +1,62 @@
+/****************************************************************************
+**  FougTools
+**  Copyright Fougue (30 Mar. 2015)
+**  contact@fougue.pro
+**
+** This software is a computer program whose purpose is to provide utility
+** tools for the C++ language and the Qt toolkit.
+**
+** This software is governed by the CeCILL-C license under French law and
+** abiding by the rules of distribution of free software.  You can  use,
+** modify and/ or redistribute the software under the terms of the CeCILL-C
+** license as circulated by CEA, CNRS and INRIA at the following URL
+** "http://www.cecill.info".
+****************************************************************************/
+
+
+#pragma once
+
+#include "occtools.h"
+
+#include <Bnd_Box.hxx>
+#include <Handle_AIS_InteractiveObject.hxx>
+
+#include <cstddef>
+
+namespace occ {
+
+class ShapePropertiesCache;
+
+class OCCTOOLS_EXPORT AisSceneBounds
+{
+public:
+    AisSceneBounds();
+    ~AisSceneBounds();
+
+    void add(const Handle_AIS_InteractiveObject& object);
+    void add(const Handle_AIS_InteractiveObject& object, const Bnd_Box& box);
+    void remove(const Handle_AIS_InteractiveObject& object);
+    void clear();
+
+    bool contains(const Handle_AIS_InteractiveObject& object) const;
+    std::size_t count() const;
+
+    Bnd_Box box() const;
+    bool isVoid() const;
+
+    ShapePropertiesCache* shapePropertiesCache() const;
+    void setShapePropertiesCache(ShapePropertiesCache* cache);
+
+    static Bnd_Box objectBox(
+            const Handle_AIS_InteractiveObject& object,
+            ShapePropertiesCache* cache = NULL);
+
+private:
+    AisSceneBounds(const AisSceneBounds&) = delete;
+    AisSceneBounds& operator=(const AisSceneBounds&) = delete;
+
+    class Private;
+    Private* const d;
+};
+
+} // namespace occ
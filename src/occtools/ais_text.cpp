@@ -15,6 +15,10 @@
 
 #include "ais_text.h"
 
+#include <algorithm>
+#include <map>
+#include <string>
+#include <tuple>
 #include <vector>
 
 #include <Quantity_Factor.hxx>
@@ -57,10 +61,14 @@ IMPLEMENT_STANDARD_TYPE_END(AIS_Text)
 
 #include <gp_Pnt.hxx>
 #include <Graphic3d_AspectText3d.hxx>
+#include <Graphic3d_Group.hxx>
+#include <Graphic3d_Vertex.hxx>
 #include <OSD_Environment.hxx>
+#include <Prs3d_Root.hxx>
 #include <Prs3d_TextAspect.hxx>
-#include <Prs3d_Text.hxx>
 #include <SelectMgr_Selection.hxx>
+#include <Aspect_Window.hxx>
+#include <V3d_View.hxx>
 
 namespace occ {
 
@@ -68,29 +76,66 @@ namespace occ {
 
 namespace internal {
 
+    //! Attributes identifying a shared text aspect
+    struct TextAspectKey
+    {
+        bool operator<(const TextAspectKey& other) const
+        {
+            return std::tie(font, red, green, blue,
+                            bgRed, bgGreen, bgBlue, displayMode, style)
+                    < std::tie(other.font, other.red, other.green, other.blue,
+                               other.bgRed, other.bgGreen, other.bgBlue,
+                               other.displayMode, other.style);
+        }
+
+        void setColor(const Quantity_Color& c)
+        {
+            red = c.Red();
+            green = c.Green();
+            blue = c.Blue();
+        }
+
+        void setBackgroundColor(const Quantity_Color& c)
+        {
+            bgRed = c.Red();
+            bgGreen = c.Green();
+            bgBlue = c.Blue();
+        }
+
+        std::string font;
+        double red, green, blue;
+        double bgRed, bgGreen, bgBlue;
+        int displayMode; // Aspect_TypeOfDisplayText
+        int style; // Aspect_TypeOfStyleText
+    };
+
     class TextProperties
     {
     public:
         TextProperties()
-            : m_font(nullptr),
-              m_aspect(new Prs3d_TextAspect)
+            : m_aspectId(0),
+              m_isDirty(true),
+              m_isVisible(true)
         { }
 
         bool operator==(const TextProperties& other) const
         {
             return
-                    m_font == other.m_font
-                    && m_position.SquareDistance(other.m_position) < 1e-6
+                    m_position.SquareDistance(other.m_position) < 1e-6
                     && m_text == other.m_text
-                    && m_aspect == other.m_aspect;
+                    && m_aspectId == other.m_aspectId;
         }
 
-        const char* m_font;
         gp_Pnt m_position;
         TCollection_ExtendedString m_text;
-        Handle_Prs3d_TextAspect m_aspect;
+        unsigned m_aspectId; // Index in AIS_Text::Private::m_aspects
+        bool m_isDirty;
+        bool m_isVisible; // false if culled by the level of detail
     };
 
+    //! Count of consecutive texts drawn in the same Graphic3d_Group
+    static const unsigned textBlockSize = 256;
+
 } // namespace internal
 
 class AIS_Text::Private
@@ -101,23 +146,167 @@ public:
           m_defaultColor(Quantity_NOC_YELLOW),
           m_defaultTextBackgroundColor(Quantity_NOC_GREEN),
           m_defaultTextDisplayMode(Aspect_TODT_NORMAL),
-          m_defaultTextStyle(Aspect_TOST_NORMAL)
+          m_defaultTextStyle(Aspect_TOST_NORMAL),
+          m_dirtyTextCount(0),
+          m_isLodEnabled(false),
+          m_lodCellSize(24)
     {
         //Graphic3d_AspectText3d::TexFontDisable();
     }
 
+    //! Returns the ID of the shared aspect matching \p key, created if needed
+    unsigned internAspect(const internal::TextAspectKey& key)
+    {
+        auto it = m_aspectIdFromKey.find(key);
+        if (it != m_aspectIdFromKey.end())
+            return it->second;
+
+        Handle_Prs3d_TextAspect aspect = new Prs3d_TextAspect;
+        aspect->SetColor(Quantity_Color(key.red, key.green, key.blue, Quantity_TOC_RGB));
+        aspect->SetFont(key.font.c_str());
+        const Handle_Graphic3d_AspectText3d& gfxAspect = aspect->Aspect();
+        gfxAspect->SetDisplayType(static_cast<Aspect_TypeOfDisplayText>(key.displayMode));
+        gfxAspect->SetStyle(static_cast<Aspect_TypeOfStyleText>(key.style));
+        gfxAspect->SetColorSubTitle(
+                    Quantity_Color(key.bgRed, key.bgGreen, key.bgBlue, Quantity_TOC_RGB));
+        const auto id = static_cast<unsigned>(m_aspects.size());
+        SharedAspect shared;
+        shared.key = key;
+        shared.aspect = aspect;
+        m_aspects.push_back(shared);
+        m_aspectIdFromKey.insert(std::make_pair(key, id));
+        return id;
+    }
+
+    internal::TextAspectKey defaultAspectKey() const
+    {
+        internal::TextAspectKey key;
+        key.font = m_defaultFont;
+        key.setColor(m_defaultColor);
+        key.setBackgroundColor(m_defaultTextBackgroundColor);
+        key.displayMode = m_defaultTextDisplayMode;
+        key.style = m_defaultTextStyle;
+        return key;
+    }
+
+    const Handle_Prs3d_TextAspect& textAspect(unsigned i) const
+    {
+        return m_aspects.at(m_textProps.at(i).m_aspectId).aspect;
+    }
+
+    //! Makes the \p i-th text use the aspect of key modified by \p fnModify
+    template<typename FUNC>
+    void modifyTextAspect(unsigned i, FUNC fnModify)
+    {
+        internal::TextProperties& props = m_textProps.at(i);
+        internal::TextAspectKey key = m_aspects.at(props.m_aspectId).key;
+        fnModify(&key);
+        const unsigned aspectId = this->internAspect(key);
+        if (aspectId != props.m_aspectId) {
+            props.m_aspectId = aspectId;
+            this->setTextDirty(i);
+        }
+    }
+
+    void setTextDirty(unsigned i)
+    {
+        internal::TextProperties& props = m_textProps[i];
+        if (!props.m_isDirty) {
+            props.m_isDirty = true;
+            ++m_dirtyTextCount;
+        }
+    }
+
+    unsigned blockCount() const
+    {
+        const auto textCount = static_cast<unsigned>(m_textProps.size());
+        return (textCount + internal::textBlockSize - 1) / internal::textBlockSize;
+    }
+
+    //! Clears the graphic group of block \p iBlock and draws its texts again
+    void drawBlock(unsigned iBlock)
+    {
+        const Handle_Graphic3d_Group& group = m_blockGroups.at(iBlock);
+        group->Clear(Standard_False);
+        const auto textCount = static_cast<unsigned>(m_textProps.size());
+        const unsigned iBegin = iBlock * internal::textBlockSize;
+        const unsigned iEnd = std::min(iBegin + internal::textBlockSize, textCount);
+        unsigned groupAspectId = static_cast<unsigned>(m_aspects.size()); // None
+        for (unsigned i = iBegin; i < iEnd; ++i) {
+            internal::TextProperties& props = m_textProps[i];
+            if (props.m_isDirty) {
+                props.m_isDirty = false;
+                --m_dirtyTextCount;
+            }
+            if (!props.m_isVisible)
+                continue;
+            const Handle_Prs3d_TextAspect& aspect = m_aspects.at(props.m_aspectId).aspect;
+            const gp_Pnt& pos = props.m_position;
+            // Consecutive texts sharing an aspect are drawn without switching
+            // the aspect of the group
+            if (props.m_aspectId != groupAspectId) {
+                group->SetPrimitivesAspect(aspect->Aspect());
+                groupAspectId = props.m_aspectId;
+            }
+            group->Text(
+                        props.m_text,
+                        Graphic3d_Vertex(pos.X(), pos.Y(), pos.Z()),
+                        aspect->Height(),
+                        aspect->Angle(),
+                        aspect->Orientation(),
+                        aspect->HorizontalJustification(),
+                        aspect->VerticalJustification());
+        }
+    }
+
+    void setTextVisible(unsigned i, bool on)
+    {
+        if (m_textProps[i].m_isVisible != on) {
+            m_textProps[i].m_isVisible = on;
+            this->setTextDirty(i);
+        }
+    }
+
     const char* m_defaultFont;
     Quantity_Color m_defaultColor;
     Quantity_Color m_defaultTextBackgroundColor;
     Aspect_TypeOfDisplayText m_defaultTextDisplayMode;
     Aspect_TypeOfStyleText m_defaultTextStyle;
     std::vector<internal::TextProperties> m_textProps;
+    unsigned m_dirtyTextCount;
+
+    // Text aspects interned by attributes, shared by all the texts having the
+    // same font, colors, display mode and style
+    struct SharedAspect
+    {
+        internal::TextAspectKey key;
+        Handle_Prs3d_TextAspect aspect;
+    };
+    std::vector<SharedAspect> m_aspects;
+    std::map<internal::TextAspectKey, unsigned> m_aspectIdFromKey;
+
+    // Presentation built by the last call to Compute(), with one graphic group
+    // per block of internal::textBlockSize texts
+    Handle_Prs3d_Presentation m_presentation;
+    std::vector<Handle_Graphic3d_Group> m_blockGroups;
+
+    // Level of detail, m_lodGrid is the occupancy of the screen-space grid
+    // used by AIS_Text::updateLod()
+    bool m_isLodEnabled;
+    int m_lodCellSize;
+    std::vector<bool> m_lodGrid;
 };
 
 /*!
  * \class AIS_Text
  * \brief Interactive items specialized in text display
  *
+ * Texts having the same font, color, background color, display mode and
+ * style share one Prs3d_TextAspect, so thousands of labels cost a few aspect
+ * objects and the texts of a block are drawn without switching aspects.
+ * Per-text setters (setTextStyle(), ...) make the text use another shared
+ * aspect, they never modify the aspect of other texts.
+ *
  * \headerfile ais_text.h <occtools/ais_text.h>
  * \ingroup occtools
  */
@@ -133,10 +322,7 @@ AIS_Text::AIS_Text(
         const TCollection_ExtendedString &text, const gp_Pnt& pos)
     : d(new Private)
 {
-    internal::TextProperties defaultProps;
-    d->m_textProps.push_back(defaultProps);
-    this->setText(text);
-    this->setPosition(pos);
+    this->addText(text, pos);
 }
 
 //! Destructs the instance and free any allocated resources
@@ -145,20 +331,32 @@ AIS_Text::~AIS_Text()
     delete d;
 }
 
+/*! Returns the aspect of the \p i-th text
+ *
+ *  \warning The aspect is shared by all the texts having the same attributes,
+ *           modifying it affects them all
+ */
 Handle_Prs3d_TextAspect AIS_Text::presentationTextAspect(unsigned i) const
 {
     if (this->isValidTextIndex(i))
-        return d->m_textProps.at(i).m_aspect;
+        return d->textAspect(i);
     return Handle_Prs3d_TextAspect();
 }
 
+//! Same as presentationTextAspect()->Aspect()
 Handle_Graphic3d_AspectText3d AIS_Text::graphicTextAspect(unsigned i) const
 {
     if (this->isValidTextIndex(i))
-        return d->m_textProps.at(i).m_aspect->Aspect();
+        return d->textAspect(i)->Aspect();
     return Handle_Graphic3d_AspectText3d();
 }
 
+//! Returns the count of distinct aspects shared by the texts
+unsigned AIS_Text::sharedTextAspectCount() const
+{
+    return static_cast<unsigned>(d->m_aspects.size());
+}
+
 //! Returns the position of the \p i-th text displayed
 gp_Pnt AIS_Text::position(unsigned i) const
 {
@@ -192,32 +390,187 @@ unsigned AIS_Text::textsCount() const
 void AIS_Text::addText(
         const TCollection_ExtendedString &text, const gp_Pnt& pos)
 {
-    internal::TextProperties newProps;
-    d->m_textProps.push_back(newProps);
-    const unsigned i = this->textsCount() - 1; // Index of the last text item
+    d->m_textProps.push_back(internal::TextProperties());
+    internal::TextProperties& props = d->m_textProps.back();
+    ++(d->m_dirtyTextCount);
 
-    this->presentationTextAspect(i)->SetColor(d->m_defaultColor);
-    this->presentationTextAspect(i)->SetFont(d->m_defaultFont);
+    props.m_position = pos;
+    props.m_text = text;
+    props.m_aspectId = d->internAspect(d->defaultAspectKey());
+}
+
+//! Returns true if some texts were modified or added since the last update
+bool AIS_Text::hasDirtyTexts() const
+{
+    return d->m_dirtyTextCount > 0;
+}
 
-    this->setPosition(pos, i);
-    this->setText(text, i);
-    this->setTextDisplayMode(d->m_defaultTextDisplayMode, i);
-    this->setTextStyle(d->m_defaultTextStyle, i);
-    this->setTextBackgroundColor(d->m_defaultTextBackgroundColor, i);
+/*! \brief Returns true if the \p i-th text was modified or added since the last
+ *         update
+ *
+ *  Texts are dirty until they are drawn by Compute() or updateDirtyTexts()
+ */
+bool AIS_Text::isTextDirty(unsigned i) const
+{
+    return this->isValidTextIndex(i) ? d->m_textProps.at(i).m_isDirty : false;
+}
+
+/*! \brief Draws again the dirty texts in the current presentation
+ *
+ *  Texts are drawn by blocks of consecutive items, each block having its own
+ *  graphic group. Only the blocks containing dirty texts are cleared and
+ *  drawn again, which is much cheaper than a full redisplay of the object when
+ *  few texts out of many were modified or added.
+ *
+ *  The viewer has to be updated afterwards to show the changes (ex: with
+ *  AIS_InteractiveContext::UpdateCurrentViewer()).
+ *
+ *  Returns false if there is no presentation yet, ie the object was never
+ *  displayed. In that case the object should be displayed or redisplayed
+ *  with the interactive context.
+ *
+ *  \note Only the presentation built by the last call to Compute() is updated
+ */
+bool AIS_Text::updateDirtyTexts()
+{
+    if (d->m_presentation.IsNull())
+        return false;
+
+    // Create the groups of the new blocks
+    while (d->m_blockGroups.size() < d->blockCount())
+        d->m_blockGroups.push_back(Prs3d_Root::NewGroup(d->m_presentation));
+
+    const unsigned blockCount = d->blockCount();
+    for (unsigned iBlock = 0;
+         iBlock < blockCount && d->m_dirtyTextCount > 0;
+         ++iBlock)
+    {
+        const unsigned iBegin = iBlock * internal::textBlockSize;
+        const unsigned iEnd =
+                std::min(iBegin + internal::textBlockSize, this->textsCount());
+        for (unsigned i = iBegin; i < iEnd; ++i) {
+            if (d->m_textProps[i].m_isDirty) {
+                d->drawBlock(iBlock);
+                break;
+            }
+        }
+    }
+    return true;
+}
+
+//! Is the level of detail enabled ? (default is false)
+bool AIS_Text::isLodEnabled() const
+{
+    return d->m_isLodEnabled;
+}
+
+/*! \brief Enables the level of detail, so that texts not worth drawing are
+ *         culled by updateLod()
+ *
+ *  When disabled, all the texts are visible again (call updateDirtyTexts() to
+ *  update the presentation)
+ */
+void AIS_Text::setLodEnabled(bool on)
+{
+    d->m_isLodEnabled = on;
+    if (!on) {
+        for (unsigned i = 0; i < this->textsCount(); ++i)
+            d->setTextVisible(i, true);
+    }
+}
+
+/*! \brief Returns the size, in pixels, of the cells of the screen-space grid
+ *         used by the level of detail
+ *
+ *  At most one text is drawn per cell. Default is 24 pixels
+ */
+int AIS_Text::lodCellSize() const
+{
+    return d->m_lodCellSize;
+}
+
+void AIS_Text::setLodCellSize(int pixels)
+{
+    d->m_lodCellSize = std::max(pixels, 1);
+}
+
+//! Returns false if the \p i-th text is culled by the level of detail
+bool AIS_Text::isTextVisible(unsigned i) const
+{
+    return this->isValidTextIndex(i) ? d->m_textProps.at(i).m_isVisible : false;
+}
+
+/*! \brief Culls the texts not worth drawing in \p view and updates the
+ *         presentation
+ *
+ *  A text is culled if its position projects outside of \p view, or if the
+ *  cell of the screen-space grid (see lodCellSize()) containing its position
+ *  is already occupied by a text of lower index. So texts inserted first have
+ *  higher priority.
+ *
+ *  This function is meant to be called on view changes (zoom, pan, rotation,
+ *  resize). Only the blocks of texts whose visibility changed are drawn again
+ *  with updateDirtyTexts(), then the viewer has to be updated.
+ *
+ *  Returns true if the presentation was modified. Does nothing if the
+ *  level of detail is disabled.
+ */
+bool AIS_Text::updateLod(const Handle_V3d_View& view)
+{
+    if (!d->m_isLodEnabled || view.IsNull() || view->Window().IsNull())
+        return false;
+
+    int viewWidth = 0;
+    int viewHeight = 0;
+    view->Window()->Size(viewWidth, viewHeight);
+    const int cellSize = d->m_lodCellSize;
+    const int gridWidth = (viewWidth + cellSize - 1) / cellSize;
+    const int gridHeight = (viewHeight + cellSize - 1) / cellSize;
+    d->m_lodGrid.assign(std::max(gridWidth * gridHeight, 0), false);
+
+    const unsigned textCount = this->textsCount();
+    for (unsigned i = 0; i < textCount; ++i) {
+        const gp_Pnt& pos = d->m_textProps[i].m_position;
+        Standard_Integer xPixel = 0;
+        Standard_Integer yPixel = 0;
+        view->Convert(pos.X(), pos.Y(), pos.Z(), xPixel, yPixel);
+        bool isVisible =
+                0 <= xPixel && xPixel < viewWidth
+                && 0 <= yPixel && yPixel < viewHeight;
+        if (isVisible) {
+            const int iCell = (yPixel / cellSize) * gridWidth + xPixel / cellSize;
+            isVisible = !d->m_lodGrid[iCell];
+            d->m_lodGrid[iCell] = true;
+        }
+        d->setTextVisible(i, isVisible);
+    }
+
+    if (!this->hasDirtyTexts())
+        return false;
+    return this->updateDirtyTexts();
+}
+
+void AIS_Text::reserveTexts(unsigned count)
+{
+    d->m_textProps.reserve(count);
 }
 
 //! Sets the position of the \p i-th displayed text to \p pos
 void AIS_Text::setPosition(const gp_Pnt& pos, unsigned i)
 {
-    if (this->isValidTextIndex(i))
+    if (this->isValidTextIndex(i)) {
         d->m_textProps[i].m_position = pos;
+        d->setTextDirty(i);
+    }
 }
 
 //! Sets the \p i-th displayed text to \p v
 void AIS_Text::setText(const TCollection_ExtendedString &v, unsigned i)
 {
-    if (this->isValidTextIndex(i))
+    if (this->isValidTextIndex(i)) {
         d->m_textProps[i].m_text = v;
+        d->setTextDirty(i);
+    }
 }
 
 /*! \brief Sets the color of the \p i-th text background to \p color
@@ -226,20 +579,29 @@ void AIS_Text::setText(const TCollection_ExtendedString &v, unsigned i)
  */
 void AIS_Text::setTextBackgroundColor(const Quantity_Color& color, unsigned i)
 {
-    if (this->isValidTextIndex(i))
-        this->graphicTextAspect(i)->SetColorSubTitle(color);
+    if (this->isValidTextIndex(i)) {
+        d->modifyTextAspect(i, [&] (internal::TextAspectKey* key) {
+            key->setBackgroundColor(color);
+        });
+    }
 }
 
 void AIS_Text::setTextDisplayMode(Aspect_TypeOfDisplayText mode, unsigned i)
 {
-    if (this->isValidTextIndex(i))
-        this->graphicTextAspect(i)->SetDisplayType(mode);
+    if (this->isValidTextIndex(i)) {
+        d->modifyTextAspect(i, [=] (internal::TextAspectKey* key) {
+            key->displayMode = mode;
+        });
+    }
 }
 
 void AIS_Text::setTextStyle(Aspect_TypeOfStyleText style, unsigned i)
 {
-    if (this->isValidTextIndex(i))
-        this->graphicTextAspect(i)->SetStyle(style);
+    if (this->isValidTextIndex(i)) {
+        d->modifyTextAspect(i, [=] (internal::TextAspectKey* key) {
+            key->style = style;
+        });
+    }
 }
 
 void AIS_Text::setDefaultColor(const Quantity_Color &c)
@@ -275,13 +637,12 @@ void AIS_Text::Compute(
         const Handle_Prs3d_Presentation& pres,
         const Standard_Integer /*mode*/)
 {
-    const auto txtCount = this->textsCount();
-    for (unsigned i = 0; i < txtCount; ++i) {
-        Prs3d_Text::Draw(
-                    pres,
-                    this->presentationTextAspect(i),
-                    this->text(i),
-                    this->position(i));
+    d->m_presentation = pres;
+    d->m_blockGroups.clear();
+    const unsigned blockCount = d->blockCount();
+    for (unsigned iBlock = 0; iBlock < blockCount; ++iBlock) {
+        d->m_blockGroups.push_back(Prs3d_Root::NewGroup(pres));
+        d->drawBlock(iBlock);
     }
 }
 
@@ -26,11 +26,14 @@
 #include <Handle_Prs3d_Presentation.hxx>
 #include <Handle_Prs3d_Projector.hxx>
 #include <Handle_Prs3d_TextAspect.hxx>
+#include <Handle_V3d_View.hxx>
 #include <PrsMgr_PresentationManager3d.hxx>
 #include <SelectMgr_Selection.hxx>
 #include <Quantity_Color.hxx>
 #include <TCollection_ExtendedString.hxx>
 
+#include <iterator>
+
 namespace occ {
 
 class OCCTOOLS_EXPORT AIS_Text : public AIS_InteractiveObject
@@ -44,6 +47,7 @@ public:
 
     Handle_Prs3d_TextAspect presentationTextAspect(unsigned i = 0) const;
     Handle_Graphic3d_AspectText3d graphicTextAspect(unsigned i = 0) const;
+    unsigned sharedTextAspectCount() const;
 
     void setDefaultColor(const Quantity_Color& c);
     void setDefaultFont(const char* fontName);
@@ -65,6 +69,21 @@ public:
     unsigned textsCount() const;
     void addText(const TCollection_ExtendedString& text, const gp_Pnt& pos);
 
+    template<typename FWD_ITERATOR>
+    void addTexts(FWD_ITERATOR iBegin, FWD_ITERATOR iEnd);
+
+    bool hasDirtyTexts() const;
+    bool isTextDirty(unsigned i) const;
+    bool updateDirtyTexts();
+
+    // Level of detail
+    bool isLodEnabled() const;
+    void setLodEnabled(bool on);
+    int lodCellSize() const;
+    void setLodCellSize(int pixels);
+    bool isTextVisible(unsigned i) const;
+    bool updateLod(const Handle_V3d_View& view);
+
     // --- Implementation
 protected:
     void Compute(
@@ -79,8 +98,40 @@ protected:
             const Standard_Integer mode) override;
 
 private:
+    void reserveTexts(unsigned count);
+
     class Private;
     Private* const d;
 };
 
+
+
+// --
+// -- Implementation
+// --
+
+/*! \brief Adds the text items denoted between the begin and end iterators
+ *         \p iBegin and \p iEnd
+ *
+ *  This is equivalent to calling addText() for each item, but storage is
+ *  allocated once. New texts are dirty, so if the object is already displayed
+ *  they can be drawn with a single call to updateDirtyTexts().
+ *
+ *  \note The value type of \p iBegin and \p iEnd (accessed with operator*)
+ *        must be a pair-like type whose \c first member is the text (convertible
+ *        to TCollection_ExtendedString) and \c second member is the position
+ *        (gp_Pnt)
+ */
+template<typename FWD_ITERATOR>
+void AIS_Text::addTexts(FWD_ITERATOR iBegin, FWD_ITERATOR iEnd)
+{
+    this->reserveTexts(
+                this->textsCount()
+                + static_cast<unsigned>(std::distance(iBegin, iEnd)));
+    while (iBegin != iEnd) {
+        this->addText((*iBegin).first, (*iBegin).second);
+        ++iBegin;
+    }
+}
+
 } // namespace occ
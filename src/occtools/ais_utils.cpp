@@ -25,15 +25,21 @@ namespace occ {
 /*! \class AisUtils
  *  \brief Collection of tools for the AIS package
  *
+ *  Functions displaying or erasing objects optionally keep an AisSceneBounds
+ *  up to date, so QtView::fitAll() does not have to traverse the scene
+ *
  *  \headerfile ais_utils.h <occtools/ais_utils.h>
  *  \ingroup occtools
  */
 
 void AisUtils::eraseObjectFromContext(
         const Handle_AIS_InteractiveObject &object,
-        const Handle_AIS_InteractiveContext &context)
+        const Handle_AIS_InteractiveContext &context,
+        AisSceneBounds* sceneBounds)
 {
     if (!object.IsNull()) {
+        if (sceneBounds != NULL)
+            sceneBounds->remove(object);
         context->Erase(object, Standard_False);
         context->Remove(object, Standard_False);
 #if OCC_VERSION_HEX < 0x060900
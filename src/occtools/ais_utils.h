@@ -16,7 +16,9 @@
 #pragma once
 
 #include "occtools.h"
+#include "ais_scene_bounds.h"
 
+#include <AIS_InteractiveContext.hxx>
 #include <Handle_AIS_InteractiveContext.hxx>
 #include <Handle_AIS_InteractiveObject.hxx>
 
@@ -27,7 +29,146 @@ class OCCTOOLS_EXPORT AisUtils
 public:
     static void eraseObjectFromContext(
             const Handle_AIS_InteractiveObject& object,
-            const Handle_AIS_InteractiveContext& context);
+            const Handle_AIS_InteractiveContext& context,
+            AisSceneBounds* sceneBounds = NULL);
+
+    // Bulk operations, the viewer is updated once
+    template<typename FWD_ITERATOR>
+    static void displayObjects(
+            FWD_ITERATOR iBegin,
+            FWD_ITERATOR iEnd,
+            const Handle_AIS_InteractiveContext& context,
+            AisSceneBounds* sceneBounds = NULL);
+
+    template<typename FWD_ITERATOR>
+    static void redisplayObjects(
+            FWD_ITERATOR iBegin,
+            FWD_ITERATOR iEnd,
+            const Handle_AIS_InteractiveContext& context,
+            AisSceneBounds* sceneBounds = NULL);
+
+    template<typename FWD_ITERATOR>
+    static void eraseObjects(
+            FWD_ITERATOR iBegin,
+            FWD_ITERATOR iEnd,
+            const Handle_AIS_InteractiveContext& context,
+            AisSceneBounds* sceneBounds = NULL);
+
+    template<typename FWD_ITERATOR>
+    static void eraseObjectsFromContext(
+            FWD_ITERATOR iBegin,
+            FWD_ITERATOR iEnd,
+            const Handle_AIS_InteractiveContext& context,
+            AisSceneBounds* sceneBounds = NULL);
 };
 
+
+
+// --
+// -- Implementation
+// --
+
+/*! Displays the interactive objects denoted between the begin and end
+ *  iterators \p iBegin and \p iEnd, then updates the current viewer once
+ *
+ *  \note The value type of \p iBegin and \p iEnd (accessed with operator*) must
+ *        be convertible to Handle_AIS_InteractiveObject
+ *
+ *  If \p sceneBounds is not NULL then the displayed objects are added to it
+ */
+template<typename FWD_ITERATOR>
+void AisUtils::displayObjects(
+        FWD_ITERATOR iBegin,
+        FWD_ITERATOR iEnd,
+        const Handle_AIS_InteractiveContext& context,
+        AisSceneBounds* sceneBounds)
+{
+    while (iBegin != iEnd) {
+        const Handle_AIS_InteractiveObject object = *iBegin;
+        if (!object.IsNull()) {
+            context->Display(object, Standard_False);
+            if (sceneBounds != NULL)
+                sceneBounds->add(object);
+        }
+        ++iBegin;
+    }
+    context->UpdateCurrentViewer();
+}
+
+/*! Recomputes the presentations of the interactive objects denoted between
+ *  \p iBegin and \p iEnd, then updates the current viewer once
+ *
+ *  If \p sceneBounds is not NULL then the boxes of the redisplayed objects it
+ *  tracks are recomputed
+ *
+ *  \sa displayObjects()
+ */
+template<typename FWD_ITERATOR>
+void AisUtils::redisplayObjects(
+        FWD_ITERATOR iBegin,
+        FWD_ITERATOR iEnd,
+        const Handle_AIS_InteractiveContext& context,
+        AisSceneBounds* sceneBounds)
+{
+    while (iBegin != iEnd) {
+        const Handle_AIS_InteractiveObject object = *iBegin;
+        if (!object.IsNull()) {
+            context->Redisplay(object, Standard_False);
+            if (sceneBounds != NULL && sceneBounds->contains(object))
+                sceneBounds->add(object);
+        }
+        ++iBegin;
+    }
+    context->UpdateCurrentViewer();
+}
+
+/*! Hides the interactive objects denoted between \p iBegin and \p iEnd, then
+ *  updates the current viewer once
+ *
+ *  Objects are still loaded in \p context and can be displayed again. If
+ *  \p sceneBounds is not NULL then the erased objects are removed from it
+ *
+ *  \sa displayObjects()
+ */
+template<typename FWD_ITERATOR>
+void AisUtils::eraseObjects(
+        FWD_ITERATOR iBegin,
+        FWD_ITERATOR iEnd,
+        const Handle_AIS_InteractiveContext& context,
+        AisSceneBounds* sceneBounds)
+{
+    while (iBegin != iEnd) {
+        const Handle_AIS_InteractiveObject object = *iBegin;
+        if (!object.IsNull()) {
+            context->Erase(object, Standard_False);
+            if (sceneBounds != NULL)
+                sceneBounds->remove(object);
+        }
+        ++iBegin;
+    }
+    context->UpdateCurrentViewer();
+}
+
+/*! Calls eraseObjectFromContext() for each interactive object denoted between
+ *  \p iBegin and \p iEnd, then updates the current viewer once
+ *
+ *  If \p sceneBounds is not NULL then the boxes of the redisplayed objects are
+ *  recomputed
+ *
+ *  \sa displayObjects()
+ */
+template<typename FWD_ITERATOR>
+void AisUtils::eraseObjectsFromContext(
+        FWD_ITERATOR iBegin,
+        FWD_ITERATOR iEnd,
+        const Handle_AIS_InteractiveContext& context,
+        AisSceneBounds* sceneBounds)
+{
+    while (iBegin != iEnd) {
+        AisUtils::eraseObjectFromContext(*iBegin, context, sceneBounds);
+        ++iBegin;
+    }
+    context->UpdateCurrentViewer();
+}
+
 } // namespace occ
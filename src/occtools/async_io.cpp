@@ -0,0 +1,245 @@
+/****************************************************************************
+**  FougTools
+**  Copyright Fougue (30 Mar. 2015)
+**  contact@fougue.pro
+**
+** This software is a computer program whose purpose is to provide utility
+** tools for the C++ language and the Qt toolkit.
+**
+** This software is governed by the CeCILL-C license under French law and
+** abiding by the rules of distribution of free software.  You can  use,
+** modify and/ or redistribute the software under the terms of the CeCILL-C
+** license as circulated by CEA, CNRS and INRIA at the following URL
+** "http://www.cecill.info".
+****************************************************************************/
+
+
+#include "async_io.h"
+
+#include "../qttools/task/manager.h"
+
+#include <BRepBuilderAPI_Copy.hxx>
+#include <Message_ProgressIndicator.hxx>
+#include <Standard_Failure.hxx>
+
+#include <QtCore/QCoreApplication>
+#include <QtCore/QTimer>
+
+namespace occ {
+
+namespace internal {
+
+//! Forwards the progress of OpenCascade algorithms to a qttask::Progress, and
+//! the abort requests of the task to the algorithms
+class TaskProgressIndicator : public Message_ProgressIndicator
+{
+public:
+    TaskProgressIndicator(qttask::Progress* progress)
+        : m_progress(progress)
+    { }
+
+    Standard_Boolean Show(const Standard_Boolean /*force*/) override
+    {
+        m_progress->setValue(static_cast<int>(100. * this->GetPosition()));
+        return Standard_True;
+    }
+
+    Standard_Boolean UserBreak() override
+    {
+        return m_progress->isAbortRequested() ? Standard_True : Standard_False;
+    }
+
+private:
+    qttask::Progress* m_progress;
+};
+
+static QString exportTaskTitle(IO::Format format)
+{
+    switch (format) {
+    case IO::IgesFormat: return QCoreApplication::translate("occ::AsyncIO", "IGES export");
+    case IO::StepFormat: return QCoreApplication::translate("occ::AsyncIO", "STEP export");
+    case IO::OccBrepFormat: return QCoreApplication::translate("occ::AsyncIO", "BREP export");
+    case IO::AsciiStlFormat:
+    case IO::BinaryStlFormat: return QCoreApplication::translate("occ::AsyncIO", "STL export");
+    case IO::UnknownFormat: break;
+    }
+    return QString();
+}
+
+static void postToMainThread(const std::function<void()>& func)
+{
+    QTimer::singleShot(0, QCoreApplication::instance(), func);
+}
+
+} // namespace internal
+
+/*! \class AsyncIO
+ *  \brief Runs IO operations in background tasks of qttask::Manager
+ *
+ *  IO::writeStepFile() and IO::writeIgesFile() can block for tens of seconds
+ *  on large assemblies. The functions of AsyncIO return immediately. The
+ *  transfer and write run in a qttask::Runner<QThread> task registered in
+ *  qttask::Manager::globalInstance(), and each function returns the ID of that
+ *  task.
+ *
+ *  The task reports progress through qttask::Progress, so the usual task
+ *  notifications of the manager follow the export. Abort is requested with
+ *  qttask::Manager::requestAbort(), and the OpenCascade writers check it
+ *  through Message_ProgressIndicator::UserBreak().
+ *
+ *  The optional callback is executed in the main thread once the task ends.
+ *
+ *  \headerfile async_io.h <occtools/async_io.h>
+ *  \ingroup occtools
+ */
+
+/*! Writes \p shape to \p fileNameLocal8Bit in \p format, in a background task
+ *
+ *  The shape written is a snapshot of \p shape taken on call:
+ *    \li ShareShape : the TopoDS_Shape handle is copied, so the topology
+ *        must not be modified in place (ex: with BRep_Builder) until the
+ *        export is finished. Replacing the shape by a new one is safe
+ *    \li CopyShape : the topology and geometry are deep copied before the
+ *        call returns, with BRepBuilderAPI_Copy
+ *
+ *  STL formats don't report progress nor support abort.
+ *
+ *  \return ID of the task in qttask::Manager::globalInstance()
+ */
+quint64 AsyncIO::writeFile(
+        const TopoDS_Shape& shape,
+        const std::string& fileNameLocal8Bit,
+        IO::Format format,
+        const FinishedCallback& onFinished,
+        SnapshotMode snapshot)
+{
+    const TopoDS_Shape snapshotShape =
+            snapshot == CopyShape && !shape.IsNull() ?
+                BRepBuilderAPI_Copy(shape).Shape() :
+                shape;
+    auto task = qttask::Manager::globalInstance()->newTask<QThread>();
+    task->setTaskTitle(internal::exportTaskTitle(format));
+    const quint64 taskId = task->taskId();
+    task->run([=] {
+        qttask::Progress& progress = task->progress();
+        const Handle_Message_ProgressIndicator indicator =
+                new internal::TaskProgressIndicator(&progress);
+        const char* fileName = fileNameLocal8Bit.c_str();
+        bool isWritten = false;
+        try {
+            switch (format) {
+            case IO::IgesFormat:
+                isWritten = IO::writeIgesFile(snapshotShape, fileName, indicator);
+                break;
+            case IO::StepFormat:
+                isWritten = IO::writeStepFile(snapshotShape, fileName, indicator);
+                break;
+            case IO::OccBrepFormat:
+                isWritten = IO::writeBrepFile(snapshotShape, fileName, indicator);
+                break;
+            case IO::AsciiStlFormat:
+                IO::writeAsciiStlFile(snapshotShape, fileName);
+                isWritten = true;
+                break;
+            case IO::BinaryStlFormat:
+                IO::writeBinaryStlFile(snapshotShape, fileName);
+                isWritten = true;
+                break;
+            case IO::UnknownFormat:
+                break;
+            }
+        }
+        catch (const Standard_Failure&) {
+            isWritten = false;
+        }
+
+        const Status status =
+                progress.isAbortRequested() ? Aborted : (isWritten ? Done : Failed);
+        if (status == Done)
+            progress.setValue(100);
+        if (onFinished)
+            internal::postToMainThread([=] { onFinished(status); });
+    });
+    return taskId;
+}
+
+//! Same as writeFile() with IO::StepFormat
+quint64 AsyncIO::writeStepFile(
+        const TopoDS_Shape& shape,
+        const std::string& fileNameLocal8Bit,
+        const FinishedCallback& onFinished,
+        SnapshotMode snapshot)
+{
+    return AsyncIO::writeFile(
+                shape, fileNameLocal8Bit, IO::StepFormat, onFinished, snapshot);
+}
+
+//! Same as writeFile() with IO::IgesFormat
+quint64 AsyncIO::writeIgesFile(
+        const TopoDS_Shape& shape,
+        const std::string& fileNameLocal8Bit,
+        const FinishedCallback& onFinished,
+        SnapshotMode snapshot)
+{
+    return AsyncIO::writeFile(
+                shape, fileNameLocal8Bit, IO::IgesFormat, onFinished, snapshot);
+}
+
+/*! Loads the STEP or IGES file \p fileNameLocal8Bit root by root in a
+ *  background task, see IO::loadStepFileByRoots()
+ *
+ *  \p onRootShapeLoaded is executed in the main thread with the shape of each
+ *  root, in order, as soon as it is translated. So a viewer can display the
+ *  first components of a big assembly while the others stream in.
+ *  \p onFinished is then executed in the main thread with the whole shape
+ *  (partial if Aborted).
+ *
+ *  \return ID of the task in qttask::Manager::globalInstance()
+ */
+quint64 AsyncIO::loadFileByRoots(
+        const std::string& fileNameLocal8Bit,
+        IO::Format format,
+        const RootShapeLoadedCallback& onRootShapeLoaded,
+        const LoadFinishedCallback& onFinished)
+{
+    auto task = qttask::Manager::globalInstance()->newTask<QThread>();
+    task->setTaskTitle(
+                format == IO::IgesFormat ?
+                    QCoreApplication::translate("occ::AsyncIO", "IGES import") :
+                    QCoreApplication::translate("occ::AsyncIO", "STEP import"));
+    const quint64 taskId = task->taskId();
+    task->run([=] {
+        qttask::Progress& progress = task->progress();
+        const Handle_Message_ProgressIndicator indicator =
+                new internal::TaskProgressIndicator(&progress);
+        auto fnRootShapeLoaded = [=] (const TopoDS_Shape& rootShape, int i, int count) {
+            if (onRootShapeLoaded) {
+                internal::postToMainThread([=] {
+                    onRootShapeLoaded(rootShape, i, count);
+                });
+            }
+        };
+
+        TopoDS_Shape shape;
+        bool isLoaded = false;
+        try {
+            const char* fileName = fileNameLocal8Bit.c_str();
+            if (format == IO::IgesFormat)
+                shape = IO::loadIgesFileByRoots(fileName, fnRootShapeLoaded, indicator);
+            else if (format == IO::StepFormat)
+                shape = IO::loadStepFileByRoots(fileName, fnRootShapeLoaded, indicator);
+            isLoaded = !shape.IsNull();
+        }
+        catch (const Standard_Failure&) {
+            isLoaded = false;
+        }
+
+        const Status status =
+                progress.isAbortRequested() ? Aborted : (isLoaded ? Done : Failed);
+        if (onFinished)
+            internal::postToMainThread([=] { onFinished(status, shape); });
+    });
+    return taskId;
+}
+
+} // namespace occ
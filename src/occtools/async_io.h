@@ -0,0 +1,76 @@
+/****************************************************************************
+**  FougTools
+**  Copyright Fougue (30 Mar. 2015)
+**  contact@fougue.pro
+**
+** This software is a computer program whose purpose is to provide utility
+** tools for the C++ language and the Qt toolkit.
+**
+** This software is governed by the CeCILL-C license under French law and
+** abiding by the rules of distribution of free software.  You can  use,
+** modify and/ or redistribute the software under the terms of the CeCILL-C
+** license as circulated by CEA, CNRS and INRIA at the following URL
+** "http://www.cecill.info".
+****************************************************************************/
+
+
+#pragma once
+
+#include "occtools.h"
+#include "io.h"
+
+#include <TopoDS_Shape.hxx>
+
+#include <QtCore/QtGlobal>
+
+#include <functional>
+#include <string>
+
+namespace occ {
+
+class OCCTOOLS_EXPORT AsyncIO
+{
+public:
+    enum Status
+    {
+        Done,
+        Failed,
+        Aborted
+    };
+
+    enum SnapshotMode
+    {
+        ShareShape,
+        CopyShape
+    };
+
+    typedef std::function<void(Status)> FinishedCallback;
+
+    static quint64 writeFile(
+            const TopoDS_Shape& shape,
+            const std::string& fileNameLocal8Bit,
+            IO::Format format,
+            const FinishedCallback& onFinished = FinishedCallback(),
+            SnapshotMode snapshot = ShareShape);
+    static quint64 writeStepFile(
+            const TopoDS_Shape& shape,
+            const std::string& fileNameLocal8Bit,
+            const FinishedCallback& onFinished = FinishedCallback(),
+            SnapshotMode snapshot = ShareShape);
+    static quint64 writeIgesFile(
+            const TopoDS_Shape& shape,
+            const std::string& fileNameLocal8Bit,
+            const FinishedCallback& onFinished = FinishedCallback(),
+            SnapshotMode snapshot = ShareShape);
+
+    typedef IO::RootShapeLoadedFunction RootShapeLoadedCallback;
+    typedef std::function<void(Status, const TopoDS_Shape&)> LoadFinishedCallback;
+
+    static quint64 loadFileByRoots(
+            const std::string& fileNameLocal8Bit,
+            IO::Format format,
+            const RootShapeLoadedCallback& onRootShapeLoaded,
+            const LoadFinishedCallback& onFinished = LoadFinishedCallback());
+};
+
+} // namespace occ
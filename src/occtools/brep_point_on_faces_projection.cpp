@@ -17,68 +17,457 @@
 
 #include "math_utils.h"
 #include "topods_utils.h"
+#include "../cpptools/parallel_utils.h"
 
 #include <BRep_Tool.hxx>
+#include <BRepBndLib.hxx>
+#include <BRepTools.hxx>
+#include <Bnd_Box.hxx>
 #include <GeomAPI_ProjectPointOnSurf.hxx>
+#include <Geom_ElementarySurface.hxx>
 #include <Geom_Surface.hxx>
+#include <Precision.hxx>
 #include <TopExp_Explorer.hxx>
 #include <TopoDS.hxx>
 #include <algorithm>
 #include <functional>
-#include <cassert>
+#include <list>
 #include <limits>
 #include <vector>
 
 namespace occ {
 
-class BRepPointOnFacesProjection::Private
+namespace internal {
+
+//! Axis-aligned bounding box of a face, sides are infinite if the box is open
+struct FaceBndBox
+{
+    double min[3];
+    double max[3];
+};
+
+//! Data of a loaded face, shared by all the projectors
+struct FaceInfo
+{
+    TopoDS_Face face;
+    Handle_Geom_Surface surface;
+    double uMin;
+    double uMax;
+    double vMin;
+    double vMax;
+    FaceBndBox box;
+};
+
+static FaceBndBox faceBndBox(const TopoDS_Face& face)
+{
+    // Box of the surface patch delimited by the UV bounds of the face, so it
+    // encloses all the solutions of the face projector
+    Bnd_Box bndBox;
+    BRepBndLib::Add(face, bndBox, Standard_False);
+
+    FaceBndBox box;
+    if (bndBox.IsVoid() == Standard_True || bndBox.IsWhole() == Standard_True) {
+        const double inf = std::numeric_limits<double>::max();
+        std::fill(box.min, box.min + 3, -inf);
+        std::fill(box.max, box.max + 3, inf);
+    }
+    else {
+        bndBox.Get(box.min[0], box.min[1], box.min[2],
+                   box.max[0], box.max[1], box.max[2]);
+    }
+    return box;
+}
+
+//! Lower bound of the squared distance between \p pnt and points inside \p box
+static double sqrDistanceToBox(const gp_Pnt& pnt, const FaceBndBox& box)
+{
+    const double coords[3] = { pnt.X(), pnt.Y(), pnt.Z() };
+    double sqrDist = 0.;
+    for (int i = 0; i < 3; ++i) {
+        double delta = 0.;
+        if (coords[i] < box.min[i])
+            delta = box.min[i] - coords[i];
+        else if (coords[i] > box.max[i])
+            delta = coords[i] - box.max[i];
+        sqrDist += delta * delta;
+    }
+    return sqrDist;
+}
+
+/*! Set of GeomAPI_ProjectPointOnSurf objects, one per face
+ *
+ *  GeomAPI_ProjectPointOnSurf keeps the solutions of the last query inside,
+ *  so a set must not be used by concurrent threads. Projectors are allocated
+ *  on first use.\n
+ *  When the count of allocated projectors reaches maxCount() (if not zero),
+ *  the least recently used projector is destroyed before a new one is
+ *  allocated.
+ */
+class FaceProjectorSet
 {
 public:
-    typedef std::pair<GeomAPI_ProjectPointOnSurf*, TopoDS_Face> ProjectorInfo;
-    struct ProjectorCompare
+    FaceProjectorSet(const std::vector<FaceInfo>* faces, std::size_t maxCount = 0)
+        : m_faces(faces),
+          m_maxCount(maxCount)
+    { }
+
+    ~FaceProjectorSet()
+    {
+        this->clear();
+    }
+
+    GeomAPI_ProjectPointOnSurf* projector(std::size_t faceId)
+    {
+        if (m_entries.size() != m_faces->size())
+            m_entries.resize(m_faces->size());
+        Entry& entry = m_entries[faceId];
+        if (entry.projector != NULL) {
+            // Move to the front of the LRU list
+            m_lruFaceIds.splice(m_lruFaceIds.begin(), m_lruFaceIds, entry.lruPos);
+            return entry.projector;
+        }
+
+        if (m_maxCount > 0) {
+            while (m_lruFaceIds.size() >= m_maxCount)
+                this->destroy(m_lruFaceIds.back());
+        }
+        const FaceInfo& info = m_faces->at(faceId);
+        entry.projector = new GeomAPI_ProjectPointOnSurf(
+                    occ::origin3d, info.surface,
+                    info.uMin, info.uMax, info.vMin, info.vMax);
+        m_lruFaceIds.push_front(faceId);
+        entry.lruPos = m_lruFaceIds.begin();
+        return entry.projector;
+    }
+
+    std::size_t count() const
     {
-        bool operator()(
-                const ProjectorInfo& lhs, const ProjectorInfo& rhs) const;
+        return m_lruFaceIds.size();
+    }
+
+    //! Estimated count of bytes allocated by the projectors and the LRU list
+    std::size_t memoryUsage() const
+    {
+        // Extrema_GenExtPS samples non-elementary surfaces on a grid of
+        // about 32x32 points, each point kept with its UV parameters
+        const std::size_t gridBytes = 32 * 32 * (sizeof(gp_Pnt) + 2 * sizeof(double));
+        const std::size_t lruNodeBytes = sizeof(std::size_t) + 2 * sizeof(void*);
+        std::size_t bytes = m_entries.capacity() * sizeof(Entry);
+        for (std::size_t faceId : m_lruFaceIds) {
+            bytes += sizeof(GeomAPI_ProjectPointOnSurf) + lruNodeBytes;
+            const Handle_Geom_Surface& surface = m_faces->at(faceId).surface;
+            if (!surface->IsKind(STANDARD_TYPE(Geom_ElementarySurface)))
+                bytes += gridBytes;
+        }
+        return bytes;
+    }
+
+    std::size_t maxCount() const
+    {
+        return m_maxCount;
+    }
+
+    void setMaxCount(std::size_t maxCount)
+    {
+        m_maxCount = maxCount;
+        if (m_maxCount > 0) {
+            while (m_lruFaceIds.size() > m_maxCount)
+                this->destroy(m_lruFaceIds.back());
+        }
+    }
+
+    void clear()
+    {
+        for (const Entry& entry : m_entries)
+            delete entry.projector;
+        m_entries.clear();
+        m_lruFaceIds.clear();
+    }
+
+private:
+    struct Entry
+    {
+        Entry() : projector(NULL) { }
+        GeomAPI_ProjectPointOnSurf* projector;
+        std::list<std::size_t>::iterator lruPos;
     };
 
+    FaceProjectorSet(const FaceProjectorSet&);
+    FaceProjectorSet& operator=(const FaceProjectorSet&);
+
+    void destroy(std::size_t faceId)
+    {
+        Entry& entry = m_entries[faceId];
+        delete entry.projector;
+        entry.projector = NULL;
+        m_lruFaceIds.erase(entry.lruPos);
+    }
+
+    const std::vector<FaceInfo>* m_faces;
+    std::size_t m_maxCount;
+    std::vector<Entry> m_entries;
+    std::list<std::size_t> m_lruFaceIds; // Most recently used first
+};
+
+static bool hasSolution(const GeomAPI_ProjectPointOnSurf* projector)
+{
+    return projector != NULL && projector->IsDone() && projector->NbPoints() > 0;
+}
+
+//! Projection of a point on a face, the face index is -1 if there is no solution
+struct FaceSolution
+{
+    FaceSolution()
+        : faceId(-1), point(occ::origin3d), u(0.), v(0.)
+    { }
+
+    int faceId;
+    gp_Pnt point;
+    double u;
+    double v;
+};
+
+/*! Newton iterations minimizing the distance between \p pnt and the surface
+ *  of \p info, starting from (\p *u, \p *v)
+ *
+ *  Returns false if the iterations do not converge to a point strictly
+ *  inside the UV bounds of the face.
+ */
+static bool localSurfaceProjection(
+        const gp_Pnt& pnt, const FaceInfo& info, double* u, double* v)
+{
+    const int maxIterationCount = 8;
+    const double tol = Precision::Confusion();
+    for (int i = 0; i < maxIterationCount; ++i) {
+        gp_Pnt surfPnt;
+        gp_Vec du, dv, duu, dvv, duv;
+        info.surface->D2(*u, *v, surfPnt, du, dv, duu, dvv, duv);
+
+        // Solve "(S(u,v) - pnt).dS = 0" with Newton
+        const gp_Vec r(pnt, surfPnt);
+        const double f1 = r.Dot(du);
+        const double f2 = r.Dot(dv);
+        const double j11 = du.Dot(du) + r.Dot(duu);
+        const double j12 = du.Dot(dv) + r.Dot(duv);
+        const double j22 = dv.Dot(dv) + r.Dot(dvv);
+        const double det = j11 * j22 - j12 * j12;
+        if (j11 <= 0. || det <= 0.) // Not a local minimum of the distance
+            return false;
+
+        const double stepU = (j22 * f1 - j12 * f2) / det;
+        const double stepV = (j11 * f2 - j12 * f1) / det;
+        *u -= stepU;
+        *v -= stepV;
+        if (!(info.uMin < *u && *u < info.uMax && info.vMin < *v && *v < info.vMax))
+            return false; // Solution may be on a neighbour face
+        if ((du * stepU + dv * stepV).SquareMagnitude() < tol * tol)
+            return true;
+    }
+    return false;
+}
+
+} // namespace internal
+
+class BRepPointOnFacesProjection::Private
+{
+public:
+    //! Squared distance from the point to the box of a face, index of the face
+    typedef std::pair<double, std::size_t> Candidate;
+
     Private();
 
-    std::vector<ProjectorInfo> m_projectors;
-    ProjectorInfo m_solProjector;
+    internal::FaceSolution solution(
+            const gp_Pnt& point,
+            internal::FaceProjectorSet* projectors,
+            std::vector<Candidate>* candidates,
+            const internal::FaceSolution* seed) const;
+    internal::FaceSolution nearestSolution(
+            const gp_Pnt& point,
+            internal::FaceProjectorSet* projectors,
+            std::vector<Candidate>* candidates) const;
+    bool localSolution(
+            const gp_Pnt& point,
+            const internal::FaceSolution& seed,
+            internal::FaceSolution* sol) const;
+    BRepPointOnFacesProjection::Result result(
+            const internal::FaceSolution& sol) const;
+
+    std::vector<internal::FaceInfo> m_faces;
+    internal::FaceProjectorSet m_projectors; // Used by compute()
+    std::vector<Candidate> m_candidates; // Buffer reused by compute()
+    internal::FaceSolution m_sol;
+    bool m_isCoherentQueryEnabled;
 };
 
 BRepPointOnFacesProjection::Private::Private()
-    : m_solProjector(static_cast<GeomAPI_ProjectPointOnSurf*>(NULL), TopoDS_Face())
+    : m_projectors(&m_faces),
+      m_isCoherentQueryEnabled(false)
 {
 }
 
-bool BRepPointOnFacesProjection::Private::ProjectorCompare::operator()(
-        const ProjectorInfo &lhs,
-        const ProjectorInfo &rhs) const
+/*! Returns the projection of \p point, first tried locally around \p seed
+ *  if not null
+ *
+ *  Only \p projectors and \p candidates are modified, so concurrent calls are
+ *  safe as long as each thread provides its own objects.
+ */
+internal::FaceSolution BRepPointOnFacesProjection::Private::solution(
+        const gp_Pnt& point,
+        internal::FaceProjectorSet* projectors,
+        std::vector<Candidate>* candidates,
+        const internal::FaceSolution* seed) const
 {
-    double p1Dist = std::numeric_limits<double>::max();
-    double p2Dist = std::numeric_limits<double>::max();
-    if (lhs.first->IsDone() && lhs.first->NbPoints() > 0)
-        p1Dist = lhs.first->LowerDistance();
-    if (rhs.first->IsDone() && rhs.first->NbPoints() > 0)
-        p2Dist = rhs.first->LowerDistance();
-    return p1Dist < p2Dist;
+    internal::FaceSolution sol;
+    if (seed != NULL && seed->faceId != -1 && this->localSolution(point, *seed, &sol))
+        return sol;
+    return this->nearestSolution(point, projectors, candidates);
+}
+
+/*! Returns the projection of \p point at minimal distance on all faces
+ *
+ *  Faces are visited by increasing distance of \p point to their bounding box,
+ *  the visit stops when no remaining face can contain a nearer solution.
+ */
+internal::FaceSolution BRepPointOnFacesProjection::Private::nearestSolution(
+        const gp_Pnt& point,
+        internal::FaceProjectorSet* projectors,
+        std::vector<Candidate>* candidates) const
+{
+    // Min-heap of faces ordered by the distance of point to their bounding box
+    candidates->clear();
+    for (std::size_t i = 0; i < m_faces.size(); ++i) {
+        const double boxSqrDist = internal::sqrDistanceToBox(point, m_faces[i].box);
+        candidates->push_back(Candidate(boxSqrDist, i));
+    }
+    const std::greater<Candidate> fnHeapCompare;
+    std::make_heap(candidates->begin(), candidates->end(), fnHeapCompare);
+
+    internal::FaceSolution sol;
+    double minSqrDist = std::numeric_limits<double>::max();
+    while (!candidates->empty()) {
+        std::pop_heap(candidates->begin(), candidates->end(), fnHeapCompare);
+        const Candidate candidate = candidates->back();
+        candidates->pop_back();
+        if (candidate.first >= minSqrDist)
+            break; // Remaining faces cannot contain a nearer solution
+
+        // Solution is copied at once, the projector may be destroyed by the
+        // next allocations if the count of projectors is limited
+        GeomAPI_ProjectPointOnSurf* projector =
+                projectors->projector(candidate.second);
+        projector->Perform(point);
+        if (internal::hasSolution(projector)) {
+            const double dist = projector->LowerDistance();
+            if (dist * dist < minSqrDist) {
+                minSqrDist = dist * dist;
+                sol.faceId = static_cast<int>(candidate.second);
+                sol.point = projector->NearestPoint();
+                projector->LowerDistanceParameters(sol.u, sol.v);
+            }
+        }
+    }
+    return sol;
+}
+
+/*! Tries to project \p point on the face of \p seed with Newton iterations
+ *  starting at the UV parameters of \p seed
+ *
+ *  The local solution is accepted only if no other face has its bounding box
+ *  nearer to \p point, so the result is the same as with nearestSolution()
+ *  as long as the distance function has a single minimum on the seed face.
+ */
+bool BRepPointOnFacesProjection::Private::localSolution(
+        const gp_Pnt& point,
+        const internal::FaceSolution& seed,
+        internal::FaceSolution* sol) const
+{
+    const internal::FaceInfo& info = m_faces[seed.faceId];
+    double u = seed.u;
+    double v = seed.v;
+    if (!internal::localSurfaceProjection(point, info, &u, &v))
+        return false;
+
+    const gp_Pnt solPnt = info.surface->Value(u, v);
+    const double solSqrDist = point.SquareDistance(solPnt);
+    for (std::size_t i = 0; i < m_faces.size(); ++i) {
+        if (static_cast<int>(i) != seed.faceId
+                && internal::sqrDistanceToBox(point, m_faces[i].box) < solSqrDist)
+        {
+            return false;
+        }
+    }
+
+    sol->faceId = seed.faceId;
+    sol->point = solPnt;
+    sol->u = u;
+    sol->v = v;
+    return true;
+}
+
+BRepPointOnFacesProjection::Result BRepPointOnFacesProjection::Private::result(
+        const internal::FaceSolution& sol) const
+{
+    BRepPointOnFacesProjection::Result res;
+    if (sol.faceId != -1) {
+        res.isValid = true;
+        res.face = m_faces[sol.faceId].face;
+        res.point = sol.point;
+        res.uv = std::make_pair(sol.u, sol.v);
+        res.normal = occ::TopoDsUtils::normalToFaceAtUV(res.face, sol.u, sol.v);
+    }
+    return res;
 }
 
 /*! \class BRepPointOnFacesProjection
  *  \brief Framework to perform normal point projection on a soup of topologic faces
  *
  *  Internally, the utility class GeomAPI_ProjectPointOnSurf is heavily used.
- *  \n The algorithmics are pretty slow : for a point to be projected, the
- *  projection of that point is performed on each loaded TopoDS_Face with the
- *  help of GeomAPI_ProjectPointOnSurf.\n
- *  The minimal distance amongst all the projection candidates is computed to
- *  get the final projected point
+ *  \n For a point to be projected, the loaded TopoDS_Face objects are visited
+ *  by increasing distance to their bounding box, the projection of that point
+ *  is performed on each visited face with the help of
+ *  GeomAPI_ProjectPointOnSurf. The visit stops as soon as the distance to the
+ *  next bounding box is greater than the minimal projection distance found,
+ *  so faces far from the point are never evaluated.\n
+ *  Projection on a face is restricted to the UV bounds of that face.
+ *
+ *  When points to be projected are ordered along a path, consecutive points
+ *  project near each other. In "coherent query" mode (see
+ *  setCoherentQueryEnabled()), the solution of the previous query is used as
+ *  a seed : a local Newton search is tried first on the previous solution
+ *  face, and the full search is performed only if it fails.
+ *
+ *  compute() stores its solution inside the object, so it must not be called
+ *  concurrently. projected() functions are const and thread-safe : they use
+ *  their own projector objects and return solutions by value.
  *
  *  \headerfile brep_point_on_faces_projection.h <occtools/brep_point_on_faces_projection.h>
  *  \ingroup occtools
  */
 
+/*! \struct BRepPointOnFacesProjection::Result
+ *  \brief Solution of a point projection, returned by projected()
+ */
+
+BRepPointOnFacesProjection::Result::Result()
+    : isValid(false),
+      point(occ::origin3d),
+      uv(0., 0.),
+      normal(0., 0., 1.)
+{
+}
+
+BRepPointOnFacesProjection::MemoryUsage::MemoryUsage()
+    : faceBytes(0),
+      projectorBytes(0),
+      projectorCount(0)
+{
+}
+
+std::size_t BRepPointOnFacesProjection::MemoryUsage::totalBytes() const
+{
+    return faceBytes + projectorBytes;
+}
+
 //! Construct an uninitialized BRepPointOnFacesProjection
 BRepPointOnFacesProjection::BRepPointOnFacesProjection()
     : d(new Private)
@@ -86,10 +475,11 @@ BRepPointOnFacesProjection::BRepPointOnFacesProjection()
 }
 
 //! Construct a BRepPointOnFacesProjection and call prepare() on \p faces
-BRepPointOnFacesProjection::BRepPointOnFacesProjection(const TopoDS_Shape& faces)
+BRepPointOnFacesProjection::BRepPointOnFacesProjection(
+        const TopoDS_Shape& faces, ProjectorAllocation alloc)
     : d(new Private)
 {
-    this->prepare(faces);
+    this->prepare(faces, alloc);
 }
 
 BRepPointOnFacesProjection::~BRepPointOnFacesProjection()
@@ -100,83 +490,207 @@ BRepPointOnFacesProjection::~BRepPointOnFacesProjection()
 
 /*! \brief Setup the algorithm to project points on \p faces
  *  \param faces A soup of topologic faces
+ *  \param alloc  With LazyAllocation, the GeomAPI_ProjectPointOnSurf object
+ *                of a face is created the first time a query visits that
+ *                face. This saves memory and setup time on big shapes where
+ *                most faces are never hit.
  */
-void BRepPointOnFacesProjection::prepare(const TopoDS_Shape& faces)
+void BRepPointOnFacesProjection::prepare(
+        const TopoDS_Shape& faces, ProjectorAllocation alloc)
 {
     this->releaseMemory();
 
-    // Allocate a projector for each face
+    // Compute the UV bounds and the bounding box of each face
     for (TopExp_Explorer exp(faces, TopAbs_FACE); exp.More(); exp.Next()) {
-        const TopoDS_Face& iFace = TopoDS::Face(exp.Current());
-        const Handle_Geom_Surface& iSurf = BRep_Tool::Surface(iFace);
-        auto projector = new GeomAPI_ProjectPointOnSurf(occ::origin3d, iSurf);
-        d->m_projectors.push_back(Private::ProjectorInfo(projector, iFace));
+        internal::FaceInfo info;
+        info.face = TopoDS::Face(exp.Current());
+        info.surface = BRep_Tool::Surface(info.face);
+        BRepTools::UVBounds(info.face, info.uMin, info.uMax, info.vMin, info.vMax);
+        info.box = internal::faceBndBox(info.face);
+        d->m_faces.push_back(info);
+    }
+
+    // Allocate a projector for each face, within the limit of projectors
+    if (alloc == EagerAllocation) {
+        const std::size_t maxCount = d->m_projectors.maxCount();
+        for (std::size_t i = 0; i < d->m_faces.size(); ++i) {
+            if (maxCount > 0 && i >= maxCount)
+                break;
+            d->m_projectors.projector(i);
+        }
     }
 }
 
 void BRepPointOnFacesProjection::releaseMemory()
 {
     // Destroy allocated projectors
-    for (auto proj : d->m_projectors)
-        delete proj.first;
     d->m_projectors.clear();
+    d->m_faces.clear();
+    d->m_candidates.clear();
+    d->m_sol = internal::FaceSolution();
 }
 
 BRepPointOnFacesProjection& BRepPointOnFacesProjection::compute(const gp_Pnt& point)
 {
-    for (auto proj : d->m_projectors)
-        proj.first->Perform(point);
-
-    auto iResult = std::min_element(
-                d->m_projectors.begin(),
-                d->m_projectors.end(),
-                Private::ProjectorCompare());
-    assert(iResult != d->m_projectors.end() && "always_a_minimum");
-    d->m_solProjector = *iResult;
+    const internal::FaceSolution* seed =
+            d->m_isCoherentQueryEnabled ? &d->m_sol : NULL;
+    d->m_sol = d->solution(point, &d->m_projectors, &d->m_candidates, seed);
     return *this;
 }
 
 bool BRepPointOnFacesProjection::isDone() const
 {
-    const GeomAPI_ProjectPointOnSurf* projector = d->m_solProjector.first;
-    if (projector != NULL)
-        return projector->IsDone() && projector->NbPoints() > 0;
-    return false;
+    return d->m_sol.faceId != -1;
 }
 
 const TopoDS_Face& BRepPointOnFacesProjection::solutionFace() const
 {
     static TopoDS_Face emptyFace;
     if (this->isDone())
-        return d->m_solProjector.second;
+        return d->m_faces[d->m_sol.faceId].face;
     return emptyFace;
 }
 
 gp_Pnt BRepPointOnFacesProjection::solutionPoint() const
 {
     if (this->isDone())
-        return d->m_solProjector.first->NearestPoint();
+        return d->m_sol.point;
     return occ::origin3d;
 }
 
 std::pair<double, double> BRepPointOnFacesProjection::solutionUV() const
 {
-    if (this->isDone()) {
-        double u, v;
-        d->m_solProjector.first->LowerDistanceParameters(u, v);
-        return std::make_pair(u, v);
-    }
+    if (this->isDone())
+        return std::make_pair(d->m_sol.u, d->m_sol.v);
     return std::make_pair(0., 0.);
 }
 
 gp_Vec BRepPointOnFacesProjection::solutionNormal() const
 {
     if (this->isDone()) {
-        double u, v;
-        d->m_solProjector.first->LowerDistanceParameters(u, v);
-        return occ::TopoDsUtils::normalToFaceAtUV(d->m_solProjector.second, u, v);
+        return occ::TopoDsUtils::normalToFaceAtUV(
+                    d->m_faces[d->m_sol.faceId].face, d->m_sol.u, d->m_sol.v);
     }
     return gp_Vec(0., 0., 1.);
 }
 
+/*! \brief Returns the count of GeomAPI_ProjectPointOnSurf objects currently
+ *         allocated for compute()
+ *
+ *  With LazyAllocation, this is the count of faces visited so far by queries
+ *  (less the destroyed projectors, see setMaxProjectorCount())
+ */
+std::size_t BRepPointOnFacesProjection::projectorCount() const
+{
+    return d->m_projectors.count();
+}
+
+std::size_t BRepPointOnFacesProjection::maxProjectorCount() const
+{
+    return d->m_projectors.maxCount();
+}
+
+/*! \brief Limits the count of GeomAPI_ProjectPointOnSurf objects allocated at
+ *         the same time, zero means no limit (the default)
+ *
+ *  When the limit is reached, the least recently used projector is destroyed
+ *  before a new one is created. The limit applies to compute() as well as to
+ *  each chunk of the batch projected().
+ */
+void BRepPointOnFacesProjection::setMaxProjectorCount(std::size_t count)
+{
+    d->m_projectors.setMaxCount(count);
+}
+
+/*! \brief Returns the memory consumed by the loaded faces and the projectors
+ *         allocated for compute()
+ *
+ *  Projector sizes are an estimate, the internals of GeomAPI_ProjectPointOnSurf
+ *  are not exposed. Face geometry is shared with the input shape and is not
+ *  counted, neither are the temporary projectors of the batch projected().
+ */
+BRepPointOnFacesProjection::MemoryUsage BRepPointOnFacesProjection::memoryUsage() const
+{
+    MemoryUsage usage;
+    usage.faceBytes =
+            d->m_faces.capacity() * sizeof(internal::FaceInfo)
+            + d->m_candidates.capacity() * sizeof(Private::Candidate);
+    usage.projectorBytes = d->m_projectors.memoryUsage();
+    usage.projectorCount = d->m_projectors.count();
+    return usage;
+}
+
+bool BRepPointOnFacesProjection::isCoherentQueryEnabled() const
+{
+    return d->m_isCoherentQueryEnabled;
+}
+
+/*! \brief Enables the "coherent query" mode, disabled by default
+ *
+ *  In this mode, each query is seeded with the solution of the previous one
+ *  (compute() uses its last solution, the batch projected() uses the solution
+ *  of the previous point in the array). This greatly reduces the average cost
+ *  when successive points are close to each other.
+ *
+ *  The local search may miss the global minimum when the distance function
+ *  has several local minima on the seed face (ex: point near the axis of a
+ *  cylinder), so this mode is not recommended for unordered point sets.
+ */
+void BRepPointOnFacesProjection::setCoherentQueryEnabled(bool on)
+{
+    d->m_isCoherentQueryEnabled = on;
+}
+
+/*! \brief Returns the projection of \p point on the loaded faces
+ *
+ *  Unlike compute(), this function does not modify the object and can be
+ *  called concurrently from several threads.\n
+ *  Each call allocates the projectors of the faces it visits, prefer the
+ *  batch overload to project many points.
+ */
+BRepPointOnFacesProjection::Result
+BRepPointOnFacesProjection::projected(const gp_Pnt& point) const
+{
+    internal::FaceProjectorSet projectors(&d->m_faces, d->m_projectors.maxCount());
+    std::vector<Private::Candidate> candidates;
+    return d->result(d->nearestSolution(point, &projectors, &candidates));
+}
+
+/*! \brief Projects the array of \p count points in \p points
+ *
+ *  The input array is partitioned into contiguous chunks processed
+ *  concurrently. Each chunk uses its own set of GeomAPI_ProjectPointOnSurf
+ *  objects, allocated on first use and reused for all the points of the
+ *  chunk.\n
+ *  In "coherent query" mode, the projection of a point is seeded with the
+ *  projection of the previous point in the chunk.
+ *
+ *  \param results  Output array of at least \p count items, \p results[i]
+ *                  receives the projection of \p points[i]
+ *  \param threadCount  Maximum count of threads to use (0 means as many as
+ *                      the hardware supports)
+ */
+void BRepPointOnFacesProjection::projected(
+        const gp_Pnt* points,
+        std::size_t count,
+        Result* results,
+        unsigned threadCount) const
+{
+    // Exact surface projections are expensive, so small chunks are worthwhile
+    const std::size_t minChunkSize = 16;
+    auto fnProjectChunk = [=] (std::size_t iBegin, std::size_t iEnd) {
+        internal::FaceProjectorSet projectors(
+                    &d->m_faces, d->m_projectors.maxCount());
+        std::vector<Private::Candidate> candidates;
+        internal::FaceSolution sol;
+        for (std::size_t i = iBegin; i < iEnd; ++i) {
+            const internal::FaceSolution* seed =
+                    d->m_isCoherentQueryEnabled ? &sol : NULL;
+            sol = d->solution(points[i], &projectors, &candidates, seed);
+            results[i] = d->result(sol);
+        }
+    };
+    cpp::parallelForRanges(count, fnProjectChunk, threadCount, minChunkSize);
+}
+
 } // namespace occ
@@ -20,6 +20,7 @@
 #include <TopoDS_Shape.hxx>
 #include <gp_Pnt.hxx>
 #include <gp_Vec.hxx>
+#include <cstddef>
 #include <utility>
 
 namespace occ {
@@ -27,12 +28,39 @@ namespace occ {
 class OCCTOOLS_EXPORT BRepPointOnFacesProjection
 {
 public:
+    struct OCCTOOLS_EXPORT Result
+    {
+        Result();
+        bool isValid;
+        TopoDS_Face face;
+        gp_Pnt point;
+        std::pair<double, double> uv;
+        gp_Vec normal;
+    };
+
+    struct OCCTOOLS_EXPORT MemoryUsage
+    {
+        MemoryUsage();
+        std::size_t faceBytes;
+        std::size_t projectorBytes;
+        std::size_t projectorCount;
+        std::size_t totalBytes() const;
+    };
+
+    enum ProjectorAllocation
+    {
+        EagerAllocation,
+        LazyAllocation
+    };
+
     BRepPointOnFacesProjection();
-    BRepPointOnFacesProjection(const TopoDS_Shape& faces);
+    BRepPointOnFacesProjection(
+            const TopoDS_Shape& faces, ProjectorAllocation alloc = EagerAllocation);
     ~BRepPointOnFacesProjection();
     void releaseMemory();
 
-    void prepare(const TopoDS_Shape& faces);
+    void prepare(
+            const TopoDS_Shape& faces, ProjectorAllocation alloc = EagerAllocation);
     BRepPointOnFacesProjection& compute(const gp_Pnt& point);
     bool isDone() const;
 
@@ -41,6 +69,21 @@ public:
     std::pair<double, double> solutionUV() const;
     gp_Vec solutionNormal() const;
 
+    std::size_t projectorCount() const;
+    std::size_t maxProjectorCount() const;
+    void setMaxProjectorCount(std::size_t count);
+    MemoryUsage memoryUsage() const;
+
+    bool isCoherentQueryEnabled() const;
+    void setCoherentQueryEnabled(bool on);
+
+    Result projected(const gp_Pnt& point) const;
+    void projected(
+            const gp_Pnt* points,
+            std::size_t count,
+            Result* results,
+            unsigned threadCount = 0) const;
+
 private:
     class Private;
     Private* const d;
@@ -0,0 +1,322 @@
+/****************************************************************************
+**  FougTools
+**  Copyright Fougue (30 Mar. 2015)
+**  contact@fougue.pro
+**
+** This software is a computer program whose purpose is to provide utility
+** tools for the C++ language and the Qt toolkit.
+**
+** This software is governed by the CeCILL-C license under French law and
+** abiding by the rules of distribution of free software.  You can  use,
+** modify and/ or redistribute the software under the terms of the CeCILL-C
+** license as circulated by CEA, CNRS and INRIA at the following URL
+** "http://www.cecill.info".
+****************************************************************************/
+
+#include "gcpnts_uniform_abscissa_sampler.h"
+
+#include "geom_utils.h"
+#include "../cpptools/parallel_utils.h"
+
+#include <BRepAdaptor_Curve.hxx>
+#include <BRep_Tool.hxx>
+#include <GCPnts_UniformAbscissa.hxx>
+#include <TopExp.hxx>
+#include <TopoDS.hxx>
+#include <cassert>
+#include <cstring>
+
+namespace occ {
+
+/*! \class GCPnts_UniformAbscissaSampler
+ *  \brief Contiguous table of the parameters computed by a
+ *         GCPnts_UniformAbscissa algorithm
+ *
+ *  Unlike GCPnts_UniformAbscissaConstIterator which calls
+ *  GCPnts_UniformAbscissa::Parameter() on each dereference, the parameters
+ *  are copied once in an array, so iterating over them is a pointer walk.
+ *
+ *  Optionally, the points of the curve at these parameters can be evaluated
+ *  once too with GeomUtils::geomCurveD0() and stored in another array.
+ *
+ *  Items are indexed from 0 to count() - 1, the i-th item corresponds to
+ *  GCPnts_UniformAbscissa::Parameter(i + 1)
+ *
+ *  \headerfile gcpnts_uniform_abscissa_sampler.h <occtools/gcpnts_uniform_abscissa_sampler.h>
+ *  \ingroup occtools
+ */
+
+GCPnts_UniformAbscissaSampler::GCPnts_UniformAbscissaSampler()
+{
+}
+
+GCPnts_UniformAbscissaSampler::GCPnts_UniformAbscissaSampler(
+        const GCPnts_UniformAbscissa& ua)
+{
+    this->load(ua);
+}
+
+GCPnts_UniformAbscissaSampler::GCPnts_UniformAbscissaSampler(
+        const GCPnts_UniformAbscissa& ua, const Handle_Geom_Curve& curve)
+{
+    this->load(ua, curve);
+}
+
+/*! Copies the parameters computed by \p ua, any previous point is cleared
+ *
+ *  The sampler is empty if \p ua is not done
+ */
+void GCPnts_UniformAbscissaSampler::load(const GCPnts_UniformAbscissa& ua)
+{
+    this->clear();
+    if (ua.IsDone() != Standard_True)
+        return;
+    const int paramCount = ua.NbPoints();
+    m_params.reserve(paramCount);
+    for (int i = 1; i <= paramCount; ++i)
+        m_params.push_back(ua.Parameter(i));
+}
+
+/*! Copies the parameters computed by \p ua and evaluates the points of
+ *  \p curve at these parameters
+ *
+ *  \p curve is expected to be the curve \p ua was computed on
+ */
+void GCPnts_UniformAbscissaSampler::load(
+        const GCPnts_UniformAbscissa& ua, const Handle_Geom_Curve& curve)
+{
+    this->load(ua);
+    if (curve.IsNull())
+        return;
+    m_points.reserve(m_params.size());
+    for (double param : m_params)
+        m_points.push_back(GeomUtils::geomCurveD0(curve, param));
+}
+
+void GCPnts_UniformAbscissaSampler::clear()
+{
+    m_params.clear();
+    m_points.clear();
+}
+
+std::size_t GCPnts_UniformAbscissaSampler::count() const
+{
+    return m_params.size();
+}
+
+bool GCPnts_UniformAbscissaSampler::isEmpty() const
+{
+    return m_params.empty();
+}
+
+//! Returns true if points were evaluated by load()
+bool GCPnts_UniformAbscissaSampler::hasPoints() const
+{
+    return !m_points.empty();
+}
+
+double GCPnts_UniformAbscissaSampler::parameter(std::size_t i) const
+{
+    assert(i < m_params.size());
+    return m_params[i];
+}
+
+/*! Returns the point of the curve at parameter(i)
+ *
+ *  \note Undefined behavior if hasPoints() is false
+ */
+const gp_Pnt& GCPnts_UniformAbscissaSampler::point(std::size_t i) const
+{
+    assert(i < m_points.size());
+    return m_points[i];
+}
+
+/*! Returns a pointer to the array of count() parameters, NULL if the sampler
+ *  is empty
+ */
+const double* GCPnts_UniformAbscissaSampler::parameters() const
+{
+    return !m_params.empty() ? m_params.data() : NULL;
+}
+
+//! Returns a pointer past the last parameter
+const double* GCPnts_UniformAbscissaSampler::parametersEnd() const
+{
+    return !m_params.empty() ? m_params.data() + m_params.size() : NULL;
+}
+
+/*! Returns a pointer to the array of count() points, NULL if hasPoints() is
+ *  false
+ */
+const gp_Pnt* GCPnts_UniformAbscissaSampler::points() const
+{
+    return !m_points.empty() ? m_points.data() : NULL;
+}
+
+//! Returns a pointer past the last point
+const gp_Pnt* GCPnts_UniformAbscissaSampler::pointsEnd() const
+{
+    return !m_points.empty() ? m_points.data() + m_points.size() : NULL;
+}
+
+/*! \class GCPnts_UniformAbscissaShapeSampler
+ *  \brief Uniform discretization of all the edges of a shape into contiguous
+ *         buffers
+ *
+ *  Edges are the unique ones of the shape (see TopoDsUtils::parallelForEach()),
+ *  they are discretized concurrently with GCPnts_UniformAbscissa on
+ *  BRepAdaptor_Curve (so edge locations are applied to points).
+ *
+ *  Parameters and points of all edges are stored in two arrays, CSR style :
+ *  the samples of edge(i) are the items of indexes [offsets()[i],
+ *  offsets()[i + 1]) of parameters() and points(). So the samples can be
+ *  uploaded to the GPU or processed in batch without walking per-edge
+ *  containers.
+ *
+ *  Degenerated edges and edges whose discretization failed have no samples.
+ *
+ *  \headerfile gcpnts_uniform_abscissa_sampler.h <occtools/gcpnts_uniform_abscissa_sampler.h>
+ *  \ingroup occtools
+ */
+
+GCPnts_UniformAbscissaShapeSampler::GCPnts_UniformAbscissaShapeSampler()
+{
+}
+
+/*! Discretizes the edges of \p shape with points spaced by the curvilinear
+ *  distance \p abscissa
+ *
+ *  \param threadCount  Maximum count of threads to use (0 means as many as
+ *                      the hardware supports)
+ */
+void GCPnts_UniformAbscissaShapeSampler::sampleByAbscissa(
+        const TopoDS_Shape& shape,
+        double abscissa,
+        double tolerance,
+        unsigned threadCount)
+{
+    this->sample(shape, abscissa, 0, tolerance, threadCount);
+}
+
+//! Discretizes each edge of \p shape into \p pointCount equidistant points
+void GCPnts_UniformAbscissaShapeSampler::sampleByPointCount(
+        const TopoDS_Shape& shape,
+        int pointCount,
+        double tolerance,
+        unsigned threadCount)
+{
+    this->sample(shape, 0., pointCount, tolerance, threadCount);
+}
+
+void GCPnts_UniformAbscissaShapeSampler::clear()
+{
+    m_edges.Clear();
+    m_offsets.clear();
+    m_params.clear();
+    m_points.clear();
+}
+
+std::size_t GCPnts_UniformAbscissaShapeSampler::edgeCount() const
+{
+    return static_cast<std::size_t>(m_edges.Extent());
+}
+
+const TopoDS_Edge& GCPnts_UniformAbscissaShapeSampler::edge(std::size_t i) const
+{
+    assert(i < this->edgeCount());
+    return TopoDS::Edge(m_edges.FindKey(static_cast<int>(i) + 1));
+}
+
+//! Count of samples of edge(i)
+std::size_t GCPnts_UniformAbscissaShapeSampler::edgeSampleCount(std::size_t i) const
+{
+    assert(i < this->edgeCount());
+    return m_offsets[i + 1] - m_offsets[i];
+}
+
+//! Count of samples of all the edges
+std::size_t GCPnts_UniformAbscissaShapeSampler::count() const
+{
+    return m_params.size();
+}
+
+/*! Returns a pointer to the array of edgeCount() + 1 offsets, the last one
+ *  being count()
+ *
+ *  NULL if nothing was sampled
+ */
+const std::size_t* GCPnts_UniformAbscissaShapeSampler::offsets() const
+{
+    return !m_offsets.empty() ? m_offsets.data() : NULL;
+}
+
+//! Returns a pointer to the array of count() parameters
+const double* GCPnts_UniformAbscissaShapeSampler::parameters() const
+{
+    return !m_params.empty() ? m_params.data() : NULL;
+}
+
+//! Returns a pointer to the array of count() points
+const gp_Pnt* GCPnts_UniformAbscissaShapeSampler::points() const
+{
+    return !m_points.empty() ? m_points.data() : NULL;
+}
+
+/*! Two passes : edges are discretized concurrently into per-edge parameter
+ *  arrays, then once offsets are known, parameters are copied and points
+ *  evaluated concurrently into the contiguous buffers
+ */
+void GCPnts_UniformAbscissaShapeSampler::sample(
+        const TopoDS_Shape& shape,
+        double abscissa,
+        int pointCount,
+        double tolerance,
+        unsigned threadCount)
+{
+    this->clear();
+    TopExp::MapShapes(shape, TopAbs_EDGE, m_edges);
+    const std::size_t edgeCount = this->edgeCount();
+    std::vector<std::vector<double>> edgeParams(edgeCount);
+    auto fnDiscretize = [&] (std::size_t iBegin, std::size_t iEnd) {
+        for (std::size_t i = iBegin; i < iEnd; ++i) {
+            const TopoDS_Edge& edge = this->edge(i);
+            if (BRep_Tool::Degenerated(edge) || !BRep_Tool::IsGeometric(edge))
+                continue;
+            const BRepAdaptor_Curve curve(edge);
+            GCPnts_UniformAbscissa ua;
+            if (pointCount > 0)
+                ua.Initialize(curve, pointCount, tolerance);
+            else
+                ua.Initialize(curve, abscissa, tolerance);
+            if (ua.IsDone() != Standard_True)
+                continue;
+            std::vector<double>& params = edgeParams[i];
+            params.reserve(ua.NbPoints());
+            for (int p = 1; p <= ua.NbPoints(); ++p)
+                params.push_back(ua.Parameter(p));
+        }
+    };
+    cpp::parallelForRanges(edgeCount, fnDiscretize, threadCount);
+
+    m_offsets.resize(edgeCount + 1, 0);
+    for (std::size_t i = 0; i < edgeCount; ++i)
+        m_offsets[i + 1] = m_offsets[i] + edgeParams[i].size();
+    m_params.resize(m_offsets.back());
+    m_points.resize(m_offsets.back());
+
+    auto fnScatter = [&] (std::size_t iBegin, std::size_t iEnd) {
+        for (std::size_t i = iBegin; i < iEnd; ++i) {
+            const std::vector<double>& params = edgeParams[i];
+            if (params.empty())
+                continue;
+            const BRepAdaptor_Curve curve(this->edge(i));
+            const std::size_t offset = m_offsets[i];
+            std::memcpy(&m_params[offset], params.data(), params.size() * sizeof(double));
+            for (std::size_t p = 0; p < params.size(); ++p)
+                m_points[offset + p] = curve.Value(params[p]);
+        }
+    };
+    cpp::parallelForRanges(edgeCount, fnScatter, threadCount);
+}
+
+} // namespace occ
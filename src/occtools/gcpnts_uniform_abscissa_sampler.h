@@ -0,0 +1,100 @@
+/****************************************************************************
+**  FougTools
+**  Copyright Fougue (30 Mar. 2015)
+**  contact@fougue.pro
+**
+** This software is a computer program whose purpose is to provide utility
+** tools for the C++ language and the Qt toolkit.
+**
+** This software is governed by the CeCILL-C license under French law and
+** abiding by the rules of distribution of free software.  You can  use,
+** modify and/ or redistribute the software under the terms of the CeCILL-C
+** license as circulated by CEA, CNRS and INRIA at the following URL
+** "http://www.cecill.info".
+****************************************************************************/
+
+#pragma once
+
+#include "occtools.h"
+
+#include <Handle_Geom_Curve.hxx>
+#include <TopTools_IndexedMapOfShape.hxx>
+#include <TopoDS_Edge.hxx>
+#include <gp_Pnt.hxx>
+
+#include <cstddef>
+#include <vector>
+class GCPnts_UniformAbscissa;
+
+namespace occ {
+
+class OCCTOOLS_EXPORT GCPnts_UniformAbscissaSampler
+{
+public:
+    GCPnts_UniformAbscissaSampler();
+    explicit GCPnts_UniformAbscissaSampler(const GCPnts_UniformAbscissa& ua);
+    GCPnts_UniformAbscissaSampler(
+            const GCPnts_UniformAbscissa& ua, const Handle_Geom_Curve& curve);
+
+    void load(const GCPnts_UniformAbscissa& ua);
+    void load(const GCPnts_UniformAbscissa& ua, const Handle_Geom_Curve& curve);
+    void clear();
+
+    std::size_t count() const;
+    bool isEmpty() const;
+    bool hasPoints() const;
+
+    double parameter(std::size_t i) const;
+    const gp_Pnt& point(std::size_t i) const;
+
+    const double* parameters() const;
+    const double* parametersEnd() const;
+    const gp_Pnt* points() const;
+    const gp_Pnt* pointsEnd() const;
+
+private:
+    std::vector<double> m_params;
+    std::vector<gp_Pnt> m_points;
+};
+
+class OCCTOOLS_EXPORT GCPnts_UniformAbscissaShapeSampler
+{
+public:
+    GCPnts_UniformAbscissaShapeSampler();
+
+    void sampleByAbscissa(
+            const TopoDS_Shape& shape,
+            double abscissa,
+            double tolerance = -1.,
+            unsigned threadCount = 0);
+    void sampleByPointCount(
+            const TopoDS_Shape& shape,
+            int pointCount,
+            double tolerance = -1.,
+            unsigned threadCount = 0);
+    void clear();
+
+    std::size_t edgeCount() const;
+    const TopoDS_Edge& edge(std::size_t i) const;
+    std::size_t edgeSampleCount(std::size_t i) const;
+
+    std::size_t count() const;
+    const std::size_t* offsets() const;
+    const double* parameters() const;
+    const gp_Pnt* points() const;
+
+private:
+    void sample(
+            const TopoDS_Shape& shape,
+            double abscissa,
+            int pointCount,
+            double tolerance,
+            unsigned threadCount);
+
+    TopTools_IndexedMapOfShape m_edges;
+    std::vector<std::size_t> m_offsets;
+    std::vector<double> m_params;
+    std::vector<gp_Pnt> m_points;
+};
+
+} // namespace occ
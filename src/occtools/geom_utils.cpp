@@ -15,13 +15,68 @@
 
 #include "geom_utils.h"
 
+#include "../cpptools/parallel_utils.h"
+
 #include <Geom_Curve.hxx>
 #include <Geom_Surface.hxx>
 #include <GeomAdaptor_Curve.hxx>
 #include <GCPnts_AbscissaPoint.hxx>
 
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
 namespace occ {
 
+namespace internal {
+
+/*! Computes the lengths of \p count param ranges on \p curve
+ *
+ *  The bounds of all the ranges are sorted to build a table of cumulative
+ *  abscissae, where each entry is the length from the smallest bound. The
+ *  curve is integrated once between each pair of consecutive bounds, and the
+ *  length of a range is the difference of the abscissae of its bounds.
+ */
+static void curveLengthsFromAbscissaTable(
+        const Handle_Geom_Curve& curve,
+        const GeomUtils::ParamRange* ranges,
+        std::size_t count,
+        Standard_Real* lengths)
+{
+    if (curve.IsNull()) {
+        std::fill(lengths, lengths + count, 0.);
+        return;
+    }
+
+    std::vector<Standard_Real> params;
+    params.reserve(2 * count);
+    for (std::size_t i = 0; i < count; ++i) {
+        params.push_back(ranges[i].first);
+        params.push_back(ranges[i].second);
+    }
+    std::sort(params.begin(), params.end());
+    params.erase(std::unique(params.begin(), params.end()), params.end());
+
+    const GeomAdaptor_Curve adaptor(curve);
+    std::vector<Standard_Real> abscissae(params.size(), 0.);
+    for (std::size_t i = 1; i < params.size(); ++i) {
+        abscissae[i] =
+                abscissae[i - 1]
+                + GCPnts_AbscissaPoint::Length(adaptor, params[i - 1], params[i]);
+    }
+
+    auto fnAbscissa = [&] (Standard_Real u) {
+        const auto itParam = std::lower_bound(params.cbegin(), params.cend(), u);
+        return abscissae.at(itParam - params.cbegin());
+    };
+    for (std::size_t i = 0; i < count; ++i) {
+        lengths[i] = std::abs(
+                    fnAbscissa(ranges[i].second) - fnAbscissa(ranges[i].first));
+    }
+}
+
+} // namespace internal
+
 /*! \class GeomUtils
  *  \brief Collection of tools for the Geom package
  *
@@ -55,6 +110,98 @@ Standard_Real GeomUtils::curveLengthBetweenParams(
     return 0;
 }
 
+/*! Computes the length of each curve in the array \p curves
+ *
+ *  \p lengths must point to an array of \p count items, on output
+ *  lengths[i] is GeomUtils::curveLength(curves[i]).
+ *
+ *  Curves are dispatched to threads by contiguous chunks.
+ *
+ *  \param threadCount  Maximum count of threads to use (0 means as many as
+ *                      the hardware supports)
+ *
+ *  \warning Some OpenCascade curves (ex: BSpline) maintain an evaluation cache
+ *           which is not thread-safe, so the same Geom_Curve object should
+ *           not appear in \p curves more than once if \p threadCount != 1
+ */
+void GeomUtils::curveLengths(
+        const Handle_Geom_Curve* curves,
+        std::size_t count,
+        Standard_Real* lengths,
+        unsigned threadCount)
+{
+    auto fnChunk = [=] (std::size_t iBegin, std::size_t iEnd) {
+        for (std::size_t i = iBegin; i < iEnd; ++i)
+            lengths[i] = GeomUtils::curveLength(curves[i]);
+    };
+    cpp::parallelForRanges(count, fnChunk, threadCount);
+}
+
+/*! Computes the lengths of many param ranges on the same \p curve
+ *
+ *  \p lengths must point to an array of \p count items, on output
+ *  lengths[i] is the length of \p curve between ranges[i].first and
+ *  ranges[i].second .
+ *
+ *  This is faster than calling curveLengthBetweenParams() for each range :
+ *  the curve adaptor is built once and the curve is integrated once over each
+ *  interval between sorted range bounds, no matter how many ranges overlap
+ *  this interval.
+ */
+void GeomUtils::curveLengthsBetweenParams(
+        const Handle_Geom_Curve& curve,
+        const ParamRange* ranges,
+        std::size_t count,
+        Standard_Real* lengths)
+{
+    internal::curveLengthsFromAbscissaTable(curve, ranges, count, lengths);
+}
+
+/*! Computes the lengths of param ranges on many curves
+ *
+ *  ranges[i] is a param range of curves[i], \p lengths must point to an
+ *  array of \p count items that receives the length of each range.
+ *
+ *  Consecutive items referencing the same curve are computed together as with
+ *  curveLengthsBetweenParams(const Handle_Geom_Curve&, ...), so ranges should
+ *  be grouped by curve. These groups are dispatched to threads by contiguous
+ *  chunks.
+ *
+ *  \param threadCount  Maximum count of threads to use (0 means as many as
+ *                      the hardware supports)
+ *
+ *  \warning A Geom_Curve object should not appear in more than one group if
+ *           \p threadCount != 1 (see curveLengths())
+ */
+void GeomUtils::curveLengthsBetweenParams(
+        const Handle_Geom_Curve* curves,
+        const ParamRange* ranges,
+        std::size_t count,
+        Standard_Real* lengths,
+        unsigned threadCount)
+{
+    // Start index of each group of consecutive items having the same curve
+    std::vector<std::size_t> groupStarts;
+    for (std::size_t i = 0; i < count; ++i) {
+        if (i == 0 || !(curves[i] == curves[i - 1]))
+            groupStarts.push_back(i);
+    }
+    groupStarts.push_back(count);
+
+    auto fnChunk = [&] (std::size_t iGroupBegin, std::size_t iGroupEnd) {
+        for (std::size_t iGroup = iGroupBegin; iGroup < iGroupEnd; ++iGroup) {
+            const std::size_t iStart = groupStarts.at(iGroup);
+            const std::size_t groupSize = groupStarts.at(iGroup + 1) - iStart;
+            internal::curveLengthsFromAbscissaTable(
+                        curves[iStart],
+                        ranges + iStart,
+                        groupSize,
+                        lengths + iStart);
+        }
+    };
+    cpp::parallelForRanges(groupStarts.size() - 1, fnChunk, threadCount);
+}
+
 gp_Vec GeomUtils::normalToSurfaceAtUV(
         const Handle_Geom_Surface& surface, Standard_Real u, Standard_Real v)
 {
@@ -25,17 +25,41 @@
 #include <gp_Pnt.hxx>
 #include <gp_Vec.hxx>
 
+#include <cstddef>
+#include <utility>
+
 namespace occ {
 
 class OCCTOOLS_EXPORT GeomUtils
 {
 public:
+    typedef std::pair<Standard_Real, Standard_Real> ParamRange;
+
     static gp_Pnt geomCurveD0(const Handle_Geom_Curve& curve, Standard_Real u);
     static Standard_Real curveLength(const Handle_Geom_Curve& curve);
     static Standard_Real curveLengthBetweenParams(
             const Handle_Geom_Curve& curve,
             Standard_Real firstU,
             Standard_Real lastU);
+
+    // Batch length computation
+    static void curveLengths(
+            const Handle_Geom_Curve* curves,
+            std::size_t count,
+            Standard_Real* lengths,
+            unsigned threadCount = 0);
+    static void curveLengthsBetweenParams(
+            const Handle_Geom_Curve& curve,
+            const ParamRange* ranges,
+            std::size_t count,
+            Standard_Real* lengths);
+    static void curveLengthsBetweenParams(
+            const Handle_Geom_Curve* curves,
+            const ParamRange* ranges,
+            std::size_t count,
+            Standard_Real* lengths,
+            unsigned threadCount = 0);
+
     static gp_Vec normalToSurfaceAtUV(
             const Handle_Geom_Surface& surface,
             Standard_Real u,
@@ -0,0 +1,431 @@
+/****************************************************************************
+**  FougTools
+**  Copyright Fougue (30 Mar. 2015)
+**  contact@fougue.pro
+**
+** This software is a computer program whose purpose is to provide utility
+** tools for the C++ language and the Qt toolkit.
+**
+** This software is governed by the CeCILL-C license under French law and
+** abiding by the rules of distribution of free software.  You can  use,
+** modify and/ or redistribute the software under the terms of the CeCILL-C
+** license as circulated by CEA, CNRS and INRIA at the following URL
+** "http://www.cecill.info".
+****************************************************************************/
+
+
+#include "id_buffer_picker.h"
+
+#include "ais_utils.h"
+#include "offscreen_renderer.h"
+
+#include <AIS_InteractiveContext.hxx>
+#include <AIS_Shape.hxx>
+#include <Aspect_Window.hxx>
+#include <Quantity_Color.hxx>
+#include <Standard_Version.hxx>
+#include <TopExp.hxx>
+#include <TopTools_IndexedMapOfShape.hxx>
+#include <TopoDS.hxx>
+#include <V3d_View.hxx>
+#if OCC_VERSION_HEX >= 0x060700
+# include <AIS_ColoredShape.hxx>
+#endif
+#if OCC_VERSION_HEX >= 0x060800
+# include <Graphic3d_Camera.hxx>
+#endif
+
+#include <QtGui/QImage>
+
+#include <algorithm>
+#include <unordered_map>
+
+namespace occ {
+
+namespace internal {
+
+//! Parameters of a V3d_View camera, used to detect the ID buffer is outdated
+struct IdBufferCamera
+{
+    IdBufferCamera()
+        : scale(0.), width(0), height(0)
+    {
+        std::fill(eye, eye + 3, 0.);
+        std::fill(at, at + 3, 0.);
+        std::fill(up, up + 3, 0.);
+    }
+
+    explicit IdBufferCamera(const Handle_V3d_View& view)
+        : scale(view->Scale()), width(0), height(0)
+    {
+        view->Eye(eye[0], eye[1], eye[2]);
+        view->At(at[0], at[1], at[2]);
+        view->Up(up[0], up[1], up[2]);
+        if (!view->Window().IsNull())
+            view->Window()->Size(width, height);
+    }
+
+    bool operator==(const IdBufferCamera& other) const
+    {
+        return std::equal(eye, eye + 3, other.eye)
+                && std::equal(at, at + 3, other.at)
+                && std::equal(up, up + 3, other.up)
+                && scale == other.scale
+                && width == other.width
+                && height == other.height;
+    }
+
+    double eye[3];
+    double at[3];
+    double up[3];
+    double scale;
+    Standard_Integer width;
+    Standard_Integer height;
+};
+
+static void copyCamera(const Handle_V3d_View& from, const Handle_V3d_View& to)
+{
+#if OCC_VERSION_HEX >= 0x060800
+    to->Camera()->Copy(from->Camera());
+#else
+    double x, y, z;
+    from->Eye(x, y, z);
+    to->SetEye(x, y, z);
+    from->At(x, y, z);
+    to->SetAt(x, y, z);
+    from->Up(x, y, z);
+    to->SetUp(x, y, z);
+    to->SetScale(from->Scale());
+#endif
+}
+
+static Quantity_Color idColor(std::uint32_t id)
+{
+    std::uint8_t rgb[3];
+    IdBufferPicker::idToRgb(id, rgb);
+    return Quantity_Color(
+                rgb[0] / 255., rgb[1] / 255., rgb[2] / 255., Quantity_TOC_RGB);
+}
+
+} // namespace internal
+
+//! IdBufferPicker's pimpl
+class IdBufferPicker::Private
+{
+public:
+    //! Proxy displayed in the ID context for a picked object
+    struct Record
+    {
+        Handle_AIS_InteractiveObject source;
+        Handle_AIS_Shape proxy;
+        std::uint32_t firstId;
+        std::uint32_t idCount;
+    };
+
+    //! What an ID of the ID buffer identifies, source is NULL for removed IDs
+    struct IdEntry
+    {
+        IdEntry(const AIS_InteractiveObject* src, const TopoDS_Face& f)
+            : source(src), face(f)
+        { }
+
+        const AIS_InteractiveObject* source;
+        TopoDS_Face face;
+    };
+
+    Private(const Handle_AIS_InteractiveContext& idContext)
+        : m_renderer(idContext, 1, 1),
+          m_width(0),
+          m_height(0),
+          m_isDirty(true)
+    { }
+
+    Hit hitOfId(std::uint32_t id) const
+    {
+        Hit hit;
+        if (id > 0 && id <= m_ids.size()) {
+            const IdEntry& entry = m_ids.at(id - 1);
+            auto it = m_records.find(entry.source);
+            if (it != m_records.end()) {
+                hit.object = it->second.source;
+                hit.face = entry.face;
+            }
+        }
+        return hit;
+    }
+
+    void eraseProxy(const Record& record)
+    {
+        AisUtils::eraseObjectFromContext(record.proxy, m_renderer.context());
+        for (std::uint32_t i = 0; i < record.idCount; ++i) {
+            IdEntry& entry = m_ids.at(record.firstId - 1 + i);
+            entry.source = NULL;
+            entry.face.Nullify();
+        }
+    }
+
+    OffscreenRenderer m_renderer;
+    std::unordered_map<const AIS_InteractiveObject*, Record> m_records;
+    std::vector<IdEntry> m_ids;
+
+    std::vector<std::uint32_t> m_buffer;
+    int m_width;
+    int m_height;
+    bool m_isDirty;
+    internal::IdBufferCamera m_camera;
+};
+
+/*! \class IdBufferPicker
+ *  \brief Picks objects or faces under the cursor by reading back an
+ *         offscreen buffer of IDs
+ *
+ *  AIS_InteractiveContext picking casts rays against the sensitive entities of
+ *  the objects, its cost grows with the triangle count of dense meshes. Here
+ *  each picked object is displayed in a separate "ID context" by a proxy whose
+ *  color encodes an ID (one per object, or one per face with FaceLevel). The
+ *  proxies are rendered unlit offscreen with the camera of the picked view,
+ *  then the ID image is read back once. As long as the camera and the picked
+ *  objects don't change, pick() is a lookup in this image, whatever the count
+ *  of triangles, and picking in a rectangle costs its pixel count.
+ *
+ *  The ID context must be bound to a V3d_Viewer of its own (so proxies are not
+ *  visible in the picked view), but it can use the same graphic driver. IDs
+ *  are 24-bit RGB colors, so at most 2^24 - 1 objects and faces can be
+ *  tracked between two calls to clear(). Face pick level requires
+ *  OpenCascade >= v6.7.0, ObjectLevel is used otherwise.
+ *
+ *  Objects must be added and removed as they are displayed and erased in the
+ *  picked view.
+ *
+ *  \headerfile id_buffer_picker.h <occtools/id_buffer_picker.h>
+ *  \ingroup occtools
+ */
+
+//! Hit is valid when some object was found under the picked position
+bool IdBufferPicker::Hit::isValid() const
+{
+    return !object.IsNull();
+}
+
+IdBufferPicker::IdBufferPicker(const Handle_AIS_InteractiveContext& idContext)
+    : d(new Private(idContext))
+{
+    const Handle_V3d_View idView = d->m_renderer.internalView();
+    idView->SetImmediateUpdate(Standard_False);
+    idView->SetShadingModel(V3d_COLOR); // No lighting, colors are kept as is
+    idView->SetAntialiasingOff();
+    d->m_renderer.setBackgroundColor(Quantity_NOC_BLACK); // ID 0 : nothing
+}
+
+IdBufferPicker::~IdBufferPicker()
+{
+    this->clear();
+    delete d;
+}
+
+Handle_AIS_InteractiveContext IdBufferPicker::idContext() const
+{
+    return d->m_renderer.context();
+}
+
+/*! Makes \p object pickable, either as a whole or per face depending on
+ *  \p level
+ *
+ *  If \p object was already added then its proxy is recreated (ex: after a
+ *  change of shape or location)
+ */
+void IdBufferPicker::add(const Handle_AIS_Shape& object, PickLevel level)
+{
+    if (object.IsNull() || object->Shape().IsNull())
+        return;
+    this->remove(object);
+
+    const TopoDS_Shape& shape = object->Shape();
+    TopTools_IndexedMapOfShape mapFace;
+#if OCC_VERSION_HEX >= 0x060700
+    if (level == FaceLevel)
+        TopExp::MapShapes(shape, TopAbs_FACE, mapFace);
+#else
+    (void)level;
+#endif
+    const std::uint32_t idCount =
+            mapFace.IsEmpty() ? 1 : static_cast<std::uint32_t>(mapFace.Extent());
+    if (d->m_ids.size() + idCount > 0xFFFFFF)
+        return; // Out of IDs
+
+    Private::Record record;
+    record.source = object;
+    record.firstId = static_cast<std::uint32_t>(d->m_ids.size() + 1);
+    record.idCount = idCount;
+    d->m_ids.reserve(d->m_ids.size() + idCount);
+    if (mapFace.IsEmpty()) {
+        record.proxy = new AIS_Shape(shape);
+        record.proxy->SetColor(internal::idColor(record.firstId));
+        d->m_ids.push_back(Private::IdEntry(object.operator->(), TopoDS_Face()));
+    }
+#if OCC_VERSION_HEX >= 0x060700
+    else {
+        const Handle_AIS_ColoredShape coloredProxy = new AIS_ColoredShape(shape);
+        for (int i = 1; i <= mapFace.Extent(); ++i) {
+            const TopoDS_Face& face = TopoDS::Face(mapFace.FindKey(i));
+            coloredProxy->SetCustomColor(
+                        face, internal::idColor(record.firstId + i - 1));
+            d->m_ids.push_back(Private::IdEntry(object.operator->(), face));
+        }
+        record.proxy = coloredProxy;
+    }
+#endif
+
+    const Handle_AIS_InteractiveContext& idContext = d->m_renderer.context();
+    if (object->HasLocation())
+        idContext->SetLocation(record.proxy, object->Location());
+    // Display shaded, without selection mode (the ID context is never picked)
+    idContext->Display(record.proxy, AIS_Shaded, -1, Standard_False);
+    d->m_records.emplace(object.operator->(), record);
+    d->m_isDirty = true;
+}
+
+//! Makes \p object no longer pickable
+void IdBufferPicker::remove(const Handle_AIS_InteractiveObject& object)
+{
+    auto it = !object.IsNull() ?
+                d->m_records.find(object.operator->()) : d->m_records.end();
+    if (it != d->m_records.end()) {
+        d->eraseProxy(it->second);
+        d->m_records.erase(it);
+        d->m_isDirty = true;
+    }
+}
+
+//! Removes all the pickable objects, IDs are then reused
+void IdBufferPicker::clear()
+{
+    for (const auto& entry : d->m_records)
+        d->eraseProxy(entry.second);
+    d->m_records.clear();
+    d->m_ids.clear();
+    d->m_buffer.clear();
+    d->m_width = 0;
+    d->m_height = 0;
+    d->m_isDirty = true;
+}
+
+bool IdBufferPicker::contains(const Handle_AIS_InteractiveObject& object) const
+{
+    return !object.IsNull()
+            && d->m_records.find(object.operator->()) != d->m_records.end();
+}
+
+/*! Forces the next call to update() to render the ID buffer again
+ *
+ *  Changes of camera and of added objects are detected, this is needed only
+ *  when a picked object changed without being added again
+ */
+void IdBufferPicker::invalidate()
+{
+    d->m_isDirty = true;
+}
+
+//! Whether the ID buffer was rendered for the current camera of \p view
+bool IdBufferPicker::isUpToDate(const Handle_V3d_View& view) const
+{
+    return !d->m_isDirty
+            && !view.IsNull()
+            && d->m_camera == internal::IdBufferCamera(view);
+}
+
+/*! Renders the ID buffer with the camera and window size of \p view, unless
+ *  it is already up to date
+ *
+ *  Must be called by the thread owning the OpenGL context, typically just
+ *  before pick()
+ */
+void IdBufferPicker::update(const Handle_V3d_View& view)
+{
+    if (view.IsNull() || this->isUpToDate(view))
+        return;
+
+    const internal::IdBufferCamera camera(view);
+    d->m_camera = camera;
+    d->m_isDirty = false;
+    d->m_buffer.clear();
+    d->m_width = 0;
+    d->m_height = 0;
+    if (camera.width <= 0 || camera.height <= 0)
+        return;
+
+    internal::copyCamera(view, d->m_renderer.internalView());
+    d->m_renderer.setSize(camera.width, camera.height);
+    const QImage image = d->m_renderer.render();
+    if (image.isNull())
+        return;
+
+    d->m_width = image.width();
+    d->m_height = image.height();
+    d->m_buffer.resize(static_cast<std::size_t>(d->m_width) * d->m_height);
+    for (int y = 0; y < d->m_height; ++y) {
+        const std::uint8_t* rgb = image.constScanLine(y);
+        std::uint32_t* ids = &d->m_buffer.at(static_cast<std::size_t>(y) * d->m_width);
+        for (int x = 0; x < d->m_width; ++x)
+            ids[x] = IdBufferPicker::rgbToId(rgb + 3 * x);
+    }
+}
+
+/*! Object (and face with FaceLevel) visible at position \p pos of the picked
+ *  view, as of the last update()
+ */
+IdBufferPicker::Hit IdBufferPicker::pick(const QPoint& pos) const
+{
+    if (pos.x() < 0 || pos.x() >= d->m_width || pos.y() < 0 || pos.y() >= d->m_height)
+        return Hit();
+    return d->hitOfId(
+                d->m_buffer.at(static_cast<std::size_t>(pos.y()) * d->m_width + pos.x()));
+}
+
+/*! Objects (and faces with FaceLevel) visible inside \p rect of the picked
+ *  view, as of the last update()
+ *
+ *  Each hit is returned once, in increasing order of ID
+ */
+std::vector<IdBufferPicker::Hit> IdBufferPicker::pick(const QRect& rect) const
+{
+    const QRect area = rect.normalized() & QRect(0, 0, d->m_width, d->m_height);
+    std::vector<std::uint32_t> vecId;
+    for (int y = area.top(); y <= area.bottom(); ++y) {
+        const std::uint32_t* ids =
+                &d->m_buffer.at(static_cast<std::size_t>(y) * d->m_width);
+        for (int x = area.left(); x <= area.right(); ++x) {
+            if (ids[x] != 0 && (vecId.empty() || vecId.back() != ids[x]))
+                vecId.push_back(ids[x]);
+        }
+    }
+    std::sort(vecId.begin(), vecId.end());
+    vecId.erase(std::unique(vecId.begin(), vecId.end()), vecId.end());
+
+    std::vector<Hit> vecHit;
+    vecHit.reserve(vecId.size());
+    for (std::uint32_t id : vecId) {
+        Hit hit = d->hitOfId(id);
+        if (hit.isValid())
+            vecHit.push_back(std::move(hit));
+    }
+    return vecHit;
+}
+
+//! Encodes \p id (24 bits) as RGB components
+void IdBufferPicker::idToRgb(std::uint32_t id, std::uint8_t rgb[3])
+{
+    rgb[0] = static_cast<std::uint8_t>((id >> 16) & 0xFF);
+    rgb[1] = static_cast<std::uint8_t>((id >> 8) & 0xFF);
+    rgb[2] = static_cast<std::uint8_t>(id & 0xFF);
+}
+
+//! Decodes the ID encoded by idToRgb()
+std::uint32_t IdBufferPicker::rgbToId(const std::uint8_t rgb[3])
+{
+    return (static_cast<std::uint32_t>(rgb[0]) << 16)
+            | (static_cast<std::uint32_t>(rgb[1]) << 8)
+            | static_cast<std::uint32_t>(rgb[2]);
+}
+
+} // namespace occ
@@ -0,0 +1,79 @@
+/****************************************************************************
+**  FougTools
+**  Copyright Fougue (30 Mar. 2015)
+**  contact@fougue.pro
+**
+** This software is a computer program whose purpose is to provide utility
+** tools for the C++ language and the Qt toolkit.
+**
+** This software is governed by the CeCILL-C license under French law and
+** abiding by the rules of distribution of free software.  You can  use,
+** modify and/ or redistribute the software under the terms of the CeCILL-C
+** license as circulated by CEA, CNRS and INRIA at the following URL
+** "http://www.cecill.info".
+****************************************************************************/
+
+
+#pragma once
+
+#include "occtools.h"
+
+#include <Handle_AIS_InteractiveContext.hxx>
+#include <Handle_AIS_InteractiveObject.hxx>
+#include <Handle_AIS_Shape.hxx>
+#include <Handle_V3d_View.hxx>
+#include <TopoDS_Face.hxx>
+
+#include <QtCore/QPoint>
+#include <QtCore/QRect>
+
+#include <cstdint>
+#include <vector>
+
+namespace occ {
+
+class OCCTOOLS_EXPORT IdBufferPicker
+{
+public:
+    enum PickLevel
+    {
+        ObjectLevel,
+        FaceLevel
+    };
+
+    struct Hit
+    {
+        bool isValid() const;
+        Handle_AIS_InteractiveObject object;
+        TopoDS_Face face; // Null for ObjectLevel
+    };
+
+    IdBufferPicker(const Handle_AIS_InteractiveContext& idContext);
+    ~IdBufferPicker();
+
+    Handle_AIS_InteractiveContext idContext() const;
+
+    void add(const Handle_AIS_Shape& object, PickLevel level = ObjectLevel);
+    void remove(const Handle_AIS_InteractiveObject& object);
+    void clear();
+    bool contains(const Handle_AIS_InteractiveObject& object) const;
+
+    void invalidate();
+    bool isUpToDate(const Handle_V3d_View& view) const;
+    void update(const Handle_V3d_View& view);
+
+    Hit pick(const QPoint& pos) const;
+    std::vector<Hit> pick(const QRect& rect) const;
+
+    static void idToRgb(std::uint32_t id, std::uint8_t rgb[3]);
+    static std::uint32_t rgbToId(const std::uint8_t rgb[3]);
+
+private:
+    IdBufferPicker(const IdBufferPicker&) = delete;
+    IdBufferPicker& operator=(const IdBufferPicker&) = delete;
+
+    class Private;
+    Private* const d;
+};
+
+} // namespace occ
@@ -15,20 +15,34 @@
 
 #include "io.h"
 
+#include "topods_utils.h"
+#include "../cpptools/profiling.h"
+
 #include <BRep_Builder.hxx>
+#include <BRep_Tool.hxx>
+#include <BRepBndLib.hxx>
+#include <BRepMesh_IncrementalMesh.hxx>
 #include <BRepTools.hxx>
+#include <Bnd_Box.hxx>
 #include <OSD_Path.hxx>
 #include <RWStl.hxx>
 #include <IGESControl_Controller.hxx>
 #include <IGESControl_Reader.hxx> // For IGES files reading
 #include <IGESControl_Writer.hxx>
+#include <STEPControl_Controller.hxx>
 #include <STEPControl_Reader.hxx> // For STEP files reading
 #include <STEPControl_Writer.hxx>
+#include <Standard_Failure.hxx>
 #include <StlMesh_Mesh.hxx>
+#include <TopoDS.hxx>
+#include <TopoDS_Compound.hxx>
+#include <TopoDS_Face.hxx>
 #include <StlAPI_Writer.hxx>
 #include <IFSelect_ReturnStatus.hxx> // For status reading
 #include <Interface_Static.hxx>
 #include <Message_ProgressIndicator.hxx>
+#include <Message_ProgressSentry.hxx>
+#include <Poly_Triangulation.hxx>
 #include <Transfer_FinderProcess.hxx>
 #include <Transfer_TransientProcess.hxx>
 #include <XSControl_TransferWriter.hxx>
@@ -36,13 +50,28 @@
 
 #include <algorithm>
 #include <array>
+#include <atomic>
 #include <cctype>
+#include <cmath>
 #include <cstdint>
 #include <cstdlib>
+#include <cstring>
 #include <fstream>
+#include <mutex>
+#include <streambuf>
 
 #include "../cpptools/c_array_utils.h"
+#include "../cpptools/hash_fnv.h"
 #include "../cpptools/memory_utils.h"
+#include "../cpptools/parallel_utils.h"
+
+#include <QtCore/QByteArray>
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtCore/QSaveFile>
+#include <QtCore/QIODevice>
+#include <QtCore/QTemporaryFile>
+#include <QtCore/QtEndian>
 
 namespace {
 
@@ -75,6 +104,58 @@ TopoDS_Shape loadFile(
     return result;
 }
 
+/*! Same as loadFile() but roots are transferred one at a time, the shape of
+ *  each root being passed to \p onRootShapeLoaded as soon as it is translated
+ *
+ *  Abort requested through \p indicator is checked between roots
+ */
+template<typename _READER_>
+TopoDS_Shape loadFileByRoots(
+        occ::IO::FileNameLocal8Bit fileName,
+        const occ::IO::RootShapeLoadedFunction& onRootShapeLoaded,
+        Handle_Message_ProgressIndicator indicator)
+{
+    if (!indicator.IsNull())
+        indicator->NewScope(30, "Loading file");
+    _READER_ reader;
+    const int status = reader.ReadFile(const_cast<Standard_CString>(fileName));
+    if (!indicator.IsNull())
+        indicator->EndScope();
+    if (status != IFSelect_RetDone)
+        return TopoDS_Shape();
+
+    const int rootCount = reader.NbRootsForTransfer();
+    if (!indicator.IsNull())
+        indicator->NewScope(70, "Translating file");
+    {
+        Message_ProgressSentry sentry(indicator, "Translating roots", 0, rootCount, 1);
+        for (int i = 1; i <= rootCount && sentry.More(); ++i, sentry.Next()) {
+            const int shapeCountBefore = reader.NbShapes();
+            reader.TransferOneRoot(i);
+            const int shapeCountAfter = reader.NbShapes();
+            if (shapeCountAfter == shapeCountBefore || !onRootShapeLoaded)
+                continue;
+
+            TopoDS_Shape rootShape;
+            if (shapeCountAfter == shapeCountBefore + 1) {
+                rootShape = reader.Shape(shapeCountAfter);
+            }
+            else {
+                BRep_Builder builder;
+                TopoDS_Compound cmpd;
+                builder.MakeCompound(cmpd);
+                for (int s = shapeCountBefore + 1; s <= shapeCountAfter; ++s)
+                    builder.Add(cmpd, reader.Shape(s));
+                rootShape = cmpd;
+            }
+            onRootShapeLoaded(rootShape, i, rootCount);
+        }
+    }
+    if (!indicator.IsNull())
+        indicator->EndScope();
+    return reader.NbShapes() > 0 ? reader.OneShape() : TopoDS_Shape();
+}
+
 const char* skipWhiteSpaces(const char* str, std::size_t len)
 {
     std::size_t pos = 0;
@@ -95,6 +176,585 @@ bool matchToken(const char* buffer, const char (&token)[N])
     return std::strncmp(buffer, token, N - 1) == 0;
 }
 
+// -- STL reading
+
+const std::size_t binaryStlHeaderSize = 80 + sizeof(std::uint32_t);
+const std::size_t binaryStlFacetSize = (sizeof(float) * 12) + sizeof(std::uint16_t);
+
+/*! Indexed triangle mesh built from STL facets
+ *
+ *  Vertices with the same coordinates are merged with the help of an open
+ *  addressing hash table, so no allocation is done per vertex.
+ */
+class StlMeshBuilder
+{
+public:
+    StlMeshBuilder()
+        : m_tableMask(0)
+    { }
+
+    void reserve(std::size_t facetCount)
+    {
+        // Closed meshes have about twice as many facets as vertices
+        m_nodes.reserve(3 * (facetCount / 2 + 3));
+        m_triangles.reserve(3 * facetCount);
+        std::size_t tableSize = 1024;
+        while (tableSize < facetCount)
+            tableSize *= 2;
+        this->resizeTable(tableSize);
+    }
+
+    void addFacet(const float* v1, const float* v2, const float* v3)
+    {
+        m_triangles.push_back(this->vertexIndex(v1));
+        m_triangles.push_back(this->vertexIndex(v2));
+        m_triangles.push_back(this->vertexIndex(v3));
+    }
+
+    std::size_t facetCount() const
+    {
+        return m_triangles.size() / 3;
+    }
+
+    //! Appends the facets of \p other, merging vertices shared with this mesh
+    void append(const StlMeshBuilder& other)
+    {
+        const std::size_t otherNodeCount = other.m_nodes.size() / 3;
+        std::vector<std::uint32_t> nodeIndices(otherNodeCount);
+        for (std::size_t i = 0; i < otherNodeCount; ++i)
+            nodeIndices[i] = this->vertexIndex(&other.m_nodes[3 * i]);
+        m_triangles.reserve(m_triangles.size() + other.m_triangles.size());
+        for (std::uint32_t otherIndex : other.m_triangles)
+            m_triangles.push_back(nodeIndices[otherIndex]);
+    }
+
+    Handle_Poly_Triangulation toTriangulation() const
+    {
+        const int nodeCount = static_cast<int>(m_nodes.size() / 3);
+        const int triangleCount = static_cast<int>(m_triangles.size() / 3);
+        Handle_Poly_Triangulation triangulation =
+                new Poly_Triangulation(nodeCount, triangleCount, Standard_False);
+        TColgp_Array1OfPnt& nodes = triangulation->ChangeNodes();
+        for (int i = 0; i < nodeCount; ++i) {
+            const float* coords = &m_nodes[3 * i];
+            nodes.SetValue(i + 1, gp_Pnt(coords[0], coords[1], coords[2]));
+        }
+        Poly_Array1OfTriangle& triangles = triangulation->ChangeTriangles();
+        for (int i = 0; i < triangleCount; ++i) {
+            const std::uint32_t* ids = &m_triangles[3 * i];
+            triangles.SetValue(i + 1, Poly_Triangle(ids[0] + 1, ids[1] + 1, ids[2] + 1));
+        }
+        return triangulation;
+    }
+
+private:
+    static std::uint32_t floatBits(float value)
+    {
+        if (value == 0.f)
+            value = 0.f; // Merge -0 and +0
+        std::uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(float));
+        return bits;
+    }
+
+    static std::size_t hash(const float* coords)
+    {
+        const std::uint32_t h =
+                (floatBits(coords[0]) * 73856093u)
+                ^ (floatBits(coords[1]) * 19349663u)
+                ^ (floatBits(coords[2]) * 83492791u);
+        return (h ^ (h >> 16)) * 0x45d9f3bu;
+    }
+
+    std::uint32_t vertexIndex(const float* coords)
+    {
+        std::size_t slot = hash(coords) & m_tableMask;
+        while (m_table[slot] != 0) {
+            const std::uint32_t index = m_table[slot] - 1;
+            const float* nodeCoords = &m_nodes[3 * index];
+            if (nodeCoords[0] == coords[0]
+                    && nodeCoords[1] == coords[1]
+                    && nodeCoords[2] == coords[2])
+            {
+                return index;
+            }
+            slot = (slot + 1) & m_tableMask;
+        }
+
+        const std::uint32_t index = static_cast<std::uint32_t>(m_nodes.size() / 3);
+        m_nodes.insert(m_nodes.end(), coords, coords + 3);
+        m_table[slot] = index + 1;
+        if (2 * (index + 1) > m_table.size()) // Keep load factor below 0.5
+            this->resizeTable(2 * m_table.size());
+        return index;
+    }
+
+    void resizeTable(std::size_t tableSize)
+    {
+        if (tableSize <= m_table.size())
+            return;
+        m_table.assign(tableSize, 0);
+        m_tableMask = tableSize - 1;
+        const std::uint32_t nodeCount = static_cast<std::uint32_t>(m_nodes.size() / 3);
+        for (std::uint32_t i = 0; i < nodeCount; ++i) {
+            std::size_t slot = hash(&m_nodes[3 * i]) & m_tableMask;
+            while (m_table[slot] != 0)
+                slot = (slot + 1) & m_tableMask;
+            m_table[slot] = i + 1;
+        }
+    }
+
+    std::vector<float> m_nodes; // x, y, z per node
+    std::vector<std::uint32_t> m_triangles; // 3 node indices per triangle
+    std::vector<std::uint32_t> m_table; // Node index + 1 (0 is empty slot)
+    std::size_t m_tableMask;
+};
+
+//! Notifies progress of STL parsing, returns false if the user asked to stop
+bool notifyStlProgress(
+        const Handle_Message_ProgressIndicator& indicator, double position)
+{
+    if (indicator.IsNull())
+        return true;
+    double min, max, step;
+    Standard_Boolean isInfinite;
+    indicator->GetScale(min, max, step, isInfinite);
+    indicator->SetValue(min + (max - min) * position);
+    indicator->Show(Standard_False);
+    return indicator->UserBreak() == Standard_False;
+}
+
+bool parseBinaryStl(
+        const uchar* contents,
+        std::size_t size,
+        StlMeshBuilder* builder,
+        const Handle_Message_ProgressIndicator& indicator)
+{
+    if (size < binaryStlHeaderSize)
+        return false;
+    const std::uint32_t facetCount = qFromLittleEndian<quint32>(contents + 80);
+    if (binaryStlHeaderSize + facetCount * binaryStlFacetSize > size)
+        return false;
+
+    builder->reserve(facetCount);
+    const uchar* facet = contents + binaryStlHeaderSize;
+    for (std::uint32_t i = 0; i < facetCount; ++i) {
+        // Skip normal, read 3 vertices
+        float coords[9];
+        for (int j = 0; j < 9; ++j) {
+            const quint32 bits =
+                    qFromLittleEndian<quint32>(facet + (3 + j) * sizeof(float));
+            std::memcpy(coords + j, &bits, sizeof(float));
+        }
+        builder->addFacet(coords, coords + 3, coords + 6);
+        facet += binaryStlFacetSize;
+
+        if ((i + 1) % 65536 == 0
+                && !notifyStlProgress(indicator, double(i) / facetCount))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool isStlSpace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f' || c == '\v';
+}
+
+/*! Parses a floating point number in [\p it, \p end), the number must be
+ *  directly at \p it
+ *
+ *  Unlike std::strtod(), the input does not need to be null-terminated and
+ *  the current locale is ignored.
+ *  Returns the position after the number, or \p it if there is no number.
+ */
+const char* parseStlFloat(const char* it, const char* end, float* value)
+{
+    const char* begin = it;
+    bool isNegative = false;
+    if (it != end && (*it == '-' || *it == '+')) {
+        isNegative = *it == '-';
+        ++it;
+    }
+
+    std::uint64_t mantissa = 0;
+    int exponent = 0;
+    int digitCount = 0;
+    for (; it != end && *it >= '0' && *it <= '9'; ++it, ++digitCount) {
+        if (mantissa < 1000000000000000000ull)
+            mantissa = mantissa * 10 + (*it - '0');
+        else
+            ++exponent; // Extra digits are not significant
+    }
+    if (it != end && *it == '.') {
+        ++it;
+        for (; it != end && *it >= '0' && *it <= '9'; ++it, ++digitCount) {
+            if (mantissa < 1000000000000000000ull) {
+                mantissa = mantissa * 10 + (*it - '0');
+                --exponent;
+            }
+        }
+    }
+    if (digitCount == 0)
+        return begin;
+
+    if (it != end && (*it == 'e' || *it == 'E')) {
+        const char* itExp = it + 1;
+        bool isExpNegative = false;
+        if (itExp != end && (*itExp == '-' || *itExp == '+')) {
+            isExpNegative = *itExp == '-';
+            ++itExp;
+        }
+        if (itExp != end && *itExp >= '0' && *itExp <= '9') {
+            int expValue = 0;
+            for (; itExp != end && *itExp >= '0' && *itExp <= '9'; ++itExp) {
+                if (expValue < 10000)
+                    expValue = expValue * 10 + (*itExp - '0');
+            }
+            exponent += isExpNegative ? -expValue : expValue;
+            it = itExp;
+        }
+    }
+
+    // Fast path : mantissa and power of 10 are exact doubles, so the result
+    // is correctly rounded
+    static const double exactPowersOf10[] = {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+    const int maxExactExponent = 22;
+    const std::uint64_t maxExactMantissa = 1ull << 53;
+    double result = static_cast<double>(mantissa);
+    if (mantissa != 0 && exponent != 0) {
+        if (mantissa <= maxExactMantissa
+                && -maxExactExponent <= exponent && exponent <= maxExactExponent)
+        {
+            if (exponent > 0)
+                result *= exactPowersOf10[exponent];
+            else
+                result /= exactPowersOf10[-exponent];
+        }
+        else {
+            result *= std::pow(10., exponent);
+        }
+    }
+    *value = static_cast<float>(isNegative ? -result : result);
+    return it;
+}
+
+/*! Parses ASCII STL facets in [\p begin, \p end)
+ *
+ *  Only "vertex" records are interpreted, each group of three vertices in a
+ *  loop gives a facet.
+ */
+bool parseAsciiStl(
+        const char* begin,
+        const char* end,
+        StlMeshBuilder* builder,
+        const Handle_Message_ProgressIndicator& indicator)
+{
+    // About 250 bytes per facet
+    builder->reserve(static_cast<std::size_t>(end - begin) / 250);
+
+    static const char vertexToken[] = "vertex";
+    static const char endLoopToken[] = "endloop";
+    const std::size_t vertexTokenLen = cpp::cArraySize(vertexToken) - 1;
+    const std::size_t endLoopTokenLen = cpp::cArraySize(endLoopToken) - 1;
+    float coords[9];
+    int loopVertexCount = 0;
+    std::size_t tokenCount = 0;
+    const char* it = begin;
+    while (it != end) {
+        while (it != end && isStlSpace(*it))
+            ++it;
+        const char* token = it;
+        while (it != end && !isStlSpace(*it))
+            ++it;
+        const std::size_t tokenLen = it - token;
+
+        if (tokenLen == vertexTokenLen
+                && std::strncmp(token, vertexToken, vertexTokenLen) == 0)
+        {
+            float* vertex = coords + 3 * (loopVertexCount % 3);
+            for (int i = 0; i < 3; ++i) {
+                while (it != end && isStlSpace(*it))
+                    ++it;
+                const char* itNext = parseStlFloat(it, end, vertex + i);
+                if (itNext == it)
+                    return false; // Malformed vertex
+                it = itNext;
+            }
+            ++loopVertexCount;
+            if (loopVertexCount == 3)
+                builder->addFacet(coords, coords + 3, coords + 6);
+        }
+        else if (tokenLen == endLoopTokenLen
+                 && std::strncmp(token, endLoopToken, endLoopTokenLen) == 0)
+        {
+            loopVertexCount = 0;
+        }
+
+        if (++tokenCount % 1048576 == 0
+                && !notifyStlProgress(indicator, double(it - begin) / (end - begin)))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/*! Returns the position of the first "facet" record starting in
+ *  [\p it, \p end), or \p end if there is none
+ */
+const char* findStlFacetRecord(const char* it, const char* begin, const char* end)
+{
+    static const char facetToken[] = "facet";
+    const std::size_t facetTokenLen = cpp::cArraySize(facetToken) - 1;
+    for (; it + facetTokenLen < end; ++it) {
+        if (*it == 'f'
+                && (it == begin || isStlSpace(*(it - 1))) // Rejects "endfacet"
+                && isStlSpace(*(it + facetTokenLen))
+                && std::strncmp(it, facetToken, facetTokenLen) == 0)
+        {
+            return it;
+        }
+    }
+    return end;
+}
+
+/*! Parses ASCII STL contents concurrently
+ *
+ *  Contents are split into chunks starting at "facet" records, each chunk is
+ *  parsed by a thread into its own mesh. Chunk meshes are then stitched in
+ *  order, vertices shared by chunks are merged.\n
+ *  Only the thread of the first chunk notifies \p indicator (chunks have about
+ *  the same size, so its progress is representative).
+ */
+bool parseAsciiStlParallel(
+        const char* begin,
+        const char* end,
+        StlMeshBuilder* builder,
+        const Handle_Message_ProgressIndicator& indicator)
+{
+    // Below this size, threading overhead is not worth it
+    const std::size_t minChunkSize = 4 * 1024 * 1024;
+    const std::size_t size = end - begin;
+    const std::size_t chunkCount =
+            std::max<std::size_t>(
+                1, std::min<std::size_t>(cpp::parallelThreadCount(), size / minChunkSize));
+    if (chunkCount == 1)
+        return parseAsciiStl(begin, end, builder, indicator);
+
+    std::vector<const char*> chunkBegins(chunkCount + 1, end);
+    chunkBegins.front() = begin;
+    for (std::size_t i = 1; i < chunkCount; ++i) {
+        const char* approxPos = begin + i * (size / chunkCount);
+        chunkBegins[i] = findStlFacetRecord(
+                    std::max(approxPos, chunkBegins[i - 1]), begin, end);
+    }
+
+    std::vector<StlMeshBuilder> chunkBuilders(chunkCount);
+    std::vector<char> chunkResults(chunkCount, 0);
+    auto fnParseChunks = [&] (std::size_t iBegin, std::size_t iEnd) {
+        for (std::size_t i = iBegin; i < iEnd; ++i) {
+            const Handle_Message_ProgressIndicator chunkIndicator =
+                    i == 0 ? indicator : Handle_Message_ProgressIndicator();
+            chunkResults[i] = parseAsciiStl(
+                        chunkBegins[i], chunkBegins[i + 1],
+                        &chunkBuilders[i], chunkIndicator) ? 1 : 0;
+        }
+    };
+    cpp::parallelForRanges(chunkCount, fnParseChunks, chunkCount);
+    if (std::find(chunkResults.begin(), chunkResults.end(), 0) != chunkResults.end())
+        return false;
+
+    std::size_t facetCount = 0;
+    for (const StlMeshBuilder& chunkBuilder : chunkBuilders)
+        facetCount += chunkBuilder.facetCount();
+    builder->reserve(facetCount);
+    for (const StlMeshBuilder& chunkBuilder : chunkBuilders)
+        builder->append(chunkBuilder);
+    return true;
+}
+
+// -- STL writing
+
+/*! Writes binary STL facets to a stream through a fixed-size buffer
+ *
+ *  The facet count in the header is patched at the end by finish(), so
+ *  facets can be emitted without knowing their count in advance.
+ */
+class BinaryStlStreamWriter
+{
+public:
+    BinaryStlStreamWriter(std::ostream* ostr)
+        : m_ostr(ostr),
+          m_facetCount(0)
+    {
+        // 1MB buffer, about 20k facets
+        m_buffer.reserve(1024 * 1024);
+        const std::array<char, binaryStlHeaderSize> header = {};
+        m_ostr->write(header.data(), header.size());
+    }
+
+    void addFacet(const gp_Pnt& p1, const gp_Pnt& p2, const gp_Pnt& p3)
+    {
+        gp_Vec normal = gp_Vec(p1, p2).Crossed(gp_Vec(p1, p3));
+        if (normal.SquareMagnitude() > 0.)
+            normal.Normalize();
+
+        uchar record[binaryStlFacetSize] = {};
+        uchar* it = record;
+        it = writeXyz(it, normal.XYZ());
+        it = writeXyz(it, p1.XYZ());
+        it = writeXyz(it, p2.XYZ());
+        it = writeXyz(it, p3.XYZ());
+        m_buffer.insert(m_buffer.end(), record, record + binaryStlFacetSize);
+        ++m_facetCount;
+        if (m_buffer.size() + binaryStlFacetSize > m_buffer.capacity())
+            this->flush();
+    }
+
+    void finish()
+    {
+        this->flush();
+        uchar facetCount[sizeof(quint32)];
+        qToLittleEndian<quint32>(m_facetCount, facetCount);
+        m_ostr->seekp(80);
+        m_ostr->write(reinterpret_cast<const char*>(facetCount), sizeof(facetCount));
+        m_ostr->seekp(0, std::ios_base::end);
+    }
+
+private:
+    static uchar* writeXyz(uchar* it, const gp_XYZ& coords)
+    {
+        for (int i = 1; i <= 3; ++i) {
+            const float value = static_cast<float>(coords.Coord(i));
+            quint32 bits;
+            std::memcpy(&bits, &value, sizeof(float));
+            qToLittleEndian<quint32>(bits, it);
+            it += sizeof(float);
+        }
+        return it;
+    }
+
+    void flush()
+    {
+        m_ostr->write(reinterpret_cast<const char*>(m_buffer.data()), m_buffer.size());
+        m_buffer.clear();
+    }
+
+    std::ostream* m_ostr;
+    std::vector<uchar> m_buffer;
+    quint32 m_facetCount;
+};
+
+// -- Reading from memory
+
+//! Read-only std::streambuf over a memory buffer, contents are not copied
+class MemoryStreamBuffer : public std::streambuf
+{
+public:
+    MemoryStreamBuffer(const char* contents, std::size_t contentsSize)
+    {
+        char* begin = const_cast<char*>(contents);
+        this->setg(begin, begin, begin + contentsSize);
+    }
+};
+
+/*! Reads \p contents with \p fnLoadFile(fileName) through a temporary file
+ *
+ *  OCC translators (STEP, IGES) can only read files.
+ */
+template<typename FUNC>
+TopoDS_Shape loadContentsWithTempFile(
+        const char* contents, std::size_t contentsSize, FUNC fnLoadFile)
+{
+    QTemporaryFile file;
+    if (!file.open())
+        return TopoDS_Shape();
+    if (file.write(contents, contentsSize) != static_cast<qint64>(contentsSize))
+        return TopoDS_Shape();
+    file.close();
+    return fnLoadFile(file.fileName().toLocal8Bit().constData());
+}
+
+//! Aggregates the progress of the files loaded by IO::loadPartFiles()
+class MultiFileProgress
+{
+public:
+    MultiFileProgress(
+            const Handle_Message_ProgressIndicator& indicator,
+            std::size_t fileCount)
+        : m_indicator(indicator),
+          m_filePositions(fileCount, 0.),
+          m_min(0.),
+          m_max(100.)
+    {
+        if (!m_indicator.IsNull()) {
+            double step;
+            Standard_Boolean isInfinite;
+            m_indicator->GetScale(m_min, m_max, step, isInfinite);
+        }
+    }
+
+    void setFilePosition(std::size_t fileId, double pos)
+    {
+        if (m_indicator.IsNull())
+            return;
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_filePositions.at(fileId) = pos;
+        double sumPos = 0.;
+        for (double filePos : m_filePositions)
+            sumPos += filePos;
+        const double avgPos = sumPos / m_filePositions.size();
+        m_indicator->SetValue(m_min + (m_max - m_min) * avgPos);
+        m_indicator->Show(Standard_False);
+    }
+
+    bool userBreak()
+    {
+        if (m_indicator.IsNull())
+            return false;
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_indicator->UserBreak() == Standard_True;
+    }
+
+private:
+    std::mutex m_mutex;
+    Handle_Message_ProgressIndicator m_indicator;
+    std::vector<double> m_filePositions;
+    double m_min;
+    double m_max;
+};
+
+//! Progress indicator of one file, forwards to MultiFileProgress
+class FileProgressIndicator : public Message_ProgressIndicator
+{
+public:
+    FileProgressIndicator(MultiFileProgress* progress, std::size_t fileId)
+        : m_progress(progress),
+          m_fileId(fileId)
+    { }
+
+    Standard_Boolean Show(const Standard_Boolean /*force*/) override
+    {
+        m_progress->setFilePosition(m_fileId, this->GetPosition());
+        return Standard_True;
+    }
+
+    Standard_Boolean UserBreak() override
+    {
+        return m_progress->userBreak() ? Standard_True : Standard_False;
+    }
+
+private:
+    MultiFileProgress* m_progress;
+    const std::size_t m_fileId;
+};
+
 } // Anonymous namespace
 
 namespace occ {
@@ -132,17 +792,12 @@ IO::Format IO::partFormatFromContents(
 {
     // Assume a binary-based format (little-endian format)
     // -- Binary STL ?
-    const std::size_t binaryStlHeaderSize = 80 + sizeof(std::uint32_t);
     if (contentsBeginSize >= binaryStlHeaderSize) {
         const std::uint32_t offset = 80; // Skip header
-        const std::uint32_t facetsCount =
-                (static_cast<std::uint32_t>(contentsBegin[offset + 0]) << 24)
-                | (static_cast<std::uint32_t>(contentsBegin[offset + 1]) << 16)
-                | (static_cast<std::uint32_t>(contentsBegin[offset + 2]) << 8)
-                | (static_cast<std::uint32_t>(contentsBegin[offset + 3]));
-        const unsigned facetSize = (sizeof(float) * 12) + sizeof(std::uint16_t);
-
-        if ((facetSize * facetsCount + binaryStlHeaderSize)
+        const uchar* facetsCountBytes =
+                reinterpret_cast<const uchar*>(contentsBegin + offset);
+        const std::uint32_t facetsCount = qFromLittleEndian<quint32>(facetsCountBytes);
+        if ((binaryStlFacetSize * facetsCount + binaryStlHeaderSize)
                 == fullContentsSizeHint)
         {
             return BinaryStlFormat;
@@ -218,9 +873,28 @@ IO::Format IO::partFormatFromContents(
     return UnknownFormat;
 }
 
+/*! \brief Format of the contents available in \p device
+ *
+ *  The first bytes are peeked, so the current position of \p device is left
+ *  unchanged.\n
+ *  Binary STL can't be detected if \p device is sequential (its full size is
+ *  unknown).
+ */
+IO::Format IO::partFormatFromDevice(QIODevice* device)
+{
+    if (device == NULL || !device->isReadable())
+        return UnknownFormat;
+    const QByteArray contentsBegin = device->peek(2048);
+    const std::size_t fullSize =
+            device->isSequential() ? 0 : static_cast<std::size_t>(device->size());
+    return IO::partFormatFromContents(
+                contentsBegin.constData(), contentsBegin.size(), fullSize);
+}
+
 TopoDS_Shape IO::loadPartFile(
         FileNameLocal8Bit fileName, Handle_Message_ProgressIndicator indicator)
 {
+    CPPTOOLS_PROFILE_ZONE("occ::IO::loadPartFile");
     switch (partFormat(fileName)) {
     case StepFormat:
         return IO::loadStepFile(fileName, indicator);
@@ -233,12 +907,245 @@ TopoDS_Shape IO::loadPartFile(
     }
 }
 
+/*! \brief Same as loadPartFile() but translated shapes are cached on disk
+ *
+ *  The cache key is a 64b FNV-1a hash of the file contents (plus its size),
+ *  so a file is translated once whatever its path or modification time.\n
+ *  Shapes are stored in \p cacheDirPath with the binary encoding of
+ *  TopoDsUtils::shapeToBinaryString(), loading them back is much faster than
+ *  translating STEP or IGES files.\n
+ *  A cache entry that cannot be decoded (corrupted, or written by another
+ *  version of OpenCascade) is ignored : the file is translated again and the
+ *  entry replaced.
+ *
+ *  \param fileName Path to the file to read
+ *  \param cacheDirPath Directory of the cache files, created if needed
+ *  \param indicator Indicator to notify the loading progress (cache misses)
+ */
+TopoDS_Shape IO::loadPartFileCached(
+        FileNameLocal8Bit fileName,
+        const std::string& cacheDirPath,
+        Handle_Message_ProgressIndicator indicator)
+{
+    QFile file(QString::fromLocal8Bit(fileName));
+    if (!file.open(QIODevice::ReadOnly))
+        return TopoDS_Shape();
+    const qint64 fileSize = file.size();
+    const uchar* contents = fileSize > 0 ? file.map(0, fileSize) : NULL;
+    if (contents == NULL)
+        return IO::loadPartFile(fileName, indicator);
+    const std::uint64_t hash = cpp::hash64_fnv_1a()(contents, fileSize);
+    file.close();
+
+    const QDir cacheDir(QString::fromLocal8Bit(cacheDirPath.c_str()));
+    const QString cacheFileName =
+            cacheDir.filePath(QString("%1-%2.obs")
+                              .arg(hash, 16, 16, QChar('0'))
+                              .arg(fileSize));
+
+    // Cache hit ?
+    QFile cacheFile(cacheFileName);
+    if (cacheFile.open(QIODevice::ReadOnly)) {
+        const QByteArray encodedShape = cacheFile.readAll();
+        cacheFile.close(); // Replaced below if unreadable
+        try {
+            const TopoDS_Shape shape = TopoDsUtils::shapeFromBinaryString(
+                        std::string(encodedShape.constData(), encodedShape.size()));
+            if (!shape.IsNull())
+                return shape;
+        }
+        catch (const Standard_Failure&) {
+            // Stale or corrupted cache entry, translated again below
+        }
+    }
+
+    // Cache miss : translate and store
+    const TopoDS_Shape shape = IO::loadPartFile(fileName, indicator);
+    if (!shape.IsNull() && cacheDir.mkpath(".")) {
+        const std::string encodedShape = TopoDsUtils::shapeToBinaryString(shape);
+        QSaveFile saveFile(cacheFileName); // Atomic write
+        if (saveFile.open(QIODevice::WriteOnly)) {
+            saveFile.write(encodedShape.data(), encodedShape.size());
+            saveFile.commit();
+        }
+    }
+    return shape;
+}
+
+/*! \brief Topologic shape read from a memory buffer (STEP, IGES or OCC BREP)
+ *
+ *  The format is detected with partFormatFromContents().\n
+ *  OCC BREP contents are read directly from memory. OCC translators can only
+ *  read files, so STEP and IGES contents are first written to a temporary
+ *  file.
+ *
+ *  \param contents Beginning of the buffer
+ *  \param contentsSize Size of the buffer in bytes
+ *  \param indicator Indicator to notify the loading progress
+ */
+TopoDS_Shape IO::loadPartFromContents(
+        const char* contents,
+        std::size_t contentsSize,
+        Handle_Message_ProgressIndicator indicator)
+{
+    const std::size_t contentsBeginSize = std::min<std::size_t>(contentsSize, 2048);
+    switch (IO::partFormatFromContents(contents, contentsBeginSize, contentsSize)) {
+    case StepFormat:
+        return loadContentsWithTempFile(
+                    contents, contentsSize, [=] (FileNameLocal8Bit fileName) {
+            return IO::loadStepFile(fileName, indicator);
+        });
+    case IgesFormat:
+        return loadContentsWithTempFile(
+                    contents, contentsSize, [=] (FileNameLocal8Bit fileName) {
+            return IO::loadIgesFile(fileName, indicator);
+        });
+    case OccBrepFormat: {
+        MemoryStreamBuffer buffer(contents, contentsSize);
+        std::istream istr(&buffer);
+        TopoDS_Shape result;
+        BRep_Builder brepBuilder;
+        BRepTools::Read(result, istr, brepBuilder, indicator);
+        return result;
+    }
+    default:
+        return TopoDS_Shape();
+    }
+}
+
+/*! \brief Topologic shape read from the remaining contents of \p device
+ *
+ *  If \p device is a QFile, the file is directly read with loadPartFile().
+ *  Otherwise all the contents are read into memory and loaded with
+ *  loadPartFromContents().
+ */
+TopoDS_Shape IO::loadPartFromDevice(
+        QIODevice* device, Handle_Message_ProgressIndicator indicator)
+{
+    if (device == NULL || !device->isReadable())
+        return TopoDS_Shape();
+    const QFile* file = qobject_cast<const QFile*>(device);
+    if (file != NULL && device->pos() == 0 && !file->fileName().isEmpty())
+        return IO::loadPartFile(file->fileName().toLocal8Bit().constData(), indicator);
+    const QByteArray contents = device->readAll();
+    return IO::loadPartFromContents(contents.constData(), contents.size(), indicator);
+}
+
+/*! \brief Topologic shapes read from files, concurrently
+ *
+ *  Each file is loaded with loadPartFile(). Files are distributed dynamically
+ *  on a pool of threads, so a thread loading a big file does not delay the
+ *  loading of the other files.
+ *
+ *  \param fileNames Paths to the files to read
+ *  \param indicator Indicator to notify the overall loading progress, that is
+ *                   the mean progress of all the files. It is accessed from
+ *                   the loading threads (never concurrently)
+ *  \param threadCount Maximum count of threads to use (0 means as many as
+ *                     the hardware supports)
+ *  \return The shapes loaded, in the order of \p fileNames (null shapes for
+ *          files that could not be loaded)
+ */
+std::vector<TopoDS_Shape> IO::loadPartFiles(
+        const std::vector<std::string>& fileNames,
+        Handle_Message_ProgressIndicator indicator,
+        unsigned threadCount)
+{
+    std::vector<TopoDS_Shape> result(fileNames.size());
+    if (fileNames.empty())
+        return result;
+
+    // Static initialization of translation controllers is not thread-safe
+    IGESControl_Controller::Init();
+    STEPControl_Controller::Init();
+
+    MultiFileProgress progress(indicator, fileNames.size());
+    std::atomic<std::size_t> nextFileId(0);
+    auto fnLoadFiles = [&] (std::size_t /*iWorkerBegin*/, std::size_t /*iWorkerEnd*/) {
+        std::size_t fileId = nextFileId++;
+        while (fileId < fileNames.size() && !progress.userBreak()) {
+            Handle_Message_ProgressIndicator fileIndicator;
+            if (!indicator.IsNull())
+                fileIndicator = new FileProgressIndicator(&progress, fileId);
+            result.at(fileId) =
+                    IO::loadPartFile(fileNames.at(fileId).c_str(), fileIndicator);
+            progress.setFilePosition(fileId, 1.);
+            fileId = nextFileId++;
+        }
+    };
+
+    // One chunk per worker thread, each worker loads files until none is left
+    if (threadCount == 0)
+        threadCount = cpp::parallelThreadCount();
+    const std::size_t workerCount = std::min<std::size_t>(threadCount, fileNames.size());
+    cpp::parallelForRanges(workerCount, fnLoadFiles, threadCount);
+    return result;
+}
+
 Handle_StlMesh_Mesh IO::loadStlFile(
         FileNameLocal8Bit fileName, Handle_Message_ProgressIndicator indicator)
 {
     return RWStl::ReadFile(OSD_Path(fileName), indicator);
 }
 
+/*! \brief Triangle mesh read from a file (ASCII or binary STL format)
+ *
+ *  The file is memory-mapped and parsed in a single pass without going
+ *  through StlMesh_Mesh. Vertices shared by facets are merged (exact
+ *  coordinates comparison), so the resulting mesh is indexed.\n
+ *  Big ASCII files are split into chunks parsed by concurrent threads.
+ *
+ *  \param fileName Path to the file to read
+ *  \param indicator Indicator to notify the loading progress
+ *  \return The mesh, or a null handle if the file could not be read or if
+ *          the loading was stopped by the user
+ */
+Handle_Poly_Triangulation IO::loadStlFileAsTriangulation(
+        FileNameLocal8Bit fileName, Handle_Message_ProgressIndicator indicator)
+{
+    QFile file(QString::fromLocal8Bit(fileName));
+    if (!file.open(QIODevice::ReadOnly) || file.size() == 0)
+        return NULL;
+    const uchar* contents = file.map(0, file.size());
+    if (contents == NULL)
+        return NULL;
+    return IO::loadStlContentsAsTriangulation(
+                reinterpret_cast<const char*>(contents),
+                static_cast<std::size_t>(file.size()),
+                indicator);
+}
+
+/*! \brief Triangle mesh read from a memory buffer (ASCII or binary STL format)
+ *
+ *  Same as loadStlFileAsTriangulation(), but contents are already in memory
+ */
+Handle_Poly_Triangulation IO::loadStlContentsAsTriangulation(
+        const char* contents,
+        std::size_t contentsSize,
+        Handle_Message_ProgressIndicator indicator)
+{
+    const std::size_t contentsBeginSize = std::min<std::size_t>(contentsSize, 2048);
+    StlMeshBuilder builder;
+    bool ok = false;
+    switch (IO::partFormatFromContents(contents, contentsBeginSize, contentsSize)) {
+    case BinaryStlFormat:
+        ok = parseBinaryStl(
+                    reinterpret_cast<const uchar*>(contents),
+                    contentsSize,
+                    &builder,
+                    indicator);
+        break;
+    case AsciiStlFormat:
+        ok = parseAsciiStlParallel(contents, contents + contentsSize, &builder, indicator);
+        break;
+    default:
+        break;
+    }
+    if (ok && builder.facetCount() > 0)
+        return builder.toTriangulation();
+    return NULL;
+}
+
 /*! \brief Topologic shape read from a file (OCC's internal BREP format)
  *  \param fileName Path to the file to read
  *  \param indicator Indicator to notify the loading progress
@@ -275,25 +1182,59 @@ TopoDS_Shape IO::loadStepFile(
     return ::loadFile<STEPControl_Reader>(fileName, indicator);
 }
 
+/*! \brief Topologic shape read from a file (IGES format), root by root
+ *
+ *  Unlike loadIgesFile() which returns only once all the roots are translated,
+ *  \p onRootShapeLoaded is called with the shape of each root as soon as it
+ *  is translated (roots producing no shape are skipped). So the first
+ *  components of big assemblies can be displayed while the others are still
+ *  loading.
+ *
+ *  \p onRootShapeLoaded is called in the thread calling this function
+ *
+ *  \return The part as a whole topologic shape, partial if aborted
+ */
+TopoDS_Shape IO::loadIgesFileByRoots(
+        FileNameLocal8Bit fileName,
+        const RootShapeLoadedFunction& onRootShapeLoaded,
+        Handle_Message_ProgressIndicator indicator)
+{
+    return ::loadFileByRoots<IGESControl_Reader>(fileName, onRootShapeLoaded, indicator);
+}
+
+/*! \brief Topologic shape read from a file (STEP format), root by root
+ *
+ *  \sa loadIgesFileByRoots()
+ */
+TopoDS_Shape IO::loadStepFileByRoots(
+        FileNameLocal8Bit fileName,
+        const RootShapeLoadedFunction& onRootShapeLoaded,
+        Handle_Message_ProgressIndicator indicator)
+{
+    return ::loadFileByRoots<STEPControl_Reader>(fileName, onRootShapeLoaded, indicator);
+}
+
 /*! \brief Write a topologic shape to a file (OCC's internal BREP format)
  *  \param shape Topologic shape to write
  *  \param fileName Path to the file to write
  *  \param indicator Indicator to notify the writing progress
+ *  \return true if the file was written
  */
-void IO::writeBrepFile(
+bool IO::writeBrepFile(
         const TopoDS_Shape& shape,
         FileNameLocal8Bit fileName,
         Handle_Message_ProgressIndicator indicator)
 {
-    BRepTools::Write(shape, fileName, indicator);
+    return BRepTools::Write(shape, fileName, indicator) == Standard_True;
 }
 
 /*! \brief Write a topologic shape to a file (IGES format)
  *  \param shape Topologic shape to write
  *  \param fileName Path to the file to write
  *  \param indicator Indicator to notify the writing progress
+ *  \return true if the file was written
  */
-void IO::writeIgesFile(
+bool IO::writeIgesFile(
         const TopoDS_Shape& shape,
         FileNameLocal8Bit fileName,
         Handle_Message_ProgressIndicator indicator)
@@ -306,16 +1247,18 @@ void IO::writeIgesFile(
         writer.TransferProcess()->SetProgress(indicator);
     writer.AddShape(shape);
     writer.ComputeModel();
-    writer.Write(fileName);
+    const bool isWritten = writer.Write(fileName) == Standard_True;
     writer.TransferProcess()->SetProgress(NULL);
+    return isWritten;
 }
 
 /*! \brief Write a topologic shape to a file (STEP format)
  *  \param shape Topologic shape to write
  *  \param fileName Path to the file to write
  *  \param indicator Indicator to notify the writing progress
+ *  \return true if the shape was transferred and the file written
  */
-void IO::writeStepFile(
+bool IO::writeStepFile(
         const TopoDS_Shape& shape,
         FileNameLocal8Bit fileName,
         Handle_Message_ProgressIndicator indicator)
@@ -325,8 +1268,10 @@ void IO::writeStepFile(
     if (!indicator.IsNull())
         writer.WS()->TransferWriter()->FinderProcess()->SetProgress(indicator);
     status = writer.Transfer(shape, STEPControl_AsIs);
-    status = writer.Write(fileName);
+    if (status == IFSelect_RetDone)
+        status = writer.Write(fileName);
     writer.WS()->TransferWriter()->FinderProcess()->SetProgress(NULL);
+    return status == IFSelect_RetDone;
 }
 
 /*! \brief Write a topologic shape to a file (ASCII STL format)
@@ -342,15 +1287,55 @@ void IO::writeAsciiStlFile(
 }
 
 /*! \brief Write a topologic shape to a file (binary STL format)
+ *
+ *  Facets are streamed face by face, so the memory used does not depend on
+ *  the size of the shape. Faces with no triangulation are meshed on the fly,
+ *  with a deflection relative to the size of the shape (like StlAPI_Writer).
+ *
  *  \param shape Topologic shape to write
  *  \param fileName Path to the file to write
  */
 void IO::writeBinaryStlFile(
         const TopoDS_Shape& shape, FileNameLocal8Bit fileName)
 {
-    StlAPI_Writer writer;
-    writer.ASCIIMode() = Standard_False;
-    writer.Write(shape, fileName);
+    std::ofstream ofs(fileName, std::ios_base::out | std::ios_base::binary);
+    if (!ofs)
+        return;
+
+    double deflection = -1.; // Computed on first face lacking triangulation
+    BinaryStlStreamWriter writer(&ofs);
+    auto fnWriteFace = [&] (const TopoDS_Shape& faceShape) {
+        const TopoDS_Face& face = TopoDS::Face(faceShape);
+        TopLoc_Location loc;
+        Handle_Poly_Triangulation triangulation = BRep_Tool::Triangulation(face, loc);
+        if (triangulation.IsNull()) {
+            if (deflection < 0.) {
+                Bnd_Box box;
+                BRepBndLib::Add(shape, box);
+                deflection = 0.001 * std::sqrt(box.SquareExtent());
+            }
+            BRepMesh_IncrementalMesh(face, deflection);
+            triangulation = BRep_Tool::Triangulation(face, loc);
+            if (triangulation.IsNull())
+                return;
+        }
+
+        const gp_Trsf& trsf = loc.Transformation();
+        const TColgp_Array1OfPnt& nodes = triangulation->Nodes();
+        const Poly_Array1OfTriangle& triangles = triangulation->Triangles();
+        const bool isReversed = face.Orientation() == TopAbs_REVERSED;
+        for (int i = triangles.Lower(); i <= triangles.Upper(); ++i) {
+            int n1, n2, n3;
+            triangles(i).Get(n1, n2, n3);
+            if (isReversed)
+                std::swap(n2, n3);
+            writer.addFacet(nodes(n1).Transformed(trsf),
+                            nodes(n2).Transformed(trsf),
+                            nodes(n3).Transformed(trsf));
+        }
+    };
+    occ::TopoDsUtils::forEachFace(shape, fnWriteFace);
+    writer.finish();
 }
 
 } // namespace occ
@@ -17,8 +17,13 @@
 
 #include "occtools.h"
 #include <Handle_Message_ProgressIndicator.hxx>
+#include <Handle_Poly_Triangulation.hxx>
 #include <Handle_StlMesh_Mesh.hxx>
 #include <TopoDS_Shape.hxx>
+#include <functional>
+#include <string>
+#include <vector>
+class QIODevice;
 
 namespace occ {
 
@@ -42,14 +47,40 @@ public:
             const char* contentsBegin,
             std::size_t contentsBeginSize,
             std::size_t fullContentsSizeHint = 0);
+    static Format partFormatFromDevice(QIODevice* device);
 
     static TopoDS_Shape loadPartFile(
             FileNameLocal8Bit fileName,
             Handle_Message_ProgressIndicator indicator = NULL);
 
+    static TopoDS_Shape loadPartFileCached(
+            FileNameLocal8Bit fileName,
+            const std::string& cacheDirPath,
+            Handle_Message_ProgressIndicator indicator = NULL);
+
+    static TopoDS_Shape loadPartFromContents(
+            const char* contents,
+            std::size_t contentsSize,
+            Handle_Message_ProgressIndicator indicator = NULL);
+    static TopoDS_Shape loadPartFromDevice(
+            QIODevice* device,
+            Handle_Message_ProgressIndicator indicator = NULL);
+
+    static std::vector<TopoDS_Shape> loadPartFiles(
+            const std::vector<std::string>& fileNames,
+            Handle_Message_ProgressIndicator indicator = NULL,
+            unsigned threadCount = 0);
+
     static Handle_StlMesh_Mesh loadStlFile(
             FileNameLocal8Bit fileName,
             Handle_Message_ProgressIndicator indicator = NULL);
+    static Handle_Poly_Triangulation loadStlFileAsTriangulation(
+            FileNameLocal8Bit fileName,
+            Handle_Message_ProgressIndicator indicator = NULL);
+    static Handle_Poly_Triangulation loadStlContentsAsTriangulation(
+            const char* contents,
+            std::size_t contentsSize,
+            Handle_Message_ProgressIndicator indicator = NULL);
 
     static TopoDS_Shape loadBrepFile(
             FileNameLocal8Bit fileName,
@@ -61,15 +92,27 @@ public:
             FileNameLocal8Bit fileName,
             Handle_Message_ProgressIndicator indicator = NULL);
 
-    static void writeBrepFile(
+    typedef std::function<void(const TopoDS_Shape& rootShape,
+                               int rootIndex,
+                               int rootCount)> RootShapeLoadedFunction;
+    static TopoDS_Shape loadIgesFileByRoots(
+            FileNameLocal8Bit fileName,
+            const RootShapeLoadedFunction& onRootShapeLoaded,
+            Handle_Message_ProgressIndicator indicator = NULL);
+    static TopoDS_Shape loadStepFileByRoots(
+            FileNameLocal8Bit fileName,
+            const RootShapeLoadedFunction& onRootShapeLoaded,
+            Handle_Message_ProgressIndicator indicator = NULL);
+
+    static bool writeBrepFile(
             const TopoDS_Shape& shape,
             FileNameLocal8Bit fileName,
             Handle_Message_ProgressIndicator indicator = NULL);
-    static void writeIgesFile(
+    static bool writeIgesFile(
             const TopoDS_Shape& shape,
             FileNameLocal8Bit fileName,
             Handle_Message_ProgressIndicator indicator = NULL);
-    static void writeStepFile(
+    static bool writeStepFile(
             const TopoDS_Shape& shape,
             FileNameLocal8Bit fileName,
             Handle_Message_ProgressIndicator indicator = NULL);
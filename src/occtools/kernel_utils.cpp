@@ -17,6 +17,27 @@
 
 namespace occ {
 
+namespace internal {
+
+//! Values k/255 for k in [0, 255], so color components are not divided again
+//! for each conversion
+struct UnitColorComponents
+{
+    UnitColorComponents()
+    {
+        for (int k = 0; k < 256; ++k)
+            values[k] = k / 255.;
+    }
+
+    double operator()(int k) const { return values[k & 0xFF]; }
+
+    double values[256];
+};
+
+static const UnitColorComponents unitColorComponent;
+
+} // namespace internal
+
 /*! \class KernelUtils
  *  \brief Collection of tools for the Kernel toolkit
  *
@@ -24,9 +45,42 @@ namespace occ {
  *  \ingroup occtools
  */
 
-Quantity_Color KernelUtils::rgbColor(int red, int blue, int green)
+/*! Quantity_Color of components \p red, \p green and \p blue in [0, 255]
+ *
+ *  Components out of range are wrapped modulo 256
+ */
+Quantity_Color KernelUtils::rgbColor(int red, int green, int blue)
+{
+    return Quantity_Color(
+                internal::unitColorComponent(red),
+                internal::unitColorComponent(green),
+                internal::unitColorComponent(blue),
+                Quantity_TOC_RGB);
+}
+
+//! Quantity_Color of packed \p rgb value 0xRRGGBB (alpha bits are ignored, so
+//! a QRgb can be passed)
+Quantity_Color KernelUtils::rgbColor(std::uint32_t rgb)
+{
+    return KernelUtils::rgbColor(
+                static_cast<int>(rgb >> 16), static_cast<int>(rgb >> 8), static_cast<int>(rgb));
+}
+
+/*! Converts the \p count packed values of array \p rgbs (see rgbColor()) into
+ *  array \p colors
+ *
+ *  A run of identical values is converted once, as with per-face coloring
+ *  where neighbour faces often share a color
+ */
+void KernelUtils::rgbColors(
+        const std::uint32_t* rgbs, std::size_t count, Quantity_Color* colors)
 {
-    return Quantity_Color(red / 255., blue / 255., green / 255., Quantity_TOC_RGB);
+    for (std::size_t i = 0; i < count; ++i) {
+        if (i > 0 && (rgbs[i] & 0xFFFFFF) == (rgbs[i - 1] & 0xFFFFFF))
+            colors[i] = colors[i - 1];
+        else
+            colors[i] = KernelUtils::rgbColor(rgbs[i]);
+    }
 }
 
 } // namespace occ
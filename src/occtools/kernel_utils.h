@@ -19,12 +19,18 @@
 
 #include <Quantity_Color.hxx>
 
+#include <cstddef>
+#include <cstdint>
+
 namespace occ {
 
 class OCCTOOLS_EXPORT KernelUtils
 {
 public:
-    static Quantity_Color rgbColor(int red, int blue, int green);
+    static Quantity_Color rgbColor(int red, int green, int blue);
+    static Quantity_Color rgbColor(std::uint32_t rgb);
+    static void rgbColors(
+            const std::uint32_t* rgbs, std::size_t count, Quantity_Color* colors);
 };
 
 } // namespace occ
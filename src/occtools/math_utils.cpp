@@ -18,12 +18,43 @@
 #include <algorithm>
 #include <cassert>
 #include <cmath>
+#include <limits>
 
 #include <Poly_Triangle.hxx>
 #include <TColgp_Array1OfPnt.hxx>
 
 namespace occ {
 
+namespace internal {
+
+//! Coefficients of the 3x4 matrix of a gp_Trsf, scale factor included
+struct AffineMatrix
+{
+    explicit AffineMatrix(const gp_Trsf& trsf)
+        : a11(trsf.Value(1, 1)), a12(trsf.Value(1, 2)), a13(trsf.Value(1, 3)),
+          a14(trsf.Value(1, 4)),
+          a21(trsf.Value(2, 1)), a22(trsf.Value(2, 2)), a23(trsf.Value(2, 3)),
+          a24(trsf.Value(2, 4)),
+          a31(trsf.Value(3, 1)), a32(trsf.Value(3, 2)), a33(trsf.Value(3, 3)),
+          a34(trsf.Value(3, 4))
+    { }
+
+    const double a11, a12, a13, a14;
+    const double a21, a22, a23, a24;
+    const double a31, a32, a33, a34;
+};
+
+//! Count of triangles processed together by projectPointOnTriangles()
+static const std::size_t triangleLaneCount = 8;
+
+//! Clamps \p x in [0, 1]
+static inline double clamp01(double x)
+{
+    return x < 0. ? 0. : (x > 1. ? 1. : x);
+}
+
+} // namespace internal
+
 /*! \class MathUtils
  *  \brief Collection of tools for the Math toolkit
  *
@@ -59,6 +90,54 @@ gp_Trsf MathUtils::transformation(const gp_Quaternion &q, const gp_Vec &vec)
     return trsf;
 }
 
+/*! \brief Applies \p trsf to \p count points stored as contiguous xyz
+ *         triplets (array of structures)
+ *
+ *  \p xyzIn and \p xyzOut must hold 3 * \p count values, they can be the
+ *  same array in which case the points are transformed in place.
+ *
+ *  \note The loop has no branch nor call and the matrix of \p trsf is
+ *        extracted once, so the compiler can vectorize it. For best
+ *        throughput prefer the SoA overload, whose loads are not strided
+ */
+void MathUtils::transformPoints(
+        const gp_Trsf &trsf,
+        const double *xyzIn, double *xyzOut, std::size_t count)
+{
+    const internal::AffineMatrix m(trsf);
+    for (std::size_t i = 0; i < count; ++i) {
+        const double x = xyzIn[3*i];
+        const double y = xyzIn[3*i + 1];
+        const double z = xyzIn[3*i + 2];
+        xyzOut[3*i]     = m.a11 * x + m.a12 * y + m.a13 * z + m.a14;
+        xyzOut[3*i + 1] = m.a21 * x + m.a22 * y + m.a23 * z + m.a24;
+        xyzOut[3*i + 2] = m.a31 * x + m.a32 * y + m.a33 * z + m.a34;
+    }
+}
+
+/*! \brief Applies \p trsf to \p count points stored as separate x, y and z
+ *         arrays (structure of arrays)
+ *
+ *  Output arrays can be the input arrays, in which case the points are
+ *  transformed in place.
+ */
+void MathUtils::transformPoints(
+        const gp_Trsf &trsf,
+        const double *xIn, const double *yIn, const double *zIn,
+        double *xOut, double *yOut, double *zOut,
+        std::size_t count)
+{
+    const internal::AffineMatrix m(trsf);
+    for (std::size_t i = 0; i < count; ++i) {
+        const double x = xIn[i];
+        const double y = yIn[i];
+        const double z = zIn[i];
+        xOut[i] = m.a11 * x + m.a12 * y + m.a13 * z + m.a14;
+        yOut[i] = m.a21 * x + m.a22 * y + m.a23 * z + m.a24;
+        zOut[i] = m.a31 * x + m.a32 * y + m.a33 * z + m.a34;
+    }
+}
+
 gp_Pnt MathUtils::projectPointOnPlane(const gp_Pnt &p, const gp_Vec &n)
 {
     const gp_Vec pVec(p.X(), p.Y(), p.Z());
@@ -66,6 +145,54 @@ gp_Pnt MathUtils::projectPointOnPlane(const gp_Pnt &p, const gp_Vec &n)
     return p.Translated(-dotVN * n);
 }
 
+/*! \brief Batch version of projectPointOnPlane() for \p count points stored
+ *         as contiguous xyz triplets
+ *
+ *  \p xyzIn and \p xyzOut can be the same array.
+ */
+void MathUtils::projectPointsOnPlane(
+        const gp_Vec &n,
+        const double *xyzIn, double *xyzOut, std::size_t count)
+{
+    const double nx = n.X();
+    const double ny = n.Y();
+    const double nz = n.Z();
+    for (std::size_t i = 0; i < count; ++i) {
+        const double x = xyzIn[3*i];
+        const double y = xyzIn[3*i + 1];
+        const double z = xyzIn[3*i + 2];
+        const double dotVN = x * nx + y * ny + z * nz;
+        xyzOut[3*i]     = x - dotVN * nx;
+        xyzOut[3*i + 1] = y - dotVN * ny;
+        xyzOut[3*i + 2] = z - dotVN * nz;
+    }
+}
+
+/*! \brief Batch version of projectPointOnPlane() for \p count points stored
+ *         as separate x, y and z arrays
+ *
+ *  Output arrays can be the input arrays.
+ */
+void MathUtils::projectPointsOnPlane(
+        const gp_Vec &n,
+        const double *xIn, const double *yIn, const double *zIn,
+        double *xOut, double *yOut, double *zOut,
+        std::size_t count)
+{
+    const double nx = n.X();
+    const double ny = n.Y();
+    const double nz = n.Z();
+    for (std::size_t i = 0; i < count; ++i) {
+        const double x = xIn[i];
+        const double y = yIn[i];
+        const double z = zIn[i];
+        const double dotVN = x * nx + y * ny + z * nz;
+        xOut[i] = x - dotVN * nx;
+        yOut[i] = y - dotVN * ny;
+        zOut[i] = z - dotVN * nz;
+    }
+}
+
 std::pair<gp_Pnt, bool> MathUtils::projectPointOnTriangle(
         const gp_Pnt &p, const gp_Pnt &v0, const gp_Pnt &v1, const gp_Pnt &v2)
 {
@@ -169,6 +296,126 @@ Standard_Real MathUtils::manhattanNorm(const gp_Vec &vec)
     return std::fabs(vec.X()) + std::fabs(vec.Y()) + std::fabs(vec.Z());
 }
 
+MathUtils::TriangleProjection::TriangleProjection()
+    : triangleId(0),
+      u(0.),
+      v(0.),
+      squareDistance(std::numeric_limits<Standard_Real>::max()),
+      isInside(false)
+{
+}
+
+/*! \brief Returns the projection of \p p on the closest of the first \p count
+ *         triangles in \p triangles
+ *
+ *  The projected point is TriangleProjection::point = v0 + u*(v1-v0) + v*(v2-v0)
+ *  for the vertices of triangle TriangleProjection::triangleId.\n
+ *  Triangles are processed by blocks of 8 with a branch-free formulation (the
+ *  closest point is the minimum of the interior projection and the three edge
+ *  projections), so the compiler can vectorize the block loop. The answer is
+ *  the same as calling projectPointOnTriangle() for each triangle.
+ *
+ *  If \p count is 0 the returned TriangleProjection::squareDistance is the
+ *  maximum value of Standard_Real.
+ */
+MathUtils::TriangleProjection MathUtils::projectPointOnTriangles(
+        const gp_Pnt &p, const TriangleArrays &triangles, std::size_t count)
+{
+    const std::size_t laneCount = internal::triangleLaneCount;
+    const double px = p.X();
+    const double py = p.Y();
+    const double pz = p.Z();
+
+    TriangleProjection result;
+    std::size_t resultId = 0;
+    for (std::size_t iBlock = 0; iBlock < count; iBlock += laneCount) {
+        const std::size_t blockSize = std::min(laneCount, count - iBlock);
+        double laneS[laneCount];
+        double laneT[laneCount];
+        double laneSqrDist[laneCount];
+        bool laneInside[laneCount];
+        for (std::size_t k = 0; k < blockSize; ++k) {
+            const std::size_t i = iBlock + k;
+            const double e0x = triangles.v1x[i] - triangles.v0x[i];
+            const double e0y = triangles.v1y[i] - triangles.v0y[i];
+            const double e0z = triangles.v1z[i] - triangles.v0z[i];
+            const double e1x = triangles.v2x[i] - triangles.v0x[i];
+            const double e1y = triangles.v2y[i] - triangles.v0y[i];
+            const double e1z = triangles.v2z[i] - triangles.v0z[i];
+            const double dx = triangles.v0x[i] - px;
+            const double dy = triangles.v0y[i] - py;
+            const double dz = triangles.v0z[i] - pz;
+
+            const double a = e0x * e0x + e0y * e0y + e0z * e0z;
+            const double b = e0x * e1x + e0y * e1y + e0z * e1z;
+            const double c = e1x * e1x + e1y * e1y + e1z * e1z;
+            const double d = e0x * dx + e0y * dy + e0z * dz;
+            const double e = e1x * dx + e1y * dy + e1z * dz;
+            const double f = dx * dx + dy * dy + dz * dz;
+            const double det = a * c - b * b;
+
+            // Squared distance from p to v0 + s*e0 + t*e1
+            auto fnSqrDist = [=] (double s, double t) {
+                return a * s * s + 2. * b * s * t + c * t * t
+                        + 2. * (d * s + e * t) + f;
+            };
+
+            // Interior projection
+            const double invDet = det > 0. ? 1. / det : 0.;
+            const double sIn = (b * e - c * d) * invDet;
+            const double tIn = (b * d - a * e) * invDet;
+            const bool isInside =
+                    det > 0. && sIn >= 0. && tIn >= 0. && sIn + tIn <= 1.;
+
+            // Projections on edges (v0,v1), (v0,v2) and (v1,v2)
+            const double s01 = a > 0. ? internal::clamp01(-d / a) : 0.;
+            const double t02 = c > 0. ? internal::clamp01(-e / c) : 0.;
+            const double denom12 = a - 2. * b + c;
+            const double t12 =
+                    denom12 > 0. ? internal::clamp01((a - b + d - e) / denom12) : 0.;
+
+            const double sqrDist01 = fnSqrDist(s01, 0.);
+            const double sqrDist02 = fnSqrDist(0., t02);
+            const double sqrDist12 = fnSqrDist(1. - t12, t12);
+            double s = s01;
+            double t = 0.;
+            double sqrDist = sqrDist01;
+            s = sqrDist02 < sqrDist ? 0. : s;
+            t = sqrDist02 < sqrDist ? t02 : t;
+            sqrDist = std::min(sqrDist02, sqrDist);
+            s = sqrDist12 < sqrDist ? 1. - t12 : s;
+            t = sqrDist12 < sqrDist ? t12 : t;
+            sqrDist = std::min(sqrDist12, sqrDist);
+
+            laneS[k] = isInside ? sIn : s;
+            laneT[k] = isInside ? tIn : t;
+            laneSqrDist[k] = isInside ? std::max(fnSqrDist(sIn, tIn), 0.) : sqrDist;
+            laneInside[k] = isInside;
+        }
+
+        for (std::size_t k = 0; k < blockSize; ++k) {
+            if (laneSqrDist[k] < result.squareDistance) {
+                resultId = iBlock + k;
+                result.u = laneS[k];
+                result.v = laneT[k];
+                result.squareDistance = laneSqrDist[k];
+                result.isInside = laneInside[k];
+            }
+        }
+    }
+
+    if (count > 0) {
+        const std::size_t i = resultId;
+        const gp_Pnt v0(triangles.v0x[i], triangles.v0y[i], triangles.v0z[i]);
+        const gp_Vec e0(v0, gp_Pnt(triangles.v1x[i], triangles.v1y[i], triangles.v1z[i]));
+        const gp_Vec e1(v0, gp_Pnt(triangles.v2x[i], triangles.v2y[i], triangles.v2z[i]));
+        result.triangleId = resultId;
+        result.point = v0.Translated(e0 * result.u).Translated(e1 * result.v);
+        result.squareDistance = p.SquareDistance(result.point);
+    }
+    return result;
+}
+
 /*! \brief Returns the component of \p vec having the maximum absolute value */
 Standard_Real MathUtils::maximumNorm(const gp_Vec &vec)
 {
@@ -17,6 +17,7 @@
 
 #include "occtools.h"
 
+#include <cstddef>
 #include <utility>
 #include <gp_Ax3.hxx>
 #include <gp_Vec.hxx>
@@ -30,15 +31,56 @@ namespace occ {
 class OCCTOOLS_EXPORT MathUtils
 {
 public:
+    //! Vertices of triangles stored as separate coordinate arrays
+    struct TriangleArrays
+    {
+        const double* v0x; const double* v0y; const double* v0z;
+        const double* v1x; const double* v1y; const double* v1z;
+        const double* v2x; const double* v2y; const double* v2z;
+    };
+
+    //! Projection of a point on its closest triangle among TriangleArrays
+    struct OCCTOOLS_EXPORT TriangleProjection
+    {
+        TriangleProjection();
+        std::size_t triangleId;
+        gp_Pnt point;
+        Standard_Real u; //!< Coordinate along edge (v0,v1)
+        Standard_Real v; //!< Coordinate along edge (v0,v2)
+        Standard_Real squareDistance;
+        bool isInside;
+    };
+
     static gp_Trsf displacement(const gp_Ax3& srcSys, const gp_Ax3& dstSys);
     static gp_Trsf transformation(const gp_Ax3& srcSys, const gp_Ax3& dstSys);
     static gp_Trsf transformation(const gp_Ax3& dstSys);
     static gp_Trsf transformation(const gp_Quaternion& q, const gp_Vec& vec);
 
+    // Batch transformations
+    static void transformPoints(
+            const gp_Trsf& trsf,
+            const double* xyzIn, double* xyzOut, std::size_t count);
+    static void transformPoints(
+            const gp_Trsf& trsf,
+            const double* xIn, const double* yIn, const double* zIn,
+            double* xOut, double* yOut, double* zOut,
+            std::size_t count);
+
     static gp_Pnt projectPointOnPlane(const gp_Pnt& p, const gp_Vec& n);
     static std::pair<gp_Pnt, bool> projectPointOnTriangle(
             const gp_Pnt& p,
             const gp_Pnt& v0, const gp_Pnt& v1, const gp_Pnt& v2);
+    static TriangleProjection projectPointOnTriangles(
+            const gp_Pnt& p, const TriangleArrays& triangles, std::size_t count);
+
+    static void projectPointsOnPlane(
+            const gp_Vec& n,
+            const double* xyzIn, double* xyzOut, std::size_t count);
+    static void projectPointsOnPlane(
+            const gp_Vec& n,
+            const double* xIn, const double* yIn, const double* zIn,
+            double* xOut, double* yOut, double* zOut,
+            std::size_t count);
 
     static Standard_Real euclideanNorm(const gp_Vec& vec);
     static Standard_Real squaredEuclideanNorm(const gp_Vec& vec);
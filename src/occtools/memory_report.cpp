@@ -0,0 +1,476 @@
+/****************************************************************************
+**  FougTools
+**  Copyright Fougue (30 Mar. 2015)
+**  contact@fougue.pro
+**
+** This software is a computer program whose purpose is to provide utility
+** tools for the C++ language and the Qt toolkit.
+**
+** This software is governed by the CeCILL-C license under French law and
+** abiding by the rules of distribution of free software.  You can  use,
+** modify and/ or redistribute the software under the terms of the CeCILL-C
+** license as circulated by CEA, CNRS and INRIA at the following URL
+** "http://www.cecill.info".
+****************************************************************************/
+
+#include "memory_report.h"
+
+#include "brep_point_on_faces_projection.h"
+#include "point_on_faces_projector.h"
+
+#include <BRep_CurveRepresentation.hxx>
+#include <BRep_ListIteratorOfListOfCurveRepresentation.hxx>
+#include <BRep_TEdge.hxx>
+#include <BRep_TFace.hxx>
+#include <Geom2d_BSplineCurve.hxx>
+#include <Geom2d_BezierCurve.hxx>
+#include <Geom2d_OffsetCurve.hxx>
+#include <Geom2d_TrimmedCurve.hxx>
+#include <Geom_BSplineCurve.hxx>
+#include <Geom_BSplineSurface.hxx>
+#include <Geom_BezierCurve.hxx>
+#include <Geom_BezierSurface.hxx>
+#include <Geom_OffsetCurve.hxx>
+#include <Geom_OffsetSurface.hxx>
+#include <Geom_RectangularTrimmedSurface.hxx>
+#include <Geom_SweptSurface.hxx>
+#include <Geom_TrimmedCurve.hxx>
+#include <Poly_Polygon2D.hxx>
+#include <Poly_Polygon3D.hxx>
+#include <Poly_PolygonOnTriangulation.hxx>
+#include <Poly_Triangulation.hxx>
+#include <Standard_Type.hxx>
+#include <Standard_Version.hxx>
+#include <TopExp.hxx>
+#include <TopTools_IndexedMapOfShape.hxx>
+#include <TopoDS_Iterator.hxx>
+
+#include <iomanip>
+#include <sstream>
+#include <unordered_set>
+
+namespace occ {
+
+namespace internal {
+
+//! Size of the dynamic type of \p object, not including data it points to
+static std::size_t transientBytes(const Handle_Standard_Transient& object)
+{
+    return static_cast<std::size_t>(object->DynamicType()->Size());
+}
+
+//! Bytes of the poles, weights and knots arrays of a B-spline or Bezier curve
+template<typename PNT, typename CURVE>
+static std::size_t polesBytes(const CURVE& curve)
+{
+    const std::size_t weightBytes = curve->IsRational() ? sizeof(double) : 0;
+    return curve->NbPoles() * (sizeof(PNT) + weightBytes);
+}
+
+template<typename PNT, typename CURVE>
+static std::size_t bsplineCurveBytes(const CURVE& curve)
+{
+    return internal::polesBytes<PNT>(curve)
+            + curve->NbKnots() * (sizeof(double) + sizeof(int));
+}
+
+} // namespace internal
+
+class MemoryReport::Private
+{
+public:
+    bool isFirstVisit(const Handle_Standard_Transient& object);
+
+    void addTShape(const TopoDS_Shape& shape);
+    void addEdgeRepresentations(const Handle_BRep_TEdge& edge);
+    void addSurface(const Handle_Geom_Surface& surface);
+    void addCurve(const Handle_Geom_Curve& curve);
+    void addPCurve(const Handle_Geom2d_Curve& curve);
+    void addTriangulation(const Handle_Poly_Triangulation& triangulation);
+    void addPolygon3D(const Handle_Poly_Polygon3D& polygon);
+    void addPolygon2D(const Handle_Poly_Polygon2D& polygon);
+    void addPolygonOnTriangulation(const Handle_Poly_PolygonOnTriangulation& polygon);
+
+    MemoryReport::Item m_items[MemoryReport::CategoryCount];
+    std::unordered_set<const Standard_Transient*> m_visited;
+};
+
+//! Returns true if \p object is not null and was not counted yet
+bool MemoryReport::Private::isFirstVisit(const Handle_Standard_Transient& object)
+{
+    return !object.IsNull() && m_visited.insert(object.operator->()).second;
+}
+
+void MemoryReport::Private::addTShape(const TopoDS_Shape& shape)
+{
+    const Handle_TopoDS_TShape& tshape = shape.TShape();
+    if (!this->isFirstVisit(tshape))
+        return;
+
+    // TShape object, plus one node of TopoDS_ListOfShape per child
+    std::size_t childCount = 0;
+    for (TopoDS_Iterator it(shape, Standard_False, Standard_False); it.More(); it.Next())
+        ++childCount;
+    MemoryReport::Item& topo = m_items[MemoryReport::TopologyCategory];
+    topo.bytes +=
+            internal::transientBytes(tshape)
+            + childCount * (sizeof(TopoDS_Shape) + sizeof(void*));
+    ++topo.count;
+
+    if (shape.ShapeType() == TopAbs_FACE) {
+        const Handle_BRep_TFace face = Handle_BRep_TFace::DownCast(tshape);
+        if (!face.IsNull()) {
+            this->addSurface(face->Surface());
+            this->addTriangulation(face->Triangulation());
+        }
+    }
+    else if (shape.ShapeType() == TopAbs_EDGE) {
+        const Handle_BRep_TEdge edge = Handle_BRep_TEdge::DownCast(tshape);
+        if (!edge.IsNull())
+            this->addEdgeRepresentations(edge);
+    }
+}
+
+void MemoryReport::Private::addEdgeRepresentations(const Handle_BRep_TEdge& edge)
+{
+    MemoryReport::Item& topo = m_items[MemoryReport::TopologyCategory];
+    BRep_ListIteratorOfListOfCurveRepresentation it(edge->Curves());
+    for (; it.More(); it.Next()) {
+        const Handle_BRep_CurveRepresentation& rep = it.Value();
+        topo.bytes += internal::transientBytes(rep) + 2 * sizeof(void*);
+        if (rep->IsCurve3D()) {
+            this->addCurve(rep->Curve3D());
+        }
+        else if (rep->IsCurveOnSurface()) {
+            this->addPCurve(rep->PCurve());
+            if (rep->IsCurveOnClosedSurface())
+                this->addPCurve(rep->PCurve2());
+        }
+        else if (rep->IsPolygon3D()) {
+            this->addPolygon3D(rep->Polygon3D());
+        }
+        else if (rep->IsPolygonOnTriangulation()) {
+            this->addPolygonOnTriangulation(rep->PolygonOnTriangulation());
+            if (rep->IsPolygonOnClosedTriangulation())
+                this->addPolygonOnTriangulation(rep->PolygonOnTriangulation2());
+        }
+        else if (rep->IsPolygonOnSurface()) {
+            this->addPolygon2D(rep->Polygon());
+            if (rep->IsPolygonOnClosedSurface())
+                this->addPolygon2D(rep->Polygon2());
+        }
+    }
+}
+
+void MemoryReport::Private::addSurface(const Handle_Geom_Surface& surface)
+{
+    if (!this->isFirstVisit(surface))
+        return;
+
+    std::size_t bytes = internal::transientBytes(surface);
+    const Handle_Geom_BSplineSurface bspline =
+            Handle_Geom_BSplineSurface::DownCast(surface);
+    const Handle_Geom_BezierSurface bezier =
+            Handle_Geom_BezierSurface::DownCast(surface);
+    if (!bspline.IsNull()) {
+        const bool isRational =
+                bspline->IsURational() == Standard_True
+                || bspline->IsVRational() == Standard_True;
+        const std::size_t weightBytes = isRational ? sizeof(double) : 0;
+        bytes +=
+                bspline->NbUPoles() * bspline->NbVPoles() * (sizeof(gp_Pnt) + weightBytes)
+                + (bspline->NbUKnots() + bspline->NbVKnots()) * (sizeof(double) + sizeof(int));
+    }
+    else if (!bezier.IsNull()) {
+        const bool isRational =
+                bezier->IsURational() == Standard_True
+                || bezier->IsVRational() == Standard_True;
+        const std::size_t weightBytes = isRational ? sizeof(double) : 0;
+        bytes += bezier->NbUPoles() * bezier->NbVPoles() * (sizeof(gp_Pnt) + weightBytes);
+    }
+    else if (surface->IsKind(STANDARD_TYPE(Geom_RectangularTrimmedSurface))) {
+        this->addSurface(
+                    Handle_Geom_RectangularTrimmedSurface::DownCast(surface)->BasisSurface());
+    }
+    else if (surface->IsKind(STANDARD_TYPE(Geom_OffsetSurface))) {
+        this->addSurface(Handle_Geom_OffsetSurface::DownCast(surface)->BasisSurface());
+    }
+    else if (surface->IsKind(STANDARD_TYPE(Geom_SweptSurface))) {
+        this->addCurve(Handle_Geom_SweptSurface::DownCast(surface)->BasisCurve());
+    }
+
+    MemoryReport::Item& item = m_items[MemoryReport::SurfaceCategory];
+    item.bytes += bytes;
+    ++item.count;
+}
+
+void MemoryReport::Private::addCurve(const Handle_Geom_Curve& curve)
+{
+    if (!this->isFirstVisit(curve))
+        return;
+
+    std::size_t bytes = internal::transientBytes(curve);
+    if (curve->IsKind(STANDARD_TYPE(Geom_BSplineCurve))) {
+        bytes += internal::bsplineCurveBytes<gp_Pnt>(
+                    Handle_Geom_BSplineCurve::DownCast(curve));
+    }
+    else if (curve->IsKind(STANDARD_TYPE(Geom_BezierCurve))) {
+        bytes += internal::polesBytes<gp_Pnt>(
+                    Handle_Geom_BezierCurve::DownCast(curve));
+    }
+    else if (curve->IsKind(STANDARD_TYPE(Geom_TrimmedCurve))) {
+        this->addCurve(Handle_Geom_TrimmedCurve::DownCast(curve)->BasisCurve());
+    }
+    else if (curve->IsKind(STANDARD_TYPE(Geom_OffsetCurve))) {
+        this->addCurve(Handle_Geom_OffsetCurve::DownCast(curve)->BasisCurve());
+    }
+
+    MemoryReport::Item& item = m_items[MemoryReport::CurveCategory];
+    item.bytes += bytes;
+    ++item.count;
+}
+
+void MemoryReport::Private::addPCurve(const Handle_Geom2d_Curve& curve)
+{
+    if (!this->isFirstVisit(curve))
+        return;
+
+    std::size_t bytes = internal::transientBytes(curve);
+    if (curve->IsKind(STANDARD_TYPE(Geom2d_BSplineCurve))) {
+        bytes += internal::bsplineCurveBytes<gp_Pnt2d>(
+                    Handle_Geom2d_BSplineCurve::DownCast(curve));
+    }
+    else if (curve->IsKind(STANDARD_TYPE(Geom2d_BezierCurve))) {
+        bytes += internal::polesBytes<gp_Pnt2d>(
+                    Handle_Geom2d_BezierCurve::DownCast(curve));
+    }
+    else if (curve->IsKind(STANDARD_TYPE(Geom2d_TrimmedCurve))) {
+        this->addPCurve(Handle_Geom2d_TrimmedCurve::DownCast(curve)->BasisCurve());
+    }
+    else if (curve->IsKind(STANDARD_TYPE(Geom2d_OffsetCurve))) {
+        this->addPCurve(Handle_Geom2d_OffsetCurve::DownCast(curve)->BasisCurve());
+    }
+
+    MemoryReport::Item& item = m_items[MemoryReport::PCurveCategory];
+    item.bytes += bytes;
+    ++item.count;
+}
+
+void MemoryReport::Private::addTriangulation(
+        const Handle_Poly_Triangulation& triangulation)
+{
+    if (!this->isFirstVisit(triangulation))
+        return;
+
+    const std::size_t nodeCount = triangulation->NbNodes();
+    std::size_t bytes =
+            internal::transientBytes(triangulation)
+            + nodeCount * sizeof(gp_Pnt)
+            + triangulation->NbTriangles() * sizeof(Poly_Triangle);
+    if (triangulation->HasUVNodes() == Standard_True)
+        bytes += nodeCount * sizeof(gp_Pnt2d);
+#if OCC_VERSION_HEX >= 0x060700
+    if (triangulation->HasNormals() == Standard_True)
+        bytes += 3 * nodeCount * sizeof(Standard_ShortReal);
+#endif
+
+    MemoryReport::Item& item = m_items[MemoryReport::TriangulationCategory];
+    item.bytes += bytes;
+    ++item.count;
+}
+
+void MemoryReport::Private::addPolygon3D(const Handle_Poly_Polygon3D& polygon)
+{
+    if (!this->isFirstVisit(polygon))
+        return;
+
+    const std::size_t nodeCount = polygon->NbNodes();
+    std::size_t bytes = internal::transientBytes(polygon) + nodeCount * sizeof(gp_Pnt);
+    if (polygon->HasParameters() == Standard_True)
+        bytes += nodeCount * sizeof(double);
+
+    MemoryReport::Item& item = m_items[MemoryReport::PolygonCategory];
+    item.bytes += bytes;
+    ++item.count;
+}
+
+void MemoryReport::Private::addPolygon2D(const Handle_Poly_Polygon2D& polygon)
+{
+    if (!this->isFirstVisit(polygon))
+        return;
+
+    MemoryReport::Item& item = m_items[MemoryReport::PolygonCategory];
+    item.bytes +=
+            internal::transientBytes(polygon) + polygon->NbNodes() * sizeof(gp_Pnt2d);
+    ++item.count;
+}
+
+void MemoryReport::Private::addPolygonOnTriangulation(
+        const Handle_Poly_PolygonOnTriangulation& polygon)
+{
+    if (!this->isFirstVisit(polygon))
+        return;
+
+    const std::size_t nodeCount = polygon->NbNodes();
+    std::size_t bytes = internal::transientBytes(polygon) + nodeCount * sizeof(int);
+    if (polygon->HasParameters() == Standard_True)
+        bytes += nodeCount * sizeof(double);
+
+    MemoryReport::Item& item = m_items[MemoryReport::PolygonCategory];
+    item.bytes += bytes;
+    ++item.count;
+}
+
+/*!
+ * \class MemoryReport
+ * \brief Accounts the memory consumed by shapes and projection indices,
+ *        by category
+ *
+ * Objects shared by several shapes (TShapes, geometries, triangulations, ...)
+ * are counted once, even across calls to addShape(). Sizes are computed from
+ * the counts of items in the OpenCascade arrays, allocator overhead is not
+ * included so the report is a lower bound of the actual heap usage.
+ *
+ * \code
+ *   occ::MemoryReport report;
+ *   report.addShape(shape);
+ *   report.addProjector(projector);
+ *   std::cout << report.toText();
+ * \endcode
+ *
+ * \headerfile memory_report.h <occtools/memory_report.h>
+ * \ingroup occtools
+ */
+
+MemoryReport::Item::Item()
+    : bytes(0),
+      count(0)
+{
+}
+
+MemoryReport::MemoryReport()
+    : d(new Private)
+{
+}
+
+MemoryReport::~MemoryReport()
+{
+    delete d;
+}
+
+/*! Adds the topology, geometry and meshes of \p shape and all its sub-shapes
+ *
+ *  Meshes are the triangulations of faces and the polygons of edges
+ */
+void MemoryReport::addShape(const TopoDS_Shape& shape)
+{
+    if (shape.IsNull())
+        return;
+
+    TopTools_IndexedMapOfShape mapShape;
+    TopExp::MapShapes(shape, mapShape);
+    for (int i = 1; i <= mapShape.Extent(); ++i)
+        d->addTShape(mapShape.FindKey(i));
+}
+
+/*! Adds the spatial index and the per-face data of \p projector
+ *
+ *  The index viewed in the blob passed to PointOnFacesProjector::loadIndex()
+ *  goes to MappedIndexCategory
+ */
+void MemoryReport::addProjector(const PointOnFacesProjector& projector)
+{
+    const PointOnFacesProjector::MemoryUsage usage = projector.memoryUsage();
+    this->add(ProjectorIndexCategory, usage.indexBytes);
+    this->add(ProjectorDataCategory, usage.faceBytes + usage.normalBytes);
+    if (usage.externalIndexBytes > 0)
+        this->add(MappedIndexCategory, usage.externalIndexBytes);
+}
+
+//! Adds the face data and the (estimated) surface projectors of \p projection
+void MemoryReport::addProjection(const BRepPointOnFacesProjection& projection)
+{
+    const BRepPointOnFacesProjection::MemoryUsage usage = projection.memoryUsage();
+    this->add(ProjectorDataCategory, usage.faceBytes);
+    this->add(SurfaceProjectorCategory, usage.projectorBytes, usage.projectorCount);
+}
+
+//! Adds \p count objects consuming \p bytes to \p category
+void MemoryReport::add(Category category, std::size_t bytes, std::size_t count)
+{
+    Item& item = d->m_items[category];
+    item.bytes += bytes;
+    item.count += count;
+}
+
+void MemoryReport::clear()
+{
+    for (Item& item : d->m_items)
+        item = Item();
+    d->m_visited.clear();
+}
+
+const MemoryReport::Item& MemoryReport::item(Category category) const
+{
+    return d->m_items[category];
+}
+
+std::size_t MemoryReport::bytes(Category category) const
+{
+    return d->m_items[category].bytes;
+}
+
+/*! Returns the sum of bytes of all categories, except MappedIndexCategory
+ *
+ *  Mapped index memory is owned by the caller of
+ *  PointOnFacesProjector::loadIndex() (typically a memory-mapped file)
+ */
+std::size_t MemoryReport::totalBytes() const
+{
+    std::size_t total = 0;
+    for (int i = 0; i < CategoryCount; ++i) {
+        if (i != MappedIndexCategory)
+            total += d->m_items[i].bytes;
+    }
+    return total;
+}
+
+//! Returns the report as a table, one line per non-empty category
+std::string MemoryReport::toText() const
+{
+    std::ostringstream text;
+    text << std::left << std::setw(20) << "Category"
+         << std::right << std::setw(14) << "Bytes"
+         << std::setw(10) << "Count" << '\n';
+    for (int i = 0; i < CategoryCount; ++i) {
+        const Item& item = d->m_items[i];
+        if (item.bytes == 0 && item.count == 0)
+            continue;
+        text << std::left << std::setw(20) << categoryName(static_cast<Category>(i))
+             << std::right << std::setw(14) << item.bytes
+             << std::setw(10) << item.count << '\n';
+    }
+    text << std::left << std::setw(20) << "total"
+         << std::right << std::setw(14) << this->totalBytes() << '\n';
+    return text.str();
+}
+
+const char* MemoryReport::categoryName(Category category)
+{
+    switch (category) {
+    case TopologyCategory: return "topology";
+    case SurfaceCategory: return "surfaces";
+    case CurveCategory: return "curves";
+    case PCurveCategory: return "pcurves";
+    case TriangulationCategory: return "triangulations";
+    case PolygonCategory: return "polygons";
+    case ProjectorIndexCategory: return "projector.index";
+    case ProjectorDataCategory: return "projector.data";
+    case SurfaceProjectorCategory: return "projector.surfaces";
+    case MappedIndexCategory: return "mapped.index";
+    case CategoryCount: break;
+    }
+    return "";
+}
+
+} // namespace occ
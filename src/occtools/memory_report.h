@@ -0,0 +1,80 @@
+/****************************************************************************
+**  FougTools
+**  Copyright Fougue (30 Mar. 2015)
+**  contact@fougue.pro
+**
+** This software is a computer program whose purpose is to provide utility
+** tools for the C++ language and the Qt toolkit.
+**
+** This software is governed by the CeCILL-C license under French law and
+** abiding by the rules of distribution of free software.  You can  use,
+** modify and/ or redistribute the software under the terms of the CeCILL-C
+** license as circulated by CEA, CNRS and INRIA at the following URL
+** "http://www.cecill.info".
+****************************************************************************/
+
+#pragma once
+
+#include "occtools.h"
+
+#include <TopoDS_Shape.hxx>
+
+#include <cstddef>
+#include <string>
+
+namespace occ {
+
+class BRepPointOnFacesProjection;
+class PointOnFacesProjector;
+
+class OCCTOOLS_EXPORT MemoryReport
+{
+public:
+    enum Category
+    {
+        TopologyCategory,
+        SurfaceCategory,
+        CurveCategory,
+        PCurveCategory,
+        TriangulationCategory,
+        PolygonCategory,
+        ProjectorIndexCategory,
+        ProjectorDataCategory,
+        SurfaceProjectorCategory,
+        MappedIndexCategory,
+        CategoryCount
+    };
+
+    struct OCCTOOLS_EXPORT Item
+    {
+        Item();
+        std::size_t bytes;
+        std::size_t count;
+    };
+
+    MemoryReport();
+    ~MemoryReport();
+
+    void addShape(const TopoDS_Shape& shape);
+    void addProjector(const PointOnFacesProjector& projector);
+    void addProjection(const BRepPointOnFacesProjection& projection);
+    void add(Category category, std::size_t bytes, std::size_t count = 1);
+    void clear();
+
+    const Item& item(Category category) const;
+    std::size_t bytes(Category category) const;
+    std::size_t totalBytes() const;
+
+    std::string toText() const;
+
+    static const char* categoryName(Category category);
+
+private:
+    MemoryReport(const MemoryReport&);
+    MemoryReport& operator=(const MemoryReport&);
+
+    class Private;
+    Private* const d;
+};
+
+} // namespace occ
@@ -0,0 +1,387 @@
+/****************************************************************************
+**  FougTools
+**  Copyright Fougue (30 Mar. 2015)
+**  contact@fougue.pro
+**
+** This software is a computer program whose purpose is to provide utility
+** tools for the C++ language and the Qt toolkit.
+**
+** This software is governed by the CeCILL-C license under French law and
+** abiding by the rules of distribution of free software.  You can  use,
+** modify and/ or redistribute the software under the terms of the CeCILL-C
+** license as circulated by CEA, CNRS and INRIA at the following URL
+** "http://www.cecill.info".
+****************************************************************************/
+
+
+#include "mesh_deviation_analysis.h"
+
+#include "point_on_faces_projector.h"
+#include "../cpptools/parallel_utils.h"
+#include "../cpptools/profiling.h"
+
+#include <Poly_Triangulation.hxx>
+#include <StlMesh_Mesh.hxx>
+#include <TColgp_SequenceOfXYZ.hxx>
+#include <gp_Vec.hxx>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <mutex>
+
+namespace occ {
+
+/*! \class MeshDeviationAnalysis
+ *  \brief Measures the deviation of mesh vertices (ex: a scan loaded with
+ *         IO::loadStlFile()) from the faces of a PointOnFacesProjector
+ *
+ *  Each vertex is projected on the faces, its signed distance is the distance
+ *  to its projection, positive when the vertex lies on the side the face
+ *  normal points to (outside of a solid), negative otherwise.
+ *
+ *  Statistics (min/max, mean, RMS and histogram of signed distances) are
+ *  accumulated while projecting, in one pass : projection results are
+ *  not stored and each thread accumulates its own partial statistics, merged
+ *  once its range of vertices is done. Vertices that are not contiguous in
+ *  memory (StlMesh_Mesh) are streamed through a buffer of chunkSize() points,
+ *  so memory used does not depend on the size of the mesh.
+ *
+ *  The PointOnFacesProjector must be prepared before calling analyze(), and
+ *  must outlive the MeshDeviationAnalysis object.
+ *
+ *  \headerfile mesh_deviation_analysis.h <occtools/mesh_deviation_analysis.h>
+ *  \ingroup occtools
+ */
+
+/*! \struct MeshDeviationAnalysis::Histogram
+ *  \brief Counts of signed distances in [lowerBound, upperBound], divided in
+ *         binCounts.size() bins of equal width
+ *
+ *  Distances outside the range are counted in underflowCount and
+ *  overflowCount
+ */
+
+/*! \struct MeshDeviationAnalysis::Stats
+ *  \brief Statistics of the signed distances of the vertices projected with
+ *         success
+ *
+ *  Vertices that could not be projected (projectedCount < vertexCount) are
+ *  excluded from the statistics
+ */
+
+//! Partial statistics, accumulated by one thread
+class MeshDeviationAnalysis::Accumulator
+{
+public:
+    explicit Accumulator(const MeshDeviationAnalysis* analysis)
+        : vertexCount(0),
+          projectedCount(0),
+          minSignedDistance(std::numeric_limits<double>::max()),
+          maxSignedDistance(-std::numeric_limits<double>::max()),
+          sumSignedDistances(0.),
+          sumSquaredDistances(0.),
+          binCounts(analysis->m_histogramBinCount, 0),
+          underflowCount(0),
+          overflowCount(0),
+          m_histogramLowerBound(analysis->m_histogramLowerBound),
+          m_histogramUpperBound(analysis->m_histogramUpperBound),
+          m_invBinWidth(
+              analysis->m_histogramBinCount
+              / (analysis->m_histogramUpperBound - analysis->m_histogramLowerBound))
+    { }
+
+    void add(double signedDistance)
+    {
+        ++this->projectedCount;
+        this->minSignedDistance = std::min(this->minSignedDistance, signedDistance);
+        this->maxSignedDistance = std::max(this->maxSignedDistance, signedDistance);
+        this->sumSignedDistances += signedDistance;
+        this->sumSquaredDistances += signedDistance * signedDistance;
+        if (signedDistance < m_histogramLowerBound) {
+            ++this->underflowCount;
+        }
+        else if (signedDistance > m_histogramUpperBound) {
+            ++this->overflowCount;
+        }
+        else {
+            // Upper bound falls in the last bin
+            const std::size_t binId = static_cast<std::size_t>(
+                        (signedDistance - m_histogramLowerBound) * m_invBinWidth);
+            ++this->binCounts[std::min(binId, this->binCounts.size() - 1)];
+        }
+    }
+
+    void merge(const Accumulator& other)
+    {
+        this->vertexCount += other.vertexCount;
+        this->projectedCount += other.projectedCount;
+        this->minSignedDistance =
+                std::min(this->minSignedDistance, other.minSignedDistance);
+        this->maxSignedDistance =
+                std::max(this->maxSignedDistance, other.maxSignedDistance);
+        this->sumSignedDistances += other.sumSignedDistances;
+        this->sumSquaredDistances += other.sumSquaredDistances;
+        for (std::size_t i = 0; i < this->binCounts.size(); ++i)
+            this->binCounts[i] += other.binCounts[i];
+        this->underflowCount += other.underflowCount;
+        this->overflowCount += other.overflowCount;
+    }
+
+    std::size_t vertexCount;
+    std::size_t projectedCount;
+    double minSignedDistance;
+    double maxSignedDistance;
+    double sumSignedDistances;
+    double sumSquaredDistances;
+    std::vector<std::size_t> binCounts;
+    std::size_t underflowCount;
+    std::size_t overflowCount;
+
+private:
+    double m_histogramLowerBound;
+    double m_histogramUpperBound;
+    double m_invBinWidth;
+};
+
+MeshDeviationAnalysis::Histogram::Histogram()
+    : lowerBound(0.),
+      upperBound(0.),
+      underflowCount(0),
+      overflowCount(0)
+{
+}
+
+double MeshDeviationAnalysis::Histogram::binWidth() const
+{
+    return !this->binCounts.empty() ?
+                (this->upperBound - this->lowerBound) / this->binCounts.size() :
+                0.;
+}
+
+double MeshDeviationAnalysis::Histogram::binLowerBound(std::size_t binId) const
+{
+    return this->lowerBound + binId * this->binWidth();
+}
+
+MeshDeviationAnalysis::Stats::Stats()
+    : vertexCount(0),
+      projectedCount(0),
+      minSignedDistance(0.),
+      maxSignedDistance(0.),
+      maxAbsDistance(0.),
+      meanSignedDistance(0.),
+      rmsDistance(0.)
+{
+}
+
+/*! Constructs the analysis of deviations from the faces of \p projector
+ *
+ *  Histogram range defaults to [-1, 1] divided in 100 bins
+ */
+MeshDeviationAnalysis::MeshDeviationAnalysis(const PointOnFacesProjector* projector)
+    : m_projector(projector),
+      m_histogramLowerBound(-1.),
+      m_histogramUpperBound(1.),
+      m_histogramBinCount(100),
+      m_chunkSize(64 * 1024),
+      m_threadCount(0)
+{
+}
+
+/*! Sets the range of the histogram of signed distances
+ *
+ *  Does nothing if \p lowerBound is not less than \p upperBound or if
+ *  \p binCount is 0
+ */
+void MeshDeviationAnalysis::setHistogramRange(
+        double lowerBound, double upperBound, unsigned binCount)
+{
+    if (lowerBound < upperBound && binCount > 0) {
+        m_histogramLowerBound = lowerBound;
+        m_histogramUpperBound = upperBound;
+        m_histogramBinCount = binCount;
+    }
+}
+
+double MeshDeviationAnalysis::histogramLowerBound() const
+{
+    return m_histogramLowerBound;
+}
+
+double MeshDeviationAnalysis::histogramUpperBound() const
+{
+    return m_histogramUpperBound;
+}
+
+unsigned MeshDeviationAnalysis::histogramBinCount() const
+{
+    return m_histogramBinCount;
+}
+
+//! Count of vertices buffered when they are streamed, defaults to 65536
+std::size_t MeshDeviationAnalysis::chunkSize() const
+{
+    return m_chunkSize;
+}
+
+void MeshDeviationAnalysis::setChunkSize(std::size_t size)
+{
+    m_chunkSize = std::max(size, static_cast<std::size_t>(1));
+}
+
+//! Maximum count of threads to use, 0 (the default) means as many as the
+//! hardware supports
+unsigned MeshDeviationAnalysis::threadCount() const
+{
+    return m_threadCount;
+}
+
+void MeshDeviationAnalysis::setThreadCount(unsigned count)
+{
+    m_threadCount = count;
+}
+
+/*! Analyzes the deviation of the array of \p count points in \p points
+ *
+ *  \param signedDistances  Optional output array of at least \p count items,
+ *                          \p signedDistances[i] receives the signed distance
+ *                          of \p points[i] (NaN if it could not be projected)
+ */
+MeshDeviationAnalysis::Stats MeshDeviationAnalysis::analyze(
+        const gp_Pnt* points, std::size_t count, double* signedDistances) const
+{
+    CPPTOOLS_PROFILE_ZONE("occ::MeshDeviationAnalysis::analyze");
+    Accumulator accumulator(this);
+    this->analyzeChunk(points, count, signedDistances, &accumulator);
+    return this->stats(accumulator);
+}
+
+/*! Analyzes the deviation of the nodes of \p mesh
+ *
+ *  The location of \p mesh is not applied (nodes are taken as is). Nodes are
+ *  read in place, they are not copied.
+ *
+ *  \param signedDistances  Optional output array of at least
+ *                          \p mesh->NbNodes() items
+ */
+MeshDeviationAnalysis::Stats MeshDeviationAnalysis::analyze(
+        const Handle_Poly_Triangulation& mesh, double* signedDistances) const
+{
+    if (mesh.IsNull() || mesh->NbNodes() == 0)
+        return this->stats(Accumulator(this));
+    const TColgp_Array1OfPnt& nodes = mesh->Nodes();
+    return this->analyze(
+                &nodes(nodes.Lower()),
+                static_cast<std::size_t>(nodes.Length()),
+                signedDistances);
+}
+
+/*! Analyzes the deviation of the vertices of all domains of \p mesh
+ *
+ *  Vertices are streamed by chunks of chunkSize() points.
+ *
+ *  \param signedDistances  Optional output array of at least
+ *                          vertexCount(\p mesh) items, vertices are numbered
+ *                          domain after domain
+ */
+MeshDeviationAnalysis::Stats MeshDeviationAnalysis::analyze(
+        const Handle_StlMesh_Mesh& mesh, double* signedDistances) const
+{
+    CPPTOOLS_PROFILE_ZONE("occ::MeshDeviationAnalysis::analyze");
+    Accumulator accumulator(this);
+    if (mesh.IsNull())
+        return this->stats(accumulator);
+
+    std::vector<gp_Pnt> chunk;
+    chunk.reserve(std::min(m_chunkSize, MeshDeviationAnalysis::vertexCount(mesh)));
+    std::size_t chunkOffset = 0;
+    auto fnFlushChunk = [&] {
+        double* chunkDistances =
+                signedDistances != nullptr ? signedDistances + chunkOffset : nullptr;
+        this->analyzeChunk(chunk.data(), chunk.size(), chunkDistances, &accumulator);
+        chunkOffset += chunk.size();
+        chunk.clear();
+    };
+    for (int iDomain = 1; iDomain <= mesh->NbDomains(); ++iDomain) {
+        const TColgp_SequenceOfXYZ& vertices = mesh->Vertices(iDomain);
+        for (int iVertex = 1; iVertex <= vertices.Length(); ++iVertex) {
+            chunk.emplace_back(vertices.Value(iVertex));
+            if (chunk.size() == m_chunkSize)
+                fnFlushChunk();
+        }
+    }
+    if (!chunk.empty())
+        fnFlushChunk();
+    return this->stats(accumulator);
+}
+
+//! Count of vertices in all the domains of \p mesh
+std::size_t MeshDeviationAnalysis::vertexCount(const Handle_StlMesh_Mesh& mesh)
+{
+    std::size_t count = 0;
+    if (!mesh.IsNull()) {
+        for (int iDomain = 1; iDomain <= mesh->NbDomains(); ++iDomain)
+            count += mesh->Vertices(iDomain).Length();
+    }
+    return count;
+}
+
+void MeshDeviationAnalysis::analyzeChunk(
+        const gp_Pnt* points,
+        std::size_t count,
+        double* signedDistances,
+        Accumulator* accumulator) const
+{
+    // There is little to gain from a thread below this count of points
+    const std::size_t minRangeSize = 256;
+    std::mutex mutexAccumulator;
+    auto fnAnalyzeRange = [&] (std::size_t iBegin, std::size_t iEnd) {
+        Accumulator rangeAccumulator(this);
+        rangeAccumulator.vertexCount = iEnd - iBegin;
+        for (std::size_t i = iBegin; i < iEnd; ++i) {
+            const gp_Pnt& point = points[i];
+            const PointOnFacesProjector::Result result =
+                    m_projector->projected(point);
+            double signedDistance = std::numeric_limits<double>::quiet_NaN();
+            if (result.isValid) {
+                const gp_Vec vec(result.point, point);
+                signedDistance = vec.Magnitude();
+                if (vec.Dot(result.normal) < 0.)
+                    signedDistance = -signedDistance;
+                rangeAccumulator.add(signedDistance);
+            }
+            if (signedDistances != nullptr)
+                signedDistances[i] = signedDistance;
+        }
+        std::lock_guard<std::mutex> lock(mutexAccumulator);
+        accumulator->merge(rangeAccumulator);
+    };
+    cpp::parallelForRanges(count, fnAnalyzeRange, m_threadCount, minRangeSize);
+}
+
+MeshDeviationAnalysis::Stats MeshDeviationAnalysis::stats(
+        const Accumulator& accumulator) const
+{
+    Stats stats;
+    stats.vertexCount = accumulator.vertexCount;
+    stats.projectedCount = accumulator.projectedCount;
+    if (accumulator.projectedCount > 0) {
+        const double count = static_cast<double>(accumulator.projectedCount);
+        stats.minSignedDistance = accumulator.minSignedDistance;
+        stats.maxSignedDistance = accumulator.maxSignedDistance;
+        stats.maxAbsDistance = std::max(
+                    std::abs(accumulator.minSignedDistance),
+                    std::abs(accumulator.maxSignedDistance));
+        stats.meanSignedDistance = accumulator.sumSignedDistances / count;
+        stats.rmsDistance = std::sqrt(accumulator.sumSquaredDistances / count);
+    }
+    stats.histogram.lowerBound = m_histogramLowerBound;
+    stats.histogram.upperBound = m_histogramUpperBound;
+    stats.histogram.binCounts = accumulator.binCounts;
+    stats.histogram.underflowCount = accumulator.underflowCount;
+    stats.histogram.overflowCount = accumulator.overflowCount;
+    return stats;
+}
+
+} // namespace occ
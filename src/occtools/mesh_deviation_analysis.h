@@ -0,0 +1,105 @@
+/****************************************************************************
+**  FougTools
+**  Copyright Fougue (30 Mar. 2015)
+**  contact@fougue.pro
+**
+** This software is a computer program whose purpose is to provide utility
+** tools for the C++ language and the Qt toolkit.
+**
+** This software is governed by the CeCILL-C license under French law and
+** abiding by the rules of distribution of free software.  You can  use,
+** modify and/ or redistribute the software under the terms of the CeCILL-C
+** license as circulated by CEA, CNRS and INRIA at the following URL
+** "http://www.cecill.info".
+****************************************************************************/
+
+
+#pragma once
+
+#include "occtools.h"
+
+#include <Handle_Poly_Triangulation.hxx>
+#include <Handle_StlMesh_Mesh.hxx>
+#include <gp_Pnt.hxx>
+
+#include <cstddef>
+#include <vector>
+
+namespace occ {
+
+class PointOnFacesProjector;
+
+class OCCTOOLS_EXPORT MeshDeviationAnalysis
+{
+public:
+    struct OCCTOOLS_EXPORT Histogram
+    {
+        Histogram();
+        double lowerBound;
+        double upperBound;
+        std::vector<std::size_t> binCounts;
+        std::size_t underflowCount;
+        std::size_t overflowCount;
+
+        double binWidth() const;
+        double binLowerBound(std::size_t binId) const;
+    };
+
+    struct OCCTOOLS_EXPORT Stats
+    {
+        Stats();
+        std::size_t vertexCount;
+        std::size_t projectedCount;
+        double minSignedDistance;
+        double maxSignedDistance;
+        double maxAbsDistance;
+        double meanSignedDistance;
+        double rmsDistance;
+        Histogram histogram;
+    };
+
+    explicit MeshDeviationAnalysis(const PointOnFacesProjector* projector);
+
+    void setHistogramRange(double lowerBound, double upperBound, unsigned binCount);
+    double histogramLowerBound() const;
+    double histogramUpperBound() const;
+    unsigned histogramBinCount() const;
+
+    std::size_t chunkSize() const;
+    void setChunkSize(std::size_t size);
+
+    unsigned threadCount() const;
+    void setThreadCount(unsigned count);
+
+    Stats analyze(
+            const gp_Pnt* points,
+            std::size_t count,
+            double* signedDistances = nullptr) const;
+    Stats analyze(
+            const Handle_Poly_Triangulation& mesh,
+            double* signedDistances = nullptr) const;
+    Stats analyze(
+            const Handle_StlMesh_Mesh& mesh,
+            double* signedDistances = nullptr) const;
+
+    static std::size_t vertexCount(const Handle_StlMesh_Mesh& mesh);
+
+private:
+    class Accumulator;
+
+    void analyzeChunk(
+            const gp_Pnt* points,
+            std::size_t count,
+            double* signedDistances,
+            Accumulator* accumulator) const;
+    Stats stats(const Accumulator& accumulator) const;
+
+    const PointOnFacesProjector* m_projector;
+    double m_histogramLowerBound;
+    double m_histogramUpperBound;
+    unsigned m_histogramBinCount;
+    std::size_t m_chunkSize;
+    unsigned m_threadCount;
+};
+
+} // namespace occ
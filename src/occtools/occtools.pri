@@ -22,14 +22,23 @@ HEADERS += \
     $$PWD/handle_ais_text.h \
     $$PWD/brep_point_on_faces_projection.h \
     $$PWD/gcpnts_uniform_abscissa_const_iterator.h \
+    $$PWD/gcpnts_uniform_abscissa_sampler.h \
+    $$PWD/id_buffer_picker.h \
     $$PWD/point_on_faces_projector.h \
+    $$PWD/poly_triangulation_normals.h \
     $$PWD/qt_view.h \
     $$PWD/qt_view_controller.h \
     $$PWD/down_cast.h \
+    $$PWD/ais_scene_bounds.h \
     $$PWD/ais_utils.h \
     $$PWD/geom_utils.h \
     $$PWD/kernel_utils.h \
     $$PWD/math_utils.h \
+    $$PWD/memory_report.h \
+    $$PWD/mesh_deviation_analysis.h \
+    $$PWD/offscreen_renderer.h \
+    $$PWD/shape_properties_cache.h \
+    $$PWD/topods_shape_maps.h \
     $$PWD/topods_utils.h \
     $$PWD/qt_utils.h
 
@@ -38,16 +47,35 @@ SOURCES += \
     $$PWD/ais_text.cpp \
     $$PWD/brep_point_on_faces_projection.cpp \
     $$PWD/gcpnts_uniform_abscissa_const_iterator.cpp \
+    $$PWD/gcpnts_uniform_abscissa_sampler.cpp \
+    $$PWD/id_buffer_picker.cpp \
     $$PWD/point_on_faces_projector.cpp \
+    $$PWD/poly_triangulation_normals.cpp \
     $$PWD/qt_view.cpp \
     $$PWD/qt_view_controller.cpp \
+    $$PWD/ais_scene_bounds.cpp \
     $$PWD/ais_utils.cpp \
     $$PWD/geom_utils.cpp \
     $$PWD/kernel_utils.cpp \
     $$PWD/math_utils.cpp \
+    $$PWD/memory_report.cpp \
+    $$PWD/mesh_deviation_analysis.cpp \
+    $$PWD/offscreen_renderer.cpp \
+    $$PWD/shape_properties_cache.cpp \
+    $$PWD/topods_shape_maps.cpp \
     $$PWD/topods_utils.cpp \
     $$PWD/qt_utils.cpp
 
+# Requires qttools_task
+qttools_task {
+    HEADERS += \
+        $$PWD/async_io.h \
+        $$PWD/progressive_shape_display.h
+    SOURCES += \
+        $$PWD/async_io.cpp \
+        $$PWD/progressive_shape_display.cpp
+}
+
 LIBS += -lTKBRep -lTKernel -lTKG2d -lTKG3d -lTKGeomAlgo -lTKGeomBase \
         -lTKIGES -lTKMath -lTKMesh -lTKOpenGl -lTKPrim -lTKService -lTKShHealing \
         -lTKSTEP -lTKSTEPAttr -lTKSTEPBase -lTKSTEP209 -lTKSTL -lTKTopAlgo \
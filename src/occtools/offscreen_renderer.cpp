@@ -0,0 +1,234 @@
+/****************************************************************************
+**  FougTools
+**  Copyright Fougue (30 Mar. 2015)
+**  contact@fougue.pro
+**
+** This software is a computer program whose purpose is to provide utility
+** tools for the C++ language and the Qt toolkit.
+**
+** This software is governed by the CeCILL-C license under French law and
+** abiding by the rules of distribution of free software.  You can  use,
+** modify and/ or redistribute the software under the terms of the CeCILL-C
+** license as circulated by CEA, CNRS and INRIA at the following URL
+** "http://www.cecill.info".
+****************************************************************************/
+
+#include "offscreen_renderer.h"
+
+#include "ais_utils.h"
+#include "../cpptools/parallel_utils.h"
+
+#include <AIS_InteractiveContext.hxx>
+#include <AIS_Shape.hxx>
+#include <Aspect_Window.hxx>
+#include <Graphic3d_GraphicDriver.hxx>
+#include <Image_PixMap.hxx>
+#include <Standard_Version.hxx>
+#include <V3d_View.hxx>
+#include <V3d_Viewer.hxx>
+
+#if defined(Q_OS_WIN32)
+# include <windows.h>
+# include <WNT_WClass.hxx>
+# include <WNT_Window.hxx>
+#elif defined(Q_OS_MAC) && !defined(MACOSX_USE_GLX)
+# include <Cocoa_Window.hxx>
+#else
+# include <Aspect_DisplayConnection.hxx>
+# include <Xw_Window.hxx>
+#endif
+
+#include <cstring>
+
+namespace occ {
+
+namespace internal {
+
+//! Creates a window that is never shown, required by V3d_View
+static Handle_Aspect_Window createHiddenWindow(
+        const Handle_AIS_InteractiveContext& context, int width, int height)
+{
+    static const char title[] = "occ::OffscreenRenderer";
+#if defined(Q_OS_WIN32)
+    static Handle_WNT_WClass wClass =
+            new WNT_WClass(title, DefWindowProc, CS_VREDRAW | CS_HREDRAW);
+    Handle_WNT_Window window =
+            new WNT_Window(title, wClass, WS_POPUP, 0, 0, width, height);
+#elif defined(Q_OS_MAC) && !defined(MACOSX_USE_GLX)
+    (void)context;
+    Handle_Cocoa_Window window = new Cocoa_Window(title, 0, 0, width, height);
+#else
+    Handle_Aspect_DisplayConnection dispConnection =
+            context->CurrentViewer()->Driver()->GetDisplayConnection();
+    Handle_Xw_Window window =
+            new Xw_Window(dispConnection, title, 0, 0, width, height);
+#endif
+#if OCC_VERSION_HEX >= 0x060800
+    window->SetVirtual(Standard_True);
+#endif
+    return window;
+}
+
+//! Copies the RGB pixels of \p pixmap into a new QImage
+static QImage toQImage(const Image_PixMap& pixmap)
+{
+    const int width = static_cast<int>(pixmap.SizeX());
+    const int height = static_cast<int>(pixmap.SizeY());
+    QImage image(width, height, QImage::Format_RGB888);
+    for (int y = 0; y < height; ++y) {
+        // Image_PixMap::Row(0) is the top row whatever the storage order
+        std::memcpy(image.scanLine(y), pixmap.Row(y), 3 * width);
+    }
+    return image;
+}
+
+} // namespace internal
+
+class OffscreenRenderer::Private
+{
+public:
+    Handle_AIS_InteractiveContext m_context;
+    Handle_V3d_View m_view;
+    int m_width;
+    int m_height;
+};
+
+/*! \class OffscreenRenderer
+ *  \brief Renders the contents of an interactive context into images, without
+ *         any widget
+ *
+ *  The V3d_View is bound to a hidden window created once, images are rendered
+ *  by V3d_View::ToPixMap() into an offscreen buffer (FBO when supported). So
+ *  the same renderer can be used to render many shapes in sequence, for
+ *  example to generate thumbnails with renderShape().
+ *
+ *  A window system is still required by OpenCascade (ex: a X server, that can
+ *  be virtual like Xvfb).
+ *
+ *  OpenGL contexts are bound to threads, so an OffscreenRenderer must be used
+ *  by the thread that created it, with a context (and so a V3d_Viewer and
+ *  graphic driver) not shared with other threads. renderShapes() follows
+ *  this rule to render on many threads.
+ *
+ *  \headerfile offscreen_renderer.h <occtools/offscreen_renderer.h>
+ *  \ingroup occtools
+ */
+
+/*! Constructs a renderer of images of \p width x \p height pixels, displaying
+ *  objects of \p context
+ */
+OffscreenRenderer::OffscreenRenderer(
+        const Handle_AIS_InteractiveContext& context, int width, int height)
+    : d(new Private)
+{
+    d->m_context = context;
+    d->m_width = width;
+    d->m_height = height;
+    d->m_view = context->CurrentViewer()->CreateView();
+    d->m_view->SetWindow(internal::createHiddenWindow(context, width, height));
+    d->m_view->SetBackgroundColor(Quantity_NOC_WHITE);
+    d->m_view->MustBeResized();
+}
+
+OffscreenRenderer::~OffscreenRenderer()
+{
+    if (!d->m_view.IsNull())
+        d->m_view->Remove();
+    delete d;
+}
+
+Handle_AIS_InteractiveContext OffscreenRenderer::context() const
+{
+    return d->m_context;
+}
+
+Handle_V3d_View OffscreenRenderer::internalView() const
+{
+    return d->m_view;
+}
+
+int OffscreenRenderer::width() const
+{
+    return d->m_width;
+}
+
+int OffscreenRenderer::height() const
+{
+    return d->m_height;
+}
+
+//! Sets the size (in pixels) of the images rendered
+void OffscreenRenderer::setSize(int width, int height)
+{
+    d->m_width = width;
+    d->m_height = height;
+}
+
+void OffscreenRenderer::setBackgroundColor(const Quantity_Color& color)
+{
+    d->m_view->SetBackgroundColor(color);
+}
+
+/*! Renders the objects currently displayed in context(), with the current
+ *  camera of internalView()
+ *
+ *  Returns a null QImage if rendering failed
+ */
+QImage OffscreenRenderer::render()
+{
+    Image_PixMap pixmap;
+    const bool isRendered =
+            d->m_view->ToPixMap(pixmap, d->m_width, d->m_height, Graphic3d_BT_RGB)
+            == Standard_True;
+    return isRendered ? internal::toQImage(pixmap) : QImage();
+}
+
+/*! Renders \p shape alone, shaded and fitted in the image
+ *
+ *  Other objects displayed in context() are temporarily erased. \p shape is
+ *  removed from the context once rendered.
+ */
+QImage OffscreenRenderer::renderShape(const TopoDS_Shape& shape)
+{
+    d->m_context->EraseAll(Standard_False);
+    Handle_AIS_Shape aisShape = new AIS_Shape(shape);
+    aisShape->SetDisplayMode(AIS_Shaded);
+    d->m_context->Display(aisShape, Standard_False);
+    d->m_view->FitAll();
+    d->m_view->ZFitAll();
+    const QImage image = this->render();
+    AisUtils::eraseObjectFromContext(aisShape, d->m_context);
+    d->m_context->DisplayAll(Standard_False);
+    return image;
+}
+
+/*! Renders the \p count shapes of array \p shapes into array \p images, with
+ *  renderShape()
+ *
+ *  Shapes are dispatched to threads by contiguous chunks. Each thread calls
+ *  \p contextFactory once to get its own interactive context (the
+ *  AIS_InteractiveContext, V3d_Viewer and graphic driver must not be shared
+ *  among threads), then reuses a single OffscreenRenderer for all the shapes
+ *  of its chunk.
+ *
+ *  \param threadCount  Maximum count of threads to use (0 means as many as
+ *                      the hardware supports)
+ */
+void OffscreenRenderer::renderShapes(
+        const TopoDS_Shape* shapes,
+        std::size_t count,
+        QImage* images,
+        int width,
+        int height,
+        const ContextFactory& contextFactory,
+        unsigned threadCount)
+{
+    auto fnChunk = [&] (std::size_t iBegin, std::size_t iEnd) {
+        OffscreenRenderer renderer(contextFactory(), width, height);
+        for (std::size_t i = iBegin; i < iEnd; ++i)
+            images[i] = renderer.renderShape(shapes[i]);
+    };
+    cpp::parallelForRanges(count, fnChunk, threadCount);
+}
+
+} // namespace occ
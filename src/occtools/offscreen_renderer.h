@@ -0,0 +1,68 @@
+/****************************************************************************
+**  FougTools
+**  Copyright Fougue (30 Mar. 2015)
+**  contact@fougue.pro
+**
+** This software is a computer program whose purpose is to provide utility
+** tools for the C++ language and the Qt toolkit.
+**
+** This software is governed by the CeCILL-C license under French law and
+** abiding by the rules of distribution of free software.  You can  use,
+** modify and/ or redistribute the software under the terms of the CeCILL-C
+** license as circulated by CEA, CNRS and INRIA at the following URL
+** "http://www.cecill.info".
+****************************************************************************/
+
+#pragma once
+
+#include "occtools.h"
+
+#include <Handle_AIS_InteractiveContext.hxx>
+#include <Handle_V3d_View.hxx>
+#include <Quantity_Color.hxx>
+#include <TopoDS_Shape.hxx>
+
+#include <QtGui/QImage>
+
+#include <cstddef>
+#include <functional>
+
+namespace occ {
+
+class OCCTOOLS_EXPORT OffscreenRenderer
+{
+public:
+    OffscreenRenderer(
+            const Handle_AIS_InteractiveContext& context,
+            int width,
+            int height);
+    ~OffscreenRenderer();
+
+    Handle_AIS_InteractiveContext context() const;
+    Handle_V3d_View internalView() const;
+
+    int width() const;
+    int height() const;
+    void setSize(int width, int height);
+
+    void setBackgroundColor(const Quantity_Color& color);
+
+    QImage render();
+    QImage renderShape(const TopoDS_Shape& shape);
+
+    typedef std::function<Handle_AIS_InteractiveContext()> ContextFactory;
+    static void renderShapes(
+            const TopoDS_Shape* shapes,
+            std::size_t count,
+            QImage* images,
+            int width,
+            int height,
+            const ContextFactory& contextFactory,
+            unsigned threadCount = 0);
+
+private:
+    class Private;
+    Private* const d;
+};
+
+} // namespace occ
@@ -16,21 +16,33 @@
 #include "point_on_faces_projector.h"
 
 #include "math_utils.h"
+#include "poly_triangulation_normals.h"
+#include "../cpptools/parallel_utils.h"
+#include "../cpptools/profiling.h"
 
+#include <BRepMesh_IncrementalMesh.hxx>
 #include <BRep_Tool.hxx>
 #include <Bnd_Box.hxx>
 #include <NCollection_UBTree.hxx>
 #include <NCollection_UBTreeFiller.hxx>
 #include <Poly_Triangulation.hxx>
+#include <Standard_Version.hxx>
 #include <TColgp_Array1OfPnt.hxx>
 #include <TopExp_Explorer.hxx>
 #include <TopoDS.hxx>
 #include <TopoDS_Face.hxx>
 #include <TopoDS_Shape.hxx>
 
+#include <algorithm>
+#include <cassert>
+#include <chrono>
 #include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <deque>
 #include <limits>
-#include <map>
+#include <string>
+#include <vector>
 
 namespace occ {
 
@@ -46,121 +58,1731 @@ namespace occ {
 
 namespace internal {
 
-typedef std::pair<int, Handle_Poly_Triangulation> NodeIndexInTriangulation_t;
-typedef NCollection_UBTree<NodeIndexInTriangulation_t, Bnd_Box> UBTreeOfNodeIndices_t;
-typedef NCollection_UBTreeFiller<NodeIndexInTriangulation_t, Bnd_Box> UBTreeOfNodeIndicesFiller_t;
+/*! Triangulation of a face loaded in the projector
+ *
+ *  Spatial indexes refer to slots with their 32-bit index, so a search result
+ *  is mapped back to its face in O(1)
+ */
+struct TriangulationSlot
+{
+    TopoDS_Face face;
+    const TopoDS_Face* stableFace; // Copy of face in Private::m_faces, see faceOfProjection()
+    Handle_Poly_Triangulation triangulation;
+    Poly_TriangulationNormals normals; // Triangle normals, in triangulation frame
+    gp_Trsf trsf;
+    double boxMin[3]; // Bounding box of the transformed nodes
+    double boxMax[3];
+    std::uint32_t batchId;
+    std::uint32_t firstNodeId; // TriangleBvhIndex: offset in Private::m_nodeX/Y/Z
+    bool isRemoved;
+};
+
+typedef std::vector<TriangulationSlot> TriangulationSlots_t;
+
+//! Index of a node in the triangulation of a slot, the node index is -1 if null
+typedef std::pair<int, std::uint32_t> NodeIndexInSlot_t;
+typedef NCollection_UBTree<NodeIndexInSlot_t, Bnd_Box> UBTreeOfNodeIndices_t;
+typedef NCollection_UBTreeFiller<NodeIndexInSlot_t, Bnd_Box> UBTreeOfNodeIndicesFiller_t;
+
+//! Triangulation node found by range queries
+struct NodeCandidate
+{
+    double sqrDist;
+    std::uint32_t slotId;
+    int nodeId; // Index in the triangulation of the slot
+    std::uint32_t key; // Unique key of the node in the spatial index
+    double coords[3];
+};
+
+/*! Collects the nodes within a maximum distance, keeping at most maxCount()
+ *  nearest ones
+ *
+ *  maxSqrDistance() shrinks as soon as maxCount() nodes are collected, it is
+ *  used to prune the traversals of the spatial index.\n
+ *  With TriangleBvhIndex the same node is reached through all the triangles
+ *  around it, duplicates are then discarded by key.
+ */
+class NodeCollector
+{
+public:
+    NodeCollector(std::size_t maxCount, double maxSqrDist, bool hasDuplicates)
+        : m_maxCount(maxCount),
+          m_maxSqrDist(maxSqrDist),
+          m_hasDuplicates(hasDuplicates)
+    { }
+
+    std::size_t maxCount() const
+    { return m_maxCount; }
+
+    const double& maxSqrDistance() const
+    { return m_maxSqrDist; }
+
+    void add(const NodeCandidate& node)
+    {
+        if (node.sqrDist > m_maxSqrDist || m_maxCount == 0)
+            return;
+        if (m_hasDuplicates && m_maxCount != std::numeric_limits<std::size_t>::max()) {
+            // Bounded count (k-nearest) : linear check, k is meant to be small
+            for (const NodeCandidate& other : m_nodes) {
+                if (other.key == node.key)
+                    return;
+            }
+        }
+
+        if (m_nodes.size() < m_maxCount) {
+            m_nodes.push_back(node);
+            std::push_heap(m_nodes.begin(), m_nodes.end(), &NodeCollector::isNearer);
+        }
+        else {
+            std::pop_heap(m_nodes.begin(), m_nodes.end(), &NodeCollector::isNearer);
+            m_nodes.back() = node;
+            std::push_heap(m_nodes.begin(), m_nodes.end(), &NodeCollector::isNearer);
+        }
+        if (m_nodes.size() == m_maxCount)
+            m_maxSqrDist = m_nodes.front().sqrDist;
+    }
+
+    //! Collected nodes, sorted by increasing distance
+    std::vector<NodeCandidate> takeNodes()
+    {
+        std::sort_heap(m_nodes.begin(), m_nodes.end(), &NodeCollector::isNearer);
+        if (m_hasDuplicates && m_maxCount == std::numeric_limits<std::size_t>::max()) {
+            auto itEnd = std::unique(
+                        m_nodes.begin(),
+                        m_nodes.end(),
+                        [] (const NodeCandidate& lhs, const NodeCandidate& rhs) {
+                return lhs.key == rhs.key;
+            });
+            m_nodes.erase(itEnd, m_nodes.end());
+        }
+        std::vector<NodeCandidate> nodes;
+        nodes.swap(m_nodes);
+        return nodes;
+    }
+
+private:
+    static bool isNearer(const NodeCandidate& lhs, const NodeCandidate& rhs)
+    {
+        return lhs.sqrDist < rhs.sqrDist
+                || (lhs.sqrDist == rhs.sqrDist && lhs.key < rhs.key);
+    }
+
+    std::vector<NodeCandidate> m_nodes;
+    const std::size_t m_maxCount;
+    double m_maxSqrDist;
+    const bool m_hasDuplicates;
+};
+
+//! Selects the nodes of an UBTreeIndex within the distance of a NodeCollector
+class NodeRangeSelector : public UBTreeOfNodeIndices_t::Selector
+{
+public:
+    NodeRangeSelector(
+            const gp_Pnt& pnt, const TriangulationSlots_t& slots, NodeCollector* collector)
+        : m_pnt(pnt),
+          m_slots(slots),
+          m_collector(collector)
+    {
+    }
+
+    Standard_Boolean Reject(const Bnd_Box& bb) const
+    {
+        if (bb.IsVoid() == Standard_True)
+            return Standard_True;
+        double boxMin[3];
+        double boxMax[3];
+        bb.Get(boxMin[0], boxMin[1], boxMin[2], boxMax[0], boxMax[1], boxMax[2]);
+        double sqrDist = 0.;
+        for (int i = 0; i < 3; ++i) {
+            const double coord = m_pnt.Coord(i + 1);
+            const double delta =
+                    std::max(0., std::max(boxMin[i] - coord, coord - boxMax[i]));
+            sqrDist += delta * delta;
+        }
+        return sqrDist > m_collector->maxSqrDistance() ? Standard_True : Standard_False;
+    }
+
+    Standard_Boolean Accept(const NodeIndexInSlot_t& nodeId)
+    {
+        const TriangulationSlot& slot = m_slots[nodeId.second];
+        if (slot.isRemoved || slot.triangulation.IsNull())
+            return Standard_False;
+
+        const gp_Pnt pnt = slot.triangulation->Nodes()(nodeId.first).Transformed(slot.trsf);
+        NodeCandidate node;
+        node.sqrDist = m_pnt.SquareDistance(pnt);
+        node.slotId = nodeId.second;
+        node.nodeId = nodeId.first;
+        node.key = 0;
+        node.coords[0] = pnt.X();
+        node.coords[1] = pnt.Y();
+        node.coords[2] = pnt.Z();
+        m_collector->add(node);
+        return Standard_True;
+    }
+
+private:
+    const gp_Pnt m_pnt;
+    const TriangulationSlots_t& m_slots;
+    NodeCollector* m_collector;
+};
+
+class NodeBndBoxSelector : public UBTreeOfNodeIndices_t::Selector
+{
+public:
+    NodeBndBoxSelector(
+            const gp_Pnt& pntToProject, const TriangulationSlots_t& slots)
+        : m_pntToProject(pntToProject),
+          m_slots(slots),
+          m_currMinDist(std::numeric_limits<double>::max()),
+          m_currMinDistNodeId(-1, 0)
+    {
+    }
+
+    Standard_Boolean Reject(const Bnd_Box& bb) const
+    {
+        const bool result =
+                bb.IsOpenXmin() == Standard_True
+                || bb.IsOpenXmax() == Standard_True
+                || bb.IsOpenYmin() == Standard_True
+                || bb.IsOpenYmax() == Standard_True
+                || bb.IsOpenZmin() == Standard_True
+                || bb.IsOpenZmax() == Standard_True
+                || bb.IsWhole() == Standard_True
+                || bb.IsVoid() == Standard_True;
+        return result ? Standard_True : Standard_False;
+    }
+
+    Standard_Boolean Accept(const NodeIndexInSlot_t& nodeId)
+    {
+        const TriangulationSlot& slot = m_slots[nodeId.second];
+        if (slot.isRemoved || slot.triangulation.IsNull())
+            return Standard_False;
+
+        const TColgp_Array1OfPnt& nodes = slot.triangulation->Nodes();
+        if (!(nodes.Lower() <= nodeId.first && nodeId.first <= nodes.Upper()))
+            return Standard_False;
+
+        const gp_Pnt pnt = nodes(nodeId.first).Transformed(slot.trsf);
+        const double dist = m_pntToProject.SquareDistance(pnt);
+        if (dist < m_currMinDist || m_currMinDistNodeId.first == -1) {
+            m_currMinDistNodeId = nodeId;
+            m_currMinDist = dist;
+            return Standard_True;
+        }
+        return Standard_False;
+    }
+
+    double minDistance() const
+    {
+        return std::sqrt(m_currMinDist);
+    }
+
+    const NodeIndexInSlot_t& minDistanceNodeIndex() const
+    {
+        return m_currMinDistNodeId;
+    }
+
+private:
+    const gp_Pnt m_pntToProject;
+    const TriangulationSlots_t& m_slots;
+    double m_currMinDist;
+    NodeIndexInSlot_t m_currMinDistNodeId;
+};
+
+/*! Array of spatial index data, either owning its items or viewing items in
+ *  external read-only memory (index loaded with loadIndex())
+ *
+ *  Read access goes through data(). Any modification first copies external
+ *  items into the owned vector, so a loaded index can still be modified
+ *  (addFaces(), refitFace(), ...) without writing to the external memory.
+ */
+template<typename T>
+class IndexArray
+{
+public:
+    IndexArray()
+        : m_external(nullptr),
+          m_externalSize(0)
+    { }
+
+    const T* data() const
+    { return m_external != nullptr ? m_external : m_vec.data(); }
+
+    std::size_t size() const
+    { return m_external != nullptr ? m_externalSize : m_vec.size(); }
+
+    bool empty() const
+    { return this->size() == 0; }
+
+    //! Bytes allocated for owned items (capacity, not size)
+    std::size_t ownedBytes() const
+    { return m_vec.capacity() * sizeof(T); }
+
+    //! Bytes of the external items viewed, not owned by this array
+    std::size_t externalBytes() const
+    { return m_externalSize * sizeof(T); }
+
+    const T& operator[](std::size_t i) const
+    { return this->data()[i]; }
+
+    T& operator[](std::size_t i)
+    { return this->owned()[i]; }
+
+    typename std::vector<T>::iterator begin()
+    { return this->owned().begin(); }
+
+    void resize(std::size_t count)
+    { this->owned().resize(count); }
+
+    void reserve(std::size_t count)
+    { this->owned().reserve(count); }
+
+    void push_back(const T& item)
+    { this->owned().push_back(item); }
+
+    void clear()
+    {
+        m_vec.clear();
+        m_external = nullptr;
+        m_externalSize = 0;
+    }
+
+    //! Views the \p count items at \p items, which must outlive this array
+    void setExternal(const T* items, std::size_t count)
+    {
+        this->clear();
+        if (count > 0) {
+            m_external = items;
+            m_externalSize = count;
+        }
+    }
+
+private:
+    std::vector<T>& owned()
+    {
+        if (m_external != nullptr) {
+            m_vec.assign(m_external, m_external + m_externalSize);
+            m_external = nullptr;
+            m_externalSize = 0;
+        }
+        return m_vec;
+    }
+
+    std::vector<T> m_vec;
+    const T* m_external;
+    std::size_t m_externalSize;
+};
+
+/*! Compact bounding volume hierarchy over primitives, stored in a flat array
+ *
+ *  Nodes are laid out in depth-first order : the left child of an inner node
+ *  immediately follows it, the right child index is stored in the node.
+ *  Primitives are referenced with 32-bit indices, once the BVH is built the
+ *  primitives of a leaf are contiguous in primitiveOrder().
+ */
+class FlatBvh
+{
+public:
+    struct Node
+    {
+        double boxMin[3];
+        double boxMax[3];
+        std::uint32_t offset; // Leaf: first primitive, inner node: right child
+        std::uint32_t count;  // Leaf: count of primitives, inner node: 0
+    };
+
+    //! Bounding boxes of the primitives, in SoA layout
+    struct PrimitiveBoxes
+    {
+        std::vector<double> minX, minY, minZ;
+        std::vector<double> maxX, maxY, maxZ;
+
+        std::size_t size() const;
+        void reserve(std::size_t count);
+        void add(const double boxMin[3], const double boxMax[3]);
+    };
+
+    void build(const PrimitiveBoxes& boxes, unsigned maxLeafSize = 8);
+    void clear();
+
+    bool isEmpty() const;
+    const IndexArray<Node>& nodes() const;
+    const IndexArray<std::uint32_t>& primitiveOrder() const;
+    void setExternal(
+            const Node* nodes,
+            std::size_t nodeCount,
+            const std::uint32_t* primOrder,
+            std::size_t primCount);
+    bool isValid() const;
+
+    template<typename SQR_DIST_FUNC>
+    std::int64_t nearest(
+            const double pnt[3],
+            SQR_DIST_FUNC fnSqrDist,
+            double* ptrMinSqrDist) const;
+
+    template<typename FUNC>
+    void forEachNear(const double pnt[3], const double& maxSqrDist, FUNC fn) const;
+
+    template<typename PRIMITIVE_BOX_FUNC>
+    void refit(PRIMITIVE_BOX_FUNC fnPrimitiveBox);
+
+    static double sqrDistanceToBox(const double pnt[3], const Node& node);
+    static double sqrDistanceToFarthestCorner(
+            const double pnt[3], const double boxMin[3], const double boxMax[3]);
+
+private:
+    std::uint32_t buildNode(
+            const PrimitiveBoxes& boxes,
+            const std::vector<double>& centers,
+            std::uint32_t first,
+            std::uint32_t count,
+            unsigned maxLeafSize);
+
+    IndexArray<Node> m_nodes;
+    IndexArray<std::uint32_t> m_primOrder;
+};
+
+std::size_t FlatBvh::PrimitiveBoxes::size() const
+{
+    return minX.size();
+}
+
+void FlatBvh::PrimitiveBoxes::reserve(std::size_t count)
+{
+    for (std::vector<double>* vec : { &minX, &minY, &minZ, &maxX, &maxY, &maxZ })
+        vec->reserve(count);
+}
+
+void FlatBvh::PrimitiveBoxes::add(const double boxMin[3], const double boxMax[3])
+{
+    minX.push_back(boxMin[0]);
+    minY.push_back(boxMin[1]);
+    minZ.push_back(boxMin[2]);
+    maxX.push_back(boxMax[0]);
+    maxY.push_back(boxMax[1]);
+    maxZ.push_back(boxMax[2]);
+}
+
+void FlatBvh::build(const PrimitiveBoxes& boxes, unsigned maxLeafSize)
+{
+    this->clear();
+    const std::size_t primCount = boxes.size();
+    assert(primCount <= std::numeric_limits<std::uint32_t>::max());
+    if (primCount == 0)
+        return;
+
+    std::vector<double> centers(3 * primCount);
+    m_primOrder.resize(primCount);
+    for (std::size_t i = 0; i < primCount; ++i) {
+        centers[3*i + 0] = 0.5 * (boxes.minX[i] + boxes.maxX[i]);
+        centers[3*i + 1] = 0.5 * (boxes.minY[i] + boxes.maxY[i]);
+        centers[3*i + 2] = 0.5 * (boxes.minZ[i] + boxes.maxZ[i]);
+        m_primOrder[i] = static_cast<std::uint32_t>(i);
+    }
+
+    m_nodes.reserve(2 * (primCount / std::max(maxLeafSize, 1u)) + 1);
+    this->buildNode(
+                boxes,
+                centers,
+                0,
+                static_cast<std::uint32_t>(primCount),
+                std::max(maxLeafSize, 1u));
+}
+
+void FlatBvh::clear()
+{
+    m_nodes.clear();
+    m_primOrder.clear();
+}
+
+bool FlatBvh::isEmpty() const
+{
+    return m_nodes.empty();
+}
+
+const IndexArray<FlatBvh::Node>& FlatBvh::nodes() const
+{
+    return m_nodes;
+}
+
+//! Position of a primitive in the BVH -> index of that primitive in the input
+const IndexArray<std::uint32_t>& FlatBvh::primitiveOrder() const
+{
+    return m_primOrder;
+}
+
+//! Views a BVH built previously, stored in external memory
+void FlatBvh::setExternal(
+        const Node* nodes,
+        std::size_t nodeCount,
+        const std::uint32_t* primOrder,
+        std::size_t primCount)
+{
+    m_nodes.setExternal(nodes, nodeCount);
+    m_primOrder.setExternal(primOrder, primCount);
+}
+
+/*! Checks the tree structure, typically of a BVH viewed with setExternal()
+ *
+ *  Children must be stored after their parent, leaves must refer to valid
+ *  primitive positions and the depth must fit the traversal stacks
+ */
+bool FlatBvh::isValid() const
+{
+    const std::size_t nodeCount = m_nodes.size();
+    const std::size_t primCount = m_primOrder.size();
+    for (std::size_t pos = 0; pos < primCount; ++pos) {
+        if (m_primOrder[pos] >= primCount)
+            return false;
+    }
+
+    std::vector<std::uint8_t> vecDepth(nodeCount, 0);
+    for (std::size_t nodeId = 0; nodeId < nodeCount; ++nodeId) {
+        const Node& node = m_nodes[nodeId];
+        if (node.count > 0) {
+            if (std::uint64_t(node.offset) + node.count > primCount)
+                return false;
+        }
+        else {
+            const std::size_t leftId = nodeId + 1;
+            const std::size_t rightId = node.offset;
+            // Traversal stacks hold 64 node ids
+            const std::uint8_t childDepth = static_cast<std::uint8_t>(vecDepth[nodeId] + 1);
+            if (rightId <= leftId || rightId >= nodeCount || childDepth >= 64)
+                return false;
+            vecDepth[leftId] = std::max(vecDepth[leftId], childDepth);
+            vecDepth[rightId] = std::max(vecDepth[rightId], childDepth);
+        }
+    }
+    return true;
+}
+
+/*! Finds the primitive closest to point \p pnt
+ *
+ *  \p fnSqrDist is called as fnSqrDist(pos, currMinSqrDist) where \c pos is the
+ *  position of the primitive in the BVH (see primitiveOrder()), it must return
+ *  the squared distance from \p pnt to the primitive.\n
+ *  Subtrees whose bounding box is farther than the current minimum distance
+ *  are skipped.
+ *
+ *  \param ptrMinSqrDist  In: current minimum squared distance (eg. found in
+ *                        another BVH), out: updated minimum squared distance
+ *  \returns Position of the closest primitive in the BVH, -1 if no primitive
+ *           is closer than the input minimum distance
+ */
+template<typename SQR_DIST_FUNC>
+std::int64_t FlatBvh::nearest(
+        const double pnt[3],
+        SQR_DIST_FUNC fnSqrDist,
+        double* ptrMinSqrDist) const
+{
+    std::int64_t minPos = -1;
+    if (m_nodes.empty())
+        return minPos;
+
+    const Node* nodes = m_nodes.data();
+    double minSqrDist = *ptrMinSqrDist;
+    std::uint32_t stack[64]; // Median split keeps the depth below 32
+    int stackSize = 0;
+    stack[stackSize++] = 0;
+    while (stackSize > 0) {
+        const std::uint32_t nodeId = stack[--stackSize];
+        const Node& node = nodes[nodeId];
+        if (FlatBvh::sqrDistanceToBox(pnt, node) >= minSqrDist)
+            continue;
+
+        if (node.count > 0) {
+            for (std::uint32_t pos = node.offset;
+                 pos < node.offset + node.count;
+                 ++pos)
+            {
+                const double sqrDist = fnSqrDist(pos, minSqrDist);
+                if (sqrDist < minSqrDist) {
+                    minSqrDist = sqrDist;
+                    minPos = pos;
+                }
+            }
+        }
+        else {
+            // Push the farthest child first so the nearest one is visited first
+            const std::uint32_t leftId = nodeId + 1;
+            const std::uint32_t rightId = node.offset;
+            const double leftSqrDist =
+                    FlatBvh::sqrDistanceToBox(pnt, nodes[leftId]);
+            const double rightSqrDist =
+                    FlatBvh::sqrDistanceToBox(pnt, nodes[rightId]);
+            const bool leftIsNearest = leftSqrDist <= rightSqrDist;
+            const std::uint32_t nearId = leftIsNearest ? leftId : rightId;
+            const std::uint32_t farId = leftIsNearest ? rightId : leftId;
+            const double nearSqrDist = leftIsNearest ? leftSqrDist : rightSqrDist;
+            const double farSqrDist = leftIsNearest ? rightSqrDist : leftSqrDist;
+            if (farSqrDist < minSqrDist)
+                stack[stackSize++] = farId;
+            if (nearSqrDist < minSqrDist)
+                stack[stackSize++] = nearId;
+        }
+    }
+    *ptrMinSqrDist = minSqrDist;
+    return minPos;
+}
+
+/*! Calls \p fn(pos) for each primitive of the leaves whose bounding box is
+ *  within \p maxSqrDist (squared distance) of point \p pnt
+ *
+ *  This is a conservative selection, \p fn has to check the primitive itself.
+ *  \p maxSqrDist is read again before visiting each BVH node, so \p fn may
+ *  decrease it to prune the rest of the traversal (ex: k-nearest search)
+ */
+template<typename FUNC>
+void FlatBvh::forEachNear(
+        const double pnt[3], const double& maxSqrDist, FUNC fn) const
+{
+    if (m_nodes.empty())
+        return;
+
+    const Node* nodes = m_nodes.data();
+    std::uint32_t stack[64];
+    int stackSize = 0;
+    stack[stackSize++] = 0;
+    while (stackSize > 0) {
+        const std::uint32_t nodeId = stack[--stackSize];
+        const Node& node = nodes[nodeId];
+        if (FlatBvh::sqrDistanceToBox(pnt, node) > maxSqrDist)
+            continue;
+
+        if (node.count > 0) {
+            for (std::uint32_t pos = node.offset; pos < node.offset + node.count; ++pos)
+                fn(pos);
+        }
+        else {
+            stack[stackSize++] = node.offset;
+            stack[stackSize++] = nodeId + 1;
+        }
+    }
+}
+
+/*! Recomputes the bounding boxes of the BVH nodes, keeping the tree structure
+ *
+ *  \p fnPrimitiveBox is called as fnPrimitiveBox(pos, boxMin, boxMax) where
+ *  \c pos is the position of the primitive in the BVH, it must assign the
+ *  bounding box of the primitive.\n
+ *  This is much faster than build() but search efficiency degrades if the
+ *  primitives moved a lot.
+ */
+template<typename PRIMITIVE_BOX_FUNC>
+void FlatBvh::refit(PRIMITIVE_BOX_FUNC fnPrimitiveBox)
+{
+    // Children are stored after their parent, so a reverse traversal visits
+    // them first
+    for (std::size_t nodeId = m_nodes.size(); nodeId > 0; --nodeId) {
+        Node& node = m_nodes[nodeId - 1];
+        for (int i = 0; i < 3; ++i) {
+            node.boxMin[i] = std::numeric_limits<double>::max();
+            node.boxMax[i] = -std::numeric_limits<double>::max();
+        }
+        if (node.count > 0) {
+            for (std::uint32_t pos = node.offset;
+                 pos < node.offset + node.count;
+                 ++pos)
+            {
+                double primMin[3];
+                double primMax[3];
+                fnPrimitiveBox(pos, primMin, primMax);
+                for (int i = 0; i < 3; ++i) {
+                    node.boxMin[i] = std::min(node.boxMin[i], primMin[i]);
+                    node.boxMax[i] = std::max(node.boxMax[i], primMax[i]);
+                }
+            }
+        }
+        else {
+            for (const Node* child : { &m_nodes[nodeId], &m_nodes[node.offset] }) {
+                for (int i = 0; i < 3; ++i) {
+                    node.boxMin[i] = std::min(node.boxMin[i], child->boxMin[i]);
+                    node.boxMax[i] = std::max(node.boxMax[i], child->boxMax[i]);
+                }
+            }
+        }
+    }
+}
+
+double FlatBvh::sqrDistanceToBox(const double pnt[3], const Node& node)
+{
+    double sqrDist = 0.;
+    for (int i = 0; i < 3; ++i) {
+        const double coord = pnt[i];
+        if (coord < node.boxMin[i]) {
+            const double delta = node.boxMin[i] - coord;
+            sqrDist += delta * delta;
+        }
+        else if (coord > node.boxMax[i]) {
+            const double delta = coord - node.boxMax[i];
+            sqrDist += delta * delta;
+        }
+    }
+    return sqrDist;
+}
+
+//! Squared distance from \p pnt to the farthest corner of a box, an upper
+//! bound of the distance to anything inside the box
+double FlatBvh::sqrDistanceToFarthestCorner(
+        const double pnt[3], const double boxMin[3], const double boxMax[3])
+{
+    double sqrDist = 0.;
+    for (int i = 0; i < 3; ++i) {
+        const double delta =
+                std::max(std::abs(pnt[i] - boxMin[i]), std::abs(pnt[i] - boxMax[i]));
+        sqrDist += delta * delta;
+    }
+    return sqrDist;
+}
+
+std::uint32_t FlatBvh::buildNode(
+        const PrimitiveBoxes& boxes,
+        const std::vector<double>& centers,
+        std::uint32_t first,
+        std::uint32_t count,
+        unsigned maxLeafSize)
+{
+    const std::uint32_t nodeId = static_cast<std::uint32_t>(m_nodes.size());
+    m_nodes.push_back(Node());
+
+    // Bounding box of the primitives and of their centers
+    Node node;
+    double centerMin[3];
+    double centerMax[3];
+    for (int i = 0; i < 3; ++i) {
+        node.boxMin[i] = centerMin[i] = std::numeric_limits<double>::max();
+        node.boxMax[i] = centerMax[i] = -std::numeric_limits<double>::max();
+    }
+    for (std::uint32_t pos = first; pos < first + count; ++pos) {
+        const std::uint32_t primId = m_primOrder[pos];
+        const double primMin[3] =
+            { boxes.minX[primId], boxes.minY[primId], boxes.minZ[primId] };
+        const double primMax[3] =
+            { boxes.maxX[primId], boxes.maxY[primId], boxes.maxZ[primId] };
+        for (int i = 0; i < 3; ++i) {
+            node.boxMin[i] = std::min(node.boxMin[i], primMin[i]);
+            node.boxMax[i] = std::max(node.boxMax[i], primMax[i]);
+            centerMin[i] = std::min(centerMin[i], centers[3*primId + i]);
+            centerMax[i] = std::max(centerMax[i], centers[3*primId + i]);
+        }
+    }
+
+    if (count <= maxLeafSize) {
+        node.offset = first;
+        node.count = count;
+        m_nodes[nodeId] = node;
+        return nodeId;
+    }
+
+    // Median split along the largest extent of primitive centers
+    int axis = 0;
+    for (int i = 1; i < 3; ++i) {
+        if (centerMax[i] - centerMin[i] > centerMax[axis] - centerMin[axis])
+            axis = i;
+    }
+    const std::uint32_t leftCount = count / 2;
+    auto itFirst = m_primOrder.begin() + first;
+    std::nth_element(
+                itFirst,
+                itFirst + leftCount,
+                itFirst + count,
+                [&] (std::uint32_t lhs, std::uint32_t rhs) {
+        return centers[3*lhs + axis] < centers[3*rhs + axis];
+    });
+
+    this->buildNode(boxes, centers, first, leftCount, maxLeafSize);
+    node.offset = this->buildNode(
+                boxes, centers, first + leftCount, count - leftCount, maxLeafSize);
+    node.count = 0;
+    m_nodes[nodeId] = node;
+    return nodeId;
+}
+
+/*! Spatial index (NodeBvhIndex or TriangleBvhIndex) of the triangulations
+ *  loaded by one call to prepare() or addFaces()
+ *
+ *  Primitive data is stored in BVH order, so primitives of a BVH leaf are
+ *  contiguous in memory
+ */
+struct IndexBatch
+{
+    void addMemoryUsage(PointOnFacesProjector::MemoryUsage* usage) const;
+
+    FlatBvh bvh;
+    IndexArray<std::uint32_t> primitiveSlotId;
+
+    // NodeBvhIndex
+    IndexArray<double> nodeX;
+    IndexArray<double> nodeY;
+    IndexArray<double> nodeZ;
+    IndexArray<std::uint32_t> nodeIdInTriangulation;
+
+    // TriangleBvhIndex : 3 nodes per triangle, index in Private::m_nodeX/Y/Z
+    IndexArray<std::uint32_t> triangleNodes;
+    IndexArray<std::uint32_t> triangleIdInTriangulation;
+};
+
+//! Triangle found by TriangleBvhIndex queries
+struct TriangleHit
+{
+    std::uint32_t slotId;
+    int triangleId;
+    gp_Pnt projPnt;
+};
+
+//! Computes the bounding box of the transformed nodes of \p slot
+static void computeSlotBox(TriangulationSlot* slot)
+{
+    for (int i = 0; i < 3; ++i) {
+        slot->boxMin[i] = std::numeric_limits<double>::max();
+        slot->boxMax[i] = -std::numeric_limits<double>::max();
+    }
+    const TColgp_Array1OfPnt& nodes = slot->triangulation->Nodes();
+    for (int i = nodes.Lower(); i <= nodes.Upper(); ++i) {
+        const gp_Pnt node(nodes(i).Transformed(slot->trsf));
+        for (int j = 0; j < 3; ++j) {
+            slot->boxMin[j] = std::min(slot->boxMin[j], node.Coord(j + 1));
+            slot->boxMax[j] = std::max(slot->boxMax[j], node.Coord(j + 1));
+        }
+    }
+}
+
+static double sqrDistanceToSlotBox(const double pnt[3], const TriangulationSlot& slot)
+{
+    FlatBvh::Node slotBox;
+    std::copy(slot.boxMin, slot.boxMin + 3, slotBox.boxMin);
+    std::copy(slot.boxMax, slot.boxMax + 3, slotBox.boxMax);
+    return FlatBvh::sqrDistanceToBox(pnt, slotBox);
+}
+
+/*! Binary layout of an index saved with saveIndex()
+ *
+ *  The blob only contains fixed-size integers, doubles and FlatBvh::Node
+ *  items, arrays are located with offsets from the start of the blob (8-byte
+ *  aligned), so it is position-independent and can be used in place.
+ */
+struct IndexBlobArray
+{
+    std::uint64_t offset;
+    std::uint64_t count;
+};
+
+struct IndexBlobSlot
+{
+    std::uint32_t nodeCount;
+    std::uint32_t triangleCount;
+    std::uint32_t batchId;
+    std::uint32_t firstNodeId;
+    std::uint32_t isRemoved;
+    std::uint32_t reserved;
+};
+
+struct IndexBlobBatch
+{
+    IndexBlobArray bvhNodes;
+    IndexBlobArray bvhPrimitiveOrder;
+    IndexBlobArray primitiveSlotId;
+    IndexBlobArray nodeX;
+    IndexBlobArray nodeY;
+    IndexBlobArray nodeZ;
+    IndexBlobArray nodeIdInTriangulation;
+    IndexBlobArray triangleNodes;
+    IndexBlobArray triangleIdInTriangulation;
+};
+
+struct IndexBlobHeader
+{
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t byteOrderMark;
+    std::uint32_t spatialIndex;
+    std::uint32_t sizeOfBvhNode;
+    std::uint32_t reserved[2];
+    IndexBlobArray slots;  // IndexBlobSlot items
+    IndexBlobArray batches;  // IndexBlobBatch items
+    IndexBlobArray nodeX;
+    IndexBlobArray nodeY;
+    IndexBlobArray nodeZ;
+};
+
+static const char indexBlobMagic[8] = { 'F', 'T', 'P', 'O', 'F', 'I', 'D', 'X' };
+static const std::uint32_t indexBlobVersion = 1;
+static const std::uint32_t indexBlobByteOrderMark = 0x01020304;
+static const std::size_t indexBlobAlignment = 8;
+
+class IndexBlobWriter
+{
+public:
+    IndexBlobWriter()
+        : m_blob(sizeof(IndexBlobHeader), '\0')
+    { }
+
+    template<typename T>
+    IndexBlobArray append(const T* items, std::size_t count)
+    {
+        m_blob.resize(
+                    (m_blob.size() + indexBlobAlignment - 1)
+                    / indexBlobAlignment * indexBlobAlignment,
+                    '\0');
+        IndexBlobArray array;
+        array.offset = m_blob.size();
+        array.count = count;
+        if (count > 0)
+            m_blob.append(reinterpret_cast<const char*>(items), count * sizeof(T));
+        return array;
+    }
+
+    template<typename T>
+    IndexBlobArray append(const IndexArray<T>& items)
+    {
+        return this->append(items.data(), items.size());
+    }
+
+    std::string finish(const IndexBlobHeader& header)
+    {
+        std::memcpy(&m_blob[0], &header, sizeof(IndexBlobHeader));
+        std::string blob;
+        blob.swap(m_blob);
+        return blob;
+    }
+
+private:
+    std::string m_blob;
+};
+
+class IndexBlobReader
+{
+public:
+    IndexBlobReader(const char* data, std::size_t size)
+        : m_data(data),
+          m_size(size)
+    { }
+
+    //! Locates \p array in the blob, returns false if it overflows the blob
+    template<typename T>
+    bool get(const IndexBlobArray& array, const T** ptrItems) const
+    {
+        const std::uint64_t maxCount = m_size / sizeof(T);
+        const bool isValid =
+                array.offset % indexBlobAlignment == 0
+                && array.offset <= m_size
+                && array.count <= maxCount
+                && array.count * sizeof(T) <= m_size - array.offset;
+        *ptrItems = isValid ? reinterpret_cast<const T*>(m_data + array.offset) : nullptr;
+        return isValid;
+    }
+
+    template<typename T>
+    bool get(const IndexBlobArray& array, IndexArray<T>* items) const
+    {
+        const T* ptrItems = nullptr;
+        if (!this->get(array, &ptrItems))
+            return false;
+        items->setExternal(ptrItems, static_cast<std::size_t>(array.count));
+        return true;
+    }
+
+private:
+    const char* m_data;
+    std::size_t m_size;
+};
+
+template<typename T>
+static void addMemoryUsage(
+        const IndexArray<T>& array, PointOnFacesProjector::MemoryUsage* usage)
+{
+    usage->indexBytes += array.ownedBytes();
+    usage->externalIndexBytes += array.externalBytes();
+}
+
+void IndexBatch::addMemoryUsage(PointOnFacesProjector::MemoryUsage* usage) const
+{
+    internal::addMemoryUsage(bvh.nodes(), usage);
+    internal::addMemoryUsage(bvh.primitiveOrder(), usage);
+    internal::addMemoryUsage(primitiveSlotId, usage);
+    internal::addMemoryUsage(nodeX, usage);
+    internal::addMemoryUsage(nodeY, usage);
+    internal::addMemoryUsage(nodeZ, usage);
+    internal::addMemoryUsage(nodeIdInTriangulation, usage);
+    internal::addMemoryUsage(triangleNodes, usage);
+    internal::addMemoryUsage(triangleIdInTriangulation, usage);
+}
+
+static const TopoDS_Face dummyFace;
+
+typedef std::chrono::steady_clock PrepareClock;
+
+static double elapsedMsec(PrepareClock::time_point start)
+{
+    const auto elapsed = PrepareClock::now() - start;
+    return std::chrono::duration<double, std::milli>(elapsed).count();
+}
+
+} // namespace internal
+
+class PointOnFacesProjector::Private
+{
+public:
+    Private();
+    ~Private();
+
+    void clear();
+    void clearIndex();
+
+    std::size_t primitiveCount(const internal::TriangulationSlot& slot) const;
+    std::uint32_t appendSlots(const TopoDS_Shape& faces);
+    void indexSlots(std::uint32_t firstSlotId, std::uint32_t endSlotId);
+    void indexSlotsInUBTree(std::uint32_t firstSlotId, std::uint32_t endSlotId);
+    void indexSlotsInNodeBvh(std::uint32_t firstSlotId, std::uint32_t endSlotId);
+    void indexSlotsInTriangleBvh(std::uint32_t firstSlotId, std::uint32_t endSlotId);
+    void refitSlot(std::uint32_t slotId);
+    bool needsRebuild() const;
+    void rebuild();
+    void indexSlotBoxes();
+    bool loadIndex(const TopoDS_Shape& faces, const char* data, std::size_t size);
+    bool isValidBatchItems(std::uint32_t batchId, const internal::IndexBatch& batch) const;
+
+    internal::NodeIndexInSlot_t nearestNode(const gp_Pnt& point) const;
+    bool nearestTriangle(const gp_Pnt& point, internal::TriangleHit* hit) const;
+    PointOnFacesProjector::Result projectedOnTriangles(const gp_Pnt& point) const;
+    const internal::TriangulationSlot* certainlyNearestSlot(const gp_Pnt& point) const;
+    std::vector<PointOnFacesProjector::NodeHit> collectNodes(
+            const gp_Pnt& point, std::size_t maxCount, double maxSqrDist) const;
+
+    // Bound the count of batches to be searched by queries
+    static const std::size_t maxBatchCount = 32;
+
+    SpatialIndex m_spatialIndex;
+    internal::TriangulationSlots_t m_slots;
+    // Never compacted before clear(), addresses are returned by queries
+    std::deque<TopoDS_Face> m_faces;
+    std::size_t m_primitiveCount;
+    std::size_t m_removedPrimitiveCount;
+
+    // UBTreeIndex
+    internal::UBTreeOfNodeIndices_t m_ubTree;
+
+    // NodeBvhIndex, TriangleBvhIndex
+    std::vector<internal::IndexBatch> m_batches;
+
+    // TriangleBvhIndex : transformed node coordinates of all the slots
+    internal::IndexArray<double> m_nodeX;
+    internal::IndexArray<double> m_nodeY;
+    internal::IndexArray<double> m_nodeZ;
+
+    // Bounding volume hierarchy of the slot bounding boxes, for face queries
+    internal::FlatBvh m_slotBvh;
+
+    PointOnFacesProjector::PrepareStats m_prepareStats;
+};
+
+PointOnFacesProjector::Private::Private()
+    : m_spatialIndex(PointOnFacesProjector::UBTreeIndex),
+      m_primitiveCount(0),
+      m_removedPrimitiveCount(0)
+{
+}
+
+PointOnFacesProjector::Private::~Private()
+{
+    this->clear();
+}
+
+void PointOnFacesProjector::Private::clear()
+{
+    m_slots.clear();
+    m_faces.clear();
+    m_primitiveCount = 0;
+    m_removedPrimitiveCount = 0;
+    this->clearIndex();
+}
+
+void PointOnFacesProjector::Private::clearIndex()
+{
+    m_ubTree.Clear();
+    m_batches.clear();
+    m_slotBvh.clear();
+    m_nodeX.clear();
+    m_nodeY.clear();
+    m_nodeZ.clear();
+}
+
+//! Count of items (nodes or triangles) of \p slot in the spatial index
+std::size_t PointOnFacesProjector::Private::primitiveCount(
+        const internal::TriangulationSlot& slot) const
+{
+    if (m_spatialIndex == PointOnFacesProjector::TriangleBvhIndex)
+        return slot.triangulation->Triangles().Length();
+    return slot.triangulation->Nodes().Length();
+}
+
+//! Adds a slot for each triangulated face in \p faces, returns the first new slot
+std::uint32_t PointOnFacesProjector::Private::appendSlots(const TopoDS_Shape& faces)
+{
+    const auto firstSlotId = static_cast<std::uint32_t>(m_slots.size());
+    for (TopExp_Explorer exp(faces, TopAbs_FACE); exp.More(); exp.Next()) {
+        const TopoDS_Face face = TopoDS::Face(exp.Current());
+        if (face.IsNull())
+            continue;
+        TopLoc_Location loc;
+        const auto& triangulation = BRep_Tool::Triangulation(face, loc);
+        if (triangulation.IsNull())
+            continue;
+
+        internal::TriangulationSlot slot;
+        slot.face = face;
+        m_faces.push_back(face);
+        slot.stableFace = &m_faces.back();
+        slot.triangulation = triangulation;
+        slot.trsf = loc.Transformation();
+        internal::computeSlotBox(&slot);
+        slot.batchId = static_cast<std::uint32_t>(m_batches.size());
+        slot.firstNodeId = 0;
+        slot.isRemoved = false;
+        m_slots.push_back(std::move(slot));
+        m_slots.back().normals.load(
+                    triangulation,
+                    face.Orientation(),
+                    Poly_TriangulationNormals::TriangleNormals);
+        m_primitiveCount += this->primitiveCount(m_slots.back());
+    }
+    return firstSlotId;
+}
+
+//! Inserts slots [firstSlotId, endSlotId) in the spatial index
+void PointOnFacesProjector::Private::indexSlots(
+        std::uint32_t firstSlotId, std::uint32_t endSlotId)
+{
+    if (firstSlotId >= endSlotId)
+        return;
+    switch (m_spatialIndex) {
+    case PointOnFacesProjector::UBTreeIndex:
+        this->indexSlotsInUBTree(firstSlotId, endSlotId);
+        break;
+    case PointOnFacesProjector::NodeBvhIndex:
+        this->indexSlotsInNodeBvh(firstSlotId, endSlotId);
+        break;
+    case PointOnFacesProjector::TriangleBvhIndex:
+        this->indexSlotsInTriangleBvh(firstSlotId, endSlotId);
+        break;
+    }
+    this->indexSlotBoxes();
+}
+
+//! Builds the BVH of the bounding boxes of all slots (removed ones included)
+void PointOnFacesProjector::Private::indexSlotBoxes()
+{
+    internal::FlatBvh::PrimitiveBoxes slotBoxes;
+    slotBoxes.reserve(m_slots.size());
+    for (const internal::TriangulationSlot& slot : m_slots)
+        slotBoxes.add(slot.boxMin, slot.boxMax);
+    m_slotBvh.build(slotBoxes, 4);
+}
+
+void PointOnFacesProjector::Private::indexSlotsInUBTree(
+        std::uint32_t firstSlotId, std::uint32_t endSlotId)
+{
+    // Build the UB tree for binary search of points
+    internal::UBTreeOfNodeIndicesFiller_t ubTreeFiller(m_ubTree, Standard_False);
+    for (std::uint32_t slotId = firstSlotId; slotId < endSlotId; ++slotId) {
+        const internal::TriangulationSlot& slot = m_slots[slotId];
+        const TColgp_Array1OfPnt& nodes = slot.triangulation->Nodes();
+        for (int i = nodes.Lower(); i <= nodes.Upper(); ++i) {
+            const gp_Pnt iNode(nodes(i).Transformed(slot.trsf));
+            Bnd_Box ibb;
+            ibb.Set(iNode);
+            ubTreeFiller.Add(internal::NodeIndexInSlot_t(i, slotId), ibb);
+        }
+    }
+    ubTreeFiller.Fill();
+}
+
+void PointOnFacesProjector::Private::indexSlotsInNodeBvh(
+        std::uint32_t firstSlotId, std::uint32_t endSlotId)
+{
+    // Gather the nodes of the triangulations, in input order
+    std::vector<double> nodeX;
+    std::vector<double> nodeY;
+    std::vector<double> nodeZ;
+    std::vector<std::uint32_t> nodeId;
+    std::vector<std::uint32_t> nodeSlotId;
+    internal::FlatBvh::PrimitiveBoxes nodeBoxes;
+    for (std::uint32_t slotId = firstSlotId; slotId < endSlotId; ++slotId) {
+        const internal::TriangulationSlot& slot = m_slots[slotId];
+        const TColgp_Array1OfPnt& nodes = slot.triangulation->Nodes();
+        for (int i = nodes.Lower(); i <= nodes.Upper(); ++i) {
+            const gp_Pnt iNode(nodes(i).Transformed(slot.trsf));
+            const double coords[3] = { iNode.X(), iNode.Y(), iNode.Z() };
+            nodeX.push_back(coords[0]);
+            nodeY.push_back(coords[1]);
+            nodeZ.push_back(coords[2]);
+            nodeId.push_back(static_cast<std::uint32_t>(i));
+            nodeSlotId.push_back(slotId);
+            nodeBoxes.add(coords, coords);
+        }
+    }
 
-class NodeBndBoxSelector : public UBTreeOfNodeIndices_t::Selector
+    internal::IndexBatch batch;
+    batch.bvh.build(nodeBoxes);
+
+    // Store node data in BVH order
+    const internal::IndexArray<std::uint32_t>& bvhOrder = batch.bvh.primitiveOrder();
+    const std::size_t nodeCount = bvhOrder.size();
+    batch.nodeX.resize(nodeCount);
+    batch.nodeY.resize(nodeCount);
+    batch.nodeZ.resize(nodeCount);
+    batch.nodeIdInTriangulation.resize(nodeCount);
+    batch.primitiveSlotId.resize(nodeCount);
+    for (std::size_t pos = 0; pos < nodeCount; ++pos) {
+        const std::uint32_t i = bvhOrder[pos];
+        batch.nodeX[pos] = nodeX[i];
+        batch.nodeY[pos] = nodeY[i];
+        batch.nodeZ[pos] = nodeZ[i];
+        batch.nodeIdInTriangulation[pos] = nodeId[i];
+        batch.primitiveSlotId[pos] = nodeSlotId[i];
+    }
+    m_batches.push_back(std::move(batch));
+}
+
+void PointOnFacesProjector::Private::indexSlotsInTriangleBvh(
+        std::uint32_t firstSlotId, std::uint32_t endSlotId)
 {
-public:
-    NodeBndBoxSelector(const gp_Pnt& pntToProject)
-        : m_pntToProject(pntToProject),
-          m_currMinDist(std::numeric_limits<double>::max()),
-          m_currMinDistNodeId(-1, Handle_Poly_Triangulation())
-    {
+    internal::FlatBvh::PrimitiveBoxes triangleBoxes;
+    std::vector<std::uint32_t> triangleNodes;
+    std::vector<std::uint32_t> triangleId;
+    std::vector<std::uint32_t> triangleSlotId;
+    for (std::uint32_t slotId = firstSlotId; slotId < endSlotId; ++slotId) {
+        internal::TriangulationSlot& slot = m_slots[slotId];
+
+        // Global index of the triangulation nodes
+        const TColgp_Array1OfPnt& nodes = slot.triangulation->Nodes();
+        slot.firstNodeId = static_cast<std::uint32_t>(m_nodeX.size());
+        for (int i = nodes.Lower(); i <= nodes.Upper(); ++i) {
+            const gp_Pnt iNode(nodes(i).Transformed(slot.trsf));
+            m_nodeX.push_back(iNode.X());
+            m_nodeY.push_back(iNode.Y());
+            m_nodeZ.push_back(iNode.Z());
+        }
+
+        const Poly_Array1OfTriangle& triangles = slot.triangulation->Triangles();
+        for (int iTri = triangles.Lower(); iTri <= triangles.Upper(); ++iTri) {
+            int n[3];
+            triangles(iTri).Get(n[0], n[1], n[2]);
+            double triMin[3] = {
+                std::numeric_limits<double>::max(),
+                std::numeric_limits<double>::max(),
+                std::numeric_limits<double>::max() };
+            double triMax[3] = {
+                -std::numeric_limits<double>::max(),
+                -std::numeric_limits<double>::max(),
+                -std::numeric_limits<double>::max() };
+            for (int j = 0; j < 3; ++j) {
+                const std::size_t nodeId = slot.firstNodeId + (n[j] - nodes.Lower());
+                const double coords[3] = {
+                    m_nodeX[nodeId], m_nodeY[nodeId], m_nodeZ[nodeId] };
+                for (int k = 0; k < 3; ++k) {
+                    triMin[k] = std::min(triMin[k], coords[k]);
+                    triMax[k] = std::max(triMax[k], coords[k]);
+                }
+                triangleNodes.push_back(static_cast<std::uint32_t>(nodeId));
+            }
+            triangleBoxes.add(triMin, triMax);
+            triangleId.push_back(static_cast<std::uint32_t>(iTri));
+            triangleSlotId.push_back(slotId);
+        }
     }
 
-    Standard_Boolean Reject(const Bnd_Box& bb) const
-    {
-        const bool result =
-                bb.IsOpenXmin() == Standard_True
-                || bb.IsOpenXmax() == Standard_True
-                || bb.IsOpenYmin() == Standard_True
-                || bb.IsOpenYmax() == Standard_True
-                || bb.IsOpenZmin() == Standard_True
-                || bb.IsOpenZmax() == Standard_True
-                || bb.IsWhole() == Standard_True
-                || bb.IsVoid() == Standard_True;
-        return result ? Standard_True : Standard_False;
+    internal::IndexBatch batch;
+    batch.bvh.build(triangleBoxes);
+
+    // Store triangle data in BVH order
+    const internal::IndexArray<std::uint32_t>& bvhOrder = batch.bvh.primitiveOrder();
+    const std::size_t triangleCount = bvhOrder.size();
+    batch.triangleNodes.resize(3 * triangleCount);
+    batch.triangleIdInTriangulation.resize(triangleCount);
+    batch.primitiveSlotId.resize(triangleCount);
+    for (std::size_t pos = 0; pos < triangleCount; ++pos) {
+        const std::uint32_t i = bvhOrder[pos];
+        for (int j = 0; j < 3; ++j)
+            batch.triangleNodes[3 * pos + j] = triangleNodes[3 * i + j];
+        batch.triangleIdInTriangulation[pos] = triangleId[i];
+        batch.primitiveSlotId[pos] = triangleSlotId[i];
     }
+    m_batches.push_back(std::move(batch));
+}
 
-    Standard_Boolean Accept(const NodeIndexInTriangulation_t& nodeId)
-    {
-        if (nodeId.second.IsNull())
-            return Standard_False;
+/*! Updates the node coordinates of \p slotId after its triangulation moved
+ *  (same nodes and triangles count), then refits the BVH of its batch
+ */
+void PointOnFacesProjector::Private::refitSlot(std::uint32_t slotId)
+{
+    const internal::TriangulationSlot& slot = m_slots[slotId];
+    const TColgp_Array1OfPnt& nodes = slot.triangulation->Nodes();
+    internal::IndexBatch& batch = m_batches[slot.batchId];
+    if (m_spatialIndex == PointOnFacesProjector::NodeBvhIndex) {
+        for (std::size_t pos = 0; pos < batch.primitiveSlotId.size(); ++pos) {
+            if (batch.primitiveSlotId[pos] == slotId) {
+                const int nodeId = batch.nodeIdInTriangulation[pos];
+                const gp_Pnt node(nodes(nodeId).Transformed(slot.trsf));
+                batch.nodeX[pos] = node.X();
+                batch.nodeY[pos] = node.Y();
+                batch.nodeZ[pos] = node.Z();
+            }
+        }
+        batch.bvh.refit([&] (std::uint32_t pos, double* boxMin, double* boxMax) {
+            boxMin[0] = boxMax[0] = batch.nodeX[pos];
+            boxMin[1] = boxMax[1] = batch.nodeY[pos];
+            boxMin[2] = boxMax[2] = batch.nodeZ[pos];
+        });
+    }
+    else if (m_spatialIndex == PointOnFacesProjector::TriangleBvhIndex) {
+        for (int i = nodes.Lower(); i <= nodes.Upper(); ++i) {
+            const std::size_t nodeId = slot.firstNodeId + (i - nodes.Lower());
+            const gp_Pnt node(nodes(i).Transformed(slot.trsf));
+            m_nodeX[nodeId] = node.X();
+            m_nodeY[nodeId] = node.Y();
+            m_nodeZ[nodeId] = node.Z();
+        }
+        batch.bvh.refit([&] (std::uint32_t pos, double* boxMin, double* boxMax) {
+            const std::uint32_t* triNodes = &batch.triangleNodes[3 * pos];
+            for (int i = 0; i < 3; ++i) {
+                boxMin[i] = std::numeric_limits<double>::max();
+                boxMax[i] = -std::numeric_limits<double>::max();
+            }
+            for (int j = 0; j < 3; ++j) {
+                const double coords[3] = {
+                    m_nodeX[triNodes[j]], m_nodeY[triNodes[j]], m_nodeZ[triNodes[j]] };
+                for (int i = 0; i < 3; ++i) {
+                    boxMin[i] = std::min(boxMin[i], coords[i]);
+                    boxMax[i] = std::max(boxMax[i], coords[i]);
+                }
+            }
+        });
+    }
+}
 
-        const TColgp_Array1OfPnt& nodes = nodeId.second->Nodes();
-        if (!(nodes.Lower() <= nodeId.first && nodeId.first <= nodes.Upper()))
-            return Standard_False;
+//! Too many removed items or batches make queries slow
+bool PointOnFacesProjector::Private::needsRebuild() const
+{
+    return 2 * m_removedPrimitiveCount > m_primitiveCount
+            || m_batches.size() > maxBatchCount;
+}
 
-        const gp_Pnt& pnt = nodes(nodeId.first);
-        const double dist = m_pntToProject.SquareDistance(pnt);
-        if (dist < m_currMinDist || m_currMinDistNodeId.first == -1) {
-            m_currMinDistNodeId = nodeId;
-            m_currMinDist = dist;
-            return Standard_True;
+//! Drops removed slots and indexes the remaining ones from scratch
+void PointOnFacesProjector::Private::rebuild()
+{
+    internal::TriangulationSlots_t liveSlots;
+    for (const internal::TriangulationSlot& slot : m_slots) {
+        if (!slot.isRemoved) {
+            liveSlots.push_back(slot);
+            liveSlots.back().batchId = 0;
         }
-        return Standard_False;
     }
+    m_slots.swap(liveSlots);
+    m_removedPrimitiveCount = 0;
+    m_primitiveCount = 0;
+    for (const internal::TriangulationSlot& slot : m_slots)
+        m_primitiveCount += this->primitiveCount(slot);
+    this->clearIndex();
+    this->indexSlots(0, static_cast<std::uint32_t>(m_slots.size()));
+}
 
-    double minDistance() const
+//! Loads slots of \p faces and views the index arrays saved in \p data
+bool PointOnFacesProjector::Private::loadIndex(
+        const TopoDS_Shape& faces, const char* data, std::size_t size)
+{
+    const bool isAligned =
+            reinterpret_cast<std::uintptr_t>(data) % internal::indexBlobAlignment == 0;
+    if (data == nullptr || !isAligned || size < sizeof(internal::IndexBlobHeader))
+        return false;
+
+    const auto& header = *reinterpret_cast<const internal::IndexBlobHeader*>(data);
+    const bool isValidHeader =
+            std::memcmp(header.magic, internal::indexBlobMagic, sizeof(header.magic)) == 0
+            && header.version == internal::indexBlobVersion
+            && header.byteOrderMark == internal::indexBlobByteOrderMark
+            && header.sizeOfBvhNode == sizeof(internal::FlatBvh::Node)
+            && (header.spatialIndex == PointOnFacesProjector::NodeBvhIndex
+                || header.spatialIndex == PointOnFacesProjector::TriangleBvhIndex);
+    if (!isValidHeader)
+        return false;
+
+    const internal::IndexBlobReader reader(data, size);
+    const internal::IndexBlobSlot* blobSlots = nullptr;
+    const internal::IndexBlobBatch* blobBatches = nullptr;
+    if (!reader.get(header.slots, &blobSlots)
+            || !reader.get(header.batches, &blobBatches)
+            || header.batches.count > maxBatchCount)
     {
-        return std::sqrt(m_currMinDist);
+        return false;
+    }
+
+    // Slots are matched in order with the faces, their index data is in the blob
+    m_spatialIndex = static_cast<SpatialIndex>(header.spatialIndex);
+    this->appendSlots(faces);
+    if (m_slots.size() != header.slots.count)
+        return false;
+    for (std::size_t slotId = 0; slotId < m_slots.size(); ++slotId) {
+        internal::TriangulationSlot& slot = m_slots[slotId];
+        const internal::IndexBlobSlot& blobSlot = blobSlots[slotId];
+        const bool isMatching =
+                static_cast<std::uint32_t>(slot.triangulation->NbNodes()) == blobSlot.nodeCount
+                && static_cast<std::uint32_t>(slot.triangulation->NbTriangles())
+                   == blobSlot.triangleCount
+                && blobSlot.batchId < header.batches.count;
+        if (!isMatching)
+            return false;
+        slot.batchId = blobSlot.batchId;
+        slot.firstNodeId = blobSlot.firstNodeId;
+        slot.isRemoved = blobSlot.isRemoved != 0;
+        if (slot.isRemoved)
+            m_removedPrimitiveCount += this->primitiveCount(slot);
     }
 
-    const NodeIndexInTriangulation_t& minDistanceNodeIndex() const
+    if (!reader.get(header.nodeX, &m_nodeX)
+            || !reader.get(header.nodeY, &m_nodeY)
+            || !reader.get(header.nodeZ, &m_nodeZ)
+            || m_nodeY.size() != m_nodeX.size()
+            || m_nodeZ.size() != m_nodeX.size())
     {
-        return m_currMinDistNodeId;
+        return false;
     }
 
-private:
-    const gp_Pnt m_pntToProject;
-    double m_currMinDist;
-    NodeIndexInTriangulation_t m_currMinDistNodeId;
-};
+    const bool isTriangleIndex = m_spatialIndex == PointOnFacesProjector::TriangleBvhIndex;
+    if (isTriangleIndex) {
+        for (const internal::TriangulationSlot& slot : m_slots) {
+            const std::uint64_t endNodeId =
+                    std::uint64_t(slot.firstNodeId) + slot.triangulation->NbNodes();
+            if (endNodeId > m_nodeX.size())
+                return false;
+        }
+    }
 
-static const TopoDS_Face dummyFace;
+    for (std::size_t batchId = 0; batchId < header.batches.count; ++batchId) {
+        const internal::IndexBlobBatch& blobBatch = blobBatches[batchId];
+        internal::IndexBatch batch;
+        const internal::FlatBvh::Node* bvhNodes = nullptr;
+        const std::uint32_t* bvhPrimOrder = nullptr;
+        const bool isReadable =
+                reader.get(blobBatch.bvhNodes, &bvhNodes)
+                && reader.get(blobBatch.bvhPrimitiveOrder, &bvhPrimOrder)
+                && reader.get(blobBatch.primitiveSlotId, &batch.primitiveSlotId)
+                && reader.get(blobBatch.nodeX, &batch.nodeX)
+                && reader.get(blobBatch.nodeY, &batch.nodeY)
+                && reader.get(blobBatch.nodeZ, &batch.nodeZ)
+                && reader.get(blobBatch.nodeIdInTriangulation, &batch.nodeIdInTriangulation)
+                && reader.get(blobBatch.triangleNodes, &batch.triangleNodes)
+                && reader.get(blobBatch.triangleIdInTriangulation,
+                              &batch.triangleIdInTriangulation);
+        if (!isReadable)
+            return false;
 
-} // namespace internal
+        // Consistency of array sizes
+        const std::size_t primCount = batch.primitiveSlotId.size();
+        const std::size_t nodeCount = isTriangleIndex ? 0 : primCount;
+        const std::size_t triangleCount = isTriangleIndex ? primCount : 0;
+        const bool isConsistent =
+                blobBatch.bvhPrimitiveOrder.count == primCount
+                && (primCount == 0) == (blobBatch.bvhNodes.count == 0)
+                && batch.nodeX.size() == nodeCount
+                && batch.nodeY.size() == nodeCount
+                && batch.nodeZ.size() == nodeCount
+                && batch.nodeIdInTriangulation.size() == nodeCount
+                && batch.triangleNodes.size() == 3 * triangleCount
+                && batch.triangleIdInTriangulation.size() == triangleCount;
+        if (!isConsistent)
+            return false;
 
-class PointOnFacesProjector::Private
-{
-public:
-    ~Private();
+        batch.bvh.setExternal(
+                    bvhNodes,
+                    static_cast<std::size_t>(blobBatch.bvhNodes.count),
+                    bvhPrimOrder,
+                    primCount);
+        if (!batch.bvh.isValid()
+                || !this->isValidBatchItems(static_cast<std::uint32_t>(batchId), batch))
+        {
+            return false;
+        }
 
-    void clear();
+        m_batches.push_back(std::move(batch));
+    }
+    this->indexSlotBoxes();
+    return true;
+}
 
-    const TopoDS_Face* triangulationToFace(Poly_Triangulation *tri) const;
-    const TopoDS_Face* triangulationToFace(const Handle_Poly_Triangulation& tri) const;
-    void insertMapping(const Handle_Poly_Triangulation& tri, const TopoDS_Face& face);
+/*! Checks the item values of \p batch loaded from an index blob : slot ids,
+ *  node and triangle ids must be in the range of their slot, otherwise they
+ *  would be used as out-of-bounds indices
+ */
+bool PointOnFacesProjector::Private::isValidBatchItems(
+        std::uint32_t batchId, const internal::IndexBatch& batch) const
+{
+    const bool isTriangleIndex = m_spatialIndex == PointOnFacesProjector::TriangleBvhIndex;
+    for (std::size_t pos = 0; pos < batch.primitiveSlotId.size(); ++pos) {
+        const std::uint32_t slotId = batch.primitiveSlotId[pos];
+        if (slotId >= m_slots.size() || m_slots[slotId].batchId != batchId)
+            return false;
 
-    std::map<const Poly_Triangulation*, TopoDS_Face> m_faceMap;
-    internal::UBTreeOfNodeIndices_t m_ubTree;
-};
+        const internal::TriangulationSlot& slot = m_slots[slotId];
+        if (isTriangleIndex) {
+            const Poly_Array1OfTriangle& triangles = slot.triangulation->Triangles();
+            const std::uint32_t triangleId = batch.triangleIdInTriangulation[pos];
+            if (triangleId < static_cast<std::uint32_t>(triangles.Lower())
+                    || triangleId > static_cast<std::uint32_t>(triangles.Upper()))
+            {
+                return false;
+            }
 
-PointOnFacesProjector::Private::~Private()
+            const std::uint64_t endNodeId =
+                    std::uint64_t(slot.firstNodeId) + slot.triangulation->NbNodes();
+            for (int j = 0; j < 3; ++j) {
+                const std::uint32_t nodeId = batch.triangleNodes[3 * pos + j];
+                if (nodeId < slot.firstNodeId || nodeId >= endNodeId)
+                    return false;
+            }
+        }
+        else {
+            const TColgp_Array1OfPnt& nodes = slot.triangulation->Nodes();
+            const std::uint32_t nodeId = batch.nodeIdInTriangulation[pos];
+            if (nodeId < static_cast<std::uint32_t>(nodes.Lower())
+                    || nodeId > static_cast<std::uint32_t>(nodes.Upper()))
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+//! Closest triangulation node to \p point, the node index is -1 if not found
+internal::NodeIndexInSlot_t
+PointOnFacesProjector::Private::nearestNode(const gp_Pnt& point) const
 {
-    this->clear();
+    if (m_spatialIndex == PointOnFacesProjector::UBTreeIndex) {
+        internal::NodeBndBoxSelector selector(point, m_slots);
+        if (m_ubTree.Select(selector) > 0)
+            return selector.minDistanceNodeIndex();
+        return internal::NodeIndexInSlot_t(-1, 0);
+    }
+
+    internal::NodeIndexInSlot_t minNode(-1, 0);
+    const double pnt[3] = { point.X(), point.Y(), point.Z() };
+    const bool hasRemovedSlots = m_removedPrimitiveCount > 0;
+    double minSqrDist = std::numeric_limits<double>::max();
+    for (const internal::IndexBatch& batch : m_batches) {
+        const double* nodeX = batch.nodeX.data();
+        const double* nodeY = batch.nodeY.data();
+        const double* nodeZ = batch.nodeZ.data();
+        auto fnSqrDist = [&] (std::uint32_t pos, double) {
+            if (hasRemovedSlots && m_slots[batch.primitiveSlotId[pos]].isRemoved)
+                return std::numeric_limits<double>::max();
+            const double dx = nodeX[pos] - pnt[0];
+            const double dy = nodeY[pos] - pnt[1];
+            const double dz = nodeZ[pos] - pnt[2];
+            return dx * dx + dy * dy + dz * dz;
+        };
+        const std::int64_t pos = batch.bvh.nearest(pnt, fnSqrDist, &minSqrDist);
+        if (pos >= 0) {
+            minNode.first = static_cast<int>(batch.nodeIdInTriangulation[pos]);
+            minNode.second = batch.primitiveSlotId[pos];
+        }
+    }
+    return minNode;
 }
 
-void PointOnFacesProjector::Private::clear()
+//! Closest triangle to \p point (TriangleBvhIndex), returns false if not found
+bool PointOnFacesProjector::Private::nearestTriangle(
+        const gp_Pnt& point, internal::TriangleHit* hit) const
 {
-    m_faceMap.clear();
-    m_ubTree.Clear();
+    const double pnt[3] = { point.X(), point.Y(), point.Z() };
+    const bool hasRemovedSlots = m_removedPrimitiveCount > 0;
+    const double* nodeX = m_nodeX.data();
+    const double* nodeY = m_nodeY.data();
+    const double* nodeZ = m_nodeZ.data();
+    auto fnNode = [=] (std::uint32_t nodeId) {
+        return gp_Pnt(nodeX[nodeId], nodeY[nodeId], nodeZ[nodeId]);
+    };
+
+    bool isFound = false;
+    gp_Pnt projPnt;
+    double minSqrDist = std::numeric_limits<double>::max();
+    for (const internal::IndexBatch& batch : m_batches) {
+        auto fnSqrDist = [&] (std::uint32_t pos, double currMinSqrDist) {
+            if (hasRemovedSlots && m_slots[batch.primitiveSlotId[pos]].isRemoved)
+                return std::numeric_limits<double>::max();
+            const std::uint32_t* triNodes = batch.triangleNodes.data() + 3 * pos;
+            const gp_Pnt v0 = fnNode(triNodes[0]);
+            const gp_Pnt v1 = fnNode(triNodes[1]);
+            const gp_Pnt v2 = fnNode(triNodes[2]);
+
+            // Early-out : bounding box of the triangle beyond current minimum
+            internal::FlatBvh::Node triBox;
+            for (int i = 0; i < 3; ++i) {
+                const int c = i + 1;
+                triBox.boxMin[i] = std::min(v0.Coord(c), std::min(v1.Coord(c), v2.Coord(c)));
+                triBox.boxMax[i] = std::max(v0.Coord(c), std::max(v1.Coord(c), v2.Coord(c)));
+            }
+            if (internal::FlatBvh::sqrDistanceToBox(pnt, triBox) >= currMinSqrDist)
+                return std::numeric_limits<double>::max();
+
+            const gp_Pnt triProjPnt =
+                    MathUtils::projectPointOnTriangle(point, v0, v1, v2).first;
+            const double sqrDist = point.SquareDistance(triProjPnt);
+            if (sqrDist < currMinSqrDist)
+                projPnt = triProjPnt;
+            return sqrDist;
+        };
+        const std::int64_t pos = batch.bvh.nearest(pnt, fnSqrDist, &minSqrDist);
+        if (pos >= 0) {
+            isFound = true;
+            hit->slotId = batch.primitiveSlotId[pos];
+            hit->triangleId = static_cast<int>(batch.triangleIdInTriangulation[pos]);
+            hit->projPnt = projPnt;
+        }
+    }
+    return isFound;
 }
 
-const TopoDS_Face*
-PointOnFacesProjector::Private::triangulationToFace(Poly_Triangulation *tri) const
+/*! Slot that is nearest to \p point whatever the spatial index, decided from
+ *  the bounding boxes only
+ *
+ *  This is the case when the farthest corner of the box of a slot is closer
+ *  than the boxes of all other slots : every node and triangle of the slot
+ *  are closer than those of the other slots.
+ *
+ *  \returns \c nullptr if no slot can be told apart by its bounding box
+ */
+const internal::TriangulationSlot*
+PointOnFacesProjector::Private::certainlyNearestSlot(const gp_Pnt& point) const
 {
-    auto it = m_faceMap.find(tri);
-    return it != m_faceMap.end() ? &(it->second) : NULL;
+    const double pnt[3] = { point.X(), point.Y(), point.Z() };
+    const internal::IndexArray<std::uint32_t>& slotIds = m_slotBvh.primitiveOrder();
+    auto fnSqrFarDist = [&] (std::uint32_t pos, double) {
+        const internal::TriangulationSlot& slot = m_slots[slotIds[pos]];
+        if (slot.isRemoved)
+            return std::numeric_limits<double>::max();
+        return internal::FlatBvh::sqrDistanceToFarthestCorner(
+                    pnt, slot.boxMin, slot.boxMax);
+    };
+    double minSqrFarDist = std::numeric_limits<double>::max();
+    const std::int64_t nearestPos = m_slotBvh.nearest(pnt, fnSqrFarDist, &minSqrFarDist);
+    if (nearestPos < 0)
+        return nullptr;
+
+    bool isAmbiguous = false;
+    auto fnCheckSlot = [&] (std::uint32_t pos) {
+        const internal::TriangulationSlot& slot = m_slots[slotIds[pos]];
+        if (pos == nearestPos || slot.isRemoved || isAmbiguous)
+            return;
+        isAmbiguous = internal::sqrDistanceToSlotBox(pnt, slot) <= minSqrFarDist;
+    };
+    m_slotBvh.forEachNear(pnt, minSqrFarDist, fnCheckSlot);
+    return !isAmbiguous ? &m_slots[slotIds[nearestPos]] : nullptr;
 }
 
-const TopoDS_Face*
-PointOnFacesProjector::Private::triangulationToFace(const Handle_Poly_Triangulation& tri) const
+/*! Triangulation nodes within \p maxSqrDist of \p point, at most
+ *  \p maxCount nearest ones, sorted by increasing distance
+ */
+std::vector<PointOnFacesProjector::NodeHit>
+PointOnFacesProjector::Private::collectNodes(
+        const gp_Pnt& point, std::size_t maxCount, double maxSqrDist) const
 {
-    return this->triangulationToFace(tri.operator->());
+    const bool isTriangleIndex = m_spatialIndex == PointOnFacesProjector::TriangleBvhIndex;
+    internal::NodeCollector collector(maxCount, maxSqrDist, isTriangleIndex);
+    const double pnt[3] = { point.X(), point.Y(), point.Z() };
+    const bool hasRemovedSlots = m_removedPrimitiveCount > 0;
+    auto fnSqrDist = [&] (const double coords[3]) {
+        const double dx = coords[0] - pnt[0];
+        const double dy = coords[1] - pnt[1];
+        const double dz = coords[2] - pnt[2];
+        return dx * dx + dy * dy + dz * dz;
+    };
+
+    if (m_spatialIndex == PointOnFacesProjector::UBTreeIndex) {
+        internal::NodeRangeSelector selector(point, m_slots, &collector);
+        m_ubTree.Select(selector);
+    }
+    else if (m_spatialIndex == PointOnFacesProjector::NodeBvhIndex) {
+        for (const internal::IndexBatch& batch : m_batches) {
+            auto fnAddNode = [&] (std::uint32_t pos) {
+                internal::NodeCandidate node;
+                node.slotId = batch.primitiveSlotId[pos];
+                if (hasRemovedSlots && m_slots[node.slotId].isRemoved)
+                    return;
+                node.coords[0] = batch.nodeX[pos];
+                node.coords[1] = batch.nodeY[pos];
+                node.coords[2] = batch.nodeZ[pos];
+                node.sqrDist = fnSqrDist(node.coords);
+                node.nodeId = static_cast<int>(batch.nodeIdInTriangulation[pos]);
+                node.key = pos;
+                collector.add(node);
+            };
+            batch.bvh.forEachNear(pnt, collector.maxSqrDistance(), fnAddNode);
+        }
+    }
+    else if (m_spatialIndex == PointOnFacesProjector::TriangleBvhIndex) {
+        for (const internal::IndexBatch& batch : m_batches) {
+            auto fnAddTriangleNodes = [&] (std::uint32_t pos) {
+                internal::NodeCandidate node;
+                node.slotId = batch.primitiveSlotId[pos];
+                const internal::TriangulationSlot& slot = m_slots[node.slotId];
+                if (hasRemovedSlots && slot.isRemoved)
+                    return;
+                const int nodeLower = slot.triangulation->Nodes().Lower();
+                for (int j = 0; j < 3; ++j) {
+                    // Global node ids are unique over all batches
+                    node.key = batch.triangleNodes[3 * pos + j];
+                    node.coords[0] = m_nodeX[node.key];
+                    node.coords[1] = m_nodeY[node.key];
+                    node.coords[2] = m_nodeZ[node.key];
+                    node.sqrDist = fnSqrDist(node.coords);
+                    node.nodeId = static_cast<int>(node.key - slot.firstNodeId) + nodeLower;
+                    collector.add(node);
+                }
+            };
+            batch.bvh.forEachNear(pnt, collector.maxSqrDistance(), fnAddTriangleNodes);
+        }
+    }
+
+    const std::vector<internal::NodeCandidate> nodes = collector.takeNodes();
+    std::vector<PointOnFacesProjector::NodeHit> hits;
+    hits.reserve(nodes.size());
+    for (const internal::NodeCandidate& node : nodes) {
+        PointOnFacesProjector::NodeHit hit;
+        hit.face = m_slots[node.slotId].stableFace;
+        hit.nodeId = node.nodeId;
+        hit.point.SetCoord(node.coords[0], node.coords[1], node.coords[2]);
+        hit.distance = std::sqrt(node.sqrDist);
+        hits.push_back(hit);
+    }
+    return hits;
 }
 
-void PointOnFacesProjector::Private::insertMapping(
-        const Handle_Poly_Triangulation &tri, const TopoDS_Face &face)
+PointOnFacesProjector::Result
+PointOnFacesProjector::Private::projectedOnTriangles(const gp_Pnt& point) const
 {
-    m_faceMap[tri.operator->()] = face;
+    internal::TriangleHit hit;
+    if (!this->nearestTriangle(point, &hit))
+        return PointOnFacesProjector::Result();
+
+    const internal::TriangulationSlot& slot = m_slots[hit.slotId];
+    const gp_Vec triNormal =
+            slot.normals.triangleNormal(hit.triangleId).Transformed(slot.trsf);
+    return PointOnFacesProjector::Result(slot.face, hit.projPnt, triNormal);
 }
 
 /*! \class PointOnFacesProjector
  *  \brief Provides projection of a point on a soup of faces
  *
+ *  Once prepare() is done, the query functions (faceOfProjection(),
+ *  projected(), ...) only read the internal search structures, so they can be
+ *  called concurrently from several threads.\n
+ *  Functions modifying the loaded faces (prepare(), addFaces(), removeFace(),
+ *  refitFace()) must not run concurrently with queries.
+ *
  *  \headerfile point_on_faces_projector.h <occtools/point_on_faces_projector.h>
  *  \ingroup occtools
  */
@@ -175,6 +1797,39 @@ PointOnFacesProjector::Result::Result()
 {
 }
 
+PointOnFacesProjector::NodeHit::NodeHit()
+    : face(nullptr),
+      nodeId(-1),
+      point(occ::origin3d),
+      distance(0.)
+{
+}
+
+PointOnFacesProjector::PrepareStats::PrepareStats()
+    : meshingTimeMsec(0.),
+      indexingTimeMsec(0.),
+      faceCount(0)
+{
+}
+
+PointOnFacesProjector::MemoryUsage::MemoryUsage()
+    : indexBytes(0),
+      externalIndexBytes(0),
+      faceBytes(0),
+      normalBytes(0)
+{
+}
+
+/*! Returns the count of bytes owned by the projector
+ *
+ *  externalIndexBytes is excluded, that memory belongs to the blob passed to
+ *  loadIndex()
+ */
+std::size_t PointOnFacesProjector::MemoryUsage::totalBytes() const
+{
+    return indexBytes + faceBytes + normalBytes;
+}
+
 // --- PointOnFacesProjector implementation
 
 PointOnFacesProjector::Result::Result(
@@ -191,13 +1846,14 @@ PointOnFacesProjector::PointOnFacesProjector()
 {
 }
 
-/*! \brief Construct a prepared projector (calling prepare(faces))
+/*! \brief Construct a prepared projector (calling prepare(faces, index))
  *
  */
-PointOnFacesProjector::PointOnFacesProjector(const TopoDS_Shape& faces)
+PointOnFacesProjector::PointOnFacesProjector(
+        const TopoDS_Shape& faces, SpatialIndex index)
     : d(new Private)
 {
-    this->prepare(faces);
+    this->prepare(faces, index);
 }
 
 PointOnFacesProjector::~PointOnFacesProjector()
@@ -205,58 +1861,465 @@ PointOnFacesProjector::~PointOnFacesProjector()
     delete d;
 }
 
-void PointOnFacesProjector::prepare(const TopoDS_Shape& faces)
+/*! \brief Setup the projector to work on \p faces
+ *
+ *  Faces must have a triangulation (see BRepMesh), faces without one are
+ *  ignored.\n
+ *  \p index selects the spatial structure used to search the triangulation
+ *  nodes :
+ *    \li UBTreeIndex : NCollection_UBTree where each node has its own Bnd_Box
+ *    \li NodeBvhIndex : flat array of node coordinates plus a compact bounding
+ *        volume hierarchy with 32-bit indices, less memory per node and faster
+ *        queries on big meshes
+ *    \li TriangleBvhIndex : bounding volume hierarchy of the triangles, the
+ *        closest point is searched on the triangles themselves instead of
+ *        refining around the closest node. This gives accurate projections
+ *        even with coarse triangulations
+ */
+void PointOnFacesProjector::prepare(const TopoDS_Shape& faces, SpatialIndex index)
 {
+    CPPTOOLS_PROFILE_ZONE("occ::PointOnFacesProjector::prepare");
+    const auto start = internal::PrepareClock::now();
     d->clear();
-    // Build the UB tree for binary search of points
-    internal::UBTreeOfNodeIndicesFiller_t ubTreeFiller(d->m_ubTree, Standard_False);
-    for (TopExp_Explorer exp(faces, TopAbs_FACE); exp.More(); exp.Next()) {
-        const TopoDS_Face face = TopoDS::Face(exp.Current());
-        if (!face.IsNull()) {
-            TopLoc_Location loc;
-            const auto& triangulation = BRep_Tool::Triangulation(face, loc);
-            if (!triangulation.IsNull()) {
-                d->insertMapping(triangulation, face);
-                const gp_Trsf& trsf = loc.Transformation();
-                const TColgp_Array1OfPnt& nodes = triangulation->Nodes();
-                for (int i = nodes.Lower(); i <= nodes.Upper(); ++i) {
-                    const gp_Pnt iNode(nodes(i).Transformed(trsf));
-                    Bnd_Box ibb;
-                    ibb.Set(iNode);
-                    ubTreeFiller.Add(std::make_pair(i, triangulation), ibb);
-                }
-            }
+    d->m_spatialIndex = index;
+    const std::uint32_t firstSlotId = d->appendSlots(faces);
+    d->indexSlots(firstSlotId, static_cast<std::uint32_t>(d->m_slots.size()));
+
+    d->m_prepareStats = PrepareStats();
+    d->m_prepareStats.indexingTimeMsec = internal::elapsedMsec(start);
+    d->m_prepareStats.faceCount = d->m_slots.size();
+}
+
+/*! \brief Same as prepare() but first triangulates \p faces with
+ *         BRepMesh_IncrementalMesh
+ *
+ *  Faces already having a triangulation finer than \p deflection (absolute)
+ *  are left untouched. Since OpenCascade 6.8 faces are meshed in parallel
+ *  (BRepMesh discretizes the shared edges first, so it is safe unlike meshing
+ *  each face in its own thread).
+ *
+ *  The time spent in meshing and in building the spatial index is available
+ *  with prepareStats()
+ */
+void PointOnFacesProjector::prepareWithMeshing(
+        const TopoDS_Shape& faces, double deflection, SpatialIndex index)
+{
+    const auto start = internal::PrepareClock::now();
+#if OCC_VERSION_HEX >= 0x060800
+    BRepMesh_IncrementalMesh(faces, deflection, Standard_False, 0.5, Standard_True);
+#else
+    BRepMesh_IncrementalMesh(faces, deflection);
+#endif
+    const double meshingTime = internal::elapsedMsec(start);
+    this->prepare(faces, index);
+    d->m_prepareStats.meshingTimeMsec = meshingTime;
+}
+
+//! Returns statistics about the last call to prepare() or prepareWithMeshing()
+PointOnFacesProjector::PrepareStats PointOnFacesProjector::prepareStats() const
+{
+    return d->m_prepareStats;
+}
+
+/*! Returns the memory consumed by the spatial index and the per-face data
+ *
+ *  Triangulations are shared with the faces and are not counted, see
+ *  occ::MemoryReport to account for them.\n
+ *  The UBTreeIndex is estimated from the count of indexed nodes (one leaf and
+ *  about one inner node per node), the exact size depends on the
+ *  NCollection allocator.
+ */
+PointOnFacesProjector::MemoryUsage PointOnFacesProjector::memoryUsage() const
+{
+    MemoryUsage usage;
+    usage.faceBytes =
+            d->m_slots.capacity() * sizeof(internal::TriangulationSlot)
+            + d->m_faces.size() * sizeof(TopoDS_Face);
+    for (const internal::TriangulationSlot& slot : d->m_slots)
+        usage.normalBytes += slot.normals.memoryUsage();
+
+    if (!d->m_ubTree.IsEmpty()) {
+        typedef internal::UBTreeOfNodeIndices_t::TreeNode UBTreeNode_t;
+        usage.indexBytes += 2 * d->m_primitiveCount * sizeof(UBTreeNode_t);
+    }
+
+    usage.indexBytes += d->m_batches.capacity() * sizeof(internal::IndexBatch);
+    for (const internal::IndexBatch& batch : d->m_batches)
+        batch.addMemoryUsage(&usage);
+    internal::addMemoryUsage(d->m_nodeX, &usage);
+    internal::addMemoryUsage(d->m_nodeY, &usage);
+    internal::addMemoryUsage(d->m_nodeZ, &usage);
+    internal::addMemoryUsage(d->m_slotBvh.nodes(), &usage);
+    internal::addMemoryUsage(d->m_slotBvh.primitiveOrder(), &usage);
+    return usage;
+}
+
+/*! \brief Serializes the spatial index built by prepare() (and addFaces())
+ *         into a binary blob
+ *
+ *  The blob holds the flat node/triangle arrays and the BVHs, located with
+ *  offsets so it does not depend on the address it is loaded at. It can be
+ *  written to a file, then memory-mapped read-only by other processes and
+ *  given to loadIndex().\n
+ *  Faces and triangulations are not part of the blob, only their count of
+ *  nodes and triangles to check they match on load.
+ *
+ *  The blob uses the native byte order and is meant to be loaded by the
+ *  same build of the library on the same machine architecture.
+ *
+ *  \returns Empty string with UBTreeIndex (not serializable) or if no face is
+ *           loaded
+ */
+std::string PointOnFacesProjector::saveIndex() const
+{
+    if (d->m_spatialIndex == UBTreeIndex || d->m_slots.empty())
+        return std::string();
+
+    internal::IndexBlobWriter writer;
+    internal::IndexBlobHeader header;
+    std::memset(&header, 0, sizeof(internal::IndexBlobHeader));
+    std::memcpy(header.magic, internal::indexBlobMagic, sizeof(header.magic));
+    header.version = internal::indexBlobVersion;
+    header.byteOrderMark = internal::indexBlobByteOrderMark;
+    header.spatialIndex = static_cast<std::uint32_t>(d->m_spatialIndex);
+    header.sizeOfBvhNode = sizeof(internal::FlatBvh::Node);
+
+    std::vector<internal::IndexBlobSlot> blobSlots;
+    blobSlots.reserve(d->m_slots.size());
+    for (const internal::TriangulationSlot& slot : d->m_slots) {
+        internal::IndexBlobSlot blobSlot;
+        blobSlot.nodeCount = static_cast<std::uint32_t>(slot.triangulation->NbNodes());
+        blobSlot.triangleCount =
+                static_cast<std::uint32_t>(slot.triangulation->NbTriangles());
+        blobSlot.batchId = slot.batchId;
+        blobSlot.firstNodeId = slot.firstNodeId;
+        blobSlot.isRemoved = slot.isRemoved ? 1 : 0;
+        blobSlot.reserved = 0;
+        blobSlots.push_back(blobSlot);
+    }
+    header.slots = writer.append(blobSlots.data(), blobSlots.size());
+
+    std::vector<internal::IndexBlobBatch> blobBatches;
+    blobBatches.reserve(d->m_batches.size());
+    for (const internal::IndexBatch& batch : d->m_batches) {
+        internal::IndexBlobBatch blobBatch;
+        blobBatch.bvhNodes = writer.append(batch.bvh.nodes());
+        blobBatch.bvhPrimitiveOrder = writer.append(batch.bvh.primitiveOrder());
+        blobBatch.primitiveSlotId = writer.append(batch.primitiveSlotId);
+        blobBatch.nodeX = writer.append(batch.nodeX);
+        blobBatch.nodeY = writer.append(batch.nodeY);
+        blobBatch.nodeZ = writer.append(batch.nodeZ);
+        blobBatch.nodeIdInTriangulation = writer.append(batch.nodeIdInTriangulation);
+        blobBatch.triangleNodes = writer.append(batch.triangleNodes);
+        blobBatch.triangleIdInTriangulation =
+                writer.append(batch.triangleIdInTriangulation);
+        blobBatches.push_back(blobBatch);
+    }
+    header.batches = writer.append(blobBatches.data(), blobBatches.size());
+    header.nodeX = writer.append(d->m_nodeX);
+    header.nodeY = writer.append(d->m_nodeY);
+    header.nodeZ = writer.append(d->m_nodeZ);
+    return writer.finish(header);
+}
+
+/*! \brief Setup the projector to work on \p faces with the spatial index
+ *         previously serialized with saveIndex()
+ *
+ *  This replaces prepare() : the index arrays are not copied nor rebuilt,
+ *  they are read in place from \p data, so many processes mapping the same
+ *  index file share its memory. \p data must be 8-byte aligned (as is memory
+ *  returned by mmap() or QFile::map()) and stay valid until the projector is
+ *  destroyed or prepared again. Modifications (addFaces(), removeFace(),
+ *  refitFace()) first copy the affected arrays, \p data is never written.
+ *
+ *  \p faces must explore to the same triangulated faces, in the same order,
+ *  as the faces loaded in the projector that saved the index (typically the
+ *  same shape given to prepare()). Their count of nodes and triangles is
+ *  checked, not their coordinates.
+ *
+ *  \returns \c false (and the projector is left empty) if \p data is not a
+ *           valid index or does not match \p faces
+ */
+bool PointOnFacesProjector::loadIndex(
+        const TopoDS_Shape& faces, const char* data, std::size_t size)
+{
+    const auto start = internal::PrepareClock::now();
+    d->clear();
+    d->m_prepareStats = PrepareStats();
+    if (d->loadIndex(faces, data, size)) {
+        d->m_prepareStats.indexingTimeMsec = internal::elapsedMsec(start);
+        d->m_prepareStats.faceCount = d->m_slots.size();
+        return true;
+    }
+    d->clear();
+    return false;
+}
+
+/*! \brief Adds \p faces to the faces already loaded, without rebuilding the
+ *         whole spatial index
+ *
+ *  The new faces are indexed separately (with the index type given to
+ *  prepare()) and searched along with the previous ones.\n
+ *  When too many separate indexes accumulate, everything is indexed again.
+ */
+void PointOnFacesProjector::addFaces(const TopoDS_Shape& faces)
+{
+    const std::uint32_t firstSlotId = d->appendSlots(faces);
+    const auto endSlotId = static_cast<std::uint32_t>(d->m_slots.size());
+    if (firstSlotId == endSlotId)
+        return;
+    if (d->m_spatialIndex != UBTreeIndex
+            && d->m_batches.size() >= Private::maxBatchCount)
+    {
+        d->rebuild();
+    }
+    else {
+        d->indexSlots(firstSlotId, endSlotId);
+    }
+}
+
+/*! \brief Excludes \p face from the search
+ *
+ *  \p face is matched with TopoDS_Shape::IsSame() against the loaded faces.\n
+ *  Indexed items of the face are just flagged, the spatial index is rebuilt
+ *  once half of the items are removed.
+ *
+ *  \returns \c false if \p face was not loaded
+ */
+bool PointOnFacesProjector::removeFace(const TopoDS_Face& face)
+{
+    bool isFound = false;
+    for (internal::TriangulationSlot& slot : d->m_slots) {
+        if (!slot.isRemoved && slot.face.IsSame(face)) {
+            slot.isRemoved = true;
+            d->m_removedPrimitiveCount += d->primitiveCount(slot);
+            isFound = true;
         }
     }
-    ubTreeFiller.Fill();
+    if (isFound && d->needsRebuild())
+        d->rebuild();
+    return isFound;
+}
+
+/*! \brief Updates the spatial index after the triangulation of \p face moved
+ *
+ *  Same as refitFace(face, face), for triangulation nodes modified in place.
+ */
+bool PointOnFacesProjector::refitFace(const TopoDS_Face& face)
+{
+    return this->refitFace(face, face);
+}
+
+/*! \brief Replaces loaded \p face by \p movedFace, typically the same face
+ *         with a new location or a deformed triangulation
+ *
+ *  When the triangulation of \p movedFace has the same count of nodes and
+ *  triangles as the one of \p face, the node coordinates are updated and the
+ *  bounding volumes refitted, without rebuilding the index.\n
+ *  Otherwise (or with UBTreeIndex, which cannot be refitted) this is the same
+ *  as removeFace(face) followed by addFaces(movedFace).
+ *
+ *  \returns \c false if \p face was not loaded
+ */
+bool PointOnFacesProjector::refitFace(
+        const TopoDS_Face& face, const TopoDS_Face& movedFace)
+{
+    auto itSlot = std::find_if(
+                d->m_slots.begin(),
+                d->m_slots.end(),
+                [&] (const internal::TriangulationSlot& slot) {
+        return !slot.isRemoved && slot.face.IsSame(face);
+    });
+    if (itSlot == d->m_slots.end())
+        return false;
+
+    TopLoc_Location loc;
+    const auto& triangulation = BRep_Tool::Triangulation(movedFace, loc);
+    const bool canRefit =
+            d->m_spatialIndex != UBTreeIndex
+            && !triangulation.IsNull()
+            && triangulation->NbNodes() == itSlot->triangulation->NbNodes()
+            && triangulation->NbTriangles() == itSlot->triangulation->NbTriangles();
+    if (!canRefit) {
+        this->removeFace(face);
+        this->addFaces(movedFace);
+        return true;
+    }
+
+    itSlot->face = movedFace;
+    d->m_faces.push_back(movedFace);
+    itSlot->stableFace = &d->m_faces.back();
+    itSlot->triangulation = triangulation;
+    itSlot->trsf = loc.Transformation();
+    internal::computeSlotBox(&*itSlot);
+    itSlot->normals.load(
+                triangulation,
+                movedFace.Orientation(),
+                Poly_TriangulationNormals::TriangleNormals);
+    d->refitSlot(static_cast<std::uint32_t>(itSlot - d->m_slots.begin()));
+    d->indexSlotBoxes();
+    return true;
 }
 
+/*! \brief Face where \p point would be projected, without computing the
+ *         projection
+ *
+ *  The bounding boxes of the faces are checked first : when one face is
+ *  certainly the nearest (the point is much closer to its box than to any
+ *  other box) it is returned without searching the nodes or triangles.
+ *
+ *  The returned face stays valid until the next prepare(), loadIndex() or
+ *  destruction of the projector, whatever addFaces(), removeFace() or
+ *  refitFace() do meanwhile. This also applies to candidateFaces() and
+ *  NodeHit::face.
+ *
+ *  \returns \c NULL if no face is loaded
+ */
 const TopoDS_Face* PointOnFacesProjector::faceOfProjection(const gp_Pnt& point) const
 {
-    // Find the closest node in the triangulations
-    internal::NodeBndBoxSelector selector(point);
-    if (d->m_ubTree.Select(selector) > 0) {
-        const auto& triangulation = selector.minDistanceNodeIndex().second;
-        return d->triangulationToFace(triangulation);
+    const internal::TriangulationSlot* nearestSlot = d->certainlyNearestSlot(point);
+    if (nearestSlot != nullptr)
+        return nearestSlot->stableFace;
+
+    if (d->m_spatialIndex == TriangleBvhIndex) {
+        internal::TriangleHit hit;
+        if (d->nearestTriangle(point, &hit))
+            return d->m_slots[hit.slotId].stableFace;
+        return NULL;
     }
+
+    // Find the closest node in the triangulations
+    const internal::NodeIndexInSlot_t minNode = d->nearestNode(point);
+    if (minNode.first != -1)
+        return d->m_slots[minNode.second].stableFace;
     return NULL;
 }
 
+/*! \brief Faces whose bounding box is within \p maxDistance of \p point,
+ *         sorted by increasing distance to their box
+ *
+ *  Only the bounding boxes of the face triangulations are tested, so this is
+ *  much cheaper than projected(). The result is a superset of the faces
+ *  having a node or triangle within \p maxDistance, ex: the face of the
+ *  projection is among candidateFaces(point, dist) for any \c dist not less
+ *  than the projection distance.\n
+ *  With \p maxDistance = 0 this returns the faces whose box contains \p point
+ */
+std::vector<const TopoDS_Face*> PointOnFacesProjector::candidateFaces(
+        const gp_Pnt& point, double maxDistance) const
+{
+    const double pnt[3] = { point.X(), point.Y(), point.Z() };
+    const double maxSqrDist = maxDistance * maxDistance;
+    const internal::IndexArray<std::uint32_t>& slotIds = d->m_slotBvh.primitiveOrder();
+    std::vector<std::pair<double, const TopoDS_Face*>> candidates;
+    auto fnAddSlot = [&] (std::uint32_t pos) {
+        const internal::TriangulationSlot& slot = d->m_slots[slotIds[pos]];
+        if (slot.isRemoved)
+            return;
+        const double sqrDist = internal::sqrDistanceToSlotBox(pnt, slot);
+        if (sqrDist <= maxSqrDist)
+            candidates.emplace_back(sqrDist, slot.stableFace);
+    };
+    d->m_slotBvh.forEachNear(pnt, maxSqrDist, fnAddSlot);
+
+    std::stable_sort(
+                candidates.begin(),
+                candidates.end(),
+                [] (const std::pair<double, const TopoDS_Face*>& lhs,
+                    const std::pair<double, const TopoDS_Face*>& rhs)
+    {
+        return lhs.first < rhs.first;
+    });
+    std::vector<const TopoDS_Face*> faces;
+    faces.reserve(candidates.size());
+    for (const auto& candidate : candidates)
+        faces.push_back(candidate.second);
+    return faces;
+}
+
+/*! \brief The \p k triangulation nodes nearest to \p point, sorted by
+ *         increasing distance
+ *
+ *  Nodes are searched in the spatial index built by prepare(), whatever its
+ *  type. A node shared by several faces (ex: on a common edge) is found once
+ *  per face.\n
+ *  Less than \p k nodes are returned if not as many are loaded.
+ */
+std::vector<PointOnFacesProjector::NodeHit> PointOnFacesProjector::nearestNodes(
+        const gp_Pnt& point, std::size_t k) const
+{
+    return d->collectNodes(point, k, std::numeric_limits<double>::max());
+}
+
+/*! \brief All the triangulation nodes within \p radius of \p point, sorted
+ *         by increasing distance
+ *
+ *  \sa nearestNodes()
+ */
+std::vector<PointOnFacesProjector::NodeHit> PointOnFacesProjector::nodesInRadius(
+        const gp_Pnt& point, double radius) const
+{
+    if (radius < 0.)
+        return std::vector<NodeHit>();
+    return d->collectNodes(point, std::numeric_limits<std::size_t>::max(), radius * radius);
+}
+
+/*! \brief Batch version of nearestNodes(), \p results[i] receives the nodes
+ *         nearest to \p points[i]
+ *
+ *  Points are processed concurrently by contiguous chunks, as with the batch
+ *  version of projected()
+ */
+void PointOnFacesProjector::nearestNodes(
+        const gp_Pnt* points,
+        std::size_t count,
+        std::size_t k,
+        std::vector<NodeHit>* results,
+        unsigned threadCount) const
+{
+    const std::size_t minChunkSize = 256;
+    auto fnChunk = [=] (std::size_t iBegin, std::size_t iEnd) {
+        for (std::size_t i = iBegin; i < iEnd; ++i)
+            results[i] = this->nearestNodes(points[i], k);
+    };
+    cpp::parallelForRanges(count, fnChunk, threadCount, minChunkSize);
+}
+
+//! Batch version of nodesInRadius(), see nearestNodes()
+void PointOnFacesProjector::nodesInRadius(
+        const gp_Pnt* points,
+        std::size_t count,
+        double radius,
+        std::vector<NodeHit>* results,
+        unsigned threadCount) const
+{
+    const std::size_t minChunkSize = 256;
+    auto fnChunk = [=] (std::size_t iBegin, std::size_t iEnd) {
+        for (std::size_t i = iBegin; i < iEnd; ++i)
+            results[i] = this->nodesInRadius(points[i], radius);
+    };
+    cpp::parallelForRanges(count, fnChunk, threadCount, minChunkSize);
+}
+
 PointOnFacesProjector::Result PointOnFacesProjector::projected(const gp_Pnt& point) const
 {
+    if (d->m_spatialIndex == TriangleBvhIndex)
+        return d->projectedOnTriangles(point);
+
     // Find the closest node in the triangulations
-    internal::NodeBndBoxSelector selector(point);
-    if (d->m_ubTree.Select(selector) <= 0)
+    const internal::NodeIndexInSlot_t minNode = d->nearestNode(point);
+    if (minNode.first == -1)
         return PointOnFacesProjector::Result();
 
-    const int minNodeId = selector.minDistanceNodeIndex().first;
-    const auto& triangulation = selector.minDistanceNodeIndex().second;
+    const int minNodeId = minNode.first;
+    const internal::TriangulationSlot& slot = d->m_slots[minNode.second];
+    const auto& triangulation = slot.triangulation;
 
     // Find the triangle where distance is minimum
     const TColgp_Array1OfPnt& nodes = triangulation->Nodes();
     const Poly_Array1OfTriangle& triangles = triangulation->Triangles();
     double minDist = std::numeric_limits<double>::max();
-    const Poly_Triangle* minTriangle = NULL;
+    int minTriangleId = -1;
     gp_Pnt projectedPnt;
     for (int iTri = triangles.Lower(); iTri <= triangles.Upper(); iTri++) {
         const Poly_Triangle& t = triangles(iTri);
@@ -265,30 +2328,54 @@ PointOnFacesProjector::Result PointOnFacesProjector::projected(const gp_Pnt& poi
         if (minNodeId == n1 || minNodeId == n2 || minNodeId == n3) {
             const auto projPntInfo =
                     MathUtils::projectPointOnTriangle(
-                        point, nodes(t(1)), nodes(t(2)), nodes(t(3)));
+                        point,
+                        nodes(t(1)).Transformed(slot.trsf),
+                        nodes(t(2)).Transformed(slot.trsf),
+                        nodes(t(3)).Transformed(slot.trsf));
             const double dist = point.SquareDistance(projPntInfo.first);
             if (dist < minDist) {
-                minTriangle = &t;
+                minTriangleId = iTri;
                 minDist = dist;
                 projectedPnt = projPntInfo.first;
             }
         }
     }
 
-    if (minTriangle != NULL) {
-        const TopoDS_Face* face = d->triangulationToFace(triangulation);
-        const TopAbs_Orientation faceOrientation =
-                face != NULL ? face->Orientation() : TopAbs_FORWARD;
-        const gp_Vec triNormal = occ::MathUtils::triangleNormal(
-                    nodes, *minTriangle, faceOrientation);
-        return PointOnFacesProjector::Result(
-                    face != NULL ? *face : TopoDS_Face(),
-                    projectedPnt,
-                    triNormal);
+    if (minTriangleId != -1) {
+        const gp_Vec triNormal =
+                slot.normals.triangleNormal(minTriangleId).Transformed(slot.trsf);
+        return PointOnFacesProjector::Result(slot.face, projectedPnt, triNormal);
     }
     return PointOnFacesProjector::Result();
 }
 
+/*! \brief Projects the array of \p count points in \p points
+ *
+ *  This is equivalent to calling projected(points[i]) for each point, but the
+ *  input array is partitioned into contiguous chunks processed concurrently.
+ *  The search structures built by prepare() are shared (read-only) by all
+ *  threads.
+ *
+ *  \param results  Output array of at least \p count items, \p results[i]
+ *                  receives the projection of \p points[i]
+ *  \param threadCount  Maximum count of threads to use (0 means as many as
+ *                      the hardware supports)
+ */
+void PointOnFacesProjector::projected(
+        const gp_Pnt* points,
+        std::size_t count,
+        Result* results,
+        unsigned threadCount) const
+{
+    // There is little to gain from a thread below this count of points
+    const std::size_t minChunkSize = 256;
+    auto fnProjectChunk = [=] (std::size_t iBegin, std::size_t iEnd) {
+        for (std::size_t i = iBegin; i < iEnd; ++i)
+            results[i] = this->projected(points[i]);
+    };
+    cpp::parallelForRanges(count, fnProjectChunk, threadCount, minChunkSize);
+}
+
 //! Syntactic sugar around projected()
 PointOnFacesProjector::Result
 PointOnFacesProjector::operator()(const gp_Pnt& point) const
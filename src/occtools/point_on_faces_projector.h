@@ -20,6 +20,9 @@
 #include <gp_Vec.hxx>
 #include <gp_Pnt.hxx>
 #include <TopoDS_Face.hxx>
+#include <cstddef>
+#include <string>
+#include <vector>
 class TopoDS_Shape;
 
 namespace occ {
@@ -33,19 +36,92 @@ public:
         Result(const TopoDS_Face& sFace,
                const gp_Pnt& sPoint,
                const gp_Vec& sNormal);
-        const bool isValid;
-        const TopoDS_Face face;
-        const gp_Pnt point;
-        const gp_Vec normal;
+        bool isValid;
+        TopoDS_Face face;
+        gp_Pnt point;
+        gp_Vec normal;
+    };
+
+    struct OCCTOOLS_EXPORT NodeHit
+    {
+        NodeHit();
+        const TopoDS_Face* face; // Valid until next prepare(), see faceOfProjection()
+        int nodeId; // Index in the triangulation nodes of the face
+        gp_Pnt point;
+        double distance;
+    };
+
+    enum SpatialIndex
+    {
+        UBTreeIndex,
+        NodeBvhIndex,
+        TriangleBvhIndex
+    };
+
+    struct OCCTOOLS_EXPORT PrepareStats
+    {
+        PrepareStats();
+        double meshingTimeMsec;
+        double indexingTimeMsec;
+        std::size_t faceCount;
+    };
+
+    struct OCCTOOLS_EXPORT MemoryUsage
+    {
+        MemoryUsage();
+        std::size_t indexBytes;
+        std::size_t externalIndexBytes;
+        std::size_t faceBytes;
+        std::size_t normalBytes;
+        std::size_t totalBytes() const;
     };
 
     PointOnFacesProjector();
-    PointOnFacesProjector(const TopoDS_Shape& faces);
+    PointOnFacesProjector(
+            const TopoDS_Shape& faces, SpatialIndex index = UBTreeIndex);
     ~PointOnFacesProjector();
 
-    void prepare(const TopoDS_Shape& faces);
+    void prepare(const TopoDS_Shape& faces, SpatialIndex index = UBTreeIndex);
+    void prepareWithMeshing(
+            const TopoDS_Shape& faces,
+            double deflection,
+            SpatialIndex index = UBTreeIndex);
+    PrepareStats prepareStats() const;
+    MemoryUsage memoryUsage() const;
+
+    std::string saveIndex() const;
+    bool loadIndex(const TopoDS_Shape& faces, const char* data, std::size_t size);
+
+    void addFaces(const TopoDS_Shape& faces);
+    bool removeFace(const TopoDS_Face& face);
+    bool refitFace(const TopoDS_Face& face);
+    bool refitFace(const TopoDS_Face& face, const TopoDS_Face& movedFace);
+
     const TopoDS_Face* faceOfProjection(const gp_Pnt& point) const;
+    std::vector<const TopoDS_Face*> candidateFaces(
+            const gp_Pnt& point, double maxDistance) const;
+
+    std::vector<NodeHit> nearestNodes(const gp_Pnt& point, std::size_t k) const;
+    std::vector<NodeHit> nodesInRadius(const gp_Pnt& point, double radius) const;
+    void nearestNodes(
+            const gp_Pnt* points,
+            std::size_t count,
+            std::size_t k,
+            std::vector<NodeHit>* results,
+            unsigned threadCount = 0) const;
+    void nodesInRadius(
+            const gp_Pnt* points,
+            std::size_t count,
+            double radius,
+            std::vector<NodeHit>* results,
+            unsigned threadCount = 0) const;
+
     Result projected(const gp_Pnt& point) const;
+    void projected(
+            const gp_Pnt* points,
+            std::size_t count,
+            Result* results,
+            unsigned threadCount = 0) const;
     Result operator()(const gp_Pnt& point) const;
 
 private:
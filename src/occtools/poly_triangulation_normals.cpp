@@ -0,0 +1,179 @@
+/****************************************************************************
+**  FougTools
+**  Copyright Fougue (30 Mar. 2015)
+**  contact@fougue.pro
+**
+** This software is a computer program whose purpose is to provide utility
+** tools for the C++ language and the Qt toolkit.
+**
+** This software is governed by the CeCILL-C license under French law and
+** abiding by the rules of distribution of free software.  You can  use,
+** modify and/ or redistribute the software under the terms of the CeCILL-C
+** license as circulated by CEA, CNRS and INRIA at the following URL
+** "http://www.cecill.info".
+****************************************************************************/
+
+
+#include "poly_triangulation_normals.h"
+
+#include <Poly_Triangulation.hxx>
+#include <cassert>
+#include <cmath>
+
+namespace occ {
+
+/*! \class Poly_TriangulationNormals
+ *  \brief Normals of the triangles and nodes of a Poly_Triangulation,
+ *         computed once
+ *
+ *  Triangle normals are the same vectors as returned by
+ *  MathUtils::triangleNormal() (so not normalized), they are computed in one
+ *  pass over the triangulation instead of on each query.\n
+ *  Node normals are the normalized sum of the normals of the (non-degenerate)
+ *  triangles around each node, which weights them by triangle area. A node not
+ *  used by any valid triangle gets a null normal.
+ *
+ *  Normals are expressed in the local frame of the triangulation, ie
+ *  the location of the face is not applied.
+ *
+ *  Items are accessed with the indexes of the triangulation (usually starting
+ *  at 1), as for Poly_Triangulation::Triangles() and
+ *  Poly_Triangulation::Nodes()
+ *
+ *  \headerfile poly_triangulation_normals.h <occtools/poly_triangulation_normals.h>
+ *  \ingroup occtools
+ */
+
+Poly_TriangulationNormals::Poly_TriangulationNormals()
+    : m_triangleLower(1),
+      m_nodeLower(1)
+{
+}
+
+Poly_TriangulationNormals::Poly_TriangulationNormals(
+        const Handle_Poly_Triangulation &triangulation,
+        TopAbs_Orientation ori,
+        int types)
+    : m_triangleLower(1),
+      m_nodeLower(1)
+{
+    this->load(triangulation, ori, types);
+}
+
+/*! Computes the normals of \p triangulation, previous normals are cleared
+ *
+ *  \param ori  Orientation of the triangles (generally inherited from the
+ *              triangulated face), TopAbs_REVERSED flips all normals
+ *  \param types  Combination of NormalType flags, telling which normals are
+ *                computed
+ */
+void Poly_TriangulationNormals::load(
+        const Handle_Poly_Triangulation &triangulation,
+        TopAbs_Orientation ori,
+        int types)
+{
+    this->clear();
+    if (triangulation.IsNull())
+        return;
+
+    const TColgp_Array1OfPnt& nodes = triangulation->Nodes();
+    const Poly_Array1OfTriangle& triangles = triangulation->Triangles();
+    const bool withTriangleNormals = (types & TriangleNormals) != 0;
+    const bool withNodeNormals = (types & NodeNormals) != 0;
+    m_triangleLower = triangles.Lower();
+    m_nodeLower = nodes.Lower();
+    if (withTriangleNormals)
+        m_triangleNormals.reserve(triangles.Length());
+    if (withNodeNormals)
+        m_nodeNormals.assign(nodes.Length(), gp_Vec(0., 0., 0.));
+
+    for (int i = triangles.Lower(); i <= triangles.Upper(); ++i) {
+        Standard_Integer n1, n2, n3;
+        if (ori == TopAbs_REVERSED)
+            triangles(i).Get(n1, n3, n2);
+        else
+            triangles(i).Get(n1, n2, n3);
+        assert(nodes.Lower() <= n1 && n1 <= nodes.Upper());
+        assert(nodes.Lower() <= n2 && n2 <= nodes.Upper());
+        assert(nodes.Lower() <= n3 && n3 <= nodes.Upper());
+        const gp_Vec v1(nodes(n1), nodes(n2));
+        const gp_Vec v2(nodes(n2), nodes(n3));
+        const gp_Vec v3(nodes(n3), nodes(n1));
+        const bool isValid =
+                v1.SquareMagnitude() > 1.e-10
+                && v2.SquareMagnitude() > 1.e-10
+                && v3.SquareMagnitude() > 1.e-10;
+        const gp_Vec normal = isValid ? v1.Crossed(v2) : v1;
+
+        if (withTriangleNormals)
+            m_triangleNormals.push_back(normal);
+        if (withNodeNormals && isValid) {
+            m_nodeNormals[n1 - m_nodeLower] += normal;
+            m_nodeNormals[n2 - m_nodeLower] += normal;
+            m_nodeNormals[n3 - m_nodeLower] += normal;
+        }
+    }
+
+    for (gp_Vec& normal : m_nodeNormals) {
+        const Standard_Real magnitude = normal.Magnitude();
+        if (magnitude > 1.e-10)
+            normal /= magnitude;
+        else
+            normal.SetCoord(0., 0., 0.);
+    }
+}
+
+void Poly_TriangulationNormals::clear()
+{
+    m_triangleNormals.clear();
+    m_nodeNormals.clear();
+    m_triangleLower = 1;
+    m_nodeLower = 1;
+}
+
+bool Poly_TriangulationNormals::isEmpty() const
+{
+    return m_triangleNormals.empty() && m_nodeNormals.empty();
+}
+
+bool Poly_TriangulationNormals::hasTriangleNormals() const
+{
+    return !m_triangleNormals.empty();
+}
+
+bool Poly_TriangulationNormals::hasNodeNormals() const
+{
+    return !m_nodeNormals.empty();
+}
+
+//! Returns the count of bytes allocated for the normals
+std::size_t Poly_TriangulationNormals::memoryUsage() const
+{
+    return (m_triangleNormals.capacity() + m_nodeNormals.capacity()) * sizeof(gp_Vec);
+}
+
+/*! Returns the normal of triangle \p triangleId, as MathUtils::triangleNormal()
+ *  would (not normalized)
+ *
+ *  \pre hasTriangleNormals()
+ */
+const gp_Vec &Poly_TriangulationNormals::triangleNormal(int triangleId) const
+{
+    assert(m_triangleLower <= triangleId);
+    assert(triangleId - m_triangleLower < static_cast<int>(m_triangleNormals.size()));
+    return m_triangleNormals[triangleId - m_triangleLower];
+}
+
+/*! Returns the normalized normal at node \p nodeId, or a null vector for an
+ *  isolated node
+ *
+ *  \pre hasNodeNormals()
+ */
+const gp_Vec &Poly_TriangulationNormals::nodeNormal(int nodeId) const
+{
+    assert(m_nodeLower <= nodeId);
+    assert(nodeId - m_nodeLower < static_cast<int>(m_nodeNormals.size()));
+    return m_nodeNormals[nodeId - m_nodeLower];
+}
+
+} // namespace occ
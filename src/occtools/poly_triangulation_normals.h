@@ -0,0 +1,67 @@
+/****************************************************************************
+**  FougTools
+**  Copyright Fougue (30 Mar. 2015)
+**  contact@fougue.pro
+**
+** This software is a computer program whose purpose is to provide utility
+** tools for the C++ language and the Qt toolkit.
+**
+** This software is governed by the CeCILL-C license under French law and
+** abiding by the rules of distribution of free software.  You can  use,
+** modify and/ or redistribute the software under the terms of the CeCILL-C
+** license as circulated by CEA, CNRS and INRIA at the following URL
+** "http://www.cecill.info".
+****************************************************************************/
+
+
+#pragma once
+
+#include "occtools.h"
+
+#include <Handle_Poly_Triangulation.hxx>
+#include <TopAbs_Orientation.hxx>
+#include <gp_Vec.hxx>
+
+#include <cstddef>
+#include <vector>
+
+namespace occ {
+
+class OCCTOOLS_EXPORT Poly_TriangulationNormals
+{
+public:
+    enum NormalType
+    {
+        TriangleNormals = 0x01,
+        NodeNormals = 0x02,
+        AllNormals = TriangleNormals | NodeNormals
+    };
+
+    Poly_TriangulationNormals();
+    explicit Poly_TriangulationNormals(
+            const Handle_Poly_Triangulation& triangulation,
+            TopAbs_Orientation ori = TopAbs_FORWARD,
+            int types = AllNormals);
+
+    void load(
+            const Handle_Poly_Triangulation& triangulation,
+            TopAbs_Orientation ori = TopAbs_FORWARD,
+            int types = AllNormals);
+    void clear();
+
+    bool isEmpty() const;
+    bool hasTriangleNormals() const;
+    bool hasNodeNormals() const;
+    std::size_t memoryUsage() const;
+
+    const gp_Vec& triangleNormal(int triangleId) const;
+    const gp_Vec& nodeNormal(int nodeId) const;
+
+private:
+    std::vector<gp_Vec> m_triangleNormals;
+    std::vector<gp_Vec> m_nodeNormals;
+    int m_triangleLower;
+    int m_nodeLower;
+};
+
+} // namespace occ
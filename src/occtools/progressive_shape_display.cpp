@@ -0,0 +1,249 @@
+/****************************************************************************
+**  FougTools
+**  Copyright Fougue (30 Mar. 2015)
+**  contact@fougue.pro
+**
+** This software is a computer program whose purpose is to provide utility
+** tools for the C++ language and the Qt toolkit.
+**
+** This software is governed by the CeCILL-C license under French law and
+** abiding by the rules of distribution of free software.  You can  use,
+** modify and/ or redistribute the software under the terms of the CeCILL-C
+** license as circulated by CEA, CNRS and INRIA at the following URL
+** "http://www.cecill.info".
+****************************************************************************/
+
+#include "progressive_shape_display.h"
+
+#include "../qttools/task/manager.h"
+
+#include <AIS_InteractiveContext.hxx>
+#include <AIS_Shape.hxx>
+#include <Aspect_TypeOfDeflection.hxx>
+#include <BRepBndLib.hxx>
+#include <BRepMesh_IncrementalMesh.hxx>
+#include <BRep_Builder.hxx>
+#include <Bnd_Box.hxx>
+#include <Prs3d_Drawer.hxx>
+#include <Standard_Version.hxx>
+#include <TopExp.hxx>
+#include <TopTools_IndexedMapOfShape.hxx>
+#include <TopoDS.hxx>
+#include <TopoDS_Compound.hxx>
+
+#include <QtCore/QCoreApplication>
+#include <QtCore/QTimer>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <memory>
+
+namespace occ {
+
+namespace internal {
+
+//! State shared by a ProgressiveShapeDisplay and its background task
+struct ProgressiveDisplayJob
+{
+    ProgressiveDisplayJob()
+        : isAborted(false),
+          isFinished(false)
+    { }
+
+    std::atomic<bool> isAborted;
+    std::atomic<bool> isFinished;
+};
+
+} // namespace internal
+
+class ProgressiveShapeDisplay::Private
+{
+public:
+    Private(const Handle_AIS_InteractiveContext& context)
+        : m_context(context),
+          m_deflection(0.),
+          m_batchSize(1000)
+    { }
+
+    void displayBatch(const TopoDS_Compound& batch, double deflection)
+    {
+        Handle_AIS_Shape aisShape = new AIS_Shape(batch);
+        // Use the triangulation computed in the background task, prevents
+        // AIS from meshing again in the main thread
+        const Handle_Prs3d_Drawer& drawer = aisShape->Attributes();
+        drawer->SetTypeOfDeflection(Aspect_TOD_ABSOLUTE);
+        drawer->SetMaximalChordialDeviation(deflection);
+#if OCC_VERSION_HEX >= 0x060900
+        drawer->SetAutoTriangulation(Standard_False);
+#endif
+        aisShape->SetDisplayMode(AIS_Shaded);
+        m_context->Display(aisShape, Standard_False);
+        m_context->UpdateCurrentViewer();
+        m_displayedObjects.push_back(aisShape);
+    }
+
+    Handle_AIS_InteractiveContext m_context;
+    double m_deflection;
+    int m_batchSize;
+    std::shared_ptr<internal::ProgressiveDisplayJob> m_job;
+    std::vector<Handle_AIS_InteractiveObject> m_displayedObjects;
+};
+
+/*! \class ProgressiveShapeDisplay
+ *  \brief Displays a shape in an interactive context by batches of faces
+ *         meshed in a background task
+ *
+ *  display() returns immediately : a qttask::Runner<QThread> task meshes the
+ *  faces of the shape by batches of batchSize() faces, and each batch is then
+ *  displayed in the main thread as a shaded AIS_Shape. So the model appears
+ *  incrementally and the main thread never waits for meshing of the whole
+ *  shape.
+ *
+ *  The task is registered in qttask::Manager::globalInstance(), so its
+ *  progress can be followed by the usual task notifications.
+ *
+ *  \headerfile progressive_shape_display.h <occtools/progressive_shape_display.h>
+ *  \ingroup occtools
+ */
+
+ProgressiveShapeDisplay::ProgressiveShapeDisplay(
+        const Handle_AIS_InteractiveContext& context, QObject* parent)
+    : QObject(parent),
+      d(new Private(context))
+{
+}
+
+//! Aborts the running task, if any. Displayed objects are kept in context()
+ProgressiveShapeDisplay::~ProgressiveShapeDisplay()
+{
+    this->abort();
+    delete d;
+}
+
+Handle_AIS_InteractiveContext ProgressiveShapeDisplay::context() const
+{
+    return d->m_context;
+}
+
+/*! \brief Returns the absolute deflection used to mesh faces
+ *
+ *  Default is 0, meaning the deflection is computed from the size of the
+ *  shape to display (0.001 of its bounding box diagonal)
+ */
+double ProgressiveShapeDisplay::deflection() const
+{
+    return d->m_deflection;
+}
+
+void ProgressiveShapeDisplay::setDeflection(double value)
+{
+    d->m_deflection = value;
+}
+
+//! Returns the count of faces meshed and displayed at once (default is 1000)
+int ProgressiveShapeDisplay::batchSize() const
+{
+    return d->m_batchSize;
+}
+
+void ProgressiveShapeDisplay::setBatchSize(int faceCount)
+{
+    d->m_batchSize = std::max(faceCount, 1);
+}
+
+/*! \brief Starts progressive display of \p shape
+ *
+ *  Any display in progress is aborted first. Signal batchDisplayed() is
+ *  emitted each time a batch of faces is displayed, then finished() once all
+ *  faces are displayed (not emitted on abort).
+ *
+ *  \note Faces of \p shape are meshed concurrently with the display of the
+ *        previous batches, so \p shape must not be modified until finished()
+ */
+void ProgressiveShapeDisplay::display(const TopoDS_Shape& shape)
+{
+    this->abort();
+    auto job = std::make_shared<internal::ProgressiveDisplayJob>();
+    d->m_job = job;
+    const int batchSize = d->m_batchSize;
+    const double userDeflection = d->m_deflection;
+
+    auto task = qttask::Manager::globalInstance()->newTask<QThread>();
+    task->setTaskTitle(tr("Progressive display"));
+    task->run([=] {
+        TopTools_IndexedMapOfShape mapFace;
+        TopExp::MapShapes(shape, TopAbs_FACE, mapFace);
+        const int faceCount = mapFace.Extent();
+
+        double deflection = userDeflection;
+        if (deflection <= 0.) {
+            Bnd_Box box;
+            BRepBndLib::Add(shape, box);
+            deflection = box.IsVoid() ? 0.1 : 0.001 * std::sqrt(box.SquareExtent());
+        }
+
+        for (int iBegin = 1; iBegin <= faceCount; iBegin += batchSize) {
+            if (job->isAborted || task->progress().isAbortRequested())
+                return;
+
+            const int iEnd = std::min(iBegin + batchSize, faceCount + 1);
+            TopoDS_Compound batch;
+            BRep_Builder builder;
+            builder.MakeCompound(batch);
+            for (int i = iBegin; i < iEnd; ++i) {
+                const TopoDS_Face& face = TopoDS::Face(mapFace.FindKey(i));
+                BRepMesh_IncrementalMesh(face, deflection);
+                builder.Add(batch, face);
+            }
+
+            const int displayedFaceCount = iEnd - 1;
+            const bool isLastBatch = displayedFaceCount == faceCount;
+            // Lambda executed in the main thread, where "this" can be
+            // destroyed only after job->isAborted is set
+            QTimer::singleShot(0, QCoreApplication::instance(), [=] {
+                if (job->isAborted)
+                    return;
+                d->displayBatch(batch, deflection);
+                emit batchDisplayed(displayedFaceCount, faceCount);
+                if (isLastBatch) {
+                    job->isFinished = true;
+                    emit finished();
+                }
+            });
+            task->progress().setValue((100 * displayedFaceCount) / faceCount);
+        }
+
+        if (faceCount == 0) {
+            QTimer::singleShot(0, QCoreApplication::instance(), [=] {
+                if (job->isAborted)
+                    return;
+                job->isFinished = true;
+                emit finished();
+            });
+        }
+    });
+}
+
+//! Stops the display in progress, already displayed batches are kept
+void ProgressiveShapeDisplay::abort()
+{
+    if (d->m_job)
+        d->m_job->isAborted = true;
+    d->m_job.reset();
+}
+
+//! Is a display in progress ?
+bool ProgressiveShapeDisplay::isRunning() const
+{
+    return d->m_job && !d->m_job->isFinished;
+}
+
+//! Returns the AIS objects created by display(), one per batch of faces
+std::vector<Handle_AIS_InteractiveObject>
+ProgressiveShapeDisplay::displayedObjects() const
+{
+    return d->m_displayedObjects;
+}
+
+} // namespace occ
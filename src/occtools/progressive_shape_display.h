@@ -0,0 +1,63 @@
+/****************************************************************************
+**  FougTools
+**  Copyright Fougue (30 Mar. 2015)
+**  contact@fougue.pro
+**
+** This software is a computer program whose purpose is to provide utility
+** tools for the C++ language and the Qt toolkit.
+**
+** This software is governed by the CeCILL-C license under French law and
+** abiding by the rules of distribution of free software.  You can  use,
+** modify and/ or redistribute the software under the terms of the CeCILL-C
+** license as circulated by CEA, CNRS and INRIA at the following URL
+** "http://www.cecill.info".
+****************************************************************************/
+
+#pragma once
+
+#include "occtools.h"
+
+#include <Handle_AIS_InteractiveContext.hxx>
+#include <Handle_AIS_InteractiveObject.hxx>
+#include <TopoDS_Shape.hxx>
+
+#include <QtCore/QObject>
+
+#include <vector>
+
+namespace occ {
+
+class OCCTOOLS_EXPORT ProgressiveShapeDisplay : public QObject
+{
+    Q_OBJECT
+
+public:
+    ProgressiveShapeDisplay(
+            const Handle_AIS_InteractiveContext& context,
+            QObject* parent = NULL);
+    ~ProgressiveShapeDisplay();
+
+    Handle_AIS_InteractiveContext context() const;
+
+    double deflection() const;
+    void setDeflection(double value);
+
+    int batchSize() const;
+    void setBatchSize(int faceCount);
+
+    void display(const TopoDS_Shape& shape);
+    void abort();
+    bool isRunning() const;
+
+    std::vector<Handle_AIS_InteractiveObject> displayedObjects() const;
+
+signals:
+    void batchDisplayed(int displayedFaceCount, int totalFaceCount);
+    void finished();
+
+private:
+    class Private;
+    Private* const d;
+};
+
+} // namespace occ
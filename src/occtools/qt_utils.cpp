@@ -15,6 +15,8 @@
 
 #include "qt_utils.h"
 
+#include "kernel_utils.h"
+
 namespace occ {
 
 //! Conversion of the Quantity_Color \p c to a QColor
@@ -33,9 +35,7 @@ QColor QtUtils::toQColor(const Quantity_NameOfColor c)
 //! Conversion of the QColor \p c to a Quantity_Color
 Quantity_Color QtUtils::toOccColor(const QColor& c)
 {
-    return Quantity_Color(
-                c.red() / 255., c.green() / 255., c.blue() / 255.,
-                Quantity_TOC_RGB);
+    return KernelUtils::rgbColor(c.red(), c.green(), c.blue());
 }
 
 //! Conversion of the QColor object \p c to a Quantity_NameOfColor
@@ -44,6 +44,42 @@ Quantity_NameOfColor QtUtils::toOccNameOfColor(const QColor& c)
     return QtUtils::toOccColor(c).Name();
 }
 
+//! Converts the \p count colors of array \p colors into array \p qcolors
+void QtUtils::toQColors(
+        const Quantity_Color* colors, std::size_t count, QColor* qcolors)
+{
+    for (std::size_t i = 0; i < count; ++i) {
+        if (i > 0 && colors[i].IsEqual(colors[i - 1]))
+            qcolors[i] = qcolors[i - 1];
+        else
+            qcolors[i] = QtUtils::toQColor(colors[i]);
+    }
+}
+
+/*! Converts the \p count colors of array \p colors into array \p occColors
+ *
+ *  A run of identical colors is converted once
+ */
+void QtUtils::toOccColors(
+        const QColor* colors, std::size_t count, Quantity_Color* occColors)
+{
+    for (std::size_t i = 0; i < count; ++i) {
+        if (i > 0 && colors[i].rgb() == colors[i - 1].rgb())
+            occColors[i] = occColors[i - 1];
+        else
+            occColors[i] = KernelUtils::rgbColor(colors[i].rgb());
+    }
+}
+
+//! Same as toOccColors() for an array of packed QRgb values
+void QtUtils::toOccColors(
+        const QRgb* rgbs, std::size_t count, Quantity_Color* occColors)
+{
+    static_assert(sizeof(QRgb) == sizeof(std::uint32_t), "QRgb must be 32-bit");
+    KernelUtils::rgbColors(
+                reinterpret_cast<const std::uint32_t*>(rgbs), count, occColors);
+}
+
 //! Conversion of the QString \p str to an OCC TCollection_AsciiString
 //! containing the latin1 representation of \p str
 TCollection_AsciiString QtUtils::toOccLatin1String(const QString &str)
@@ -114,4 +150,84 @@ QString QtUtils::toQString(const TCollection_ExtendedString& str)
     return QtUtils::toQString(str.ToExtString(), str.Length());
 }
 
+/*! \class QtColorCache
+ *  \brief Palette of the QColor -> OpenCascade color conversions already done
+ *
+ *  Coloring parts face by face converts the same few colors millions of times,
+ *  QtColorCache converts each distinct RGB value once. This matters most for
+ *  toOccNameOfColor() as Quantity_Color::Name() searches the nearest color
+ *  among all the named ones.
+ *
+ *  Alpha is ignored. QtColorCache is not thread-safe, use one cache per thread.
+ *
+ *  \headerfile qt_utils.h <occtools/qt_utils.h>
+ *  \ingroup occtools
+ */
+
+QtColorCache::Entry::Entry(const Quantity_Color& c)
+    : color(c),
+      name(-1)
+{ }
+
+//! Cached result of QtUtils::toOccColor()
+const Quantity_Color& QtColorCache::toOccColor(const QColor& c)
+{
+    return this->entry(c.rgb()).color;
+}
+
+const Quantity_Color& QtColorCache::toOccColor(QRgb rgb)
+{
+    return this->entry(rgb).color;
+}
+
+//! Cached result of QtUtils::toOccNameOfColor()
+Quantity_NameOfColor QtColorCache::toOccNameOfColor(const QColor& c)
+{
+    return this->toOccNameOfColor(c.rgb());
+}
+
+Quantity_NameOfColor QtColorCache::toOccNameOfColor(QRgb rgb)
+{
+    Entry& e = this->entry(rgb);
+    if (e.name < 0)
+        e.name = static_cast<int>(e.color.Name());
+    return static_cast<Quantity_NameOfColor>(e.name);
+}
+
+//! Batch version of toOccColor(), see QtUtils::toOccColors()
+void QtColorCache::toOccColors(
+        const QColor* colors, std::size_t count, Quantity_Color* occColors)
+{
+    for (std::size_t i = 0; i < count; ++i)
+        occColors[i] = this->toOccColor(colors[i]);
+}
+
+//! Batch version of toOccNameOfColor()
+void QtColorCache::toOccNameOfColors(
+        const QColor* colors, std::size_t count, Quantity_NameOfColor* names)
+{
+    for (std::size_t i = 0; i < count; ++i)
+        names[i] = this->toOccNameOfColor(colors[i]);
+}
+
+//! Count of distinct RGB values cached
+std::size_t QtColorCache::count() const
+{
+    return m_entries.size();
+}
+
+void QtColorCache::clear()
+{
+    m_entries.clear();
+}
+
+QtColorCache::Entry& QtColorCache::entry(QRgb rgb)
+{
+    rgb &= RGB_MASK;
+    auto it = m_entries.find(rgb);
+    if (it == m_entries.end())
+        it = m_entries.emplace(rgb, Entry(KernelUtils::rgbColor(rgb))).first;
+    return it->second;
+}
+
 } // namespace occ
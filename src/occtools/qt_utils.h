@@ -25,6 +25,9 @@
 #include <QtCore/QString>
 #include <QtGui/QColor>
 
+#include <cstddef>
+#include <unordered_map>
+
 namespace occ {
 
 class OCCTOOLS_EXPORT QtUtils
@@ -37,6 +40,13 @@ public:
     static Quantity_Color toOccColor(const QColor& c);
     static Quantity_NameOfColor toOccNameOfColor(const QColor& c);
 
+    static void toQColors(
+            const Quantity_Color* colors, std::size_t count, QColor* qcolors);
+    static void toOccColors(
+            const QColor* colors, std::size_t count, Quantity_Color* occColors);
+    static void toOccColors(
+            const QRgb* rgbs, std::size_t count, Quantity_Color* occColors);
+
     // --- String conversion
 
     static TCollection_AsciiString toOccLatin1String(const QString& str);
@@ -61,6 +71,35 @@ public:
             unsigned prec = 6);
 };
 
+class OCCTOOLS_EXPORT QtColorCache
+{
+public:
+    const Quantity_Color& toOccColor(const QColor& c);
+    const Quantity_Color& toOccColor(QRgb rgb);
+    Quantity_NameOfColor toOccNameOfColor(const QColor& c);
+    Quantity_NameOfColor toOccNameOfColor(QRgb rgb);
+
+    void toOccColors(
+            const QColor* colors, std::size_t count, Quantity_Color* occColors);
+    void toOccNameOfColors(
+            const QColor* colors, std::size_t count, Quantity_NameOfColor* names);
+
+    std::size_t count() const;
+    void clear();
+
+private:
+    struct Entry
+    {
+        Entry(const Quantity_Color& c);
+        Quantity_Color color;
+        int name; // Quantity_NameOfColor or -1 if not yet computed
+    };
+
+    Entry& entry(QRgb rgb);
+
+    std::unordered_map<QRgb, Entry> m_entries;
+};
+
 //
 // --- Implementation
 //
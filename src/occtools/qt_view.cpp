@@ -15,14 +15,19 @@
 
 #include "qt_view.h"
 
+#include "ais_scene_bounds.h"
+
 #if defined(Q_OS_WIN32)
 # include <windows.h>
 #endif
 
 #include <AIS_InteractiveContext.hxx>
 #include <Graphic3d_GraphicDriver.hxx>
+#include <Standard_Version.hxx>
 #include <V3d_View.hxx>
 
+#include <QtCore/QThread>
+#include <QtCore/QTimer>
 #include <QtCore/QtDebug>
 
 #include <QApplication>
@@ -42,11 +47,73 @@
 # include <X11/X.h>
 #endif
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <vector>
 #include <unordered_map>
 
 namespace occ {
 
+namespace internal {
+
+//! Rolling window of the last time samples (in milliseconds)
+class TimeSamples
+{
+public:
+    TimeSamples()
+        : m_nextId(0)
+    { }
+
+    void add(double msec, std::size_t windowSize)
+    {
+        if (m_values.size() > windowSize) {
+            m_values.clear();
+            m_nextId = 0;
+        }
+        if (m_values.size() < windowSize) {
+            m_values.push_back(msec);
+        }
+        else {
+            m_values[m_nextId] = msec;
+            m_nextId = (m_nextId + 1) % windowSize;
+        }
+    }
+
+    QtView::FrameTimeStats stats() const
+    {
+        QtView::FrameTimeStats result = {};
+        if (m_values.empty())
+            return result;
+        std::vector<double> sorted(m_values);
+        std::sort(sorted.begin(), sorted.end());
+        auto fnPercentile = [&] (double p) {
+            const auto id = static_cast<std::size_t>(p * (sorted.size() - 1) + 0.5);
+            return sorted.at(id);
+        };
+        result.sampleCount = static_cast<int>(sorted.size());
+        result.medianMsec = fnPercentile(0.5);
+        result.p90Msec = fnPercentile(0.9);
+        result.p99Msec = fnPercentile(0.99);
+        result.maxMsec = sorted.back();
+        return result;
+    }
+
+private:
+    std::vector<double> m_values;
+    std::size_t m_nextId;
+};
+
+typedef std::chrono::steady_clock FrameClock;
+
+static double elapsedMsec(FrameClock::time_point start)
+{
+    const auto elapsed = FrameClock::now() - start;
+    return std::chrono::duration<double, std::milli>(elapsed).count();
+}
+
+} // namespace internal
+
 //! QtView's pimpl
 class QtView::Private
 {
@@ -60,6 +127,9 @@ public:
     bool m_isInitialized;
     bool m_needsResize;
 
+    const AisSceneBounds* m_sceneBounds;
+    double m_fitAllMargin;
+
 #ifndef OCCTOOLS_QTVIEW_NO_PAINTCALLBACK
     struct PaintCallbackData
     {
@@ -68,10 +138,29 @@ public:
     };
 
     std::vector<PaintCallbackData> m_paintCallbacks;
+
+    void drawOverlay() const;
+
+    QRect m_overlayRubberBand;
+    QVector<QPolygon> m_overlayHighlights;
 #endif
     int m_paintCallbackLastId;
     Aspect_GraphicCallbackStruct* m_callbackData;
 
+    // Redraw scheduling
+    QTimer* m_redrawTimer;
+    std::atomic<bool> m_isRedrawPending;
+    std::atomic<quint64> m_redrawRequestCount;
+    quint64 m_redrawCount;
+
+    // Frame time instrumentation
+    bool m_isFrameTimingEnabled;
+    std::size_t m_frameTimingWindowSize;
+    internal::TimeSamples m_redrawTimes;
+#ifndef OCCTOOLS_QTVIEW_NO_PAINTCALLBACK
+    std::unordered_map<int, internal::TimeSamples> m_paintCallbackTimes;
+#endif
+
 private:
     QtView* m_backPtr;
 };
@@ -86,8 +175,19 @@ int occ_QtView_paintCallBack(
     QtView::Private* d = reinterpret_cast<QtView::Private*>(pointer);
     d->m_callbackData = data;
 
-    for (const auto& cbData : d->m_paintCallbacks)
-        cbData.callback();
+    if (d->m_isFrameTimingEnabled) {
+        for (const auto& cbData : d->m_paintCallbacks) {
+            const auto start = internal::FrameClock::now();
+            cbData.callback();
+            d->m_paintCallbackTimes[cbData.id].add(
+                        internal::elapsedMsec(start), d->m_frameTimingWindowSize);
+        }
+    }
+    else {
+        for (const auto& cbData : d->m_paintCallbacks)
+            cbData.callback();
+    }
+    d->drawOverlay();
 
     d->m_callbackData = NULL;
 #endif // !OCCTOOLS_QTVIEW_NO_PAINTCALLBACK
@@ -100,12 +200,78 @@ QtView::Private::Private(
     : m_context(context3d),
       m_isInitialized(false),
       m_needsResize(false),
+      m_sceneBounds(NULL),
+      m_fitAllMargin(0.01),
       m_paintCallbackLastId(0),
       m_callbackData(NULL),
+      m_redrawTimer(new QTimer(backPtr)),
+      m_isRedrawPending(false),
+      m_redrawRequestCount(0),
+      m_redrawCount(0),
+      m_isFrameTimingEnabled(false),
+      m_frameTimingWindowSize(120),
       m_backPtr(backPtr)
 {
+    m_redrawTimer->setSingleShot(true);
+    m_redrawTimer->setInterval(16);
 }
 
+#ifndef OCCTOOLS_QTVIEW_NO_PAINTCALLBACK
+//! Draws the overlay items with OpenGL, in widget coordinates
+void QtView::Private::drawOverlay() const
+{
+    if (m_overlayRubberBand.isNull() && m_overlayHighlights.isEmpty())
+        return;
+
+    glPushAttrib(
+                GL_ENABLE_BIT | GL_COLOR_BUFFER_BIT | GL_CURRENT_BIT
+                | GL_LINE_BIT | GL_TRANSFORM_BIT);
+    glDisable(GL_LIGHTING);
+    glDisable(GL_DEPTH_TEST);
+    glDisable(GL_TEXTURE_2D);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    glMatrixMode(GL_PROJECTION);
+    glPushMatrix();
+    glLoadIdentity();
+    glOrtho(0, m_backPtr->width(), m_backPtr->height(), 0, -1, 1);
+    glMatrixMode(GL_MODELVIEW);
+    glPushMatrix();
+    glLoadIdentity();
+
+    // Highlights
+    glLineWidth(2.f);
+    glColor4f(1.f, 1.f, 0.f, 1.f);
+    for (const QPolygon& polygon : m_overlayHighlights) {
+        glBegin(GL_LINE_LOOP);
+        for (const QPoint& pnt : polygon)
+            glVertex2i(pnt.x(), pnt.y());
+        glEnd();
+    }
+
+    // Rubber band
+    if (!m_overlayRubberBand.isNull()) {
+        const QRect& rect = m_overlayRubberBand;
+        glColor4f(0.2f, 0.4f, 1.f, 0.25f);
+        glRecti(rect.left(), rect.top(), rect.right() + 1, rect.bottom() + 1);
+        glLineWidth(1.f);
+        glColor4f(0.2f, 0.4f, 1.f, 1.f);
+        glBegin(GL_LINE_LOOP);
+        glVertex2i(rect.left(), rect.top());
+        glVertex2i(rect.right(), rect.top());
+        glVertex2i(rect.right(), rect.bottom());
+        glVertex2i(rect.left(), rect.bottom());
+        glEnd();
+    }
+
+    glPopMatrix();
+    glMatrixMode(GL_PROJECTION);
+    glPopMatrix();
+    glPopAttrib();
+}
+#endif // !OCCTOOLS_QTVIEW_NO_PAINTCALLBACK
+
 void QtView::Private::initialize()
 {
     if (!m_isInitialized && m_backPtr->winId() != 0) {
@@ -172,6 +338,11 @@ QtView::QtView(const Handle_AIS_InteractiveContext& context3d, QWidget* parent)
     this->setAttribute(Qt::WA_PaintOnScreen);
     this->setAttribute(Qt::WA_OpaquePaintEvent);
     this->setAttribute(Qt::WA_NativeWindow);
+
+    QObject::connect(d->m_redrawTimer, &QTimer::timeout, this, [=] {
+        d->m_isRedrawPending = false;
+        this->redraw();
+    });
 }
 
 QtView::~QtView()
@@ -189,6 +360,34 @@ Handle_V3d_View QtView::internalView() const
     return d->m_internalView;
 }
 
+//! Scene bounds used by fitAll(), NULL by default
+const AisSceneBounds* QtView::sceneBounds() const
+{
+    return d->m_sceneBounds;
+}
+
+/*! Sets the incrementally maintained \p bounds of the objects displayed in
+ *  this view, so fitAll() does not have to traverse the whole scene
+ *
+ *  \p bounds is not owned and must outlive this view (or be reset to NULL)
+ */
+void QtView::setSceneBounds(const AisSceneBounds* bounds)
+{
+    d->m_sceneBounds = bounds;
+}
+
+//! Margin, as a ratio of the view size, kept by fitAll() around the scene bounds
+double QtView::fitAllMargin() const
+{
+    return d->m_fitAllMargin;
+}
+
+//! Sets the margin used by fitAll() with scene bounds (0.01 by default)
+void QtView::setFitAllMargin(double margin)
+{
+    d->m_fitAllMargin = margin;
+}
+
 //! Hack for Qt 4.5.x
 QPaintEngine* QtView::paintEngine() const
 {
@@ -199,14 +398,130 @@ QPaintEngine* QtView::paintEngine() const
 void QtView::redraw()
 {
     if (!d->m_internalView.IsNull()) {
+        const auto start = internal::FrameClock::now();
         if (d->m_needsResize)
             d->m_internalView->MustBeResized();
         else
             d->m_internalView->Redraw();
+        ++(d->m_redrawCount);
+        if (d->m_isFrameTimingEnabled) {
+            const double redrawTime = internal::elapsedMsec(start);
+            d->m_redrawTimes.add(redrawTime, d->m_frameTimingWindowSize);
+            emit frameTimed(redrawTime);
+        }
     }
     d->m_needsResize = false;
 }
 
+/*! \brief Requests a redraw of the view, performed later by the event loop
+ *
+ *  Requests are coalesced : all the calls to scheduleRedraw() made before the
+ *  end of the current redraw interval (see redrawInterval()) result in a
+ *  single call to redraw().
+ *
+ *  Unlike redraw(), this function can be called from any thread.
+ */
+void QtView::scheduleRedraw()
+{
+    ++(d->m_redrawRequestCount);
+    if (!d->m_isRedrawPending.exchange(true)) {
+        if (QThread::currentThread() == this->thread())
+            d->m_redrawTimer->start();
+        else
+            QMetaObject::invokeMethod(d->m_redrawTimer, "start", Qt::QueuedConnection);
+    }
+}
+
+/*! \brief Returns the delay, in milliseconds, between the first call to
+ *         scheduleRedraw() and the actual redraw
+ *
+ *  Default is 16ms, ie at most about 60 scheduled redraws per second
+ */
+int QtView::redrawInterval() const
+{
+    return d->m_redrawTimer->interval();
+}
+
+void QtView::setRedrawInterval(int msec)
+{
+    d->m_redrawTimer->setInterval(msec);
+}
+
+//! Returns the count of calls to scheduleRedraw() since the last reset
+quint64 QtView::redrawRequestCount() const
+{
+    return d->m_redrawRequestCount;
+}
+
+//! Returns the count of redraws actually performed since the last reset
+quint64 QtView::redrawCount() const
+{
+    return d->m_redrawCount;
+}
+
+void QtView::resetRedrawCounters()
+{
+    d->m_redrawRequestCount = 0;
+    d->m_redrawCount = 0;
+}
+
+/*! \brief Is frame time instrumentation enabled ? (default is false)
+ *
+ *  When enabled, the times spent in redraw() and in each paint callback are
+ *  recorded in rolling windows of frameTimingWindowSize() samples, and signal
+ *  frameTimed() is emitted after each redraw.
+ *
+ *  \note The redraw time includes the time spent in paint callbacks
+ */
+bool QtView::isFrameTimingEnabled() const
+{
+    return d->m_isFrameTimingEnabled;
+}
+
+void QtView::setFrameTimingEnabled(bool on)
+{
+    d->m_isFrameTimingEnabled = on;
+}
+
+//! Returns the count of last frames the time statistics are computed from
+int QtView::frameTimingWindowSize() const
+{
+    return static_cast<int>(d->m_frameTimingWindowSize);
+}
+
+void QtView::setFrameTimingWindowSize(int sampleCount)
+{
+    d->m_frameTimingWindowSize = static_cast<std::size_t>(std::max(sampleCount, 1));
+}
+
+//! Returns the percentiles of the time spent in the last redraws
+QtView::FrameTimeStats QtView::redrawTimeStats() const
+{
+    return d->m_redrawTimes.stats();
+}
+
+#ifndef OCCTOOLS_QTVIEW_NO_PAINTCALLBACK
+/*! \brief Returns the percentiles of the time spent in the paint callback
+ *         identified by \p callbackId (as returned by addPaintCallback())
+ */
+QtView::FrameTimeStats QtView::paintCallbackTimeStats(int callbackId) const
+{
+    auto itTimes = d->m_paintCallbackTimes.find(callbackId);
+    if (itTimes != d->m_paintCallbackTimes.end())
+        return itTimes->second.stats();
+    return internal::TimeSamples().stats();
+}
+#endif
+
+//! Clears all the recorded frame times
+void QtView::resetFrameTimings()
+{
+    d->m_redrawTimes = internal::TimeSamples();
+#ifndef OCCTOOLS_QTVIEW_NO_PAINTCALLBACK
+    d->m_paintCallbackTimes.clear();
+#endif
+}
+
 #ifndef OCCTOOLS_QTVIEW_NO_PAINTCALLBACK
 int QtView::addPaintCallback(const PaintCallback &callback)
 {
@@ -231,6 +546,7 @@ void QtView::removePaintCallback(int callbackId)
     } );
     if (callbackIt != d->m_paintCallbacks.end())
         d->m_paintCallbacks.erase(callbackIt);
+    d->m_paintCallbackTimes.erase(callbackId);
 }
 
 Aspect_GraphicCallbackStruct *QtView::paintCallbackData() const
@@ -238,14 +554,78 @@ Aspect_GraphicCallbackStruct *QtView::paintCallbackData() const
     return d->m_callbackData;
 }
 
+/*! \brief Returns the rectangle (in widget coordinates) drawn over the 3D
+ *         scene as a rubber band
+ *
+ *  The overlay items (rubber band and highlights) are drawn with OpenGL at
+ *  the end of each redraw, after the paint callbacks. So, unlike QRubberBand
+ *  child widgets, they don't cause any expose of the 3D view and a change of
+ *  the overlay costs a single coalesced redraw (see scheduleRedraw()).
+ */
+QRect QtView::overlayRubberBand() const
+{
+    return d->m_overlayRubberBand;
+}
+
+//! Sets the overlay rubber band to \p rect, a null rect hides it
+void QtView::setOverlayRubberBand(const QRect& rect)
+{
+    if (rect != d->m_overlayRubberBand) {
+        d->m_overlayRubberBand = rect;
+        this->scheduleRedraw();
+    }
+}
+
+/*! \brief Returns the polygons (in widget coordinates) outlined over the 3D
+ *         scene, typically for dynamic highlight of detected objects
+ *
+ *  \sa overlayRubberBand()
+ */
+QVector<QPolygon> QtView::overlayHighlights() const
+{
+    return d->m_overlayHighlights;
+}
+
+void QtView::setOverlayHighlights(const QVector<QPolygon>& polygons)
+{
+    if (polygons != d->m_overlayHighlights) {
+        d->m_overlayHighlights = polygons;
+        this->scheduleRedraw();
+    }
+}
+
+//! Hides all the overlay items
+void QtView::clearOverlay()
+{
+    this->setOverlayRubberBand(QRect());
+    this->setOverlayHighlights(QVector<QPolygon>());
+}
+
 #endif // !OCCTOOLS_QTVIEW_NO_PAINTCALLBACK
 
+/*! Adjusts the camera so all the displayed objects are visible
+ *
+ *  If scene bounds were set with setSceneBounds() and are not void then the
+ *  camera is fitted directly on their box, otherwise the viewer computes the
+ *  bounds of all the displayed presentations (which is slow for large scenes)
+ *
+ *  \note The cached bounds are used only with OpenCascade >= v6.8.0
+ */
 void QtView::fitAll()
 {
-    if (!d->m_internalView.IsNull()) {
-        d->m_internalView->ZFitAll();
-        d->m_internalView->FitAll();
+    if (d->m_internalView.IsNull())
+        return;
+#if OCC_VERSION_HEX >= 0x060800
+    if (d->m_sceneBounds != NULL && !d->m_sceneBounds->isVoid()) {
+        d->m_internalView->FitAll(
+                    d->m_sceneBounds->box(), d->m_fitAllMargin, Standard_False);
+        // Z range is adjusted on redraw by V3d_View::AutoZFit()
+        this->scheduleRedraw();
+        return;
     }
+#endif
+    d->m_internalView->ZFitAll();
+    d->m_internalView->FitAll();
 }
 
 //! Reimplemented from QWidget::paintEvent()
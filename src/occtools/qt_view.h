@@ -22,6 +22,9 @@
 #endif
 
 #include <QWidget>
+#include <QtCore/QRect>
+#include <QtCore/QVector>
+#include <QtGui/QPolygon>
 
 #include <Aspect_GraphicCallbackProc.hxx>
 #include <Handle_AIS_InteractiveContext.hxx>
@@ -29,6 +32,8 @@
 
 namespace occ {
 
+class AisSceneBounds;
+
 // Obsolete use QWidgetView3d
 class OCCTOOLS_EXPORT QtView : public QWidget
 {
@@ -42,17 +47,58 @@ public:
     Handle_AIS_InteractiveContext context() const;
     Handle_V3d_View internalView() const;
 
+    const AisSceneBounds* sceneBounds() const;
+    void setSceneBounds(const AisSceneBounds* bounds);
+    double fitAllMargin() const;
+    void setFitAllMargin(double margin);
+
 #ifndef OCCTOOLS_QTVIEW_NO_PAINTCALLBACK
     typedef std::function<void()> PaintCallback;
     int addPaintCallback(const PaintCallback& callback);
     void removePaintCallback(int callbackId);
     Aspect_GraphicCallbackStruct* paintCallbackData() const;
+
+    QRect overlayRubberBand() const;
+    void setOverlayRubberBand(const QRect& rect);
+    QVector<QPolygon> overlayHighlights() const;
+    void setOverlayHighlights(const QVector<QPolygon>& polygons);
+    void clearOverlay();
 #endif
 
     QPaintEngine* paintEngine() const override;
 
+    int redrawInterval() const;
+    void setRedrawInterval(int msec);
+    quint64 redrawRequestCount() const;
+    quint64 redrawCount() const;
+    void resetRedrawCounters();
+
+    // Frame time instrumentation
+    struct FrameTimeStats
+    {
+        int sampleCount;
+        double medianMsec;
+        double p90Msec;
+        double p99Msec;
+        double maxMsec;
+    };
+
+    bool isFrameTimingEnabled() const;
+    void setFrameTimingEnabled(bool on);
+    int frameTimingWindowSize() const;
+    void setFrameTimingWindowSize(int sampleCount);
+    FrameTimeStats redrawTimeStats() const;
+#ifndef OCCTOOLS_QTVIEW_NO_PAINTCALLBACK
+    FrameTimeStats paintCallbackTimeStats(int callbackId) const;
+#endif
+    void resetFrameTimings();
+
+signals:
+    void frameTimed(double redrawTimeMsec);
+
 public slots:
     void redraw();
+    void scheduleRedraw();
     void fitAll();
 
 protected:
@@ -36,33 +36,51 @@ namespace occ {
 QtViewController::QtViewController(QtView* view)
     : QObject(view),
       m_view(view),
-      m_rubberBand(NULL)
+      m_rubberBand(NULL),
+      m_idBufferPicker(NULL)
 {
 }
 
 // -- Rubber band handling
+//
+// The rubber band is drawn in the overlay of the view when paint callbacks are
+// available, so mouse drags don't expose the 3D view as a QRubberBand child
+// widget does
 
 void QtViewController::beginRubberBandDraw(const QPoint& startPos)
 {
-    this->createRubberBand();
     m_startRubberBandPos = startPos;
-    m_rubberBand->setGeometry(QRect(startPos, QSize()));
+    m_rubberBandGeometry = QRect(startPos, QSize());
+#ifndef OCCTOOLS_QTVIEW_NO_PAINTCALLBACK
+    m_view->setOverlayRubberBand(m_rubberBandGeometry);
+#else
+    this->createRubberBand();
+    m_rubberBand->setGeometry(m_rubberBandGeometry);
     m_rubberBand->show();
+#endif
 }
 
 void QtViewController::updateRubberBandDraw(const QPoint& currPos)
 {
+    m_rubberBandGeometry = QRect(m_startRubberBandPos, currPos).normalized();
+#ifndef OCCTOOLS_QTVIEW_NO_PAINTCALLBACK
+    m_view->setOverlayRubberBand(m_rubberBandGeometry);
+#else
     this->createRubberBand();
     m_rubberBand->hide();
-    QRect window(m_startRubberBandPos, currPos);
-    m_rubberBand->setGeometry(window.normalized());
+    m_rubberBand->setGeometry(m_rubberBandGeometry);
     m_rubberBand->show();
+#endif
 }
 
 void QtViewController::endRubberBandDraw()
 {
+#ifndef OCCTOOLS_QTVIEW_NO_PAINTCALLBACK
+    m_view->setOverlayRubberBand(QRect());
+#else
     this->createRubberBand();
     m_rubberBand->hide();
+#endif
 }
 
 // --- Event handling
@@ -101,9 +119,54 @@ QtView* QtViewController::view() const
 
 const QRect QtViewController::rubberBandGeometry() const
 {
-    if (m_rubberBand == NULL)
-        return QRect();
-    return m_rubberBand->geometry();
+    return m_rubberBandGeometry;
+}
+
+// --- ID-buffer picking
+//
+// Optional alternative to AIS_InteractiveContext picking for hover and
+// rubber-band selection, whose cost does not depend on the triangle count.
+// Controllers keep the picker objects in sync with the displayed ones
+
+//! ID-buffer picker used by idBufferPick(), NULL by default
+IdBufferPicker* QtViewController::idBufferPicker() const
+{
+    return m_idBufferPicker;
+}
+
+//! Enables ID-buffer picking with \p picker (not owned), NULL disables it
+void QtViewController::setIdBufferPicker(IdBufferPicker* picker)
+{
+    m_idBufferPicker = picker;
+}
+
+bool QtViewController::isIdBufferPickingEnabled() const
+{
+    return m_idBufferPicker != NULL;
+}
+
+/*! Object (or face) visible under \p pos in the view, found in the ID buffer
+ *
+ *  The ID buffer is rendered again only if the camera or the picked objects
+ *  changed since the last call. Returns an invalid hit if ID-buffer picking
+ *  is disabled
+ */
+IdBufferPicker::Hit QtViewController::idBufferPick(const QPoint& pos) const
+{
+    if (m_idBufferPicker == NULL)
+        return IdBufferPicker::Hit();
+    m_idBufferPicker->update(this->internalOccView());
+    return m_idBufferPicker->pick(pos);
+}
+
+//! Objects (or faces) visible inside \p rect in the view, see idBufferPick()
+std::vector<IdBufferPicker::Hit> QtViewController::idBufferPick(
+        const QRect& rect) const
+{
+    if (m_idBufferPicker == NULL)
+        return std::vector<IdBufferPicker::Hit>();
+    m_idBufferPicker->update(this->internalOccView());
+    return m_idBufferPicker->pick(rect);
 }
 
 // --- Implementation
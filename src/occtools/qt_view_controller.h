@@ -16,6 +16,8 @@
 #pragma once
 
 #include "occtools.h"
+#include "id_buffer_picker.h"
+
 #include <Handle_AIS_InteractiveContext.hxx>
 #include <Handle_V3d_View.hxx>
 #include <QtCore/QObject>
@@ -56,15 +58,24 @@ public:
     Handle_AIS_InteractiveContext context() const;
     QtView* view() const;
 
+    IdBufferPicker* idBufferPicker() const;
+    void setIdBufferPicker(IdBufferPicker* picker);
+    bool isIdBufferPickingEnabled() const;
+
 protected:
     const QRect rubberBandGeometry() const;
 
+    IdBufferPicker::Hit idBufferPick(const QPoint& pos) const;
+    std::vector<IdBufferPicker::Hit> idBufferPick(const QRect& rect) const;
+
 private:
     void createRubberBand();
 
     QtView* m_view;
     QPoint m_startRubberBandPos;
+    QRect m_rubberBandGeometry;
     QRubberBand* m_rubberBand;
+    IdBufferPicker* m_idBufferPicker;
 };
 
 } // namespace occ
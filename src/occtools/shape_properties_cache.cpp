@@ -0,0 +1,313 @@
+/****************************************************************************
+**  FougTools
+**  Copyright Fougue (30 Mar. 2015)
+**  contact@fougue.pro
+**
+** This software is a computer program whose purpose is to provide utility
+** tools for the C++ language and the Qt toolkit.
+**
+** This software is governed by the CeCILL-C license under French law and
+** abiding by the rules of distribution of free software.  You can  use,
+** modify and/ or redistribute the software under the terms of the CeCILL-C
+** license as circulated by CEA, CNRS and INRIA at the following URL
+** "http://www.cecill.info".
+****************************************************************************/
+
+
+#include "shape_properties_cache.h"
+
+#include "../cpptools/parallel_utils.h"
+#include "../cpptools/profiling.h"
+
+#include <BRepBndLib.hxx>
+#include <BRepGProp.hxx>
+#include <GProp_GProps.hxx>
+#include <TopExp_Explorer.hxx>
+#include <TopoDS.hxx>
+#include <TopoDS_Face.hxx>
+
+#include <climits>
+#include <cmath>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace occ {
+
+namespace internal {
+
+//! Hashes a shape on its identity : TShape, location and orientation
+struct ShapeIdentityHash
+{
+    std::size_t operator()(const TopoDS_Shape& shape) const
+    {
+        const std::size_t hash = static_cast<std::size_t>(shape.HashCode(INT_MAX));
+        return hash * 4 + static_cast<std::size_t>(shape.Orientation());
+    }
+};
+
+struct ShapeIdentityEqual
+{
+    bool operator()(const TopoDS_Shape& lhs, const TopoDS_Shape& rhs) const
+    {
+        return lhs.IsEqual(rhs) == Standard_True;
+    }
+};
+
+struct ShapePropertiesEntry
+{
+    ShapePropertiesEntry()
+        : hasBoundingBox(false),
+          hasMassProperties(false)
+    { }
+
+    bool hasBoundingBox;
+    bool hasMassProperties;
+    Bnd_Box boundingBox;
+    ShapePropertiesCache::MassProperties massProperties;
+};
+
+//! Faces of \p shape, in exploration order (a face shared by two solids is
+//! listed twice, as both occurrences contribute to the volume)
+static std::vector<TopoDS_Face> exploredFaces(const TopoDS_Shape& shape)
+{
+    std::vector<TopoDS_Face> faces;
+    for (TopExp_Explorer exp(shape, TopAbs_FACE); exp.More(); exp.Next())
+        faces.push_back(TopoDS::Face(exp.Current()));
+    return faces;
+}
+
+// There is little to gain from a thread below this count of faces
+static const std::size_t minFaceChunkSize = 16;
+
+} // namespace internal
+
+class ShapePropertiesCache::Private
+{
+public:
+    typedef std::unordered_map<
+        TopoDS_Shape,
+        internal::ShapePropertiesEntry,
+        internal::ShapeIdentityHash,
+        internal::ShapeIdentityEqual> EntryMap_t;
+
+    Private()
+        : m_threadCount(0)
+    { }
+
+    std::mutex m_mutex;
+    EntryMap_t m_entries;
+    unsigned m_threadCount;
+};
+
+/*! \class ShapePropertiesCache
+ *  \brief Caches the bounding box and mass properties (area, volume, center
+ *         of mass) of shapes
+ *
+ *  Properties are computed on first request, in parallel over the faces of
+ *  the shape (see computeBoundingBox() and computeMassProperties()), then
+ *  returned from the cache on subsequent requests. This makes repeated
+ *  queries on big assemblies (ex: "fit all" or property panels) instant.
+ *
+ *  Shapes are keyed on their identity (TopoDS_Shape::IsEqual()) : same
+ *  TShape, location and orientation. A shape modified in place (ex: new
+ *  triangulation) must be invalidate()-d. Cached shapes are kept alive by the
+ *  cache until they are invalidated or the cache is cleared.
+ *
+ *  All functions are thread-safe, computation happens outside of the internal
+ *  lock so concurrent requests do not wait for each other (the same shape
+ *  requested concurrently may be computed more than once).
+ *
+ *  \headerfile shape_properties_cache.h <occtools/shape_properties_cache.h>
+ *  \ingroup occtools
+ */
+
+ShapePropertiesCache::MassProperties::MassProperties()
+    : area(0.),
+      volume(0.),
+      centerOfMass(0., 0., 0.),
+      faceCount(0)
+{
+}
+
+ShapePropertiesCache::ShapePropertiesCache()
+    : d(new Private)
+{
+}
+
+ShapePropertiesCache::~ShapePropertiesCache()
+{
+    delete d;
+}
+
+//! Bounding box of \p shape, computed with computeBoundingBox() if not cached
+Bnd_Box ShapePropertiesCache::boundingBox(const TopoDS_Shape& shape) const
+{
+    {
+        std::lock_guard<std::mutex> lock(d->m_mutex);
+        auto itEntry = d->m_entries.find(shape);
+        if (itEntry != d->m_entries.end() && itEntry->second.hasBoundingBox)
+            return itEntry->second.boundingBox;
+    }
+
+    const Bnd_Box box =
+            ShapePropertiesCache::computeBoundingBox(shape, d->m_threadCount);
+    std::lock_guard<std::mutex> lock(d->m_mutex);
+    internal::ShapePropertiesEntry& entry = d->m_entries[shape];
+    entry.boundingBox = box;
+    entry.hasBoundingBox = true;
+    return box;
+}
+
+//! Mass properties of \p shape, computed with computeMassProperties() if not
+//! cached
+ShapePropertiesCache::MassProperties
+ShapePropertiesCache::massProperties(const TopoDS_Shape& shape) const
+{
+    {
+        std::lock_guard<std::mutex> lock(d->m_mutex);
+        auto itEntry = d->m_entries.find(shape);
+        if (itEntry != d->m_entries.end() && itEntry->second.hasMassProperties)
+            return itEntry->second.massProperties;
+    }
+
+    const MassProperties props =
+            ShapePropertiesCache::computeMassProperties(shape, d->m_threadCount);
+    std::lock_guard<std::mutex> lock(d->m_mutex);
+    internal::ShapePropertiesEntry& entry = d->m_entries[shape];
+    entry.massProperties = props;
+    entry.hasMassProperties = true;
+    return props;
+}
+
+//! Returns \c true if any property of \p shape is cached
+bool ShapePropertiesCache::contains(const TopoDS_Shape& shape) const
+{
+    std::lock_guard<std::mutex> lock(d->m_mutex);
+    return d->m_entries.find(shape) != d->m_entries.end();
+}
+
+//! Drops the cached properties of \p shape
+void ShapePropertiesCache::invalidate(const TopoDS_Shape& shape)
+{
+    std::lock_guard<std::mutex> lock(d->m_mutex);
+    d->m_entries.erase(shape);
+}
+
+void ShapePropertiesCache::clear()
+{
+    std::lock_guard<std::mutex> lock(d->m_mutex);
+    d->m_entries.clear();
+}
+
+//! Count of shapes having cached properties
+std::size_t ShapePropertiesCache::count() const
+{
+    std::lock_guard<std::mutex> lock(d->m_mutex);
+    return d->m_entries.size();
+}
+
+//! Maximum count of threads used to compute properties, 0 (the default)
+//! means as many as the hardware supports
+unsigned ShapePropertiesCache::threadCount() const
+{
+    return d->m_threadCount;
+}
+
+void ShapePropertiesCache::setThreadCount(unsigned count)
+{
+    d->m_threadCount = count;
+}
+
+/*! \brief Computes the bounding box of \p shape, in parallel over its faces
+ *
+ *  Each thread adds a contiguous range of faces to its own Bnd_Box (with
+ *  BRepBndLib::Add(), so using triangulations when present), boxes are merged
+ *  at the end. Edges and vertices not bounding any face are added serially.
+ *
+ *  \param threadCount  Maximum count of threads to use (0 means as many as
+ *                      the hardware supports)
+ */
+Bnd_Box ShapePropertiesCache::computeBoundingBox(
+        const TopoDS_Shape& shape, unsigned threadCount)
+{
+    CPPTOOLS_PROFILE_ZONE("occ::ShapePropertiesCache::computeBoundingBox");
+    Bnd_Box box;
+    if (shape.IsNull())
+        return box;
+
+    const std::vector<TopoDS_Face> faces = internal::exploredFaces(shape);
+    std::mutex mutexBox;
+    auto fnAddFaces = [&] (std::size_t iBegin, std::size_t iEnd) {
+        Bnd_Box rangeBox;
+        for (std::size_t i = iBegin; i < iEnd; ++i)
+            BRepBndLib::Add(faces[i], rangeBox);
+        std::lock_guard<std::mutex> lock(mutexBox);
+        box.Add(rangeBox);
+    };
+    cpp::parallelForRanges(
+                faces.size(), fnAddFaces, threadCount, internal::minFaceChunkSize);
+
+    // Free edges and vertices
+    for (TopExp_Explorer exp(shape, TopAbs_EDGE, TopAbs_FACE); exp.More(); exp.Next())
+        BRepBndLib::Add(exp.Current(), box);
+    for (TopExp_Explorer exp(shape, TopAbs_VERTEX, TopAbs_EDGE); exp.More(); exp.Next())
+        BRepBndLib::Add(exp.Current(), box);
+    return box;
+}
+
+/*! \brief Computes the area, volume and center of mass of \p shape, in
+ *         parallel over its faces
+ *
+ *  Each thread accumulates BRepGProp::SurfaceProperties() and
+ *  BRepGProp::VolumeProperties() of a contiguous range of faces, the
+ *  GProp_GProps are merged at the end. The volume is meaningful for closed
+ *  shells and solids only, it is computed from the (oriented) faces.
+ *
+ *  MassProperties::centerOfMass is the center of the volume if it is not
+ *  null, otherwise the center of the area.
+ *
+ *  \param threadCount  Maximum count of threads to use (0 means as many as
+ *                      the hardware supports)
+ */
+ShapePropertiesCache::MassProperties ShapePropertiesCache::computeMassProperties(
+        const TopoDS_Shape& shape, unsigned threadCount)
+{
+    CPPTOOLS_PROFILE_ZONE("occ::ShapePropertiesCache::computeMassProperties");
+    MassProperties props;
+    if (shape.IsNull())
+        return props;
+
+    const std::vector<TopoDS_Face> faces = internal::exploredFaces(shape);
+    GProp_GProps surfaceProps;
+    GProp_GProps volumeProps;
+    std::mutex mutexProps;
+    auto fnAddFaces = [&] (std::size_t iBegin, std::size_t iEnd) {
+        GProp_GProps rangeSurfaceProps;
+        GProp_GProps rangeVolumeProps;
+        for (std::size_t i = iBegin; i < iEnd; ++i) {
+            GProp_GProps faceSurfaceProps;
+            BRepGProp::SurfaceProperties(faces[i], faceSurfaceProps);
+            rangeSurfaceProps.Add(faceSurfaceProps);
+            GProp_GProps faceVolumeProps;
+            BRepGProp::VolumeProperties(faces[i], faceVolumeProps);
+            rangeVolumeProps.Add(faceVolumeProps);
+        }
+        std::lock_guard<std::mutex> lock(mutexProps);
+        surfaceProps.Add(rangeSurfaceProps);
+        volumeProps.Add(rangeVolumeProps);
+    };
+    cpp::parallelForRanges(
+                faces.size(), fnAddFaces, threadCount, internal::minFaceChunkSize);
+
+    props.area = surfaceProps.Mass();
+    props.volume = volumeProps.Mass();
+    props.faceCount = faces.size();
+    if (std::abs(props.volume) > 0.)
+        props.centerOfMass = volumeProps.CentreOfMass();
+    else if (props.area > 0.)
+        props.centerOfMass = surfaceProps.CentreOfMass();
+    return props;
+}
+
+} // namespace occ
@@ -0,0 +1,68 @@
+/****************************************************************************
+**  FougTools
+**  Copyright Fougue (30 Mar. 2015)
+**  contact@fougue.pro
+**
+** This software is a computer program whose purpose is to provide utility
+** tools for the C++ language and the Qt toolkit.
+**
+** This software is governed by the CeCILL-C license under French law and
+** abiding by the rules of distribution of free software.  You can  use,
+** modify and/ or redistribute the software under the terms of the CeCILL-C
+** license as circulated by CEA, CNRS and INRIA at the following URL
+** "http://www.cecill.info".
+****************************************************************************/
+
+
+#pragma once
+
+#include "occtools.h"
+
+#include <Bnd_Box.hxx>
+#include <TopoDS_Shape.hxx>
+#include <gp_Pnt.hxx>
+
+#include <cstddef>
+
+namespace occ {
+
+class OCCTOOLS_EXPORT ShapePropertiesCache
+{
+public:
+    struct OCCTOOLS_EXPORT MassProperties
+    {
+        MassProperties();
+        double area;
+        double volume;
+        gp_Pnt centerOfMass;
+        std::size_t faceCount;
+    };
+
+    ShapePropertiesCache();
+    ~ShapePropertiesCache();
+
+    Bnd_Box boundingBox(const TopoDS_Shape& shape) const;
+    MassProperties massProperties(const TopoDS_Shape& shape) const;
+
+    bool contains(const TopoDS_Shape& shape) const;
+    void invalidate(const TopoDS_Shape& shape);
+    void clear();
+    std::size_t count() const;
+
+    unsigned threadCount() const;
+    void setThreadCount(unsigned count);
+
+    static Bnd_Box computeBoundingBox(
+            const TopoDS_Shape& shape, unsigned threadCount = 0);
+    static MassProperties computeMassProperties(
+            const TopoDS_Shape& shape, unsigned threadCount = 0);
+
+private:
+    ShapePropertiesCache(const ShapePropertiesCache&) = delete;
+    ShapePropertiesCache& operator=(const ShapePropertiesCache&) = delete;
+
+    class Private;
+    Private* const d;
+};
+
+} // namespace occ
@@ -0,0 +1,141 @@
+/****************************************************************************
+**  FougTools
+**  Copyright Fougue (30 Mar. 2015)
+**  contact@fougue.pro
+**
+** This software is a computer program whose purpose is to provide utility
+** tools for the C++ language and the Qt toolkit.
+**
+** This software is governed by the CeCILL-C license under French law and
+** abiding by the rules of distribution of free software.  You can  use,
+** modify and/ or redistribute the software under the terms of the CeCILL-C
+** license as circulated by CEA, CNRS and INRIA at the following URL
+** "http://www.cecill.info".
+****************************************************************************/
+
+#include "topods_shape_maps.h"
+
+#include <TopExp.hxx>
+
+#include <algorithm>
+#include <map>
+
+namespace occ {
+
+class TopoDsShapeMaps::Private
+{
+public:
+    typedef std::pair<TopAbs_ShapeEnum, TopAbs_ShapeEnum> AncestorMapKey;
+
+    Private();
+
+    TopoDS_Shape m_shape;
+    // Indexed by TopAbs_ShapeEnum
+    TopTools_IndexedMapOfShape m_subShapes[TopAbs_SHAPE + 1];
+    bool m_isSubShapesDone[TopAbs_SHAPE + 1];
+    std::map<AncestorMapKey, TopTools_IndexedDataMapOfShapeListOfShape> m_ancestorMaps;
+};
+
+TopoDsShapeMaps::Private::Private()
+{
+    std::fill(m_isSubShapesDone, m_isSubShapesDone + TopAbs_SHAPE + 1, false);
+}
+
+/*! \class TopoDsShapeMaps
+ *  \brief Cache of the topologic maps of a shape
+ *
+ *  Maps of unique sub-shapes (TopExp::MapShapes()) and maps of ancestors
+ *  (TopExp::MapShapesAndAncestors()) are computed on first request, then
+ *  reused by subsequent calls. This avoids repeated explorer traversals and
+ *  duplicate visits of shared sub-shapes.
+ *
+ *  Maps are computed lazily by const functions, so a TopoDsShapeMaps object
+ *  must not be used concurrently unless all the required maps were requested
+ *  beforehand.
+ *
+ *  \headerfile topods_shape_maps.h <occtools/topods_shape_maps.h>
+ *  \ingroup occtools
+ */
+
+TopoDsShapeMaps::TopoDsShapeMaps()
+    : d(new Private)
+{
+}
+
+TopoDsShapeMaps::TopoDsShapeMaps(const TopoDS_Shape& shape)
+    : d(new Private)
+{
+    d->m_shape = shape;
+}
+
+TopoDsShapeMaps::~TopoDsShapeMaps()
+{
+    delete d;
+}
+
+const TopoDS_Shape& TopoDsShapeMaps::shape() const
+{
+    return d->m_shape;
+}
+
+//! Changes the shape to be explored, cached maps are cleared
+void TopoDsShapeMaps::setShape(const TopoDS_Shape& shape)
+{
+    this->clear();
+    d->m_shape = shape;
+}
+
+//! Clears cached maps, the shape is kept
+void TopoDsShapeMaps::clear()
+{
+    for (int i = 0; i <= TopAbs_SHAPE; ++i) {
+        d->m_subShapes[i].Clear();
+        d->m_isSubShapesDone[i] = false;
+    }
+    d->m_ancestorMaps.clear();
+}
+
+//! Returns the map of unique sub-shapes of type \p type
+const TopTools_IndexedMapOfShape& TopoDsShapeMaps::subShapes(TopAbs_ShapeEnum type) const
+{
+    if (!d->m_isSubShapesDone[type]) {
+        TopExp::MapShapes(d->m_shape, type, d->m_subShapes[type]);
+        d->m_isSubShapesDone[type] = true;
+    }
+    return d->m_subShapes[type];
+}
+
+/*! Returns the map of sub-shapes of type \p subShapeType to the list of their
+ *  ancestors of type \p ancestorType
+ *
+ *  Ex: ancestorMap(TopAbs_EDGE, TopAbs_FACE) maps each edge to its faces
+ */
+const TopTools_IndexedDataMapOfShapeListOfShape& TopoDsShapeMaps::ancestorMap(
+        TopAbs_ShapeEnum subShapeType, TopAbs_ShapeEnum ancestorType) const
+{
+    const Private::AncestorMapKey key(subShapeType, ancestorType);
+    auto itMap = d->m_ancestorMaps.find(key);
+    if (itMap == d->m_ancestorMaps.end()) {
+        itMap = d->m_ancestorMaps.insert(
+                    std::make_pair(key, TopTools_IndexedDataMapOfShapeListOfShape())).first;
+        TopExp::MapShapesAndAncestors(
+                    d->m_shape, subShapeType, ancestorType, itMap->second);
+    }
+    return itMap->second;
+}
+
+/*! Returns the ancestors of type \p ancestorType of \p subShape
+ *
+ *  Returns an empty list if \p subShape is not a sub-shape of shape()
+ */
+const TopTools_ListOfShape& TopoDsShapeMaps::ancestors(
+        const TopoDS_Shape& subShape, TopAbs_ShapeEnum ancestorType) const
+{
+    static const TopTools_ListOfShape emptyList;
+    const TopTools_IndexedDataMapOfShapeListOfShape& mapAncestors =
+            this->ancestorMap(subShape.ShapeType(), ancestorType);
+    const int index = mapAncestors.FindIndex(subShape);
+    return index != 0 ? mapAncestors.FindFromIndex(index) : emptyList;
+}
+
+} // namespace occ
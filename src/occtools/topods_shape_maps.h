@@ -0,0 +1,100 @@
+/****************************************************************************
+**  FougTools
+**  Copyright Fougue (30 Mar. 2015)
+**  contact@fougue.pro
+**
+** This software is a computer program whose purpose is to provide utility
+** tools for the C++ language and the Qt toolkit.
+**
+** This software is governed by the CeCILL-C license under French law and
+** abiding by the rules of distribution of free software.  You can  use,
+** modify and/ or redistribute the software under the terms of the CeCILL-C
+** license as circulated by CEA, CNRS and INRIA at the following URL
+** "http://www.cecill.info".
+****************************************************************************/
+
+#pragma once
+
+#include "occtools.h"
+
+#include <TopAbs_ShapeEnum.hxx>
+#include <TopoDS_Shape.hxx>
+#include <TopTools_IndexedDataMapOfShapeListOfShape.hxx>
+#include <TopTools_IndexedMapOfShape.hxx>
+#include <TopTools_ListOfShape.hxx>
+#include <utility>
+
+namespace occ {
+
+class OCCTOOLS_EXPORT TopoDsShapeMaps
+{
+public:
+    TopoDsShapeMaps();
+    explicit TopoDsShapeMaps(const TopoDS_Shape& shape);
+    ~TopoDsShapeMaps();
+
+    const TopoDS_Shape& shape() const;
+    void setShape(const TopoDS_Shape& shape);
+    void clear();
+
+    const TopTools_IndexedMapOfShape& subShapes(TopAbs_ShapeEnum type) const;
+    const TopTools_IndexedDataMapOfShapeListOfShape& ancestorMap(
+            TopAbs_ShapeEnum subShapeType, TopAbs_ShapeEnum ancestorType) const;
+    const TopTools_ListOfShape& ancestors(
+            const TopoDS_Shape& subShape, TopAbs_ShapeEnum ancestorType) const;
+
+    template<typename FUNC>
+    void forEach(TopAbs_ShapeEnum type, FUNC fn) const;
+
+    template<typename FUNC>
+    void forEachVertex(FUNC fn) const;
+
+    template<typename FUNC>
+    void forEachEdge(FUNC fn) const;
+
+    template<typename FUNC>
+    void forEachFace(FUNC fn) const;
+
+private:
+    class Private;
+    Private* const d;
+};
+
+
+
+// --
+// -- Implementation
+// --
+
+/*! Applies function \p fn to each unique sub-shape of type \p type
+ *
+ *  Unlike TopoDsUtils::forEach(), a sub-shape shared by several parents is
+ *  visited once
+ */
+template<typename FUNC>
+void TopoDsShapeMaps::forEach(TopAbs_ShapeEnum type, FUNC fn) const
+{
+    const TopTools_IndexedMapOfShape& mapShape = this->subShapes(type);
+    for (int i = 1; i <= mapShape.Extent(); ++i)
+        fn(mapShape.FindKey(i));
+}
+
+template<typename FUNC>
+void TopoDsShapeMaps::forEachVertex(FUNC fn) const
+{
+    this->forEach(TopAbs_VERTEX, std::move(fn));
+}
+
+template<typename FUNC>
+void TopoDsShapeMaps::forEachEdge(FUNC fn) const
+{
+    this->forEach(TopAbs_EDGE, std::move(fn));
+}
+
+template<typename FUNC>
+void TopoDsShapeMaps::forEachFace(FUNC fn) const
+{
+    this->forEach(TopAbs_FACE, std::move(fn));
+}
+
+} // namespace occ
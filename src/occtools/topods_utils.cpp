@@ -18,14 +18,157 @@
 #include <BRepAdaptor_Surface.hxx>
 #include <BRepLProp_SLProps.hxx>
 #include <BRepTools.hxx>
+#include <BRep_Tool.hxx>
+#include <BinTools.hxx>
+#include <Precision.hxx>
 #include <ShapeExtend_WireData.hxx>
 #include <ShapeFix_Wire.hxx>
 #include <TopAbs_Orientation.hxx>
+#include <TopoDS.hxx>
+#include <TopoDS_Vertex.hxx>
 
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <deque>
 #include <sstream>
+#include <unordered_map>
+
+#include <QtCore/QByteArray>
 
 namespace occ {
 
+namespace internal {
+
+// Header of strings built by TopoDsUtils::shapeToBinaryString() :
+//     4 bytes magic + 1 byte compression flag
+static const char binaryShapeMagic[] = "OBS1";
+static const std::size_t binaryShapeMagicSize = 4;
+static const std::size_t binaryShapeHeaderSize = binaryShapeMagicSize + 1;
+
+//! Cell of the uniform grid hashing edge end points
+struct VertexGridCell
+{
+    bool operator==(const VertexGridCell& other) const
+    {
+        return x == other.x && y == other.y && z == other.z;
+    }
+
+    std::int64_t x;
+    std::int64_t y;
+    std::int64_t z;
+};
+
+struct VertexGridCellHash
+{
+    std::size_t operator()(const VertexGridCell& cell) const
+    {
+        std::uint64_t h = static_cast<std::uint64_t>(cell.x) * 73856093u;
+        h ^= static_cast<std::uint64_t>(cell.y) * 19349663u;
+        h ^= static_cast<std::uint64_t>(cell.z) * 83492791u;
+        return static_cast<std::size_t>(h);
+    }
+};
+
+/*! Connects edges by their end points, found within a tolerance in a hashed
+ *  uniform grid whose cells have the size of the tolerance
+ *
+ *  End point i of edge e is indexed 2 * e + i (0 : first, 1 : last, with
+ *  respect to edge orientation)
+ */
+class EdgeConnectivity
+{
+public:
+    EdgeConnectivity(const std::vector<TopoDS_Edge>& edges, double tolerance)
+        : m_invCellSize(1. / tolerance),
+          m_sqrTolerance(tolerance * tolerance),
+          m_endPoints(2 * edges.size()),
+          m_hasEndPoints(edges.size(), false)
+    {
+        for (std::size_t e = 0; e < edges.size(); ++e) {
+            TopoDS_Vertex first;
+            TopoDS_Vertex last;
+            TopExp::Vertices(edges.at(e), first, last, Standard_True);
+            if (first.IsNull() || last.IsNull())
+                continue;
+            m_hasEndPoints.at(e) = true;
+            m_endPoints.at(2 * e) = BRep_Tool::Pnt(first);
+            m_endPoints.at(2 * e + 1) = BRep_Tool::Pnt(last);
+            for (std::size_t i = 2 * e; i <= 2 * e + 1; ++i)
+                m_grid[this->cellOf(m_endPoints.at(i))].push_back(i);
+        }
+    }
+
+    bool hasEndPoints(std::size_t edgeId) const
+    { return m_hasEndPoints.at(edgeId); }
+
+    const gp_Pnt& endPoint(std::size_t endPointId) const
+    { return m_endPoints.at(endPointId); }
+
+    //! Nearest end point of an unused edge within tolerance of \p pnt, or -1
+    std::ptrdiff_t findNearEndPoint(
+            const gp_Pnt& pnt, const std::vector<bool>& isEdgeUsed) const
+    {
+        const VertexGridCell center = this->cellOf(pnt);
+        std::ptrdiff_t nearest = -1;
+        double nearestSqrDist = m_sqrTolerance;
+        VertexGridCell cell;
+        for (cell.x = center.x - 1; cell.x <= center.x + 1; ++cell.x) {
+            for (cell.y = center.y - 1; cell.y <= center.y + 1; ++cell.y) {
+                for (cell.z = center.z - 1; cell.z <= center.z + 1; ++cell.z) {
+                    auto it = m_grid.find(cell);
+                    if (it == m_grid.end())
+                        continue;
+                    for (std::size_t id : it->second) {
+                        if (isEdgeUsed.at(id / 2))
+                            continue;
+                        const double sqrDist = pnt.SquareDistance(m_endPoints.at(id));
+                        if (sqrDist <= nearestSqrDist) {
+                            nearestSqrDist = sqrDist;
+                            nearest = static_cast<std::ptrdiff_t>(id);
+                        }
+                    }
+                }
+            }
+        }
+        return nearest;
+    }
+
+private:
+    VertexGridCell cellOf(const gp_Pnt& pnt) const
+    {
+        VertexGridCell cell;
+        cell.x = static_cast<std::int64_t>(std::floor(pnt.X() * m_invCellSize));
+        cell.y = static_cast<std::int64_t>(std::floor(pnt.Y() * m_invCellSize));
+        cell.z = static_cast<std::int64_t>(std::floor(pnt.Z() * m_invCellSize));
+        return cell;
+    }
+
+    double m_invCellSize;
+    double m_sqrTolerance;
+    std::vector<gp_Pnt> m_endPoints;
+    std::vector<bool> m_hasEndPoints;
+    std::unordered_map<VertexGridCell, std::vector<std::size_t>, VertexGridCellHash> m_grid;
+};
+
+//! Greatest tolerance of the vertices of \p edges, at least Precision::Confusion()
+static double edgeVerticesTolerance(const std::vector<TopoDS_Edge>& edges)
+{
+    double tolerance = Precision::Confusion();
+    for (const TopoDS_Edge& edge : edges) {
+        TopoDS_Vertex first;
+        TopoDS_Vertex last;
+        TopExp::Vertices(edge, first, last);
+        if (!first.IsNull())
+            tolerance = std::max(tolerance, BRep_Tool::Tolerance(first));
+        if (!last.IsNull())
+            tolerance = std::max(tolerance, BRep_Tool::Tolerance(last));
+    }
+    return tolerance;
+}
+
+} // namespace internal
+
 /*! \class TopoDsUtils
  *  \brief Collection of tools for the TopoDS package
  *
@@ -81,23 +224,223 @@ TopoDS_Shape TopoDsUtils::shapeFromString(const std::string &str)
     return shape;
 }
 
-Handle_ShapeExtend_WireData TopoDsUtils::createShapeExtendWireData()
+/*! Returns the compact binary representation of a TopoDS_Shape
+ *
+ *  Uses BinTools::Write() internally, which is much faster and smaller than
+ *  the text format of shapeToString(). With ZlibCompression the binary data
+ *  is further compressed with qCompress().
+ *
+ *  The returned string is not printable, it starts with a small header
+ *  identifying the encoding.
+ */
+std::string TopoDsUtils::shapeToBinaryString(
+        const TopoDS_Shape& shape, BinaryCompression compression)
+{
+    std::ostringstream oss(std::ios_base::out | std::ios_base::binary);
+    oss.write(internal::binaryShapeMagic, internal::binaryShapeMagicSize);
+    oss.put(static_cast<char>(compression));
+    if (compression == ZlibCompression) {
+        std::ostringstream ossBin(std::ios_base::out | std::ios_base::binary);
+        BinTools::Write(shape, ossBin);
+        const std::string bin = ossBin.str();
+        const QByteArray zbin = qCompress(
+                    reinterpret_cast<const uchar*>(bin.data()),
+                    static_cast<int>(bin.size()));
+        oss.write(zbin.constData(), zbin.size());
+    }
+    else {
+        BinTools::Write(shape, oss);
+    }
+    return oss.str();
+}
+
+/*! Constructs the TopoDS_Shape from the binary representation \p str
+ *  (previously generated with shapeToBinaryString())
+ *
+ *  Returns a null shape if \p str is not a binary shape representation
+ */
+TopoDS_Shape TopoDsUtils::shapeFromBinaryString(const std::string& str)
+{
+    TopoDS_Shape shape;
+    if (str.size() < internal::binaryShapeHeaderSize
+            || str.compare(0, internal::binaryShapeMagicSize,
+                           internal::binaryShapeMagic) != 0)
+    {
+        return shape;
+    }
+
+    const char* payload = str.data() + internal::binaryShapeHeaderSize;
+    const std::size_t payloadSize = str.size() - internal::binaryShapeHeaderSize;
+    switch (str.at(internal::binaryShapeMagicSize)) {
+    case NoCompression: {
+        std::istringstream iss(
+                    std::string(payload, payloadSize),
+                    std::ios_base::in | std::ios_base::binary);
+        BinTools::Read(shape, iss);
+        break;
+    }
+    case ZlibCompression: {
+        const QByteArray bin = qUncompress(
+                    reinterpret_cast<const uchar*>(payload),
+                    static_cast<int>(payloadSize));
+        std::istringstream iss(
+                    std::string(bin.constData(), bin.size()),
+                    std::ios_base::in | std::ios_base::binary);
+        BinTools::Read(shape, iss);
+        break;
+    }
+    default:
+        break;
+    }
+    return shape;
+}
+
+/*! Builds a topologic compound of the \p count shapes of array \p shapes
+ *
+ *  Same as makeCompoundFromShapeRange(shapes, shapes + count) : sub-shapes are
+ *  added to the compound in a single pass with one builder, no temporary
+ *  container is created
+ */
+TopoDS_Compound TopoDsUtils::makeCompoundFromShapes(
+        const TopoDS_Shape* shapes, std::size_t count)
 {
-    return new ShapeExtend_WireData;
+    TopoDS_Compound cmpd;
+    BRep_Builder builder;
+    builder.MakeCompound(cmpd);
+    for (std::size_t i = 0; i < count; ++i)
+        builder.Add(cmpd, shapes[i]);
+    return cmpd;
 }
 
-void TopoDsUtils::addEdge(
-        const Handle_ShapeExtend_WireData &wireData, const TopoDS_Edge &edge)
+/*! Builds a topologic wire of the \p count edges of array \p edges
+ *
+ *  Edges can be given in any order and orientation : they are first chained
+ *  with sortConnectedEdges(), so ShapeFix_Wire::FixReorder() (quadratic in the
+ *  count of edges) is needed only when they don't form a single chain. Then
+ *  ShapeFix_Wire fixes the connections.
+ *
+ *  \param tolerance  Maximum distance between connected end points, negative
+ *                    value means the greatest tolerance of the edge vertices
+ */
+TopoDS_Wire TopoDsUtils::makeWireFromEdges(
+        const TopoDS_Edge* edges, std::size_t count, double tolerance)
 {
-    wireData->Add(edge);
+    std::vector<TopoDS_Edge> vecEdge(edges, edges + count);
+    const std::size_t chainCount =
+            TopoDsUtils::sortConnectedEdges(&vecEdge, tolerance);
+    Handle_ShapeExtend_WireData wireData = new ShapeExtend_WireData;
+    for (const TopoDS_Edge& edge : vecEdge)
+        wireData->Add(edge);
+    return TopoDsUtils::fixedWire(wireData, chainCount <= 1);
+}
+
+/*! Builds concurrently the wires of the \p count edge sets of array
+ *  \p edgeSets into array \p wires, with makeWireFromEdges()
+ *
+ *  \param threadCount  Maximum count of threads to use (0 means as many as
+ *                      the hardware supports)
+ */
+void TopoDsUtils::makeWires(
+        const std::vector<TopoDS_Edge>* edgeSets,
+        std::size_t count,
+        TopoDS_Wire* wires,
+        double tolerance,
+        unsigned threadCount)
+{
+    auto fnChunk = [=] (std::size_t iBegin, std::size_t iEnd) {
+        for (std::size_t i = iBegin; i < iEnd; ++i) {
+            const std::vector<TopoDS_Edge>& edges = edgeSets[i];
+            wires[i] = TopoDsUtils::makeWireFromEdges(
+                        edges.data(), edges.size(), tolerance);
+        }
+    };
+    cpp::parallelForRanges(count, fnChunk, threadCount);
+}
+
+/*! Reorders and reorients \p edges so they form chains, the end point of each
+ *  edge being connected to the start point of the next one
+ *
+ *  End points are matched within \p tolerance (negative value means the
+ *  greatest tolerance of the edge vertices) using a hashed uniform grid, so
+ *  the cost is linear in the count of edges.
+ *  Chains are stored one after the other, edges without vertices are put at
+ *  the end.
+ *
+ *  Returns the count of chains (1 when \p edges form a single connected
+ *  wire)
+ */
+std::size_t TopoDsUtils::sortConnectedEdges(
+        std::vector<TopoDS_Edge>* edges, double tolerance)
+{
+    if (edges->empty())
+        return 0;
+    if (tolerance < 0.)
+        tolerance = internal::edgeVerticesTolerance(*edges);
+    tolerance = std::max(tolerance, Precision::Confusion());
+
+    const internal::EdgeConnectivity connectivity(*edges, tolerance);
+    std::vector<bool> isEdgeUsed(edges->size(), false);
+    std::vector<TopoDS_Edge> sortedEdges;
+    sortedEdges.reserve(edges->size());
+    std::vector<TopoDS_Edge> isolatedEdges;
+    std::size_t chainCount = 0;
+    for (std::size_t start = 0; start < edges->size(); ++start) {
+        if (isEdgeUsed.at(start))
+            continue;
+        isEdgeUsed.at(start) = true;
+        if (!connectivity.hasEndPoints(start)) {
+            isolatedEdges.push_back(edges->at(start));
+            continue;
+        }
+
+        std::deque<TopoDS_Edge> chain;
+        chain.push_back(edges->at(start));
+        // Grow the chain forward from the end point of its last edge
+        gp_Pnt chainEnd = connectivity.endPoint(2 * start + 1);
+        std::ptrdiff_t id = connectivity.findNearEndPoint(chainEnd, isEdgeUsed);
+        while (id >= 0) {
+            const std::size_t edgeId = static_cast<std::size_t>(id) / 2;
+            const bool isReversed = (id % 2) == 1;
+            isEdgeUsed.at(edgeId) = true;
+            const TopoDS_Edge& edge = edges->at(edgeId);
+            chain.push_back(isReversed ? TopoDS::Edge(edge.Reversed()) : edge);
+            chainEnd = connectivity.endPoint(isReversed ? 2 * edgeId : 2 * edgeId + 1);
+            id = connectivity.findNearEndPoint(chainEnd, isEdgeUsed);
+        }
+
+        // Grow the chain backward from the start point of its first edge
+        gp_Pnt chainStart = connectivity.endPoint(2 * start);
+        id = connectivity.findNearEndPoint(chainStart, isEdgeUsed);
+        while (id >= 0) {
+            const std::size_t edgeId = static_cast<std::size_t>(id) / 2;
+            const bool isReversed = (id % 2) == 0;
+            isEdgeUsed.at(edgeId) = true;
+            const TopoDS_Edge& edge = edges->at(edgeId);
+            chain.push_front(isReversed ? TopoDS::Edge(edge.Reversed()) : edge);
+            chainStart = connectivity.endPoint(isReversed ? 2 * edgeId + 1 : 2 * edgeId);
+            id = connectivity.findNearEndPoint(chainStart, isEdgeUsed);
+        }
+
+        sortedEdges.insert(sortedEdges.end(), chain.begin(), chain.end());
+        ++chainCount;
+    }
+
+    chainCount += isolatedEdges.size();
+    sortedEdges.insert(sortedEdges.end(), isolatedEdges.begin(), isolatedEdges.end());
+    edges->swap(sortedEdges);
+    return chainCount;
 }
 
-TopoDS_Wire TopoDsUtils::fixedWire(const Handle_ShapeExtend_WireData &wireData)
+TopoDS_Wire TopoDsUtils::fixedWire(
+        const Handle_ShapeExtend_WireData &wireData, bool isOrdered)
 {
     ShapeFix_Wire fix;
     fix.Load(wireData);
+    if (isOrdered)
+        fix.FixReorderMode() = 0; // Skip the reorder analysis of Perform()
     fix.Perform();
-    fix.FixReorder();
+    if (!isOrdered)
+        fix.FixReorder();
     fix.FixConnected();
     return fix.WireAPIMake();
 }
@@ -16,38 +16,67 @@
 #pragma once
 
 #include "occtools.h"
+#include "../cpptools/parallel_utils.h"
 
 #include <BRep_Builder.hxx>
 #include <Handle_ShapeExtend_WireData.hxx>
 #include <TopAbs_ShapeEnum.hxx>
+#include <TopExp.hxx>
 #include <TopExp_Explorer.hxx>
+#include <TopTools_IndexedMapOfShape.hxx>
 #include <TopoDS_Compound.hxx>
+#include <TopoDS_Edge.hxx>
 #include <TopoDS_Face.hxx>
 #include <TopoDS_Wire.hxx>
 #include <gp_Vec.hxx>
 
 #include <string>
+#include <vector>
 
 namespace occ {
 
 class OCCTOOLS_EXPORT TopoDsUtils
 {
 public:
+    enum BinaryCompression
+    {
+        NoCompression,
+        ZlibCompression
+    };
+
     // Make facilities
     template<typename FWD_ITERATOR>
     static TopoDS_Compound makeCompoundFromShapeRange(
             FWD_ITERATOR iBegin, FWD_ITERATOR iEnd);
 
     template<typename CONTAINER>
-    static TopoDS_Compound makeCompoundFromShapeContainer(CONTAINER cnter);
+    static TopoDS_Compound makeCompoundFromShapeContainer(const CONTAINER& cnter);
+
+    static TopoDS_Compound makeCompoundFromShapes(
+            const TopoDS_Shape* shapes, std::size_t count);
 
     template<typename FWD_ITERATOR>
     static TopoDS_Wire makeWireFromEdgeRange(
-            FWD_ITERATOR iBegin, FWD_ITERATOR iEnd);
+            FWD_ITERATOR iBegin, FWD_ITERATOR iEnd, double tolerance = -1.);
+
+    static TopoDS_Wire makeWireFromEdges(
+            const TopoDS_Edge* edges, std::size_t count, double tolerance = -1.);
+    static void makeWires(
+            const std::vector<TopoDS_Edge>* edgeSets,
+            std::size_t count,
+            TopoDS_Wire* wires,
+            double tolerance = -1.,
+            unsigned threadCount = 0);
+    static std::size_t sortConnectedEdges(
+            std::vector<TopoDS_Edge>* edges, double tolerance = -1.);
 
     // TopoDS_Shape <-> std::string
     static std::string shapeToString(const TopoDS_Shape& shape);
     static TopoDS_Shape shapeFromString(const std::string& str);
+    static std::string shapeToBinaryString(
+            const TopoDS_Shape& shape,
+            BinaryCompression compression = NoCompression);
+    static TopoDS_Shape shapeFromBinaryString(const std::string& str);
 
     // TopExp_Explorer facilities
     template<typename FUNC>
@@ -69,16 +98,43 @@ public:
     template<typename FUNC>
     static void forEachFace(const TopoDS_Shape& shape, FUNC fn);
 
+    // Parallel facilities
+    template<typename FUNC>
+    static void parallelForEach(
+            const TopoDS_Shape& shape,
+            TopAbs_ShapeEnum shapeType,
+            FUNC fn,
+            std::size_t grainSize = 1,
+            unsigned threadCount = 0);
+
+    template<typename FUNC>
+    static void parallelForEachVertex(
+            const TopoDS_Shape& shape,
+            FUNC fn,
+            std::size_t grainSize = 1,
+            unsigned threadCount = 0);
+
+    template<typename FUNC>
+    static void parallelForEachEdge(
+            const TopoDS_Shape& shape,
+            FUNC fn,
+            std::size_t grainSize = 1,
+            unsigned threadCount = 0);
+
+    template<typename FUNC>
+    static void parallelForEachFace(
+            const TopoDS_Shape& shape,
+            FUNC fn,
+            std::size_t grainSize = 1,
+            unsigned threadCount = 0);
+
     // Misc
     static gp_Vec normalToFaceAtUV(
             const TopoDS_Face& face, Standard_Real u, Standard_Real v);
 
 private:
-    static Handle_ShapeExtend_WireData createShapeExtendWireData();
-    static void addEdge(
-            const Handle_ShapeExtend_WireData& wireData,
-            const TopoDS_Edge& edge);
-    static TopoDS_Wire fixedWire(const Handle_ShapeExtend_WireData& wireData);
+    static TopoDS_Wire fixedWire(
+            const Handle_ShapeExtend_WireData& wireData, bool isOrdered);
 };
 
 
@@ -109,9 +165,12 @@ TopoDS_Compound TopoDsUtils::makeCompoundFromShapeRange(
     return cmpd;
 }
 
-//! Same as occ::makeCompoundFromShapeRange(cnter.begin(), cnter.end())
+/*! Same as occ::makeCompoundFromShapeRange(cnter.begin(), cnter.end())
+ *
+ *  \p cnter is not copied, temporary containers can be passed too
+ */
 template<typename CONTAINER>
-TopoDS_Compound TopoDsUtils::makeCompoundFromShapeContainer(CONTAINER cnter)
+TopoDS_Compound TopoDsUtils::makeCompoundFromShapeContainer(const CONTAINER& cnter)
 {
     return TopoDsUtils::makeCompoundFromShapeRange(cnter.begin(), cnter.end());
 }
@@ -119,20 +178,21 @@ TopoDS_Compound TopoDsUtils::makeCompoundFromShapeContainer(CONTAINER cnter)
 /*! Build a topologic wire of edges denoted between the begin and end
  *  iterators \p iBegin and \p iEnd
  *
+ *  Edges can be in any order, see makeWireFromEdges()
+ *
  * \note The value type of \p iBegin and \p iEnd (accessed with operator*) must
  *       be TopoDS_Edge
  */
 template<typename FWD_ITERATOR>
 TopoDS_Wire TopoDsUtils::makeWireFromEdgeRange(
-        FWD_ITERATOR iBegin, FWD_ITERATOR iEnd)
+        FWD_ITERATOR iBegin, FWD_ITERATOR iEnd, double tolerance)
 {
-    Handle_ShapeExtend_WireData wireData =
-            TopoDsUtils::createShapeExtendWireData();
+    std::vector<TopoDS_Edge> edges;
     while (iBegin != iEnd) {
-        TopoDsUtils::addEdge(wireData, *iBegin);
+        edges.push_back(*iBegin);
         ++iBegin;
     }
-    return TopoDsUtils::fixedWire(wireData);
+    return TopoDsUtils::makeWireFromEdges(edges.data(), edges.size(), tolerance);
 }
 
 /*! Applies function \p fn to each explored shape inside \p shape */
@@ -140,7 +200,8 @@ template<typename FUNC>
 void TopoDsUtils::forEach(
         const TopoDS_Shape &shape, TopAbs_ShapeEnum shapeType, FUNC fn)
 {
-    TopoDsUtils::forEach(TopExp_Explorer(shape, shapeType), std::move(fn));
+    TopExp_Explorer explorer(shape, shapeType);
+    TopoDsUtils::forEach(explorer, std::move(fn));
 }
 
 /*! Applies function \p fn to each explored shape with \p explorer */
@@ -177,4 +238,60 @@ void TopoDsUtils::forEachFace(const TopoDS_Shape& shape, FUNC fn)
     TopoDsUtils::forEach(shape, TopAbs_FACE, std::move(fn));
 }
 
+/*! Applies function \p fn concurrently to each unique sub-shape of \p shape
+ *  of type \p shapeType
+ *
+ *  Sub-shapes are first collected with TopExp::MapShapes(), so a sub-shape
+ *  shared by several parents (ex: an edge bounding two faces) is visited
+ *  once. Then they are dispatched to threads by contiguous chunks of at least
+ *  \p grainSize items.
+ *
+ *  \p fn is called with a const TopoDS_Shape& and must be safe to call
+ *  concurrently. If \p fn throws, the exception is rethrown in the calling
+ *  thread once all threads are finished.
+ *
+ *  \param threadCount  Maximum count of threads to use (0 means as many as
+ *                      the hardware supports)
+ */
+template<typename FUNC>
+void TopoDsUtils::parallelForEach(
+        const TopoDS_Shape& shape,
+        TopAbs_ShapeEnum shapeType,
+        FUNC fn,
+        std::size_t grainSize,
+        unsigned threadCount)
+{
+    TopTools_IndexedMapOfShape mapShape;
+    TopExp::MapShapes(shape, shapeType, mapShape);
+    auto fnChunk = [&] (std::size_t iBegin, std::size_t iEnd) {
+        for (std::size_t i = iBegin; i < iEnd; ++i)
+            fn(mapShape.FindKey(static_cast<int>(i) + 1));
+    };
+    cpp::parallelForRanges(mapShape.Extent(), fnChunk, threadCount, grainSize);
+}
+
+template<typename FUNC>
+void TopoDsUtils::parallelForEachVertex(
+        const TopoDS_Shape& shape, FUNC fn, std::size_t grainSize, unsigned threadCount)
+{
+    TopoDsUtils::parallelForEach(
+                shape, TopAbs_VERTEX, std::move(fn), grainSize, threadCount);
+}
+
+template<typename FUNC>
+void TopoDsUtils::parallelForEachEdge(
+        const TopoDS_Shape& shape, FUNC fn, std::size_t grainSize, unsigned threadCount)
+{
+    TopoDsUtils::parallelForEach(
+                shape, TopAbs_EDGE, std::move(fn), grainSize, threadCount);
+}
+
+template<typename FUNC>
+void TopoDsUtils::parallelForEachFace(
+        const TopoDS_Shape& shape, FUNC fn, std::size_t grainSize, unsigned threadCount)
+{
+    TopoDsUtils::parallelForEach(
+                shape, TopAbs_FACE, std::move(fn), grainSize, threadCount);
+}
+
 } // namespace occ
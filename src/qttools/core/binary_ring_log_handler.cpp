@@ -0,0 +1,346 @@
+/****************************************************************************
+**  FougTools
+**  Copyright Fougue (30 Mar. 2015)
+**  contact@fougue.pro
+**
+** This software is a computer program whose purpose is to provide utility
+** tools for the C++ language and the Qt toolkit.
+**
+** This software is governed by the CeCILL-C license under French law and
+** abiding by the rules of distribution of free software.  You can  use,
+** modify and/ or redistribute the software under the terms of the CeCILL-C
+** license as circulated by CEA, CNRS and INRIA at the following URL
+** "http://www.cecill.info".
+****************************************************************************/
+
+
+#include "binary_ring_log_handler.h"
+
+#include <QtCore/QThread>
+#include <chrono>
+#include <cstring>
+
+namespace qtcore {
+
+//! Header at the beginning of the ring file, offsets are monotonic (not
+//! wrapped)
+struct BinaryRingLogHandler::FileHeader
+{
+    char magic[8];
+    quint32 version;
+    quint32 headerSize;
+    quint64 capacity; // Bytes of the ring data following the header
+    quint64 head; // Offset where the next record is written
+    quint64 tail; // Offset of the oldest record
+    quint64 recordCount; // Count of records written since creation
+    quint64 reserved[2];
+};
+
+/*! 8-byte aligned record in the ring, followed by the UTF-16 message
+ *
+ *  Padding records only have the first 8 bytes (size and flags) written, so
+ *  they fit in any space left at the end of the ring
+ */
+struct BinaryRingLogHandler::RecordHeader
+{
+    enum Flag { PaddingFlag = 0x01 };
+    enum { PrefixSize = 8 };
+
+    quint32 size; // Total size, including this header and alignment
+    quint8 msgType;
+    quint8 flags;
+    quint16 reserved;
+    qint64 timestampUsec;
+    quint64 threadId;
+    quint32 msgLength; // In UTF-16 code units
+    quint32 reserved2;
+};
+
+namespace internal {
+
+static const char binaryRingLogMagic[8] = { 'Q', 'T', 'L', 'O', 'G', 'R', 'N', 'G' };
+static const quint32 binaryRingLogVersion = 1;
+
+static quint64 alignedTo8(quint64 size)
+{
+    return (size + 7) & ~quint64(7);
+}
+
+} // namespace internal
+
+/*!
+ * \class BinaryRingLogHandler
+ * \brief Log handler writing compact binary records into a memory-mapped
+ *        ring file
+ *
+ * Each record holds the timestamp, the thread id, the type and the message
+ * (UTF-16, as stored by QString). Writing a record is a couple of memcpy()
+ * into the mapped file, without formatting nor text I/O. When the ring is
+ * full the oldest records are overwritten.
+ *
+ * As records are written to a shared file mapping, they survive a crash of
+ * the process : the operating system writes back the mapped pages. Use
+ * readRecords() to decode a ring file, oldest record first.
+ *
+ * The file uses the native byte order, it is not meant to be exchanged
+ * between platforms.
+ *
+ * \headerfile binary_ring_log_handler.h <qttools/core/binary_ring_log_handler.h>
+ * \ingroup qttools_core
+ */
+
+BinaryRingLogHandler::BinaryRingLogHandler()
+    : m_header(NULL),
+      m_data(NULL)
+{
+}
+
+BinaryRingLogHandler::~BinaryRingLogHandler()
+{
+    this->close();
+}
+
+/*! \brief Opens (or creates) the ring file \p filePath with \p capacity
+ *         bytes of record data
+ *
+ *  An existing ring file of the same capacity is continued, otherwise it is
+ *  reset.
+ *
+ *  Returns false on error, see errorString()
+ */
+bool BinaryRingLogHandler::open(const QString& filePath, qint64 capacity)
+{
+    QMutexLocker locker(&m_mutex); Q_UNUSED(locker);
+    if (m_header != NULL) {
+        m_file.unmap(reinterpret_cast<uchar*>(m_header));
+        m_file.close();
+        m_header = NULL;
+        m_data = NULL;
+    }
+
+    const quint64 ringCapacity =
+            internal::alignedTo8(qMax(capacity, qint64(1024)));
+    const qint64 fileSize = sizeof(FileHeader) + ringCapacity;
+    m_file.setFileName(filePath);
+    if (!m_file.open(QIODevice::ReadWrite)) {
+        m_errorString = m_file.errorString();
+        return false;
+    }
+
+    FileHeader existingHeader;
+    const bool isExistingRing =
+            m_file.size() == fileSize
+            && m_file.read(reinterpret_cast<char*>(&existingHeader),
+                           sizeof(FileHeader)) == sizeof(FileHeader)
+            && std::memcmp(existingHeader.magic, internal::binaryRingLogMagic, 8) == 0
+            && existingHeader.version == internal::binaryRingLogVersion
+            && existingHeader.capacity == ringCapacity
+            && existingHeader.tail <= existingHeader.head
+            && existingHeader.head - existingHeader.tail <= ringCapacity;
+    if (!isExistingRing && !m_file.resize(fileSize)) {
+        m_errorString = m_file.errorString();
+        m_file.close();
+        return false;
+    }
+
+    uchar* contents = m_file.map(0, fileSize);
+    if (contents == NULL) {
+        m_errorString = m_file.errorString();
+        m_file.close();
+        return false;
+    }
+
+    m_header = reinterpret_cast<FileHeader*>(contents);
+    m_data = contents + sizeof(FileHeader);
+    if (!isExistingRing) {
+        std::memset(m_header, 0, sizeof(FileHeader));
+        std::memcpy(m_header->magic, internal::binaryRingLogMagic, 8);
+        m_header->version = internal::binaryRingLogVersion;
+        m_header->headerSize = sizeof(FileHeader);
+        m_header->capacity = ringCapacity;
+    }
+    m_errorString.clear();
+    return true;
+}
+
+//! Unmaps and closes the ring file, records written so far are kept
+void BinaryRingLogHandler::close()
+{
+    QMutexLocker locker(&m_mutex); Q_UNUSED(locker);
+    if (m_header != NULL) {
+        m_file.unmap(reinterpret_cast<uchar*>(m_header));
+        m_header = NULL;
+        m_data = NULL;
+    }
+    m_file.close();
+}
+
+bool BinaryRingLogHandler::isOpen() const
+{
+    QMutexLocker locker(&m_mutex); Q_UNUSED(locker);
+    return m_header != NULL;
+}
+
+QString BinaryRingLogHandler::errorString() const
+{
+    QMutexLocker locker(&m_mutex); Q_UNUSED(locker);
+    return m_errorString;
+}
+
+//! Count of records written in the ring file since its creation
+quint64 BinaryRingLogHandler::recordCount() const
+{
+    QMutexLocker locker(&m_mutex); Q_UNUSED(locker);
+    return m_header != NULL ? m_header->recordCount : 0;
+}
+
+/*! \brief Appends a record for message \p msg to the ring
+ *
+ *  Messages larger than a quarter of the ring capacity are truncated.
+ *  Does nothing if the ring file is not open.
+ */
+void BinaryRingLogHandler::handle(Log::MessageType msgType, const QString& msg)
+{
+    const qint64 timestampUsec =
+            std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::system_clock::now().time_since_epoch()).count();
+    const quint64 threadId =
+            reinterpret_cast<quintptr>(QThread::currentThreadId());
+
+    QMutexLocker locker(&m_mutex); Q_UNUSED(locker);
+    if (m_header == NULL)
+        return;
+
+    const quint64 capacity = m_header->capacity;
+    const quint64 maxMsgLength = (capacity / 4 - sizeof(RecordHeader)) / sizeof(QChar);
+    const quint32 msgLength =
+            static_cast<quint32>(qMin(quint64(msg.size()), maxMsgLength));
+    const quint64 recordSize =
+            internal::alignedTo8(sizeof(RecordHeader) + msgLength * sizeof(QChar));
+
+    // A record is never split around the end of the ring, the remaining
+    // space is filled with a padding record instead
+    const quint64 trailingSize = capacity - m_header->head % capacity;
+    if (trailingSize < recordSize) {
+        this->makeRoom(trailingSize);
+        RecordHeader padding;
+        std::memset(&padding, 0, sizeof(RecordHeader));
+        padding.size = static_cast<quint32>(trailingSize);
+        padding.flags = RecordHeader::PaddingFlag;
+        std::memcpy(m_data + m_header->head % capacity,
+                    &padding,
+                    RecordHeader::PrefixSize);
+        m_header->head += trailingSize;
+    }
+
+    this->makeRoom(recordSize);
+    uchar* recordData = m_data + m_header->head % capacity;
+    RecordHeader record;
+    record.size = static_cast<quint32>(recordSize);
+    record.msgType = static_cast<quint8>(msgType);
+    record.flags = 0;
+    record.reserved = 0;
+    record.timestampUsec = timestampUsec;
+    record.threadId = threadId;
+    record.msgLength = msgLength;
+    record.reserved2 = 0;
+    std::memcpy(recordData, &record, sizeof(RecordHeader));
+    std::memcpy(recordData + sizeof(RecordHeader),
+                msg.constData(),
+                msgLength * sizeof(QChar));
+    // Published last, so a crash while copying leaves the previous state
+    m_header->head += recordSize;
+    ++(m_header->recordCount);
+}
+
+/*! \brief Decodes the records of ring file \p filePath, oldest first
+ *
+ *  Returns an empty list on error, \p errorString then describes it
+ */
+QList<BinaryRingLogHandler::Record> BinaryRingLogHandler::readRecords(
+        const QString& filePath, QString* errorString)
+{
+    QList<Record> records;
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        if (errorString != NULL)
+            *errorString = file.errorString();
+        return records;
+    }
+
+    const QByteArray contents = file.readAll();
+    FileHeader header;
+    std::memset(&header, 0, sizeof(FileHeader));
+    if (contents.size() >= static_cast<int>(sizeof(FileHeader)))
+        std::memcpy(&header, contents.constData(), sizeof(FileHeader));
+    const bool isValidHeader =
+            std::memcmp(header.magic, internal::binaryRingLogMagic, 8) == 0
+            && header.version == internal::binaryRingLogVersion
+            && header.capacity > 0
+            && static_cast<quint64>(contents.size()) == header.headerSize + header.capacity
+            && header.tail <= header.head
+            && header.head - header.tail <= header.capacity;
+    if (!isValidHeader) {
+        if (errorString != NULL)
+            *errorString = QLatin1String("Not a binary ring log file");
+        return records;
+    }
+
+    const char* data = contents.constData() + header.headerSize;
+    quint64 pos = header.tail;
+    while (pos < header.head) {
+        const quint64 offset = pos % header.capacity;
+        RecordHeader record;
+        std::memset(&record, 0, sizeof(RecordHeader));
+        std::memcpy(&record, data + offset, RecordHeader::PrefixSize);
+        const bool isPadding = (record.flags & RecordHeader::PaddingFlag) != 0;
+        bool isValidRecord =
+                record.size >= RecordHeader::PrefixSize
+                && record.size <= header.capacity - offset
+                && record.size <= header.head - pos;
+        if (isValidRecord && !isPadding) {
+            isValidRecord = record.size >= sizeof(RecordHeader);
+            if (isValidRecord) {
+                std::memcpy(&record, data + offset, sizeof(RecordHeader));
+                isValidRecord =
+                        record.msgLength * sizeof(QChar)
+                        <= record.size - sizeof(RecordHeader);
+            }
+        }
+        if (!isValidRecord)
+            break; // Corrupted
+        if (!isPadding) {
+            Record rec;
+            rec.timestampUsec = record.timestampUsec;
+            rec.threadId = record.threadId;
+            rec.msgType = static_cast<Log::MessageType>(record.msgType);
+            rec.msg = QString(reinterpret_cast<const QChar*>(
+                                  data + offset + sizeof(RecordHeader)),
+                              record.msgLength);
+            records.append(rec);
+        }
+        pos += record.size;
+    }
+    if (errorString != NULL)
+        errorString->clear();
+    return records;
+}
+
+//! Drops the oldest records so that \p size more bytes fit in the ring
+void BinaryRingLogHandler::makeRoom(quint64 size)
+{
+    const quint64 capacity = m_header->capacity;
+    while (m_header->head + size - m_header->tail > capacity) {
+        RecordHeader oldest;
+        std::memcpy(&oldest,
+                    m_data + m_header->tail % capacity,
+                    RecordHeader::PrefixSize);
+        if (oldest.size < RecordHeader::PrefixSize || oldest.size > capacity) {
+            m_header->tail = m_header->head; // Corrupted, drop everything
+            return;
+        }
+        m_header->tail += oldest.size;
+    }
+}
+
+} // namespace qtcore
@@ -0,0 +1,66 @@
+/****************************************************************************
+**  FougTools
+**  Copyright Fougue (30 Mar. 2015)
+**  contact@fougue.pro
+**
+** This software is a computer program whose purpose is to provide utility
+** tools for the C++ language and the Qt toolkit.
+**
+** This software is governed by the CeCILL-C license under French law and
+** abiding by the rules of distribution of free software.  You can  use,
+** modify and/ or redistribute the software under the terms of the CeCILL-C
+** license as circulated by CEA, CNRS and INRIA at the following URL
+** "http://www.cecill.info".
+****************************************************************************/
+
+
+#pragma once
+
+#include "log.h"
+#include <QtCore/QFile>
+#include <QtCore/QList>
+#include <QtCore/QMutex>
+#include <QtCore/QString>
+
+namespace qtcore {
+
+class QTTOOLS_CORE_EXPORT BinaryRingLogHandler : public AbstractLogHandler
+{
+public:
+    struct Record
+    {
+        qint64 timestampUsec; // Since epoch (UTC)
+        quint64 threadId;
+        Log::MessageType msgType;
+        QString msg;
+    };
+
+    BinaryRingLogHandler();
+    ~BinaryRingLogHandler();
+
+    bool open(const QString& filePath, qint64 capacity = 4 * 1024 * 1024);
+    void close();
+    bool isOpen() const;
+    QString errorString() const;
+
+    quint64 recordCount() const;
+
+    void handle(Log::MessageType msgType, const QString& msg) override;
+
+    static QList<Record> readRecords(
+            const QString& filePath, QString* errorString = NULL);
+
+private:
+    struct FileHeader;
+    struct RecordHeader;
+
+    void makeRoom(quint64 size);
+
+    mutable QMutex m_mutex;
+    QFile m_file;
+    FileHeader* m_header;
+    uchar* m_data;
+    QString m_errorString;
+};
+
+} // namespace qtcore
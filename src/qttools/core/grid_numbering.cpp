@@ -77,6 +77,68 @@ void GridNumbering::setSweepMode(SweepMode sweepMode)
     m_sweepMode = sweepMode;
 }
 
+/*!
+ * \brief Returns the index of the cell at (\p row, \p col) in a grid of
+ *        \p rowCount x \p colCount cells
+ *
+ * The index is computed analytically in O(1), without materializing the grid
+ *
+ * \sa cellAt()
+ */
+int GridNumbering::cellIndex(
+        int row, int col, int rowCount, int colCount, int startIndex) const
+{
+    // Normalize to the top-left corner
+    if (m_startCorner == Qt::BottomLeftCorner || m_startCorner == Qt::BottomRightCorner)
+        row = rowCount - 1 - row;
+    if (m_startCorner == Qt::TopRightCorner || m_startCorner == Qt::BottomRightCorner)
+        col = colCount - 1 - col;
+
+    const bool isHorizontal = m_orientation == Qt::Horizontal;
+    const int dim1 = isHorizontal ? row : col;
+    const int dim2Count = isHorizontal ? colCount : rowCount;
+    int dim2 = isHorizontal ? col : row;
+    if (m_sweepMode == ZigZag && dim1 % 2 == 1)
+        dim2 = dim2Count - 1 - dim2;
+    return startIndex + dim1 * dim2Count + dim2;
+}
+
+/*!
+ * \brief Computes the cell (\p row, \p col) numbered \p index in a grid of
+ *        \p rowCount x \p colCount cells
+ *
+ * This is the inverse of cellIndex(), computed in O(1)
+ *
+ * \return false if \p index is out of the grid (then \p row and \p col are
+ *         not modified)
+ */
+bool GridNumbering::cellAt(
+        int index, int rowCount, int colCount, int* row, int* col, int startIndex) const
+{
+    const int offset = index - startIndex;
+    if (rowCount <= 0 || colCount <= 0 || offset < 0 || offset >= rowCount * colCount)
+        return false;
+
+    const bool isHorizontal = m_orientation == Qt::Horizontal;
+    const int dim2Count = isHorizontal ? colCount : rowCount;
+    const int dim1 = offset / dim2Count;
+    int dim2 = offset % dim2Count;
+    if (m_sweepMode == ZigZag && dim1 % 2 == 1)
+        dim2 = dim2Count - 1 - dim2;
+
+    int cellRow = isHorizontal ? dim1 : dim2;
+    int cellCol = isHorizontal ? dim2 : dim1;
+    if (m_startCorner == Qt::BottomLeftCorner || m_startCorner == Qt::BottomRightCorner)
+        cellRow = rowCount - 1 - cellRow;
+    if (m_startCorner == Qt::TopRightCorner || m_startCorner == Qt::BottomRightCorner)
+        cellCol = colCount - 1 - cellCol;
+    if (row != NULL)
+        *row = cellRow;
+    if (col != NULL)
+        *col = cellCol;
+    return true;
+}
+
 /*!
  * \brief Computes all the indexes of a grid's cells
  *
@@ -100,46 +162,83 @@ void GridNumbering::setSweepMode(SweepMode sweepMode)
  * \param rowCount Count of rows in the grid
  * \param colCount Count of columns in the grid
  * \param startIndex The first index to start from (usually 0 or 1)
+ *
+ * \sa flatGridIndexes()
  */
 QVector< QVector<int> > GridNumbering::gridIndexes(
         const GridNumbering& gridNb, int rowCount, int colCount, int startIndex)
 {
-    const bool isZigZag = gridNb.sweepMode() == ZigZag;
-    const Qt::Corner nbCorner = gridNb.startCorner();
-    const Qt::Orientation nbOrientation = gridNb.orientation();
-
-    // Create normalized grid
+    const QVector<int> flatGrid =
+            GridNumbering::flatGridIndexes(gridNb, rowCount, colCount, startIndex);
     QVector< QVector<int> > grid;
     grid.resize(rowCount);
-    for (int row = 0; row < rowCount; ++row)
-        grid[row].resize(colCount);
-
-    // Fill grid (handle the orientation and sweep mode)
-    const int dim1Count = nbOrientation == Qt::Horizontal ? rowCount : colCount;
-    const int dim2Count = nbOrientation == Qt::Horizontal ? colCount : rowCount;
-    int index = startIndex;
-    for (int dim1 = 0; dim1 < dim1Count; ++dim1) {
-        const bool isEvenDim1 = ((dim1 + 1) % 2) == 0;
-        const int dim2Start = isEvenDim1 && isZigZag ? dim2Count - 1 : 0;
-        const int dim2End = isEvenDim1 && isZigZag ? -1 : dim2Count;
-        const int dim2Incr = isEvenDim1 && isZigZag ? -1 : 1;
-        for (int dim2 = dim2Start; dim2 != dim2End; dim2 += dim2Incr) {
-            const int row = nbOrientation == Qt::Horizontal ? dim1 : dim2;
-            const int col = nbOrientation == Qt::Horizontal ? dim2 : dim1;
-            grid[row][col] = index++;
-        } // end for(dim2)
-    } // end for(dim1)
-
-    // Handle left-right side
-    if (nbCorner == Qt::TopRightCorner || nbCorner == Qt::BottomRightCorner) {
-        for (int row = 0; row < rowCount; ++row)
-            std::reverse(grid[row].begin(), grid[row].end());
+    for (int row = 0; row < rowCount; ++row) {
+        const int* rowBegin = flatGrid.constData() + row * colCount;
+        grid[row] = QVector<int>(colCount);
+        std::copy(rowBegin, rowBegin + colCount, grid[row].begin());
     }
+    return grid;
+}
 
-    // Handle top-bottom side
-    if (nbCorner == Qt::BottomLeftCorner || nbCorner == Qt::BottomRightCorner)
-        std::reverse(grid.begin(), grid.end());
+/*!
+ * \brief Same as gridIndexes() but the result is a single row-major array,
+ *        index of cell (row, col) being at position row * colCount + col
+ */
+QVector<int> GridNumbering::flatGridIndexes(
+        const GridNumbering& gridNb, int rowCount, int colCount, int startIndex)
+{
+    QVector<int> grid;
+    if (rowCount > 0 && colCount > 0) {
+        grid.resize(rowCount * colCount);
+        GridNumbering::fillGridIndexes(
+                    gridNb, rowCount, colCount, grid.data(), startIndex);
+    }
     return grid;
 }
 
+/*!
+ * \brief Writes the indexes of a grid's cells into the row-major buffer
+ *        \p indexes (of at least \p rowCount x \p colCount items)
+ *
+ * Cells are written sequentially, with no allocation
+ */
+void GridNumbering::fillGridIndexes(
+        const GridNumbering& gridNb,
+        int rowCount,
+        int colCount,
+        int* indexes,
+        int startIndex)
+{
+    const bool isBottom =
+            gridNb.startCorner() == Qt::BottomLeftCorner
+            || gridNb.startCorner() == Qt::BottomRightCorner;
+    const bool isRight =
+            gridNb.startCorner() == Qt::TopRightCorner
+            || gridNb.startCorner() == Qt::BottomRightCorner;
+    const bool isHorizontal = gridNb.orientation() == Qt::Horizontal;
+    const bool isZigZag = gridNb.sweepMode() == ZigZag;
+
+    // Index is linear along a row of the normalized grid : only the first
+    // index and the step per column depend on the row
+    for (int row = 0; row < rowCount; ++row) {
+        const int normRow = isBottom ? rowCount - 1 - row : row;
+        int* rowIndexes = indexes + row * colCount;
+        if (isHorizontal) {
+            const bool isReversed = (isZigZag && normRow % 2 == 1) != isRight;
+            const int first = startIndex + normRow * colCount;
+            for (int col = 0; col < colCount; ++col)
+                rowIndexes[col] = first + (isReversed ? colCount - 1 - col : col);
+        }
+        else {
+            for (int col = 0; col < colCount; ++col) {
+                const int normCol = isRight ? colCount - 1 - col : col;
+                const bool isReversed = isZigZag && normCol % 2 == 1;
+                rowIndexes[col] =
+                        startIndex + normCol * rowCount
+                        + (isReversed ? rowCount - 1 - normRow : normRow);
+            }
+        }
+    }
+}
+
 } // namespace qtcore
@@ -43,11 +43,32 @@ public:
     SweepMode sweepMode() const;
     void setSweepMode(SweepMode sweepMode);
 
+    int cellIndex(
+            int row, int col, int rowCount, int colCount, int startIndex = 0) const;
+    bool cellAt(
+            int index,
+            int rowCount,
+            int colCount,
+            int* row,
+            int* col,
+            int startIndex = 0) const;
+
     static QVector< QVector<int> > gridIndexes(
             const GridNumbering& gridNb,
             int rowCount,
             int colCount,
             int startIndex = 0);
+    static QVector<int> flatGridIndexes(
+            const GridNumbering& gridNb,
+            int rowCount,
+            int colCount,
+            int startIndex = 0);
+    static void fillGridIndexes(
+            const GridNumbering& gridNb,
+            int rowCount,
+            int colCount,
+            int* indexes,
+            int startIndex = 0);
 private:
     Qt::Corner m_startCorner;
     Qt::Orientation m_orientation;
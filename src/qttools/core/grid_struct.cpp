@@ -84,4 +84,40 @@ void GridStruct::setItemNumbering(const GridNumbering& gridNb)
     m_gridNb = gridNb;
 }
 
+//! Is (\p row, \p col) a cell of the grid ?
+bool GridStruct::contains(int row, int col) const
+{
+    return 0 <= row && row < m_rowCount && 0 <= col && col < m_colCount;
+}
+
+/*!
+ * \brief Returns the index of cell (\p row, \p col) according to
+ *        itemNumbering(), or -1 if the cell is out of the grid
+ *
+ * Closed-form computation in O(1), the grid is not materialized
+ *
+ * \sa GridNumbering::cellIndex()
+ */
+int GridStruct::indexAt(int row, int col, int startIndex) const
+{
+    if (!this->contains(row, col))
+        return -1;
+    return m_gridNb.cellIndex(row, col, m_rowCount, m_colCount, startIndex);
+}
+
+/*!
+ * \brief Computes the cell (\p row, \p col) numbered \p index according to
+ *        itemNumbering()
+ *
+ * This is the inverse of indexAt(), computed in O(1)
+ *
+ * \return false if \p index is out of the grid
+ *
+ * \sa GridNumbering::cellAt()
+ */
+bool GridStruct::cellAt(int index, int* row, int* col, int startIndex) const
+{
+    return m_gridNb.cellAt(index, m_rowCount, m_colCount, row, col, startIndex);
+}
+
 } // namespace qtcore
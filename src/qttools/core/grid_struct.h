@@ -40,6 +40,10 @@ public:
     const GridNumbering& itemNumbering() const;
     void setItemNumbering(const GridNumbering& gridNb);
 
+    bool contains(int row, int col) const;
+    int indexAt(int row, int col, int startIndex = 0) const;
+    bool cellAt(int index, int* row, int* col, int startIndex = 0) const;
+
 private:
     int m_rowCount;
     int m_colCount;
@@ -0,0 +1,202 @@
+/****************************************************************************
+**  FougTools
+**  Copyright Fougue (30 Mar. 2015)
+**  contact@fougue.pro
+**
+** This software is a computer program whose purpose is to provide utility
+** tools for the C++ language and the Qt toolkit.
+**
+** This software is governed by the CeCILL-C license under French law and
+** abiding by the rules of distribution of free software.  You can  use,
+** modify and/ or redistribute the software under the terms of the CeCILL-C
+** license as circulated by CEA, CNRS and INRIA at the following URL
+** "http://www.cecill.info".
+****************************************************************************/
+
+
+#include "item_model_data_index.h"
+
+#include <QtCore/QAbstractItemModel>
+#include <algorithm>
+
+namespace qtcore {
+
+/*!
+ * \class ItemModelDataIndex
+ * \brief Hash index of the data in a column of an item model, the fast
+ *        alternative to ItemModelUtils::findDataInRow() for repeated lookups
+ *
+ * The index maps the data (of a role) of each top-level row to its row
+ * number. It is built on first lookup, then kept up to date with the signals
+ * of the model :
+ *   \li dataChanged() updates the changed rows only
+ *   \li rows appended or removed at the end are indexed incrementally
+ *   \li any other structural change (insertion in the middle, move, reset,
+ *       layout change, ...) invalidates the index, rebuilt on next lookup
+ *
+ * Values are bucketed by QVariant::toString(), then compared with
+ * QVariant::operator==() so results are the same as
+ * ItemModelUtils::findDataInRow(), without calling QAbstractItemModel::data()
+ * at lookup.
+ *
+ * \headerfile item_model_data_index.h <qttools/core/item_model_data_index.h>
+ * \ingroup qttools_core
+ */
+
+ItemModelDataIndex::ItemModelDataIndex(
+        const QAbstractItemModel* model, int col, int role, QObject* parent)
+    : QObject(parent),
+      m_model(model),
+      m_col(col),
+      m_role(role),
+      m_isDirty(true)
+{
+    if (model == NULL)
+        return;
+
+    typedef QAbstractItemModel Model;
+    QObject::connect(model, &Model::rowsInserted, this, &ItemModelDataIndex::onRowsInserted);
+    QObject::connect(model, &Model::rowsRemoved, this, &ItemModelDataIndex::onRowsRemoved);
+    QObject::connect(model, &Model::dataChanged, this, &ItemModelDataIndex::onDataChanged);
+    QObject::connect(model, &Model::rowsMoved, this, &ItemModelDataIndex::invalidate);
+    QObject::connect(model, &Model::columnsInserted, this, &ItemModelDataIndex::invalidate);
+    QObject::connect(model, &Model::columnsRemoved, this, &ItemModelDataIndex::invalidate);
+    QObject::connect(model, &Model::columnsMoved, this, &ItemModelDataIndex::invalidate);
+    QObject::connect(model, &Model::layoutChanged, this, &ItemModelDataIndex::invalidate);
+    QObject::connect(model, &Model::modelReset, this, &ItemModelDataIndex::invalidate);
+}
+
+const QAbstractItemModel* ItemModelDataIndex::model() const
+{
+    return m_model;
+}
+
+int ItemModelDataIndex::column() const
+{
+    return m_col;
+}
+
+int ItemModelDataIndex::role() const
+{
+    return m_role;
+}
+
+/*! \brief Returns the first row where the data is \p value
+ *  \retval -1 if \p value could not be found
+ */
+int ItemModelDataIndex::findRow(const QVariant& value) const
+{
+    const QVector<int> rows = this->findRows(value);
+    return !rows.isEmpty() ? rows.first() : -1;
+}
+
+//! Returns all the rows where the data is \p value, by ascending order
+QVector<int> ItemModelDataIndex::findRows(const QVariant& value) const
+{
+    this->ensureBuilt();
+    QVector<int> rows;
+    const QString key = ItemModelDataIndex::keyOf(value);
+    auto it = m_rowsByKey.constFind(key);
+    while (it != m_rowsByKey.constEnd() && it.key() == key) {
+        if (m_rowValues.at(it.value()) == value)
+            rows.append(it.value());
+        ++it;
+    }
+    std::sort(rows.begin(), rows.end());
+    return rows;
+}
+
+//! Forces the index to be rebuilt on next lookup
+void ItemModelDataIndex::invalidate()
+{
+    m_isDirty = true;
+    m_rowValues.clear();
+    m_rowsByKey.clear();
+}
+
+void ItemModelDataIndex::onRowsInserted(const QModelIndex& parent, int first, int last)
+{
+    if (parent.isValid() || m_isDirty)
+        return;
+    if (first != m_rowValues.size()) {
+        this->invalidate(); // Row numbers after first are shifted
+        return;
+    }
+    for (int row = first; row <= last; ++row)
+        this->indexRow(row);
+}
+
+void ItemModelDataIndex::onRowsRemoved(const QModelIndex& parent, int first, int last)
+{
+    if (parent.isValid() || m_isDirty)
+        return;
+    if (last != m_rowValues.size() - 1) {
+        this->invalidate();
+        return;
+    }
+    for (int row = last; row >= first; --row)
+        this->unindexRow(row);
+    m_rowValues.resize(first);
+}
+
+void ItemModelDataIndex::onDataChanged(
+        const QModelIndex& topLeft,
+        const QModelIndex& bottomRight,
+        const QVector<int>& roles)
+{
+    const bool isIndexedCell =
+            !m_isDirty
+            && !topLeft.parent().isValid()
+            && topLeft.column() <= m_col && m_col <= bottomRight.column()
+            && (roles.isEmpty() || roles.contains(m_role));
+    if (!isIndexedCell)
+        return;
+    for (int row = topLeft.row(); row <= bottomRight.row(); ++row) {
+        this->unindexRow(row);
+        this->indexRow(row);
+    }
+}
+
+QString ItemModelDataIndex::keyOf(const QVariant& value)
+{
+    return value.toString();
+}
+
+QVariant ItemModelDataIndex::modelData(int row) const
+{
+    return m_model->data(m_model->index(row, m_col), m_role);
+}
+
+void ItemModelDataIndex::indexRow(int row)
+{
+    if (row >= m_rowValues.size())
+        m_rowValues.resize(row + 1);
+    m_rowValues[row] = this->modelData(row);
+    m_rowsByKey.insert(ItemModelDataIndex::keyOf(m_rowValues.at(row)), row);
+}
+
+void ItemModelDataIndex::unindexRow(int row)
+{
+    if (row < m_rowValues.size())
+        m_rowsByKey.remove(ItemModelDataIndex::keyOf(m_rowValues.at(row)), row);
+}
+
+void ItemModelDataIndex::ensureBuilt() const
+{
+    if (!m_isDirty)
+        return;
+    m_rowValues.clear();
+    m_rowsByKey.clear();
+    if (m_model != NULL) {
+        const int rowCount = m_model->rowCount();
+        m_rowValues.resize(rowCount);
+        m_rowsByKey.reserve(rowCount);
+        for (int row = 0; row < rowCount; ++row) {
+            m_rowValues[row] = this->modelData(row);
+            m_rowsByKey.insert(ItemModelDataIndex::keyOf(m_rowValues.at(row)), row);
+        }
+    }
+    m_isDirty = false;
+}
+
+} // namespace qtcore
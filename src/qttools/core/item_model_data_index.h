@@ -0,0 +1,72 @@
+/****************************************************************************
+**  FougTools
+**  Copyright Fougue (30 Mar. 2015)
+**  contact@fougue.pro
+**
+** This software is a computer program whose purpose is to provide utility
+** tools for the C++ language and the Qt toolkit.
+**
+** This software is governed by the CeCILL-C license under French law and
+** abiding by the rules of distribution of free software.  You can  use,
+** modify and/ or redistribute the software under the terms of the CeCILL-C
+** license as circulated by CEA, CNRS and INRIA at the following URL
+** "http://www.cecill.info".
+****************************************************************************/
+
+
+#pragma once
+
+#include "core.h"
+#include <QtCore/QMultiHash>
+#include <QtCore/QObject>
+#include <QtCore/QPointer>
+#include <QtCore/QVariant>
+#include <QtCore/QVector>
+class QAbstractItemModel;
+class QModelIndex;
+
+namespace qtcore {
+
+class QTTOOLS_CORE_EXPORT ItemModelDataIndex : public QObject
+{
+    Q_OBJECT
+
+public:
+    ItemModelDataIndex(
+            const QAbstractItemModel* model,
+            int col,
+            int role = Qt::DisplayRole,
+            QObject* parent = NULL);
+
+    const QAbstractItemModel* model() const;
+    int column() const;
+    int role() const;
+
+    int findRow(const QVariant& value) const;
+    QVector<int> findRows(const QVariant& value) const;
+
+    void invalidate();
+
+private:
+    void onRowsInserted(const QModelIndex& parent, int first, int last);
+    void onRowsRemoved(const QModelIndex& parent, int first, int last);
+    void onDataChanged(
+            const QModelIndex& topLeft,
+            const QModelIndex& bottomRight,
+            const QVector<int>& roles);
+
+    static QString keyOf(const QVariant& value);
+    QVariant modelData(int row) const;
+    void indexRow(int row);
+    void unindexRow(int row);
+    void ensureBuilt() const;
+
+    QPointer<const QAbstractItemModel> m_model;
+    int m_col;
+    int m_role;
+    mutable bool m_isDirty;
+    mutable QVector<QVariant> m_rowValues;
+    mutable QMultiHash<QString, int> m_rowsByKey;
+};
+
+} // namespace qtcore
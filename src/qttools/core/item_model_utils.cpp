@@ -41,6 +41,8 @@ bool ItemModelUtils::isValidColumn(const QAbstractItemModel* model, int col, con
 /*! \brief Try to find a value in a given column of a model
  *  \return Index of the row where the first match of \p value could be found
  *  \retval -1 if \p value could not be found
+ *
+ *  This is a linear scan, use ItemModelDataIndex for repeated lookups
  */
 int ItemModelUtils::findDataInRow(const QAbstractItemModel* model, int col, const QVariant& value)
 {
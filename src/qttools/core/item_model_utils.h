@@ -82,21 +82,39 @@ bool ItemModelUtils::validRows(
     return !rows.isEmpty();
 }
 
+/*! \brief Removes the (top-level) \p rows from \p model
+ *
+ *  Rows are sorted and coalesced into contiguous ranges, then each range is
+ *  removed with a single QAbstractItemModel::removeRows() call, by descending
+ *  order so row numbers of the remaining ranges stay valid. Invalid and
+ *  duplicate rows are ignored.
+ */
 template<typename INT_CONTAINER>
 void ItemModelUtils::removeRows(
         QAbstractItemModel* model, const INT_CONTAINER& rows)
 {
     if (model == NULL)
         return;
-    // Delete rows by descending order
     QVector<int> descRows;
+    const int rowCount = model->rowCount();
     for (auto it = rows.begin(); it != rows.end(); ++it) {
-        if (ItemModelUtils::isValidRow(model, *it))
+        if (0 <= *it && *it < rowCount)
             descRows.append(*it);
     }
     std::sort(descRows.begin(), descRows.end(), std::greater<int>());
-    foreach (int row, descRows)
-        model->removeRow(row);
+    descRows.erase(std::unique(descRows.begin(), descRows.end()), descRows.end());
+
+    int i = 0;
+    while (i < descRows.size()) {
+        const int rangeLast = descRows.at(i);
+        int rangeFirst = rangeLast;
+        while (i + 1 < descRows.size() && descRows.at(i + 1) == rangeFirst - 1) {
+            --rangeFirst;
+            ++i;
+        }
+        model->removeRows(rangeFirst, rangeLast - rangeFirst + 1);
+        ++i;
+    }
 }
 
 } // namespace qtcore
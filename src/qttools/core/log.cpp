@@ -18,12 +18,31 @@
 #include <QtCore/QList>
 #include <QtCore/QLinkedList>
 #include <QtCore/QMetaType>
+#include <QtCore/QMutex>
 #include <QtCore/QPair>
+#include <QtCore/QThreadStorage>
+#include <QtCore/QVarLengthArray>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <thread>
 
 namespace qtcore {
 
 namespace internal {
 
+//! Guards the global handlers and pending messages, recursive so a handler
+//! can log
+static QMutex* globalLogMutex()
+{
+    static QMutex object(QMutex::Recursive);
+    return &object;
+}
+
 static QList<AbstractLogHandler*>* globalLogHandlers()
 {
     static QList<AbstractLogHandler*> object;
@@ -37,18 +56,273 @@ static QLinkedList<PendingLogMessage>* globalPendingMessages()
     return &object;
 }
 
-static void handleLogMessage(Log::MessageType msgType, const QString& msg)
+static void dispatchLogMessage(Log::MessageType msgType, const QString& msg)
 {
+    QMutexLocker locker(globalLogMutex()); Q_UNUSED(locker);
     if (globalLogHandlers()->isEmpty())
         globalPendingMessages()->append(qMakePair(msgType, msg));
     foreach (AbstractLogHandler* logHandler, *(globalLogHandlers()))
         logHandler->handle(msgType, msg );
 }
 
+/*! \brief Bounded multi-producer/single-consumer queue of log messages,
+ *         dispatched to the global handlers by a dedicated thread
+ *
+ *  Enqueuing is lock-free (ring of cells with sequence numbers), the
+ *  dispatcher thread sleeps on a condition variable only when the queue is
+ *  empty.
+ */
+class AsyncLogQueue
+{
+public:
+    AsyncLogQueue();
+    ~AsyncLogQueue();
+
+    void start(int capacity, LogOverflowPolicy policy);
+    void stop();
+    bool isRunning() const;
+
+    bool enqueue(Log::MessageType msgType, const QString& msg);
+    void flush();
+    quint64 droppedCount() const;
+
+private:
+    struct Cell
+    {
+        std::atomic<std::size_t> sequence;
+        Log::MessageType msgType;
+        QString msg;
+    };
+
+    bool tryPush(Log::MessageType msgType, const QString& msg);
+    bool hasPending() const;
+    void run();
+
+    std::unique_ptr<Cell[]> m_cells;
+    std::size_t m_mask;
+    std::atomic<std::size_t> m_enqueuePos;
+    std::size_t m_dequeuePos; // Dispatcher thread only
+    std::atomic<std::size_t> m_dispatchedCount;
+    std::atomic<quint64> m_droppedCount;
+    std::atomic<int> m_producerCount;
+    std::atomic<bool> m_isRunning;
+    std::atomic<bool> m_isDispatcherWaiting;
+    LogOverflowPolicy m_policy;
+
+    std::mutex m_controlMutex; // Serializes start() and stop()
+    std::mutex m_waitMutex;
+    std::condition_variable m_messageCondition;
+    std::condition_variable m_dispatchedCondition;
+    bool m_isStopRequested;
+    std::thread m_thread;
+    std::thread::id m_threadId;
+};
+
+AsyncLogQueue::AsyncLogQueue()
+    : m_mask(0),
+      m_enqueuePos(0),
+      m_dequeuePos(0),
+      m_dispatchedCount(0),
+      m_droppedCount(0),
+      m_producerCount(0),
+      m_isRunning(false),
+      m_isDispatcherWaiting(false),
+      m_policy(DropLogMessageOnOverflow),
+      m_isStopRequested(false)
+{
+}
+
+AsyncLogQueue::~AsyncLogQueue()
+{
+    this->stop();
+}
+
+void AsyncLogQueue::start(int capacity, LogOverflowPolicy policy)
+{
+    std::lock_guard<std::mutex> lock(m_controlMutex);
+    if (m_isRunning.load())
+        return;
+
+    std::size_t cellCount = 2;
+    while (cellCount < static_cast<std::size_t>(qMax(capacity, 2)))
+        cellCount *= 2;
+    m_cells.reset(new Cell[cellCount]);
+    for (std::size_t i = 0; i < cellCount; ++i)
+        m_cells[i].sequence.store(i, std::memory_order_relaxed);
+    m_mask = cellCount - 1;
+    m_enqueuePos.store(0);
+    m_dequeuePos = 0;
+    m_dispatchedCount.store(0);
+    m_policy = policy;
+    m_isStopRequested = false;
+    m_thread = std::thread(&AsyncLogQueue::run, this);
+    m_threadId = m_thread.get_id();
+    m_isRunning.store(true);
+}
+
+//! Dispatches the queued messages, then stops the dispatcher thread
+void AsyncLogQueue::stop()
+{
+    std::lock_guard<std::mutex> lock(m_controlMutex);
+    if (!m_isRunning.load())
+        return;
+
+    // New producers now dispatch synchronously, wait for the ones in flight
+    m_isRunning.store(false);
+    while (m_producerCount.load() != 0)
+        std::this_thread::yield();
+
+    {
+        std::lock_guard<std::mutex> waitLock(m_waitMutex);
+        m_isStopRequested = true;
+    }
+    m_messageCondition.notify_one();
+    m_thread.join();
+    m_dispatchedCondition.notify_all();
+}
+
+bool AsyncLogQueue::isRunning() const
+{
+    return m_isRunning.load();
+}
+
+/*! \brief Queues a message for the dispatcher thread
+ *
+ *  Returns false if the queue is not running, the message has then to be
+ *  dispatched synchronously
+ */
+bool AsyncLogQueue::enqueue(Log::MessageType msgType, const QString& msg)
+{
+    ++m_producerCount;
+    const bool isRunning = m_isRunning.load();
+    if (isRunning) {
+        bool isPushed = this->tryPush(msgType, msg);
+        // The dispatcher thread (a handler that logs) must not wait for itself
+        const bool canBlock =
+                m_policy == BlockOnLogOverflow
+                && std::this_thread::get_id() != m_threadId;
+        while (!isPushed && canBlock) {
+            std::this_thread::yield();
+            isPushed = this->tryPush(msgType, msg);
+        }
+        if (isPushed) {
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (m_isDispatcherWaiting.load()) {
+                std::lock_guard<std::mutex> lock(m_waitMutex);
+                m_messageCondition.notify_one();
+            }
+        }
+        else {
+            m_droppedCount.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+    --m_producerCount;
+    return isRunning;
+}
+
+//! Waits until all the messages queued so far are dispatched
+void AsyncLogQueue::flush()
+{
+    if (!m_isRunning.load() || std::this_thread::get_id() == m_threadId)
+        return;
+
+    const std::size_t targetCount = m_enqueuePos.load();
+    std::unique_lock<std::mutex> lock(m_waitMutex);
+    while (m_dispatchedCount.load() < targetCount && m_isRunning.load()) {
+        m_messageCondition.notify_one();
+        m_dispatchedCondition.wait_for(lock, std::chrono::milliseconds(10));
+    }
+}
+
+quint64 AsyncLogQueue::droppedCount() const
+{
+    return m_droppedCount.load(std::memory_order_relaxed);
+}
+
+bool AsyncLogQueue::tryPush(Log::MessageType msgType, const QString& msg)
+{
+    std::size_t pos = m_enqueuePos.load(std::memory_order_relaxed);
+    Cell* cell = NULL;
+    for (;;) {
+        cell = &m_cells[pos & m_mask];
+        const std::size_t seq = cell->sequence.load(std::memory_order_acquire);
+        const std::ptrdiff_t diff =
+                static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos);
+        if (diff == 0) {
+            if (m_enqueuePos.compare_exchange_weak(
+                        pos, pos + 1, std::memory_order_relaxed))
+            {
+                break;
+            }
+        }
+        else if (diff < 0) {
+            return false; // Full
+        }
+        else {
+            pos = m_enqueuePos.load(std::memory_order_relaxed);
+        }
+    }
+    cell->msgType = msgType;
+    // Copies into the capacity left by a previous message of the cell
+    cell->msg.resize(0);
+    cell->msg.append(msg);
+    cell->sequence.store(pos + 1, std::memory_order_release);
+    return true;
+}
+
+bool AsyncLogQueue::hasPending() const
+{
+    const Cell& cell = m_cells[m_dequeuePos & m_mask];
+    return cell.sequence.load(std::memory_order_acquire) == m_dequeuePos + 1;
+}
+
+void AsyncLogQueue::run()
+{
+    for (;;) {
+        bool hasDispatched = false;
+        while (this->hasPending()) {
+            Cell& cell = m_cells[m_dequeuePos & m_mask];
+            dispatchLogMessage(cell.msgType, cell.msg);
+            cell.sequence.store(m_dequeuePos + m_mask + 1, std::memory_order_release);
+            ++m_dequeuePos;
+            m_dispatchedCount.store(m_dequeuePos);
+            hasDispatched = true;
+        }
+
+        std::unique_lock<std::mutex> lock(m_waitMutex);
+        if (hasDispatched)
+            m_dispatchedCondition.notify_all();
+        m_isDispatcherWaiting.store(true);
+        if (!this->hasPending()) {
+            if (m_isStopRequested)
+                break;
+            m_messageCondition.wait_for(lock, std::chrono::milliseconds(100));
+        }
+        m_isDispatcherWaiting.store(false);
+    }
+    m_isDispatcherWaiting.store(false);
+}
+
+static AsyncLogQueue* globalAsyncLogQueue()
+{
+    static AsyncLogQueue object;
+    return &object;
+}
+
+static void handleLogMessage(Log::MessageType msgType, const QString& msg)
+{
+    if (!globalAsyncLogQueue()->enqueue(msgType, msg))
+        dispatchLogMessage(msgType, msg);
+}
+
 } // namespace internal
 
 /*! \struct Log::Stream
  *  \brief Encapsulates a reference-counted QTextStream so a Log object can be quickly copied
+ *
+ *  Streams are recycled through a per-thread pool, so the buffer keeps its
+ *  capacity from one message to the next and steady-state logging does not
+ *  allocate.
  */
 
 struct Log::Stream
@@ -59,6 +333,17 @@ struct Log::Stream
     QTextStream ts;
     int refCount;
 
+    static Stream* acquire(MessageType mType);
+    static void release(Stream* stream);
+
+    struct Pool
+    {
+        ~Pool() { qDeleteAll(streams.constBegin(), streams.constEnd()); }
+        QVarLengthArray<Stream*, 4> streams;
+    };
+    static Pool* threadPool();
+    enum { MaxPoolSize = 4, MaxPooledCapacity = 16 * 1024 };
+
     template<typename T>
     static Log& defaultQTextStreamOutput(Log& log, T value)
     {
@@ -76,6 +361,45 @@ Log::Stream::Stream(Log::MessageType mType)
 {
 }
 
+Log::Stream::Pool* Log::Stream::threadPool()
+{
+    static QThreadStorage<Pool*> storage;
+    if (!storage.hasLocalData())
+        storage.setLocalData(new Pool);
+    return storage.localData();
+}
+
+Log::Stream* Log::Stream::acquire(MessageType mType)
+{
+    Pool* pool = Stream::threadPool();
+    if (pool->streams.isEmpty())
+        return new Stream(mType);
+    Stream* stream = pool->streams.last();
+    pool->streams.removeLast();
+    stream->msgType = mType;
+    stream->refCount = 1;
+    return stream;
+}
+
+/*! Resets \p stream and gives it back to the pool of the current thread
+ *
+ *  The buffer is kept (emptied) unless it grew too large or it is still
+ *  shared by a handler that stored the message
+ */
+void Log::Stream::release(Stream* stream)
+{
+    Pool* pool = Stream::threadPool();
+    if (pool->streams.size() >= MaxPoolSize) {
+        delete stream;
+        return;
+    }
+    if (stream->buffer.capacity() > MaxPooledCapacity || !stream->buffer.isDetached())
+        stream->buffer = QString();
+    else
+        stream->buffer.resize(0);
+    pool->streams.append(stream);
+}
+
 /*!
  * \class Log
  * \brief Provides an easy-to-use output stream for logging
@@ -98,10 +422,15 @@ Log::Log()
 {
 }
 
+QAtomicInt Log::m_minimumMessageType(Log::DebugMessage);
+
 /*! \brief Construct a Log stream for messages of a special type
+ *
+ *  If \p msgType is filtered (see isEnabled()) then the stream is null and
+ *  nothing is formatted nor allocated
  */
 Log::Log(MessageType msgType)
-    : m_stream(new Stream(msgType))
+    : m_stream(Log::isEnabled(msgType) ? Stream::acquire(msgType) : NULL)
 {
 }
 
@@ -122,7 +451,7 @@ Log::~Log()
         --(m_stream->refCount);
         if (m_stream->refCount == 0) {
             internal::handleLogMessage(m_stream->msgType, m_stream->buffer);
-            delete m_stream;
+            Stream::release(m_stream);
         }
     }
 }
@@ -208,6 +537,28 @@ Log& Log::operator<<(const QString& str)
     return Log::Stream::defaultQTextStreamOutput(*this, str);
 }
 
+/*! \brief Minimum type of the messages to be handled, messages of lower
+ *         type are discarded when the Log stream is constructed
+ *
+ *  Default is DebugMessage (nothing is discarded)
+ */
+Log::MessageType Log::minimumMessageType()
+{
+    return static_cast<MessageType>(m_minimumMessageType.load());
+}
+
+/*! \brief Sets the minimum type of the messages to be handled
+ *
+ *  Combined with the QTTOOLS_*_LOG() macros, a filtered log statement then
+ *  costs a single branch : its arguments are not even evaluated. The
+ *  QTTOOLS_LOG_MIN_MESSAGE_TYPE macro additionally filters messages at
+ *  compile time.
+ */
+void Log::setMinimumMessageType(MessageType msgType)
+{
+    m_minimumMessageType.store(msgType);
+}
+
 void Log::registerMetaTypes()
 {
     static bool alreadyRegistered = false;
@@ -309,6 +660,7 @@ void AbstractLogHandler::setAutoDetach(bool b)
 void attachGlobalLogHandler(AbstractLogHandler* handler)
 {
     if (handler != NULL) {
+        QMutexLocker locker(internal::globalLogMutex()); Q_UNUSED(locker);
         if (internal::globalLogHandlers()->isEmpty()
                 && !internal::globalPendingMessages()->isEmpty())
         {
@@ -325,8 +677,69 @@ void attachGlobalLogHandler(AbstractLogHandler* handler)
  */
 void detachGlobalLogHandler(AbstractLogHandler* handler)
 {
-    if (handler != NULL)
+    if (handler != NULL) {
+        QMutexLocker locker(internal::globalLogMutex()); Q_UNUSED(locker);
         internal::globalLogHandlers()->removeAll(handler);
+    }
+}
+
+/*! \brief Switches to asynchronous dispatching of log messages
+ *
+ *  Log messages are then pushed to a lock-free queue of \p capacity entries
+ *  and a dedicated thread calls the global log handlers. So logging threads
+ *  no longer wait for handler I/O, and handlers are called by one thread at
+ *  a time.
+ *
+ *  When the queue is full, new messages are dropped or the logging thread
+ *  waits for free space, depending on \p policy. Dropped messages are
+ *  counted by globalLogDroppedMessageCount().
+ *
+ *  Does nothing if asynchronous dispatching is already enabled.
+ *
+ *  \note Log handlers must be detached (or disableAsyncGlobalLog() be called)
+ *        before they are destroyed
+ *
+ *  \relates Log
+ */
+void enableAsyncGlobalLog(int capacity, LogOverflowPolicy policy)
+{
+    internal::globalAsyncLogQueue()->start(capacity, policy);
+}
+
+/*! \brief Dispatches the queued log messages, then switches back to
+ *         synchronous dispatching
+ *  \relates Log
+ */
+void disableAsyncGlobalLog()
+{
+    internal::globalAsyncLogQueue()->stop();
+}
+
+//! \relates Log
+bool isAsyncGlobalLogEnabled()
+{
+    return internal::globalAsyncLogQueue()->isRunning();
+}
+
+/*! \brief Waits until log messages queued so far are dispatched to the
+ *         global log handlers
+ *
+ *  Does nothing if asynchronous dispatching is disabled
+ *
+ *  \relates Log
+ */
+void flushGlobalLog()
+{
+    internal::globalAsyncLogQueue()->flush();
+}
+
+/*! \brief Count of log messages dropped because the asynchronous queue was
+ *         full
+ *  \relates Log
+ */
+quint64 globalLogDroppedMessageCount()
+{
+    return internal::globalAsyncLogQueue()->droppedCount();
 }
 
 /*!
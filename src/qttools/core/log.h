@@ -16,6 +16,7 @@
 #pragma once
 
 #include "core.h"
+#include <QtCore/QAtomicInt>
 #include <QtCore/QObject>
 #include <QtCore/QString>
 #include <QtCore/QTextStream>
@@ -63,11 +64,16 @@ public:
 
     static void registerMetaTypes();
 
+    static bool isEnabled(MessageType msgType);
+    static MessageType minimumMessageType();
+    static void setMinimumMessageType(MessageType msgType);
+
 private:
     Log& operator=(const Log& other); // disabled
 
     struct Stream;
     Stream* m_stream;
+    static QAtomicInt m_minimumMessageType;
 };
 
 QTTOOLS_CORE_EXPORT Log debugLog();
@@ -92,6 +98,22 @@ private:
 QTTOOLS_CORE_EXPORT void attachGlobalLogHandler(AbstractLogHandler* handler);
 QTTOOLS_CORE_EXPORT void detachGlobalLogHandler(AbstractLogHandler* handler);
 
+// --
+// -- Asynchronous dispatching
+// --
+enum LogOverflowPolicy
+{
+    DropLogMessageOnOverflow,
+    BlockOnLogOverflow
+};
+QTTOOLS_CORE_EXPORT void enableAsyncGlobalLog(
+        int capacity = 8192,
+        LogOverflowPolicy policy = DropLogMessageOnOverflow);
+QTTOOLS_CORE_EXPORT void disableAsyncGlobalLog();
+QTTOOLS_CORE_EXPORT bool isAsyncGlobalLogEnabled();
+QTTOOLS_CORE_EXPORT void flushGlobalLog();
+QTTOOLS_CORE_EXPORT quint64 globalLogDroppedMessageCount();
+
 // --
 // -- class LogDispatcher
 // --
@@ -107,6 +129,29 @@ signals:
     void log(qtcore::Log::MessageType msgType, const QString& msg);
 };
 
+// --
+// -- Filtering macros
+// --
+
+// Log statements with a message type below this value are compiled out by
+// the QTTOOLS_*_LOG() macros, ex: -DQTTOOLS_LOG_MIN_MESSAGE_TYPE=1 removes
+// debug logging
+#ifndef QTTOOLS_LOG_MIN_MESSAGE_TYPE
+# define QTTOOLS_LOG_MIN_MESSAGE_TYPE 0
+#endif
+
+// Log statement whose arguments are not evaluated if msgType is filtered
+#define QTTOOLS_LOG(msgType) \
+    if ((msgType) < QTTOOLS_LOG_MIN_MESSAGE_TYPE \
+            || !qtcore::Log::isEnabled(msgType)) {} \
+    else qtcore::Log(msgType)
+
+#define QTTOOLS_DEBUG_LOG()    QTTOOLS_LOG(qtcore::Log::DebugMessage)
+#define QTTOOLS_INFO_LOG()     QTTOOLS_LOG(qtcore::Log::InfoMessage)
+#define QTTOOLS_WARNING_LOG()  QTTOOLS_LOG(qtcore::Log::WarningMessage)
+#define QTTOOLS_CRITICAL_LOG() QTTOOLS_LOG(qtcore::Log::CriticalMessage)
+#define QTTOOLS_FATAL_LOG()    QTTOOLS_LOG(qtcore::Log::FatalMessage)
+
 // --
 // -- Implementation
 // --
@@ -114,7 +159,17 @@ signals:
 template <typename T>
 Log& Log::operator<<(const T* ptr)
 {
+    if (m_stream == NULL)
+        return *this;
     return *this << QString("0x%1").arg(reinterpret_cast<std::size_t>(ptr), 0, 16);
 }
 
+/*! \brief Returns true if messages of type \p msgType are not filtered by
+ *         minimumMessageType()
+ */
+inline bool Log::isEnabled(MessageType msgType)
+{
+    return static_cast<int>(msgType) >= m_minimumMessageType.load();
+}
+
 } // namespace qtcore
@@ -16,15 +16,23 @@
 #include "plugins_loader.h"
 
 #include <QtCore/QCoreApplication>
+#include <QtCore/QDateTime>
 #include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
 #include <QtCore/QHash>
+#include <QtCore/QJsonDocument>
+#include <QtCore/QJsonObject>
 #include <QtCore/QLibrary>
 #include <QtCore/QPluginLoader>
 #include <QtCore/QRegExp>
+#include <QtCore/QSaveFile>
 #include <QtCore/QStringList>
 
 #include <QtCore/QtDebug>
 
+#include "../../cpptools/parallel_utils.h"
+
 namespace qtcore {
 
 /*! \brief Internal (pimpl of PluginsLoader)
@@ -34,20 +42,38 @@ class PluginsLoader::Private
 public:
     Private();
 
+    //! Plugin accepted by scanPlugins() but not instantiated yet
+    struct PendingPlugin
+    {
+        QPluginLoader* loader;
+        QString fileName;
+        QString iid;
+    };
+
     void releasePlugins();
+    bool instantiatePlugin(
+            QPluginLoader* loader, const QString& fileName, QStringList* errors);
+    static QString loadErrorString(
+            const QPluginLoader* loader, const QString& error);
 
     static bool filterAccepts(
             const QList<InstanceFilter*>& filters,
             QPluginLoader* pluginLoader,
+            const QJsonObject& metaData,
             QString* filterError);
+    static QJsonObject readMetaDataCache(const QString& filePath);
+    static void writeMetaDataCache(
+            const QString& filePath, const QJsonObject& entries);
     static bool isLibrary(const QString &path);
 
     QVector<QObject*> m_plugins;
     QVector<QPluginLoader*> m_pluginLoaders;
     QHash<const QObject*, QString> m_pluginFileNames;
+    QVector<PendingPlugin> m_pendingPlugins;
     bool m_autoDeletePlugins;
     QStringList m_pluginPaths;
     QStringList m_fileNameFilters;
+    QString m_metaDataCacheFilePath;
 };
 
 PluginsLoader::Private::Private()
@@ -67,16 +93,55 @@ void PluginsLoader::Private::releasePlugins()
         }
     }
 
+    foreach (const PendingPlugin& pending, m_pendingPlugins)
+        delete pending.loader; // Never loaded
+
     m_pluginLoaders.clear();
     m_plugins.clear();
     m_pluginFileNames.clear();
+    m_pendingPlugins.clear();
+}
+
+//! Creates the root component of \p loader, deletes \p loader on error
+bool PluginsLoader::Private::instantiatePlugin(
+        QPluginLoader* loader, const QString& fileName, QStringList* errors)
+{
+    QObject* pluginInstance = loader->instance();
+    if (pluginInstance == NULL) {
+        if (errors != NULL)
+            errors->append(Private::loadErrorString(loader, QString()));
+        delete loader;
+        return false;
+    }
+    m_plugins.append(pluginInstance);
+    m_pluginLoaders.append(loader);
+    m_pluginFileNames.insert(pluginInstance, fileName);
+    return true;
+}
+
+QString PluginsLoader::Private::loadErrorString(
+        const QPluginLoader* loader, const QString& error)
+{
+    //: %1 holds the path to a plugin (DLL)
+    //: %2 holds an error description
+    return QCoreApplication::translate(
+                "qtcore::PluginsLoader",
+                "Failed to load plugin %1, error : %2")
+            .arg(loader->fileName())
+            .arg(!error.isEmpty() ? error : loader->errorString());
 }
 
 bool PluginsLoader::Private::filterAccepts(
         const QList<InstanceFilter *> &filters,
         QPluginLoader* pluginLoader,
+        const QJsonObject& metaData,
         QString* filterError)
 {
+    // Metadata filters first, they don't need to touch the library
+    foreach (InstanceFilter* filter, filters) {
+        if (!filter->acceptsMetaData(metaData, filterError))
+            return false;
+    }
     foreach (InstanceFilter* filter, filters) {
         if (!filter->accepts(pluginLoader, filterError))
             return false;
@@ -84,6 +149,40 @@ bool PluginsLoader::Private::filterAccepts(
     return true;
 }
 
+namespace internal {
+static const int pluginsMetaDataCacheVersion = 1;
+} // namespace internal
+
+/*! Returns the "plugins" object of cache file \p filePath, or an empty object
+ *  if the file is missing or of another version
+ */
+QJsonObject PluginsLoader::Private::readMetaDataCache(const QString& filePath)
+{
+    QFile file(filePath);
+    if (filePath.isEmpty() || !file.open(QIODevice::ReadOnly))
+        return QJsonObject();
+    const QJsonObject root = QJsonDocument::fromJson(file.readAll()).object();
+    if (root.value(QLatin1String("version")).toInt()
+            != internal::pluginsMetaDataCacheVersion)
+    {
+        return QJsonObject();
+    }
+    return root.value(QLatin1String("plugins")).toObject();
+}
+
+void PluginsLoader::Private::writeMetaDataCache(
+        const QString& filePath, const QJsonObject& entries)
+{
+    QJsonObject root;
+    root.insert(QLatin1String("version"), internal::pluginsMetaDataCacheVersion);
+    root.insert(QLatin1String("plugins"), entries);
+    QSaveFile file(filePath); // Atomic, a concurrent reader never sees a partial file
+    if (file.open(QIODevice::WriteOnly)) {
+        file.write(QJsonDocument(root).toJson(QJsonDocument::Compact));
+        file.commit();
+    }
+}
+
 bool PluginsLoader::Private::isLibrary(const QString &path)
 {
     QStringList suffixList;
@@ -208,6 +307,29 @@ void PluginsLoader::setFileNameFilters(const QStringList &nameFilters)
     d->m_fileNameFilters = nameFilters;
 }
 
+/*!
+ * \brief Returns the path set with setMetaDataCacheFile()
+ */
+QString PluginsLoader::metaDataCacheFile() const
+{
+    return d->m_metaDataCacheFilePath;
+}
+
+/*! \brief Sets the file where plugin metadata is cached by scanPlugins() and
+ *         loadPlugins()
+ *
+ *  Cache entries are keyed by the absolute path of the library, and are valid
+ *  as long as its size and modification time are unchanged. So unchanged
+ *  plugins are scanned and filtered with InstanceFilter::acceptsMetaData()
+ *  without reading the library file.
+ *
+ *  The cache is disabled if \p filePath is empty (the default).
+ */
+void PluginsLoader::setMetaDataCacheFile(const QString& filePath)
+{
+    d->m_metaDataCacheFilePath = filePath;
+}
+
 /*!
  * Returns file name of a loaded plugin object (e.g. libmy_plugin.so,
  * other_plugin.dll, ...)
@@ -223,13 +345,36 @@ QString PluginsLoader::pluginFileName(const QObject* plugin) const
 }
 
 /*!
- * \brief Returns all loaded plugin root components
+ * \brief Returns all plugin root components
+ *
+ * Plugins still pending after scanPlugins() are instantiated first
+ *
+ * \sa loadedPlugins()
  */
 QVector<QObject*> PluginsLoader::plugins() const
 {
+    this->instantiatePendingPlugins(NULL);
     return d->m_plugins;
 }
 
+/*!
+ * \brief Returns the plugin root components instantiated so far, without
+ *        instantiating pending plugins
+ */
+QVector<QObject*> PluginsLoader::loadedPlugins() const
+{
+    return d->m_plugins;
+}
+
+/*!
+ * \brief Returns the count of plugins accepted by scanPlugins() whose root
+ *        component is not instantiated yet
+ */
+int PluginsLoader::pendingPluginCount() const
+{
+    return d->m_pendingPlugins.size();
+}
+
 void PluginsLoader::loadPlugins(InstanceFilter *filter, QStringList *errors)
 {
     QList<InstanceFilter*> filters;
@@ -239,51 +384,152 @@ void PluginsLoader::loadPlugins(InstanceFilter *filter, QStringList *errors)
 
 /*!
  * \brief Loads plugins, any error is reported in \p errors
+ *
+ * Same as scanPlugins() followed by the instantiation of all accepted
+ * plugins
  */
 void PluginsLoader::loadPlugins(
         const QList<InstanceFilter *> &filters, QStringList *errors)
+{
+    this->scanPlugins(filters, errors);
+    const QVector<Private::PendingPlugin> pendingPlugins = d->m_pendingPlugins;
+    d->m_pendingPlugins.clear();
+    foreach (const Private::PendingPlugin& pending, pendingPlugins)
+        d->instantiatePlugin(pending.loader, pending.fileName, errors);
+}
+
+/*!
+ * \brief Finds plugins without instantiating them, any error is reported in
+ *        \p errors
+ *
+ * The JSON metadata of candidate libraries is taken from the cache (see
+ * setMetaDataCacheFile()) or read concurrently, which does not load the
+ * libraries. Libraries without Qt plugin metadata are discarded. Then
+ * \p filters are applied : filters using only metadata keep the plugins
+ * lazy, filters calling QPluginLoader::instance() load them.
+ *
+ * Root components are instantiated later, on demand : castPlugins<>()
+ * instantiates only the plugins whose metadata IID matches the requested
+ * interface, plugins() instantiates all of them.
+ */
+void PluginsLoader::scanPlugins(
+        const QList<InstanceFilter*>& filters, QStringList* errors)
 {
     d->releasePlugins();
 
+    QVector<QPluginLoader*> candidateLoaders;
+    QStringList candidateFileNames;
+    QList<QFileInfo> candidateFileInfos;
     foreach (const QString& path, d->m_pluginPaths) {
         QDir pluginDir(path);
-        const QStringList entryList(
-                    pluginDir.entryList(d->m_fileNameFilters, QDir::Files));
-        foreach (const QString& entry, entryList) {
-            if (!Private::isLibrary(entry))
-                continue;
-
-            // Test plugin loader against filters
-            auto pluginLoader =
-                    new QPluginLoader(pluginDir.absoluteFilePath(entry));
-            QString filterError;
-            const bool pluginAccepted =
-                    Private::filterAccepts(filters, pluginLoader, &filterError);
-
-            if (pluginAccepted) {
-                QObject* pluginInstance = pluginLoader->instance();
-                d->m_plugins.append(pluginInstance);
-                d->m_pluginLoaders.append(pluginLoader);
-                d->m_pluginFileNames.insert(pluginInstance, entry);
+        const QFileInfoList entryList(
+                    pluginDir.entryInfoList(d->m_fileNameFilters, QDir::Files));
+        foreach (const QFileInfo& entry, entryList) {
+            if (Private::isLibrary(entry.fileName())) {
+                candidateLoaders.append(new QPluginLoader(entry.absoluteFilePath()));
+                candidateFileNames.append(entry.fileName());
+                candidateFileInfos.append(entry);
             }
-            else {
-                if (errors != NULL) {
-                    //: %1 holds the path to a plugin (DLL)
-                    //: %2 holds an error description
-                    errors->append(
-                                QCoreApplication::translate(
-                                    "qtcore::PluginsLoader",
-                                    "Failed to load plugin %1, error : %2")
-                                .arg(pluginLoader->fileName())
-                                .arg(!filterError.isEmpty() ?
-                                         filterError :
-                                         pluginLoader->errorString()));
-                }
-                pluginLoader->unload();
-                delete pluginLoader;
-            }
-        } // end foreach ()
-    } // end foreach ()
+        }
+    }
+
+    // Use cached metadata of unchanged libraries
+    const bool isCacheEnabled = !d->m_metaDataCacheFilePath.isEmpty();
+    const QJsonObject oldCache = Private::readMetaDataCache(d->m_metaDataCacheFilePath);
+    QJsonObject newCache;
+    QVector<QJsonObject> candidateMetaData(candidateLoaders.size());
+    QVector<int> uncachedIds;
+    for (int i = 0; i < candidateLoaders.size(); ++i) {
+        const QFileInfo& fileInfo = candidateFileInfos.at(i);
+        const QJsonObject entry =
+                oldCache.value(fileInfo.absoluteFilePath()).toObject();
+        const bool isCacheHit =
+                !entry.isEmpty()
+                && entry.value(QLatin1String("size")).toDouble() == fileInfo.size()
+                && entry.value(QLatin1String("mtime")).toDouble()
+                   == fileInfo.lastModified().toMSecsSinceEpoch();
+        if (isCacheHit) {
+            candidateMetaData[i] = entry.value(QLatin1String("metaData")).toObject();
+            newCache.insert(fileInfo.absoluteFilePath(), entry);
+        }
+        else {
+            uncachedIds.append(i);
+        }
+    }
+
+    // Reading metadata is file I/O and parsing, done concurrently
+    cpp::parallelForRanges(
+                uncachedIds.size(),
+                [&] (std::size_t iBegin, std::size_t iEnd) {
+        for (std::size_t i = iBegin; i < iEnd; ++i) {
+            const int id = uncachedIds.at(static_cast<int>(i));
+            candidateMetaData[id] = candidateLoaders.at(id)->metaData();
+        }
+    });
+
+    if (isCacheEnabled) {
+        foreach (int id, uncachedIds) {
+            const QFileInfo& fileInfo = candidateFileInfos.at(id);
+            QJsonObject entry;
+            entry.insert(QLatin1String("size"), double(fileInfo.size()));
+            entry.insert(QLatin1String("mtime"),
+                         double(fileInfo.lastModified().toMSecsSinceEpoch()));
+            entry.insert(QLatin1String("metaData"), candidateMetaData.at(id));
+            newCache.insert(fileInfo.absoluteFilePath(), entry);
+        }
+        // Rewritten only if a library was added, changed or removed
+        if (!uncachedIds.isEmpty() || newCache.size() != oldCache.size())
+            Private::writeMetaDataCache(d->m_metaDataCacheFilePath, newCache);
+    }
+
+    for (int i = 0; i < candidateLoaders.size(); ++i) {
+        QPluginLoader* pluginLoader = candidateLoaders.at(i);
+        const QJsonObject& metaData = candidateMetaData.at(i);
+        QString filterError;
+        if (metaData.isEmpty()) {
+            filterError = QCoreApplication::translate(
+                        "qtcore::PluginsLoader", "No Qt plugin metadata");
+        }
+        const bool pluginAccepted =
+                !metaData.isEmpty()
+                && Private::filterAccepts(filters, pluginLoader, metaData, &filterError);
+        if (pluginAccepted) {
+            Private::PendingPlugin pending;
+            pending.loader = pluginLoader;
+            pending.fileName = candidateFileNames.at(i);
+            pending.iid = metaData.value(QLatin1String("IID")).toString();
+            d->m_pendingPlugins.append(pending);
+        }
+        else {
+            if (errors != NULL)
+                errors->append(Private::loadErrorString(pluginLoader, filterError));
+            pluginLoader->unload();
+            delete pluginLoader;
+        }
+    }
+}
+
+/*! \brief Instantiates the pending plugins whose metadata IID is \p iid (all
+ *         of them if \p iid is NULL)
+ */
+void PluginsLoader::instantiatePendingPlugins(const char* iid) const
+{
+    const QString iidStr = iid != NULL ? QString::fromLatin1(iid) : QString();
+    QStringList errors;
+    for (int i = 0; i < d->m_pendingPlugins.size(); ) {
+        const Private::PendingPlugin pending = d->m_pendingPlugins.at(i);
+        if (iid == NULL || pending.iid == iidStr) {
+            d->m_pendingPlugins.remove(i);
+            d->instantiatePlugin(pending.loader, pending.fileName, &errors);
+        }
+        else {
+            ++i;
+        }
+    }
+#ifndef QT_NO_WARNING_OUTPUT
+    foreach (const QString& error, errors)
+        qWarning() << error;
+#endif // !QT_NO_WARNING_OUTPUT
 }
 
 /*! \brief Removes a previously loaded plugin object
@@ -43,16 +43,26 @@ public:
     QStringList fileNameFilters() const;
     void setFileNameFilters(const QStringList& nameFilters);
 
+    QString metaDataCacheFile() const;
+    void setMetaDataCacheFile(const QString& filePath);
+
     void loadPlugins(InstanceFilter* filter, QStringList* errors = NULL);
     void loadPlugins(
             const QList<InstanceFilter*>& filters, QStringList* errors = NULL);
+    void scanPlugins(
+            const QList<InstanceFilter*>& filters = QList<InstanceFilter*>(),
+            QStringList* errors = NULL);
     void discardPlugin(QObject* plugin);
 
     QString pluginFileName(const QObject* plugin) const;
     QVector<QObject*> plugins() const;
+    QVector<QObject*> loadedPlugins() const;
+    int pendingPluginCount() const;
     template<typename INTERFACE> QVector<INTERFACE*> castPlugins() const;
 
 private:
+    void instantiatePendingPlugins(const char* iid) const;
+
     class Private;
     Private* const d;
 };
@@ -70,12 +80,17 @@ private:
  * \tparam INTERFACE Interface type used with qobject_cast<>
  *
  * NULL plugins are not added to the result vector
+ *
+ * Plugins pending after scanPlugins() are instantiated only if the IID of
+ * their metadata is the IID of INTERFACE (all of them if INTERFACE has no IID
+ * declared with Q_DECLARE_INTERFACE())
  */
 template<typename INTERFACE>
 QVector<INTERFACE *> PluginsLoader::castPlugins() const
 {
+    this->instantiatePendingPlugins(qobject_interface_iid<INTERFACE*>());
     QVector<INTERFACE *> typPlugins;
-    foreach (QObject* plugin, this->plugins()) {
+    foreach (QObject* plugin, this->loadedPlugins()) {
         INTERFACE* typPlugin = qobject_cast<INTERFACE*>(plugin);
         if (typPlugin != NULL)
             typPlugins.append(typPlugin);
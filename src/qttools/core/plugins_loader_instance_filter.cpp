@@ -14,6 +14,7 @@
 ****************************************************************************/
 
 #include "plugins_loader_instance_filter.h"
+#include <QtCore/QJsonObject>
 #include <QtCore/QPluginLoader>
 
 namespace qtcore {
@@ -48,4 +49,21 @@ bool PluginsLoader_InstanceFilter::accepts(
     return loader != NULL;
 }
 
+/*! \brief Keep or discard a plugin from its JSON metadata only
+ *
+ *  This function is called before accepts(). The metadata may come from the
+ *  cache of PluginsLoader (see PluginsLoader::setMetaDataCacheFile()), so
+ *  filters implemented here do not need to read the library file.
+ *
+ *  By default this functions accepts any metadata.
+ *
+ *  \param metaData The metadata of the plugin, as QPluginLoader::metaData()
+ *  \param[out] error Used to report error in case the plugin is filtered out
+ */
+bool PluginsLoader_InstanceFilter::acceptsMetaData(
+        const QJsonObject& /*metaData*/, QString* /*error*/) const
+{
+    return true;
+}
+
 } // namespace qtcore
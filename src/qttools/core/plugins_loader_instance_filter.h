@@ -16,6 +16,7 @@
 #pragma once
 
 #include "core.h"
+class QJsonObject;
 class QPluginLoader;
 
 namespace qtcore {
@@ -24,6 +25,8 @@ class QTTOOLS_CORE_EXPORT PluginsLoader_InstanceFilter
 {
 public:
     virtual bool accepts(QPluginLoader* loader, QString* error = NULL) const;
+    virtual bool acceptsMetaData(
+            const QJsonObject& metaData, QString* error = NULL) const;
 };
 
 } // namespace qtcore
@@ -0,0 +1,143 @@
+/****************************************************************************
+**  FougTools
+**  Copyright Fougue (30 Mar. 2015)
+**  contact@fougue.pro
+**
+** This software is a computer program whose purpose is to provide utility
+** tools for the C++ language and the Qt toolkit.
+**
+** This software is governed by the CeCILL-C license under French law and
+** abiding by the rules of distribution of free software.  You can  use,
+** modify and/ or redistribute the software under the terms of the CeCILL-C
+** license as circulated by CEA, CNRS and INRIA at the following URL
+** "http://www.cecill.info".
+****************************************************************************/
+
+
+#include "profile_report.h"
+
+#include "log.h"
+#include "../../cpptools/profiling.h"
+
+#include <QtCore/QStringList>
+#include <algorithm>
+
+namespace qtcore {
+
+/*!
+ * \class ProfileReport
+ * \brief Reports the timings of the profile zones (CPPTOOLS_PROFILE_ZONE())
+ *        recorded by all threads
+ *
+ * Zones only record when the code is built with CPPTOOLS_ENABLE_PROFILING
+ * (qmake : CONFIG += profiling), otherwise zones() is empty.
+ *
+ * Percentiles come from cpp::ProfileZoneStats histograms, they are upper
+ * bounds within 25% of the exact values.
+ *
+ * \headerfile profile_report.h <qttools/core/profile_report.h>
+ * \ingroup qttools_core
+ */
+
+ProfileReport::Zone::Zone()
+    : count(0),
+      totalMSec(0.),
+      meanMSec(0.),
+      minMSec(0.),
+      p50MSec(0.),
+      p90MSec(0.),
+      p99MSec(0.),
+      maxMSec(0.),
+      percentOfTotal(0.)
+{
+}
+
+namespace internal {
+
+static double nsecToMSec(double nsec)
+{
+    return nsec / 1e6;
+}
+
+} // namespace internal
+
+/*! Timings of all zones, sorted by decreasing total time
+ *
+ *  Zone::percentOfTotal is relative to the sum of the total times of all
+ *  zones (nested zones are counted in both)
+ */
+QVector<ProfileReport::Zone> ProfileReport::zones()
+{
+    const std::vector<cpp::ProfileZoneStats> stats = cpp::profileSnapshot();
+    double sumTotalMSec = 0.;
+    QVector<Zone> zones;
+    zones.reserve(static_cast<int>(stats.size()));
+    for (const cpp::ProfileZoneStats& zoneStats : stats) {
+        Zone zone;
+        zone.name = QString::fromUtf8(zoneStats.name);
+        zone.count = zoneStats.count;
+        zone.totalMSec = internal::nsecToMSec(static_cast<double>(zoneStats.totalNSec));
+        zone.meanMSec = internal::nsecToMSec(zoneStats.meanNSec());
+        zone.minMSec = internal::nsecToMSec(static_cast<double>(zoneStats.minNSec));
+        zone.p50MSec = internal::nsecToMSec(static_cast<double>(zoneStats.percentileNSec(0.5)));
+        zone.p90MSec = internal::nsecToMSec(static_cast<double>(zoneStats.percentileNSec(0.9)));
+        zone.p99MSec = internal::nsecToMSec(static_cast<double>(zoneStats.percentileNSec(0.99)));
+        zone.maxMSec = internal::nsecToMSec(static_cast<double>(zoneStats.maxNSec));
+        sumTotalMSec += zone.totalMSec;
+        zones.append(zone);
+    }
+
+    for (Zone& zone : zones) {
+        if (sumTotalMSec > 0.)
+            zone.percentOfTotal = 100. * zone.totalMSec / sumTotalMSec;
+    }
+    std::sort(zones.begin(), zones.end(), [] (const Zone& lhs, const Zone& rhs) {
+        return lhs.totalMSec > rhs.totalMSec;
+    });
+    return zones;
+}
+
+//! Formats \p zones as a text table, one line per zone
+QString ProfileReport::toText(const QVector<Zone>& zones)
+{
+    QStringList lines;
+    lines << QString("%1 %2 %3 %4 %5 %6 %7 %8 %9")
+             .arg("zone", -48)
+             .arg("count", 10)
+             .arg("total(ms)", 12)
+             .arg("%", 6)
+             .arg("mean(ms)", 10)
+             .arg("p50(ms)", 10)
+             .arg("p90(ms)", 10)
+             .arg("p99(ms)", 10)
+             .arg("max(ms)", 10);
+    for (const Zone& zone : zones) {
+        lines << QString("%1 %2 %3 %4 %5 %6 %7 %8 %9")
+                 .arg(zone.name, -48)
+                 .arg(zone.count, 10)
+                 .arg(zone.totalMSec, 12, 'f', 3)
+                 .arg(zone.percentOfTotal, 6, 'f', 1)
+                 .arg(zone.meanMSec, 10, 'f', 3)
+                 .arg(zone.p50MSec, 10, 'f', 3)
+                 .arg(zone.p90MSec, 10, 'f', 3)
+                 .arg(zone.p99MSec, 10, 'f', 3)
+                 .arg(zone.maxMSec, 10, 'f', 3);
+    }
+    return lines.join(QLatin1String("\n"));
+}
+
+//! Writes toText(zones()) with qtcore::infoLog(), if there is any zone
+void ProfileReport::writeToLog()
+{
+    const QVector<Zone> currentZones = ProfileReport::zones();
+    if (!currentZones.isEmpty())
+        infoLog() << ProfileReport::toText(currentZones);
+}
+
+//! Clears the timings recorded so far by all threads
+void ProfileReport::reset()
+{
+    cpp::profileReset();
+}
+
+} // namespace qtcore
@@ -0,0 +1,49 @@
+/****************************************************************************
+**  FougTools
+**  Copyright Fougue (30 Mar. 2015)
+**  contact@fougue.pro
+**
+** This software is a computer program whose purpose is to provide utility
+** tools for the C++ language and the Qt toolkit.
+**
+** This software is governed by the CeCILL-C license under French law and
+** abiding by the rules of distribution of free software.  You can  use,
+** modify and/ or redistribute the software under the terms of the CeCILL-C
+** license as circulated by CEA, CNRS and INRIA at the following URL
+** "http://www.cecill.info".
+****************************************************************************/
+
+
+#pragma once
+
+#include "core.h"
+#include <QtCore/QString>
+#include <QtCore/QVector>
+
+namespace qtcore {
+
+class QTTOOLS_CORE_EXPORT ProfileReport
+{
+public:
+    struct Zone
+    {
+        Zone();
+        QString name;
+        quint64 count;
+        double totalMSec;
+        double meanMSec;
+        double minMSec;
+        double p50MSec;
+        double p90MSec;
+        double p99MSec;
+        double maxMSec;
+        double percentOfTotal;
+    };
+
+    static QVector<Zone> zones();
+    static QString toText(const QVector<Zone>& zones);
+    static void writeToLog();
+    static void reset();
+};
+
+} // namespace qtcore
@@ -33,6 +33,7 @@ public:
 
     // QAtomicPointer
     template<typename T>  static T* loadRelaxed(const QAtomicPointer<T>& atomPtr);
+    template<typename T>  static T* loadAcquire(const QAtomicPointer<T>& atomPtr);
 
     template<typename T>  static void storeRelaxed(QAtomicPointer<T>* atomPtr, T* newPtr);
     template<typename T>  static void storeRelease(QAtomicPointer<T>* atomPtr, T* newPtr);
@@ -53,6 +54,20 @@ template<typename T>  T* QAtomicUtils::loadRelaxed(const QAtomicPointer<T>& atom
 #endif
 }
 
+template<typename T>  T* QAtomicUtils::loadAcquire(const QAtomicPointer<T>& atomPtr)
+{
+#if (QT_VERSION >= QT_VERSION_CHECK(5, 0, 0))
+    return atomPtr.loadAcquire();
+#else
+    // Qt4 has no acquire load, a no-op acquire CAS provides the ordering
+    QAtomicPointer<T>& ptr = const_cast<QAtomicPointer<T>&>(atomPtr);
+    T* value = ptr;
+    while (!ptr.testAndSetAcquire(value, value))
+        value = ptr;
+    return value;
+#endif
+}
+
 template<typename T>  void QAtomicUtils::storeRelaxed(QAtomicPointer<T>* atomPtr, T* newPtr)
 {
 #if (QT_VERSION >= QT_VERSION_CHECK(5, 0, 0))
@@ -19,9 +19,52 @@
 
 #include <QtCore/QMetaObject>
 #include <QtCore/QMetaEnum>
+#include <QtCore/QGlobalStatic>
+
+#include <cassert>
 
 namespace qtcore {
 
+namespace internal {
+
+/*! Immutable table of all QLocale::Country values, built once per process
+ *
+ *  Vectors are indexed by country code and measurement system value, so
+ *  lookups are O(1)
+ */
+struct LocaleCountryTable
+{
+    LocaleCountryTable();
+
+    std::vector<QLocale::Country> countries;
+    // Indexed by QLocale::Country code, -1 if not a valid country
+    std::vector<int> measSysOfCountry;
+    // Indexed by QLocale::MeasurementSystem value
+    std::vector<std::vector<QLocale::Country>> countriesOfMeasSys;
+};
+
+LocaleCountryTable::LocaleCountryTable()
+    : countries(QObjectUtils::allQEnumValues<QLocale, QLocale::Country>("Country"))
+{
+    for (QLocale::Country country : this->countries) {
+        const int code = static_cast<int>(country);
+        const int measSys = static_cast<int>(
+                    QLocale(QLocale::AnyLanguage, country).measurementSystem());
+        if (code >= static_cast<int>(this->measSysOfCountry.size()))
+            this->measSysOfCountry.resize(code + 1, -1);
+        this->measSysOfCountry.at(code) = measSys;
+        if (measSys >= static_cast<int>(this->countriesOfMeasSys.size()))
+            this->countriesOfMeasSys.resize(measSys + 1);
+        this->countriesOfMeasSys.at(measSys).push_back(country);
+    }
+}
+
+Q_GLOBAL_STATIC(LocaleCountryTable, globalLocaleCountryTable)
+
+static const std::vector<QLocale::Country> emptyCountries;
+
+} // namespace internal
+
 /*! \class QLocaleUtils
  *  \brief Provides a collection of tools around QLocale
  *  \headerfile qlocale_utils.h <qttools/core/qlocale_utils.h>
@@ -39,13 +82,52 @@ QLocale::MeasurementSystem QLocaleUtils::toMeasurementSystem(int measSys)
 //! Safe cast of an integer to QLocale::Country
 QLocale::Country QLocaleUtils::toCountry(int code)
 {
-    return QObjectUtils::toQEnumValue<QLocale, QLocale::Country>("Country", code);
+    assert(QLocaleUtils::isCountry(code));
+    return static_cast<QLocale::Country>(code);
+}
+
+//! Is \p code the value of a QLocale::Country enumerator ?
+bool QLocaleUtils::isCountry(int code)
+{
+    const internal::LocaleCountryTable* table = internal::globalLocaleCountryTable();
+    return 0 <= code
+            && code < static_cast<int>(table->measSysOfCountry.size())
+            && table->measSysOfCountry.at(code) != -1;
+}
+
+/*! All enumerator values of QLocale::Country returned in a single array
+ *
+ *  The array is built once (on first call) and shared by all callers
+ */
+const std::vector<QLocale::Country>& QLocaleUtils::allCountries()
+{
+    return internal::globalLocaleCountryTable()->countries;
+}
+
+/*! Measurement system used in \p country
+ *
+ *  It is the measurement system of the locale QLocale(AnyLanguage, country),
+ *  computed once for all countries
+ */
+QLocale::MeasurementSystem QLocaleUtils::measurementSystem(QLocale::Country country)
+{
+    const int code = static_cast<int>(country);
+    if (QLocaleUtils::isCountry(code)) {
+        const int measSys = internal::globalLocaleCountryTable()->measSysOfCountry.at(code);
+        return static_cast<QLocale::MeasurementSystem>(measSys);
+    }
+    return QLocale::MetricSystem;
 }
 
-//! All enumerator values of QLocale::Country returned in a single array
-std::vector<QLocale::Country> QLocaleUtils::allCountries()
+//! All countries using the measurement system \p measSys
+const std::vector<QLocale::Country>& QLocaleUtils::countriesOfMeasurementSystem(
+        QLocale::MeasurementSystem measSys)
 {
-    return QObjectUtils::allQEnumValues<QLocale, QLocale::Country>("Country");
+    const internal::LocaleCountryTable* table = internal::globalLocaleCountryTable();
+    const int index = static_cast<int>(measSys);
+    if (0 <= index && index < static_cast<int>(table->countriesOfMeasSys.size()))
+        return table->countriesOfMeasSys.at(index);
+    return internal::emptyCountries;
 }
 
 } // namespace qtcore
@@ -27,7 +27,12 @@ public:
     static QLocale::MeasurementSystem toMeasurementSystem(int measSys);
 
     static QLocale::Country toCountry(int code);
-    static std::vector<QLocale::Country> allCountries();
+    static bool isCountry(int code);
+    static const std::vector<QLocale::Country>& allCountries();
+
+    static QLocale::MeasurementSystem measurementSystem(QLocale::Country country);
+    static const std::vector<QLocale::Country>& countriesOfMeasurementSystem(
+            QLocale::MeasurementSystem measSys);
 };
 
 } // namespace qtcore
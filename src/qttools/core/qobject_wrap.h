@@ -16,9 +16,14 @@
 #pragma once
 
 #include <QtCore/QObject>
+#include <type_traits>
+#include <utility>
 
 namespace qtcore {
 
+//! Tag type to select the in-place (emplace) constructor of QObjectWrap
+struct QObjectWrapInPlace {};
+
 /*! Wraps (adapts) any class object into a QObject instance
  *
  *  This class is useful to let Qt handle the lifecycle of a non QObject : wrap
@@ -33,10 +38,14 @@ class QObjectWrap : public QObject
 public:
     QObjectWrap(const T& value, QObject* parent = nullptr);
     QObjectWrap(T&& value, QObject* parent = nullptr);
+    template<typename... ARGS>
+    QObjectWrap(QObjectWrapInPlace, QObject* parent, ARGS&&... args);
 
     const T& value() const;
+    T& value();
     void setValue(const T& val);
     void setValue(T&& val);
+    T takeValue();
 
 private:
     T m_value;
@@ -51,6 +60,13 @@ private:
 template<typename T>
 QObjectWrap<T>* wrapAsQObject(const T& value, QObject* parent = nullptr);
 
+template<typename T>
+QObjectWrap<typename std::decay<T>::type>* wrapAsQObject(
+        T&& value, QObject* parent = nullptr);
+
+template<typename T, typename... ARGS>
+QObjectWrap<T>* emplaceAsQObject(QObject* parent, ARGS&&... args);
+
 
 // --
 // -- Implementation
@@ -65,20 +81,46 @@ QObjectWrap<T>::QObjectWrap(const T& value, QObject* parent)
 template<typename T>
 QObjectWrap<T>::QObjectWrap(T&& value, QObject* parent)
     : QObject(parent),
-      m_value(value)
+      m_value(std::move(value))
+{ }
+
+/*! Constructs the wrapped value in place from \p args, no copy or move of
+ *  \c T is done
+ *
+ *  \code
+ *      auto wrap = new qtcore::QObjectWrap<Mesh>(
+ *                  qtcore::QObjectWrapInPlace(), parent, nodeCount, triangleCount);
+ *  \endcode
+ */
+template<typename T>
+template<typename... ARGS>
+QObjectWrap<T>::QObjectWrap(QObjectWrapInPlace, QObject* parent, ARGS&&... args)
+    : QObject(parent),
+      m_value(std::forward<ARGS>(args)...)
 { }
 
 template<typename T>
 const T& QObjectWrap<T>::value() const
 { return m_value; }
 
+template<typename T>
+T& QObjectWrap<T>::value()
+{ return m_value; }
+
 template<typename T>
 void QObjectWrap<T>::setValue(const T& val)
 { m_value = val; }
 
 template<typename T>
 void QObjectWrap<T>::setValue(T&& val)
-{ m_value = val; }
+{ m_value = std::move(val); }
+
+/*! Moves the wrapped value out, this object is then left with a valid but
+ *  unspecified value
+ */
+template<typename T>
+T QObjectWrap<T>::takeValue()
+{ return std::move(m_value); }
 
 template<typename T>
 QObjectWrap<T>* wrapAsQObject(const T& value, QObject* parent)
@@ -86,4 +128,26 @@ QObjectWrap<T>* wrapAsQObject(const T& value, QObject* parent)
     return new QObjectWrap<T>(value, parent);
 }
 
+/*! Same as wrapAsQObject(const T&, QObject*) but \p value is moved into the
+ *  wrapper when it is an rvalue
+ *  \relates QObjectWrap
+ */
+template<typename T>
+QObjectWrap<typename std::decay<T>::type>* wrapAsQObject(T&& value, QObject* parent)
+{
+    typedef typename std::decay<T>::type ValueType;
+    return new QObjectWrap<ValueType>(
+                QObjectWrapInPlace(), parent, std::forward<T>(value));
+}
+
+/*! Create a QObjectWrap<T> whose value is constructed in place from \p args
+ *  \relates QObjectWrap
+ */
+template<typename T, typename... ARGS>
+QObjectWrap<T>* emplaceAsQObject(QObject* parent, ARGS&&... args)
+{
+    return new QObjectWrap<T>(
+                QObjectWrapInPlace(), parent, std::forward<ARGS>(args)...);
+}
+
 } // namespace qtcore
@@ -0,0 +1,238 @@
+/****************************************************************************
+**  FougTools
+**  Copyright Fougue (30 Mar. 2015)
+**  contact@fougue.pro
+**
+** This software is a computer program whose purpose is to provide utility
+** tools for the C++ language and the Qt toolkit.
+**
+** This software is governed by the CeCILL-C license under French law and
+** abiding by the rules of distribution of free software.  You can  use,
+** modify and/ or redistribute the software under the terms of the CeCILL-C
+** license as circulated by CEA, CNRS and INRIA at the following URL
+** "http://www.cecill.info".
+****************************************************************************/
+
+
+#include "qstring_utils.h"
+
+#include "../../cpptools/hash_fnv.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+# define QTTOOLS_QSTRINGUTILS_HAVE_SSE2
+# include <emmintrin.h>
+#endif
+
+namespace qtcore {
+
+namespace internal {
+
+//! Simple case folding of a Latin-1 code unit (U+00B5 MICRO SIGN excepted,
+//! it cannot be equal to any other Latin-1 character anyway)
+static inline ushort foldLatin1(ushort c)
+{
+    const bool isUpper =
+            (c >= 'A' && c <= 'Z') || (c >= 0xC0 && c <= 0xDE && c != 0xD7);
+    return isUpper ? c + 0x20 : c;
+}
+
+/*! Length of the common prefix of \p s1 and \p s2 (\p len units each) that
+ *  is Latin-1 and equal ignoring case
+ *
+ *  Stops at the first unit which is not Latin-1 (in \p s1 or \p s2), or on a
+ *  difference. In the latter case \p isDifferent is set to \c true and the
+ *  returned length is meaningless
+ */
+static int latin1CaseInsensitivePrefix(
+        const ushort* s1, const ushort* s2, int len, bool* isDifferent)
+{
+    *isDifferent = false;
+    int i = 0;
+#ifdef QTTOOLS_QSTRINGUTILS_HAVE_SSE2
+    // Eight UTF-16 code units at a time
+    const __m128i latin1Mask = _mm_set1_epi16(static_cast<short>(0xFF00));
+    const __m128i beforeA = _mm_set1_epi16('A' - 1);
+    const __m128i afterZ = _mm_set1_epi16('Z' + 1);
+    const __m128i beforeAGrave = _mm_set1_epi16(0xC0 - 1);
+    const __m128i afterThorn = _mm_set1_epi16(0xDE + 1);
+    const __m128i multiplication = _mm_set1_epi16(0xD7);
+    const __m128i caseBit = _mm_set1_epi16(0x20);
+    for (; i + 8 <= len; i += 8) {
+        const __m128i v1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s1 + i));
+        const __m128i v2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s2 + i));
+        const __m128i nonLatin1 = _mm_and_si128(_mm_or_si128(v1, v2), latin1Mask);
+        if (_mm_movemask_epi8(_mm_cmpeq_epi16(nonLatin1, _mm_setzero_si128())) != 0xFFFF)
+            break; // Let the scalar loop find the exact position
+        // Values are < 0x100 here, so signed comparisons are fine
+        const __m128i isUpper1 = _mm_andnot_si128(
+                    _mm_cmpeq_epi16(v1, multiplication),
+                    _mm_or_si128(
+                        _mm_and_si128(_mm_cmpgt_epi16(v1, beforeA), _mm_cmpgt_epi16(afterZ, v1)),
+                        _mm_and_si128(_mm_cmpgt_epi16(v1, beforeAGrave), _mm_cmpgt_epi16(afterThorn, v1))));
+        const __m128i isUpper2 = _mm_andnot_si128(
+                    _mm_cmpeq_epi16(v2, multiplication),
+                    _mm_or_si128(
+                        _mm_and_si128(_mm_cmpgt_epi16(v2, beforeA), _mm_cmpgt_epi16(afterZ, v2)),
+                        _mm_and_si128(_mm_cmpgt_epi16(v2, beforeAGrave), _mm_cmpgt_epi16(afterThorn, v2))));
+        const __m128i folded1 = _mm_or_si128(v1, _mm_and_si128(isUpper1, caseBit));
+        const __m128i folded2 = _mm_or_si128(v2, _mm_and_si128(isUpper2, caseBit));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi16(folded1, folded2)) != 0xFFFF) {
+            *isDifferent = true;
+            return i;
+        }
+    }
+#endif // QTTOOLS_QSTRINGUTILS_HAVE_SSE2
+    for (; i < len; ++i) {
+        const ushort c1 = s1[i];
+        const ushort c2 = s2[i];
+        if (c1 > 0xFF || c2 > 0xFF)
+            break;
+        if (c1 != c2 && internal::foldLatin1(c1) != internal::foldLatin1(c2)) {
+            *isDifferent = true;
+            break;
+        }
+    }
+    return i;
+}
+
+} // namespace internal
+
+/*! Case-insensitive comparison of UTF-16 strings \p s1 and \p s2, same
+ *  result as QString::compare(s1, s2, Qt::CaseInsensitive) == 0
+ *
+ *  Latin-1 contents are compared eight code units at a time when SSE2 is
+ *  available, QString::compare() is used from the first code unit that is
+ *  not Latin-1
+ */
+bool QStringUtils::iequals(const QChar* s1, int len1, const QChar* s2, int len2)
+{
+    if (len1 != len2)
+        return false;
+    if (s1 == s2)
+        return true;
+    const ushort* u1 = reinterpret_cast<const ushort*>(s1);
+    const ushort* u2 = reinterpret_cast<const ushort*>(s2);
+    bool isDifferent = false;
+    const int prefixLen =
+            internal::latin1CaseInsensitivePrefix(u1, u2, len1, &isDifferent);
+    if (isDifferent)
+        return false;
+    if (prefixLen == len1)
+        return true;
+    return QString::compare(
+                QString::fromRawData(s1 + prefixLen, len1 - prefixLen),
+                QString::fromRawData(s2 + prefixLen, len2 - prefixLen),
+                Qt::CaseInsensitive) == 0;
+}
+
+/*! Case-insensitive hash of \p str, consistent with iequals() : strings equal
+ *  ignoring case have the same hash
+ *
+ *  This is the FNV-1a hash of the case folded code units
+ */
+uint QStringUtils::ihash(const QString& str, uint seed)
+{
+    typedef cpp::hash_fnv_1a_traits<32> FnvTraits;
+    FnvTraits::uint_type hash = FnvTraits::offsetBasis ^ seed;
+    auto fnHashUnit = [&] (ushort unit) {
+        hash = (hash ^ (unit & 0xFF)) * FnvTraits::prime;
+        hash = (hash ^ (unit >> 8)) * FnvTraits::prime;
+    };
+
+    const ushort* units = reinterpret_cast<const ushort*>(str.constData());
+    const int len = str.size();
+    for (int i = 0; i < len; ++i) {
+        const ushort unit = units[i];
+        if (unit < 0x80) {
+            fnHashUnit(unit >= 'A' && unit <= 'Z' ? unit + 0x20 : unit);
+        }
+        else if (QChar::isHighSurrogate(unit)
+                 && i + 1 < len
+                 && QChar::isLowSurrogate(units[i + 1]))
+        {
+            // Fold the whole code point, as QString::compare() does
+            const uint folded =
+                    QChar::toCaseFolded(QChar::surrogateToUcs4(unit, units[i + 1]));
+            if (QChar::requiresSurrogates(folded)) {
+                fnHashUnit(QChar::highSurrogate(folded));
+                fnHashUnit(QChar::lowSurrogate(folded));
+            }
+            else {
+                fnHashUnit(static_cast<ushort>(folded));
+            }
+            ++i;
+        }
+        else {
+            fnHashUnit(static_cast<ushort>(QChar::toCaseFolded(unit)));
+        }
+    }
+    return hash;
+}
+
+#if QT_VERSION >= 0x050200
+/*! Sorts \p strs with \p collator, computing the collation key of each
+ *  string once
+ *
+ *  \sa localeAwareSort(RANDOM_IT, RANDOM_IT, STRING_FUNC, const QCollator&)
+ */
+void QStringUtils::localeAwareSort(QStringList* strs, const QCollator& collator)
+{
+    if (strs != NULL) {
+        QStringUtils::localeAwareSort(
+                    strs->begin(),
+                    strs->end(),
+                    [] (const QString& str) -> const QString& { return str; },
+                    collator);
+    }
+}
+
+/*!
+ * \class QStringSortKeyCache
+ * \brief Provides a cache of collation keys (QCollatorSortKey) of strings
+ *
+ * Comparing two sort keys is much faster than QString::localeAwareCompare(),
+ * which transforms both strings on each call. Use QStringSortKeyLess to sort
+ * containers with the cache.
+ *
+ * \headerfile qstring_utils.h <qttools/core/qstring_utils.h>
+ * \ingroup qttools_core
+ */
+
+QStringSortKeyCache::QStringSortKeyCache(const QCollator& collator)
+    : m_collator(collator)
+{
+}
+
+const QCollator& QStringSortKeyCache::collator() const
+{
+    return m_collator;
+}
+
+//! Collation key of \p str, computed if not in cache yet
+const QCollatorSortKey& QStringSortKeyCache::sortKey(const QString& str)
+{
+    auto it = m_sortKeys.find(str);
+    if (it == m_sortKeys.end())
+        it = m_sortKeys.emplace(str, m_collator.sortKey(str)).first;
+    return it->second;
+}
+
+//! Same as collator().compare(lhs, rhs) but with cached collation keys
+int QStringSortKeyCache::compare(const QString& lhs, const QString& rhs)
+{
+    const QCollatorSortKey& lhsKey = this->sortKey(lhs);
+    return lhsKey.compare(this->sortKey(rhs));
+}
+
+int QStringSortKeyCache::count() const
+{
+    return static_cast<int>(m_sortKeys.size());
+}
+
+void QStringSortKeyCache::clear()
+{
+    m_sortKeys.clear();
+}
+#endif // QT_VERSION
+
+} // namespace qtcore
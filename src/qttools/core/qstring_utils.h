@@ -17,6 +17,17 @@
 
 #include "core.h"
 #include <QtCore/QString>
+#include <cstddef>
+#if QT_VERSION >= 0x050200
+# include "qstring_hfunc.h"
+# include <QtCore/QCollator>
+# include <QtCore/QStringList>
+# include <algorithm>
+# include <iterator>
+# include <unordered_map>
+# include <utility>
+# include <vector>
+#endif // QT_VERSION
 
 namespace qtcore {
 
@@ -39,6 +50,85 @@ public:
     inline static bool iequals(const QString& s1, const QStringRef& s2);
     //! \overload
     inline static bool iequals(const QStringRef& s1, const QString& s2);
+
+    static bool iequals(const QChar* s1, int len1, const QChar* s2, int len2);
+
+    static uint ihash(const QString& str, uint seed = 0);
+
+#if QT_VERSION >= 0x050200
+    static void localeAwareSort(
+            QStringList* strs, const QCollator& collator = QCollator());
+
+    template<typename RANDOM_IT, typename STRING_FUNC>
+    static void localeAwareSort(
+            RANDOM_IT begin,
+            RANDOM_IT end,
+            STRING_FUNC fnString,
+            const QCollator& collator = QCollator());
+#endif // QT_VERSION
+};
+
+#if QT_VERSION >= 0x050200
+class QTTOOLS_CORE_EXPORT QStringSortKeyCache
+{
+public:
+    explicit QStringSortKeyCache(const QCollator& collator = QCollator());
+
+    const QCollator& collator() const;
+
+    const QCollatorSortKey& sortKey(const QString& str);
+    int compare(const QString& lhs, const QString& rhs);
+
+    int count() const;
+    void clear();
+
+private:
+    QCollator m_collator;
+    std::unordered_map<QString, QCollatorSortKey> m_sortKeys;
+};
+
+/*! Functor comparing strings with their (cached) collation keys,
+ *  ie QStringSortKeyCache::compare(lhs, rhs) < 0
+ *
+ *  Same result as QStringLocaleAwareLess (with the collator of the cache),
+ *  but each string is transformed to its sort key only once
+ *  \headerfile qstring_utils.h <qttools/core/qstring_utils.h>
+ *  \ingroup qttools_core
+ */
+struct QTTOOLS_CORE_EXPORT QStringSortKeyLess
+{
+    QStringSortKeyLess(QStringSortKeyCache* cache) : m_cache(cache) {}
+    inline bool operator()(const QString& lhs, const QString& rhs) const
+    { return m_cache->compare(lhs, rhs) < 0; }
+private:
+    QStringSortKeyCache* m_cache;
+};
+#endif // QT_VERSION
+
+/*! Functor wrapper around QStringUtils::iequals(lhs, rhs)
+ *  \headerfile qstring_utils.h <qttools/core/qstring_utils.h>
+ *  \ingroup qttools_core
+ */
+struct QTTOOLS_CORE_EXPORT QStringCaseInsensitiveEqual
+{
+    inline bool operator()(const QString& lhs, const QString& rhs) const
+    { return QStringUtils::iequals(lhs, rhs); }
+};
+
+/*! Functor wrapper around QStringUtils::ihash(str), to be used with
+ *  QStringCaseInsensitiveEqual in hashed containers, ex:
+ *  \code
+ *  std::unordered_map<QString, int,
+ *                     qtcore::QStringCaseInsensitiveHash,
+ *                     qtcore::QStringCaseInsensitiveEqual> symbols;
+ *  \endcode
+ *  \headerfile qstring_utils.h <qttools/core/qstring_utils.h>
+ *  \ingroup qttools_core
+ */
+struct QTTOOLS_CORE_EXPORT QStringCaseInsensitiveHash
+{
+    inline std::size_t operator()(const QString& str) const
+    { return QStringUtils::ihash(str); }
 };
 
 /*! Functor wrapper around QString::localeAwareCompare(lhs, rhs) == 0
@@ -108,7 +198,7 @@ struct QTTOOLS_CORE_EXPORT QStringLocaleAwareGreaterEqual
 
 bool QStringUtils::iequals(const QString &s1, const QString &s2)
 {
-    return QString::compare(s1, s2, Qt::CaseInsensitive) == 0;
+    return QStringUtils::iequals(s1.constData(), s1.size(), s2.constData(), s2.size());
 }
 
 bool QStringUtils::iequals(const QString &s1, QLatin1String s2)
@@ -123,13 +213,53 @@ bool QStringUtils::iequals(QLatin1String s1, const QString &s2)
 
 bool QStringUtils::iequals(const QString& s1, const QStringRef& s2)
 {
-    return QString::compare(s1, s2, Qt::CaseInsensitive) == 0;
+    return QStringUtils::iequals(s1.constData(), s1.size(), s2.constData(), s2.size());
 }
 
 bool QStringUtils::iequals(const QStringRef& s1, const QString& s2)
 {
-    // There is no QString::compare(QStringRef, QString) overload
-    return QString::compare(s2, s1, Qt::CaseInsensitive) == 0;
+    return QStringUtils::iequals(s1.constData(), s1.size(), s2.constData(), s2.size());
+}
+
+#if QT_VERSION >= 0x050200
+/*! Sorts the range [\p begin, \p end) by the strings fnString(*it), with
+ *  \p collator
+ *
+ *  The collation key of each string is computed only once, then the range
+ *  is sorted by comparing keys, which is far cheaper than
+ *  QString::localeAwareCompare() on each comparison.
+ *  Elements whose strings are equal keep their relative order
+ */
+template<typename RANDOM_IT, typename STRING_FUNC>
+void QStringUtils::localeAwareSort(
+        RANDOM_IT begin,
+        RANDOM_IT end,
+        STRING_FUNC fnString,
+        const QCollator& collator)
+{
+    typedef typename std::iterator_traits<RANDOM_IT>::value_type ValueType;
+    typedef typename std::iterator_traits<RANDOM_IT>::difference_type DiffType;
+    typedef std::pair<QCollatorSortKey, std::size_t> KeyIndex;
+    const std::size_t count = static_cast<std::size_t>(std::distance(begin, end));
+    if (count < 2)
+        return;
+
+    std::vector<KeyIndex> keys;
+    keys.reserve(count);
+    std::size_t index = 0;
+    for (RANDOM_IT it = begin; it != end; ++it, ++index)
+        keys.emplace_back(collator.sortKey(fnString(*it)), index);
+    std::sort(keys.begin(), keys.end(), [] (const KeyIndex& lhs, const KeyIndex& rhs) {
+        const int cmp = lhs.first.compare(rhs.first);
+        return cmp < 0 || (cmp == 0 && lhs.second < rhs.second);
+    });
+
+    std::vector<ValueType> sorted;
+    sorted.reserve(count);
+    for (const KeyIndex& key : keys)
+        sorted.push_back(std::move(*(begin + static_cast<DiffType>(key.second))));
+    std::move(sorted.begin(), sorted.end(), begin);
 }
+#endif // QT_VERSION
 
 } // namespace qtcore
@@ -1,5 +1,6 @@
 HEADERS += \
     $$PWD/plugins_loader.h \
+    $$PWD/profile_report.h \
     $$PWD/core.h \
     $$PWD/grid_numbering.h \
     $$PWD/grid_struct.h \
@@ -9,6 +10,7 @@ HEADERS += \
     $$PWD/qt_plugin_def.h \
     $$PWD/runtime_error.h \
     $$PWD/scoped_connection.h \
+    $$PWD/signal_coalescer.h \
     $$PWD/singleton.h \
     $$PWD/sleep.h \
     $$PWD/unique_id.h \
@@ -21,13 +23,17 @@ HEADERS += \
     $$PWD/qsignal_mapper_utils.h \
     $$PWD/qstring_hfunc.h \
     $$PWD/qstring_utils.h \
-    $$PWD/qvariant_utils.h
+    $$PWD/qvariant_utils.h \
+    $$PWD/binary_ring_log_handler.h \
+    $$PWD/item_model_data_index.h
 
 SOURCES += \
     $$PWD/plugins_loader.cpp \
+    $$PWD/profile_report.cpp \
     $$PWD/log.cpp \
     $$PWD/runtime_error.cpp \
     $$PWD/scoped_connection.cpp \
+    $$PWD/signal_coalescer.cpp \
     $$PWD/sleep.cpp \
     $$PWD/grid_numbering.cpp \
     $$PWD/grid_struct.cpp \
@@ -38,4 +44,7 @@ SOURCES += \
     $$PWD/qatomic_utils.cpp \
     $$PWD/qlocale_utils.cpp \
     $$PWD/qobject_utils.cpp \
-    $$PWD/qsignal_mapper_utils.cpp
+    $$PWD/qsignal_mapper_utils.cpp \
+    $$PWD/qstring_utils.cpp \
+    $$PWD/binary_ring_log_handler.cpp \
+    $$PWD/item_model_data_index.cpp
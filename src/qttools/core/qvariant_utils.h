@@ -13,13 +13,100 @@
 ** "http://www.cecill.info".
 ****************************************************************************/
 
+
 #pragma once
 
 #include "core.h"
+#include <QtCore/QList>
 #include <QtCore/QVariant>
+#include <QtCore/QVector>
+
+#include <cstddef>
+#include <iterator>
+#include <utility>
+#include <vector>
 
 namespace qtcore {
 
+/*! \brief Iterator over QVariant objects that converts them to \c T on
+ *         dereference
+ *
+ *  \headerfile qvariant_utils.h <qttools/core/qvariant_utils.h>
+ *  \ingroup qttools_core
+ */
+template<typename T, typename VARIANT_ITERATOR>
+class QVariantTypedIterator
+{
+public:
+    typedef std::input_iterator_tag iterator_category;
+    typedef T value_type;
+    typedef typename std::iterator_traits<VARIANT_ITERATOR>::difference_type difference_type;
+    typedef const T* pointer;
+    typedef T reference;
+
+    QVariantTypedIterator() { }
+    explicit QVariantTypedIterator(VARIANT_ITERATOR it) : m_it(it) { }
+
+    VARIANT_ITERATOR base() const { return m_it; }
+
+    T operator*() const { return (*m_it).template value<T>(); }
+    QVariantTypedIterator& operator++() { ++m_it; return *this; }
+    QVariantTypedIterator operator++(int) { return QVariantTypedIterator(m_it++); }
+
+    bool operator==(const QVariantTypedIterator& other) const
+    { return m_it == other.m_it; }
+    bool operator!=(const QVariantTypedIterator& other) const
+    { return m_it != other.m_it; }
+
+private:
+    VARIANT_ITERATOR m_it;
+};
+
+/*! \brief Read-only view over a range of QVariant objects, seen as a range
+ *         of \c T
+ *
+ *  Items are converted on access with QVariant::value<T>(), no container is
+ *  materialized. The view does not own the variants, the underlying container
+ *  must outlive it and not be modified meanwhile.
+ *
+ *  at() is O(1) if \p VARIANT_ITERATOR is a random access iterator.
+ *
+ *  \headerfile qvariant_utils.h <qttools/core/qvariant_utils.h>
+ *  \ingroup qttools_core
+ *  \sa QVariantUtils::typedView()
+ */
+template<typename T, typename VARIANT_ITERATOR>
+class QVariantTypedView
+{
+public:
+    typedef QVariantTypedIterator<T, VARIANT_ITERATOR> const_iterator;
+    typedef const_iterator iterator;
+    typedef T value_type;
+
+    QVariantTypedView(VARIANT_ITERATOR begin, VARIANT_ITERATOR end)
+        : m_begin(begin), m_end(end)
+    { }
+
+    const_iterator begin() const { return const_iterator(m_begin); }
+    const_iterator end() const { return const_iterator(m_end); }
+
+    std::size_t size() const
+    { return static_cast<std::size_t>(std::distance(m_begin, m_end)); }
+    bool empty() const { return m_begin == m_end; }
+
+    T at(std::size_t i) const
+    {
+        VARIANT_ITERATOR it = m_begin;
+        std::advance(it, i);
+        return (*it).template value<T>();
+    }
+    T operator[](std::size_t i) const { return this->at(i); }
+
+private:
+    VARIANT_ITERATOR m_begin;
+    VARIANT_ITERATOR m_end;
+};
+
 /*! \brief Provides a collection of tools around QVariant
  *  \headerfile qvariant_utils.h <qttools/core/qvariant_utils.h>
  *  \ingroup qttools_core
@@ -31,8 +118,18 @@ public:
     template<typename T, template <typename> class CONTAINER>
     static CONTAINER<T> toTypedContainer(const CONTAINER<QVariant>& variants);
 
+    template<typename T, template <typename> class CONTAINER>
+    static CONTAINER<T> toTypedContainer(CONTAINER<QVariant>&& variants);
+
     template<typename T, template <typename> class CONTAINER>
     static CONTAINER<QVariant> toContainerOfVariants(const CONTAINER<T>& typeds);
+
+    template<typename T, typename CONTAINER>
+    static QVariantTypedView<T, typename CONTAINER::const_iterator>
+    typedView(const CONTAINER& variants);
+
+    template<typename T>
+    static T takeValue(QVariant& variant);
 };
 
 } // namespace qtcore
@@ -41,27 +138,62 @@ public:
 // -- Implementation
 // --
 
-#include <algorithm>
-#include <functional>
-#include <iterator>
-
 namespace qtcore {
 
+namespace internal {
+
+// Capacity reservation for the containers that support it
+template<typename CONTAINER>
+void reserveCapacity(CONTAINER& /*cnter*/, std::size_t /*size*/)
+{ }
+
+template<typename T>
+void reserveCapacity(QList<T>& cnter, std::size_t size)
+{ cnter.reserve(static_cast<int>(size)); }
+
+template<typename T>
+void reserveCapacity(QVector<T>& cnter, std::size_t size)
+{ cnter.reserve(static_cast<int>(size)); }
+
+template<typename T>
+void reserveCapacity(std::vector<T>& cnter, std::size_t size)
+{ cnter.reserve(size); }
+
+} // namespace internal
+
 /*! \brief Converts a container of QVariant to a container of typed data (\c T)
  *
  * The container can be of any type (std::list<>, QVector<>, ...) the only
  * restriction is that it must satisfy the concept of Back Insertion Sequence
  * (see http://www.sgi.com/tech/stl/BackInsertionSequence.html)
  *
- * \sa toContainerOfVariants()
+ * Capacity of the output container is reserved up front when it supports it
+ * (QList, QVector, std::vector)
+ *
+ * \sa toContainerOfVariants(), typedView()
  */
 template<typename T, template <typename> class CONTAINER>
 CONTAINER<T> QVariantUtils::toTypedContainer(const CONTAINER<QVariant>& variants)
 {
     CONTAINER<T> typeds;
-    std::transform(variants.begin(), variants.end(),
-                   std::back_inserter(typeds),
-                   std::ptr_fun(&qVariantValue<T>));
+    internal::reserveCapacity(typeds, variants.size());
+    for (const QVariant& variant : variants)
+        typeds.push_back(variant.value<T>());
+    return typeds;
+}
+
+/*! \brief Same as toTypedContainer(const CONTAINER<QVariant>&) but values are
+ *         moved out of \p variants when possible
+ *
+ * \sa takeValue()
+ */
+template<typename T, template <typename> class CONTAINER>
+CONTAINER<T> QVariantUtils::toTypedContainer(CONTAINER<QVariant>&& variants)
+{
+    CONTAINER<T> typeds;
+    internal::reserveCapacity(typeds, variants.size());
+    for (QVariant& variant : variants)
+        typeds.push_back(QVariantUtils::takeValue<T>(variant));
     return typeds;
 }
 
@@ -71,18 +203,46 @@ CONTAINER<T> QVariantUtils::toTypedContainer(const CONTAINER<QVariant>& variants
  * restriction is that it must satisfy the concept of Back Insertion Sequence
  * (see http://www.sgi.com/tech/stl/BackInsertionSequence.html)
  *
+ * Capacity of the output container is reserved up front when it supports it
+ * (QList, QVector, std::vector)
+ *
  * \sa toTypedContainer()
  */
 template<typename T, template <typename> class CONTAINER>
 CONTAINER<QVariant> QVariantUtils::toContainerOfVariants(const CONTAINER<T>& typeds)
 {
     CONTAINER<QVariant> variants;
-    std::transform(typeds.begin(), typeds.end(),
-                   std::back_inserter(variants),
-                   std::ptr_fun(&QVariant::fromValue<T>));
+    internal::reserveCapacity(variants, typeds.size());
+    for (const T& typed : typeds)
+        variants.push_back(QVariant::fromValue<T>(typed));
     return variants;
 }
 
-} // namespace qtcore
+/*! \brief Returns a view over \p variants where items are seen as \c T
+ *
+ * Unlike toTypedContainer(), no container is built : each variant is converted
+ * when accessed
+ */
+template<typename T, typename CONTAINER>
+QVariantTypedView<T, typename CONTAINER::const_iterator>
+QVariantUtils::typedView(const CONTAINER& variants)
+{
+    return QVariantTypedView<T, typename CONTAINER::const_iterator>(
+                variants.begin(), variants.end());
+}
+
+/*! \brief Extracts the value of type \c T held by \p variant
+ *
+ * If \p variant holds exactly a \c T then its value is moved out (\p variant
+ * is left with a valid but unspecified \c T), otherwise it is converted with
+ * QVariant::value<T>()
+ */
+template<typename T>
+T QVariantUtils::takeValue(QVariant& variant)
+{
+    if (variant.userType() == qMetaTypeId<T>())
+        return std::move(*static_cast<T*>(variant.data()));
+    return variant.value<T>();
+}
 
-#endif // QTTOOLS_QVARIANT_TOOLS_H
+} // namespace qtcore
@@ -45,6 +45,12 @@ ScopedConnect::ScopedConnect(const QObject* sender, const char* signal,
 
 ScopedConnect::~ScopedConnect()
 {
+#if QT_VERSION >= 0x050000
+    if (m_signal == nullptr) {
+        QObject::disconnect(m_connection);
+        return;
+    }
+#endif
     QObject::disconnect(m_sender, m_signal, m_receiver, m_slot);
 }
 
@@ -74,6 +80,12 @@ ScopedDisconnect::ScopedDisconnect(const QObject* sender, const char* signal,
 
 ScopedDisconnect::~ScopedDisconnect()
 {
+#if QT_VERSION >= 0x050000
+    if (m_fnReconnect) {
+        m_fnReconnect();
+        return;
+    }
+#endif
     QObject::connect(m_sender, m_signal, m_receiver, m_slot, m_type);
 }
 
@@ -16,8 +16,10 @@
 #pragma once
 
 #include "core.h"
-#include <QtCore/Qt>
-class QObject;
+#include <QtCore/QObject>
+#if QT_VERSION >= 0x050000
+# include <functional>
+#endif
 
 namespace qtcore {
 
@@ -27,6 +29,17 @@ public:
     ScopedConnect(const QObject* sender, const char* signal,
                   const QObject* receiver, const char* slot,
                   Qt::ConnectionType type = Qt::UniqueConnection);
+#if QT_VERSION >= 0x050000
+    template<typename SENDER, typename SIGNAL_CLASS, typename SIGNAL_TYPE,
+             typename RECEIVER, typename SLOT>
+    ScopedConnect(const SENDER* sender, SIGNAL_TYPE SIGNAL_CLASS::* signal,
+                  const RECEIVER* receiver, SLOT slot,
+                  Qt::ConnectionType type = Qt::AutoConnection);
+    template<typename SENDER, typename SIGNAL_CLASS, typename SIGNAL_TYPE,
+             typename FUNCTOR>
+    ScopedConnect(const SENDER* sender, SIGNAL_TYPE SIGNAL_CLASS::* signal,
+                  FUNCTOR functor);
+#endif
     ~ScopedConnect();
 
 private:
@@ -34,6 +47,9 @@ private:
     const QObject* m_receiver;
     const char* m_signal;
     const char* m_slot;
+#if QT_VERSION >= 0x050000
+    QMetaObject::Connection m_connection;
+#endif
 };
 
 class QTTOOLS_CORE_EXPORT ScopedDisconnect
@@ -42,6 +58,13 @@ public:
     ScopedDisconnect(const QObject* sender, const char* signal,
                      const QObject* receiver, const char* slot,
                      Qt::ConnectionType type = Qt::UniqueConnection);
+#if QT_VERSION >= 0x050000
+    template<typename SENDER, typename SIGNAL_CLASS, typename SIGNAL_TYPE,
+             typename RECEIVER, typename SLOT_CLASS, typename SLOT_TYPE>
+    ScopedDisconnect(const SENDER* sender, SIGNAL_TYPE SIGNAL_CLASS::* signal,
+                     const RECEIVER* receiver, SLOT_TYPE SLOT_CLASS::* slot,
+                     Qt::ConnectionType type = Qt::AutoConnection);
+#endif
     ~ScopedDisconnect();
 
 private:
@@ -50,6 +73,74 @@ private:
     const char* m_signal;
     const char* m_slot;
     const Qt::ConnectionType m_type;
+#if QT_VERSION >= 0x050000
+    std::function<void()> m_fnReconnect;
+#endif
 };
 
 } // namespace qtcore
+
+// --
+// -- Implementation
+// --
+
+#if QT_VERSION >= 0x050000
+namespace qtcore {
+
+/*! Same as ScopedConnect(const QObject*, const char*, const QObject*, const char*, Qt::ConnectionType)
+ *  but with pointer-to-member signal and pointer-to-member (or functor) slot
+ *
+ *  No signature lookup is done by string : the QMetaObject::Connection
+ *  returned by QObject::connect() is kept and used for disconnection
+ */
+template<typename SENDER, typename SIGNAL_CLASS, typename SIGNAL_TYPE,
+         typename RECEIVER, typename SLOT>
+ScopedConnect::ScopedConnect(
+        const SENDER* sender, SIGNAL_TYPE SIGNAL_CLASS::* signal,
+        const RECEIVER* receiver, SLOT slot,
+        Qt::ConnectionType type)
+    : m_sender(sender),
+      m_receiver(receiver),
+      m_signal(nullptr),
+      m_slot(nullptr),
+      m_connection(QObject::connect(sender, signal, receiver, slot, type))
+{
+}
+
+//! Connects \p signal of \p sender to \p functor, disconnected upon destruction
+template<typename SENDER, typename SIGNAL_CLASS, typename SIGNAL_TYPE,
+         typename FUNCTOR>
+ScopedConnect::ScopedConnect(
+        const SENDER* sender, SIGNAL_TYPE SIGNAL_CLASS::* signal, FUNCTOR functor)
+    : m_sender(sender),
+      m_receiver(nullptr),
+      m_signal(nullptr),
+      m_slot(nullptr),
+      m_connection(QObject::connect(sender, signal, std::move(functor)))
+{
+}
+
+/*! Same as ScopedDisconnect(const QObject*, const char*, const QObject*, const char*, Qt::ConnectionType)
+ *  but with pointer-to-member signal and slot
+ *
+ *  These member pointers are kept to re-establish the connection upon
+ *  destruction, so no signature lookup is done by string
+ */
+template<typename SENDER, typename SIGNAL_CLASS, typename SIGNAL_TYPE,
+         typename RECEIVER, typename SLOT_CLASS, typename SLOT_TYPE>
+ScopedDisconnect::ScopedDisconnect(
+        const SENDER* sender, SIGNAL_TYPE SIGNAL_CLASS::* signal,
+        const RECEIVER* receiver, SLOT_TYPE SLOT_CLASS::* slot,
+        Qt::ConnectionType type)
+    : m_sender(sender),
+      m_receiver(receiver),
+      m_signal(nullptr),
+      m_slot(nullptr),
+      m_type(type),
+      m_fnReconnect([=] { QObject::connect(sender, signal, receiver, slot, type); })
+{
+    QObject::disconnect(sender, signal, receiver, slot);
+}
+
+} // namespace qtcore
+#endif // QT_VERSION
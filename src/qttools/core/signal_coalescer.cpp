@@ -0,0 +1,119 @@
+/****************************************************************************
+**  FougTools
+**  Copyright Fougue (30 Mar. 2015)
+**  contact@fougue.pro
+**
+** This software is a computer program whose purpose is to provide utility
+** tools for the C++ language and the Qt toolkit.
+**
+** This software is governed by the CeCILL-C license under French law and
+** abiding by the rules of distribution of free software.  You can  use,
+** modify and/ or redistribute the software under the terms of the CeCILL-C
+** license as circulated by CEA, CNRS and INRIA at the following URL
+** "http://www.cecill.info".
+****************************************************************************/
+
+
+#include "signal_coalescer.h"
+
+namespace qtcore {
+
+/*!
+ * \class SignalCoalescer
+ * \brief Coalesces bursts of trigger() calls into a single activated() signal
+ *
+ * The first call to trigger() starts a single-shot timer, further calls only
+ * increment pendingCount(). When the timer expires activated() is emitted
+ * once, with the count of coalesced triggers.
+ *
+ * With a delay of 0 (the default) activated() is emitted on the next turn of
+ * the event loop. The timer is not restarted by trigger(), so the latency of
+ * activated() is bounded by delay() even under continuous emissions.
+ *
+ * \code
+ *     auto coalescer = new qtcore::SignalCoalescer(16, this);
+ *     QObject::connect(selectionModel, &IndexedSelectionModel::itemToggled,
+ *                      coalescer, &qtcore::SignalCoalescer::trigger);
+ *     QObject::connect(coalescer, &qtcore::SignalCoalescer::activated,
+ *                      view, &QWidget::update);
+ * \endcode
+ *
+ * \headerfile signal_coalescer.h <qttools/core/signal_coalescer.h>
+ * \ingroup qttools_core
+ * \sa SignalBatcher
+ */
+
+SignalCoalescer::SignalCoalescer(QObject* parent)
+    : QObject(parent),
+      m_timer(this),
+      m_pendingCount(0)
+{
+    m_timer.setSingleShot(true);
+    m_timer.setInterval(0);
+    QObject::connect(&m_timer, SIGNAL(timeout()), this, SLOT(onTimeout()));
+}
+
+SignalCoalescer::SignalCoalescer(int delay, QObject* parent)
+    : QObject(parent),
+      m_timer(this),
+      m_pendingCount(0)
+{
+    m_timer.setSingleShot(true);
+    m_timer.setInterval(delay);
+    QObject::connect(&m_timer, SIGNAL(timeout()), this, SLOT(onTimeout()));
+}
+
+//! Delay (in milliseconds) between the first trigger() and activated()
+int SignalCoalescer::delay() const
+{
+    return m_timer.interval();
+}
+
+void SignalCoalescer::setDelay(int msecs)
+{
+    m_timer.setInterval(msecs);
+}
+
+//! Is there any trigger() not delivered yet by activated() ?
+bool SignalCoalescer::isPending() const
+{
+    return m_pendingCount > 0;
+}
+
+//! Count of trigger() calls since the last activated()
+int SignalCoalescer::pendingCount() const
+{
+    return m_pendingCount;
+}
+
+//! Records one emission, activated() will be emitted after delay()
+void SignalCoalescer::trigger()
+{
+    ++m_pendingCount;
+    if (!m_timer.isActive())
+        m_timer.start();
+}
+
+//! Emits activated() now if there are pending triggers
+void SignalCoalescer::flush()
+{
+    m_timer.stop();
+    this->onTimeout();
+}
+
+//! Discards pending triggers, activated() will not be emitted for them
+void SignalCoalescer::cancel()
+{
+    m_timer.stop();
+    m_pendingCount = 0;
+}
+
+void SignalCoalescer::onTimeout()
+{
+    const int count = m_pendingCount;
+    m_pendingCount = 0;
+    if (count > 0)
+        emit activated(count);
+}
+
+} // namespace qtcore
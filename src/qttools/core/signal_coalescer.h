@@ -0,0 +1,176 @@
+/****************************************************************************
+**  FougTools
+**  Copyright Fougue (30 Mar. 2015)
+**  contact@fougue.pro
+**
+** This software is a computer program whose purpose is to provide utility
+** tools for the C++ language and the Qt toolkit.
+**
+** This software is governed by the CeCILL-C license under French law and
+** abiding by the rules of distribution of free software.  You can  use,
+** modify and/ or redistribute the software under the terms of the CeCILL-C
+** license as circulated by CEA, CNRS and INRIA at the following URL
+** "http://www.cecill.info".
+****************************************************************************/
+
+
+#pragma once
+
+#include "core.h"
+#include <QtCore/QObject>
+#include <QtCore/QTimer>
+
+#if QT_VERSION >= 0x050000
+# include <functional>
+# include <utility>
+# include <vector>
+#endif
+
+namespace qtcore {
+
+class QTTOOLS_CORE_EXPORT SignalCoalescer : public QObject
+{
+    Q_OBJECT
+
+public:
+    SignalCoalescer(QObject* parent = NULL);
+    SignalCoalescer(int delay, QObject* parent = NULL);
+
+    int delay() const;
+    void setDelay(int msecs);
+
+    bool isPending() const;
+    int pendingCount() const;
+
+public slots:
+    void trigger();
+    void flush();
+    void cancel();
+
+signals:
+    void activated(int count);
+
+private slots:
+    void onTimeout();
+
+private:
+    QTimer m_timer;
+    int m_pendingCount;
+};
+
+#if QT_VERSION >= 0x050000
+template<typename T>
+class SignalBatcher
+{
+public:
+    typedef std::function<void(const std::vector<T>&)> Callback;
+
+    SignalBatcher(Callback fn, int delay = 0);
+
+    void add(const T& value);
+    void add(T&& value);
+
+    void flush();
+    void cancel();
+
+    SignalCoalescer* coalescer() const;
+
+private:
+    SignalBatcher(const SignalBatcher&) = delete;
+    SignalBatcher& operator=(const SignalBatcher&) = delete;
+
+    void deliver();
+
+    SignalCoalescer m_coalescer;
+    Callback m_fnCallback;
+    std::vector<T> m_values;
+};
+#endif // QT_VERSION
+
+} // namespace qtcore
+
+// --
+// -- Implementation
+// --
+
+#if QT_VERSION >= 0x050000
+namespace qtcore {
+
+/*!
+ * \class SignalBatcher
+ * \brief Collects values for one event-loop turn (or a delay) and delivers them
+ *        all at once to a callback
+ *
+ * Typical use is to connect a high-rate signal to a lambda calling add(), the
+ * callback then gets an array of all the values emitted meanwhile.
+ *
+ * \code
+ *     qtcore::SignalBatcher<int> batcher([=] (const std::vector<int>& ids) {
+ *         view->updateItems(ids);
+ *     });
+ *     QObject::connect(model, &Model::itemChanged, [&] (int id) { batcher.add(id); });
+ * \endcode
+ *
+ * \headerfile signal_coalescer.h <qttools/core/signal_coalescer.h>
+ * \ingroup qttools_core
+ * \sa SignalCoalescer
+ */
+
+template<typename T>
+SignalBatcher<T>::SignalBatcher(Callback fn, int delay)
+    : m_coalescer(delay),
+      m_fnCallback(std::move(fn))
+{
+    QObject::connect(
+                &m_coalescer, &SignalCoalescer::activated,
+                [=] (int) { this->deliver(); });
+}
+
+template<typename T>
+void SignalBatcher<T>::add(const T& value)
+{
+    m_values.push_back(value);
+    m_coalescer.trigger();
+}
+
+template<typename T>
+void SignalBatcher<T>::add(T&& value)
+{
+    m_values.push_back(std::move(value));
+    m_coalescer.trigger();
+}
+
+//! Delivers immediately the values collected, if any
+template<typename T>
+void SignalBatcher<T>::flush()
+{
+    m_coalescer.flush();
+}
+
+//! Discards the values collected
+template<typename T>
+void SignalBatcher<T>::cancel()
+{
+    m_coalescer.cancel();
+    m_values.clear();
+}
+
+//! The underlying SignalCoalescer, useful to change its delay
+template<typename T>
+SignalCoalescer* SignalBatcher<T>::coalescer() const
+{
+    return const_cast<SignalCoalescer*>(&m_coalescer);
+}
+
+template<typename T>
+void SignalBatcher<T>::deliver()
+{
+    // Swap first so the callback can safely add() values for the next batch
+    std::vector<T> values;
+    values.swap(m_values);
+    if (m_fnCallback)
+        m_fnCallback(values);
+}
+
+} // namespace qtcore
+#endif // QT_VERSION
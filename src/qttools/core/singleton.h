@@ -15,6 +15,7 @@
 
 #pragma once
 
+#include "qatomic_utils.h"
 #include <QtCore/QAtomicPointer>
 #include <QtCore/QMutex>
 
@@ -36,26 +37,39 @@ private:
 // -- Implementation
 // --
 
+/*! \brief Returns the unique instance of T, created on first call
+ *
+ *  Double-checked locking : once the instance exists, a call is a single
+ *  acquire load. The release store publishing the instance guarantees other
+ *  threads see it fully constructed.
+ */
 template<typename T>
 T* Singleton<T>::instance()
 {
-    if (!m_instance) {
-        m_mutex.lock();
-        if (!m_instance)
-            m_instance = new T;
-        m_mutex.unlock();
+    T* instance = QAtomicUtils::loadAcquire(m_instance);
+    if (instance == NULL) {
+        QMutexLocker locker(&m_mutex); Q_UNUSED(locker);
+        instance = QAtomicUtils::loadRelaxed(m_instance);
+        if (instance == NULL) {
+            instance = new T;
+            QAtomicUtils::storeRelease(&m_instance, instance);
+        }
     }
-    return m_instance;
+    return instance;
 }
 
+/*! \brief Deletes the instance of T, the next call to instance() creates a
+ *         new one
+ *
+ *  Must not be called while other threads may use the instance
+ */
 template<typename T>
 void Singleton<T>::release()
 {
-    m_mutex.lock();
-    if (m_instance)
-        delete m_instance;
-    m_instance = NULL;
-    m_mutex.unlock();
+    QMutexLocker locker(&m_mutex); Q_UNUSED(locker);
+    T* instance = QAtomicUtils::loadRelaxed(m_instance);
+    QAtomicUtils::storeRelease(&m_instance, static_cast<T*>(NULL));
+    delete instance;
 }
 
 } // namespace qtcore
@@ -15,6 +15,7 @@
 
 #include "sleep.h"
 
+#include <QtCore/QElapsedTimer>
 #include <QtCore/QEventLoop>
 #include <QtCore/QThread>
 #include <QtCore/QTimer>
@@ -52,9 +53,11 @@ void mSecSleep(unsigned msec)
  * \brief Waits until \p msec milliseconds have elapsed
  *
  * Internally a QEventLoop is used, so the Qt event system is not blocked while
- * waiting.
+ * waiting. The thread sleeps until an event arrives or the timer expires, no
+ * CPU is burnt. With Qt5 the timer is a Qt::PreciseTimer, so the wait does not
+ * overshoot by the 5% allowed to coarse timers.
  *
- * \sa mSecSleep()
+ * \sa mSecSleep(), WaitEvent
  *
  * \headerfile sleep.h <qttools/core/sleep.h>
  */
@@ -62,9 +65,100 @@ void waitForMSec(unsigned msec)
 {
     if (msec > 0) {
         QEventLoop eventLoop;
+#if QT_VERSION >= 0x050000
+        QTimer::singleShot(msec, Qt::PreciseTimer, &eventLoop, SLOT(quit()));
+#else
         QTimer::singleShot(msec, &eventLoop, SLOT(quit()));
+#endif
         eventLoop.exec();
     }
 }
 
+/*!
+ * \class WaitEvent
+ * \brief Event object a thread can block on with a deadline, until another
+ *        thread sets it
+ *
+ * Unlike polling with mSecSleep(), wait() returns as soon as set() is called,
+ * and the waiting thread does not consume CPU meanwhile.
+ *
+ * With AutoReset mode, a successful wait() resets the event (only one waiter
+ * is released per set()). With ManualReset mode, the event stays set (and all
+ * waiters are released) until reset() is called.
+ *
+ * \code
+ *     // Worker loop
+ *     while (!isStopRequested()) {
+ *         processPendingJobs();
+ *         jobAvailable.wait(1000); // Wakes up early when a job is posted
+ *     }
+ * \endcode
+ *
+ * \headerfile sleep.h <qttools/core/sleep.h>
+ * \ingroup qttools_core
+ */
+
+WaitEvent::WaitEvent(ResetMode mode)
+    : m_resetMode(mode),
+      m_isSet(false)
+{
+}
+
+WaitEvent::ResetMode WaitEvent::resetMode() const
+{
+    return m_resetMode;
+}
+
+//! Sets the event, waking up the waiting thread(s)
+void WaitEvent::set()
+{
+    QMutexLocker locker(&m_mutex);
+    m_isSet = true;
+    if (m_resetMode == AutoReset)
+        m_condition.wakeOne();
+    else
+        m_condition.wakeAll();
+}
+
+void WaitEvent::reset()
+{
+    QMutexLocker locker(&m_mutex);
+    m_isSet = false;
+}
+
+bool WaitEvent::isSet() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_isSet;
+}
+
+/*! Blocks the current thread until the event is set or \p msec milliseconds
+ *  have elapsed
+ *
+ *  Returns \c true if the event was set, \c false on timeout. Spurious
+ *  wake-ups are handled : the deadline is kept.
+ *
+ *  \param elapsedMSec  If not null, receives the time actually spent in wait()
+ */
+bool WaitEvent::wait(unsigned msec, qint64* elapsedMSec)
+{
+    QElapsedTimer chrono;
+    chrono.start();
+    bool isSet = false;
+    {
+        QMutexLocker locker(&m_mutex);
+        qint64 remaining = msec;
+        while (!m_isSet && remaining > 0) {
+            m_condition.wait(&m_mutex, static_cast<unsigned long>(remaining));
+            remaining = static_cast<qint64>(msec) - chrono.elapsed();
+        }
+        isSet = m_isSet;
+        if (isSet && m_resetMode == AutoReset)
+            m_isSet = false;
+    }
+    if (elapsedMSec != nullptr)
+        *elapsedMSec = chrono.elapsed();
+    return isSet;
+}
+
 } // namespace qtcore
@@ -16,11 +16,42 @@
 #pragma once
 
 #include "core.h"
+#include <QtCore/QMutex>
+#include <QtCore/QWaitCondition>
 
 namespace qtcore {
 
 QTTOOLS_CORE_EXPORT void mSecSleep(unsigned msec);
 QTTOOLS_CORE_EXPORT void waitForMSec(unsigned msec);
 
+class QTTOOLS_CORE_EXPORT WaitEvent
+{
+public:
+    enum ResetMode
+    {
+        AutoReset,
+        ManualReset
+    };
+
+    WaitEvent(ResetMode mode = AutoReset);
+
+    ResetMode resetMode() const;
+
+    void set();
+    void reset();
+    bool isSet() const;
+
+    bool wait(unsigned msec, qint64* elapsedMSec = nullptr);
+
+private:
+    WaitEvent(const WaitEvent&) = delete;
+    WaitEvent& operator=(const WaitEvent&) = delete;
+
+    mutable QMutex m_mutex;
+    QWaitCondition m_condition;
+    const ResetMode m_resetMode;
+    bool m_isSet;
+};
+
 } // namespace qtcore
 
@@ -15,21 +15,114 @@
 
 #include "unique_id.h"
 
-#include <QtCore/QMutex>
-#include <QtCore/QMutexLocker>
-#include <QtCore/QSet>
+#include <QtCore/QtAlgorithms>
+#include <QtCore/QtGlobal>
+
+#include <atomic>
 
 namespace qtcore {
 
 namespace internal {
 
+/*! \brief Lock-free registry of ids, a sparse 3-level bitmap
+ *
+ *  The 32 bits of an id (offset from INT_MIN) are split into a top index
+ *  (10 bits), a middle index (10 bits) and the position in a leaf of 4096
+ *  bits. Nodes are allocated on first use with compare-and-swap and never
+ *  freed (ids are never unregistered).
+ */
 class UniqueIdRegistration
 {
 public:
-    QMutex m_mutex;
-    QSet<int> m_set;
+    enum {
+        LeafWordCount = 64,
+        LeafBitCount = LeafWordCount * 64,
+        NodeSize = 1024
+    };
+
+    struct Leaf
+    {
+        Leaf() : freeCount(LeafBitCount) {
+            for (std::atomic<quint64>& word : words)
+                word.store(0, std::memory_order_relaxed);
+        }
+        std::atomic<quint64> words[LeafWordCount];
+        std::atomic<int> freeCount; // Hint to skip full leaves
+    };
+
+    struct Middle
+    {
+        Middle() {
+            for (std::atomic<Leaf*>& leaf : leaves)
+                leaf.store(NULL, std::memory_order_relaxed);
+        }
+        ~Middle() {
+            for (std::atomic<Leaf*>& leaf : leaves)
+                delete leaf.load(std::memory_order_relaxed);
+        }
+        std::atomic<Leaf*> leaves[NodeSize];
+    };
+
+    UniqueIdRegistration() {
+        for (std::atomic<Middle*>& middle : m_middles)
+            middle.store(NULL, std::memory_order_relaxed);
+    }
+
+    ~UniqueIdRegistration() {
+        for (std::atomic<Middle*>& middle : m_middles)
+            delete middle.load(std::memory_order_relaxed);
+    }
+
+    static quint32 toIndex(int id) {
+        return static_cast<quint32>(static_cast<qint64>(id) - INT_MIN);
+    }
+
+    static int toId(quint32 index) {
+        return static_cast<int>(static_cast<qint64>(index) + INT_MIN);
+    }
+
+    //! Returns the leaf of bits [leafId * LeafBitCount, ...), or NULL if it
+    //! does not exist and \p create is false
+    Leaf* leaf(quint32 leafId, bool create) {
+        std::atomic<Middle*>& middleRef = m_middles[leafId / NodeSize];
+        Middle* middle = middleRef.load(std::memory_order_acquire);
+        if (middle == NULL) {
+            if (!create)
+                return NULL;
+            middle = UniqueIdRegistration::install(&middleRef);
+        }
+        std::atomic<Leaf*>& leafRef = middle->leaves[leafId % NodeSize];
+        Leaf* leaf = leafRef.load(std::memory_order_acquire);
+        if (leaf == NULL && create)
+            leaf = UniqueIdRegistration::install(&leafRef);
+        return leaf;
+    }
+
+private:
+    //! Allocates the node referenced by \p ref, unless another thread did it
+    template<typename NODE>
+    static NODE* install(std::atomic<NODE*>* ref) {
+        NODE* expected = NULL;
+        NODE* node = new NODE;
+        if (ref->compare_exchange_strong(
+                    expected, node, std::memory_order_acq_rel))
+        {
+            return node;
+        }
+        delete node;
+        return expected;
+    }
+
+    std::atomic<Middle*> m_middles[NodeSize];
 };
 
+//! Mask of bits [low, high] of a 64-bit word
+static quint64 bitRangeMask(int low, int high)
+{
+    const quint64 highMask = high == 63 ? ~quint64(0) : (quint64(1) << (high + 1)) - 1;
+    return highMask & ~((quint64(1) << low) - 1);
+}
+
 } // namespace internal
 
 Q_GLOBAL_STATIC(internal::UniqueIdRegistration, uniqueIdRegistrationHelper)
@@ -55,7 +148,9 @@ Q_GLOBAL_STATIC(internal::UniqueIdRegistration, uniqueIdRegistrationHelper)
  *
  * This is a generalization of QEvent::registerEventType()
  *
- * \note This function is thread-safe.
+ * \note This function is thread-safe and lock-free. Registered ids are
+ *       searched 64 at a time and full blocks of 4096 ids are skipped, so the
+ *       cost is amortized O(1) for ranges filled from the top.
  *
  */
 UniqueId::RegisterResult UniqueId::registerId(int min, int max)
@@ -68,30 +163,69 @@ UniqueId::RegisterResult UniqueId::registerId(int min, int max)
     if (reg == NULL || min > max)
         return result;
 
-    QMutexLocker locker(&reg->m_mutex);
-    Q_UNUSED(locker);
-
-    // Find a free id, starting at \p max and decreasing
-    int id = max;
-    while (reg->m_set.contains(id) && id >= min)
-        --id;
-    if (id >= min) {
-        reg->m_set.insert(id);
-        result.isValid = true;
-        result.id = id;
-        return result;
+    typedef internal::UniqueIdRegistration Registration;
+    const quint32 lowIndex = Registration::toIndex(min);
+    quint32 index = Registration::toIndex(max);
+
+    // Find a free id, starting at \p max and decreasing. Full leaves are
+    // skipped, then 64 ids are tested at once
+    for (;;) {
+        const quint32 leafId = index / Registration::LeafBitCount;
+        const quint32 leafBegin = leafId * Registration::LeafBitCount;
+        Registration::Leaf* leaf = reg->leaf(leafId, true);
+        if (leaf->freeCount.load(std::memory_order_relaxed) > 0) {
+            const quint32 lowWordIndex = qMax(lowIndex, leafBegin) / 64;
+            for (quint32 wordIndex = index / 64; wordIndex >= lowWordIndex; --wordIndex) {
+                const int highBit = wordIndex == index / 64 ? index % 64 : 63;
+                const int lowBit = wordIndex == lowIndex / 64 ? lowIndex % 64 : 0;
+                const quint64 mask = internal::bitRangeMask(lowBit, highBit);
+                std::atomic<quint64>& word =
+                        leaf->words[wordIndex % Registration::LeafWordCount];
+                quint64 bits = word.load(std::memory_order_relaxed);
+                quint64 freeBits = ~bits & mask;
+                while (freeBits != 0) {
+                    const int bit = 63 - qCountLeadingZeroBits(freeBits);
+                    const quint64 newBits = bits | (quint64(1) << bit);
+                    if (word.compare_exchange_weak(
+                                bits, newBits, std::memory_order_acq_rel))
+                    {
+                        leaf->freeCount.fetch_sub(1, std::memory_order_relaxed);
+                        result.isValid = true;
+                        result.id = Registration::toId(wordIndex * 64 + bit);
+                        return result;
+                    }
+                    freeBits = ~bits & mask; // bits updated by CAS failure
+                }
+                if (wordIndex == 0)
+                    break;
+            }
+        }
+        if (leafBegin <= lowIndex)
+            break;
+        index = leafBegin - 1;
     }
 
     return result;
 }
 
 //! Has \p id already been registered with UniqueId::registerId() ?
+//! \note This function is lock-free
 bool UniqueId::isRegistered(int id)
 {
     internal::UniqueIdRegistration* reg = uniqueIdRegistrationHelper();
     if (reg == NULL)
         return false;
-    return reg->m_set.contains(id);
+
+    typedef internal::UniqueIdRegistration Registration;
+    const quint32 index = Registration::toIndex(id);
+    const Registration::Leaf* leaf =
+            reg->leaf(index / Registration::LeafBitCount, false);
+    if (leaf == NULL)
+        return false;
+    const quint64 bits =
+            leaf->words[(index / 64) % Registration::LeafWordCount].load(
+                std::memory_order_acquire);
+    return (bits & (quint64(1) << (index % 64))) != 0;
 }
 
 } // namespace qtcore
@@ -146,4 +146,49 @@ double AbstractLengthEditor::asImperialLength(double len, ImperialUnit unit)
     return len;
 }
 
+/*! Amount of \p unit in one millimeter
+ *
+ *  \sa asMetricLengths()
+ */
+double AbstractLengthEditor::metricUnitFactor(MetricUnit unit)
+{
+    return AbstractLengthEditor::asMetricLength(1., unit);
+}
+
+/*! Amount of \p unit in one millimeter
+ *
+ *  \sa asImperialLengths()
+ */
+double AbstractLengthEditor::imperialUnitFactor(ImperialUnit unit)
+{
+    return AbstractLengthEditor::asImperialLength(1., unit);
+}
+
+/*! Batch version of asMetricLength() : converts the \p count lengths in
+ *  millimeter of array \p lens into \p unit, results are written to \p out
+ *
+ *  Conversion is a single loop multiplying by metricUnitFactor(), which the
+ *  compiler vectorizes (results may differ from asMetricLength() by one unit
+ *  in the last place). \p out may be \p lens (in-place conversion).
+ *
+ *  cpp::QuantityArray::data() can provide the \p lens buffer.
+ */
+void AbstractLengthEditor::asMetricLengths(
+        const double* lens, std::size_t count, MetricUnit unit, double* out)
+{
+    const double factor = AbstractLengthEditor::metricUnitFactor(unit);
+    for (std::size_t i = 0; i < count; ++i)
+        out[i] = lens[i] * factor;
+}
+
+/*! Batch version of asImperialLength(), same as asMetricLengths()
+ */
+void AbstractLengthEditor::asImperialLengths(
+        const double* lens, std::size_t count, ImperialUnit unit, double* out)
+{
+    const double factor = AbstractLengthEditor::imperialUnitFactor(unit);
+    for (std::size_t i = 0; i < count; ++i)
+        out[i] = lens[i] * factor;
+}
+
 } // namespace qtgui
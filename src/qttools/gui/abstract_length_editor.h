@@ -18,6 +18,7 @@
 #include "gui.h"
 #include "abstract_quantity_editor.h"
 #include <QtCore/QVector>
+#include <cstddef>
 
 namespace qtgui {
 
@@ -60,6 +61,13 @@ public:
     static double asMetricLength(double len, MetricUnit unit);
     static double asImperialLength(double len, ImperialUnit unit);
 
+    static double metricUnitFactor(MetricUnit unit);
+    static double imperialUnitFactor(ImperialUnit unit);
+    static void asMetricLengths(
+            const double* lens, std::size_t count, MetricUnit unit, double* out);
+    static void asImperialLengths(
+            const double* lens, std::size_t count, ImperialUnit unit, double* out);
+
 private:
     MetricUnit m_prefMetricUnit;
     ImperialUnit m_prefImperialUnit;
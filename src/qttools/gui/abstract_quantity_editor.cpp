@@ -50,9 +50,14 @@ void AbstractQuantityEditor::updateEditor(QLocale::MeasurementSystem /*newSys*/)
 {
 }
 
+/*! Measurement system the editor is displayed in
+ *
+ *  This is QuantityEditorManager::measurementSytem(), unless the editor has
+ *  not been updated yet to the current system (see QuantityEditorManager)
+ */
 QLocale::MeasurementSystem AbstractQuantityEditor::measurementSystem() const
 {
-    return QuantityEditorManager::globalInstance()->measurementSytem();
+    return QuantityEditorManager::globalInstance()->editorMeasurementSystem(this);
 }
 
 } // namespace qtgui
@@ -31,7 +31,8 @@ public:
     Private(CodeEditor* backPtr);
 
     void lineNumberAreaPaintEvent(QPaintEvent *event);
-    int lineNumberAreaWidth();
+    int lineNumberAreaWidth() const;
+    void updateFontMetrics();
 
     void updateLineNumberAreaWidth(int newBlockCount);
     void highlightCurrentLine();
@@ -39,6 +40,9 @@ public:
 
     CodeEditor* m_backPtr;
     QWidget* m_lineNumberArea;
+    int m_digitWidth;
+    int m_lineHeight;
+    int m_digitCount;
 };
 
 /*! \class CodeEditor::LineNumberArea
@@ -77,26 +81,32 @@ void CodeEditor::LineNumberArea::paintEvent(QPaintEvent *event)
 
 CodeEditor::Private::Private(CodeEditor* backPtr)
     : m_backPtr(backPtr),
-      m_lineNumberArea(new CodeEditor::LineNumberArea(this))
+      m_lineNumberArea(new CodeEditor::LineNumberArea(this)),
+      m_digitWidth(0),
+      m_lineHeight(0),
+      m_digitCount(0)
 {
+    this->updateFontMetrics();
 }
 
-int CodeEditor::Private::lineNumberAreaWidth()
+int CodeEditor::Private::lineNumberAreaWidth() const
 {
-    int digits = 1;
-    int max = std::max(1, m_backPtr->blockCount());
-    while (max >= 10) {
-        max /= 10;
-        ++digits;
-    }
+    return 3 + m_digitWidth * std::max(1, m_digitCount);
+}
 
-    return 3 + m_backPtr->fontMetrics().width(QLatin1Char('9')) * digits;
+//! Caches the font measures used by the line number area
+void CodeEditor::Private::updateFontMetrics()
+{
+    const QFontMetrics fm = m_backPtr->fontMetrics();
+    m_digitWidth = fm.width(QLatin1Char('9'));
+    m_lineHeight = fm.height();
 }
 
 void CodeEditor::Private::lineNumberAreaPaintEvent(QPaintEvent *event)
 {
     QPainter painter(m_lineNumberArea);
     painter.fillRect(event->rect(), Qt::lightGray);
+    painter.setPen(Qt::black);
 
     QTextBlock block = m_backPtr->firstVisibleBlock();
     int blockNumber = block.blockNumber();
@@ -105,8 +115,7 @@ void CodeEditor::Private::lineNumberAreaPaintEvent(QPaintEvent *event)
 
     while (block.isValid() && top <= event->rect().bottom()) {
         if (block.isVisible() && bottom >= event->rect().top()) {
-            painter.setPen(Qt::black);
-            painter.drawText(0, top, m_lineNumberArea->width(), m_backPtr->fontMetrics().height(),
+            painter.drawText(0, top, m_lineNumberArea->width(), m_lineHeight,
                              Qt::AlignRight, QString::number(blockNumber + 1));
         }
 
@@ -117,10 +126,25 @@ void CodeEditor::Private::lineNumberAreaPaintEvent(QPaintEvent *event)
     }
 }
 
+/*! Updates viewport margins only when the count of digits of \p newBlockCount
+ *  changes, so adding lines does not relayout the editor every time
+ */
 void CodeEditor::Private::updateLineNumberAreaWidth(int newBlockCount)
 {
-    Q_UNUSED(newBlockCount);
-    m_backPtr->setViewportMargins(this->lineNumberAreaWidth(), 0, 0, 0);
+    int digits = 1;
+    int max = std::max(1, newBlockCount);
+    while (max >= 10) {
+        max /= 10;
+        ++digits;
+    }
+
+    if (digits != m_digitCount) {
+        m_digitCount = digits;
+        m_backPtr->setViewportMargins(this->lineNumberAreaWidth(), 0, 0, 0);
+        const QRect cr = m_backPtr->contentsRect();
+        m_lineNumberArea->setGeometry(
+                    QRect(cr.left(), cr.top(), this->lineNumberAreaWidth(), cr.height()));
+    }
 }
 
 void CodeEditor::Private::highlightCurrentLine()
@@ -150,12 +174,16 @@ void CodeEditor::Private::updateLineNumberArea(const QRect &rect, int dy)
         m_lineNumberArea->update(0, rect.y(), m_lineNumberArea->width(), rect.height());
 
     if (rect.contains(m_backPtr->viewport()->rect()))
-        this->updateLineNumberAreaWidth(0);
+        this->updateLineNumberAreaWidth(m_backPtr->blockCount());
 }
 
 /*! \class CodeEditor
  *  \brief Provides a text editor with a line numbering bar
  *
+ * Only the dirty part of the line numbering bar is painted, starting from the
+ * first visible block, and its width is recomputed only when the count of
+ * digits of the line count changes.
+ *
  * \headerfile code_editor.h <qttools/gui/code_editor.h>
  * \ingroup qttools_gui
  *
@@ -174,7 +202,7 @@ CodeEditor::CodeEditor(QWidget *parent)
     QObject::connect(this, &CodeEditor::cursorPositionChanged,
                      [=] { d->highlightCurrentLine(); } );
 
-    d->updateLineNumberAreaWidth(0);
+    d->updateLineNumberAreaWidth(this->blockCount());
     d->highlightCurrentLine();
 }
 
@@ -192,4 +220,15 @@ void CodeEditor::resizeEvent(QResizeEvent *e)
                                            d->lineNumberAreaWidth(), cr.height()));
 }
 
+void CodeEditor::changeEvent(QEvent *e)
+{
+    QPlainTextEdit::changeEvent(e);
+
+    if (e->type() == QEvent::FontChange) {
+        d->updateFontMetrics();
+        d->m_digitCount = 0; // Force geometry update
+        d->updateLineNumberAreaWidth(this->blockCount());
+    }
+}
+
 } // namespace qtgui
@@ -21,6 +21,7 @@
 #include <QPlainTextEdit>
 
 QT_BEGIN_NAMESPACE
+class QEvent;
 class QResizeEvent;
 QT_END_NAMESPACE
 
@@ -36,6 +37,7 @@ public:
 
 protected:
     void resizeEvent(QResizeEvent *event) Q_DECL_OVERRIDE;
+    void changeEvent(QEvent *event) Q_DECL_OVERRIDE;
 
 private:
     class LineNumberArea;
@@ -15,14 +15,44 @@
 
 #include "indexed_selection_model.h"
 
+#include <QtCore/QtAlgorithms>
+
+#include <algorithm>
+#include <cstring>
+
 namespace qtgui {
 
+namespace internal {
+
+//! Mask of bits [low, high] of a 64-bit word
+static quint64 bitRangeMask(int low, int high)
+{
+    const quint64 highMask = high == 63 ? ~quint64(0) : (quint64(1) << (high + 1)) - 1;
+    return highMask & ~((quint64(1) << low) - 1);
+}
+
+//! Index of the chunk containing item \p id, rounded towards -infinity
+static int chunkKey(int id, int chunkSize)
+{
+    const qint64 id64 = id;
+    return static_cast<int>(id64 >= 0 ? id64 / chunkSize : -((-id64 + chunkSize - 1) / chunkSize));
+}
+
+} // namespace internal
+
 /*!
  * \class IndexedSelectionModel
  * \brief Helper that keeps track of selected items in any kind of view (not specific to Qt)
  *
  * View items are each referenced by an index that the caller must provide.
  *
+ * The selection is stored as bitsets of 4096 consecutive indexes, only the
+ * chunks having selected items are allocated. So dense selections of millions
+ * of items stay compact, while sparse indexes (even negative ones, if
+ * isValidIndex() accepts them) cost one chunk each.
+ * Range operations (toggleItems(), setItemsSelected()) and clear() update
+ * the bitsets word by word and emit a single signal for the whole batch.
+ *
  * \headerfile indexed_selection_model.h <qttools/gui/indexed_selection_model.h>
  * \ingroup qttools_gui
  *
@@ -30,24 +60,74 @@ namespace qtgui {
 
 IndexedSelectionModel::IndexedSelectionModel(QObject* parent)
     : QObject(parent),
+      m_selectedCount(0),
       m_hadSelection(false)
 {
     QObject::connect(this, &IndexedSelectionModel::selectionCleared,
                      this, &IndexedSelectionModel::selectionChanged);
     QObject::connect(this, &IndexedSelectionModel::itemToggled,
                      this, &IndexedSelectionModel::selectionChanged);
+    QObject::connect(this, &IndexedSelectionModel::itemsChanged,
+                     this, &IndexedSelectionModel::selectionChanged);
 }
 
-//! Indexes of the items being selected in the view
-const QSet<int>& IndexedSelectionModel::selectedItems() const
+/*! Indexes of the items being selected in the view
+ *
+ *  The set is built on each call, prefer isSelected() or
+ *  selectedItemVector() for large selections
+ */
+QSet<int> IndexedSelectionModel::selectedItems() const
+{
+    QSet<int> items;
+    items.reserve(m_selectedCount);
+    foreach (int id, this->selectedItemVector())
+        items.insert(id);
+    return items;
+}
+
+//! Indexes of the items being selected in the view, by ascending order
+QVector<int> IndexedSelectionModel::selectedItemVector() const
+{
+    QVector<int> items;
+    items.reserve(m_selectedCount);
+    QList<int> chunkKeys = m_chunks.keys();
+    std::sort(chunkKeys.begin(), chunkKeys.end());
+    foreach (int key, chunkKeys) {
+        const Chunk& chunk = *m_chunks.constFind(key);
+        const qint64 chunkFirstId = qint64(key) * Chunk::ItemCount;
+        for (int i = 0; i < Chunk::WordCount; ++i) {
+            quint64 bits = chunk.words[i];
+            while (bits != 0) {
+                const int bit = qCountTrailingZeroBits(bits);
+                items.append(static_cast<int>(chunkFirstId + i * 64 + bit));
+                bits &= bits - 1;
+            }
+        }
+    }
+    return items;
+}
+
+//! Is the item of index \p id selected ?
+bool IndexedSelectionModel::isSelected(int id) const
+{
+    const int key = internal::chunkKey(id, Chunk::ItemCount);
+    const QHash<int, Chunk>::const_iterator itChunk = m_chunks.constFind(key);
+    if (itChunk == m_chunks.constEnd())
+        return false;
+    const int bit = static_cast<int>(qint64(id) - qint64(key) * Chunk::ItemCount);
+    return (itChunk->words[bit / 64] & (quint64(1) << (bit % 64))) != 0;
+}
+
+//! Count of selected items, in O(1)
+int IndexedSelectionModel::selectedCount() const
 {
-    return m_selectedItems;
+    return m_selectedCount;
 }
 
 //! Is the selection not empty ?
 bool IndexedSelectionModel::hasSelection() const
 {
-    return !this->selectedItems().isEmpty();
+    return m_selectedCount > 0;
 }
 
 /*! Is index \p id valid ?
@@ -62,6 +142,7 @@ bool IndexedSelectionModel::isValidIndex(int id) const
 /*! \brief Untoggle all selected items, this will emit selectionCleared() at the end
  *
  *  Signal selectionCleared() is emitted only if hasSelection() returned \c true.
+ *  Signal itemToggled() is not emitted for each deselected item.
  */
 void IndexedSelectionModel::clear()
 {
@@ -75,12 +156,37 @@ void IndexedSelectionModel::toggleItem(int id)
 {
     if (!this->isValidIndex(id))
         return;
-    const bool isItemSelected = this->selectedItems().contains(id);
-    if (isItemSelected)
-        m_selectedItems.remove(id);
-    else
-        m_selectedItems.insert(id);
-    emit itemToggled(id, !isItemSelected);
+    this->applyToRange(id, id, ToggleRange);
+    emit itemToggled(id, this->isSelected(id));
+}
+
+/*! \brief Toggles the selection state of items of index [\p firstId, \p lastId]
+ *
+ *  Signal itemsChanged() is emitted once for the whole range. Only the bounds
+ *  are checked with isValidIndex().
+ */
+void IndexedSelectionModel::toggleItems(int firstId, int lastId)
+{
+    if (!this->isValidIndex(firstId) || !this->isValidIndex(lastId) || lastId < firstId)
+        return;
+    this->applyToRange(firstId, lastId, ToggleRange);
+    emit itemsChanged(firstId, lastId);
+}
+
+/*! \brief Selects (or deselects if \p on is false) items of index
+ *         [\p firstId, \p lastId]
+ *
+ *  Signal itemsChanged() is emitted once for the whole range, only if the
+ *  selection changed
+ */
+void IndexedSelectionModel::setItemsSelected(int firstId, int lastId, bool on)
+{
+    if (!this->isValidIndex(firstId) || !this->isValidIndex(lastId) || lastId < firstId)
+        return;
+    const int oldSelectedCount = m_selectedCount;
+    this->applyToRange(firstId, lastId, on ? SelectRange : DeselectRange);
+    if (m_selectedCount != oldSelectedCount)
+        emit itemsChanged(firstId, lastId);
 }
 
 void IndexedSelectionModel::beginClear()
@@ -90,12 +196,8 @@ void IndexedSelectionModel::beginClear()
 
 void IndexedSelectionModel::clearItems()
 {
-    // Untoggle selected items
-    foreach (int id, this->selectedItems()) {
-        m_selectedItems.remove(id);
-        emit itemToggled(id, false);
-    }
-    Q_ASSERT(this->selectedItems().count() == 0);
+    m_chunks.clear();
+    m_selectedCount = 0;
 }
 
 void IndexedSelectionModel::endClear()
@@ -104,4 +206,65 @@ void IndexedSelectionModel::endClear()
         emit selectionCleared();
 }
 
+void IndexedSelectionModel::applyToRange(int firstId, int lastId, RangeOperation op)
+{
+    const int firstKey = internal::chunkKey(firstId, Chunk::ItemCount);
+    const int lastKey = internal::chunkKey(lastId, Chunk::ItemCount);
+    auto fnApply = [=] (int key) {
+        const qint64 chunkFirstId = qint64(key) * Chunk::ItemCount;
+        const int firstBit = key == firstKey ? static_cast<int>(firstId - chunkFirstId) : 0;
+        const int lastBit =
+                key == lastKey ? static_cast<int>(lastId - chunkFirstId) : Chunk::ItemCount - 1;
+        this->applyToChunk(key, firstBit, lastBit, op);
+    };
+
+    // Deselecting a range wider than the selection visits the allocated
+    // chunks only
+    const qint64 rangeChunkCount = qint64(lastKey) - firstKey + 1;
+    if (op == DeselectRange && rangeChunkCount > m_chunks.size()) {
+        foreach (int key, m_chunks.keys()) {
+            if (firstKey <= key && key <= lastKey)
+                fnApply(key);
+        }
+    }
+    else {
+        for (qint64 key = firstKey; key <= lastKey; ++key)
+            fnApply(static_cast<int>(key));
+    }
+}
+
+//! Applies \p op to bits [\p firstBit, \p lastBit] of the chunk of key \p chunkKey
+void IndexedSelectionModel::applyToChunk(
+        int chunkKey, int firstBit, int lastBit, RangeOperation op)
+{
+    QHash<int, Chunk>::iterator itChunk = m_chunks.find(chunkKey);
+    if (itChunk == m_chunks.end()) {
+        if (op == DeselectRange)
+            return; // Items of missing chunks are not selected
+        Chunk chunk;
+        std::memset(chunk.words, 0, sizeof(chunk.words));
+        chunk.count = 0;
+        itChunk = m_chunks.insert(chunkKey, chunk);
+    }
+
+    Chunk& chunk = itChunk.value();
+    for (int wordId = firstBit / 64; wordId <= lastBit / 64; ++wordId) {
+        const int lowBit = wordId == firstBit / 64 ? firstBit % 64 : 0;
+        const int highBit = wordId == lastBit / 64 ? lastBit % 64 : 63;
+        const quint64 mask = internal::bitRangeMask(lowBit, highBit);
+        quint64& bits = chunk.words[wordId];
+        const int oldCount = qPopulationCount(bits);
+        switch (op) {
+        case ToggleRange: bits ^= mask; break;
+        case SelectRange: bits |= mask; break;
+        case DeselectRange: bits &= ~mask; break;
+        }
+        const int diffCount = qPopulationCount(bits) - oldCount;
+        chunk.count += diffCount;
+        m_selectedCount += diffCount;
+    }
+    if (chunk.count == 0)
+        m_chunks.erase(itChunk);
+}
+
 } // namespace qtgui
@@ -16,8 +16,10 @@
 #pragma once
 
 #include "gui.h"
+#include <QtCore/QHash>
 #include <QtCore/QObject>
 #include <QtCore/QSet>
+#include <QtCore/QVector>
 
 namespace qtgui {
 
@@ -28,7 +30,10 @@ class QTTOOLS_GUI_EXPORT IndexedSelectionModel : public QObject
 public:
     IndexedSelectionModel(QObject* parent = NULL);
 
-    const QSet<int>& selectedItems() const;
+    QSet<int> selectedItems() const;
+    QVector<int> selectedItemVector() const;
+    bool isSelected(int id) const;
+    int selectedCount() const;
 
     virtual bool hasSelection() const;
     virtual bool isValidIndex(int id) const;
@@ -36,10 +41,13 @@ public:
 public slots:
     virtual void clear();
     void toggleItem(int id);
+    void toggleItems(int firstId, int lastId);
+    void setItemsSelected(int firstId, int lastId, bool on);
 
 signals:
     void selectionCleared();
     void itemToggled(int id, bool on);
+    void itemsChanged(int firstId, int lastId);
     void selectionChanged();
 
 protected:
@@ -48,7 +56,20 @@ protected:
     void endClear();
 
 private:
-    QSet<int> m_selectedItems;
+    enum RangeOperation { ToggleRange, SelectRange, DeselectRange };
+    void applyToRange(int firstId, int lastId, RangeOperation op);
+    void applyToChunk(int chunkKey, int firstBit, int lastBit, RangeOperation op);
+
+    //! Bitset of 4096 consecutive item indexes, stored only if not empty
+    struct Chunk
+    {
+        enum { WordCount = 64, ItemCount = WordCount * 64 };
+        quint64 words[WordCount];
+        int count;
+    };
+
+    QHash<int, Chunk> m_chunks; // Key is floor(id / Chunk::ItemCount)
+    int m_selectedCount;
     bool m_hadSelection;
 };
 
@@ -17,6 +17,8 @@
 
 #include "proxy_styled_item_delegate.h"
 
+#include <QtCore/QAbstractItemModel>
+#include <QtCore/QPointer>
 #include <QtCore/QtDebug>
 #include <QtGui/QPainter>
 #include <QtGui/QMouseEvent>
@@ -64,6 +66,11 @@ public:
         int displayColumn;
         ItemViewButtons::ItemSide itemSide;
         ItemViewButtons::DisplayModes itemDisplayModes;
+
+        // Pixmaps rendered from icon, valid while cachedPixSize is unchanged
+        QSize cachedPixSize;
+        QPixmap cachedPixNormal;
+        QPixmap cachedPixActive;
     };
 
     Private(ItemViewButtons* backPtr);
@@ -71,7 +78,10 @@ public:
     const ButtonInfo* buttonInfo(int btnId) const;
     ButtonInfo* mutableButtonInfo(int btnId);
     void setAllIsOverButtonState(bool on);
-    QModelIndex modelIndexForButtonDisplay(const QModelIndex& index) const;
+    int cachedButtonAtModelIndex(const QModelIndex& index);
+    void clearButtonCache();
+    void syncWithViewModel();
+    QModelIndex modelIndexForButtonDisplay(const QModelIndex& index);
     void itemViewUpdateAt(const QModelIndex& index);
     void paintButton(
             ButtonInfo *btnInfo,
@@ -83,6 +93,8 @@ public:
     QHash<int, ButtonInfo> m_btnInfos;
     QModelIndex m_prevModelIndexUnderMouse;
     const ButtonInfo* m_buttonUnderMouse;
+    QPointer<QAbstractItemModel> m_model;
+    QHash<QModelIndex, int> m_btnIdCache;
 
 private:
     ItemViewButtons* m_backPtr;
@@ -132,10 +144,58 @@ ItemViewButtons::Private::mutableButtonInfo(int btnId)
     return NULL;
 }
 
+/*! Same as ItemViewButtons::buttonAtModelIndex() but the result is cached per
+ *  model index
+ *
+ *  The cache is cleared whenever the model of the view emits a change signal,
+ *  is replaced by another model, or button detection settings are modified
+ */
+int ItemViewButtons::Private::cachedButtonAtModelIndex(const QModelIndex &index)
+{
+    this->syncWithViewModel();
+    const auto iCached = m_btnIdCache.constFind(index);
+    if (iCached != m_btnIdCache.constEnd())
+        return iCached.value();
+    const int btnId = m_backPtr->buttonAtModelIndex(index);
+    m_btnIdCache.insert(index, btnId);
+    return btnId;
+}
+
+void ItemViewButtons::Private::clearButtonCache()
+{
+    m_btnIdCache.clear();
+}
+
+void ItemViewButtons::Private::syncWithViewModel()
+{
+    QAbstractItemModel* viewModel = m_view != NULL ? m_view->model() : NULL;
+    if (m_model == viewModel)
+        return;
+
+    if (m_model != NULL)
+        QObject::disconnect(m_model, NULL, m_backPtr, NULL);
+    this->clearButtonCache();
+    m_model = viewModel;
+    if (viewModel == NULL)
+        return;
+
+    typedef QAbstractItemModel Model;
+    auto fnClearCache = [=] { this->clearButtonCache(); };
+    QObject::connect(viewModel, &Model::dataChanged, m_backPtr, fnClearCache);
+    QObject::connect(viewModel, &Model::rowsInserted, m_backPtr, fnClearCache);
+    QObject::connect(viewModel, &Model::rowsRemoved, m_backPtr, fnClearCache);
+    QObject::connect(viewModel, &Model::rowsMoved, m_backPtr, fnClearCache);
+    QObject::connect(viewModel, &Model::columnsInserted, m_backPtr, fnClearCache);
+    QObject::connect(viewModel, &Model::columnsRemoved, m_backPtr, fnClearCache);
+    QObject::connect(viewModel, &Model::columnsMoved, m_backPtr, fnClearCache);
+    QObject::connect(viewModel, &Model::layoutChanged, m_backPtr, fnClearCache);
+    QObject::connect(viewModel, &Model::modelReset, m_backPtr, fnClearCache);
+}
+
 QModelIndex ItemViewButtons::Private::modelIndexForButtonDisplay(
-        const QModelIndex &index) const
+        const QModelIndex &index)
 {
-    const int btnIndex = m_backPtr->buttonAtModelIndex(index);
+    const int btnIndex = this->cachedButtonAtModelIndex(index);
     const auto btnInfo = this->buttonInfo(btnIndex);
     if (btnInfo != NULL && btnInfo->displayColumn != -1)
         return index.sibling(index.row(), btnInfo->displayColumn);
@@ -179,13 +239,17 @@ void ItemViewButtons::Private::paintButton(
 
     const bool isInsideButtonRegion =
             pixRect.contains(m_view->viewport()->mapFromGlobal(QCursor::pos()));
-    const QIcon icon = btnInfo->icon;
-    const QPixmap pix =
-            icon.pixmap(
-                pixWidth,
-                pixHeight,
-                isInsideButtonRegion ? QIcon::Active : QIcon::Normal);
-    painter->drawPixmap(pixRect, pix);
+    const QSize pixSize(pixWidth, pixHeight);
+    if (btnInfo->cachedPixSize != pixSize) {
+        btnInfo->cachedPixNormal = btnInfo->icon.pixmap(pixSize, QIcon::Normal);
+        btnInfo->cachedPixActive = btnInfo->icon.pixmap(pixSize, QIcon::Active);
+        btnInfo->cachedPixSize = pixSize;
+    }
+    painter->drawPixmap(
+                pixRect,
+                isInsideButtonRegion ?
+                    btnInfo->cachedPixActive :
+                    btnInfo->cachedPixNormal);
 
     if (isInsideButtonRegion)
         m_buttonUnderMouse = btnInfo;
@@ -227,6 +291,10 @@ void ItemViewButtons::Private::resetButtonUnderMouseState()
  *
  * ItemViewButtons notifies any button click with signal buttonClicked()
  *
+ * The button detected for a model index (see buttonAtModelIndex()) is cached
+ * until the model emits a change signal, so hovering and painting do not query
+ * item data again. Icon pixmaps are also rendered once per size and state.
+ *
  * \example qttools/item_view_buttons/main.cpp
  *
  * \headerfile item_view_buttons.h <qttools/gui/item_view_buttons.h>
@@ -268,6 +336,7 @@ void ItemViewButtons::reset()
 {
     d->m_prevModelIndexUnderMouse = QModelIndex();
     d->resetButtonUnderMouseState();
+    d->clearButtonCache();
 }
 
 bool ItemViewButtons::eventFilter(QObject *object, QEvent *event)
@@ -351,7 +420,7 @@ void ItemViewButtons::paint(
         QStyleOptionViewItemV4 optionForBtn(option);
         optionForBtn.rect =
                 this->itemView()->visualRect(d->modelIndexForButtonDisplay(index));
-        const int btnIndex = this->buttonAtModelIndex(index);
+        const int btnIndex = d->cachedButtonAtModelIndex(index);
         Private::ButtonInfo* btnInfo = d->mutableButtonInfo(btnIndex);
         if (btnInfo == NULL)
             return;
@@ -403,6 +472,7 @@ void ItemViewButtons::addButton(
         info.itemSide = ItemRightSide;
         info.itemDisplayModes = DisplayOnDetection;
         d->m_btnInfos.insert(btnId, info);
+        d->clearButtonCache();
     }
     else {
         qWarning() << QString("%1 : there is already a button of index '%2'")
@@ -427,6 +497,7 @@ void ItemViewButtons::copyButtonProperties(int srcBtnId, int dstBtnId)
         if (dstBtnInfo != NULL) {
             *dstBtnInfo = *srcBtnInfo;
             dstBtnInfo->index = dstBtnId; // Restore destination button index
+            d->clearButtonCache();
         }
         else {
             qWarning() << QString("%1 : no destination button of index '%1'")
@@ -490,6 +561,7 @@ void ItemViewButtons::setButtonDetection(
     if (btnInfo != NULL) {
         btnInfo->matchRole = matchRole;
         btnInfo->matchData = matchData;
+        d->clearButtonCache();
     }
 }
 
@@ -563,10 +635,11 @@ QIcon ItemViewButtons::buttonIcon(int btnId) const
 
 void ItemViewButtons::setButtonIcon(int btnId, const QIcon &icon)
 {
-    cpp::checkedAssign(
-                &Private::ButtonInfo::icon,
-                d->mutableButtonInfo(btnId),
-                icon);
+    Private::ButtonInfo* btnInfo = d->mutableButtonInfo(btnId);
+    if (btnInfo != NULL) {
+        btnInfo->icon = icon;
+        btnInfo->cachedPixSize = QSize(); // Invalidate cached pixmaps
+    }
 }
 
 /*!
@@ -629,10 +702,20 @@ QStyledItemDelegate* ItemViewButtons::createProxyItemDelegate(
     return new Private::ProxyItemDelegate(this, sourceDelegate, parent);
 }
 
+/*! Returns the identifier of the button to be displayed for item \p index, or
+ *  -1 if there is none
+ *
+ *  Results are cached by ItemViewButtons, so a reimplementation must only
+ *  depend on the model data and on the button detection settings
+ */
 int ItemViewButtons::buttonAtModelIndex(const QModelIndex &index) const
 {
-    foreach (int id, d->m_btnInfos.keys()) {
-        const Private::ButtonInfo* btnInfo = d->buttonInfo(id);
+    for (auto it = d->m_btnInfos.constBegin();
+         it != d->m_btnInfos.constEnd();
+         ++it)
+    {
+        const int id = it.key();
+        const Private::ButtonInfo* btnInfo = &it.value();
         if (btnInfo->matchRole < 0)
             return id;
         const QVariant modelItemData = index.data(btnInfo->matchRole);
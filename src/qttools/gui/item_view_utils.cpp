@@ -22,6 +22,9 @@
 // QtWidgets
 #include <QAbstractItemView>
 
+#include <algorithm>
+#include <vector>
+
 namespace qtgui {
 
 /*! \class ItemViewUtils
@@ -32,6 +35,10 @@ namespace qtgui {
  */
 
 /*! \brief Indexes, in the given column, of the rows selected in a view
+ *
+ *  Rows are computed from the ranges of QItemSelectionModel::selection(),
+ *  selected indexes are not expanded
+ *
  *  \param view View in which to find selected rows
  *  \param col Column index. If \p col == \c -1 then \p col is ignored
  */
@@ -40,30 +47,54 @@ QVector<int> ItemViewUtils::selectedRows(const QAbstractItemView* view, int col)
     const QItemSelectionModel* itemSelModel = view->selectionModel();
     if (itemSelModel == NULL || !itemSelModel->hasSelection())
         return QVector<int>();
-    const QModelIndexList selIndexes = itemSelModel->selectedIndexes();
+    const QItemSelection selection = itemSelModel->selection();
     QVector<int> result;
-    result.reserve(selIndexes.size());
-    QSet<int> alreadyAddedRows;
-    foreach (const QModelIndex& modId, selIndexes) {
-        if (!alreadyAddedRows.contains(modId.row()) && (col == -1 || modId.column() == col)) {
-            result.append(modId.row());
-            alreadyAddedRows.insert(modId.row());
+    std::vector<bool> isRowAdded; // Ranges may share rows (ex: other columns)
+    foreach (const QItemSelectionRange& range, selection) {
+        if (col != -1 && (col < range.left() || range.right() < col))
+            continue;
+        if (static_cast<int>(isRowAdded.size()) <= range.bottom())
+            isRowAdded.resize(range.bottom() + 1, false);
+        for (int row = range.top(); row <= range.bottom(); ++row) {
+            if (!isRowAdded[row]) {
+                result.append(row);
+                isRowAdded[row] = true;
+            }
         }
     }
     return result;
 }
 
+/*! \brief Toggles the selection of \p rows in a view
+ *
+ *  The rows are merged into contiguous ranges, and the resulting
+ *  QItemSelection is applied with a single QItemSelectionModel::select(), so
+ *  the selection model emits one selectionChanged() signal
+ */
 void ItemViewUtils::selectRows(QAbstractItemView* view, const QVector<int>& rows)
 {
     const QAbstractItemModel* model = view->model();
     QItemSelectionModel* selModel = view->selectionModel();
-    if (model == NULL || selModel == NULL)
+    if (model == NULL || selModel == NULL || rows.isEmpty())
         return;
-    const QItemSelectionModel::SelectionFlags selFlags =
-            QItemSelectionModel::ToggleCurrent | QItemSelectionModel::Rows;
-    //        QItemSelectionModel::Select | QItemSelectionModel::Rows;
-    foreach (int iRow, rows)
-        selModel->select(model->index(iRow, 0), selFlags);
+
+    QVector<int> sortedRows = rows;
+    std::sort(sortedRows.begin(), sortedRows.end());
+    sortedRows.erase(std::unique(sortedRows.begin(), sortedRows.end()), sortedRows.end());
+    QItemSelection selection;
+    int i = 0;
+    while (i < sortedRows.size()) {
+        const int rangeFirst = sortedRows.at(i);
+        int rangeLast = rangeFirst;
+        while (i + 1 < sortedRows.size() && sortedRows.at(i + 1) == rangeLast + 1) {
+            ++rangeLast;
+            ++i;
+        }
+        selection.append(QItemSelectionRange(model->index(rangeFirst, 0),
+                                             model->index(rangeLast, 0)));
+        ++i;
+    }
+    selModel->select(selection, QItemSelectionModel::ToggleCurrent | QItemSelectionModel::Rows);
 }
 
 /*! \brief Same as QSortFilterProxyModel::mapFromSource() but more concise
@@ -82,4 +113,59 @@ int ItemViewUtils::mapRowToSourceModel(
     return proxyModel->mapToSource(proxyModel->index(proxyRow, 0)).row();
 }
 
+/*! \brief Maps all \p srcRows with mapRowFromSourceModel(), in one pass
+ *
+ *  A source -> proxy lookup table is built once by mapping each proxy row to
+ *  the source, then each source row is a table lookup. This is much faster
+ *  than mapping rows one by one when \p srcRows is large (ex: selection sync).
+ *
+ *  \returns The proxy rows, in the order of \p srcRows. Source rows that are
+ *            filtered out (or out of range) are mapped to \c -1
+ */
+QVector<int> ItemViewUtils::mapRowsFromSourceModel(
+        const QSortFilterProxyModel* proxyModel, const QVector<int>& srcRows)
+{
+    // For a few rows, the lookup table costs more than direct mapping
+    const int minRowCountForTable = 16;
+    QVector<int> proxyRows(srcRows.size(), -1);
+    if (srcRows.size() < minRowCountForTable) {
+        for (int i = 0; i < srcRows.size(); ++i)
+            proxyRows[i] = ItemViewUtils::mapRowFromSourceModel(proxyModel, srcRows.at(i));
+        return proxyRows;
+    }
+
+    const int srcRowCount = proxyModel->sourceModel()->rowCount();
+    const int proxyRowCount = proxyModel->rowCount();
+    std::vector<int> proxyRowFromSrcRow(srcRowCount, -1);
+    for (int proxyRow = 0; proxyRow < proxyRowCount; ++proxyRow) {
+        const int srcRow = ItemViewUtils::mapRowToSourceModel(proxyModel, proxyRow);
+        if (0 <= srcRow && srcRow < srcRowCount)
+            proxyRowFromSrcRow[srcRow] = proxyRow;
+    }
+
+    for (int i = 0; i < srcRows.size(); ++i) {
+        const int srcRow = srcRows.at(i);
+        if (0 <= srcRow && srcRow < srcRowCount)
+            proxyRows[i] = proxyRowFromSrcRow[srcRow];
+    }
+    return proxyRows;
+}
+
+/*! \brief Maps all \p proxyRows with mapRowToSourceModel()
+ *
+ *  QSortFilterProxyModel keeps a proxy -> source mapping, so no lookup table
+ *  is needed in this direction : the result is built in a single allocation.
+ *
+ *  \returns The source rows, in the order of \p proxyRows. Out of range
+ *            proxy rows are mapped to \c -1
+ */
+QVector<int> ItemViewUtils::mapRowsToSourceModel(
+        const QSortFilterProxyModel* proxyModel, const QVector<int>& proxyRows)
+{
+    QVector<int> srcRows(proxyRows.size(), -1);
+    for (int i = 0; i < proxyRows.size(); ++i)
+        srcRows[i] = ItemViewUtils::mapRowToSourceModel(proxyModel, proxyRows.at(i));
+    return srcRows;
+}
+
 } // namespace qtgui
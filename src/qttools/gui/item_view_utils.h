@@ -32,6 +32,11 @@ public:
             const QSortFilterProxyModel* proxyModel, int srcRow);
     static int mapRowToSourceModel(
             const QSortFilterProxyModel* proxyModel, int proxyRow);
+
+    static QVector<int> mapRowsFromSourceModel(
+            const QSortFilterProxyModel* proxyModel, const QVector<int>& srcRows);
+    static QVector<int> mapRowsToSourceModel(
+            const QSortFilterProxyModel* proxyModel, const QVector<int>& proxyRows);
 };
 
 } // namespace qtgui
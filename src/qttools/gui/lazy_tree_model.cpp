@@ -0,0 +1,438 @@
+/****************************************************************************
+**  FougTools
+**  Copyright Fougue (30 Mar. 2015)
+**  contact@fougue.pro
+**
+** This software is a computer program whose purpose is to provide utility
+** tools for the C++ language and the Qt toolkit.
+**
+** This software is governed by the CeCILL-C license under French law and
+** abiding by the rules of distribution of free software.  You can  use,
+** modify and/ or redistribute the software under the terms of the CeCILL-C
+** license as circulated by CEA, CNRS and INRIA at the following URL
+** "http://www.cecill.info".
+****************************************************************************/
+
+#include "lazy_tree_model.h"
+
+#include <QtCore/QRegExp>
+
+#include <algorithm>
+#include <vector>
+
+namespace qtgui {
+
+namespace internal {
+
+//! Node of the source tree loaded in a LazyTreeModel
+struct LazyTreeNode
+{
+    LazyTreeNode(LazyTreeModel::NodeId id, int parentPos, int row)
+        : id(id), parentPos(parentPos), row(row), childCount(-1)
+    { }
+
+    LazyTreeModel::NodeId id;
+    int parentPos; // Position of the parent node in LazyTreeModel::Private::m_nodes
+    int row;
+    int childCount; // Count of children in the source, -1 if not queried yet
+    std::vector<int> children; // Positions of the loaded children
+};
+
+//! Matching of item values, with the same semantics as QAbstractItemModel::match()
+class LazyTreeMatcher
+{
+public:
+    LazyTreeMatcher(const QVariant& value, Qt::MatchFlags flags)
+        : m_value(value),
+          m_text(value.toString()),
+          m_matchType(flags & 0x0F),
+          m_cs(flags.testFlag(Qt::MatchCaseSensitive) ?
+                   Qt::CaseSensitive : Qt::CaseInsensitive)
+    {
+        if (m_matchType == Qt::MatchRegExp)
+            m_rx = QRegExp(m_text, m_cs);
+        else if (m_matchType == Qt::MatchWildcard)
+            m_rx = QRegExp(m_text, m_cs, QRegExp::Wildcard);
+    }
+
+    bool matches(const QVariant& itemValue)
+    {
+        if (m_matchType == Qt::MatchExactly)
+            return itemValue == m_value;
+
+        const QString key = itemValue.toString();
+        switch (m_matchType) {
+        case Qt::MatchRegExp:
+        case Qt::MatchWildcard:
+            return m_rx.exactMatch(key);
+        case Qt::MatchStartsWith:
+            return key.startsWith(m_text, m_cs);
+        case Qt::MatchEndsWith:
+            return key.endsWith(m_text, m_cs);
+        case Qt::MatchFixedString:
+            return key.compare(m_text, m_cs) == 0;
+        case Qt::MatchContains:
+        default:
+            return key.contains(m_text, m_cs);
+        }
+    }
+
+private:
+    const QVariant m_value;
+    const QString m_text;
+    const int m_matchType;
+    const Qt::CaseSensitivity m_cs;
+    QRegExp m_rx;
+};
+
+} // namespace internal
+
+/*! \class LazyTreeModel::Private
+ *  \brief Internal (pimpl of LazyTreeModel)
+ */
+class LazyTreeModel::Private
+{
+public:
+    //! Rows (from the parent of the match start) of a node found by match()
+    typedef std::vector<int> RowPath;
+
+    struct MatchQuery
+    {
+        int role;
+        int hits;
+        bool isRecursive;
+        internal::LazyTreeMatcher* matcher;
+        std::vector<RowPath>* paths;
+
+        bool isComplete() const
+        { return hits >= 0 && static_cast<int>(paths->size()) >= hits; }
+    };
+
+    Private(LazyTreeModel* backPtr)
+        : m_backPtr(backPtr),
+          m_source(NULL),
+          m_rootId(0),
+          m_fetchBatchSize(-1)
+    {
+        this->clearNodes();
+    }
+
+    void clearNodes();
+    int nodePos(const QModelIndex& index) const;
+    int childCount(int nodePos);
+    void loadChildren(const QModelIndex& parent, int endRow);
+    void matchChildren(
+            NodeId parentId, int firstRow, int endRow,
+            MatchQuery* query, RowPath* path) const;
+
+    LazyTreeModel* m_backPtr;
+    Source* m_source;
+    NodeId m_rootId;
+    int m_fetchBatchSize;
+    std::vector<internal::LazyTreeNode> m_nodes; // m_nodes[0] is the root node
+};
+
+void LazyTreeModel::Private::clearNodes()
+{
+    m_nodes.clear();
+    m_nodes.push_back(internal::LazyTreeNode(m_rootId, -1, 0));
+}
+
+int LazyTreeModel::Private::nodePos(const QModelIndex& index) const
+{
+    return index.isValid() ? static_cast<int>(index.internalId()) : 0;
+}
+
+//! Count of children of a node in the source, queried once
+int LazyTreeModel::Private::childCount(int nodePos)
+{
+    internal::LazyTreeNode& node = m_nodes.at(nodePos);
+    if (node.childCount < 0)
+        node.childCount = m_source != NULL ? std::max(m_source->childCount(node.id), 0) : 0;
+    return node.childCount;
+}
+
+//! Loads the children of \p parent until row \p endRow (excluded)
+void LazyTreeModel::Private::loadChildren(const QModelIndex& parent, int endRow)
+{
+    const int parentPos = this->nodePos(parent);
+    const int firstRow = static_cast<int>(m_nodes.at(parentPos).children.size());
+    endRow = std::min(endRow, this->childCount(parentPos));
+    if (endRow <= firstRow)
+        return;
+
+    m_backPtr->beginInsertRows(parent, firstRow, endRow - 1);
+    m_nodes.reserve(m_nodes.size() + (endRow - firstRow));
+    const NodeId parentId = m_nodes.at(parentPos).id;
+    for (int row = firstRow; row < endRow; ++row) {
+        const int childPos = static_cast<int>(m_nodes.size());
+        m_nodes.push_back(
+                    internal::LazyTreeNode(m_source->childId(parentId, row), parentPos, row));
+        m_nodes.at(parentPos).children.push_back(childPos);
+    }
+    m_backPtr->endInsertRows();
+}
+
+//! Depth-first search in the source, in the traversal order of QAbstractItemModel::match()
+void LazyTreeModel::Private::matchChildren(
+        NodeId parentId, int firstRow, int endRow,
+        MatchQuery* query, RowPath* path) const
+{
+    for (int row = firstRow; row < endRow && !query->isComplete(); ++row) {
+        const NodeId id = m_source->childId(parentId, row);
+        path->push_back(row);
+        if (query->matcher->matches(m_source->data(id, query->role)))
+            query->paths->push_back(*path);
+        if (query->isRecursive && m_source->hasChildren(id)) {
+            const int childCount = std::max(m_source->childCount(id), 0);
+            this->matchChildren(id, 0, childCount, query, path);
+        }
+        path->pop_back();
+    }
+}
+
+/*!
+ * \class LazyTreeModel::Source
+ * \brief Provides the nodes of the tree exposed by a LazyTreeModel
+ *
+ * Nodes are identified by a NodeId chosen by the implementation (ex: an index
+ * in some array, a pointer, a database key). Children are queried by row, on
+ * demand, so the whole tree does not need to be materialized.
+ */
+
+LazyTreeModel::Source::~Source()
+{
+}
+
+//! Default implementation returns childCount(node) > 0
+bool LazyTreeModel::Source::hasChildren(NodeId node) const
+{
+    return this->childCount(node) > 0;
+}
+
+//! Default implementation returns Qt::ItemIsEnabled | Qt::ItemIsSelectable
+Qt::ItemFlags LazyTreeModel::Source::flags(NodeId /*node*/) const
+{
+    return Qt::ItemIsEnabled | Qt::ItemIsSelectable;
+}
+
+/*!
+ * \class LazyTreeModel
+ * \brief Single-column tree model populating its rows on demand from a
+ *        LazyTreeModel::Source
+ *
+ * Rows of some parent are loaded by fetchMore(), which views call when the
+ * parent gets expanded. Only the loaded nodes are kept in memory, so a view
+ * over a huge hierarchy opens instantly.
+ *
+ * match() searches the source instead of the loaded rows, then loads only the
+ * ancestors of the nodes found, so searching (ex: with
+ * TreeComboBox::treeFindData()) is not limited to what was browsed.
+ *
+ * The model does not own the source, call reload() when the source changes.
+ *
+ * \headerfile lazy_tree_model.h <qttools/gui/lazy_tree_model.h>
+ * \ingroup qttools_gui
+ *
+ */
+
+LazyTreeModel::LazyTreeModel(QObject* parent)
+    : QAbstractItemModel(parent),
+      d(new Private(this))
+{
+}
+
+LazyTreeModel::~LazyTreeModel()
+{
+    delete d;
+}
+
+LazyTreeModel::Source* LazyTreeModel::source() const
+{
+    return d->m_source;
+}
+
+//! Identifier of the (invisible) root node, parent of top-level rows
+LazyTreeModel::NodeId LazyTreeModel::rootNodeId() const
+{
+    return d->m_rootId;
+}
+
+//! Resets the model on \p source, top-level rows are the children of \p rootId
+void LazyTreeModel::setSource(Source* source, NodeId rootId)
+{
+    this->beginResetModel();
+    d->m_source = source;
+    d->m_rootId = rootId;
+    d->clearNodes();
+    this->endResetModel();
+}
+
+/*! \brief Holds the count of children loaded by one call to fetchMore()
+ *
+ *  -1 means all the children of the parent (the default). Note that
+ *  QTreeView repeats fetchMore() only for top-level rows (when scrolled down),
+ *  children of an expanded item are fetched once.
+ */
+int LazyTreeModel::fetchBatchSize() const
+{
+    return d->m_fetchBatchSize;
+}
+
+void LazyTreeModel::setFetchBatchSize(int count)
+{
+    d->m_fetchBatchSize = count > 0 ? count : -1;
+}
+
+//! Identifier of the node at \p index, rootNodeId() if \p index is invalid
+LazyTreeModel::NodeId LazyTreeModel::nodeId(const QModelIndex& index) const
+{
+    return d->m_nodes.at(d->nodePos(index)).id;
+}
+
+//! Count of nodes loaded so far, the root node excluded
+int LazyTreeModel::loadedNodeCount() const
+{
+    return static_cast<int>(d->m_nodes.size()) - 1;
+}
+
+//! Unloads all nodes, they will be queried again from the source
+void LazyTreeModel::reload()
+{
+    this->beginResetModel();
+    d->clearNodes();
+    this->endResetModel();
+}
+
+QModelIndex LazyTreeModel::index(int row, int column, const QModelIndex& parent) const
+{
+    const internal::LazyTreeNode& parentNode = d->m_nodes.at(d->nodePos(parent));
+    if (column != 0 || row < 0 || row >= static_cast<int>(parentNode.children.size()))
+        return QModelIndex();
+    return this->createIndex(row, column, quintptr(parentNode.children.at(row)));
+}
+
+QModelIndex LazyTreeModel::parent(const QModelIndex& index) const
+{
+    if (!index.isValid())
+        return QModelIndex();
+    const int parentPos = d->m_nodes.at(d->nodePos(index)).parentPos;
+    if (parentPos <= 0)
+        return QModelIndex();
+    return this->createIndex(d->m_nodes.at(parentPos).row, 0, quintptr(parentPos));
+}
+
+//! Count of loaded rows below \p parent
+int LazyTreeModel::rowCount(const QModelIndex& parent) const
+{
+    if (parent.column() > 0)
+        return 0;
+    return static_cast<int>(d->m_nodes.at(d->nodePos(parent)).children.size());
+}
+
+int LazyTreeModel::columnCount(const QModelIndex& /*parent*/) const
+{
+    return 1;
+}
+
+QVariant LazyTreeModel::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid() || d->m_source == NULL)
+        return QVariant();
+    return d->m_source->data(this->nodeId(index), role);
+}
+
+Qt::ItemFlags LazyTreeModel::flags(const QModelIndex& index) const
+{
+    if (!index.isValid() || d->m_source == NULL)
+        return Qt::NoItemFlags;
+    return d->m_source->flags(this->nodeId(index));
+}
+
+//! Returns true if \p parent has children in the source, loaded or not
+bool LazyTreeModel::hasChildren(const QModelIndex& parent) const
+{
+    if (d->m_source == NULL || parent.column() > 0)
+        return false;
+    const int parentPos = d->nodePos(parent);
+    const internal::LazyTreeNode& node = d->m_nodes.at(parentPos);
+    if (node.childCount >= 0 || !parent.isValid())
+        return d->childCount(parentPos) > 0;
+    return d->m_source->hasChildren(node.id);
+}
+
+bool LazyTreeModel::canFetchMore(const QModelIndex& parent) const
+{
+    if (d->m_source == NULL || parent.column() > 0)
+        return false;
+    const int parentPos = d->nodePos(parent);
+    return static_cast<int>(d->m_nodes.at(parentPos).children.size())
+            < d->childCount(parentPos);
+}
+
+void LazyTreeModel::fetchMore(const QModelIndex& parent)
+{
+    if (!this->canFetchMore(parent))
+        return;
+    const int loadedCount = this->rowCount(parent);
+    const int endRow =
+            d->m_fetchBatchSize > 0 ?
+                loadedCount + d->m_fetchBatchSize :
+                d->childCount(d->nodePos(parent));
+    d->loadChildren(parent, endRow);
+}
+
+/*! Same as QAbstractItemModel::match() but nodes are searched in the source,
+ *  loaded or not
+ *
+ *  Rows leading to the nodes found are loaded (by batches of fetchBatchSize()),
+ *  so rowsInserted() can be emitted even though this function is const.
+ */
+QModelIndexList LazyTreeModel::match(
+        const QModelIndex& start,
+        int role,
+        const QVariant& value,
+        int hits,
+        Qt::MatchFlags flags) const
+{
+    QModelIndexList result;
+    if (d->m_source == NULL || !start.isValid())
+        return result;
+
+    const QModelIndex parent = start.parent();
+    const NodeId parentId = this->nodeId(parent);
+    const int childCount = d->childCount(d->nodePos(parent));
+
+    internal::LazyTreeMatcher matcher(value, flags);
+    std::vector<Private::RowPath> paths;
+    Private::MatchQuery query;
+    query.role = role;
+    query.hits = hits;
+    query.isRecursive = flags.testFlag(Qt::MatchRecursive);
+    query.matcher = &matcher;
+    query.paths = &paths;
+    Private::RowPath path;
+    d->matchChildren(parentId, start.row(), childCount, &query, &path);
+    if (flags.testFlag(Qt::MatchWrap))
+        d->matchChildren(parentId, 0, start.row(), &query, &path);
+
+    // Load the rows leading to the nodes found
+    LazyTreeModel* self = const_cast<LazyTreeModel*>(this);
+    for (const Private::RowPath& rowPath : paths) {
+        QModelIndex index = parent;
+        for (int row : rowPath) {
+            if (row >= self->rowCount(index)) {
+                const int endRow =
+                        d->m_fetchBatchSize > 0 ?
+                            (row / d->m_fetchBatchSize + 1) * d->m_fetchBatchSize :
+                            d->childCount(d->nodePos(index));
+                d->loadChildren(index, endRow);
+            }
+            index = self->index(row, 0, index);
+        }
+        result.append(index);
+    }
+    return result;
+}
+
+} // namespace qtgui
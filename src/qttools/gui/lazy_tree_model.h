@@ -0,0 +1,80 @@
+/****************************************************************************
+**  FougTools
+**  Copyright Fougue (30 Mar. 2015)
+**  contact@fougue.pro
+**
+** This software is a computer program whose purpose is to provide utility
+** tools for the C++ language and the Qt toolkit.
+**
+** This software is governed by the CeCILL-C license under French law and
+** abiding by the rules of distribution of free software.  You can  use,
+** modify and/ or redistribute the software under the terms of the CeCILL-C
+** license as circulated by CEA, CNRS and INRIA at the following URL
+** "http://www.cecill.info".
+****************************************************************************/
+
+#pragma once
+
+#include "gui.h"
+
+#include <QtCore/QAbstractItemModel>
+
+namespace qtgui {
+
+class QTTOOLS_GUI_EXPORT LazyTreeModel : public QAbstractItemModel
+{
+    Q_OBJECT
+
+public:
+    typedef quint64 NodeId;
+
+    class QTTOOLS_GUI_EXPORT Source
+    {
+    public:
+        virtual ~Source();
+        virtual int childCount(NodeId parent) const = 0;
+        virtual NodeId childId(NodeId parent, int row) const = 0;
+        virtual QVariant data(NodeId node, int role) const = 0;
+        virtual bool hasChildren(NodeId node) const;
+        virtual Qt::ItemFlags flags(NodeId node) const;
+    };
+
+    LazyTreeModel(QObject* parent = NULL);
+    ~LazyTreeModel();
+
+    Source* source() const;
+    NodeId rootNodeId() const;
+    void setSource(Source* source, NodeId rootId = 0);
+
+    int fetchBatchSize() const;
+    void setFetchBatchSize(int count);
+
+    NodeId nodeId(const QModelIndex& index) const;
+    int loadedNodeCount() const;
+    void reload();
+
+    // QAbstractItemModel
+    QModelIndex index(
+            int row, int column, const QModelIndex& parent = QModelIndex()) const Q_DECL_OVERRIDE;
+    QModelIndex parent(const QModelIndex& index) const Q_DECL_OVERRIDE;
+    int rowCount(const QModelIndex& parent = QModelIndex()) const Q_DECL_OVERRIDE;
+    int columnCount(const QModelIndex& parent = QModelIndex()) const Q_DECL_OVERRIDE;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const Q_DECL_OVERRIDE;
+    Qt::ItemFlags flags(const QModelIndex& index) const Q_DECL_OVERRIDE;
+    bool hasChildren(const QModelIndex& parent = QModelIndex()) const Q_DECL_OVERRIDE;
+    bool canFetchMore(const QModelIndex& parent) const Q_DECL_OVERRIDE;
+    void fetchMore(const QModelIndex& parent) Q_DECL_OVERRIDE;
+    QModelIndexList match(
+            const QModelIndex& start,
+            int role,
+            const QVariant& value,
+            int hits = 1,
+            Qt::MatchFlags flags =
+                Qt::MatchFlags(Qt::MatchStartsWith | Qt::MatchWrap)) const Q_DECL_OVERRIDE;
+
+private:
+    class Private;
+    Private* const d;
+};
+
+} // namespace qtgui
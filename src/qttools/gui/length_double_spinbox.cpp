@@ -16,38 +16,23 @@
 #include "length_double_spinbox.h"
 
 #include "../../cpptools/scoped_value.h"
+#include "length_formatter.h"
 #include "quantity_editor_manager.h"
 
 namespace qtgui {
 
 namespace internal {
 
-static double toMmValue(double v, qtgui::LengthDoubleSpinBox::MetricUnit unit)
+//! Shared formatter matching the units, locale and decimals of \p box
+static const LengthFormatter* lengthFormatter(
+        const LengthDoubleSpinBox* box, QLocale::MeasurementSystem sys)
 {
-    switch (unit) {
-    case qtgui::LengthDoubleSpinBox::MeterUnit:
-        return v * 1000.;
-    case qtgui::LengthDoubleSpinBox::CentimeterUnit:
-        return v * 10.;
-    case qtgui::LengthDoubleSpinBox::MillimeterUnit:
-        return v;
-    default:
-        return v;
-    }
-}
-
-static double toMmValue(double v, qtgui::LengthDoubleSpinBox::ImperialUnit unit)
-{
-    switch (unit) {
-    case qtgui::LengthDoubleSpinBox::InchUnit:
-        return v * 25.4;
-    case qtgui::LengthDoubleSpinBox::FootUnit:
-        return (v * 25.4) * 12.;
-    case qtgui::LengthDoubleSpinBox::YardUnit:
-        return (v * 25.4) * 36.;
-    default:
-        return v;
-    }
+    return LengthFormatter::forMeasurementSystem(
+                sys,
+                box->preferredMetricUnit(),
+                box->preferredImperialUnit(),
+                box->locale(),
+                box->decimals());
 }
 
 } // namespace internal
@@ -82,6 +67,9 @@ void LengthDoubleSpinBox::Private::onValueChanged(double v)
  * \class LengthDoubleSpinBox
  * \brief Provides a QDoubleSpinBox adapted to the interface of AbstractLengthEditor
  *
+ * Unit conversions use the shared LengthFormatter of the current units,
+ * locale and decimals.
+ *
  * \headerfile length_double_spinbox.h <qttools/gui/length_double_spinbox.h>
  * \ingroup qttools_gui
  */
@@ -107,17 +95,9 @@ double LengthDoubleSpinBox::length() const
     if (!d->m_valueHasChanged)
         return d->m_orgLengthMm;
 
-    const double v = QDoubleSpinBox::value();
-    switch (this->measurementSystem()) {
-    case QLocale::MetricSystem:
-        return internal::toMmValue(v, this->preferredMetricUnit());
-#if QT_VERSION >= 0x050000
-    case QLocale::ImperialUKSystem:
-#endif // QT_VERSION
-    case QLocale::ImperialSystem:
-        return internal::toMmValue(v, this->preferredImperialUnit());
-    }
-    return 0.;
+    const LengthFormatter* fmt =
+            internal::lengthFormatter(this, this->measurementSystem());
+    return fmt->toMmValue(QDoubleSpinBox::value());
 }
 
 void LengthDoubleSpinBox::setLength(double v)
@@ -128,19 +108,9 @@ void LengthDoubleSpinBox::setLength(double v)
     cpp::ScopedBool sb(d->m_isInternalUpdateContext, true);
     Q_UNUSED(sb);
 
-    switch (this->measurementSystem()) {
-    case QLocale::MetricSystem:
-        this->setValue(AbstractLengthEditor::asMetricLength(
-                           v, this->preferredMetricUnit()));
-        break;
-#if QT_VERSION >= 0x050000
-    case QLocale::ImperialUKSystem:
-#endif // QT_VERSION
-    case QLocale::ImperialSystem:
-        this->setValue(AbstractLengthEditor::asImperialLength(
-                           v, this->preferredImperialUnit()));
-        break;
-    }
+    const LengthFormatter* fmt =
+            internal::lengthFormatter(this, this->measurementSystem());
+    this->setValue(fmt->toUnitValue(v));
 }
 
 void LengthDoubleSpinBox::updateEditor(QLocale::MeasurementSystem newSys)
@@ -149,28 +119,9 @@ void LengthDoubleSpinBox::updateEditor(QLocale::MeasurementSystem newSys)
     Q_UNUSED(sb);
 
     const double oldLengthMm = this->length();
-    double newLengthUnit = 0.;
-    QString unitStr;
-    switch (newSys) {
-    case QLocale::MetricSystem: {
-        unitStr = AbstractLengthEditor::unitText(this->preferredMetricUnit());
-        newLengthUnit = AbstractLengthEditor::asMetricLength(
-                    oldLengthMm, this->preferredMetricUnit());
-        break;
-    }
-#if QT_VERSION >= 0x050000
-    case QLocale::ImperialUKSystem:
-#endif // QT_VERSION
-    case QLocale::ImperialSystem: {
-        unitStr = AbstractLengthEditor::unitText(this->preferredImperialUnit());
-        newLengthUnit = AbstractLengthEditor::asImperialLength(
-                    oldLengthMm, this->preferredImperialUnit());
-        break;
-    }
-    }
-
-    QDoubleSpinBox::setSuffix(unitStr);
-    QDoubleSpinBox::setValue(newLengthUnit);
+    const LengthFormatter* fmt = internal::lengthFormatter(this, newSys);
+    QDoubleSpinBox::setSuffix(fmt->unitText());
+    QDoubleSpinBox::setValue(fmt->toUnitValue(oldLengthMm));
 }
 
 } // namespace qtgui
@@ -0,0 +1,220 @@
+/****************************************************************************
+**  FougTools
+**  Copyright Fougue (30 Mar. 2015)
+**  contact@fougue.pro
+**
+** This software is a computer program whose purpose is to provide utility
+** tools for the C++ language and the Qt toolkit.
+**
+** This software is governed by the CeCILL-C license under French law and
+** abiding by the rules of distribution of free software.  You can  use,
+** modify and/ or redistribute the software under the terms of the CeCILL-C
+** license as circulated by CEA, CNRS and INRIA at the following URL
+** "http://www.cecill.info".
+****************************************************************************/
+
+
+#include "length_formatter.h"
+
+#include <QtCore/QHash>
+#include <QtCore/QMutex>
+
+namespace qtgui {
+
+namespace internal {
+
+struct LengthFormatterKey
+{
+    bool isImperial;
+    int unit;
+    QString localeName;
+    int localeOptions;
+    int decimals;
+
+    bool operator==(const LengthFormatterKey& other) const
+    {
+        return isImperial == other.isImperial
+                && unit == other.unit
+                && localeName == other.localeName
+                && localeOptions == other.localeOptions
+                && decimals == other.decimals;
+    }
+};
+
+static uint qHash(const LengthFormatterKey& key, uint seed = 0)
+{
+    const uint h = ::qHash(key.localeName, seed);
+    return h ^ ((key.unit << 1 | (key.isImperial ? 1 : 0))
+                + (key.decimals << 8) + (key.localeOptions << 16));
+}
+
+struct LengthFormatterCache
+{
+    // Formatters are never deleted : pointers handed out stay valid, and the
+    // count of (unit, locale, decimals) combinations used is small
+    QMutex mutex;
+    QHash<LengthFormatterKey, const LengthFormatter*> formatters;
+};
+
+Q_GLOBAL_STATIC(LengthFormatterCache, globalLengthFormatterCache)
+
+static double mmPerMetricUnit(AbstractLengthEditor::MetricUnit unit)
+{
+    switch (unit) {
+    case AbstractLengthEditor::MeterUnit: return 1000.;
+    case AbstractLengthEditor::CentimeterUnit: return 10.;
+    case AbstractLengthEditor::MillimeterUnit: return 1.;
+    }
+    return 1.;
+}
+
+static double mmPerImperialUnit(AbstractLengthEditor::ImperialUnit unit)
+{
+    switch (unit) {
+    case AbstractLengthEditor::InchUnit: return 25.4;
+    case AbstractLengthEditor::FootUnit: return 25.4 * 12.;
+    case AbstractLengthEditor::YardUnit: return 25.4 * 36.;
+    }
+    return 1.;
+}
+
+} // namespace internal
+
+/*!
+ * \class LengthFormatter
+ * \brief Converts and formats lengths for some unit, locale and count of
+ *        decimals
+ *
+ * Formatter objects are shared : metric(), imperial() and
+ * forMeasurementSystem() return the same object for the same (unit, locale,
+ * decimals) combination, with conversion factors computed once. They are
+ * immutable, so they can be used from any thread.
+ *
+ * Editors (ex: LengthDoubleSpinBox) and display-only delegates can use them
+ * the same way, typically keeping the formatter pointer rather than querying it
+ * for each value :
+ * \code
+ *   QString MyLengthDelegate::displayText(const QVariant& value, const QLocale& locale) const
+ *   {
+ *       const qtgui::LengthFormatter* fmt =
+ *               qtgui::LengthFormatter::metric(Editor::CentimeterUnit, locale, 1);
+ *       return fmt->formatLength(value.toDouble()); // ex: "2.5 cm"
+ *   }
+ * \endcode
+ *
+ * \headerfile length_formatter.h <qttools/gui/length_formatter.h>
+ * \ingroup qttools_gui
+ */
+
+LengthFormatter::LengthFormatter(
+        bool isImperial, int unit, double mmPerUnit,
+        const QLocale& locale, int decimals)
+    : m_isImperial(isImperial),
+      m_unit(unit),
+      m_mmPerUnit(mmPerUnit),
+      m_locale(locale),
+      m_decimals(decimals),
+      m_unitText(
+          isImperial ?
+              AbstractLengthEditor::unitText(
+                  static_cast<AbstractLengthEditor::ImperialUnit>(unit)) :
+              AbstractLengthEditor::unitText(
+                  static_cast<AbstractLengthEditor::MetricUnit>(unit)))
+{
+}
+
+//! Shared formatter for metric \p unit
+const LengthFormatter* LengthFormatter::metric(
+        AbstractLengthEditor::MetricUnit unit, const QLocale& locale, int decimals)
+{
+    return LengthFormatter::cached(false, unit, locale, decimals);
+}
+
+//! Shared formatter for imperial \p unit
+const LengthFormatter* LengthFormatter::imperial(
+        AbstractLengthEditor::ImperialUnit unit, const QLocale& locale, int decimals)
+{
+    return LengthFormatter::cached(true, unit, locale, decimals);
+}
+
+/*! Shared formatter for \p metricUnit or \p imperialUnit, depending on
+ *  measurement system \p sys
+ */
+const LengthFormatter* LengthFormatter::forMeasurementSystem(
+        QLocale::MeasurementSystem sys,
+        AbstractLengthEditor::MetricUnit metricUnit,
+        AbstractLengthEditor::ImperialUnit imperialUnit,
+        const QLocale& locale,
+        int decimals)
+{
+    if (sys == QLocale::MetricSystem)
+        return LengthFormatter::metric(metricUnit, locale, decimals);
+    return LengthFormatter::imperial(imperialUnit, locale, decimals);
+}
+
+bool LengthFormatter::isImperial() const
+{
+    return m_isImperial;
+}
+
+/*! Unit of this formatter, to be casted to AbstractLengthEditor::ImperialUnit
+ *  if isImperial(), AbstractLengthEditor::MetricUnit otherwise
+ */
+int LengthFormatter::unit() const
+{
+    return m_unit;
+}
+
+const QLocale& LengthFormatter::locale() const
+{
+    return m_locale;
+}
+
+int LengthFormatter::decimals() const
+{
+    return m_decimals;
+}
+
+//! Same as AbstractLengthEditor::unitText() for the unit of this formatter
+const QString& LengthFormatter::unitText() const
+{
+    return m_unitText;
+}
+
+//! Text of \p unitValue (already in the unit of this formatter), without unit
+QString LengthFormatter::formatValue(double unitValue) const
+{
+    return m_locale.toString(unitValue, 'f', m_decimals);
+}
+
+//! Text of \p lengthMm converted to the unit of this formatter, with unit text
+QString LengthFormatter::formatLength(double lengthMm) const
+{
+    return this->formatValue(this->toUnitValue(lengthMm))
+            + QLatin1Char(' ')
+            + m_unitText;
+}
+
+const LengthFormatter* LengthFormatter::cached(
+        bool isImperial, int unit, const QLocale& locale, int decimals)
+{
+    internal::LengthFormatterCache* cache = internal::globalLengthFormatterCache();
+    const internal::LengthFormatterKey key = {
+        isImperial, unit, locale.name(), static_cast<int>(locale.numberOptions()), decimals };
+
+    QMutexLocker locker(&cache->mutex);
+    Q_UNUSED(locker);
+    const LengthFormatter*& formatter = cache->formatters[key];
+    if (formatter == NULL) {
+        const double mmPerUnit =
+                isImperial ?
+                    internal::mmPerImperialUnit(
+                        static_cast<AbstractLengthEditor::ImperialUnit>(unit)) :
+                    internal::mmPerMetricUnit(
+                        static_cast<AbstractLengthEditor::MetricUnit>(unit));
+        formatter = new LengthFormatter(isImperial, unit, mmPerUnit, locale, decimals);
+    }
+    return formatter;
+}
+
+} // namespace qtgui
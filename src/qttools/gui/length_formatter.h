@@ -0,0 +1,90 @@
+/****************************************************************************
+**  FougTools
+**  Copyright Fougue (30 Mar. 2015)
+**  contact@fougue.pro
+**
+** This software is a computer program whose purpose is to provide utility
+** tools for the C++ language and the Qt toolkit.
+**
+** This software is governed by the CeCILL-C license under French law and
+** abiding by the rules of distribution of free software.  You can  use,
+** modify and/ or redistribute the software under the terms of the CeCILL-C
+** license as circulated by CEA, CNRS and INRIA at the following URL
+** "http://www.cecill.info".
+****************************************************************************/
+
+
+#pragma once
+
+#include "gui.h"
+#include "abstract_length_editor.h"
+
+#include <QtCore/QLocale>
+#include <QtCore/QString>
+
+namespace qtgui {
+
+class QTTOOLS_GUI_EXPORT LengthFormatter
+{
+public:
+    static const LengthFormatter* metric(
+            AbstractLengthEditor::MetricUnit unit,
+            const QLocale& locale = QLocale(),
+            int decimals = 2);
+    static const LengthFormatter* imperial(
+            AbstractLengthEditor::ImperialUnit unit,
+            const QLocale& locale = QLocale(),
+            int decimals = 2);
+    static const LengthFormatter* forMeasurementSystem(
+            QLocale::MeasurementSystem sys,
+            AbstractLengthEditor::MetricUnit metricUnit,
+            AbstractLengthEditor::ImperialUnit imperialUnit,
+            const QLocale& locale = QLocale(),
+            int decimals = 2);
+
+    bool isImperial() const;
+    int unit() const;
+    const QLocale& locale() const;
+    int decimals() const;
+    const QString& unitText() const;
+
+    inline double toUnitValue(double lengthMm) const;
+    inline double toMmValue(double unitValue) const;
+
+    QString formatValue(double unitValue) const;
+    QString formatLength(double lengthMm) const;
+
+private:
+    LengthFormatter(
+            bool isImperial, int unit, double mmPerUnit,
+            const QLocale& locale, int decimals);
+    static const LengthFormatter* cached(
+            bool isImperial, int unit, const QLocale& locale, int decimals);
+
+    const bool m_isImperial;
+    const int m_unit;
+    const double m_mmPerUnit;
+    const QLocale m_locale;
+    const int m_decimals;
+    const QString m_unitText;
+};
+
+
+
+// --
+// -- Implementation
+// --
+
+//! Converts \p lengthMm (in millimeter) to the unit of this formatter
+double LengthFormatter::toUnitValue(double lengthMm) const
+{
+    return lengthMm / m_mmPerUnit;
+}
+
+//! Converts \p unitValue (in the unit of this formatter) to millimeter
+double LengthFormatter::toMmValue(double unitValue) const
+{
+    return unitValue * m_mmPerUnit;
+}
+
+} // namespace qtgui
@@ -16,7 +16,9 @@
 #include "line_numbers_bar.h"
 
 #include <QtCore/QRect>
+#include <QtCore/qmath.h>
 #include <QtGui/QAbstractTextDocumentLayout>
+#include <QtGui/QPaintEvent>
 #include <QtGui/QPainter>
 #include <QtGui/QPixmap>
 #include <QtGui/QTextBlock>
@@ -58,6 +60,10 @@ public:
  * \class LineNumbersBar
  * \brief Provides numbering of the lines of a QTextEdit as a vertical bar
  *
+ * Painting starts at the first block visible in the text edit viewport, and
+ * document layout updates only repaint the matching part of the bar, so the
+ * cost of a repaint does not depend on the document size.
+ *
  * \headerfile line_numbers_bar.h <qttools/gui/line_numbers_bar.h>
  * \ingroup qttools_gui
  */
@@ -95,19 +101,26 @@ void LineNumbersBar::setBugLine(int lineno)
 
 void LineNumbersBar::setTextEdit(QTextEdit* edit)
 {
-    auto docLayout = edit->document()->documentLayout();
     if (d->m_edit != NULL) {
+        QTextDocument* doc = d->m_edit->document();
+        QObject::disconnect(
+                    doc->documentLayout(), &QAbstractTextDocumentLayout::update,
+                    this, &LineNumbersBar::updateWidgetRect);
         QObject::disconnect(
-                    docLayout, &QAbstractTextDocumentLayout::update,
+                    doc, &QTextDocument::blockCountChanged,
                     this, &LineNumbersBar::updateWidget);
         QObject::disconnect(
-                    edit->verticalScrollBar(), &QScrollBar::valueChanged,
+                    d->m_edit->verticalScrollBar(), &QScrollBar::valueChanged,
                     this, &LineNumbersBar::updateWidget);
     }
     d->m_edit = edit;
     if (edit != NULL) {
+        QTextDocument* doc = edit->document();
+        QObject::connect(
+                    doc->documentLayout(), &QAbstractTextDocumentLayout::update,
+                    this, &LineNumbersBar::updateWidgetRect);
         QObject::connect(
-                    docLayout, &QAbstractTextDocumentLayout::update,
+                    doc, &QTextDocument::blockCountChanged,
                     this, &LineNumbersBar::updateWidget);
         QObject::connect(
                     edit->verticalScrollBar(), &QScrollBar::valueChanged,
@@ -127,14 +140,24 @@ void LineNumbersBar::paintEvent(QPaintEvent* event)
     const qreal pageBottom = contentsY + d->m_edit->viewport()->height();
     const QFontMetrics fm = this->fontMetrics();
     const int ascent = this->fontMetrics().ascent() + 1; // height = ascent + descent + 1
-    int lineCount = 1;
+    const QRect paintRect = event->rect();
     QPainter p(this);
 
     d->m_bugRect = QRect();
     d->m_stopRect = QRect();
     d->m_currentRect = QRect();
 
-    for (QTextBlock block = d->m_edit->document()->begin();
+    // Find first visible block with a hit test instead of iterating from the
+    // beginning of the document
+    QTextBlock block = d->m_edit->cursorForPosition(QPoint(0, 0)).block();
+    while (block.isValid()
+           && block.previous().isValid()
+           && layout->blockBoundingRect(block).top() > contentsY)
+    {
+        block = block.previous();
+    }
+
+    for (int lineCount = block.blockNumber() + 1;
          block.isValid();
          block = block.next(), ++lineCount)
     {
@@ -147,8 +170,12 @@ void LineNumbersBar::paintEvent(QPaintEvent* event)
         if (position.y() > pageBottom)
             break;
 
-        const QString txt(QString::number(lineCount));
-        p.drawText(this->width() - fm.width(txt), qRound(position.y() ) - contentsY + ascent, txt);
+        const int lineTop = qRound(position.y()) - contentsY;
+        const int lineBottom = lineTop + qCeil(boundingRect.height());
+        if (lineBottom >= paintRect.top() && lineTop <= paintRect.bottom()) {
+            const QString txt(QString::number(lineCount));
+            p.drawText(this->width() - fm.width(txt), lineTop + ascent, txt);
+        }
 
         // Bug marker
         if (d->m_bugLine == lineCount) {
@@ -195,4 +222,19 @@ void LineNumbersBar::updateWidget()
     QWidget::update();
 }
 
+/*! Repaints the part of the bar facing \p docRect (in document coordinates) */
+void LineNumbersBar::updateWidgetRect(const QRectF& docRect)
+{
+    if (d->m_edit == NULL || !docRect.isValid()) {
+        QWidget::update();
+        return;
+    }
+
+    const int contentsY = d->m_edit->verticalScrollBar()->value();
+    const int top = qMax(qFloor(docRect.top()) - contentsY, 0);
+    const int bottom = qMin(qCeil(docRect.bottom()) - contentsY, this->height());
+    if (top <= bottom)
+        QWidget::update(0, top, this->width(), bottom - top + 1);
+}
+
 } // namespace qtgui
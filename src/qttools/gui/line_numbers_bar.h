@@ -18,6 +18,7 @@
 #include "gui.h"
 // QtWidgets
 #include <QWidget>
+class QRectF;
 class QTextEdit;
 
 namespace qtgui {
@@ -41,6 +42,7 @@ protected:
 
 private:
     void updateWidget();
+    void updateWidgetRect(const QRectF& docRect);
 
     class Private;
     Private* const d;
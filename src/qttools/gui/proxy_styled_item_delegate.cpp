@@ -15,8 +15,158 @@
 
 #include "proxy_styled_item_delegate.h"
 
+#include <QtCore/QAbstractItemModel>
+#include <QtCore/QDate>
+#include <QtCore/QDateTime>
+#include <QtCore/QHash>
+#include <QtCore/QPointer>
+#include <QtCore/QTime>
+
+#include <cstring>
+
 namespace qtgui {
 
+namespace internal {
+
+//! Key of a value whose text is cached by ProxyStyledItemDelegate::displayText()
+struct DisplayTextKey
+{
+    int type;
+    quint64 bits;
+    QString localeName;
+
+    bool operator==(const DisplayTextKey& other) const
+    {
+        return type == other.type
+                && bits == other.bits
+                && localeName == other.localeName;
+    }
+};
+
+static uint qHash(const DisplayTextKey& key, uint seed = 0)
+{
+    return ::qHash(key.bits, seed) ^ ::qHash(key.localeName) ^ uint(key.type);
+}
+
+/*! Builds the cache key of \p value into \p key, only for types whose text is
+ *  potentially costly to compute (locale-dependent number and date/time
+ *  formatting)
+ *
+ *  \returns \c false if \p value is not cacheable
+ */
+static bool toDisplayTextKey(
+        const QVariant& value, const QLocale& locale, DisplayTextKey* key)
+{
+    switch (value.userType()) {
+    case QMetaType::Int:
+    case QMetaType::LongLong:
+        key->bits = static_cast<quint64>(value.toLongLong());
+        break;
+    case QMetaType::UInt:
+    case QMetaType::ULongLong:
+        key->bits = value.toULongLong();
+        break;
+    case QMetaType::Float:
+    case QMetaType::Double: {
+        const double dval = value.toDouble();
+        std::memcpy(&key->bits, &dval, sizeof(dval));
+        break;
+    }
+    case QMetaType::QDate:
+        key->bits = static_cast<quint64>(value.toDate().toJulianDay());
+        break;
+    case QMetaType::QTime:
+        key->bits = static_cast<quint64>(value.toTime().msecsSinceStartOfDay());
+        break;
+    case QMetaType::QDateTime:
+        // Time spec is not part of the key
+        if (value.toDateTime().timeSpec() != Qt::LocalTime)
+            return false;
+        key->bits = static_cast<quint64>(value.toDateTime().toMSecsSinceEpoch());
+        break;
+    default:
+        return false;
+    }
+    key->type = value.userType();
+    key->localeName = locale.name();
+    return true;
+}
+
+} // namespace internal
+
+class ProxyStyledItemDelegate::Private
+{
+public:
+    Private(ProxyStyledItemDelegate* backPtr)
+        : m_backPtr(backPtr),
+          m_isSizeHintCacheEnabled(false),
+          m_isDisplayTextCacheEnabled(false)
+    { }
+
+    struct SizeHintEntry
+    {
+        int rectWidth;
+        QSize decorationSize;
+        QSize sizeHint;
+    };
+
+    void syncWithModel(const QAbstractItemModel* model);
+    void onDataChanged(const QModelIndex& topLeft, const QModelIndex& bottomRight);
+
+    ProxyStyledItemDelegate* m_backPtr;
+    bool m_isSizeHintCacheEnabled;
+    bool m_isDisplayTextCacheEnabled;
+    QPointer<const QAbstractItemModel> m_model;
+    QHash<QModelIndex, SizeHintEntry> m_sizeHintCache;
+    QHash<internal::DisplayTextKey, QString> m_displayTextCache;
+};
+
+void ProxyStyledItemDelegate::Private::syncWithModel(const QAbstractItemModel *model)
+{
+    if (m_model == model)
+        return;
+
+    if (m_model != NULL)
+        QObject::disconnect(m_model, NULL, m_backPtr, NULL);
+    m_sizeHintCache.clear();
+    m_model = model;
+    if (model == NULL)
+        return;
+
+    typedef QAbstractItemModel Model;
+    auto fnClear = [=] { m_sizeHintCache.clear(); };
+    QObject::connect(
+                model, &Model::dataChanged,
+                m_backPtr, [=](const QModelIndex& topLeft, const QModelIndex& bottomRight) {
+        this->onDataChanged(topLeft, bottomRight);
+    } );
+    QObject::connect(model, &Model::rowsInserted, m_backPtr, fnClear);
+    QObject::connect(model, &Model::rowsRemoved, m_backPtr, fnClear);
+    QObject::connect(model, &Model::rowsMoved, m_backPtr, fnClear);
+    QObject::connect(model, &Model::columnsInserted, m_backPtr, fnClear);
+    QObject::connect(model, &Model::columnsRemoved, m_backPtr, fnClear);
+    QObject::connect(model, &Model::columnsMoved, m_backPtr, fnClear);
+    QObject::connect(model, &Model::layoutChanged, m_backPtr, fnClear);
+    QObject::connect(model, &Model::modelReset, m_backPtr, fnClear);
+}
+
+void ProxyStyledItemDelegate::Private::onDataChanged(
+        const QModelIndex &topLeft, const QModelIndex &bottomRight)
+{
+    const int rowCount = bottomRight.row() - topLeft.row() + 1;
+    const int colCount = bottomRight.column() - topLeft.column() + 1;
+    // Removing entries one by one is worth it only for small ranges
+    if (!topLeft.isValid() || rowCount * colCount > 1024) {
+        m_sizeHintCache.clear();
+        return;
+    }
+
+    for (int row = topLeft.row(); row <= bottomRight.row(); ++row) {
+        for (int col = topLeft.column(); col <= bottomRight.column(); ++col)
+            m_sizeHintCache.remove(topLeft.sibling(row, col));
+    }
+}
+
 /*!
  * \class ProxyStyledItemDelegate
  * \brief Convenience class that simplifies dynamically overriding QStyledItemDelegate
@@ -27,6 +177,18 @@ namespace qtgui {
  *   \li QStyledItemDelegate::eventFilter()
  *   \li QStyledItemDelegate::editorEvent()
  *
+ * Results of sizeHint() and displayText() can optionally be cached, so views
+ * calling them repeatedly (ex: QHeaderView::ResizeToContents) do not run the
+ * source delegate again for unchanged items :
+ *   \li size hints are cached per model index, an entry is dropped when the
+ *       model signals the item data changed. All entries are dropped on any
+ *       structural change of the model (rows, columns, layout, reset)
+ *   \li display texts of numbers and date/times are cached per value and
+ *       locale
+ *
+ * Caches are not aware of changes in fonts, styles or the source delegate
+ * itself, clearCaches() must then be called.
+ *
  * \headerfile proxy_styled_item_delegate.h <qttools/gui/proxy_styled_item_delegate.h>
  * \ingroup qttools_gui
  *
@@ -34,17 +196,23 @@ namespace qtgui {
 
 ProxyStyledItemDelegate::ProxyStyledItemDelegate(QObject *parent)
     : QStyledItemDelegate(parent),
-      m_sourceDelegate(NULL)
+      m_sourceDelegate(NULL),
+      d(new Private(this))
 {
-
 }
 
 ProxyStyledItemDelegate::ProxyStyledItemDelegate(
         QStyledItemDelegate *srcDelegate,
         QObject* parent)
     : QStyledItemDelegate(parent),
-      m_sourceDelegate(srcDelegate)
+      m_sourceDelegate(srcDelegate),
+      d(new Private(this))
+{
+}
+
+ProxyStyledItemDelegate::~ProxyStyledItemDelegate()
 {
+    delete d;
 }
 
 QStyledItemDelegate *ProxyStyledItemDelegate::sourceDelegate() const
@@ -55,6 +223,49 @@ QStyledItemDelegate *ProxyStyledItemDelegate::sourceDelegate() const
 void ProxyStyledItemDelegate::setSourceDelegate(QStyledItemDelegate *srcDelegate)
 {
     m_sourceDelegate = srcDelegate;
+    this->clearCaches();
+}
+
+/*! \brief Holds whether results of sizeHint() are cached per model index
+ *
+ *  Default value is \c false
+ */
+bool ProxyStyledItemDelegate::isSizeHintCacheEnabled() const
+{
+    return d->m_isSizeHintCacheEnabled;
+}
+
+void ProxyStyledItemDelegate::setSizeHintCacheEnabled(bool on)
+{
+    d->m_isSizeHintCacheEnabled = on;
+    if (!on) {
+        d->syncWithModel(NULL);
+        d->m_sizeHintCache.clear();
+    }
+}
+
+/*! \brief Holds whether results of displayText() are cached for number and
+ *         date/time values
+ *
+ *  Default value is \c false
+ */
+bool ProxyStyledItemDelegate::isDisplayTextCacheEnabled() const
+{
+    return d->m_isDisplayTextCacheEnabled;
+}
+
+void ProxyStyledItemDelegate::setDisplayTextCacheEnabled(bool on)
+{
+    d->m_isDisplayTextCacheEnabled = on;
+    if (!on)
+        d->m_displayTextCache.clear();
+}
+
+//! Drops all cached size hints and display texts
+void ProxyStyledItemDelegate::clearCaches()
+{
+    d->m_sizeHintCache.clear();
+    d->m_displayTextCache.clear();
 }
 
 void ProxyStyledItemDelegate::paint(
@@ -72,17 +283,56 @@ QSize ProxyStyledItemDelegate::sizeHint(
         const QStyleOptionViewItem &option,
         const QModelIndex &index) const
 {
-    if (m_sourceDelegate != NULL)
-        return m_sourceDelegate->sizeHint(option, index);
-    return QStyledItemDelegate::sizeHint(option, index);
+    if (!d->m_isSizeHintCacheEnabled || !index.isValid()) {
+        if (m_sourceDelegate != NULL)
+            return m_sourceDelegate->sizeHint(option, index);
+        return QStyledItemDelegate::sizeHint(option, index);
+    }
+
+    d->syncWithModel(index.model());
+    const auto it = d->m_sizeHintCache.constFind(index);
+    if (it != d->m_sizeHintCache.constEnd()
+            && it.value().rectWidth == option.rect.width()
+            && it.value().decorationSize == option.decorationSize)
+    {
+        return it.value().sizeHint;
+    }
+
+    Private::SizeHintEntry entry;
+    entry.rectWidth = option.rect.width();
+    entry.decorationSize = option.decorationSize;
+    entry.sizeHint =
+            m_sourceDelegate != NULL ?
+                m_sourceDelegate->sizeHint(option, index) :
+                QStyledItemDelegate::sizeHint(option, index);
+    d->m_sizeHintCache.insert(index, entry);
+    return entry.sizeHint;
 }
 
 QString ProxyStyledItemDelegate::displayText(
         const QVariant &value, const QLocale &locale) const
 {
-    if (m_sourceDelegate != NULL)
-        return m_sourceDelegate->displayText(value, locale);
-    return QStyledItemDelegate::displayText(value, locale);
+    internal::DisplayTextKey key;
+    const bool useCache =
+            d->m_isDisplayTextCacheEnabled
+            && internal::toDisplayTextKey(value, locale, &key);
+    if (useCache) {
+        const auto it = d->m_displayTextCache.constFind(key);
+        if (it != d->m_displayTextCache.constEnd())
+            return it.value();
+    }
+
+    const QString text =
+            m_sourceDelegate != NULL ?
+                m_sourceDelegate->displayText(value, locale) :
+                QStyledItemDelegate::displayText(value, locale);
+    if (useCache) {
+        // Keep memory bounded, values displayed are usually far less
+        if (d->m_displayTextCache.size() >= 16384)
+            d->m_displayTextCache.clear();
+        d->m_displayTextCache.insert(key, text);
+    }
+    return text;
 }
 
 QWidget *ProxyStyledItemDelegate::createEditor(
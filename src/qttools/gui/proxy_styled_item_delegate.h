@@ -27,10 +27,19 @@ class QTTOOLS_GUI_EXPORT ProxyStyledItemDelegate : public QStyledItemDelegate
 public:
     ProxyStyledItemDelegate(QObject* parent = NULL);
     ProxyStyledItemDelegate(QStyledItemDelegate* srcDelegate, QObject* parent = NULL);
+    ~ProxyStyledItemDelegate();
 
     QStyledItemDelegate* sourceDelegate() const;
     void setSourceDelegate(QStyledItemDelegate* srcDelegate);
 
+    bool isSizeHintCacheEnabled() const;
+    void setSizeHintCacheEnabled(bool on);
+
+    bool isDisplayTextCacheEnabled() const;
+    void setDisplayTextCacheEnabled(bool on);
+
+    void clearCaches();
+
     void paint(
             QPainter *painter,
             const QStyleOptionViewItem &option,
@@ -59,6 +68,9 @@ public:
 
 private:
     QStyledItemDelegate* m_sourceDelegate;
+
+    class Private;
+    Private* const d;
 };
 
 } // namespace qtgui
@@ -26,6 +26,16 @@ namespace qtgui {
  * \brief Provides automatic preservation of a QComboBox's current item on reset
  *        of a QAbstractItemModel
  *
+ * When the combo box is refilled through several model operations (ex: many
+ * resets, or clear() then insertions), wrap them in a bulk update, so the
+ * current item is saved once at the beginning and restored once at the end :
+ * \code
+ *   {
+ *       qtgui::QComboBoxCurrentItemKeeper::BulkUpdate bulkUpdate(keeper);
+ *       qtgui::QComboBoxUtils::setItems(comboBox, texts, userData);
+ *   }
+ * \endcode
+ *
  * \headerfile qcombo_box_current_item_keeper.h <qttools/gui/qcombo_box_current_item_keeper.h>
  * \ingroup qttools_gui
  *
@@ -35,7 +45,8 @@ QComboBoxCurrentItemKeeper::QComboBoxCurrentItemKeeper(QComboBox* comboBox)
     : QObject(comboBox),
       m_oldCurrentIndex(-1),
       m_oldIdentifierValue(),
-      m_columnForModelRowIdentifier(0)
+      m_columnForModelRowIdentifier(0),
+      m_bulkUpdateDepth(0)
 {
     if (comboBox == NULL)
         return;
@@ -58,10 +69,53 @@ void QComboBoxCurrentItemKeeper::setColumnForModelRowIdentifier(int col)
     m_columnForModelRowIdentifier = col;
 }
 
+/*! Starts a bulk update : model resets are ignored until the matching call to
+ *  endBulkUpdate(), which then restores the current item
+ *
+ *  Calls can be nested, only the outermost ones are effective
+ */
+void QComboBoxCurrentItemKeeper::beginBulkUpdate()
+{
+    if (m_bulkUpdateDepth++ == 0)
+        this->saveCurrentItem();
+}
+
+//! Ends a bulk update started with beginBulkUpdate()
+void QComboBoxCurrentItemKeeper::endBulkUpdate()
+{
+    if (m_bulkUpdateDepth > 0 && --m_bulkUpdateDepth == 0)
+        this->restoreCurrentItem();
+}
+
+bool QComboBoxCurrentItemKeeper::isInBulkUpdate() const
+{
+    return m_bulkUpdateDepth > 0;
+}
+
+/*! \class QComboBoxCurrentItemKeeper::BulkUpdate
+ *  \brief Scoped bulk update of a QComboBoxCurrentItemKeeper object
+ *
+ *  Calls beginBulkUpdate() on construction and endBulkUpdate() on destruction
+ */
+
+QComboBoxCurrentItemKeeper::BulkUpdate::BulkUpdate(QComboBoxCurrentItemKeeper *keeper)
+    : m_keeper(keeper)
+{
+    if (m_keeper != NULL)
+        m_keeper->beginBulkUpdate();
+}
+
+QComboBoxCurrentItemKeeper::BulkUpdate::~BulkUpdate()
+{
+    if (m_keeper != NULL)
+        m_keeper->endBulkUpdate();
+}
+
 void QComboBoxCurrentItemKeeper::onModelAboutToBeReset()
 {
-    m_oldCurrentIndex = this->comboBox()->currentIndex();
-    m_oldIdentifierValue = this->currentIdentifierValue();
+    if (this->isInBulkUpdate())
+        return;
+    this->saveCurrentItem();
 
 #ifdef _TRACE_QComboBoxCurrentItemKeeper_
     qDebug() << "QComboBoxCurrentItemKeeper::onModelAboutToBeReset()";
@@ -71,6 +125,18 @@ void QComboBoxCurrentItemKeeper::onModelAboutToBeReset()
 }
 
 void QComboBoxCurrentItemKeeper::onModelReset()
+{
+    if (!this->isInBulkUpdate())
+        this->restoreCurrentItem();
+}
+
+void QComboBoxCurrentItemKeeper::saveCurrentItem()
+{
+    m_oldCurrentIndex = this->comboBox()->currentIndex();
+    m_oldIdentifierValue = this->currentIdentifierValue();
+}
+
+void QComboBoxCurrentItemKeeper::restoreCurrentItem()
 {
 #ifdef _TRACE_QComboBoxCurrentItemKeeper_
     qDebug() << "QComboBoxCurrentItemKeeper::onModelReset()";
@@ -87,7 +153,8 @@ void QComboBoxCurrentItemKeeper::onModelReset()
     else  {
         // Case when the old index does not match the (new) current index
         const QAbstractItemModel* model = this->comboBox()->model();
-        for (int iRow = 0; iRow < model->rowCount() && newCurrIndex == -1; ++iRow) {
+        const int rowCount = model->rowCount();
+        for (int iRow = 0; iRow < rowCount && newCurrIndex == -1; ++iRow) {
             if (m_oldIdentifierValue == this->identifierValue(iRow))
                 newCurrIndex = iRow;
         }
@@ -32,6 +32,19 @@ public:
     int columnForModelRowIdentifier() const;
     void setColumnForModelRowIdentifier(int col);
 
+    void beginBulkUpdate();
+    void endBulkUpdate();
+    bool isInBulkUpdate() const;
+
+    class BulkUpdate
+    {
+    public:
+        explicit BulkUpdate(QComboBoxCurrentItemKeeper* keeper);
+        ~BulkUpdate();
+    private:
+        QComboBoxCurrentItemKeeper* m_keeper;
+    };
+
 signals:
     void currentIndexChanged(int row);
 
@@ -43,10 +56,13 @@ private:
     QComboBox* comboBox() const;
     QVariant currentIdentifierValue() const;
     QVariant identifierValue(int row) const;
+    void saveCurrentItem();
+    void restoreCurrentItem();
 
     int m_oldCurrentIndex;
     QVariant m_oldIdentifierValue;
     int m_columnForModelRowIdentifier;
+    int m_bulkUpdateDepth;
 };
 
 } // namespace qtgui
@@ -15,6 +15,8 @@
 
 #include "qcombo_box_utils.h"
 
+#include <QtGui/QStandardItemModel>
+
 namespace qtgui {
 
 /*!
@@ -54,4 +56,76 @@ QComboBoxUtils::SignalHighlighted_QString QComboBoxUtils::signalHighlighted_QStr
     return static_cast<QComboBoxUtils::SignalHighlighted_QString>(&QComboBox::highlighted);
 }
 
+/*! Replaces all the items of \p comboBox with \p texts, optionally associated
+ *  to \p userData (Qt::UserRole)
+ *
+ *  When the model of \p comboBox is a QStandardItemModel (the default), all
+ *  items are inserted in one shot (a single QAbstractItemModel::rowsInserted()
+ *  signal), instead of one insertion plus one data change per item with
+ *  QComboBox::addItem().
+ *
+ *  The current item is then restored : it is the item having the same user
+ *  data as the previous current item (or the same text when \p userData is
+ *  empty), or the first item if there is no such item
+ */
+void QComboBoxUtils::setItems(
+        QComboBox *comboBox,
+        const QStringList &texts,
+        const QVariantList &userData)
+{
+    if (comboBox == NULL)
+        return;
+
+    const bool hasUserData = !userData.isEmpty();
+    const int oldCurrentIndex = comboBox->currentIndex();
+    const QVariant oldCurrentKey =
+            hasUserData ?
+                comboBox->currentData() :
+                QVariant(comboBox->currentText());
+    int newCurrentIndex = -1;
+
+    comboBox->clear();
+    QStandardItemModel* model =
+            qobject_cast<QStandardItemModel*>(comboBox->model());
+    if (model != NULL) {
+        const int column = comboBox->modelColumn();
+        QList<QStandardItem*> items;
+        items.reserve(texts.size());
+        for (int i = 0; i < texts.size(); ++i) {
+            QStandardItem* item = new QStandardItem(texts.at(i));
+            if (i < userData.size())
+                item->setData(userData.at(i), Qt::UserRole);
+            items.append(item);
+        }
+        if (column == 0) {
+            model->invisibleRootItem()->appendRows(items);
+        }
+        else {
+            model->insertRows(0, items.size());
+            for (int i = 0; i < items.size(); ++i)
+                model->setItem(i, column, items.at(i));
+        }
+    }
+    else {
+        comboBox->insertItems(0, texts);
+        for (int i = 0; i < texts.size() && i < userData.size(); ++i)
+            comboBox->setItemData(i, userData.at(i), Qt::UserRole);
+    }
+
+    if (oldCurrentIndex != -1) {
+        for (int i = 0; i < texts.size() && newCurrentIndex == -1; ++i) {
+            const QVariant key =
+                    hasUserData ?
+                        userData.value(i) :
+                        QVariant(texts.at(i));
+            if (key == oldCurrentKey)
+                newCurrentIndex = i;
+        }
+    }
+
+    if (newCurrentIndex == -1 && !texts.isEmpty())
+        newCurrentIndex = 0;
+    comboBox->setCurrentIndex(newCurrentIndex);
+}
+
 } // namespace qtgui
@@ -17,6 +17,8 @@
 
 #include "gui.h"
 
+#include <QtCore/QStringList>
+#include <QtCore/QVariant>
 #include <QtWidgets/QComboBox>
 
 namespace qtgui {
@@ -37,6 +39,11 @@ public:
     static SignalCurrentIndexChanged_QString signalCurrentIndexChanged_QString();
     static SignalHighlighted_int signalHighlighted_int();
     static SignalHighlighted_QString signalHighlighted_QString();
+
+    static void setItems(
+            QComboBox* comboBox,
+            const QStringList& texts,
+            const QVariantList& userData = QVariantList());
 };
 
 } // namespace qtgui
@@ -37,6 +37,22 @@ namespace qtgui {
  *   }
  * \endcode
  *
+ * Subtrees known to be of no interest can be pruned with skipChildren(), their
+ * items are then neither visited nor enqueued :
+ * \code
+ *   for (explorer.begin(model->invisibleRootItem());
+ *        !explorer.atEnd();
+ *        explorer.goNext())
+ *   {
+ *     if (!explorer.current()->isEnabled())
+ *       explorer.skipChildren();
+ *   }
+ * \endcode
+ *
+ * An explorer object can be reused for many explorations with begin(), the
+ * storage of pending items is kept so there is no memory allocation once it
+ * has reached the width of the explored trees (see also reserve()).
+ *
  * \headerfile qstandard_item_explorer.h <qttools/gui/qstandard_item_explorer.h>
  * \ingroup qttools_gui
  *
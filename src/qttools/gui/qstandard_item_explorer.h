@@ -31,7 +31,8 @@ struct QStandardItemTreeBfsModel
     template<typename OUT_ITERATOR>
     static void enqueueChildren(OUT_ITERATOR out, QStandardItem* parentItem)
     {
-        for (int row = 0; row < parentItem->rowCount(); ++row) {
+        const int rowCount = parentItem->rowCount();
+        for (int row = 0; row < rowCount; ++row) {
             *out = parentItem->child(row);
             ++out;
         }
@@ -0,0 +1,154 @@
+/****************************************************************************
+**  FougTools
+**  Copyright Fougue (30 Mar. 2015)
+**  contact@fougue.pro
+**
+** This software is a computer program whose purpose is to provide utility
+** tools for the C++ language and the Qt toolkit.
+**
+** This software is governed by the CeCILL-C license under French law and
+** abiding by the rules of distribution of free software.  You can  use,
+** modify and/ or redistribute the software under the terms of the CeCILL-C
+** license as circulated by CEA, CNRS and INRIA at the following URL
+** "http://www.cecill.info".
+****************************************************************************/
+
+
+#pragma once
+
+#include "qstandard_item_tree_snapshot.h"
+#include "../task/parallel_algorithms.h"
+
+#include <QtCore/QHash>
+
+#include <cstddef>
+#include <vector>
+class QStandardItem;
+
+namespace qtgui {
+
+template<typename RESULT, typename FUNC>
+QHash<const QStandardItem*, RESULT> parallelMapItems(
+        qttask::Progress& progress,
+        const QStandardItemTreeSnapshot& snapshot,
+        FUNC fn,
+        std::size_t grainSize = 256,
+        qttask::WorkStealingPool* pool = qttask::WorkStealingPool::globalInstance());
+
+template<typename PREDICATE>
+std::vector<QStandardItem*> parallelFilterItems(
+        qttask::Progress& progress,
+        const QStandardItemTreeSnapshot& snapshot,
+        PREDICATE pred,
+        std::size_t grainSize = 256,
+        qttask::WorkStealingPool* pool = qttask::WorkStealingPool::globalInstance());
+
+
+
+// --
+// -- Implementation
+// --
+
+namespace internal {
+
+//! Result of one item, flag tells if it was computed (chunks can be skipped)
+template<typename T>
+struct ParallelItemResult
+{
+    ParallelItemResult() : value(), isDone(false) { }
+    T value;
+    bool isDone;
+};
+
+} // namespace internal
+
+/*! \brief Calls \p fn(const QStandardItem* item, unsigned depth) concurrently
+ *         on each item of \p snapshot
+ *
+ *  This is typically run by a qttask::Manager task, so the GUI thread is not
+ *  blocked while items are processed. Items are dispatched to \p pool by
+ *  chunks of \p grainSize, see qttask::parallelFor() for progress, abort and
+ *  exception handling.
+ *
+ *  \p fn must only read items (ex: QStandardItem::data()), and the tree must
+ *  not be modified in the meantime.
+ *
+ *  \returns The results of \p fn keyed by item. If the task was aborted,
+ *           items of skipped chunks are missing.
+ *
+ *  \headerfile qstandard_item_parallel.h <qttools/gui/qstandard_item_parallel.h>
+ *  \ingroup qttools_gui
+ */
+template<typename RESULT, typename FUNC>
+QHash<const QStandardItem*, RESULT> parallelMapItems(
+        qttask::Progress& progress,
+        const QStandardItemTreeSnapshot& snapshot,
+        FUNC fn,
+        std::size_t grainSize,
+        qttask::WorkStealingPool* pool)
+{
+    std::vector<internal::ParallelItemResult<RESULT>> itemResults(snapshot.size());
+    qttask::parallelFor(
+                progress,
+                snapshot.size(),
+                grainSize,
+                [&] (std::size_t iBegin, std::size_t iEnd) {
+                    for (std::size_t i = iBegin; i < iEnd; ++i) {
+                        const QStandardItem* item = snapshot.item(i);
+                        itemResults[i].value = fn(item, snapshot.depth(i));
+                        itemResults[i].isDone = true;
+                    }
+                },
+                pool);
+
+    QHash<const QStandardItem*, RESULT> results;
+    results.reserve(static_cast<int>(snapshot.size()));
+    for (std::size_t i = 0; i < itemResults.size(); ++i) {
+        if (itemResults[i].isDone)
+            results.insert(snapshot.item(i), itemResults[i].value);
+    }
+    return results;
+}
+
+/*! \brief Returns the items of \p snapshot satisfying
+ *         \p pred(const QStandardItem* item, unsigned depth), evaluated
+ *         concurrently
+ *
+ *  Items are returned in the order of \p snapshot (BFS). Requirements on
+ *  \p pred and the handling of progress and abort are the same as with
+ *  parallelMapItems()
+ *
+ *  \headerfile qstandard_item_parallel.h <qttools/gui/qstandard_item_parallel.h>
+ *  \ingroup qttools_gui
+ */
+template<typename PREDICATE>
+std::vector<QStandardItem*> parallelFilterItems(
+        qttask::Progress& progress,
+        const QStandardItemTreeSnapshot& snapshot,
+        PREDICATE pred,
+        std::size_t grainSize,
+        qttask::WorkStealingPool* pool)
+{
+    // Not std::vector<bool> : chunks write concurrently
+    std::vector<char> isAccepted(snapshot.size(), 0);
+    qttask::parallelFor(
+                progress,
+                snapshot.size(),
+                grainSize,
+                [&] (std::size_t iBegin, std::size_t iEnd) {
+                    for (std::size_t i = iBegin; i < iEnd; ++i) {
+                        const QStandardItem* item = snapshot.item(i);
+                        isAccepted[i] = pred(item, snapshot.depth(i)) ? 1 : 0;
+                    }
+                },
+                pool);
+
+    std::vector<QStandardItem*> items;
+    for (std::size_t i = 0; i < isAccepted.size(); ++i) {
+        if (isAccepted[i] != 0)
+            items.push_back(snapshot.item(i));
+    }
+    return items;
+}
+
+} // namespace qtgui
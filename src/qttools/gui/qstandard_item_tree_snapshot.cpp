@@ -0,0 +1,152 @@
+/****************************************************************************
+**  FougTools
+**  Copyright Fougue (30 Mar. 2015)
+**  contact@fougue.pro
+**
+** This software is a computer program whose purpose is to provide utility
+** tools for the C++ language and the Qt toolkit.
+**
+** This software is governed by the CeCILL-C license under French law and
+** abiding by the rules of distribution of free software.  You can  use,
+** modify and/ or redistribute the software under the terms of the CeCILL-C
+** license as circulated by CEA, CNRS and INRIA at the following URL
+** "http://www.cecill.info".
+****************************************************************************/
+
+
+#include "qstandard_item_tree_snapshot.h"
+
+#include <QtGui/QStandardItem>
+#include <QtGui/QStandardItemModel>
+
+namespace qtgui {
+
+/*!
+ * \class QStandardItemTreeSnapshot
+ * \brief Flat BFS (breadth-first search) copy of the structure of a tree of
+ *        QStandardItem objects
+ *
+ * The item pointers and their depth are collected in contiguous arrays, by
+ * one BFS pass over the tree. Items can then be processed by index, for
+ * example concurrently with qtgui::parallelMapItems() or
+ * qtgui::parallelFilterItems().
+ *
+ * The snapshot does not track changes of the tree : it must be built again
+ * once items are inserted or removed.
+ *
+ * \headerfile qstandard_item_tree_snapshot.h <qttools/gui/qstandard_item_tree_snapshot.h>
+ * \ingroup qttools_gui
+ */
+
+QStandardItemTreeSnapshot::QStandardItemTreeSnapshot()
+{
+}
+
+QStandardItemTreeSnapshot::QStandardItemTreeSnapshot(QStandardItem *rootItem)
+{
+    this->build(rootItem);
+}
+
+QStandardItemTreeSnapshot::QStandardItemTreeSnapshot(QStandardItemModel *model)
+{
+    this->build(model);
+}
+
+//! Builds the snapshot of \p rootItem and its descendants, \p rootItem is at depth 0
+void QStandardItemTreeSnapshot::build(QStandardItem *rootItem)
+{
+    this->clear();
+    if (rootItem != NULL)
+        this->appendTree(rootItem, true);
+}
+
+/*! Builds the snapshot of all the items of \p model
+ *
+ *  The invisible root item is excluded, top-level items are at depth 0
+ */
+void QStandardItemTreeSnapshot::build(QStandardItemModel *model)
+{
+    this->clear();
+    if (model != NULL)
+        this->appendTree(model->invisibleRootItem(), false);
+}
+
+//! Releases the items of the snapshot (but not the storage)
+void QStandardItemTreeSnapshot::clear()
+{
+    m_items.clear();
+    m_depths.clear();
+}
+
+std::size_t QStandardItemTreeSnapshot::size() const
+{
+    return m_items.size();
+}
+
+bool QStandardItemTreeSnapshot::isEmpty() const
+{
+    return m_items.empty();
+}
+
+//! Item at BFS position \p i
+QStandardItem *QStandardItemTreeSnapshot::item(std::size_t i) const
+{
+    return m_items[i];
+}
+
+//! Depth of the item at BFS position \p i
+unsigned QStandardItemTreeSnapshot::depth(std::size_t i) const
+{
+    return m_depths[i];
+}
+
+const std::vector<QStandardItem*>& QStandardItemTreeSnapshot::items() const
+{
+    return m_items;
+}
+
+const std::vector<unsigned>& QStandardItemTreeSnapshot::depths() const
+{
+    return m_depths;
+}
+
+void QStandardItemTreeSnapshot::appendTree(QStandardItem *rootItem, bool withRoot)
+{
+    // m_items is also the BFS queue : items of depth N+1 are appended while
+    // items of depth N are scanned
+    std::size_t iLevelBegin = m_items.size();
+    unsigned depth = 0;
+    if (withRoot) {
+        m_items.push_back(rootItem);
+        m_depths.push_back(0);
+    }
+    else {
+        const int rowCount = rootItem->rowCount();
+        for (int row = 0; row < rowCount; ++row) {
+            QStandardItem* child = rootItem->child(row);
+            if (child != NULL) {
+                m_items.push_back(child);
+                m_depths.push_back(0);
+            }
+        }
+    }
+
+    while (iLevelBegin < m_items.size()) {
+        const std::size_t iLevelEnd = m_items.size();
+        ++depth;
+        for (std::size_t i = iLevelBegin; i < iLevelEnd; ++i) {
+            const QStandardItem* item = m_items[i];
+            const int rowCount = item->rowCount();
+            for (int row = 0; row < rowCount; ++row) {
+                QStandardItem* child = item->child(row);
+                if (child != NULL) {
+                    m_items.push_back(child);
+                    m_depths.push_back(depth);
+                }
+            }
+        }
+        iLevelBegin = iLevelEnd;
+    }
+}
+
+} // namespace qtgui
@@ -0,0 +1,55 @@
+/****************************************************************************
+**  FougTools
+**  Copyright Fougue (30 Mar. 2015)
+**  contact@fougue.pro
+**
+** This software is a computer program whose purpose is to provide utility
+** tools for the C++ language and the Qt toolkit.
+**
+** This software is governed by the CeCILL-C license under French law and
+** abiding by the rules of distribution of free software.  You can  use,
+** modify and/ or redistribute the software under the terms of the CeCILL-C
+** license as circulated by CEA, CNRS and INRIA at the following URL
+** "http://www.cecill.info".
+****************************************************************************/
+
+
+#pragma once
+
+#include "gui.h"
+
+#include <cstddef>
+#include <vector>
+class QStandardItem;
+class QStandardItemModel;
+
+namespace qtgui {
+
+class QTTOOLS_GUI_EXPORT QStandardItemTreeSnapshot
+{
+public:
+    QStandardItemTreeSnapshot();
+    explicit QStandardItemTreeSnapshot(QStandardItem* rootItem);
+    explicit QStandardItemTreeSnapshot(QStandardItemModel* model);
+
+    void build(QStandardItem* rootItem);
+    void build(QStandardItemModel* model);
+    void clear();
+
+    std::size_t size() const;
+    bool isEmpty() const;
+
+    QStandardItem* item(std::size_t i) const;
+    unsigned depth(std::size_t i) const;
+
+    const std::vector<QStandardItem*>& items() const;
+    const std::vector<unsigned>& depths() const;
+
+private:
+    void appendTree(QStandardItem* rootItem, bool withRoot);
+
+    std::vector<QStandardItem*> m_items;
+    std::vector<unsigned> m_depths;
+};
+
+} // namespace qtgui
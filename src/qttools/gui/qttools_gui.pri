@@ -8,6 +8,7 @@ HEADERS += \
     $$PWD/code_editor.h \
     $$PWD/gui.h \
     $$PWD/indexed_selection_model.h \
+    $$PWD/lazy_tree_model.h \
     $$PWD/length_double_spinbox.h \
     $$PWD/quantity_editor_manager.h \
     $$PWD/line_numbers_bar.h \
@@ -24,6 +25,9 @@ HEADERS += \
     $$PWD/item_view_utils.h \
     $$PWD/qcombo_box_utils.h \
     $$PWD/qwidget_utils.h \
+    $$PWD/qstandard_item_tree_snapshot.h \
+    $$PWD/qstandard_item_parallel.h \
+    $$PWD/length_formatter.h \
     \
     $$PWD/../core/qsignal_mapper_utils.h
 
@@ -31,6 +35,7 @@ SOURCES += \
     $$PWD/abstract_length_editor.cpp \
     $$PWD/code_editor.cpp \
     $$PWD/indexed_selection_model.cpp \
+    $$PWD/lazy_tree_model.cpp \
     $$PWD/length_double_spinbox.cpp \
     $$PWD/quantity_editor_manager.cpp \
     $$PWD/line_numbers_bar.cpp \
@@ -47,5 +52,7 @@ SOURCES += \
     $$PWD/item_view_utils.cpp \
     $$PWD/qcombo_box_utils.cpp \
     $$PWD/qwidget_utils.cpp \
+    $$PWD/qstandard_item_tree_snapshot.cpp \
+    $$PWD/length_formatter.cpp \
     \
     $$PWD/../core/qsignal_mapper_utils.cpp
@@ -17,6 +17,10 @@
 
 #include "abstract_quantity_editor.h"
 
+#include <QtCore/QEvent>
+// QtWidgets
+#include <QWidget>
+
 namespace qtgui {
 
 namespace internal {
@@ -38,6 +42,15 @@ public:
  * \brief Manages a set of AbstractQuantityEditor objects that will get notified
  *        when the current measurement system is changed
  *
+ * When the measurement system is changed, only the editors currently visible
+ * are updated, with repaint of their windows suppressed until all of them are
+ * done. Other editors are updated later, when they are shown (or by an
+ * explicit call to updatePendingEditors()). Meanwhile, a pending editor still
+ * sees the measurement system it is displayed in with
+ * AbstractQuantityEditor::measurementSystem().
+ *
+ * Editors that are not QWidget objects are always updated immediately.
+ *
  * \headerfile quantity_editor_manager.h <qttools/gui/quantity_editor_manager.h>
  * \ingroup qttools_gui
  */
@@ -59,8 +72,10 @@ void QuantityEditorManager::attach(AbstractQuantityEditor* editor)
 
 void QuantityEditorManager::detach(AbstractQuantityEditor* editor)
 {
-    if (editor != NULL)
+    if (editor != NULL) {
         m_qtyEditors.remove(editor);
+        m_pendingEditors.remove(editor);
+    }
 }
 
 Q_GLOBAL_STATIC(internal::QuantityEditorManagerCreator, globalCoreInstance)
@@ -80,10 +95,86 @@ void QuantityEditorManager::setMeasurementSystem(QLocale::MeasurementSystem sys)
     if (sys == m_measureSys)
         return;
 
-    foreach (AbstractQuantityEditor* qtyEditor, m_qtyEditors)
-        qtyEditor->updateEditor(sys);
+    // Editors not already pending keep on displaying the previous system
+    foreach (AbstractQuantityEditor* qtyEditor, m_qtyEditors) {
+        if (!m_pendingEditors.contains(qtyEditor)) {
+            m_pendingEditors.insert(qtyEditor, m_measureSys);
+            QWidget* widget = dynamic_cast<QWidget*>(qtyEditor);
+            if (widget != NULL)
+                widget->installEventFilter(this);
+        }
+    }
     m_measureSys = sys;
+
+    // Update visible editors now, without repaint of their windows in between
+    QList<AbstractQuantityEditor*> nowEditors;
+    QSet<QWidget*> frozenWindows;
+    foreach (AbstractQuantityEditor* qtyEditor, m_qtyEditors) {
+        QWidget* widget = dynamic_cast<QWidget*>(qtyEditor);
+        if (widget == NULL || widget->isVisible()) {
+            nowEditors.append(qtyEditor);
+            QWidget* window = widget != NULL ? widget->window() : NULL;
+            if (window != NULL && window->updatesEnabled()) {
+                window->setUpdatesEnabled(false);
+                frozenWindows.insert(window);
+            }
+        }
+    }
+    foreach (AbstractQuantityEditor* qtyEditor, nowEditors)
+        this->updatePendingEditor(qtyEditor);
+    foreach (QWidget* window, frozenWindows)
+        window->setUpdatesEnabled(true);
+
     emit currentMeasurementSytemChanged(sys);
 }
 
+//! Count of editors not yet updated to the current measurement system
+int QuantityEditorManager::pendingEditorCount() const
+{
+    return m_pendingEditors.size();
+}
+
+//! Updates now all editors not yet updated to the current measurement system
+void QuantityEditorManager::updatePendingEditors()
+{
+    foreach (AbstractQuantityEditor* qtyEditor, m_qtyEditors)
+        this->updatePendingEditor(qtyEditor);
+}
+
+//! Updates pending editors when they are about to be shown
+bool QuantityEditorManager::eventFilter(QObject* watched, QEvent* event)
+{
+    if (event->type() == QEvent::Show) {
+        foreach (AbstractQuantityEditor* qtyEditor, m_qtyEditors) {
+            if (dynamic_cast<QObject*>(qtyEditor) == watched) {
+                this->updatePendingEditor(qtyEditor);
+                break;
+            }
+        }
+    }
+    return QObject::eventFilter(watched, event);
+}
+
+QLocale::MeasurementSystem QuantityEditorManager::editorMeasurementSystem(
+        const AbstractQuantityEditor* editor) const
+{
+    return m_pendingEditors.value(editor, m_measureSys);
+}
+
+void QuantityEditorManager::updatePendingEditor(AbstractQuantityEditor* editor)
+{
+    const auto iPending = m_pendingEditors.find(editor);
+    if (iPending == m_pendingEditors.end())
+        return;
+
+    // Editor stays pending during updateEditor(), so it still sees the
+    // measurement system it was displayed in
+    if (iPending.value() != m_measureSys)
+        editor->updateEditor(m_measureSys);
+    m_pendingEditors.remove(editor);
+    QWidget* widget = dynamic_cast<QWidget*>(editor);
+    if (widget != NULL)
+        widget->removeEventFilter(this);
+}
+
 } // namespace qtgui
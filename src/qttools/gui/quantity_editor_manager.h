@@ -16,6 +16,7 @@
 #pragma once
 
 #include "gui.h"
+#include <QtCore/QHash>
 #include <QtCore/QLocale>
 #include <QtCore/QSet>
 
@@ -42,13 +43,24 @@ public:
     QLocale::MeasurementSystem measurementSytem() const;
     void setMeasurementSystem(QLocale::MeasurementSystem sys);
 
+    int pendingEditorCount() const;
+    void updatePendingEditors();
+
+    bool eventFilter(QObject* watched, QEvent* event) Q_DECL_OVERRIDE;
+
 signals:
     void currentMeasurementSytemChanged(QLocale::MeasurementSystem sys);
 
 private:
     friend class internal::QuantityEditorManagerCreator;
     friend class AbstractQuantityEditor;
+
+    QLocale::MeasurementSystem editorMeasurementSystem(
+            const AbstractQuantityEditor* editor) const;
+    void updatePendingEditor(AbstractQuantityEditor* editor);
+
     QSet<AbstractQuantityEditor*> m_qtyEditors;
+    QHash<const AbstractQuantityEditor*, QLocale::MeasurementSystem> m_pendingEditors;
     QLocale::MeasurementSystem m_measureSys;
 };
 
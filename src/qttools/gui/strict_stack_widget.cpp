@@ -15,7 +15,9 @@
 
 #include "strict_stack_widget.h"
 
+#include <QtCore/QHash>
 #include <QtCore/QStack>
+#include <QtCore/QTimer>
 #include <QStackedWidget>
 #include <QBoxLayout>
 
@@ -24,8 +26,18 @@ namespace qtgui {
 class StrictStackWidget::Private
 {
 public:
+    //! Page created on demand inside a container widget of the stack
+    struct LazyEntry
+    {
+        WidgetFactory factory;
+        QWidget* widget;
+        int hideSerial;
+    };
+
     Private(StrictStackWidget* backPtr)
-        : m_implWidget(backPtr)
+        : m_lazyReleaseDelay(-1),
+          m_backPtr(backPtr),
+          m_implWidget(backPtr)
     {
     }
 
@@ -34,12 +46,73 @@ public:
         return &m_implWidget;
     }
 
+    void setCurrentIndex(int widgetId);
+    QWidget* createLazyWidget(QWidget* container);
+    void releaseLazyWidget(QWidget* container, int hideSerial);
+
     QStack<int> m_stackWidgetId;
+    QHash<QWidget*, LazyEntry> m_lazyEntries;
+    int m_lazyReleaseDelay;
 
 private:
+    StrictStackWidget* m_backPtr;
     QStackedWidget m_implWidget;
 };
 
+/*! Makes widget \p widgetId the current one of the stacked widget, the lazy
+ *  widget becoming current is created (if visible), the one being hidden
+ *  is scheduled for release
+ */
+void StrictStackWidget::Private::setCurrentIndex(int widgetId)
+{
+    QWidget* prevContainer = m_implWidget.currentWidget();
+    QWidget* container = m_implWidget.widget(widgetId);
+    if (container != prevContainer) {
+        auto itPrev = m_lazyEntries.find(prevContainer);
+        if (itPrev != m_lazyEntries.end() && m_lazyReleaseDelay >= 0) {
+            const int hideSerial = ++(itPrev.value().hideSerial);
+            QTimer::singleShot(m_lazyReleaseDelay, prevContainer, [=] {
+                this->releaseLazyWidget(prevContainer, hideSerial);
+            } );
+        }
+    }
+
+    m_implWidget.setCurrentIndex(widgetId);
+    if (m_backPtr->isVisible())
+        this->createLazyWidget(container);
+}
+
+//! Widget of lazy \p container, created if not yet done
+QWidget* StrictStackWidget::Private::createLazyWidget(QWidget* container)
+{
+    auto it = m_lazyEntries.find(container);
+    if (it == m_lazyEntries.end())
+        return container;
+
+    LazyEntry& entry = it.value();
+    if (entry.widget == NULL) {
+        entry.widget = entry.factory();
+        if (entry.widget != NULL)
+            container->layout()->addWidget(entry.widget);
+    }
+    return entry.widget;
+}
+
+void StrictStackWidget::Private::releaseLazyWidget(
+        QWidget* container, int hideSerial)
+{
+    auto it = m_lazyEntries.find(container);
+    if (it == m_lazyEntries.end()
+            || it.value().hideSerial != hideSerial
+            || m_implWidget.currentWidget() == container)
+    {
+        return;
+    }
+
+    delete it.value().widget;
+    it.value().widget = NULL;
+}
+
 /*! \class StrictStackWidget
  *  \brief Provides a stack of widgets similar to QStackedWidget but with
  *         "strict" stack semantics
@@ -51,6 +124,12 @@ private:
  *  When popWidget() is called it destroys the top widget and then makes visible
  *  the previous widget (if any), becoming the new top widget.
  *
+ *  With pushLazyWidget() the widget is created by a factory function only
+ *  when it is first shown, ie. when it is the top widget and the stack is
+ *  visible. So the cost of widgets never shown is not paid. Optionally (see
+ *  setLazyWidgetReleaseDelay()) such widgets are destroyed once hidden for
+ *  some time, to be created again when shown back.
+ *
  *  \headerfile strict_stack_widget.h <qttools/gui/strict_stack_widget.h>
  *  \ingroup qttools_gui
  */
@@ -77,13 +156,41 @@ void StrictStackWidget::pushWidget(QWidget *widget)
     if (widget != NULL) {
         const int widgetId = d->stackWidget()->addWidget(widget);
         d->m_stackWidgetId.push(widgetId);
-        d->stackWidget()->setCurrentIndex(widgetId);
+        d->setCurrentIndex(widgetId);
     }
 }
 
+/*! Adds to the top of the stack a widget to be created by calling \p factory
+ *  once it has to be shown
+ *
+ *  \p factory must return a new widget each time it is called, its ownership
+ *  is taken by the stack
+ */
+void StrictStackWidget::pushLazyWidget(const WidgetFactory &factory)
+{
+    if (!factory)
+        return;
+
+    QWidget* container = new QWidget;
+    QBoxLayout* containerLayout = new QVBoxLayout(container);
+    containerLayout->setContentsMargins(0, 0, 0, 0);
+    Private::LazyEntry entry;
+    entry.factory = factory;
+    entry.widget = NULL;
+    entry.hideSerial = 0;
+    d->m_lazyEntries.insert(container, entry);
+
+    const int widgetId = d->stackWidget()->addWidget(container);
+    d->m_stackWidgetId.push(widgetId);
+    d->setCurrentIndex(widgetId);
+}
+
 /*! Destroys the top widget from the stack
  *
  *  Does nothing if stack is empty
+ *
+ *  For a widget added with pushLazyWidget(), NULL is returned if it was never
+ *  created
  */
 QWidget *StrictStackWidget::popWidget()
 {
@@ -91,8 +198,17 @@ QWidget *StrictStackWidget::popWidget()
         const int widgetId = d->m_stackWidgetId.pop();
         QWidget* widget = d->stackWidget()->widget(widgetId);
         d->stackWidget()->removeWidget(widget);
+        auto itLazy = d->m_lazyEntries.find(widget);
+        if (itLazy != d->m_lazyEntries.end()) {
+            QWidget* container = widget;
+            widget = itLazy.value().widget;
+            d->m_lazyEntries.erase(itLazy);
+            if (widget != NULL)
+                widget->setParent(NULL);
+            delete container;
+        }
         if (!this->isEmpty())
-            d->stackWidget()->setCurrentIndex(d->m_stackWidgetId.top());
+            d->setCurrentIndex(d->m_stackWidgetId.top());
         return widget;
     }
     else {
@@ -113,10 +229,38 @@ bool StrictStackWidget::isEmpty() const
  */
 QWidget *StrictStackWidget::topWidget() const
 {
-    if (!this->isEmpty())
-        return d->stackWidget()->widget(d->m_stackWidgetId.top());
-    else
+    if (!this->isEmpty()) {
+        QWidget* container = d->stackWidget()->widget(d->m_stackWidgetId.top());
+        return d->createLazyWidget(container);
+    }
+    else {
         return NULL;
+    }
+}
+
+/*! \brief Holds the time (in milliseconds) after which a hidden widget added
+ *         with pushLazyWidget() is destroyed
+ *
+ *  It will be created again with its factory when shown back. A negative value
+ *  means hidden lazy widgets are never destroyed.
+ *
+ *  Default value is -1
+ */
+int StrictStackWidget::lazyWidgetReleaseDelay() const
+{
+    return d->m_lazyReleaseDelay;
+}
+
+void StrictStackWidget::setLazyWidgetReleaseDelay(int msecs)
+{
+    d->m_lazyReleaseDelay = msecs;
+}
+
+void StrictStackWidget::showEvent(QShowEvent *event)
+{
+    QWidget::showEvent(event);
+    if (!this->isEmpty())
+        d->createLazyWidget(d->stackWidget()->widget(d->m_stackWidgetId.top()));
 }
 
 } // namespace qtgui
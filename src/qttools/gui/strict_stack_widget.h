@@ -18,6 +18,8 @@
 #include "gui.h"
 #include <QWidget>
 
+#include <functional>
+
 namespace qtgui {
 
 class QTTOOLS_GUI_EXPORT StrictStackWidget : public QWidget
@@ -28,12 +30,21 @@ public:
     StrictStackWidget(QWidget* parent = NULL);
     ~StrictStackWidget();
 
+    typedef std::function<QWidget* ()> WidgetFactory;
+
     void pushWidget(QWidget* widget);
+    void pushLazyWidget(const WidgetFactory& factory);
     QWidget* popWidget();
 
     bool isEmpty() const;
     QWidget* topWidget() const;
 
+    int lazyWidgetReleaseDelay() const;
+    void setLazyWidgetReleaseDelay(int msecs);
+
+protected:
+    void showEvent(QShowEvent* event) Q_DECL_OVERRIDE;
+
 private:
     class Private;
     Private* const d;
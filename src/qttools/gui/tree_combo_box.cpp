@@ -15,17 +15,393 @@
 
 #include "tree_combo_box.h"
 
+#include "lazy_tree_model.h"
+
+#include <QtCore/QAbstractItemModel>
+#include <QtCore/QCoreApplication>
+#include <QtCore/QEvent>
+#include <QtCore/QHash>
+#include <QtCore/QPointer>
+#include <QtCore/QRegExp>
+#include <QtCore/QRunnable>
+#include <QtCore/QThreadPool>
 #include <QtCore/QtDebug>
+// QtGui
+#include <QMouseEvent>
 // QtWidgets
 #include <QHeaderView>
 #include <QTreeView>
 
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <vector>
+
 namespace qtgui {
 
+namespace internal {
+
+/*! Snapshot of the data of a tree model, for one item role
+ *
+ *  Items are stored in the traversal order of QAbstractItemModel::match(), so
+ *  the lowest entry id is the first match. Once built the snapshot is never
+ *  modified, it can then be shared with worker threads (that only read keys
+ *  and values, never modelIndexes)
+ */
+struct TreeSearchIndex
+{
+    std::vector<QModelIndex> modelIndexes;
+    std::vector<QVariant> values;
+    std::vector<QString> keys;
+    std::vector<bool> isRootItem;
+    std::vector<QString> foldedKeys;
+    std::vector<int> sortedEntries; // Entry ids sorted by foldedKeys
+};
+
+typedef std::shared_ptr<const TreeSearchIndex> TreeSearchIndexPtr;
+
+static void buildTreeSearchIndex(
+        TreeSearchIndex* index,
+        const QAbstractItemModel* model,
+        const QModelIndex& parent,
+        int column,
+        int role)
+{
+    const int rowCount = model->rowCount(parent);
+    for (int row = 0; row < rowCount; ++row) {
+        const QModelIndex modelIndex = model->index(row, column, parent);
+        const QVariant value = modelIndex.data(role);
+        index->modelIndexes.push_back(modelIndex);
+        index->values.push_back(value);
+        index->keys.push_back(value.toString());
+        index->isRootItem.push_back(!parent.isValid());
+        // Same as QAbstractItemModel::match() : children are below column 0
+        const QModelIndex childParent =
+                column != 0 ? modelIndex.sibling(row, 0) : modelIndex;
+        if (model->hasChildren(childParent))
+            buildTreeSearchIndex(index, model, childParent, column, role);
+    }
+}
+
+static TreeSearchIndexPtr createTreeSearchIndex(
+        const QAbstractItemModel* model, int column, int role)
+{
+    auto index = std::make_shared<TreeSearchIndex>();
+    buildTreeSearchIndex(index.get(), model, QModelIndex(), column, role);
+
+    const int entryCount = static_cast<int>(index->keys.size());
+    index->foldedKeys.reserve(entryCount);
+    index->sortedEntries.reserve(entryCount);
+    for (int i = 0; i < entryCount; ++i) {
+        index->foldedKeys.push_back(index->keys.at(i).toCaseFolded());
+        index->sortedEntries.push_back(i);
+    }
+    const std::vector<QString>& foldedKeys = index->foldedKeys;
+    std::stable_sort(
+                index->sortedEntries.begin(),
+                index->sortedEntries.end(),
+                [&](int lhs, int rhs) { return foldedKeys.at(lhs) < foldedKeys.at(rhs); });
+    return index;
+}
+
+/*! Matching of entries of a TreeSearchIndex, with the same semantics as
+ *  QAbstractItemModel::match()
+ */
+class TreeSearchMatcher
+{
+public:
+    TreeSearchMatcher(
+            const TreeSearchIndex* index, const QVariant& value, Qt::MatchFlags flags)
+        : m_index(index),
+          m_value(value),
+          m_text(value.toString()),
+          m_flags(flags),
+          m_matchType(flags & 0x0F),
+          m_cs(flags.testFlag(Qt::MatchCaseSensitive) ?
+                   Qt::CaseSensitive : Qt::CaseInsensitive)
+    {
+        if (m_matchType == Qt::MatchRegExp)
+            m_rx = QRegExp(m_text, m_cs);
+        else if (m_matchType == Qt::MatchWildcard)
+            m_rx = QRegExp(m_text, m_cs, QRegExp::Wildcard);
+    }
+
+    //! Ids (in ascending order) of the entries possibly matching
+    std::vector<int> candidateEntries() const
+    {
+        std::vector<int> entries;
+        const bool isKeyLookup =
+                m_matchType == Qt::MatchStartsWith
+                || m_matchType == Qt::MatchFixedString
+                || (m_matchType == Qt::MatchExactly
+                    && m_value.canConvert(QMetaType::QString));
+        if (isKeyLookup) {
+            const QString foldedText = m_text.toCaseFolded();
+            const std::vector<QString>& foldedKeys = m_index->foldedKeys;
+            auto it = std::lower_bound(
+                        m_index->sortedEntries.cbegin(),
+                        m_index->sortedEntries.cend(),
+                        foldedText,
+                        [&](int entry, const QString& text) { return foldedKeys.at(entry) < text; });
+            while (it != m_index->sortedEntries.cend()) {
+                const QString& foldedKey = foldedKeys.at(*it);
+                const bool isCandidate =
+                        m_matchType == Qt::MatchStartsWith ?
+                            foldedKey.startsWith(foldedText) :
+                            foldedKey == foldedText;
+                if (!isCandidate)
+                    break;
+                entries.push_back(*it);
+                ++it;
+            }
+            std::sort(entries.begin(), entries.end());
+        }
+        else {
+            const int entryCount = static_cast<int>(m_index->keys.size());
+            entries.reserve(entryCount);
+            for (int i = 0; i < entryCount; ++i)
+                entries.push_back(i);
+        }
+        return entries;
+    }
+
+    bool matches(int entry)
+    {
+        if (!m_flags.testFlag(Qt::MatchRecursive) && !m_index->isRootItem.at(entry))
+            return false;
+
+        const QString& key = m_index->keys.at(entry);
+        switch (m_matchType) {
+        case Qt::MatchExactly:
+            return m_index->values.at(entry) == m_value;
+        case Qt::MatchRegExp:
+        case Qt::MatchWildcard:
+            return m_rx.exactMatch(key);
+        case Qt::MatchStartsWith:
+            return key.startsWith(m_text, m_cs);
+        case Qt::MatchEndsWith:
+            return key.endsWith(m_text, m_cs);
+        case Qt::MatchFixedString:
+            return key.compare(m_text, m_cs) == 0;
+        case Qt::MatchContains:
+        default:
+            return key.contains(m_text, m_cs);
+        }
+    }
+
+private:
+    const TreeSearchIndex* m_index;
+    const QVariant m_value;
+    const QString m_text;
+    const Qt::MatchFlags m_flags;
+    const int m_matchType;
+    const Qt::CaseSensitivity m_cs;
+    QRegExp m_rx;
+};
+
+//! Batch of matching entries posted by TreeSearchJob to the TreeComboBox
+class TreeSearchResultEvent : public QEvent
+{
+public:
+    TreeSearchResultEvent(int searchId, const TreeSearchIndexPtr& index)
+        : QEvent(TreeSearchResultEvent::eventType()),
+          searchId(searchId),
+          index(index),
+          isLast(false)
+    {
+    }
+
+    static QEvent::Type eventType()
+    {
+        static const int type = QEvent::registerEventType();
+        return static_cast<QEvent::Type>(type);
+    }
+
+    const int searchId;
+    const TreeSearchIndexPtr index;
+    std::vector<int> entries;
+    bool isLast;
+};
+
+//! Matches entries of a TreeSearchIndex in a worker thread
+class TreeSearchJob : public QRunnable
+{
+public:
+    TreeSearchJob(
+            QObject* receiver,
+            const std::atomic<int>* currentSearchId,
+            int searchId,
+            const TreeSearchIndexPtr& index,
+            const QVariant& value,
+            Qt::MatchFlags flags,
+            int hits)
+        : m_receiver(receiver),
+          m_currentSearchId(currentSearchId),
+          m_searchId(searchId),
+          m_index(index),
+          m_value(value),
+          m_flags(flags),
+          m_hits(hits)
+    {
+    }
+
+    void run() override
+    {
+        const std::size_t batchSize = 256;
+        TreeSearchMatcher matcher(m_index.get(), m_value, m_flags);
+        const std::vector<int> candidates = matcher.candidateEntries();
+        int hitCount = 0;
+        auto batch = this->newBatch();
+        for (int entry : candidates) {
+            if (this->isCanceled())
+                return;
+            if (m_hits >= 0 && hitCount >= m_hits)
+                break;
+            if (matcher.matches(entry)) {
+                batch->entries.push_back(entry);
+                ++hitCount;
+            }
+            if (batch->entries.size() >= batchSize) {
+                QCoreApplication::postEvent(m_receiver, batch.release());
+                batch = this->newBatch();
+            }
+        }
+        batch->isLast = true;
+        QCoreApplication::postEvent(m_receiver, batch.release());
+    }
+
+private:
+    bool isCanceled() const
+    {
+        return m_currentSearchId->load() != m_searchId;
+    }
+
+    std::unique_ptr<TreeSearchResultEvent> newBatch() const
+    {
+        return std::unique_ptr<TreeSearchResultEvent>(
+                    new TreeSearchResultEvent(m_searchId, m_index));
+    }
+
+    QObject* m_receiver;
+    const std::atomic<int>* m_currentSearchId;
+    const int m_searchId;
+    const TreeSearchIndexPtr m_index;
+    const QVariant m_value;
+    const Qt::MatchFlags m_flags;
+    const int m_hits;
+};
+
+} // namespace internal
+
+/*! \class TreeComboBox::Private
+ *  \brief Internal (pimpl of TreeComboBox)
+ */
+class TreeComboBox::Private
+{
+public:
+    Private(TreeComboBox* backPtr)
+        : m_backPtr(backPtr),
+          m_isIndexedSearchEnabled(false),
+          m_indexedColumn(-1),
+          m_lastSearchId(0),
+          m_currentSearchId(0)
+    {
+        m_searchThreadPool.setMaxThreadCount(1);
+        // Register event type now, not concurrently from worker threads
+        internal::TreeSearchResultEvent::eventType();
+    }
+
+    internal::TreeSearchIndexPtr searchIndex(int role);
+    void clearSearchIndexes();
+    void syncWithModel();
+    bool isLazyModel() const;
+    bool isSearchIndex(const internal::TreeSearchIndexPtr& index) const;
+
+    TreeComboBox* m_backPtr;
+    bool m_isIndexedSearchEnabled;
+    QPointer<QAbstractItemModel> m_model;
+    int m_indexedColumn;
+    QHash<int, internal::TreeSearchIndexPtr> m_searchIndexes;
+    int m_lastSearchId;
+    std::atomic<int> m_currentSearchId;
+    QThreadPool m_searchThreadPool;
+};
+
+//! Index of the data of \p role, built if not already cached
+internal::TreeSearchIndexPtr TreeComboBox::Private::searchIndex(int role)
+{
+    this->syncWithModel();
+    if (m_indexedColumn != m_backPtr->modelColumn())
+        this->clearSearchIndexes();
+    m_indexedColumn = m_backPtr->modelColumn();
+    auto it = m_searchIndexes.find(role);
+    if (it == m_searchIndexes.end()) {
+        it = m_searchIndexes.insert(
+                    role,
+                    internal::createTreeSearchIndex(m_model, m_indexedColumn, role));
+    }
+    return it.value();
+}
+
+//! Is \p index still the index of some role ? (ie. the model did not change)
+bool TreeComboBox::Private::isSearchIndex(
+        const internal::TreeSearchIndexPtr& index) const
+{
+    for (auto it = m_searchIndexes.constBegin(); it != m_searchIndexes.constEnd(); ++it) {
+        if (it.value() == index)
+            return true;
+    }
+    return false;
+}
+
+//! Is the model populated on demand ? (then it must not be expanded at once)
+bool TreeComboBox::Private::isLazyModel() const
+{
+    return qobject_cast<const LazyTreeModel*>(m_backPtr->model()) != NULL;
+}
+
+void TreeComboBox::Private::clearSearchIndexes()
+{
+    m_searchIndexes.clear();
+}
+
+void TreeComboBox::Private::syncWithModel()
+{
+    QAbstractItemModel* model = m_backPtr->model();
+    if (m_model == model)
+        return;
+
+    if (m_model != NULL)
+        QObject::disconnect(m_model, NULL, m_backPtr, NULL);
+    this->clearSearchIndexes();
+    m_model = model;
+    if (model == NULL)
+        return;
+
+    typedef QAbstractItemModel Model;
+    auto fnClear = [=] { this->clearSearchIndexes(); };
+    QObject::connect(model, &Model::dataChanged, m_backPtr, fnClear);
+    QObject::connect(model, &Model::rowsInserted, m_backPtr, fnClear);
+    QObject::connect(model, &Model::rowsRemoved, m_backPtr, fnClear);
+    QObject::connect(model, &Model::rowsMoved, m_backPtr, fnClear);
+    QObject::connect(model, &Model::columnsInserted, m_backPtr, fnClear);
+    QObject::connect(model, &Model::columnsRemoved, m_backPtr, fnClear);
+    QObject::connect(model, &Model::columnsMoved, m_backPtr, fnClear);
+    QObject::connect(model, &Model::layoutChanged, m_backPtr, fnClear);
+    QObject::connect(model, &Model::modelReset, m_backPtr, fnClear);
+}
+
 /*!
  * \class TreeComboBox
  * \brief Provides a QComboBox able to display a tree model item
  *
+ * Searching with treeFindData() can be backed by an index of the model data
+ * (see setIndexedSearchEnabled()), and treeFindDataAsync() runs matching in a
+ * worker thread, which keeps type-ahead over large trees responsive.
+ *
+ * With a LazyTreeModel, the popup is not fully expanded (only the ancestors of
+ * the current item are), items are then loaded as the user expands them.
+ *
  * \headerfile tree_combo_box.h <qttools/gui/tree_combo_box.h>
  * \ingroup qttools_gui
  *
@@ -35,21 +411,55 @@ namespace qtgui {
  *  Example of how to use class qtgui::TreeComboBox
  */
 
+/*! \fn void TreeComboBox::treeFindDataAsyncResults(int searchId, const QModelIndexList& indexes)
+ *  \brief This signal is emitted each time a batch of items matching search
+ *         \p searchId is available, in the order of treeFindData()
+ *
+ *  \sa treeFindDataAsync()
+ */
+
+/*! \fn void TreeComboBox::treeFindDataAsyncFinished(int searchId)
+ *  \brief This signal is emitted when search \p searchId is complete
+ *
+ *  It is not emitted for canceled searches, nor if the model changed while
+ *  searching.
+ */
+
 TreeComboBox::TreeComboBox(QWidget *parent)
-    : QComboBox(parent)
+    : QComboBox(parent),
+      d(new Private(this))
 {
     QTreeView* treeView = new QTreeView(this);
     treeView->setEditTriggers(QTreeView::NoEditTriggers);
     treeView->setSelectionBehavior(QTreeView::SelectRows);
     treeView->header()->setVisible(false);
     this->setView(treeView);
+    // Installed after the filter of the popup container, so called before it
+    treeView->viewport()->installEventFilter(this);
+}
+
+TreeComboBox::~TreeComboBox()
+{
+    this->cancelTreeFindDataAsync();
+    d->m_searchThreadPool.waitForDone();
+    delete d;
 }
 
 void TreeComboBox::showPopup()
 {
+    const QModelIndex currentModelIndex = this->currentModelIndex();
     this->setRootModelIndex(QModelIndex());
-    this->treeView()->expandAll();
-    this->treeView()->setItemsExpandable(false);
+    QTreeView* treeView = this->treeView();
+    if (d->isLazyModel()) {
+        // Expanding all would load the whole hierarchy
+        treeView->setItemsExpandable(true);
+        for (QModelIndex it = currentModelIndex.parent(); it.isValid(); it = it.parent())
+            treeView->expand(it);
+    }
+    else {
+        treeView->expandAll();
+        treeView->setItemsExpandable(false);
+    }
     QComboBox::showPopup();
 }
 
@@ -61,12 +471,31 @@ QTreeView *TreeComboBox::treeView() const
 
 /*! Similar to QComboBox::findData() but searches recursively in the tree
  *  model (instead of just root items)
+ *
+ *  If isIndexedSearchEnabled() then the search is done in the cached index of
+ *  \p role data : items are looked up by binary search for Qt::MatchExactly,
+ *  Qt::MatchFixedString and Qt::MatchStartsWith, other match types scan the
+ *  cached data without calling QAbstractItemModel::data()
+ *
+ *  With a LazyTreeModel, the search always goes through LazyTreeModel::match()
+ *  so items not loaded yet are found too (the indexed search is not used)
  */
 QModelIndex TreeComboBox::treeFindData(
         const QVariant &data, int role, Qt::MatchFlags flags) const
 {
     if (this->model() == NULL)
         return QModelIndex();
+
+    if (d->m_isIndexedSearchEnabled && !d->isLazyModel()) {
+        const internal::TreeSearchIndexPtr index = d->searchIndex(role);
+        internal::TreeSearchMatcher matcher(index.get(), data, flags);
+        for (int entry : matcher.candidateEntries()) {
+            if (matcher.matches(entry))
+                return index->modelIndexes.at(entry);
+        }
+        return QModelIndex();
+    }
+
     const QModelIndex startId =
             this->model()->index(0, this->modelColumn(), QModelIndex());
     const QModelIndexList matchIds =
@@ -74,6 +503,67 @@ QModelIndex TreeComboBox::treeFindData(
     return !matchIds.isEmpty() ? matchIds.first() : QModelIndex();
 }
 
+/*! \brief Holds whether treeFindData() searches in an index of the model data
+ *
+ *  The index of some item role is built by the first search on this role,
+ *  it is then reused until the model signals any change (data, rows, columns,
+ *  layout or reset) or modelColumn() changes.
+ *
+ *  Default value is \c false
+ */
+bool TreeComboBox::isIndexedSearchEnabled() const
+{
+    return d->m_isIndexedSearchEnabled;
+}
+
+void TreeComboBox::setIndexedSearchEnabled(bool on)
+{
+    d->m_isIndexedSearchEnabled = on;
+    if (!on)
+        d->clearSearchIndexes();
+}
+
+/*! Same as treeFindData() but matching runs in a worker thread, and at most
+ *  \p hits matching items are reported (-1 means all of them)
+ *
+ *  Matching items are reported by batches with treeFindDataAsyncResults(),
+ *  then treeFindDataAsyncFinished() is emitted.
+ *
+ *  The index of \p role data is built (or reused) in the calling thread, so
+ *  the model is never accessed from the worker thread. Starting a new search
+ *  cancels the previous one.
+ *  With a LazyTreeModel, only the items loaded so far are searched.
+ *
+ *  \returns The identifier of the search, passed to signals
+ */
+int TreeComboBox::treeFindDataAsync(
+        const QVariant &data, int role, Qt::MatchFlags flags, int hits)
+{
+    const int searchId = ++(d->m_lastSearchId);
+    d->m_currentSearchId.store(searchId);
+    if (this->model() == NULL) {
+        emit treeFindDataAsyncFinished(searchId);
+        return searchId;
+    }
+
+    d->m_searchThreadPool.start(
+                new internal::TreeSearchJob(
+                    this,
+                    &d->m_currentSearchId,
+                    searchId,
+                    d->searchIndex(role),
+                    data,
+                    flags,
+                    hits));
+    return searchId;
+}
+
+//! Cancels the search started with treeFindDataAsync(), if any
+void TreeComboBox::cancelTreeFindDataAsync()
+{
+    d->m_currentSearchId.store(0);
+}
+
 /*! \brief Holds the QModelIndex of the current item in the TreeComboBox
  */
 QModelIndex TreeComboBox::currentModelIndex() const
@@ -96,4 +586,48 @@ void TreeComboBox::setCurrentModelIndex(const QModelIndex &modelIndex)
     this->setCurrentIndex(modelIndex.row());
 }
 
+bool TreeComboBox::event(QEvent *event)
+{
+    if (event->type() == internal::TreeSearchResultEvent::eventType()) {
+        auto resultEvent = static_cast<internal::TreeSearchResultEvent*>(event);
+        const int searchId = resultEvent->searchId;
+        // Results are stale if the search was canceled or the model changed
+        const bool isStale =
+                searchId != d->m_currentSearchId.load()
+                || !d->isSearchIndex(resultEvent->index);
+        if (!isStale) {
+            if (!resultEvent->entries.empty()) {
+                QModelIndexList indexes;
+                indexes.reserve(static_cast<int>(resultEvent->entries.size()));
+                for (int entry : resultEvent->entries)
+                    indexes.append(resultEvent->index->modelIndexes.at(entry));
+                emit treeFindDataAsyncResults(searchId, indexes);
+            }
+            if (resultEvent->isLast)
+                emit treeFindDataAsyncFinished(searchId);
+        }
+        return true;
+    }
+    return QComboBox::event(event);
+}
+
+bool TreeComboBox::eventFilter(QObject* watched, QEvent* event)
+{
+    // When items are expandable (LazyTreeModel), a click on the branch
+    // indicator expands the item : the mouse release must not reach the popup
+    // container, that would select the item and close the popup
+    const QTreeView* treeView = this->treeView();
+    if (treeView != NULL
+            && watched == treeView->viewport()
+            && treeView->itemsExpandable()
+            && event->type() == QEvent::MouseButtonRelease)
+    {
+        const QPoint pos = static_cast<QMouseEvent*>(event)->pos();
+        const QModelIndex index = treeView->indexAt(pos);
+        if (index.isValid() && pos.x() < treeView->visualRect(index).x())
+            return true;
+    }
+    return QComboBox::eventFilter(watched, event);
+}
+
 } // namespace qtgui
@@ -20,6 +20,7 @@
 #include <QtCore/QModelIndex>
 // QtWidgets
 #include <QComboBox>
+class QEvent;
 class QTreeView;
 
 namespace qtgui {
@@ -28,9 +29,11 @@ class QTTOOLS_GUI_EXPORT TreeComboBox : public QComboBox
 {
     Q_OBJECT
     Q_PROPERTY(QModelIndex currentModelIndex READ currentModelIndex WRITE setCurrentModelIndex)
+    Q_PROPERTY(bool indexedSearchEnabled READ isIndexedSearchEnabled WRITE setIndexedSearchEnabled)
 
 public:
     TreeComboBox(QWidget *parent = NULL);
+    ~TreeComboBox();
 
     void showPopup() Q_DECL_OVERRIDE;
 
@@ -41,8 +44,30 @@ public:
             int role = Qt::UserRole,
             Qt::MatchFlags flags = Qt::MatchRecursive) const;
 
+    bool isIndexedSearchEnabled() const;
+    void setIndexedSearchEnabled(bool on);
+
+    int treeFindDataAsync(
+            const QVariant& data,
+            int role = Qt::UserRole,
+            Qt::MatchFlags flags = Qt::MatchRecursive,
+            int hits = -1);
+    void cancelTreeFindDataAsync();
+
     QModelIndex currentModelIndex() const;
     Q_SLOT void setCurrentModelIndex(const QModelIndex& modelIndex);
+
+signals:
+    void treeFindDataAsyncResults(int searchId, const QModelIndexList& indexes);
+    void treeFindDataAsyncFinished(int searchId);
+
+protected:
+    bool event(QEvent* event) Q_DECL_OVERRIDE;
+    bool eventFilter(QObject* watched, QEvent* event) Q_DECL_OVERRIDE;
+
+private:
+    class Private;
+    Private* const d;
 };
 
 } // namespace qtgui
@@ -34,21 +34,47 @@ public:
           m_progressBar(NULL),
           m_btnBox(NULL),
           m_updateTimer(new QTimer(parent)),
-          m_minDuration(1000)
+          m_showTimer(new QTimer(parent)),
+          m_minDuration(1000),
+          m_isWaiting(false),
+          m_taskMgr(NULL),
+          m_taskId(0)
     {
     }
 
+    void disconnectTask(WaitDialog* dialog);
+
     QLabel* m_waitLabel;
     QProgressBar* m_progressBar;
     QDialogButtonBox* m_btnBox;
     QTimer* m_updateTimer;
+    QTimer* m_showTimer;
     int m_minDuration;
+    bool m_isWaiting;
+    const QObject* m_taskMgr;
+    quint64 m_taskId;
 };
 
+void WaitDialog::Private::disconnectTask(WaitDialog* dialog)
+{
+    if (m_taskMgr != NULL)
+        QObject::disconnect(m_taskMgr, NULL, dialog, NULL);
+    m_taskMgr = NULL;
+    m_taskId = 0;
+}
+
 /*!
  * \class WaitDialog
  * \brief Provides a dialog for long background operations
  *
+ * With startWait() the progress bar is animated by a timer, as the actual
+ * progress is unknown.
+ *
+ * With waitForTask() the progress bar follows the progress signals of a
+ * qttask::Manager task, and the dialog is closed when the task ends. No timer
+ * runs meanwhile (except once to honor minimum duration), and the dialog is
+ * repainted only when the progress value or step title really changes.
+ *
  * \headerfile wait_dialog.h <qttools/gui/wait_dialog.h>
  * \ingroup qttools_gui
  *
@@ -80,6 +106,8 @@ WaitDialog::WaitDialog(QWidget* parent)
     this->setWindowModality(Qt::ApplicationModal);
     QObject::connect(d->m_updateTimer, &QTimer::timeout, this, &WaitDialog::updateProgress);
     d->m_updateTimer->setInterval(500);
+    d->m_showTimer->setSingleShot(true);
+    QObject::connect(d->m_showTimer, &QTimer::timeout, this, &WaitDialog::showIfWaiting);
 }
 
 WaitDialog::~WaitDialog()
@@ -91,7 +119,7 @@ WaitDialog::~WaitDialog()
 
 bool WaitDialog::isWaiting() const
 {
-    return d->m_updateTimer->isActive();
+    return d->m_isWaiting;
 }
 
 void WaitDialog::setWaitLabel(const QString& text)
@@ -108,13 +136,45 @@ void WaitDialog::startWait()
 {
     if (this->isWaiting())
         return;
+    d->m_isWaiting = true;
     d->m_progressBar->setValue(0);
     d->m_updateTimer->start();
 }
 
+/*! Waits for the end of task \p taskId, started from \p taskMgr
+ *
+ *  \p taskMgr must be a qttask::Manager object. The dialog shows (after the
+ *  minimum duration) the progress of the task, it is closed on signal
+ *  qttask::Manager::ended()
+ *
+ *  Does nothing if already waiting
+ */
+void WaitDialog::waitForTask(const QObject* taskMgr, quint64 taskId)
+{
+    if (this->isWaiting() || taskMgr == NULL)
+        return;
+
+    d->m_isWaiting = true;
+    d->m_taskMgr = taskMgr;
+    d->m_taskId = taskId;
+    d->m_progressBar->setRange(0, 100);
+    d->m_progressBar->setValue(0);
+    // String-based connections : no link dependency on the qttask module
+    QObject::connect(taskMgr, SIGNAL(progressStep(quint64,QString)),
+                     this, SLOT(onTaskProgressStep(quint64,QString)));
+    QObject::connect(taskMgr, SIGNAL(progress(quint64,int)),
+                     this, SLOT(onTaskProgress(quint64,int)));
+    QObject::connect(taskMgr, SIGNAL(ended(quint64)),
+                     this, SLOT(onTaskEnded(quint64)));
+    d->m_showTimer->start(d->m_minDuration);
+}
+
 void WaitDialog::stopWait()
 {
+    d->m_isWaiting = false;
     d->m_updateTimer->stop();
+    d->m_showTimer->stop();
+    d->disconnectTask(this);
     this->close();
 }
 
@@ -133,4 +193,28 @@ void WaitDialog::updateProgress()
     QApplication::processEvents();
 }
 
+void WaitDialog::showIfWaiting()
+{
+    if (this->isWaiting() && !this->isVisible())
+        this->show();
+}
+
+void WaitDialog::onTaskProgressStep(quint64 taskId, const QString& title)
+{
+    if (taskId == d->m_taskId && !title.isEmpty() && title != d->m_waitLabel->text())
+        d->m_waitLabel->setText(title);
+}
+
+void WaitDialog::onTaskProgress(quint64 taskId, int pct)
+{
+    if (taskId == d->m_taskId && pct != d->m_progressBar->value())
+        d->m_progressBar->setValue(pct);
+}
+
+void WaitDialog::onTaskEnded(quint64 taskId)
+{
+    if (taskId == d->m_taskId)
+        this->stopWait();
+}
+
 } // namespace qtgui
@@ -35,10 +35,15 @@ public slots:
     void setWaitLabel(const QString& text);
     void setMinimumDuration(int msecs);
     void startWait();
+    void waitForTask(const QObject* taskMgr, quint64 taskId);
     void stopWait();
 
 private slots:
     void updateProgress();
+    void showIfWaiting();
+    void onTaskProgressStep(quint64 taskId, const QString& title);
+    void onTaskProgress(quint64 taskId, int pct);
+    void onTaskEnded(quint64 taskId);
 
 private:
     class Private;
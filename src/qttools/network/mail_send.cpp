@@ -17,7 +17,9 @@
 
 #include "message.h"
 #include "smtp_account.h"
+#include <QtCore/QIODevice>
 #include <QtCore/QRegExp>
+#include <QtCore/QUuid>
 #include <QtNetwork/QNetworkProxy>
 #ifndef QT_NO_SSL
 # include <QtNetwork/QSslSocket>
@@ -38,6 +40,141 @@
 
 namespace qtnetwork {
 
+namespace internal {
+
+/*! Writes the contents of a SMTP DATA command
+ *
+ *  Dot-stuffing (RFC 5321, section 4.5.2) and CRLF line endings are applied on
+ *  the fly. Output is flushed as soon as it exceeds some threshold, so memory
+ *  use does not depend on the size of the message
+ */
+class SmtpDataWriter
+{
+public:
+    SmtpDataWriter(QIODevice* socket, int timeout)
+        : m_socket(socket),
+          m_timeout(timeout),
+          m_isAtLineStart(true),
+          m_lastChar(0)
+    { }
+
+    bool writeText(const QByteArray& text)
+    {
+        QByteArray out;
+        out.reserve(text.size() + text.size() / 32 + 2);
+        for (int i = 0; i < text.size(); ++i) {
+            const char c = text.at(i);
+            if (m_isAtLineStart && c == '.')
+                out.append('.');
+            if (c == '\n' && m_lastChar != '\r')
+                out.append('\r');
+            out.append(c);
+            m_isAtLineStart = c == '\n';
+            m_lastChar = c;
+        }
+        return this->writeRaw(out);
+    }
+
+    bool writeText(const char* text)
+    {
+        return this->writeText(QByteArray(text));
+    }
+
+    bool writeTextFrom(QIODevice* device)
+    {
+        QByteArray chunk;
+        while (this->readChunk(device, 16 * 1024, &chunk)) {
+            if (!this->writeText(chunk))
+                return false;
+        }
+        return true;
+    }
+
+    //! Writes contents of \p device encoded as base64, in lines of 76 chars
+    bool writeBase64From(QIODevice* device)
+    {
+        // 57 input bytes give exactly one line of 76 base64 chars
+        QByteArray chunk;
+        while (this->readChunk(device, 57 * 256, &chunk)) {
+            const QByteArray base64 = chunk.toBase64();
+            QByteArray out;
+            out.reserve(base64.size() + (base64.size() / 76 + 1) * 2);
+            for (int pos = 0; pos < base64.size(); pos += 76) {
+                out.append(base64.constData() + pos, qMin(76, base64.size() - pos));
+                out.append("\r\n");
+            }
+            m_isAtLineStart = true;
+            m_lastChar = '\n';
+            if (!this->writeRaw(out))
+                return false;
+        }
+        return true;
+    }
+
+    bool endLine()
+    {
+        return m_isAtLineStart || this->writeText("\r\n");
+    }
+
+    //! Writes the end of data marker, then waits for all data to be written
+    bool finish()
+    {
+        if (!this->endLine() || !this->writeRaw(".\r\n"))
+            return false;
+        while (m_socket->bytesToWrite() > 0) {
+            if (!m_socket->waitForBytesWritten(m_timeout))
+                return false;
+        }
+        return true;
+    }
+
+private:
+    bool writeRaw(const QByteArray& data)
+    {
+        if (m_socket->write(data) != data.size())
+            return false;
+        while (m_socket->bytesToWrite() > 256 * 1024) {
+            if (!m_socket->waitForBytesWritten(m_timeout))
+                return false;
+        }
+        return true;
+    }
+
+    //! Reads \p size bytes (less at the end of \p device), false if none
+    bool readChunk(QIODevice* device, int size, QByteArray* chunk) const
+    {
+        chunk->clear();
+        while (chunk->size() < size) {
+            const QByteArray part = device->read(size - chunk->size());
+            if (part.isEmpty()) {
+                if (device->atEnd() || !device->waitForReadyRead(m_timeout))
+                    break;
+            }
+            chunk->append(part);
+        }
+        return !chunk->isEmpty();
+    }
+
+    QIODevice* m_socket;
+    const int m_timeout;
+    bool m_isAtLineStart;
+    char m_lastChar;
+};
+
+//! Makes \p device ready to be read from its start
+static bool prepareSourceDevice(QIODevice* device)
+{
+    if (device == NULL)
+        return false;
+    if (!device->isOpen() && !device->open(QIODevice::ReadOnly))
+        return false;
+    if (!device->isReadable())
+        return false;
+    return device->isSequential() || device->seek(0);
+}
+
+} // namespace internal
+
 /*! \class MailSend::Private
  *  \brief Private (pimpl of MailSend)
  */
@@ -53,11 +190,22 @@ public:
       #else
         : m_socket(new QTcpSocket(this)),
       #endif // !QT_NO_SSL
-          m_timeout(30000)
+          m_timeout(30000),
+          m_isPipeliningEnabled(true),
+          m_isPipeliningSupported(false)
     {
     }
 
-    bool sendSmtpCommand(const QByteArray& cmd, int expectedCode)
+    struct SmtpCommand
+    {
+        SmtpCommand(const QByteArray& text_, int expectedCode_)
+            : text(text_), expectedCode(expectedCode_)
+        { }
+        QByteArray text;
+        int expectedCode;
+    };
+
+    bool writeSmtpCommand(const QByteArray& cmd)
     {
 #ifdef QTTOOLS_MAILSEND_TRACE
         qDebug() << "C :" << cmd;
@@ -67,21 +215,47 @@ public:
             m_error = tr("Failed to write command '%1'").arg(QString(cmd));
             return false;
         }
+        return true;
+    }
+
+    bool flushSmtpCommand(const QByteArray& cmd)
+    {
         if (!m_socket->waitForBytesWritten(m_timeout)) {
             //: %1: SMTP client command
             m_error = tr("Failed to write command '%1' (timeout)").arg(QString(cmd));
             return false;
         }
-        if (!m_socket->waitForReadyRead(m_timeout)) {
-            //: %1: SMTP client command
-            m_error = tr("Failed to read response for command '%1' (timeout)").arg(QString(cmd));
-            return false;
-        }
+        return true;
+    }
 
-        const QByteArray response(m_socket->readAll());
+    /*! Reads the complete reply to \p cmd, possibly made of several lines
+     *  ("<code>-<text>" lines ended by a "<code> <text>" line)
+     */
+    bool readSmtpReply(const QByteArray& cmd, QByteArray* response)
+    {
+        response->clear();
+        bool isLastLine = false;
+        while (!isLastLine) {
+            while (!m_socket->canReadLine()) {
+                if (!m_socket->waitForReadyRead(m_timeout)) {
+                    //: %1: SMTP client command
+                    m_error = tr("Failed to read response for command '%1' (timeout)")
+                            .arg(QString(cmd));
+                    return false;
+                }
+            }
+            const QByteArray line(m_socket->readLine());
+            response->append(line);
+            isLastLine = line.size() < 4 || line.at(3) != '-';
+        }
 #ifdef QTTOOLS_MAILSEND_TRACE
-        qDebug() << "S:" << response;
+        qDebug() << "S:" << *response;
 #endif // QTTOOLS_MAILSEND_TRACE
+        return true;
+    }
+
+    bool checkSmtpReply(const QByteArray& response, int expectedCode)
+    {
         QRegExp codeRx(QLatin1String("^\\s*([0-9]+)"));
         const int responseCode = codeRx.indexIn(response) != -1 ? codeRx.cap(1).toInt() : -1;
         if (responseCode == -1) {
@@ -96,11 +270,106 @@ public:
         return responseCode == expectedCode && responseCode != -1;
     }
 
+    bool receiveSmtpReply(
+            const QByteArray& cmd, int expectedCode, QByteArray* reply = NULL)
+    {
+        QByteArray response;
+        const bool ok =
+                this->readSmtpReply(cmd, &response)
+                && this->checkSmtpReply(response, expectedCode);
+        if (reply != NULL)
+            *reply = response;
+        return ok;
+    }
+
+    bool sendSmtpCommand(
+            const QByteArray& cmd, int expectedCode, QByteArray* reply = NULL)
+    {
+        return this->writeSmtpCommand(cmd)
+                && this->flushSmtpCommand(cmd)
+                && this->receiveSmtpReply(cmd, expectedCode, reply);
+    }
+
     bool sendSmtpCommand(const char* cmd, int expectedCode)
     {
         return this->sendSmtpCommand(QByteArray(cmd), expectedCode);
     }
 
+    /*! Sends commands \p cmds in sequence, each one waiting for the reply of
+     *  the previous one
+     *
+     *  When pipelining (RFC 2920) is available, \p cmds are all written at once
+     *  and then the replies are read in sequence. All replies are consumed even
+     *  after a failure, so the SMTP session stays synchronized.
+     *
+     *  \note Only the last command of \p cmds can be DATA
+     */
+    bool sendSmtpCommands(const QList<SmtpCommand>& cmds)
+    {
+        if (!this->isPipeliningUsed()) {
+            foreach (const SmtpCommand& cmd, cmds) {
+                if (!this->sendSmtpCommand(cmd.text, cmd.expectedCode))
+                    return false;
+            }
+            return true;
+        }
+
+        if (cmds.isEmpty())
+            return true;
+        foreach (const SmtpCommand& cmd, cmds) {
+            if (!this->writeSmtpCommand(cmd.text))
+                return false;
+        }
+        if (!this->flushSmtpCommand(cmds.last().text))
+            return false;
+
+        QString firstError;
+        bool lastCmdOk = false;
+        for (int i = 0; i < cmds.size(); ++i) {
+            const SmtpCommand& cmd = cmds.at(i);
+            QByteArray response;
+            if (!this->readSmtpReply(cmd.text, &response))
+                return false; // Session is out of sync, no way to recover
+            const bool cmdOk = this->checkSmtpReply(response, cmd.expectedCode);
+            if (!cmdOk && firstError.isEmpty())
+                firstError = m_error;
+            if (i == cmds.size() - 1)
+                lastCmdOk = cmdOk;
+        }
+
+        if (!firstError.isEmpty()) {
+            // The server may have accepted DATA despite previous failures, so
+            // terminate the (empty) mail data
+            if (lastCmdOk && cmds.last().expectedCode == 354)
+                this->sendSmtpCommand(".", 250);
+            m_error = firstError;
+            return false;
+        }
+        return true;
+    }
+
+    bool isPipeliningUsed() const
+    {
+        return m_isPipeliningEnabled && m_isPipeliningSupported;
+    }
+
+    //! Sends EHLO (or HELO as a fallback) and gets the server extensions
+    bool sayHello()
+    {
+        m_isPipeliningSupported = false;
+        QByteArray reply;
+        if (this->sendSmtpCommand("EHLO qtnetwork::MailSend", 250, &reply)) {
+            foreach (const QByteArray& line, reply.split('\n')) {
+                const QByteArray keyword =
+                        line.mid(4).trimmed().split(' ').first().toUpper();
+                if (keyword == "PIPELINING")
+                    m_isPipeliningSupported = true;
+            }
+            return true;
+        }
+        return this->sendSmtpCommand("HELO qtnetwork::MailSend", 250);
+    }
+
 #ifndef QT_NO_SSL
     QSslSocket* m_socket;
 #else
@@ -110,6 +379,8 @@ public:
     SmtpAccount m_smtpAccount;
     int m_timeout;
     QString m_error;
+    bool m_isPipeliningEnabled;
+    bool m_isPipeliningSupported;
 
 private slots:
     void onProxyAuthenticationRequired(const QNetworkProxy& proxy, QAuthenticator* auth)
@@ -134,6 +405,10 @@ MailSend::MailSend()
 
 MailSend::~MailSend()
 {
+    if (this->isConnected()) {
+        if (d->writeSmtpCommand("QUIT"))
+            d->m_socket->waitForBytesWritten(this->timeout());
+    }
     d->m_socket->disconnectFromHost();
     delete d;
 }
@@ -154,6 +429,26 @@ void MailSend::setTimeout(int msecs)
     d->m_timeout = msecs;
 }
 
+/*! \brief Whether SMTP command pipelining (RFC 2920) is used when the server
+ *         supports it
+ *
+ *  When used, the envelope commands of sendMessage() (MAIL FROM, all RCPT TO
+ *  and DATA) are sent in a single batch, saving one round trip per recipient.
+ *
+ *  Pipelining is enabled by default
+ *
+ *  \sa setPipeliningEnabled()
+ */
+bool MailSend::isPipeliningEnabled() const
+{
+    return d->m_isPipeliningEnabled;
+}
+
+void MailSend::setPipeliningEnabled(bool on)
+{
+    d->m_isPipeliningEnabled = on;
+}
+
 /*! \brief Try to connect to SMTP server using \p account
  *
  *  On failure, the error can be reported by errorString()
@@ -191,15 +486,12 @@ bool MailSend::connectToSmtpServer(const SmtpAccount& account)
                                  "connection\n%1").arg(d->m_socket->errorString());
         return false;
     }
-#ifdef QTTOOLS_MAILSEND_TRACE
-    qDebug() << "S:" << d->m_socket->readAll();
-#endif // QTTOOLS_MAILSEND_TRACE
+    if (!d->receiveSmtpReply(QByteArray(), 220))
+        return false;
 
     // Hello to the SMTP server
-    if (!d->sendSmtpCommand("EHLO qtnetwork::MailSend", 250)) {
-        if (!d->sendSmtpCommand("HELO qtnetwork::MailSend", 250))
-            return false;
-    }
+    if (!d->sayHello())
+        return false;
 
     // Initiate TLS if required
     if (account.connectionSecurity() == SmtpAccount::StartTlsSecurity) {
@@ -212,6 +504,10 @@ bool MailSend::connectToSmtpServer(const SmtpAccount& account)
         if (!d->sendSmtpCommand("STARTTLS", 220))
             return false;
         d->m_socket->startClientEncryption();
+        // Server extensions must be queried again once TLS is negotiated
+        // (RFC 3207)
+        if (!d->sayHello())
+            return false;
 #else
         d->m_error = Private::tr("SSL support is disabled in Qt");
         return false;
@@ -252,7 +548,36 @@ bool MailSend::connectToSmtpServer(const SmtpAccount& account)
     return true;
 }
 
+/*! \brief Whether the connection with the SMTP server is established
+ *
+ *  \sa connectToSmtpServer()
+ */
+bool MailSend::isConnected() const
+{
+    return d->m_socket->state() == QAbstractSocket::ConnectedState;
+}
+
+/*! \brief Ends the SMTP session (QUIT) and closes the connection
+ *
+ *  This is also done on destruction, but without waiting for the reply of
+ *  the SMTP server
+ *
+ *  \return \c true if the SMTP server acknowledged the end of session
+ */
+bool MailSend::disconnectFromSmtpServer()
+{
+    d->m_error.clear();
+    bool ok = false;
+    if (this->isConnected())
+        ok = d->sendSmtpCommand("QUIT", 221);
+    d->m_socket->disconnectFromHost();
+    return ok;
+}
+
 /*! \brief Try to send message \p msg
+ *
+ *  The connection is kept open afterwards, so several messages can be sent
+ *  through the same SMTP session.
  *
  *  On failure, the error can be reported by errorString()
  *
@@ -261,26 +586,92 @@ bool MailSend::connectToSmtpServer(const SmtpAccount& account)
 bool MailSend::sendMessage(const Message& msg)
 {
     d->m_error.clear();
-    if (!d->sendSmtpCommand(QString("MAIL FROM:<%1>").arg(msg.from()).toUtf8(), 250))
+
+    // Check source devices before starting the SMTP transaction
+    const QList<Message::Attachment> attachments = msg.attachments();
+    if (msg.bodyDevice() != NULL
+            && !internal::prepareSourceDevice(msg.bodyDevice()))
+    {
+        d->m_error = Private::tr("Failed to read message body");
         return false;
-    foreach (const QString& recipient, msg.to()) {
-        if (!d->sendSmtpCommand(QString("RCPT TO:<%2>").arg(recipient).toUtf8(), 250))
+    }
+    foreach (const Message::Attachment& attach, attachments) {
+        if (!internal::prepareSourceDevice(attach.device)) {
+            //: %1: file name of the attachment
+            d->m_error = Private::tr("Failed to read attachment '%1'").arg(attach.fileName);
             return false;
+        }
     }
-    if (!d->sendSmtpCommand("DATA", 354))
-        return false;
-    QString data;
-    data.append(QString("Content-type: text/plain; charset=utf-8\r\n"));
-    data.append(QString("From: <%1>\r\n").arg(msg.from()));
-    data.append(QString("To: <%1>\r\n").arg(msg.to().join(QLatin1String(";"))));
-    data.append(QString("Date: %1\r\n").arg(msg.dateTime().toString()));
-    data.append(QString("Subject: %1\r\n\r\n").arg(msg.subject()));
-    data.append(msg.body() + "\r\n");
-    if (!d->sendSmtpCommand(data.toUtf8() + ".", 250))
+
+    QList<Private::SmtpCommand> envelope;
+    envelope.append(
+                Private::SmtpCommand(
+                    QString("MAIL FROM:<%1>").arg(msg.from()).toUtf8(), 250));
+    foreach (const QString& recipient, msg.to()) {
+        envelope.append(
+                    Private::SmtpCommand(
+                        QString("RCPT TO:<%2>").arg(recipient).toUtf8(), 250));
+    }
+    envelope.append(Private::SmtpCommand("DATA", 354));
+    if (!d->sendSmtpCommands(envelope))
         return false;
-    if (!d->sendSmtpCommand("QUIT", 221))
+
+    // Header
+    const QByteArray boundary =
+            !attachments.isEmpty() ?
+                "=_qtnetwork_" + QUuid::createUuid().toRfc4122().toHex() :
+                QByteArray();
+    QString header;
+    if (boundary.isEmpty()) {
+        header.append(QString("Content-type: text/plain; charset=utf-8\r\n"));
+    }
+    else {
+        header.append(QString("MIME-Version: 1.0\r\n"));
+        header.append(QString("Content-Type: multipart/mixed; boundary=\"%1\"\r\n")
+                      .arg(QString::fromLatin1(boundary)));
+    }
+    header.append(QString("From: <%1>\r\n").arg(msg.from()));
+    header.append(QString("To: <%1>\r\n").arg(msg.to().join(QLatin1String(";"))));
+    header.append(QString("Date: %1\r\n").arg(msg.dateTime().toString()));
+    header.append(QString("Subject: %1\r\n\r\n").arg(msg.subject()));
+
+    internal::SmtpDataWriter writer(d->m_socket, d->m_timeout);
+    bool ok = writer.writeText(header.toUtf8());
+
+    // Body
+    if (!boundary.isEmpty()) {
+        ok = ok && writer.writeText(
+                    "--" + boundary + "\r\n"
+                    "Content-Type: text/plain; charset=utf-8\r\n"
+                    "Content-Transfer-Encoding: 8bit\r\n\r\n");
+    }
+    if (msg.bodyDevice() != NULL)
+        ok = ok && writer.writeTextFrom(msg.bodyDevice());
+    else
+        ok = ok && writer.writeText(msg.body().toUtf8());
+
+    // Attachments
+    foreach (const Message::Attachment& attach, attachments) {
+        const QByteArray fileName = attach.fileName.toUtf8();
+        ok = ok
+                && writer.endLine()
+                && writer.writeText(
+                    "--" + boundary + "\r\n"
+                    "Content-Type: " + attach.contentType.toLatin1()
+                    + "; name=\"" + fileName + "\"\r\n"
+                    "Content-Transfer-Encoding: base64\r\n"
+                    "Content-Disposition: attachment; filename=\""
+                    + fileName + "\"\r\n\r\n")
+                && writer.writeBase64From(attach.device);
+    }
+    if (!boundary.isEmpty())
+        ok = ok && writer.endLine() && writer.writeText("--" + boundary + "--\r\n");
+
+    if (!ok || !writer.finish()) {
+        d->m_error = Private::tr("Failed to write message data (timeout)");
         return false;
-    return true;
+    }
+    return d->receiveSmtpReply(".", 250);
 }
 
 /*! \brief Description of the last error when operating with the SMTP server
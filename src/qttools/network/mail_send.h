@@ -32,7 +32,12 @@ public:
     int timeout() const;
     void setTimeout(int msecs);
 
+    bool isPipeliningEnabled() const;
+    void setPipeliningEnabled(bool on);
+
     bool connectToSmtpServer(const SmtpAccount& account);
+    bool isConnected() const;
+    bool disconnectFromSmtpServer();
     bool sendMessage(const Message& msg);
 
     QString errorString() const;
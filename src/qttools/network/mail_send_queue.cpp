@@ -0,0 +1,483 @@
+/****************************************************************************
+**  FougTools
+**  Copyright Fougue (30 Mar. 2015)
+**  contact@fougue.pro
+**
+** This software is a computer program whose purpose is to provide utility
+** tools for the C++ language and the Qt toolkit.
+**
+** This software is governed by the CeCILL-C license under French law and
+** abiding by the rules of distribution of free software.  You can  use,
+** modify and/ or redistribute the software under the terms of the CeCILL-C
+** license as circulated by CEA, CNRS and INRIA at the following URL
+** "http://www.cecill.info".
+****************************************************************************/
+
+
+#include "mail_send_queue.h"
+
+#include "mail_send.h"
+#include "message.h"
+#include "smtp_account.h"
+
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QList>
+#include <QtCore/QMutex>
+#include <QtCore/QMutexLocker>
+#include <QtCore/QThread>
+#include <QtCore/QWaitCondition>
+#include <climits>
+
+namespace qtnetwork {
+
+namespace internal {
+
+static bool isSameSmtpAccount(const SmtpAccount& lhs, const SmtpAccount& rhs)
+{
+    return lhs.host() == rhs.host()
+            && lhs.port() == rhs.port()
+            && lhs.authenticationMethod() == rhs.authenticationMethod()
+            && lhs.connectionSecurity() == rhs.connectionSecurity()
+            && lhs.userName() == rhs.userName()
+            && lhs.password() == rhs.password();
+}
+
+} // namespace internal
+
+/*! \class MailSendQueue::Private
+ *  \brief Internal (pimpl of MailSendQueue)
+ */
+class MailSendQueue::Private
+{
+public:
+    Private(MailSendQueue* backPtr)
+        : m_backPtr(backPtr),
+          m_maxThreadCount(2),
+          m_maxRetryCount(2),
+          m_retryDelay(5000),
+          m_idleTimeout(60 * 1000),
+          m_timeout(30000),
+          m_lastMsgId(0),
+          m_activeJobCount(0),
+          m_idleWorkerCount(0),
+          m_isStopping(false)
+    {
+        m_clock.start();
+    }
+
+    struct Job
+    {
+        Job() : msgId(0), attemptCount(0), readyAt(0) {}
+        quint64 msgId;
+        SmtpAccount account;
+        Message message;
+        int attemptCount;
+        qint64 readyAt; // Time (m_clock) from which the job can be sent
+    };
+
+    //! SMTP session kept open by a worker thread
+    struct Connection
+    {
+        SmtpAccount account;
+        MailSend* mailSend;
+        QElapsedTimer lastUseTimer;
+    };
+
+    class Worker : public QThread
+    {
+    public:
+        Worker(Private* pool) : m_pool(pool) {}
+    protected:
+        void run() override { m_pool->workerLoop(); }
+    private:
+        Private* m_pool;
+    };
+
+    void startWorkerIfNeeded();
+    void workerLoop();
+    int nextJobIndex(const QList<Connection>& connections, unsigned long* waitMsecs) const;
+    bool sendJob(QList<Connection>* connections, const Job& job, QString* error);
+    void closeConnections(QList<Connection>* connections, int idleMsecs);
+
+    MailSendQueue* m_backPtr;
+    int m_maxThreadCount;
+    int m_maxRetryCount;
+    int m_retryDelay;
+    int m_idleTimeout;
+    int m_timeout;
+
+    mutable QMutex m_mutex;
+    QWaitCondition m_jobAvailable;
+    QWaitCondition m_allDone;
+    QElapsedTimer m_clock;
+    QList<Job> m_jobs;
+    QList<Worker*> m_workers;
+    quint64 m_lastMsgId;
+    int m_activeJobCount;
+    int m_idleWorkerCount;
+    bool m_isStopping;
+};
+
+//! \note m_mutex must be locked
+void MailSendQueue::Private::startWorkerIfNeeded()
+{
+    if (m_idleWorkerCount > 0 || m_workers.size() >= m_maxThreadCount)
+        return;
+    Worker* worker = new Worker(this);
+    m_workers.append(worker);
+    worker->start();
+}
+
+/*! Index of the next job to be sent by a worker owning \p connections, -1 if
+ *  none is ready yet (then \p waitMsecs is the delay to wait before checking
+ *  again)
+ *
+ *  Jobs whose SMTP account matches one of \p connections are preferred, so
+ *  open sessions get reused
+ *
+ *  \note m_mutex must be locked
+ */
+int MailSendQueue::Private::nextJobIndex(
+        const QList<Connection>& connections, unsigned long* waitMsecs) const
+{
+    const qint64 now = m_clock.elapsed();
+    qint64 nextReadyAt = -1;
+    int firstReadyJobId = -1;
+    for (int i = 0; i < m_jobs.size(); ++i) {
+        const Job& job = m_jobs.at(i);
+        if (job.readyAt > now) {
+            if (nextReadyAt == -1 || job.readyAt < nextReadyAt)
+                nextReadyAt = job.readyAt;
+            continue;
+        }
+        if (firstReadyJobId == -1)
+            firstReadyJobId = i;
+        foreach (const Connection& conn, connections) {
+            if (internal::isSameSmtpAccount(conn.account, job.account))
+                return i;
+        }
+    }
+
+    if (firstReadyJobId == -1) {
+        qint64 wait = nextReadyAt != -1 ? nextReadyAt - now : -1;
+        if (!connections.isEmpty() && (wait == -1 || wait > m_idleTimeout))
+            wait = m_idleTimeout;
+        *waitMsecs = wait >= 0 ? static_cast<unsigned long>(wait) : ULONG_MAX;
+    }
+    return firstReadyJobId;
+}
+
+/*! Sends \p job through the session of \p connections matching its SMTP
+ *  account, which is opened first if needed
+ *
+ *  A reused session may have been closed meanwhile by the SMTP server, so a
+ *  failure on such session is retried once on a brand new one
+ */
+bool MailSendQueue::Private::sendJob(
+        QList<Connection>* connections, const Job& job, QString* error)
+{
+    int connId = -1;
+    for (int i = 0; i < connections->size() && connId == -1; ++i) {
+        if (internal::isSameSmtpAccount(connections->at(i).account, job.account))
+            connId = i;
+    }
+
+    int tryCount = 1;
+    if (connId != -1) {
+        if (connections->at(connId).mailSend->isConnected()) {
+            tryCount = 2;
+        }
+        else {
+            delete connections->takeAt(connId).mailSend;
+            connId = -1;
+        }
+    }
+
+    for (int iTry = 0; iTry < tryCount; ++iTry) {
+        if (connId == -1) {
+            Connection conn;
+            conn.account = job.account;
+            conn.mailSend = new MailSend;
+            conn.mailSend->setTimeout(m_timeout);
+            if (!conn.mailSend->connectToSmtpServer(job.account)) {
+                *error = conn.mailSend->errorString();
+                delete conn.mailSend;
+                return false;
+            }
+            connections->append(conn);
+            connId = connections->size() - 1;
+        }
+
+        Connection& conn = (*connections)[connId];
+        if (conn.mailSend->sendMessage(job.message)) {
+            conn.lastUseTimer.start();
+            return true;
+        }
+        *error = conn.mailSend->errorString();
+        delete connections->takeAt(connId).mailSend;
+        connId = -1;
+    }
+    return false;
+}
+
+//! Closes the sessions of \p connections left unused for \p idleMsecs at least
+void MailSendQueue::Private::closeConnections(
+        QList<Connection>* connections, int idleMsecs)
+{
+    for (int i = connections->size() - 1; i >= 0; --i) {
+        const Connection& conn = connections->at(i);
+        if (conn.lastUseTimer.elapsed() >= idleMsecs) {
+            conn.mailSend->disconnectFromSmtpServer();
+            delete connections->takeAt(i).mailSend;
+        }
+    }
+}
+
+void MailSendQueue::Private::workerLoop()
+{
+    // MailSend objects are created and destroyed in this thread only, their
+    // sockets do not need any event loop (blocking API)
+    QList<Connection> connections;
+    QMutexLocker locker(&m_mutex);
+    while (!m_isStopping) {
+        unsigned long waitMsecs = ULONG_MAX;
+        const int jobId = this->nextJobIndex(connections, &waitMsecs);
+        if (jobId == -1) {
+            ++m_idleWorkerCount;
+            m_jobAvailable.wait(&m_mutex, waitMsecs);
+            --m_idleWorkerCount;
+            const int idleTimeout = m_idleTimeout;
+            locker.unlock();
+            this->closeConnections(&connections, idleTimeout);
+            locker.relock();
+            continue;
+        }
+
+        Job job = m_jobs.takeAt(jobId);
+        ++m_activeJobCount;
+        locker.unlock();
+
+        QString error;
+        const bool isSent = this->sendJob(&connections, job, &error);
+        bool isFailed = false;
+        if (isSent) {
+            emit m_backPtr->messageSent(job.msgId);
+        }
+        else {
+            locker.relock();
+            isFailed = job.attemptCount >= m_maxRetryCount || m_isStopping;
+            if (!isFailed) {
+                ++job.attemptCount;
+                job.readyAt = m_clock.elapsed() + m_retryDelay;
+                m_jobs.append(job);
+                m_jobAvailable.wakeOne();
+            }
+            locker.unlock();
+        }
+        if (isFailed)
+            emit m_backPtr->messageFailed(job.msgId, error);
+
+        locker.relock();
+        --m_activeJobCount;
+        if (m_jobs.isEmpty() && m_activeJobCount == 0)
+            m_allDone.wakeAll();
+    }
+
+    locker.unlock();
+    this->closeConnections(&connections, 0);
+}
+
+/*!
+ * \class MailSendQueue
+ * \brief Sends messages asynchronously through pooled SMTP sessions
+ *
+ * Messages can be enqueued from any thread, they are sent by at most
+ * maxThreadCount() worker threads. Each worker keeps the SMTP sessions it
+ * opened (connected, secured and authenticated) alive during idleTimeout(),
+ * so sending several messages with the same SmtpAccount only pays for the
+ * connection once.
+ *
+ * A message failing to be sent is retried maxRetryCount() times, after
+ * retryDelay() msecs each time. Then messageFailed() is emitted.
+ *
+ * Signals messageSent() and messageFailed() are emitted from the worker
+ * threads.
+ *
+ * \note Messages still pending on destruction are discarded, call
+ *       waitForDone() before to ensure they get sent
+ *
+ * \headerfile mail_send_queue.h <qttools/network/mail_send_queue.h>
+ * \ingroup qttools_network
+ */
+
+MailSendQueue::MailSendQueue(QObject* parent)
+    : QObject(parent),
+      d(new Private(this))
+{
+}
+
+MailSendQueue::~MailSendQueue()
+{
+    QList<Private::Worker*> workers;
+    {
+        QMutexLocker locker(&d->m_mutex);
+        Q_UNUSED(locker);
+        d->m_isStopping = true;
+        d->m_jobs.clear();
+        workers = d->m_workers;
+        d->m_jobAvailable.wakeAll();
+    }
+    foreach (Private::Worker* worker, workers) {
+        worker->wait();
+        delete worker;
+    }
+    delete d;
+}
+
+/*! \brief Maximum count of threads (so SMTP sessions per account) used to
+ *         send messages
+ *
+ *  Default is \c 2
+ */
+int MailSendQueue::maxThreadCount() const
+{
+    QMutexLocker locker(&d->m_mutex);
+    Q_UNUSED(locker);
+    return d->m_maxThreadCount;
+}
+
+void MailSendQueue::setMaxThreadCount(int count)
+{
+    QMutexLocker locker(&d->m_mutex);
+    Q_UNUSED(locker);
+    d->m_maxThreadCount = qMax(count, 1);
+}
+
+/*! \brief Count of retries when a message fails to be sent
+ *
+ *  Default is \c 2
+ */
+int MailSendQueue::maxRetryCount() const
+{
+    QMutexLocker locker(&d->m_mutex);
+    Q_UNUSED(locker);
+    return d->m_maxRetryCount;
+}
+
+void MailSendQueue::setMaxRetryCount(int count)
+{
+    QMutexLocker locker(&d->m_mutex);
+    Q_UNUSED(locker);
+    d->m_maxRetryCount = qMax(count, 0);
+}
+
+/*! \brief Delay(msecs) before retrying to send a message
+ *
+ *  Default is \c 5 seconds
+ */
+int MailSendQueue::retryDelay() const
+{
+    QMutexLocker locker(&d->m_mutex);
+    Q_UNUSED(locker);
+    return d->m_retryDelay;
+}
+
+void MailSendQueue::setRetryDelay(int msecs)
+{
+    QMutexLocker locker(&d->m_mutex);
+    Q_UNUSED(locker);
+    d->m_retryDelay = qMax(msecs, 0);
+}
+
+/*! \brief Delay(msecs) after which an unused SMTP session is closed
+ *
+ *  Default is \c 60 seconds
+ */
+int MailSendQueue::idleTimeout() const
+{
+    QMutexLocker locker(&d->m_mutex);
+    Q_UNUSED(locker);
+    return d->m_idleTimeout;
+}
+
+void MailSendQueue::setIdleTimeout(int msecs)
+{
+    QMutexLocker locker(&d->m_mutex);
+    Q_UNUSED(locker);
+    d->m_idleTimeout = qMax(msecs, 0);
+}
+
+/*! \brief Time out of the SMTP operations, applies to sessions opened
+ *         afterwards
+ *
+ *  \sa MailSend::timeout()
+ */
+int MailSendQueue::timeout() const
+{
+    QMutexLocker locker(&d->m_mutex);
+    Q_UNUSED(locker);
+    return d->m_timeout;
+}
+
+void MailSendQueue::setTimeout(int msecs)
+{
+    QMutexLocker locker(&d->m_mutex);
+    Q_UNUSED(locker);
+    d->m_timeout = msecs;
+}
+
+/*! \brief Queues message \p msg to be sent with SMTP \p account
+ *
+ *  This function is thread-safe
+ *
+ *  \return Identifier of the message, as reported by messageSent() and
+ *          messageFailed()
+ */
+quint64 MailSendQueue::enqueue(const SmtpAccount& account, const Message& msg)
+{
+    QMutexLocker locker(&d->m_mutex);
+    Q_UNUSED(locker);
+    Private::Job job;
+    job.msgId = ++d->m_lastMsgId;
+    job.account = account;
+    job.message = msg;
+    job.readyAt = d->m_clock.elapsed();
+    d->m_jobs.append(job);
+    d->startWorkerIfNeeded();
+    d->m_jobAvailable.wakeOne();
+    return job.msgId;
+}
+
+//! \brief Count of messages queued or being sent
+int MailSendQueue::pendingCount() const
+{
+    QMutexLocker locker(&d->m_mutex);
+    Q_UNUSED(locker);
+    return d->m_jobs.size() + d->m_activeJobCount;
+}
+
+/*! \brief Blocks until all messages are sent (or failed) or \p msecs
+ *         milliseconds have passed (-1 for no time out)
+ *
+ *  \return \c true if all messages were processed
+ */
+bool MailSendQueue::waitForDone(int msecs)
+{
+    QElapsedTimer timer;
+    timer.start();
+    QMutexLocker locker(&d->m_mutex);
+    Q_UNUSED(locker);
+    while (!d->m_jobs.isEmpty() || d->m_activeJobCount > 0) {
+        unsigned long waitMsecs = ULONG_MAX;
+        if (msecs >= 0) {
+            const qint64 remaining = msecs - timer.elapsed();
+            if (remaining <= 0)
+                return false;
+            waitMsecs = static_cast<unsigned long>(remaining);
+        }
+        d->m_allDone.wait(&d->m_mutex, waitMsecs);
+    }
+    return true;
+}
+
+} // namespace qtnetwork
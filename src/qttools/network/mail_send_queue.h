@@ -0,0 +1,63 @@
+/****************************************************************************
+**  FougTools
+**  Copyright Fougue (30 Mar. 2015)
+**  contact@fougue.pro
+**
+** This software is a computer program whose purpose is to provide utility
+** tools for the C++ language and the Qt toolkit.
+**
+** This software is governed by the CeCILL-C license under French law and
+** abiding by the rules of distribution of free software.  You can  use,
+** modify and/ or redistribute the software under the terms of the CeCILL-C
+** license as circulated by CEA, CNRS and INRIA at the following URL
+** "http://www.cecill.info".
+****************************************************************************/
+
+
+#pragma once
+
+#include "network.h"
+#include <QtCore/QObject>
+
+namespace qtnetwork {
+
+class Message;
+class SmtpAccount;
+
+class QTTOOLS_NETWORK_EXPORT MailSendQueue : public QObject
+{
+    Q_OBJECT
+
+public:
+    MailSendQueue(QObject* parent = NULL);
+    ~MailSendQueue();
+
+    int maxThreadCount() const;
+    void setMaxThreadCount(int count);
+
+    int maxRetryCount() const;
+    void setMaxRetryCount(int count);
+
+    int retryDelay() const;
+    void setRetryDelay(int msecs);
+
+    int idleTimeout() const;
+    void setIdleTimeout(int msecs);
+
+    int timeout() const;
+    void setTimeout(int msecs);
+
+    quint64 enqueue(const SmtpAccount& account, const Message& msg);
+    int pendingCount() const;
+    bool waitForDone(int msecs = -1);
+
+signals:
+    void messageSent(quint64 msgId);
+    void messageFailed(quint64 msgId, const QString& error);
+
+private:
+    class Private;
+    Private* const d;
+};
+
+} // namespace qtnetwork
@@ -26,7 +26,8 @@ namespace qtnetwork {
  */
 
 Message::Message()
-    : m_dateTime(QDateTime::currentDateTime())
+    : m_dateTime(QDateTime::currentDateTime()),
+      m_bodyDevice(NULL)
 {
 }
 
@@ -80,4 +81,66 @@ void Message::setBody(const QString& text)
     m_body = text;
 }
 
+/*! \brief Device providing the (UTF-8) text of the body, NULL by default
+ *
+ *  When not NULL, the body is streamed from this device by MailSend instead
+ *  of being taken from body(). This avoids to hold large bodies in memory.
+ *
+ *  The device is not owned by the message, it must stay valid until the
+ *  message is sent
+ */
+QIODevice* Message::bodyDevice() const
+{
+    return m_bodyDevice;
+}
+
+void Message::setBodyDevice(QIODevice* device)
+{
+    m_bodyDevice = device;
+}
+
+/*! \struct Message::Attachment
+ *  \brief File attached to a Message, its contents being streamed from
+ *         \c device
+ */
+
+Message::Attachment::Attachment()
+    : device(NULL)
+{
+}
+
+QList<Message::Attachment> Message::attachments() const
+{
+    return m_attachments;
+}
+
+/*! \brief Attaches the contents of \p device as file \p fileName
+ *
+ *  The contents are streamed (base64 encoded) by MailSend, so they never
+ *  need to be fully loaded in memory.
+ *
+ *  \p device is not owned by the message, it must stay valid until the
+ *  message is sent
+ *
+ *  \param contentType  MIME type of the contents, "application/octet-stream"
+ *                      if empty
+ */
+void Message::addAttachment(
+        const QString& fileName, QIODevice* device, const QString& contentType)
+{
+    Attachment attach;
+    attach.fileName = fileName;
+    attach.contentType =
+            !contentType.isEmpty() ?
+                contentType :
+                QString::fromLatin1("application/octet-stream");
+    attach.device = device;
+    m_attachments.append(attach);
+}
+
+void Message::clearAttachments()
+{
+    m_attachments.clear();
+}
+
 } // namespace qtnetwork
@@ -17,7 +17,9 @@
 
 #include "network.h"
 #include <QtCore/QDateTime>
+#include <QtCore/QList>
 #include <QtCore/QStringList>
+class QIODevice;
 
 namespace qtnetwork {
 
@@ -41,12 +43,32 @@ public:
     QString body() const;
     void setBody(const QString& text);
 
+    QIODevice* bodyDevice() const;
+    void setBodyDevice(QIODevice* device);
+
+    struct Attachment
+    {
+        Attachment();
+        QString fileName;
+        QString contentType;
+        QIODevice* device;
+    };
+
+    QList<Attachment> attachments() const;
+    void addAttachment(
+            const QString& fileName,
+            QIODevice* device,
+            const QString& contentType = QString());
+    void clearAttachments();
+
 private:
     QString m_from;
     QStringList m_to;
     QDateTime m_dateTime;
     QString m_subject;
     QString m_body;
+    QIODevice* m_bodyDevice;
+    QList<Attachment> m_attachments;
 };
 
 } // namespace qtnetwork
@@ -4,11 +4,13 @@ QT += network
 
 HEADERS += \
     $$PWD/mail_send.h \
+    $$PWD/mail_send_queue.h \
     $$PWD/message.h \
     $$PWD/network.h \
     $$PWD/smtp_account.h
 
 SOURCES += \
     $$PWD/mail_send.cpp \
+    $$PWD/mail_send_queue.cpp \
     $$PWD/message.cpp \
     $$PWD/smtp_account.cpp
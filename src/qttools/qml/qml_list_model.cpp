@@ -0,0 +1,342 @@
+/****************************************************************************
+**  FougTools
+**  Copyright Fougue (30 Mar. 2015)
+**  contact@fougue.pro
+**
+** This software is a computer program whose purpose is to provide utility
+** tools for the C++ language and the Qt toolkit.
+**
+** This software is governed by the CeCILL-C license under French law and
+** abiding by the rules of distribution of free software.  You can  use,
+** modify and/ or redistribute the software under the terms of the CeCILL-C
+** license as circulated by CEA, CNRS and INRIA at the following URL
+** "http://www.cecill.info".
+****************************************************************************/
+
+
+#include "qml_list_model.h"
+
+#include <QtCore/QHash>
+#include <QtCore/QVector>
+
+namespace qtqml {
+
+/*! \class QmlListModel::Private
+ *  \brief Internal (pimpl of QmlListModel)
+ */
+class QmlListModel::Private
+{
+public:
+    void setRoleNames(const QStringList& names)
+    {
+        m_roleNames = names;
+        m_roleIdByName.clear();
+        m_qmlRoleNames.clear();
+        for (int i = 0; i < names.size(); ++i) {
+            m_roleIdByName.insert(names.at(i), i);
+            m_qmlRoleNames.insert(Private::roleFromId(i), names.at(i).toUtf8());
+        }
+    }
+
+    //! Row values ordered as m_roleNames, entries of \p values not matching any role are ignored
+    QVector<QVariant> toRow(const QVariantMap& values) const
+    {
+        QVector<QVariant> row(m_roleNames.size());
+        for (auto it = values.constBegin(); it != values.constEnd(); ++it) {
+            const int roleId = m_roleIdByName.value(it.key(), -1);
+            if (roleId != -1)
+                row[roleId] = it.value();
+        }
+        return row;
+    }
+
+    int roleId(int role) const
+    {
+        if (role == Qt::DisplayRole && !m_roleNames.isEmpty())
+            return 0;
+        const int id = role - (Qt::UserRole + 1);
+        return 0 <= id && id < m_roleNames.size() ? id : -1;
+    }
+
+    static int roleFromId(int id)
+    {
+        return Qt::UserRole + 1 + id;
+    }
+
+    bool isValidRow(int row) const
+    {
+        return 0 <= row && row < m_rows.size();
+    }
+
+    QStringList m_roleNames;
+    QHash<QString, int> m_roleIdByName;
+    QHash<int, QByteArray> m_qmlRoleNames;
+    QList< QVector<QVariant> > m_rows;
+};
+
+/*!
+ * \class QmlListModel
+ * \brief List model of QVariantMap rows, to be exposed to QML views
+ *
+ * Each role name is a QML role, ex: with role names "name" and "price" a QML
+ * delegate can bind to \c model.name and \c model.price .
+ *
+ * Contrary to a QVariantList property, that QML copies and re-reads entirely
+ * on every change, modifications only signal the rows (and roles) actually
+ * changed, so views update in O(changed rows). Batch overloads (append(),
+ * insert() of a list of rows) signal the insertion only once.
+ *
+ * Values are stored per row in role order, so data() needs no name lookup.
+ *
+ * If no role name is defined when the first rows are added, role names are
+ * deduced from the keys of the first row (as QML ListModel does).
+ *
+ * \headerfile qml_list_model.h <qttools/qml/qml_list_model.h>
+ * \ingroup qttools_qml
+ */
+
+QmlListModel::QmlListModel(QObject* parent)
+    : QAbstractListModel(parent),
+      d(new Private)
+{
+}
+
+QmlListModel::QmlListModel(const QStringList& roleNames, QObject* parent)
+    : QAbstractListModel(parent),
+      d(new Private)
+{
+    this->setRoleNameList(roleNames);
+}
+
+QmlListModel::~QmlListModel()
+{
+    delete d;
+}
+
+QStringList QmlListModel::roleNameList() const
+{
+    return d->m_roleNames;
+}
+
+/*! \brief Defines the roles (columns) of the rows
+ *
+ *  Role name at index \c i is associated to role Qt::UserRole + 1 + i .
+ *  The model is reset and all rows are cleared
+ */
+void QmlListModel::setRoleNameList(const QStringList& names)
+{
+    const int oldCount = d->m_rows.size();
+    this->beginResetModel();
+    d->m_rows.clear();
+    d->setRoleNames(names);
+#if QT_VERSION < 0x050000
+    QAbstractItemModel::setRoleNames(d->m_qmlRoleNames);
+#endif // QT_VERSION
+    this->endResetModel();
+    if (oldCount != 0)
+        emit countChanged();
+}
+
+//! Item data role associated to \p name, -1 if none
+int QmlListModel::roleForName(const QString& name) const
+{
+    const int id = d->m_roleIdByName.value(name, -1);
+    return id != -1 ? Private::roleFromId(id) : -1;
+}
+
+int QmlListModel::count() const
+{
+    return d->m_rows.size();
+}
+
+//! Values of \p row, keyed by role names
+QVariantMap QmlListModel::get(int row) const
+{
+    QVariantMap values;
+    if (d->isValidRow(row)) {
+        const QVector<QVariant>& rowValues = d->m_rows.at(row);
+        for (int i = 0; i < d->m_roleNames.size(); ++i)
+            values.insert(d->m_roleNames.at(i), rowValues.at(i));
+    }
+    return values;
+}
+
+QVariant QmlListModel::value(int row, const QString& roleName) const
+{
+    const int roleId = d->m_roleIdByName.value(roleName, -1);
+    if (d->isValidRow(row) && roleId != -1)
+        return d->m_rows.at(row).at(roleId);
+    return QVariant();
+}
+
+void QmlListModel::append(const QVariantMap& values)
+{
+    this->insert(d->m_rows.size(), QList<QVariantMap>() << values);
+}
+
+void QmlListModel::append(const QList<QVariantMap>& rows)
+{
+    this->insert(d->m_rows.size(), rows);
+}
+
+void QmlListModel::insert(int row, const QVariantMap& values)
+{
+    this->insert(row, QList<QVariantMap>() << values);
+}
+
+/*! \brief Inserts \p rows before row \p row, with a single rowsInserted()
+ *         signal
+ */
+void QmlListModel::insert(int row, const QList<QVariantMap>& rows)
+{
+    if (rows.isEmpty() || row < 0 || row > d->m_rows.size())
+        return;
+    if (d->m_roleNames.isEmpty() && d->m_rows.isEmpty())
+        this->setRoleNameList(rows.first().keys());
+
+    this->beginInsertRows(QModelIndex(), row, row + rows.size() - 1);
+    d->m_rows.reserve(d->m_rows.size() + rows.size());
+    for (int i = 0; i < rows.size(); ++i)
+        d->m_rows.insert(row + i, d->toRow(rows.at(i)));
+    this->endInsertRows();
+    emit countChanged();
+}
+
+void QmlListModel::remove(int row, int count)
+{
+    if (count <= 0 || row < 0 || row + count > d->m_rows.size())
+        return;
+    this->beginRemoveRows(QModelIndex(), row, row + count - 1);
+    if (row == 0 && count == d->m_rows.size()) {
+        d->m_rows.clear();
+    }
+    else {
+        const QList< QVector<QVariant> >::iterator itBegin = d->m_rows.begin() + row;
+        d->m_rows.erase(itBegin, itBegin + count);
+    }
+    this->endRemoveRows();
+    emit countChanged();
+}
+
+/*! \brief Moves \p count rows from index \p from to index \p to
+ *
+ *  Same semantics as QML ListModel::move() : \p to is the index of the first
+ *  moved row once the move is done
+ */
+void QmlListModel::move(int from, int to, int count)
+{
+    const int rowCount = d->m_rows.size();
+    if (count <= 0 || from == to
+            || from < 0 || from + count > rowCount
+            || to < 0 || to + count > rowCount)
+    {
+        return;
+    }
+    const int destChild = to > from ? to + count : to;
+    this->beginMoveRows(QModelIndex(), from, from + count - 1, QModelIndex(), destChild);
+    QList< QVector<QVariant> > movedRows = d->m_rows.mid(from, count);
+    const QList< QVector<QVariant> >::iterator itBegin = d->m_rows.begin() + from;
+    d->m_rows.erase(itBegin, itBegin + count);
+    for (int i = 0; i < count; ++i)
+        d->m_rows.insert(to + i, movedRows.at(i));
+    this->endMoveRows();
+}
+
+/*! \brief Assigns \p values to \p row
+ *
+ *  Roles not in \p values are left untouched. dataChanged() is emitted only
+ *  if some value actually changed (Qt5: with the changed roles)
+ */
+void QmlListModel::set(int row, const QVariantMap& values)
+{
+    if (!d->isValidRow(row))
+        return;
+    QVector<QVariant>& rowValues = d->m_rows[row];
+    QVector<int> changedRoles;
+    for (auto it = values.constBegin(); it != values.constEnd(); ++it) {
+        const int roleId = d->m_roleIdByName.value(it.key(), -1);
+        if (roleId != -1 && rowValues.at(roleId) != it.value()) {
+            rowValues[roleId] = it.value();
+            changedRoles.append(Private::roleFromId(roleId));
+        }
+    }
+    if (!changedRoles.isEmpty()) {
+        const QModelIndex index = this->index(row);
+#if QT_VERSION >= 0x050000
+        emit dataChanged(index, index, changedRoles);
+#else
+        emit dataChanged(index, index);
+#endif // QT_VERSION
+    }
+}
+
+void QmlListModel::setValue(int row, const QString& roleName, const QVariant& value)
+{
+    const int roleId = d->m_roleIdByName.value(roleName, -1);
+    if (roleId != -1)
+        this->setData(this->index(row), value, Private::roleFromId(roleId));
+}
+
+void QmlListModel::clear()
+{
+    this->reset(QList<QVariantMap>());
+}
+
+//! Replaces all the rows with \p rows, the model is reset
+void QmlListModel::reset(const QList<QVariantMap>& rows)
+{
+    const int oldCount = d->m_rows.size();
+    this->beginResetModel();
+    if (d->m_roleNames.isEmpty() && !rows.isEmpty()) {
+        d->setRoleNames(rows.first().keys());
+#if QT_VERSION < 0x050000
+        QAbstractItemModel::setRoleNames(d->m_qmlRoleNames);
+#endif // QT_VERSION
+    }
+    d->m_rows.clear();
+    d->m_rows.reserve(rows.size());
+    foreach (const QVariantMap& values, rows)
+        d->m_rows.append(d->toRow(values));
+    this->endResetModel();
+    if (oldCount != d->m_rows.size())
+        emit countChanged();
+}
+
+int QmlListModel::rowCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : d->m_rows.size();
+}
+
+QVariant QmlListModel::data(const QModelIndex& index, int role) const
+{
+    const int roleId = d->roleId(role);
+    if (!index.isValid() || !d->isValidRow(index.row()) || roleId == -1)
+        return QVariant();
+    return d->m_rows.at(index.row()).at(roleId);
+}
+
+bool QmlListModel::setData(const QModelIndex& index, const QVariant& value, int role)
+{
+    const int roleId = d->roleId(role == Qt::EditRole ? Qt::DisplayRole : role);
+    if (!index.isValid() || !d->isValidRow(index.row()) || roleId == -1)
+        return false;
+    QVariant& cell = d->m_rows[index.row()][roleId];
+    if (cell != value) {
+        cell = value;
+#if QT_VERSION >= 0x050000
+        emit dataChanged(index, index, QVector<int>() << Private::roleFromId(roleId));
+#else
+        emit dataChanged(index, index);
+#endif // QT_VERSION
+    }
+    return true;
+}
+
+#if QT_VERSION >= 0x050000
+QHash<int, QByteArray> QmlListModel::roleNames() const
+{
+    return d->m_qmlRoleNames;
+}
+#endif // QT_VERSION
+
+} // namespace qtqml
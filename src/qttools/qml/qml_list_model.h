@@ -0,0 +1,72 @@
+/****************************************************************************
+**  FougTools
+**  Copyright Fougue (30 Mar. 2015)
+**  contact@fougue.pro
+**
+** This software is a computer program whose purpose is to provide utility
+** tools for the C++ language and the Qt toolkit.
+**
+** This software is governed by the CeCILL-C license under French law and
+** abiding by the rules of distribution of free software.  You can  use,
+** modify and/ or redistribute the software under the terms of the CeCILL-C
+** license as circulated by CEA, CNRS and INRIA at the following URL
+** "http://www.cecill.info".
+****************************************************************************/
+
+
+#pragma once
+
+#include "qml.h"
+#include <QtCore/QAbstractListModel>
+#include <QtCore/QStringList>
+#include <QtCore/QVariantMap>
+
+namespace qtqml {
+
+class QTTOOLS_QML_EXPORT QmlListModel : public QAbstractListModel
+{
+    Q_OBJECT
+    Q_PROPERTY(int count READ count NOTIFY countChanged)
+
+public:
+    QmlListModel(QObject* parent = NULL);
+    QmlListModel(const QStringList& roleNames, QObject* parent = NULL);
+    ~QmlListModel();
+
+    QStringList roleNameList() const;
+    void setRoleNameList(const QStringList& names);
+    int roleForName(const QString& name) const;
+
+    int count() const;
+
+    Q_INVOKABLE QVariantMap get(int row) const;
+    Q_INVOKABLE QVariant value(int row, const QString& roleName) const;
+
+    Q_INVOKABLE void append(const QVariantMap& values);
+    void append(const QList<QVariantMap>& rows);
+    Q_INVOKABLE void insert(int row, const QVariantMap& values);
+    void insert(int row, const QList<QVariantMap>& rows);
+    Q_INVOKABLE void remove(int row, int count = 1);
+    Q_INVOKABLE void move(int from, int to, int count = 1);
+    Q_INVOKABLE void set(int row, const QVariantMap& values);
+    Q_INVOKABLE void setValue(int row, const QString& roleName, const QVariant& value);
+    Q_INVOKABLE void clear();
+    void reset(const QList<QVariantMap>& rows);
+
+    // -- QAbstractItemModel
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    bool setData(const QModelIndex& index, const QVariant& value, int role = Qt::EditRole) override;
+#if QT_VERSION >= 0x050000
+    QHash<int, QByteArray> roleNames() const override;
+#endif // QT_VERSION
+
+signals:
+    void countChanged();
+
+private:
+    class Private;
+    Private* const d;
+};
+
+} // namespace qtqml
@@ -15,6 +15,7 @@
 
 #include "qml_utils.h"
 
+#include <QtCore/QTimer>
 #include <QtGui/QCursor>
 
 #if QT_VERSION >= 0x050000
@@ -62,9 +63,30 @@ static Qt::CursorShape toQtCursorShape(int shape)
 
 } // namespace internal
 
+/*!
+ * \class QmlUtils
+ * \brief Provides utility functions to QML code
+ *
+ * \headerfile qml_utils.h <qttools/qml/qml_utils.h>
+ * \ingroup qttools_qml
+ */
+
 QmlUtils::QmlUtils(QObject* parent)
-    : QObject(parent)
+    : QObject(parent),
+      m_busyTimer(new QTimer(this)),
+      m_busyCount(0),
+      m_busyCursorShape(Qt::WaitCursor),
+      m_isBusyCursorApplied(false)
+{
+    m_busyTimer->setSingleShot(true);
+    m_busyTimer->setInterval(250);
+    QObject::connect(m_busyTimer, SIGNAL(timeout()), this, SLOT(applyBusyCursor()));
+}
+
+QmlUtils::~QmlUtils()
 {
+    if (m_isBusyCursorApplied)
+        this->restoreOverrideCursor();
 }
 
 void QmlUtils::setOverrideCursor(int shape)
@@ -85,6 +107,75 @@ void QmlUtils::restoreOverrideCursor()
 #endif // QT_VERSION
 }
 
+/*! \brief Marks the start of a (possibly short) busy operation
+ *
+ *  Calls are reference counted and must be balanced with endBusy(). The busy
+ *  cursor is shown only if the busy state lasts more than busyCursorDelay(),
+ *  so rapid-fire short operations neither cause flicker nor window system
+ *  traffic
+ */
+void QmlUtils::beginBusy()
+{
+    if (m_busyCount++ == 0) {
+        m_busyTimer->start();
+        emit busyChanged(true);
+    }
+}
+
+void QmlUtils::endBusy()
+{
+    if (m_busyCount == 0 || --m_busyCount > 0)
+        return;
+    m_busyTimer->stop();
+    if (m_isBusyCursorApplied) {
+        m_isBusyCursorApplied = false;
+        this->restoreOverrideCursor();
+    }
+    emit busyChanged(false);
+}
+
+bool QmlUtils::isBusy() const
+{
+    return m_busyCount > 0;
+}
+
+/*! \brief Delay(msecs) the busy state must last before the busy cursor is
+ *         shown
+ *
+ *  Default is \c 250 msecs
+ */
+int QmlUtils::busyCursorDelay() const
+{
+    return m_busyTimer->interval();
+}
+
+void QmlUtils::setBusyCursorDelay(int msecs)
+{
+    m_busyTimer->setInterval(qMax(msecs, 0));
+}
+
+/*! \brief Shape (Qt::CursorShape) of the busy cursor
+ *
+ *  Default is Qt::WaitCursor
+ */
+int QmlUtils::busyCursorShape() const
+{
+    return m_busyCursorShape;
+}
+
+void QmlUtils::setBusyCursorShape(int shape)
+{
+    m_busyCursorShape = internal::toQtCursorShape(shape);
+}
+
+void QmlUtils::applyBusyCursor()
+{
+    if (m_busyCount > 0 && !m_isBusyCursorApplied) {
+        m_isBusyCursorApplied = true;
+        this->setOverrideCursor(m_busyCursorShape);
+    }
+}
+
 #if QT_VERSION >= 0x050000
 void QmlUtils::declareObject(QQmlContext* context, QmlUtils* obj)
 #else
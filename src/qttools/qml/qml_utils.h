@@ -22,24 +22,51 @@ class QQmlContext;
 #else
 class QDeclarativeContext;
 #endif // QT_VERSION
+class QTimer;
 
 namespace qtqml {
 
 class QTTOOLS_QML_EXPORT QmlUtils : public QObject
 {
     Q_OBJECT
+    Q_PROPERTY(int busyCursorDelay READ busyCursorDelay WRITE setBusyCursorDelay)
+    Q_PROPERTY(int busyCursorShape READ busyCursorShape WRITE setBusyCursorShape)
+    Q_PROPERTY(bool busy READ isBusy NOTIFY busyChanged)
 
 public:
     QmlUtils(QObject* parent = NULL);
+    ~QmlUtils();
 
     Q_INVOKABLE void setOverrideCursor(int shape);
     Q_INVOKABLE void restoreOverrideCursor();
 
+    Q_INVOKABLE void beginBusy();
+    Q_INVOKABLE void endBusy();
+    bool isBusy() const;
+
+    int busyCursorDelay() const;
+    void setBusyCursorDelay(int msecs);
+
+    int busyCursorShape() const;
+    void setBusyCursorShape(int shape);
+
 #if QT_VERSION >= 0x050000
     static void declareObject(QQmlContext* context, QmlUtils* obj);
 #else
     static void declareObject(QDeclarativeContext* context, QmlUtils* obj);
 #endif // QT_VERSION
+
+signals:
+    void busyChanged(bool busy);
+
+private slots:
+    void applyBusyCursor();
+
+private:
+    QTimer* m_busyTimer;
+    int m_busyCount;
+    int m_busyCursorShape;
+    bool m_isBusyCursorApplied;
 };
 
 } // namespace qtqml
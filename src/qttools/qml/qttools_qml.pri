@@ -6,7 +6,9 @@ isEqual(QT_MAJOR_VERSION, 5): QT += qml
 
 HEADERS += \
     $$PWD/qml.h \
+    $$PWD/qml_list_model.h \
     $$PWD/qml_utils.h
 
 SOURCES += \
+    $$PWD/qml_list_model.cpp \
     $$PWD/qml_utils.cpp
@@ -15,12 +15,595 @@
 
 #include "calculator.h"
 
+#include "../../cpptools/parallel_utils.h"
+
+#include <QtCore/QThreadStorage>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+#include <memory>
+#include <vector>
+
 namespace qtscript {
 
+namespace internal {
+
+//! JS Math.round() : halfway values are rounded towards +infinity
+static double jsRound(double x)
+{
+    return std::floor(x + 0.5);
+}
+
+//! Same as function round_int() of the evaluation script
+static double roundInt(double x)
+{
+    const double r = internal::jsRound(x);
+    return std::fabs(r - x) < 1.0E-5 ? r : x;
+}
+
+static double fnAbs(double x)   { return internal::roundInt(std::fabs(x)); }
+static double fnAcos(double x)  { return internal::roundInt(std::acos(x)); }
+static double fnAsin(double x)  { return internal::roundInt(std::asin(x)); }
+static double fnAtan(double x)  { return internal::roundInt(std::atan(x)); }
+static double fnCeil(double x)  { return internal::roundInt(std::ceil(x)); }
+static double fnCos(double x)   { return internal::roundInt(std::cos(x)); }
+static double fnExp(double x)   { return internal::roundInt(std::exp(x)); }
+static double fnFloor(double x) { return internal::roundInt(std::floor(x)); }
+static double fnLog(double x)   { return internal::roundInt(std::log(x)); }
+static double fnRound(double x) { return internal::jsRound(x); }
+static double fnSin(double x)   { return internal::roundInt(std::sin(x)); }
+static double fnSqrt(double x)  { return internal::roundInt(std::sqrt(x)); }
+static double fnTan(double x)   { return internal::roundInt(std::tan(x)); }
+static double fnAtan2(double y, double x) { return internal::roundInt(std::atan2(y, x)); }
+static double fnPow(double x, double y)   { return internal::roundInt(std::pow(x, y)); }
+static double fnRandom() { return std::rand() / (RAND_MAX + 1.0); }
+
+typedef double (*Function0)();
+typedef double (*Function1)(double);
+typedef double (*Function2)(double, double);
+
+struct BuiltinFunction
+{
+    const char* name;
+    int argCount;
+    Function0 fn0;
+    Function1 fn1;
+    Function2 fn2;
+};
+
+//! Functions and constants defined by the evaluation script of Calculator
+static const BuiltinFunction builtinFunctions[] = {
+    { "abs",    1, NULL, &internal::fnAbs, NULL },
+    { "acos",   1, NULL, &internal::fnAcos, NULL },
+    { "asin",   1, NULL, &internal::fnAsin, NULL },
+    { "atan",   1, NULL, &internal::fnAtan, NULL },
+    { "atan2",  2, NULL, NULL, &internal::fnAtan2 },
+    { "ceil",   1, NULL, &internal::fnCeil, NULL },
+    { "cos",    1, NULL, &internal::fnCos, NULL },
+    { "exp",    1, NULL, &internal::fnExp, NULL },
+    { "floor",  1, NULL, &internal::fnFloor, NULL },
+    { "log",    1, NULL, &internal::fnLog, NULL },
+    { "pow",    2, NULL, NULL, &internal::fnPow },
+    { "random", 0, &internal::fnRandom, NULL, NULL },
+    { "round",  1, NULL, &internal::fnRound, NULL },
+    { "sin",    1, NULL, &internal::fnSin, NULL },
+    { "sqrt",   1, NULL, &internal::fnSqrt, NULL },
+    { "tan",    1, NULL, &internal::fnTan, NULL }
+};
+
+struct BuiltinConstant
+{
+    const char* name;
+    double value;
+};
+
+static const BuiltinConstant builtinConstants[] = {
+    { "PI", 3.14159265358979323846 },
+    { "RAD_TO_DEG", 180.0 / 3.14159265358979323846 },
+    { "DEG_TO_RAD", 3.14159265358979323846 / 180.0 }
+};
+
+/*! Compiled form of a plain arithmetic expression, evaluated without the
+ *  script engine
+ *
+ *  Supported syntax is numbers, identifiers (variables and constants of the
+ *  evaluation script), operators + - * / % (binary and unary +/-),
+ *  parentheses and calls to functions of the evaluation script. Anything else
+ *  makes compile() fail, the expression is then left to the script engine.
+ *
+ *  The expression is compiled to a postfix sequence of instructions run on a
+ *  small stack of doubles
+ */
+class ArithmeticProgram
+{
+public:
+    ArithmeticProgram() : m_isReentrant(true) {}
+
+    static ArithmeticProgram* compile(const QString& source);
+
+    bool evaluate(const Calculator::Variables& variables, double* result) const;
+    bool evaluateColumns(
+            const Calculator::VariableColumns& columns,
+            const Calculator::Variables& variables,
+            std::size_t rowCount,
+            double* results,
+            unsigned threadCount) const;
+
+private:
+    enum OpCode
+    {
+        OpPushConst,
+        OpPushName,
+        OpAdd,
+        OpSub,
+        OpMul,
+        OpDiv,
+        OpMod,
+        OpNeg,
+        OpCall0,
+        OpCall1,
+        OpCall2
+    };
+
+    struct Instruction
+    {
+        OpCode op;
+        int arg;      // Index in m_constants, m_names or builtinFunctions
+    };
+
+    //! Identifier referenced by the expression, resolved on evaluation
+    struct Name
+    {
+        QString text;
+        bool isFunction;
+        bool hasDefaultValue;  // Constants of the evaluation script
+        double defaultValue;
+    };
+
+    enum { MaxStackSize = 64, MaxNameCount = 64 };
+
+    class Parser;
+
+    bool resolveNames(
+            const Calculator::Variables& variables,
+            const Calculator::VariableColumns* columns,
+            double* nameValues,
+            const double** nameColumns) const;
+    double run(const double* nameValues) const;
+
+    bool m_isReentrant; // false if random() is used (std::rand() is not)
+    std::vector<Instruction> m_code;
+    std::vector<double> m_constants;
+    std::vector<Name> m_names;
+};
+
+class ArithmeticProgram::Parser
+{
+public:
+    Parser(const QString& source, ArithmeticProgram* program)
+        : m_src(source.constData()),
+          m_end(source.constData() + source.size()),
+          m_program(program),
+          m_stackSize(0),
+          m_maxStackSize(0)
+    { }
+
+    // expr := term (('+' | '-') term)*
+    bool parseExpression(int depth = 0)
+    {
+        if (depth > MaxStackSize || !this->parseTerm(depth))
+            return false;
+        forever {
+            const QChar c = this->peek();
+            if (c != QLatin1Char('+') && c != QLatin1Char('-'))
+                return true;
+            ++m_src;
+            // Reject "++" and "--" (increment/decrement operators)
+            if (m_src != m_end && *m_src == c)
+                return false;
+            if (!this->parseTerm(depth))
+                return false;
+            this->emitOp(c == QLatin1Char('+') ? OpAdd : OpSub, 0, -1);
+        }
+    }
+
+    bool isAtEnd()
+    {
+        return this->peek().isNull();
+    }
+
+    int maxStackSize() const
+    {
+        return m_maxStackSize;
+    }
+
+private:
+    // term := unary (('*' | '/' | '%') unary)*
+    bool parseTerm(int depth)
+    {
+        if (!this->parseUnary(depth))
+            return false;
+        forever {
+            const QChar c = this->peek();
+            OpCode op;
+            if (c == QLatin1Char('*'))
+                op = OpMul;
+            else if (c == QLatin1Char('/'))
+                op = OpDiv;
+            else if (c == QLatin1Char('%'))
+                op = OpMod;
+            else
+                return true;
+            ++m_src;
+            if (!this->parseUnary(depth))
+                return false;
+            this->emitOp(op, 0, -1);
+        }
+    }
+
+    // unary := ('+' | '-') unary | primary
+    bool parseUnary(int depth)
+    {
+        const QChar c = this->peek();
+        if (c == QLatin1Char('+') || c == QLatin1Char('-')) {
+            ++m_src;
+            // Reject "++" and "--" (increment/decrement operators)
+            if (m_src != m_end && *m_src == c)
+                return false;
+            if (depth > MaxStackSize || !this->parseUnary(depth + 1))
+                return false;
+            if (c == QLatin1Char('-'))
+                this->emitOp(OpNeg, 0, 0);
+            return true;
+        }
+        return this->parsePrimary(depth);
+    }
+
+    // primary := number | identifier | identifier '(' args ')' | '(' expr ')'
+    bool parsePrimary(int depth)
+    {
+        const QChar c = this->peek();
+        if (c == QLatin1Char('(')) {
+            ++m_src;
+            if (!this->parseExpression(depth + 1) || this->peek() != QLatin1Char(')'))
+                return false;
+            ++m_src;
+            return true;
+        }
+        if (c.isDigit() || c == QLatin1Char('.'))
+            return this->parseNumber();
+        if (isIdentifierStart(c))
+            return this->parseIdentifier(depth);
+        return false;
+    }
+
+    bool parseNumber()
+    {
+        const QChar* begin = m_src;
+        while (m_src != m_end && m_src->isDigit())
+            ++m_src;
+        if (m_src != m_end && *m_src == QLatin1Char('.')) {
+            ++m_src;
+            while (m_src != m_end && m_src->isDigit())
+                ++m_src;
+        }
+        if (m_src - begin == 1 && *begin == QLatin1Char('.'))
+            return false;
+        if (m_src != m_end
+                && (*m_src == QLatin1Char('e') || *m_src == QLatin1Char('E')))
+        {
+            ++m_src;
+            if (m_src != m_end
+                    && (*m_src == QLatin1Char('+') || *m_src == QLatin1Char('-')))
+            {
+                ++m_src;
+            }
+            if (m_src == m_end || !m_src->isDigit())
+                return false;
+            while (m_src != m_end && m_src->isDigit())
+                ++m_src;
+        }
+        // Reject "0x1F", "1.5.2", "2px", ...
+        if (m_src != m_end
+                && (m_src->isLetterOrNumber() || *m_src == QLatin1Char('.')
+                    || *m_src == QLatin1Char('_') || *m_src == QLatin1Char('$')))
+        {
+            return false;
+        }
+        // Reject legacy octal literals ("012")
+        if (m_src - begin > 1 && *begin == QLatin1Char('0') && begin[1].isDigit())
+            return false;
+
+        bool ok = false;
+        const double value =
+                QString(begin, static_cast<int>(m_src - begin)).toDouble(&ok);
+        if (!ok)
+            return false;
+        m_program->m_constants.push_back(value);
+        this->emitOp(OpPushConst, static_cast<int>(m_program->m_constants.size()) - 1, 1);
+        return true;
+    }
+
+    bool parseIdentifier(int depth)
+    {
+        const QChar* begin = m_src;
+        while (m_src != m_end && isIdentifierPart(*m_src))
+            ++m_src;
+        const QString ident(begin, static_cast<int>(m_src - begin));
+
+        if (this->peek() != QLatin1Char('(')) {
+            int constId = -1;
+            for (std::size_t i = 0; i < sizeof(builtinConstants) / sizeof(BuiltinConstant); ++i) {
+                if (ident == QLatin1String(builtinConstants[i].name))
+                    constId = static_cast<int>(i);
+            }
+            const int nameId = this->addName(
+                        ident,
+                        false,
+                        constId != -1,
+                        constId != -1 ? builtinConstants[constId].value : 0.);
+            if (nameId == -1)
+                return false;
+            this->emitOp(OpPushName, nameId, 1);
+            return true;
+        }
+
+        // Function call
+        int fnId = -1;
+        for (std::size_t i = 0; i < sizeof(builtinFunctions) / sizeof(BuiltinFunction); ++i) {
+            if (ident == QLatin1String(builtinFunctions[i].name))
+                fnId = static_cast<int>(i);
+        }
+        // Functions are looked up too, so a variable shadowing a function
+        // makes evaluation go through the script engine
+        if (fnId == -1 || this->addName(ident, true, false, 0.) == -1)
+            return false;
+        ++m_src; // Skip '('
+        int argCount = 0;
+        if (this->peek() == QLatin1Char(')')) {
+            ++m_src;
+        }
+        else {
+            forever {
+                if (!this->parseExpression(depth + 1))
+                    return false;
+                ++argCount;
+                const QChar c = this->peek();
+                ++m_src;
+                if (c == QLatin1Char(')'))
+                    break;
+                if (c != QLatin1Char(','))
+                    return false;
+            }
+        }
+        if (argCount != builtinFunctions[fnId].argCount)
+            return false;
+        const OpCode op = argCount == 0 ? OpCall0 : (argCount == 1 ? OpCall1 : OpCall2);
+        if (op == OpCall0)
+            m_program->m_isReentrant = false;
+        this->emitOp(op, fnId, 1 - argCount);
+        return true;
+    }
+
+    int addName(const QString& text, bool isFunction, bool hasDefault, double defaultValue)
+    {
+        std::vector<Name>& names = m_program->m_names;
+        for (std::size_t i = 0; i < names.size(); ++i) {
+            if (names.at(i).text == text && names.at(i).isFunction == isFunction)
+                return static_cast<int>(i);
+        }
+        if (names.size() >= static_cast<std::size_t>(MaxNameCount))
+            return -1;
+        Name name;
+        name.text = text;
+        name.isFunction = isFunction;
+        name.hasDefaultValue = hasDefault;
+        name.defaultValue = defaultValue;
+        names.push_back(name);
+        return static_cast<int>(names.size()) - 1;
+    }
+
+    void emitOp(OpCode op, int arg, int stackDelta)
+    {
+        Instruction instr;
+        instr.op = op;
+        instr.arg = arg;
+        m_program->m_code.push_back(instr);
+        m_stackSize += stackDelta;
+        m_maxStackSize = std::max(m_maxStackSize, m_stackSize);
+    }
+
+    //! Next non-space character, null at end of source
+    QChar peek()
+    {
+        while (m_src != m_end && m_src->isSpace())
+            ++m_src;
+        return m_src != m_end ? *m_src : QChar();
+    }
+
+    static bool isIdentifierStart(QChar c)
+    {
+        return c.isLetter() || c == QLatin1Char('_') || c == QLatin1Char('$');
+    }
+
+    static bool isIdentifierPart(QChar c)
+    {
+        return c.isLetterOrNumber() || c == QLatin1Char('_') || c == QLatin1Char('$');
+    }
+
+    const QChar* m_src;
+    const QChar* const m_end;
+    ArithmeticProgram* m_program;
+    int m_stackSize;
+    int m_maxStackSize;
+};
+
+//! Compiles \p source, returns NULL if not plain arithmetic
+ArithmeticProgram* ArithmeticProgram::compile(const QString& source)
+{
+    std::unique_ptr<ArithmeticProgram> program(new ArithmeticProgram);
+    Parser parser(source, program.get());
+    if (!parser.parseExpression()
+            || !parser.isAtEnd()
+            || parser.maxStackSize() > MaxStackSize)
+    {
+        return NULL;
+    }
+    return program.release();
+}
+
+/*! Evaluates the program with \p variables bound
+ *
+ *  \returns \c false if some identifier cannot be resolved here (ex: global
+ *           variable of the script engine), so the script engine has to be
+ *           used instead
+ */
+bool ArithmeticProgram::evaluate(
+        const Calculator::Variables& variables, double* result) const
+{
+    double nameValues[MaxNameCount];
+    if (!this->resolveNames(variables, NULL, nameValues, NULL))
+        return false;
+    *result = this->run(nameValues);
+    return true;
+}
+
+/*! Evaluates the program for each row of \p columns, in chunks processed
+ *  concurrently by \p threadCount threads at most
+ *
+ *  \returns \c false if some identifier cannot be resolved, as evaluate()
+ */
+bool ArithmeticProgram::evaluateColumns(
+        const Calculator::VariableColumns& columns,
+        const Calculator::Variables& variables,
+        std::size_t rowCount,
+        double* results,
+        unsigned threadCount) const
+{
+    double nameValues[MaxNameCount];
+    const double* nameColumns[MaxNameCount];
+    if (!this->resolveNames(variables, &columns, nameValues, nameColumns))
+        return false;
+
+    // Names bound to columns, the others are constant for all rows
+    std::vector<int> columnNameIds;
+    for (std::size_t i = 0; i < m_names.size(); ++i) {
+        if (nameColumns[i] != NULL)
+            columnNameIds.push_back(static_cast<int>(i));
+    }
+
+    auto fnChunk = [&] (std::size_t iBegin, std::size_t iEnd) {
+        double rowNameValues[MaxNameCount];
+        std::copy(nameValues, nameValues + m_names.size(), rowNameValues);
+        for (std::size_t iRow = iBegin; iRow < iEnd; ++iRow) {
+            for (int nameId : columnNameIds)
+                rowNameValues[nameId] = nameColumns[nameId][iRow];
+            results[iRow] = this->run(rowNameValues);
+        }
+    };
+    cpp::parallelForRanges(
+                rowCount, fnChunk, m_isReentrant ? threadCount : 1, 4096);
+    return true;
+}
+
+/*! Gives the value of each name of the program : the column of \p columns
+ *  (if not NULL), or the variable, or the default value
+ *
+ *  \returns \c false if some name cannot be resolved, or if some function
+ *           is shadowed by a variable
+ */
+bool ArithmeticProgram::resolveNames(
+        const Calculator::Variables& variables,
+        const Calculator::VariableColumns* columns,
+        double* nameValues,
+        const double** nameColumns) const
+{
+    for (std::size_t i = 0; i < m_names.size(); ++i) {
+        const Name& name = m_names[i];
+        nameValues[i] = 0.;
+        if (nameColumns != NULL)
+            nameColumns[i] = NULL;
+        if (columns != NULL) {
+            const auto itColumn = columns->find(name.text);
+            if (itColumn != columns->constEnd()) {
+                if (name.isFunction || itColumn.value() == NULL)
+                    return false;
+                nameColumns[i] = itColumn.value();
+                continue;
+            }
+        }
+        const auto itVar = variables.find(name.text);
+        if (itVar != variables.constEnd()) {
+            if (name.isFunction)
+                return false;
+            nameValues[i] = itVar.value();
+        }
+        else if (name.hasDefaultValue) {
+            nameValues[i] = name.defaultValue;
+        }
+        else if (!name.isFunction) {
+            return false;
+        }
+    }
+    return true;
+}
+
+//! Runs the instructions of the program with values of its names
+double ArithmeticProgram::run(const double* nameValues) const
+{
+    double stack[MaxStackSize];
+    int top = -1;
+    for (const Instruction& instr : m_code) {
+        switch (instr.op) {
+        case OpPushConst: stack[++top] = m_constants[instr.arg]; break;
+        case OpPushName: stack[++top] = nameValues[instr.arg]; break;
+        case OpAdd: --top; stack[top] += stack[top + 1]; break;
+        case OpSub: --top; stack[top] -= stack[top + 1]; break;
+        case OpMul: --top; stack[top] *= stack[top + 1]; break;
+        case OpDiv: --top; stack[top] /= stack[top + 1]; break;
+        case OpMod: --top; stack[top] = std::fmod(stack[top], stack[top + 1]); break;
+        case OpNeg: stack[top] = -stack[top]; break;
+        case OpCall0: stack[++top] = builtinFunctions[instr.arg].fn0(); break;
+        case OpCall1: stack[top] = builtinFunctions[instr.arg].fn1(stack[top]); break;
+        case OpCall2:
+            --top;
+            stack[top] = builtinFunctions[instr.arg].fn2(stack[top], stack[top + 1]);
+            break;
+        }
+    }
+    return stack[0];
+}
+
+typedef QThreadStorage<Calculator*> CalculatorThreadStorage;
+
+} // namespace internal
+
+Q_GLOBAL_STATIC(internal::CalculatorThreadStorage, calculatorThreadStorage)
+
 /*!
  * \class Calculator
  * \brief Provides evaluation of expressions
  *
+ * Programs are compiled once(QScriptProgram) and kept in a LRU cache keyed
+ * by their source text, so evaluating again the same expression with other
+ * variable values does not parse it again :
+ * \code
+ *   qtscript::Calculator calc;
+ *   qtscript::Calculator::Variables vars;
+ *   for (double x : values) {
+ *       vars.insert("x", x);
+ *       calc.evaluate("2*(3.5+x)", vars);
+ *   }
+ * \endcode
+ *
+ * Plain arithmetic expressions (numbers, variables, + - * / %, parentheses
+ * and the functions/constants defined by the evaluation script) are compiled
+ * to a native form evaluated without the script engine, which is far cheaper.
+ * Other expressions are evaluated by the script engine, see
+ * setNativeEvaluationEnabled().
+ *
  * \note Author of the evaluation script is Yves Bailly (kafka DOT fr AT laposte DOT net)
  *
  * \headerfile calculator.h <qttools/script/calculator.h>
@@ -28,7 +611,9 @@ namespace qtscript {
  */
 
 Calculator::Calculator()
-    : m_lastResult(0)
+    : m_lastResult(0),
+      m_programCacheCapacity(256),
+      m_isNativeEvaluationEnabled(true)
 {
     m_scriptEngine.evaluate(
                 "var PI = Math.PI\n"
@@ -66,7 +651,186 @@ Calculator::Calculator()
 
 void Calculator::evaluate(const QString& program)
 {
+    this->evaluate(program, Variables());
+}
+
+/*! \brief Calculator dedicated to the current thread, created on first call
+ *
+ *  Constructing a Calculator is expensive (script engine startup plus
+ *  evaluation of the preloaded script), and a Calculator cannot be shared by
+ *  threads. This function gives access to one Calculator per thread, so
+ *  parallel tasks (ex: qttask::parallelFor()) pay for the construction once
+ *  per worker thread instead of once per task :
+ *  \code
+ *    qttask::parallelFor(progress, rows.size(), 256, [&] (std::size_t i) {
+ *        qtscript::Calculator* calc = qtscript::Calculator::forCurrentThread();
+ *        calc->evaluate(formula, rows.at(i));
+ *        results[i] = calc->lastResult();
+ *    });
+ *  \endcode
+ *
+ *  The Calculator is deleted when its thread exits. As it is shared by all
+ *  the code running in the thread, prefer evaluate() overloads with
+ *  variables over globals declared with "var".
+ */
+Calculator* Calculator::forCurrentThread()
+{
+    internal::CalculatorThreadStorage* storage = calculatorThreadStorage();
+    if (!storage->hasLocalData())
+        storage->setLocalData(new Calculator);
+    return storage->localData();
+}
+
+/*! Same as evaluate(compile(program), variables), but uses the native
+ *  evaluation when \p program is plain arithmetic
+ */
+void Calculator::evaluate(const QString& program, const Variables& variables)
+{
+    const CacheEntry& entry = this->cacheEntry(program);
+    double result = 0.;
+    if (m_isNativeEvaluationEnabled
+            && entry.arithmeticProgram
+            && entry.arithmeticProgram->evaluate(variables, &result))
+    {
+        m_scriptEngine.clearExceptions();
+        m_lastResult = QScriptValue(result);
+        return;
+    }
+    this->evaluate(entry.program, variables);
+}
+
+/*! Evaluates \p program with \p variables bound
+ *
+ *  The variables are visible to \p program only, they live in a dedicated
+ *  context that is discarded afterwards (as any variable declared by
+ *  \p program)
+ */
+void Calculator::evaluate(
+        const QScriptProgram& program, const Variables& variables)
+{
+    if (variables.isEmpty()) {
+        m_lastResult = m_scriptEngine.evaluate(program);
+        return;
+    }
+
+    QScriptContext* context = m_scriptEngine.pushContext();
+    QScriptValue activation = context->activationObject();
+    for (auto it = variables.constBegin(); it != variables.constEnd(); ++it)
+        activation.setProperty(it.key(), QScriptValue(it.value()));
     m_lastResult = m_scriptEngine.evaluate(program);
+    m_scriptEngine.popContext();
+}
+
+/*! Evaluates \p program once per row, for \p rowCount rows
+ *
+ *  For row \c i, each variable named in \p columns has the value
+ *  \c columns[name][i]. Other variables are taken from \p variables (same
+ *  for all rows). Result of row \c i is written to \c results[i] (NaN if not
+ *  a number).
+ *
+ *  When \p program is plain arithmetic (see setNativeEvaluationEnabled()),
+ *  rows are evaluated natively in a tight loop, split in chunks processed by
+ *  at most \p threadCount threads (0 means as many as the hardware supports).
+ *  Otherwise rows are evaluated one by one with the script engine, in the
+ *  calling thread.
+ *
+ *  \return \c true if all rows were evaluated, \c false if the script engine
+ *          failed on some row (lastErrorText() gives the error, remaining
+ *          rows are left unchanged)
+ */
+bool Calculator::evaluateColumns(
+        const QString& program,
+        const VariableColumns& columns,
+        std::size_t rowCount,
+        double* results,
+        const Variables& variables,
+        unsigned threadCount)
+{
+    const CacheEntry& entry = this->cacheEntry(program);
+    if (m_isNativeEvaluationEnabled
+            && entry.arithmeticProgram
+            && entry.arithmeticProgram->evaluateColumns(
+                columns, variables, rowCount, results, threadCount))
+    {
+        m_scriptEngine.clearExceptions();
+        if (rowCount > 0)
+            m_lastResult = QScriptValue(results[rowCount - 1]);
+        return true;
+    }
+
+    QScriptContext* context = m_scriptEngine.pushContext();
+    QScriptValue activation = context->activationObject();
+    for (auto it = variables.constBegin(); it != variables.constEnd(); ++it)
+        activation.setProperty(it.key(), QScriptValue(it.value()));
+    bool ok = true;
+    for (std::size_t iRow = 0; iRow < rowCount && ok; ++iRow) {
+        for (auto it = columns.constBegin(); it != columns.constEnd(); ++it)
+            activation.setProperty(it.key(), QScriptValue(it.value()[iRow]));
+        m_lastResult = m_scriptEngine.evaluate(entry.program);
+        ok = !m_scriptEngine.hasUncaughtException();
+        if (ok) {
+            results[iRow] =
+                    m_lastResult.isNumber() ?
+                        m_lastResult.toNumber() :
+                        std::numeric_limits<double>::quiet_NaN();
+        }
+    }
+    m_scriptEngine.popContext();
+    return ok;
+}
+
+/*! Returns the compiled form of \p program, taken from the cache if
+ *  \p program was already compiled
+ */
+QScriptProgram Calculator::compile(const QString& program)
+{
+    return this->cacheEntry(program).program;
+}
+
+/*! Maximum count of compiled programs kept in cache
+ *
+ *  Default is \c 256
+ */
+int Calculator::programCacheCapacity() const
+{
+    return m_programCacheCapacity;
+}
+
+void Calculator::setProgramCacheCapacity(int capacity)
+{
+    m_programCacheCapacity = qMax(capacity, 1);
+    this->evictOverflowPrograms();
+}
+
+int Calculator::programCacheCount() const
+{
+    return m_programCacheIndex.size();
+}
+
+void Calculator::clearProgramCache()
+{
+    m_programCacheIndex.clear();
+    m_programCache.clear();
+}
+
+/*! Whether plain arithmetic expressions are evaluated natively instead of
+ *  through the script engine
+ *
+ *  Identifiers are first looked up in the variables passed to evaluate(),
+ *  then in the constants of the evaluation script (PI, ...). If an identifier
+ *  is not found (ex: global variable previously declared with "var"), the
+ *  script engine is used.
+ *
+ *  Enabled by default
+ */
+bool Calculator::isNativeEvaluationEnabled() const
+{
+    return m_isNativeEvaluationEnabled;
+}
+
+void Calculator::setNativeEvaluationEnabled(bool on)
+{
+    m_isNativeEvaluationEnabled = on;
 }
 
 bool Calculator::hasResult() const
@@ -95,4 +859,32 @@ QString Calculator::lastResultText() const
     return m_lastResult.toString();
 }
 
+//! Cache entry of \p program, created if \p program is not yet cached
+const Calculator::CacheEntry& Calculator::cacheEntry(const QString& program)
+{
+    auto itIndex = m_programCacheIndex.find(program);
+    if (itIndex != m_programCacheIndex.end()) {
+        // Move to front, std::list::splice() keeps iterators valid
+        m_programCache.splice(m_programCache.begin(), m_programCache, itIndex.value());
+        return m_programCache.front();
+    }
+
+    m_programCache.push_front(CacheEntry());
+    CacheEntry& entry = m_programCache.front();
+    entry.source = program;
+    entry.program = QScriptProgram(program);
+    entry.arithmeticProgram.reset(internal::ArithmeticProgram::compile(program));
+    m_programCacheIndex.insert(program, m_programCache.begin());
+    this->evictOverflowPrograms();
+    return m_programCache.front();
+}
+
+void Calculator::evictOverflowPrograms()
+{
+    while (m_programCacheIndex.size() > m_programCacheCapacity) {
+        m_programCacheIndex.remove(m_programCache.back().source);
+        m_programCache.pop_back();
+    }
+}
+
 } // namespace qtscript
@@ -16,16 +16,50 @@
 #pragma once
 
 #include "script.h"
+#include <QtCore/QHash>
 #include <QtScript/QScriptEngine>
+#include <QtScript/QScriptProgram>
+#include <cstddef>
+#include <list>
+#include <memory>
 
 namespace qtscript {
 
+namespace internal { class ArithmeticProgram; }
+
 class QTTOOLS_SCRIPT_EXPORT Calculator
 {
 public:
     Calculator();
 
+    static Calculator* forCurrentThread();
+
+    typedef QHash<QString, double> Variables;
+
     void evaluate(const QString& program);
+    void evaluate(const QString& program, const Variables& variables);
+    void evaluate(const QScriptProgram& program,
+                  const Variables& variables = Variables());
+    QScriptProgram compile(const QString& program);
+
+    typedef QHash<QString, const double*> VariableColumns;
+
+    bool evaluateColumns(
+            const QString& program,
+            const VariableColumns& columns,
+            std::size_t rowCount,
+            double* results,
+            const Variables& variables = Variables(),
+            unsigned threadCount = 1);
+
+    int programCacheCapacity() const;
+    void setProgramCacheCapacity(int capacity);
+    int programCacheCount() const;
+    void clearProgramCache();
+
+    bool isNativeEvaluationEnabled() const;
+    void setNativeEvaluationEnabled(bool on);
+
     bool hasResult() const;
     QString lastErrorText() const;
 
@@ -33,8 +67,22 @@ public:
     QString lastResultText() const;
 
 private:
+    struct CacheEntry
+    {
+        QString source;
+        QScriptProgram program;
+        std::shared_ptr<const internal::ArithmeticProgram> arithmeticProgram;
+    };
+
+    const CacheEntry& cacheEntry(const QString& program);
+    void evictOverflowPrograms();
+
     QScriptEngine m_scriptEngine;
     QScriptValue m_lastResult;
+    int m_programCacheCapacity;
+    bool m_isNativeEvaluationEnabled;
+    std::list<CacheEntry> m_programCache; // Most recently used first
+    QHash<QString, std::list<CacheEntry>::iterator> m_programCacheIndex;
 };
 
 } // namespace qtscript
@@ -14,8 +14,6 @@
 ****************************************************************************/
 
 #include "composite_type_helper.h"
-#include <QtCore/QRegExp>
-#include <QtCore/QStringList>
 #include <QtCore/QtDebug>
 
 namespace qtsql {
@@ -24,30 +22,75 @@ namespace qtsql {
  * \class CompositeTypeHelper
  * \brief Provides helper services for the management of SQL composite types
  *
+ * Rows follow the PostgreSQL syntax of composite values : fields separated by
+ * commas inside parentheses. A field is double-quoted if it is a string or
+ * contains special characters, inside quotes a double quote is written
+ * \c "" and a backslash \c \\. An empty unquoted field is NULL.
+ *
  * \headerfile composite_type_helper.h <qttools/sql/composite_type_helper.h>
  * \ingroup qttools_sql
  */
 
+namespace internal {
+
+static void appendQuoted(const QString& str, QString* out)
+{
+    out->reserve(out->size() + str.size() + 2);
+    out->append(QLatin1Char('"'));
+    for (const QChar* it = str.constData(); it != str.constData() + str.size(); ++it) {
+        if (*it == QLatin1Char('"') || *it == QLatin1Char('\\'))
+            out->append(*it); // Doubled
+        out->append(*it);
+    }
+    out->append(QLatin1Char('"'));
+}
+
+} // namespace internal
+
+//! Encodes \p values as a composite row, ex: (1,"abc",TRUE)
 QString CompositeTypeHelper::toRow(const QList<QVariant>& values)
 {
-    QStringList valuesStr;
-    foreach (const QVariant& value, values) {
+    QString row;
+    CompositeTypeHelper::appendRow(values, &row);
+    return row;
+}
+
+/*! \brief Same as toRow() but appends the row to \p out
+ *
+ *  Encoding is done in one pass, without temporary strings for strings and
+ *  integers. Reusing \p out for many rows avoids reallocations.
+ *
+ *  An invalid QVariant is encoded as NULL.
+ */
+void CompositeTypeHelper::appendRow(const QList<QVariant>& values, QString* out)
+{
+    out->append(QLatin1Char('('));
+    QString numberStr;
+    for (int i = 0; i < values.size(); ++i) {
+        if (i != 0)
+            out->append(QLatin1Char(','));
+        const QVariant& value = values.at(i);
         switch (value.type()) {
+        case QVariant::Invalid:
+            break; // NULL
         case QVariant::Char:
         case QVariant::String:
-            valuesStr += QString("\"%1\"").arg(value.toString());
+            internal::appendQuoted(value.toString(), out);
             break;
-        case QVariant::ULongLong:
-        case QVariant::UInt:
         case QVariant::Int:
         case QVariant::LongLong:
+            out->append(numberStr.setNum(value.toLongLong()));
+            break;
+        case QVariant::UInt:
+        case QVariant::ULongLong:
+            out->append(numberStr.setNum(value.toULongLong()));
+            break;
         case QVariant::Double:
-            valuesStr += QString("%1").arg(value.toString());
+            out->append(value.toString());
             break;
-        case QVariant::Bool: {
-            valuesStr += (value.toBool() ? QLatin1String("TRUE") : QLatin1String("FALSE"));
+        case QVariant::Bool:
+            out->append(value.toBool() ? QLatin1String("TRUE") : QLatin1String("FALSE"));
             break;
-        }
         default: {
 #ifndef QT_NO_DEBUG_OUTPUT
             qWarning() << "CompositeTypeHelper::toRow() : type not supported"
@@ -56,16 +99,67 @@ QString CompositeTypeHelper::toRow(const QList<QVariant>& values)
             break;
         }
         } // end switch()
-    } // end foreach()
-    return QString("(%1)").arg(valuesStr.join(QLatin1String(",")));
+    }
+    out->append(QLatin1Char(')'));
 }
 
+//! Decodes the fields of composite row \p row
 QStringList CompositeTypeHelper::toValues(const QString& row)
 {
-    QString sqlRow = row;
-    sqlRow.replace(QRegExp(QLatin1String("^\\(")), QString());
-    sqlRow.replace(QRegExp(QLatin1String("\\)$")), QString());
-    return sqlRow.split(QLatin1Char(','));
+    QStringList values;
+    CompositeTypeHelper::toValues(row, &values);
+    return values;
+}
+
+/*! \brief Same as toValues() but the fields are stored in \p values (cleared
+ *         first)
+ *
+ *  Decoding is done in one pass : surrounding parentheses are skipped, quotes
+ *  are removed and escaped characters are unescaped, commas inside quotes do
+ *  not separate fields. NULL fields are null QString objects, quoted empty
+ *  fields are empty (not null) strings.
+ */
+void CompositeTypeHelper::toValues(const QString& row, QStringList* values)
+{
+    values->clear();
+    const QChar* it = row.constData();
+    const QChar* end = it + row.size();
+    if (it != end && *it == QLatin1Char('('))
+        ++it;
+    if (it != end && *(end - 1) == QLatin1Char(')'))
+        --end;
+
+    QString field;
+    while (true) {
+        field.clear();
+        bool isQuoted = false;
+        bool isInQuotes = false;
+        for (; it != end && (isInQuotes || *it != QLatin1Char(',')); ++it) {
+            if (*it == QLatin1Char('"')) {
+                if (isInQuotes && it + 1 != end && *(it + 1) == QLatin1Char('"')) {
+                    field.append(*(++it)); // Doubled quote
+                }
+                else {
+                    isInQuotes = !isInQuotes;
+                    isQuoted = true;
+                }
+            }
+            else if (*it == QLatin1Char('\\') && it + 1 != end) {
+                field.append(*(++it));
+            }
+            else {
+                field.append(*it);
+            }
+        }
+
+        if (field.isEmpty())
+            values->append(isQuoted ? QString(QLatin1String("")) : QString());
+        else
+            values->append(field);
+        if (it == end)
+            break;
+        ++it; // Skip ','
+    }
 }
 
 } // namespace qtsql
@@ -17,6 +17,7 @@
 
 #include "sql.h"
 #include <QtCore/QList>
+#include <QtCore/QStringList>
 #include <QtCore/QVariant>
 
 namespace qtsql {
@@ -28,7 +29,10 @@ private:
 
 public:
     static QString toRow(const QList<QVariant>& values);
+    static void appendRow(const QList<QVariant>& values, QString* out);
+
     static QStringList toValues(const QString& row);
+    static void toValues(const QString& row, QStringList* values);
 };
 
 } // namespace qtsql
@@ -16,14 +16,31 @@
 #include "database_manager.h"
 
 #include "../../cpptools/memory_utils.h"
+#include "../../cpptools/profiling.h"
 
+#include <climits>
 #include <cstdio>
-#include <QtCore/QHash>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QList>
 #include <QtCore/QMutex>
 #include <QtCore/QMutexLocker>
-#include <QtCore/QTextStream>
+#include <QtCore/QPointer>
+#include <QtCore/QReadWriteLock>
+#include <QtCore/QRunnable>
+#include <QtCore/QSet>
+#include <QtCore/QThreadPool>
+#include <QtCore/QThreadStorage>
+#include <QtCore/QTimer>
 #include <QtCore/QUuid>
+#include <QtCore/QWaitCondition>
+
+#include <atomic>
+#include <memory>
+#include <unordered_map>
+#include "prepared_query_cache.h"
 #include "qsql_query_utils.h"
+#include "sql_log_writer.h"
+#include "sql_row_stream.h"
 
 namespace qtsql {
 
@@ -34,18 +51,197 @@ class DatabaseManager::Private
 {
 public:
     Private(const QSqlDatabase& refDb)
-        : m_refDatabase(refDb),
-          m_isSqlOutputEnabled(false)
+        : m_serial(++Private::serialSeq()),
+          m_queryCacheCapacity(64),
+          m_isResultCacheEnabled(false),
+          m_refDatabase(refDb),
+          m_isSqlOutputEnabled(false),
+          m_sqlOutputSampling(1),
+          m_sqlLogCounter(0),
+          m_maxPoolSize(qMax(QThread::idealThreadCount(), 1)),
+          m_idleTimeout(60 * 1000)
     {
         Q_ASSERT(QThread::currentThread() != NULL);
-        m_databases.insert(QThread::currentThread(), refDb);
+        m_databases.emplace(QThread::currentThread(), refDb);
+        m_asyncThreadPool.setMaxThreadCount(m_maxPoolSize);
+    }
+
+    //! Logs a statement with its execution time, on scope exit
+    class ScopedSqlLog
+    {
+    public:
+        ScopedSqlLog(const DatabaseManager* dbMgr,
+                     const QString& sqlCode,
+                     const QThread* inThread)
+            : m_dbMgr(dbMgr),
+              m_sqlCode(sqlCode),
+              m_inThread(inThread),
+              m_isEnabled(dbMgr->d->m_isSqlOutputEnabled)
+        {
+            if (m_isEnabled)
+                m_timer.start();
+        }
+
+        ~ScopedSqlLog()
+        {
+            if (m_isEnabled)
+                m_dbMgr->logSql(m_sqlCode, m_inThread, m_timer.nsecsElapsed() / 1000);
+        }
+
+    private:
+        const DatabaseManager* m_dbMgr;
+        const QString& m_sqlCode;
+        const QThread* m_inThread;
+        const bool m_isEnabled;
+        QElapsedTimer m_timer;
+    };
+
+    class AsyncJob : public QRunnable
+    {
+    public:
+        AsyncJob(const std::function<void()>& func) : m_func(func) {}
+        void run() override { m_func(); }
+    private:
+        std::function<void()> m_func;
+    };
+
+    /*! Per-thread cache of the connection of one DatabaseManager
+     *
+     *  m_serial identifies the DatabaseManager, so data left by a destroyed
+     *  manager (QThreadStorage slots are reused) is never taken for valid
+     */
+    struct ThreadCache
+    {
+        ThreadCache() : serial(0), db(NULL), queryCache(NULL) {}
+        quint64 serial;
+        const QSqlDatabase* db;
+        PreparedQueryCache* queryCache;
+    };
+
+    static std::atomic<quint64>& serialSeq()
+    {
+        static std::atomic<quint64> seq(0);
+        return seq;
+    }
+
+    //! Connection of \p inThread, NULL if none
+    const QSqlDatabase* findDatabase(const QThread* inThread)
+    {
+        const bool isCurrentThread = inThread == QThread::currentThread();
+        if (isCurrentThread) {
+            const ThreadCache& cache = m_threadCache.localData();
+            if (cache.serial == m_serial && cache.db != NULL)
+                return cache.db;
+        }
+
+        QReadLocker locker(&m_databasesLock);
+        Q_UNUSED(locker);
+        auto it = m_databases.find(inThread);
+        if (it == m_databases.end())
+            return NULL;
+        if (isCurrentThread)
+            this->cacheDatabase(&(*it).second);
+        return &(*it).second;
+    }
+
+    //! Prepared query cache of \p inThread, created on first use
+    PreparedQueryCache* findQueryCache(const QThread* inThread, const QSqlDatabase& db)
+    {
+        const bool isCurrentThread = inThread == QThread::currentThread();
+        if (isCurrentThread) {
+            const ThreadCache& cache = m_threadCache.localData();
+            if (cache.serial == m_serial && cache.queryCache != NULL)
+                return cache.queryCache;
+        }
+
+        QWriteLocker locker(&m_databasesLock);
+        Q_UNUSED(locker);
+        std::unique_ptr<PreparedQueryCache>& queryCache = m_queryCaches[inThread];
+        if (!queryCache)
+            queryCache.reset(new PreparedQueryCache(db, m_queryCacheCapacity));
+        if (isCurrentThread)
+            this->threadCache().queryCache = queryCache.get();
+        return queryCache.get();
+    }
+
+    void cacheDatabase(const QSqlDatabase* db)
+    {
+        this->threadCache().db = db;
+    }
+
+    //! Thread cache of the current thread, reset if left by another manager
+    ThreadCache& threadCache()
+    {
+        ThreadCache& cache = m_threadCache.localData();
+        if (cache.serial != m_serial) {
+            cache = ThreadCache();
+            cache.serial = m_serial;
+        }
+        return cache;
+    }
+
+    struct IdleDatabase
+    {
+        QSqlDatabase db;
+        QElapsedTimer idleTime;
+    };
+
+    int poolSize() const
+    { return m_idleDatabases.size() + m_checkedOutNames.size(); }
+
+    static void removePooledDatabase(QSqlDatabase* db)
+    {
+        const QString connectionName = db->connectionName();
+        db->close();
+        *db = QSqlDatabase(); // removeDatabase() requires no copy left
+        QSqlDatabase::removeDatabase(connectionName);
+    }
+
+    //! A negative \p idleTimeout never expires, see closeIdleDatabases()
+    void evictIdleDatabases(int idleTimeout)
+    {
+        for (int i = m_idleDatabases.size() - 1; i >= 0; --i) {
+            if (m_idleDatabases.at(i).idleTime.hasExpired(idleTimeout)) {
+                QSqlDatabase db = m_idleDatabases.at(i).db;
+                m_idleDatabases.removeAt(i);
+                removePooledDatabase(&db);
+            }
+        }
+    }
+
+    void closeIdleDatabases()
+    {
+        while (!m_idleDatabases.isEmpty()) {
+            QSqlDatabase db = m_idleDatabases.takeLast().db;
+            removePooledDatabase(&db);
+        }
     }
 
-    QHash<const QThread*, QSqlDatabase> m_databases;
+    const quint64 m_serial;
+    // Node-based map, addresses of values stay valid for ThreadCache::db
+    std::unordered_map<const QThread*, QSqlDatabase> m_databases;
+    QReadWriteLock m_databasesLock;
+    std::unordered_map<const QThread*, std::unique_ptr<PreparedQueryCache>> m_queryCaches;
+    QThreadStorage<ThreadCache> m_threadCache;
+    int m_queryCacheCapacity;
+
+    std::atomic<bool> m_isResultCacheEnabled;
+    QueryResultCache m_resultCache; // Thread-safe
+
+    QThreadPool m_asyncThreadPool;
     QSqlDatabase m_refDatabase;
-    QMutex m_mutex;
-    bool m_isSqlOutputEnabled;
-    QTextStream m_sqlOutStream;
+    std::atomic<bool> m_isSqlOutputEnabled;
+    std::atomic<int> m_sqlOutputSampling;
+    std::atomic<quint64> m_sqlLogCounter;
+    SqlLogWriter m_sqlLogWriter;
+
+    // Connection pool, guarded by m_poolMutex
+    QMutex m_poolMutex;
+    QWaitCondition m_poolCondition;
+    QList<IdleDatabase> m_idleDatabases; // Most recently returned last
+    QSet<QString> m_checkedOutNames;
+    int m_maxPoolSize;
+    int m_idleTimeout;
 };
 
 /*!
@@ -66,8 +262,14 @@ DatabaseManager::DatabaseManager(const QSqlDatabase& refDb)
 {
 }
 
+/*! Closes and removes the idle pooled connections, whatever idleTimeout()
+ *
+ *  Connections still checked out are left to their owner
+ */
 DatabaseManager::~DatabaseManager()
 {
+    d->m_asyncThreadPool.waitForDone();
+    d->closeIdleDatabases();
     delete d;
 }
 
@@ -84,13 +286,19 @@ bool DatabaseManager::isDatabaseOpen(const QThread* inThread) const
 
 bool DatabaseManager::hasDatabase(const QThread* inThread) const
 {
-    return d->m_databases.contains(inThread);
+    return d->findDatabase(inThread) != NULL;
 }
 
+/*! \brief Connection created for \p inThread with createDatabase()
+ *
+ *  Once found, the connection of the current thread is cached in thread-local
+ *  storage, so next calls from this thread take no lock.
+ */
 QSqlDatabase DatabaseManager::database(const QThread* inThread) const
 {
-    Q_ASSERT(this->hasDatabase(inThread));
-    return d->m_databases.value(inThread);
+    const QSqlDatabase* db = d->findDatabase(inThread);
+    Q_ASSERT(db != NULL);
+    return db != NULL ? *db : QSqlDatabase();
 }
 
 QSqlDatabase DatabaseManager::createDatabase(const QThread* inThread)
@@ -98,8 +306,11 @@ QSqlDatabase DatabaseManager::createDatabase(const QThread* inThread)
     if (this->hasDatabase(inThread))
         return this->database(inThread);
 
-    QMutexLocker locker(&(d->m_mutex));
+    QWriteLocker locker(&(d->m_databasesLock));
     Q_UNUSED(locker);
+    auto it = d->m_databases.find(inThread);
+    if (it != d->m_databases.end()) // Created by another thread meanwhile
+        return (*it).second;
 
     QSqlDatabase newDb = QSqlDatabase::cloneDatabase(this->referenceDatabase(),
                                                      QString("thread 0x%1--%2")
@@ -107,20 +318,354 @@ QSqlDatabase DatabaseManager::createDatabase(const QThread* inThread)
                                                      .arg(QUuid::createUuid().toString()));
     if (newDb.isValid())
         newDb.open();
-    d->m_databases.insert(inThread, newDb);
+    d->m_databases.emplace(inThread, newDb);
     return newDb;
 }
 
+/*! \brief Takes a connection from the pool, cloned from referenceDatabase()
+ *
+ *  Unlike createDatabase(), the connection is not bound to a QThread : it is
+ *  used by the calling thread until returnDatabase(), then it can be checked
+ *  out by any other thread. So short-lived worker threads (ex: of a
+ *  QThreadPool) neither leak connections nor pay the connect cost each time.
+ *
+ *  The most recently returned idle connection is reused first. If there is
+ *  none, a new connection is opened, unless maxPoolSize() connections are
+ *  already checked out : then the call blocks until one is returned, or
+ *  \p timeoutMsec is elapsed (-1 means no timeout).
+ *
+ *  \note Reusing a connection in another thread requires a driver supporting
+ *        it (ex: QSQLITE, QPSQL) as long as it is not used concurrently.
+ *
+ *  \returns An invalid QSqlDatabase on timeout or if referenceDatabase()
+ *           cannot be cloned
+ *
+ *  This function is thread-safe.
+ *  \sa PooledDatabase
+ */
+QSqlDatabase DatabaseManager::checkoutDatabase(int timeoutMsec)
+{
+    QElapsedTimer waitTime;
+    waitTime.start();
+    QMutexLocker locker(&(d->m_poolMutex));
+    Q_UNUSED(locker);
+
+    d->evictIdleDatabases(d->m_idleTimeout);
+    while (d->m_idleDatabases.isEmpty() && d->poolSize() >= d->m_maxPoolSize) {
+        const qint64 remainingMsec =
+                timeoutMsec >= 0 ? timeoutMsec - waitTime.elapsed() : -1;
+        if (timeoutMsec >= 0 && remainingMsec <= 0)
+            return QSqlDatabase();
+        d->m_poolCondition.wait(
+                    &(d->m_poolMutex),
+                    remainingMsec >= 0 ? static_cast<unsigned long>(remainingMsec) : ULONG_MAX);
+    }
+
+    QSqlDatabase db;
+    if (!d->m_idleDatabases.isEmpty()) {
+        db = d->m_idleDatabases.takeLast().db;
+    }
+    else {
+        db = QSqlDatabase::cloneDatabase(this->referenceDatabase(),
+                                         QString("pool--%1")
+                                         .arg(QUuid::createUuid().toString()));
+        if (db.isValid())
+            db.open();
+    }
+    if (db.isValid())
+        d->m_checkedOutNames.insert(db.connectionName());
+    return db;
+}
+
+/*! \brief Gives back to the pool a connection obtained with checkoutDatabase()
+ *
+ *  Closed connections are removed instead of being reused. Connections not
+ *  coming from checkoutDatabase() are ignored.
+ *
+ *  This function is thread-safe.
+ */
+void DatabaseManager::returnDatabase(const QSqlDatabase& db)
+{
+    QMutexLocker locker(&(d->m_poolMutex));
+    Q_UNUSED(locker);
+
+    if (!d->m_checkedOutNames.remove(db.connectionName()))
+        return;
+
+    Private::IdleDatabase idleDb;
+    idleDb.db = db;
+    if (idleDb.db.isOpen()) {
+        idleDb.idleTime.start();
+        d->m_idleDatabases.append(idleDb);
+    }
+    else {
+        Private::removePooledDatabase(&idleDb.db);
+    }
+    d->evictIdleDatabases(d->m_idleTimeout);
+    d->m_poolCondition.wakeOne();
+}
+
+//! Closes the pooled connections left idle for more than idleTimeout()
+void DatabaseManager::evictIdleDatabases()
+{
+    QMutexLocker locker(&(d->m_poolMutex));
+    Q_UNUSED(locker);
+    d->evictIdleDatabases(d->m_idleTimeout);
+}
+
+/*! \brief Maximum count of pooled connections (idle or checked out)
+ *
+ *  Default is QThread::idealThreadCount()
+ */
+int DatabaseManager::maxPoolSize() const
+{
+    QMutexLocker locker(&(d->m_poolMutex));
+    Q_UNUSED(locker);
+    return d->m_maxPoolSize;
+}
+
+void DatabaseManager::setMaxPoolSize(int size)
+{
+    QMutexLocker locker(&(d->m_poolMutex));
+    Q_UNUSED(locker);
+    d->m_maxPoolSize = qMax(size, 1);
+    d->m_asyncThreadPool.setMaxThreadCount(d->m_maxPoolSize);
+    d->m_poolCondition.wakeAll();
+}
+
+/*! \brief Duration in milliseconds after which an idle pooled connection is
+ *         closed
+ *
+ *  Default is 60s. Eviction is done by checkoutDatabase(), returnDatabase()
+ *  and evictIdleDatabases().
+ */
+int DatabaseManager::idleTimeout() const
+{
+    QMutexLocker locker(&(d->m_poolMutex));
+    Q_UNUSED(locker);
+    return d->m_idleTimeout;
+}
+
+void DatabaseManager::setIdleTimeout(int msec)
+{
+    QMutexLocker locker(&(d->m_poolMutex));
+    Q_UNUSED(locker);
+    d->m_idleTimeout = msec;
+}
+
 QSqlQuery DatabaseManager::execSqlCode(const QString& sqlCode, const QThread* inThread) const
 {
-    this->logSql(sqlCode, inThread);
+    CPPTOOLS_PROFILE_ZONE("qtsql::DatabaseManager::execSqlCode");
+    Private::ScopedSqlLog sqlLog(this, sqlCode, inThread);
+    Q_UNUSED(sqlLog);
     return qtsql::execSqlCode(sqlCode, this->database(inThread));
 }
 
+//! Same as qtsql::execBatchInsert() on the connection of \p inThread
+void DatabaseManager::execBatchInsert(const QString& tableName,
+                                      const QStringList& columnNames,
+                                      const QList<QVariantList>& columnValues,
+                                      int batchSize,
+                                      const QThread* inThread) const
+{
+    const QString sqlLogCode =
+            this->isSqlOutputEnabled() ?
+                QString("-- batch insert of %1 rows into %2")
+                .arg(columnValues.isEmpty() ? 0 : columnValues.first().size())
+                .arg(tableName) :
+                QString();
+    Private::ScopedSqlLog sqlLog(this, sqlLogCode, inThread);
+    Q_UNUSED(sqlLog);
+    qtsql::execBatchInsert(
+                tableName, columnNames, columnValues, this->database(inThread), batchSize);
+    if (d->m_isResultCacheEnabled)
+        d->m_resultCache.invalidateTable(tableName);
+}
+
+/*! \brief Executes the prepared statement of \p sqlCode with positional
+ *         \p bindValues, on the connection of \p inThread
+ *
+ *  Statements are prepared once per connection and kept in a
+ *  PreparedQueryCache, see preparedQueryCache()
+ *
+ *  \throws SqlQueryError if the preparation or execution fails
+ */
+QSqlQuery DatabaseManager::execPreparedSqlCode(const QString& sqlCode,
+                                               const QVariantList& bindValues,
+                                               const QThread* inThread) const
+{
+    Private::ScopedSqlLog sqlLog(this, sqlCode, inThread);
+    Q_UNUSED(sqlLog);
+    return this->preparedQueryCache(inThread)->exec(sqlCode, bindValues);
+}
+
+/*! \brief Cache of the prepared statements of the connection of \p inThread
+ *
+ *  The cache is created on first use, with capacity
+ *  preparedQueryCacheCapacity(). It must only be used by \p inThread, as its
+ *  connection.
+ */
+PreparedQueryCache* DatabaseManager::preparedQueryCache(const QThread* inThread) const
+{
+    return d->findQueryCache(inThread, this->database(inThread));
+}
+
+//! Capacity of the caches created by preparedQueryCache(), default is 64
+int DatabaseManager::preparedQueryCacheCapacity() const
+{
+    QReadLocker locker(&(d->m_databasesLock));
+    Q_UNUSED(locker);
+    return d->m_queryCacheCapacity;
+}
+
+void DatabaseManager::setPreparedQueryCacheCapacity(int capacity)
+{
+    QWriteLocker locker(&(d->m_databasesLock));
+    Q_UNUSED(locker);
+    d->m_queryCacheCapacity = capacity;
+}
+
+/*! \brief Executes read-only \p sqlCode with positional \p bindValues, on the
+ *         connection of \p inThread, and returns all its rows
+ *
+ *  If isResultCacheEnabled(), the result is first looked up in resultCache()
+ *  and the database is queried only on a miss. \p tableNames are the tables
+ *  read by \p sqlCode, used by invalidateResultCache() : if empty they are
+ *  guessed with QueryResultCache::tableNamesOfSql().
+ *
+ *  Only cache misses reach the database, so only those are logged (see
+ *  logSql()).
+ *
+ *  \throws SqlQueryError if the execution fails, errors are not cached
+ */
+SqlResultTable DatabaseManager::execCachedSqlCode(const QString& sqlCode,
+                                                  const QVariantList& bindValues,
+                                                  const QStringList& tableNames,
+                                                  const QThread* inThread) const
+{
+    SqlResultTable result;
+    const bool isCacheEnabled = d->m_isResultCacheEnabled;
+    if (isCacheEnabled && d->m_resultCache.find(sqlCode, bindValues, &result))
+        return result;
+
+    {
+        Private::ScopedSqlLog sqlLog(this, sqlCode, inThread);
+        Q_UNUSED(sqlLog);
+        SqlRowStream rows(sqlCode, this->database(inThread), bindValues);
+        result = SqlResultTable::fetch(&rows);
+    }
+    if (isCacheEnabled) {
+        d->m_resultCache.insert(
+                    sqlCode,
+                    bindValues,
+                    !tableNames.isEmpty() ?
+                        tableNames :
+                        QueryResultCache::tableNamesOfSql(sqlCode),
+                    result);
+    }
+    return result;
+}
+
+/*! \brief Drops the cached results of the queries reading \p tableName
+ *
+ *  To be called after the table is modified. execBatchInsert() does it
+ *  automatically.
+ *
+ *  This function is thread-safe.
+ */
+void DatabaseManager::invalidateResultCache(const QString& tableName)
+{
+    d->m_resultCache.invalidateTable(tableName);
+}
+
+/*! \brief Holds whether execCachedSqlCode() uses resultCache()
+ *
+ *  Default value is \c false. Disabling the cache clears it.
+ */
+bool DatabaseManager::isResultCacheEnabled() const
+{
+    return d->m_isResultCacheEnabled;
+}
+
+void DatabaseManager::setResultCacheEnabled(bool on)
+{
+    d->m_isResultCacheEnabled = on;
+    if (!on)
+        d->m_resultCache.clear();
+}
+
+//! Cache of execCachedSqlCode(), shared by all threads (see its capacity and TTL)
+QueryResultCache* DatabaseManager::resultCache() const
+{
+    return &d->m_resultCache;
+}
+
+/*! \brief Executes \p sqlCode with positional \p bindValues in a worker
+ *         thread, so the calling thread never waits for the database
+ *
+ *  The query runs on a connection of the pool (see checkoutDatabase()), in a
+ *  thread pool owned by this manager whose size is maxPoolSize(). All the
+ *  records are fetched in the worker thread.
+ *
+ *  \p callback (if any) is called with the result in the thread of
+ *  \p context, typically a widget of the GUI thread. If \p context is NULL,
+ *  \p callback is called in the worker thread. The callback is not called if
+ *  \p context was destroyed meanwhile.
+ *
+ *  Errors do not throw, they are reported by SqlQueryResult::error.
+ *
+ *  This function is thread-safe.
+ */
+std::shared_future<SqlQueryResult> DatabaseManager::execSqlCodeAsync(
+        const QString& sqlCode,
+        const QVariantList& bindValues,
+        QObject* context,
+        AsyncQueryCallback callback)
+{
+    auto promise = std::make_shared<std::promise<SqlQueryResult>>();
+    std::shared_future<SqlQueryResult> future = promise->get_future().share();
+    const bool hasContext = context != NULL;
+    QPointer<QObject> contextPtr(context);
+    auto func = [=] {
+        SqlQueryResult result;
+        {
+            Private::ScopedSqlLog sqlLog(this, sqlCode, QThread::currentThread());
+            Q_UNUSED(sqlLog);
+            PooledDatabase pooledDb(this);
+            if (pooledDb.database().isOpen()) {
+                QSqlQuery qry(pooledDb.database());
+                qry.setForwardOnly(true);
+                if (qry.prepare(sqlCode)) {
+                    for (int i = 0; i < bindValues.size(); ++i)
+                        qry.bindValue(i, bindValues.at(i));
+                    qry.exec();
+                }
+                result = SqlQueryResult::fetch(&qry);
+            }
+            else {
+                result.error = QSqlError(QLatin1String("db is not valid or not open"),
+                                         QLatin1String(""),
+                                         QSqlError::ConnectionError);
+            }
+        }
+
+        promise->set_value(result);
+        if (callback) {
+            if (!hasContext)
+                callback(result);
+            else if (!contextPtr.isNull())
+                QTimer::singleShot(0, contextPtr.data(), [=] { callback(result); } );
+        }
+    };
+    d->m_asyncThreadPool.start(new Private::AsyncJob(func));
+    return future;
+}
+
 QSqlQuery DatabaseManager::execSqlCodeInTransaction(const QString& sqlCode,
                                                     const QThread* inThread) const
 {
-    this->logSql(sqlCode, inThread);
+    Private::ScopedSqlLog sqlLog(this, sqlCode, inThread);
+    Q_UNUSED(sqlLog);
     return qtsql::execSqlCodeInTransaction(sqlCode, this->database(inThread));
 }
 
@@ -134,30 +679,94 @@ void DatabaseManager::setSqlOutputEnabled(bool on)
     d->m_isSqlOutputEnabled = on;
 }
 
+/*! \brief Device where SQL statements are written when isSqlOutputEnabled()
+ *
+ *  Writing is done asynchronously by a background thread (see SqlLogWriter),
+ *  so \p device must support writes from a non-GUI thread (ex: QFile).
+ *  Statements already logged are written to the previous device before
+ *  switching.
+ */
 QIODevice* DatabaseManager::sqlOutputDevice() const
 {
-    return d->m_sqlOutStream.device();
+    return d->m_sqlLogWriter.device();
 }
 
 void DatabaseManager::setSqlOutputDevice(QIODevice* device)
 {
-    if (d->m_sqlOutStream.device() != device)
-        d->m_sqlOutStream.setDevice(device);
+    d->m_sqlLogWriter.setDevice(device);
+}
+
+/*! \brief Only one statement out of sqlOutputSampling() is logged
+ *
+ *  Default is 1 (all statements are logged)
+ */
+int DatabaseManager::sqlOutputSampling() const
+{
+    return d->m_sqlOutputSampling;
+}
+
+void DatabaseManager::setSqlOutputSampling(int everyN)
+{
+    d->m_sqlOutputSampling = qMax(everyN, 1);
 }
 
-void DatabaseManager::logSql(const QString &sqlCode, const QThread *inThread) const
+//! Blocks until the logged statements are written to sqlOutputDevice()
+void DatabaseManager::flushSqlOutput()
 {
-    if (sqlCode.trimmed().isEmpty())
+    d->m_sqlLogWriter.flush();
+}
+
+/*! \brief Called after execution of \p sqlCode when isSqlOutputEnabled()
+ *
+ *  \param durationUsec  Execution time in microseconds
+ *
+ *  Default implementation samples statements (see sqlOutputSampling()) and
+ *  queues them to the asynchronous writer of sqlOutputDevice()
+ */
+void DatabaseManager::logSql(const QString &sqlCode,
+                             const QThread *inThread,
+                             qint64 durationUsec) const
+{
+    if (sqlCode.isEmpty() || !d->m_isSqlOutputEnabled)
         return;
 
-    if (d->m_isSqlOutputEnabled && d->m_sqlOutStream.device() != NULL) {
-        const QString threadObjectName = inThread != NULL ? inThread->objectName() : QString();
-        d->m_sqlOutStream << QString("[thread%1 0x%2] %3")
-                             .arg(threadObjectName)
-                             .arg(QString::number(reinterpret_cast<std::size_t>(inThread), 16))
-                             .arg(sqlCode)
-                          << endl;
-    }
+    const int sampling = d->m_sqlOutputSampling;
+    if (sampling > 1 && d->m_sqlLogCounter.fetch_add(1, std::memory_order_relaxed) % sampling != 0)
+        return;
+
+    d->m_sqlLogWriter.log(sqlCode, inThread, durationUsec);
+}
+
+/*! \class DatabaseManager::PooledDatabase
+ *  \brief Scoped checkout of a pooled connection
+ *
+ *  \code
+ *      qtsql::DatabaseManager::PooledDatabase pooledDb(dbMgr);
+ *      QSqlQuery query(pooledDb.database());
+ *  \endcode
+ *
+ * \headerfile database_manager.h <qttools/sql/database_manager.h>
+ * \ingroup qttools_sql
+ */
+
+//! Same as DatabaseManager::checkoutDatabase(\p timeoutMsec)
+DatabaseManager::PooledDatabase::PooledDatabase(
+        DatabaseManager* dbMgr, int timeoutMsec)
+    : m_dbMgr(dbMgr),
+      m_db(dbMgr->checkoutDatabase(timeoutMsec))
+{
+}
+
+DatabaseManager::PooledDatabase::~PooledDatabase()
+{
+    if (m_db.isValid())
+        m_dbMgr->returnDatabase(m_db);
+}
+
+//! Invalid if the checkout timed out
+const QSqlDatabase& DatabaseManager::PooledDatabase::database() const
+{
+    return m_db;
 }
 
 } // namespace qtsql
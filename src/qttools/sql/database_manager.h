@@ -16,13 +16,22 @@
 #pragma once
 
 #include "sql.h"
+#include "qsql_query_utils.h"
+#include "query_result_cache.h"
 #include <QtCore/QThread>
+#include <QtCore/QStringList>
+#include <QtCore/QVariantList>
 #include <QtSql/QSqlDatabase>
 #include <QtSql/QSqlQuery>
+#include <functional>
+#include <future>
 class QIODevice;
+class QObject;
 
 namespace qtsql {
 
+class PreparedQueryCache;
+
 class QTTOOLS_SQL_EXPORT DatabaseManager
 {
 public:
@@ -36,11 +45,57 @@ public:
     QSqlDatabase database(const QThread* inThread = QThread::currentThread()) const;
     virtual QSqlDatabase createDatabase(const QThread* inThread = QThread::currentThread());
 
+    // Connection pool
+    QSqlDatabase checkoutDatabase(int timeoutMsec = -1);
+    void returnDatabase(const QSqlDatabase& db);
+    void evictIdleDatabases();
+
+    int maxPoolSize() const;
+    void setMaxPoolSize(int size);
+
+    int idleTimeout() const;
+    void setIdleTimeout(int msec);
+
+    class PooledDatabase;
+
     virtual QSqlQuery execSqlCode(const QString& sqlCode,
                                   const QThread* inThread = QThread::currentThread()) const;
     virtual QSqlQuery execSqlCodeInTransaction(const QString& sqlCode,
                                                const QThread* inThread = QThread::currentThread()) const;
 
+    void execBatchInsert(const QString& tableName,
+                         const QStringList& columnNames,
+                         const QList<QVariantList>& columnValues,
+                         int batchSize = 1000,
+                         const QThread* inThread = QThread::currentThread()) const;
+
+    // Prepared statements
+    QSqlQuery execPreparedSqlCode(const QString& sqlCode,
+                                  const QVariantList& bindValues = QVariantList(),
+                                  const QThread* inThread = QThread::currentThread()) const;
+    PreparedQueryCache* preparedQueryCache(const QThread* inThread = QThread::currentThread()) const;
+    int preparedQueryCacheCapacity() const;
+    void setPreparedQueryCacheCapacity(int capacity);
+
+    // Result cache
+    SqlResultTable execCachedSqlCode(const QString& sqlCode,
+                                     const QVariantList& bindValues = QVariantList(),
+                                     const QStringList& tableNames = QStringList(),
+                                     const QThread* inThread = QThread::currentThread()) const;
+    void invalidateResultCache(const QString& tableName);
+
+    bool isResultCacheEnabled() const;
+    void setResultCacheEnabled(bool on);
+    QueryResultCache* resultCache() const;
+
+    // Asynchronous execution
+    typedef std::function<void(const SqlQueryResult&)> AsyncQueryCallback;
+    std::shared_future<SqlQueryResult> execSqlCodeAsync(
+            const QString& sqlCode,
+            const QVariantList& bindValues = QVariantList(),
+            QObject* context = NULL,
+            AsyncQueryCallback callback = AsyncQueryCallback());
+
     // SQL output
     bool isSqlOutputEnabled() const;
     void setSqlOutputEnabled(bool on);
@@ -48,12 +103,40 @@ public:
     QIODevice* sqlOutputDevice() const;
     void setSqlOutputDevice(QIODevice* device);
 
+    int sqlOutputSampling() const;
+    void setSqlOutputSampling(int everyN);
+
+    void flushSqlOutput();
+
 protected:
-    virtual void logSql(const QString& sqlCode, const QThread* inThread) const;
+    virtual void logSql(const QString& sqlCode,
+                        const QThread* inThread,
+                        qint64 durationUsec = -1) const;
 
 private:
     class Private;
     Private* const d;
 };
 
+/*! \brief Scoped checkout of a pooled connection
+ *
+ *  The connection is returned to the pool of the DatabaseManager on
+ *  destruction
+ */
+class QTTOOLS_SQL_EXPORT DatabaseManager::PooledDatabase
+{
+public:
+    PooledDatabase(DatabaseManager* dbMgr, int timeoutMsec = -1);
+    ~PooledDatabase();
+
+    const QSqlDatabase& database() const;
+
+private:
+    PooledDatabase(const PooledDatabase&);
+    PooledDatabase& operator=(const PooledDatabase&);
+
+    DatabaseManager* m_dbMgr;
+    QSqlDatabase m_db;
+};
+
 } // namespace qtsql
@@ -0,0 +1,350 @@
+/****************************************************************************
+**  FougTools
+**  Copyright Fougue (30 Mar. 2015)
+**  contact@fougue.pro
+**
+** This software is a computer program whose purpose is to provide utility
+** tools for the C++ language and the Qt toolkit.
+**
+** This software is governed by the CeCILL-C license under French law and
+** abiding by the rules of distribution of free software.  You can  use,
+** modify and/ or redistribute the software under the terms of the CeCILL-C
+** license as circulated by CEA, CNRS and INRIA at the following URL
+** "http://www.cecill.info".
+****************************************************************************/
+
+
+#include "pg_binary_copy.h"
+
+#include "qsql_query_utils.h"
+#include <QtCore/QtEndian>
+#include <QtCore/QtDebug>
+#include <QtSql/QSqlDriver>
+#include <cstring>
+
+#ifdef QTTOOLS_SQL_HAVE_LIBPQ
+# include <libpq-fe.h>
+#endif
+
+namespace qtsql {
+
+namespace internal {
+
+template<typename T>
+static void appendBigEndian(QByteArray* out, T value)
+{
+    uchar bytes[sizeof(T)];
+    qToBigEndian(value, bytes);
+    out->append(reinterpret_cast<const char*>(bytes), sizeof(T));
+}
+
+static void appendField(QByteArray* out, const char* data, int size)
+{
+    appendBigEndian<qint32>(out, size);
+    out->append(data, size);
+}
+
+//! Replaces the 4 bytes at \p pos with the count of bytes appended after them
+static void patchFieldSize(QByteArray* out, int pos)
+{
+    uchar bytes[4];
+    qToBigEndian<qint32>(out->size() - pos - 4, bytes);
+    std::memcpy(out->data() + pos, bytes, 4);
+}
+
+} // namespace internal
+
+/*!
+ * \class PgBinaryCopy
+ * \brief Provides encoding of rows in the binary format of PostgreSQL COPY
+ *
+ * Binary COPY data is a header, then for each row a field count followed by
+ * the size (-1 for NULL) and big-endian binary value of each field, then a
+ * trailer.
+ *
+ * \headerfile pg_binary_copy.h <qttools/sql/pg_binary_copy.h>
+ * \ingroup qttools_sql
+ */
+
+//! Appends the signature, flags and header extension of binary COPY data
+void PgBinaryCopy::appendHeader(QByteArray* out)
+{
+    static const char signature[] = "PGCOPY\n\377\r\n";
+    out->append(signature, sizeof(signature)); // Includes ending '\0'
+    internal::appendBigEndian<qint32>(out, 0); // Flags
+    internal::appendBigEndian<qint32>(out, 0); // Header extension length
+}
+
+void PgBinaryCopy::appendTrailer(QByteArray* out)
+{
+    internal::appendBigEndian<qint16>(out, -1);
+}
+
+void PgBinaryCopy::appendRowBegin(QByteArray* out, int fieldCount)
+{
+    internal::appendBigEndian<qint16>(out, static_cast<qint16>(fieldCount));
+}
+
+/*! \brief Appends a field encoding \p value as PostgreSQL type \p typeOid
+ *
+ *  An invalid or null QVariant is encoded as NULL. Unsupported type OIDs are
+ *  encoded as NULL too (with a warning).
+ */
+void PgBinaryCopy::appendValue(QByteArray* out, const QVariant& value, quint32 typeOid)
+{
+    if (value.isNull()) {
+        internal::appendBigEndian<qint32>(out, -1);
+        return;
+    }
+
+    switch (typeOid) {
+    case BoolOid: {
+        const char byte = value.toBool() ? 1 : 0;
+        internal::appendField(out, &byte, 1);
+        break;
+    }
+    case Int2Oid:
+        internal::appendBigEndian<qint32>(out, 2);
+        internal::appendBigEndian<qint16>(out, static_cast<qint16>(value.toInt()));
+        break;
+    case Int4Oid:
+        internal::appendBigEndian<qint32>(out, 4);
+        internal::appendBigEndian<qint32>(out, value.toInt());
+        break;
+    case Int8Oid:
+        internal::appendBigEndian<qint32>(out, 8);
+        internal::appendBigEndian<qint64>(out, value.toLongLong());
+        break;
+    case Float4Oid: {
+        const float f = value.toFloat();
+        quint32 bits;
+        std::memcpy(&bits, &f, sizeof(bits));
+        internal::appendBigEndian<qint32>(out, 4);
+        internal::appendBigEndian<quint32>(out, bits);
+        break;
+    }
+    case Float8Oid: {
+        const double d = value.toDouble();
+        quint64 bits;
+        std::memcpy(&bits, &d, sizeof(bits));
+        internal::appendBigEndian<qint32>(out, 8);
+        internal::appendBigEndian<quint64>(out, bits);
+        break;
+    }
+    case TextOid:
+    case VarcharOid: {
+        // Size is patched after in-place UTF-8 conversion, saving a copy
+        const int sizePos = out->size();
+        internal::appendBigEndian<qint32>(out, 0);
+        out->append(value.toString().toUtf8());
+        internal::patchFieldSize(out, sizePos);
+        break;
+    }
+    case ByteaOid: {
+        const QByteArray bytes = value.toByteArray();
+        internal::appendField(out, bytes.constData(), bytes.size());
+        break;
+    }
+    default:
+#ifndef QT_NO_DEBUG_OUTPUT
+        qWarning() << "PgBinaryCopy::appendValue() : type OID not supported" << typeOid;
+#endif // !QT_NO_DEBUG_OUTPUT
+        internal::appendBigEndian<qint32>(out, -1);
+        break;
+    }
+}
+
+/*! \brief Appends a field encoding \p values as a composite value (binary
+ *         format of PostgreSQL record_send())
+ *
+ *  \p fieldTypeOids gives the type of each field of the composite type, in
+ *  the same order as \p values
+ */
+void PgBinaryCopy::appendComposite(QByteArray* out,
+                                   const QList<QVariant>& values,
+                                   const QVector<quint32>& fieldTypeOids)
+{
+    const int sizePos = out->size();
+    internal::appendBigEndian<qint32>(out, 0);
+    internal::appendBigEndian<qint32>(out, fieldTypeOids.size());
+    for (int i = 0; i < fieldTypeOids.size(); ++i) {
+        const quint32 oid = fieldTypeOids.at(i);
+        internal::appendBigEndian<quint32>(out, oid);
+        PgBinaryCopy::appendValue(out, i < values.size() ? values.at(i) : QVariant(), oid);
+    }
+    internal::patchFieldSize(out, sizePos);
+}
+
+#ifdef QTTOOLS_SQL_HAVE_LIBPQ
+
+/*!
+ * \class PgCopyLoader
+ * \brief Provides bulk loading of rows into a PostgreSQL table with
+ *        COPY ... FROM STDIN (FORMAT binary)
+ *
+ * Rows are encoded with PgBinaryCopy into an in-memory buffer, which is sent
+ * through the libpq connection of the QPSQL driver each time it exceeds
+ * bufferSize. So memory is bounded whatever the count of rows.
+ *
+ * Only available when built with libpq (qmake CONFIG += qttools_sql_libpq).
+ *
+ * \headerfile pg_binary_copy.h <qttools/sql/pg_binary_copy.h>
+ * \ingroup qttools_sql
+ */
+
+namespace internal {
+
+static void throwCopyError(const char* pgError)
+{
+    throw SqlQueryError(QSqlError(QLatin1String("COPY failed"),
+                                  QString::fromUtf8(pgError),
+                                  QSqlError::StatementError));
+}
+
+} // namespace internal
+
+/*! \brief Starts COPY of \p columnNames into \p tableName
+ *
+ *  \param columnTypeOids  PostgreSQL type of each column (see
+ *                         PgBinaryCopy::TypeOid), ignored for composite
+ *                         columns (see setCompositeColumn())
+ *
+ *  \throws SqlQueryError if \p db is not an open QPSQL connection or if COPY
+ *          cannot start
+ */
+PgCopyLoader::PgCopyLoader(const QSqlDatabase& db,
+                           const QString& tableName,
+                           const QStringList& columnNames,
+                           const QVector<quint32>& columnTypeOids,
+                           int bufferSize)
+    : m_pgConn(NULL),
+      m_columnTypeOids(columnTypeOids),
+      m_compositeFieldTypeOids(columnTypeOids.size()),
+      m_bufferSize(qMax(bufferSize, 1024)),
+      m_rowCount(0),
+      m_isCopyActive(false)
+{
+    const QVariant handle = db.isOpen() ? db.driver()->handle() : QVariant();
+    if (!handle.isValid() || qstrcmp(handle.typeName(), "PGconn*") != 0) {
+        throw SqlQueryError(QSqlError(QLatin1String("db is not an open QPSQL connection"),
+                                      QLatin1String(""),
+                                      QSqlError::ConnectionError));
+    }
+    PGconn* pgConn = *static_cast<PGconn* const*>(handle.data());
+    m_pgConn = pgConn;
+
+    QStringList escapedColumnNames;
+    for (const QString& columnName : columnNames)
+        escapedColumnNames += db.driver()->escapeIdentifier(columnName, QSqlDriver::FieldName);
+    const QString sqlCode =
+            QString("COPY %1 (%2) FROM STDIN (FORMAT binary)")
+            .arg(db.driver()->escapeIdentifier(tableName, QSqlDriver::TableName))
+            .arg(escapedColumnNames.join(QLatin1String(", ")));
+    PGresult* res = PQexec(pgConn, sqlCode.toUtf8().constData());
+    const bool isCopyIn = PQresultStatus(res) == PGRES_COPY_IN;
+    PQclear(res);
+    if (!isCopyIn)
+        internal::throwCopyError(PQerrorMessage(pgConn));
+
+    m_isCopyActive = true;
+    m_buffer.reserve(m_bufferSize + m_bufferSize / 4);
+    PgBinaryCopy::appendHeader(&m_buffer);
+}
+
+//! Aborts COPY if finish() was not called, no row is then inserted
+PgCopyLoader::~PgCopyLoader()
+{
+    if (m_isCopyActive) {
+        PGconn* pgConn = static_cast<PGconn*>(m_pgConn);
+        PQputCopyEnd(pgConn, "PgCopyLoader destroyed before finish()");
+        while (PGresult* res = PQgetResult(pgConn))
+            PQclear(res);
+    }
+}
+
+//! Makes addRow() encode \p column as a composite value of \p fieldTypeOids
+void PgCopyLoader::setCompositeColumn(int column, const QVector<quint32>& fieldTypeOids)
+{
+    m_compositeFieldTypeOids[column] = fieldTypeOids;
+}
+
+//! \p func is called with rowCount() each time the buffer is sent
+void PgCopyLoader::setProgressFunc(const ProgressFunc& func)
+{
+    m_progressFunc = func;
+}
+
+/*! \brief Encodes a row, \p values are the column values in order
+ *
+ *  Values of composite columns are QVariantList of the field values.
+ *
+ *  \throws SqlQueryError if sending buffered data fails
+ */
+void PgCopyLoader::addRow(const QList<QVariant>& values)
+{
+    const int columnCount = m_columnTypeOids.size();
+    PgBinaryCopy::appendRowBegin(&m_buffer, columnCount);
+    for (int i = 0; i < columnCount; ++i) {
+        const QVariant value = i < values.size() ? values.at(i) : QVariant();
+        const QVector<quint32>& fieldTypeOids = m_compositeFieldTypeOids.at(i);
+        if (!fieldTypeOids.isEmpty() && !value.isNull())
+            PgBinaryCopy::appendComposite(&m_buffer, value.toList(), fieldTypeOids);
+        else
+            PgBinaryCopy::appendValue(&m_buffer, value, m_columnTypeOids.at(i));
+    }
+    ++m_rowCount;
+    if (m_buffer.size() >= m_bufferSize)
+        this->flushBuffer();
+}
+
+/*! \brief Sends remaining data and ends COPY
+ *
+ *  \throws SqlQueryError if the server rejects the data (no row is inserted
+ *          then)
+ */
+void PgCopyLoader::finish()
+{
+    if (!m_isCopyActive)
+        return;
+
+    PgBinaryCopy::appendTrailer(&m_buffer);
+    this->flushBuffer();
+    PGconn* pgConn = static_cast<PGconn*>(m_pgConn);
+    m_isCopyActive = false;
+    if (PQputCopyEnd(pgConn, NULL) != 1)
+        internal::throwCopyError(PQerrorMessage(pgConn));
+
+    bool isOk = true;
+    QByteArray error;
+    while (PGresult* res = PQgetResult(pgConn)) {
+        if (PQresultStatus(res) != PGRES_COMMAND_OK) {
+            isOk = false;
+            error = PQresultErrorMessage(res);
+        }
+        PQclear(res);
+    }
+    if (!isOk)
+        internal::throwCopyError(error.constData());
+}
+
+qint64 PgCopyLoader::rowCount() const
+{
+    return m_rowCount;
+}
+
+void PgCopyLoader::flushBuffer()
+{
+    PGconn* pgConn = static_cast<PGconn*>(m_pgConn);
+    if (!m_buffer.isEmpty()
+            && PQputCopyData(pgConn, m_buffer.constData(), m_buffer.size()) != 1)
+    {
+        internal::throwCopyError(PQerrorMessage(pgConn));
+    }
+    m_buffer.resize(0); // Keeps capacity
+    if (m_progressFunc)
+        m_progressFunc(m_rowCount);
+}
+
+#endif // QTTOOLS_SQL_HAVE_LIBPQ
+
+} // namespace qtsql
@@ -0,0 +1,100 @@
+/****************************************************************************
+**  FougTools
+**  Copyright Fougue (30 Mar. 2015)
+**  contact@fougue.pro
+**
+** This software is a computer program whose purpose is to provide utility
+** tools for the C++ language and the Qt toolkit.
+**
+** This software is governed by the CeCILL-C license under French law and
+** abiding by the rules of distribution of free software.  You can  use,
+** modify and/ or redistribute the software under the terms of the CeCILL-C
+** license as circulated by CEA, CNRS and INRIA at the following URL
+** "http://www.cecill.info".
+****************************************************************************/
+
+
+#pragma once
+
+#include "sql.h"
+#include <QtCore/QByteArray>
+#include <QtCore/QList>
+#include <QtCore/QStringList>
+#include <QtCore/QVariant>
+#include <QtCore/QVector>
+#include <QtSql/QSqlDatabase>
+#include <functional>
+
+namespace qtsql {
+
+class QTTOOLS_SQL_EXPORT PgBinaryCopy
+{
+public:
+    //! OIDs of the PostgreSQL types supported by appendValue()
+    enum TypeOid
+    {
+        BoolOid = 16,
+        ByteaOid = 17,
+        Int8Oid = 20,
+        Int2Oid = 21,
+        Int4Oid = 23,
+        TextOid = 25,
+        Float4Oid = 700,
+        Float8Oid = 701,
+        VarcharOid = 1043
+    };
+
+    static void appendHeader(QByteArray* out);
+    static void appendTrailer(QByteArray* out);
+
+    static void appendRowBegin(QByteArray* out, int fieldCount);
+    static void appendValue(QByteArray* out, const QVariant& value, quint32 typeOid);
+    static void appendComposite(QByteArray* out,
+                                const QList<QVariant>& values,
+                                const QVector<quint32>& fieldTypeOids);
+
+private:
+    PgBinaryCopy();
+};
+
+#ifdef QTTOOLS_SQL_HAVE_LIBPQ
+
+class QTTOOLS_SQL_EXPORT PgCopyLoader
+{
+public:
+    PgCopyLoader(const QSqlDatabase& db,
+                 const QString& tableName,
+                 const QStringList& columnNames,
+                 const QVector<quint32>& columnTypeOids,
+                 int bufferSize = 1 << 20);
+    ~PgCopyLoader();
+
+    void setCompositeColumn(int column, const QVector<quint32>& fieldTypeOids);
+
+    typedef std::function<void(qint64 rowCount)> ProgressFunc;
+    void setProgressFunc(const ProgressFunc& func);
+
+    void addRow(const QList<QVariant>& values);
+    void finish();
+
+    qint64 rowCount() const;
+
+private:
+    PgCopyLoader(const PgCopyLoader&);
+    PgCopyLoader& operator=(const PgCopyLoader&);
+
+    void flushBuffer();
+
+    void* m_pgConn;
+    QVector<quint32> m_columnTypeOids;
+    QVector<QVector<quint32>> m_compositeFieldTypeOids; // Empty if not composite
+    QByteArray m_buffer;
+    int m_bufferSize;
+    qint64 m_rowCount;
+    bool m_isCopyActive;
+    ProgressFunc m_progressFunc;
+};
+
+#endif // QTTOOLS_SQL_HAVE_LIBPQ
+
+} // namespace qtsql
@@ -0,0 +1,126 @@
+/****************************************************************************
+**  FougTools
+**  Copyright Fougue (30 Mar. 2015)
+**  contact@fougue.pro
+**
+** This software is a computer program whose purpose is to provide utility
+** tools for the C++ language and the Qt toolkit.
+**
+** This software is governed by the CeCILL-C license under French law and
+** abiding by the rules of distribution of free software.  You can  use,
+** modify and/ or redistribute the software under the terms of the CeCILL-C
+** license as circulated by CEA, CNRS and INRIA at the following URL
+** "http://www.cecill.info".
+****************************************************************************/
+
+
+#include "prepared_query_cache.h"
+
+#include "qsql_query_utils.h"
+
+namespace qtsql {
+
+/*!
+ * \class PreparedQueryCache
+ * \brief Provides a LRU cache of prepared queries for one database connection
+ *
+ * Preparing a statement once and executing it many times with other bind
+ * values saves the parsing and planning of SQL code by the database server.
+ * Cached queries are identified by their SQL code, the least recently used
+ * query is dropped when capacity() is exceeded.
+ *
+ * As the connection itself, a PreparedQueryCache must be used by one thread
+ * at a time.
+ *
+ * \headerfile prepared_query_cache.h <qttools/sql/prepared_query_cache.h>
+ * \ingroup qttools_sql
+ */
+
+PreparedQueryCache::PreparedQueryCache(const QSqlDatabase &db, int capacity)
+    : m_db(db),
+      m_capacity(qMax(capacity, 1))
+{
+}
+
+const QSqlDatabase &PreparedQueryCache::database() const
+{
+    return m_db;
+}
+
+//! Maximum count of cached queries
+int PreparedQueryCache::capacity() const
+{
+    return m_capacity;
+}
+
+void PreparedQueryCache::setCapacity(int capacity)
+{
+    m_capacity = qMax(capacity, 1);
+    this->evictOverflow();
+}
+
+int PreparedQueryCache::count() const
+{
+    return m_entryIndex.size();
+}
+
+/*! \brief Returns the query prepared with \p sqlCode, prepares it if not
+ *         cached
+ *
+ *  The returned reference is valid until the query is evicted, ie after
+ *  capacity() other distinct queries are requested
+ *
+ *  \throws SqlQueryError if the preparation fails
+ */
+QSqlQuery &PreparedQueryCache::query(const QString &sqlCode)
+{
+    auto itIndex = m_entryIndex.find(sqlCode);
+    if (itIndex != m_entryIndex.end()) {
+        // Move to front, std::list::splice() keeps iterators valid
+        m_entries.splice(m_entries.begin(), m_entries, itIndex.value());
+        return m_entries.front().query;
+    }
+
+    QSqlQuery qry(m_db);
+    if (!qry.prepare(sqlCode))
+        throw SqlQueryError(qry);
+
+    m_entries.push_front(Entry());
+    m_entries.front().sqlCode = sqlCode;
+    m_entries.front().query = qry;
+    m_entryIndex.insert(sqlCode, m_entries.begin());
+    this->evictOverflow();
+    return m_entries.front().query;
+}
+
+/*! \brief Executes the prepared query of \p sqlCode with positional
+ *         \p bindValues
+ *
+ *  \throws SqlQueryError if the preparation or execution fails
+ */
+QSqlQuery &PreparedQueryCache::exec(
+        const QString &sqlCode, const QVariantList &bindValues)
+{
+    QSqlQuery& qry = this->query(sqlCode);
+    for (int i = 0; i < bindValues.size(); ++i)
+        qry.bindValue(i, bindValues.at(i));
+    qry.exec();
+    qtsql::throwIfError(qry);
+    return qry;
+}
+
+void PreparedQueryCache::clear()
+{
+    m_entryIndex.clear();
+    m_entries.clear();
+}
+
+void PreparedQueryCache::evictOverflow()
+{
+    while (m_entryIndex.size() > m_capacity) {
+        m_entryIndex.remove(m_entries.back().sqlCode);
+        m_entries.pop_back();
+    }
+}
+
+} // namespace qtsql
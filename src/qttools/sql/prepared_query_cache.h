@@ -0,0 +1,60 @@
+/****************************************************************************
+**  FougTools
+**  Copyright Fougue (30 Mar. 2015)
+**  contact@fougue.pro
+**
+** This software is a computer program whose purpose is to provide utility
+** tools for the C++ language and the Qt toolkit.
+**
+** This software is governed by the CeCILL-C license under French law and
+** abiding by the rules of distribution of free software.  You can  use,
+** modify and/ or redistribute the software under the terms of the CeCILL-C
+** license as circulated by CEA, CNRS and INRIA at the following URL
+** "http://www.cecill.info".
+****************************************************************************/
+
+
+#pragma once
+
+#include "sql.h"
+#include <QtCore/QHash>
+#include <QtCore/QVariantList>
+#include <QtSql/QSqlDatabase>
+#include <QtSql/QSqlQuery>
+#include <list>
+
+namespace qtsql {
+
+class QTTOOLS_SQL_EXPORT PreparedQueryCache
+{
+public:
+    PreparedQueryCache(const QSqlDatabase& db, int capacity = 64);
+
+    const QSqlDatabase& database() const;
+
+    int capacity() const;
+    void setCapacity(int capacity);
+    int count() const;
+
+    QSqlQuery& query(const QString& sqlCode);
+    QSqlQuery& exec(const QString& sqlCode,
+                    const QVariantList& bindValues = QVariantList());
+
+    void clear();
+
+private:
+    struct Entry
+    {
+        QString sqlCode;
+        QSqlQuery query;
+    };
+
+    void evictOverflow();
+
+    QSqlDatabase m_db;
+    int m_capacity;
+    std::list<Entry> m_entries; // Most recently used first
+    QHash<QString, std::list<Entry>::iterator> m_entryIndex;
+};
+
+} // namespace qtsql
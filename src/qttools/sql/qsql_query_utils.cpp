@@ -16,6 +16,9 @@
 #include "qsql_query_utils.h"
 
 #include <QtCore/QVariant>
+#include <QtSql/QSqlDriver>
+
+#include <algorithm>
 
 namespace qtsql {
 
@@ -48,6 +51,41 @@ QSqlError SqlQueryError::sqlError() const
     return m_sqlError;
 }
 
+/*!
+ * \class SqlQueryResult
+ * \brief Records, error and counters of an executed QSqlQuery
+ *
+ * Unlike QSqlQuery, a SqlQueryResult can be handed to another thread than the
+ * one of the database connection (ex: see DatabaseManager::execSqlCodeAsync())
+ *
+ * \headerfile qsql_query_utils.h <qttools/sql/qsql_query_utils.h>
+ * \ingroup qttools_sql
+ */
+
+SqlQueryResult::SqlQueryResult()
+    : numRowsAffected(-1)
+{
+}
+
+bool SqlQueryResult::hasError() const
+{
+    return error.type() != QSqlError::NoError;
+}
+
+//! Builds the result of executed query \p qry, fetching all its records
+SqlQueryResult SqlQueryResult::fetch(QSqlQuery* qry)
+{
+    SqlQueryResult result;
+    result.error = qry->lastError();
+    result.lastInsertId = qry->lastInsertId();
+    result.numRowsAffected = qry->numRowsAffected();
+    if (qry->isSelect()) {
+        while (qry->next())
+            result.records.append(qry->record());
+    }
+    return result;
+}
+
 /*! \brief Execute SQL statements in \p code use databse connection \p db
  *  \note Does nothing if \p sqlCode is empty
  *  \throws SqlQueryError if no connection to database or if SQL exec fails (SQL query has error)
@@ -89,6 +127,146 @@ QSqlQuery execSqlCodeInTransaction(const QString& sqlCode, QSqlDatabase db)
     return sqlQry;
 }
 
+namespace internal {
+
+static void throwBatchError(const QString& text)
+{
+    throw SqlQueryError(QSqlError(text, QLatin1String(""), QSqlError::StatementError));
+}
+
+//! "INSERT INTO table (col1, col2) VALUES (?, ?), (?, ?), ..." for \p rowCount rows
+static QString multiRowInsertSqlCode(const QString& insertHeader,
+                                     int columnCount,
+                                     int rowCount)
+{
+    QString rowPlaceholders(QLatin1String("("));
+    for (int iCol = 0; iCol < columnCount; ++iCol)
+        rowPlaceholders += iCol == 0 ? QLatin1String("?") : QLatin1String(", ?");
+    rowPlaceholders += QLatin1Char(')');
+
+    QString sqlCode = insertHeader;
+    sqlCode.reserve(sqlCode.size() + rowCount * (rowPlaceholders.size() + 2));
+    for (int iRow = 0; iRow < rowCount; ++iRow) {
+        if (iRow != 0)
+            sqlCode += QLatin1String(", ");
+        sqlCode += rowPlaceholders;
+    }
+    return sqlCode;
+}
+
+static void execBatchInsertNoTransaction(const QString& tableName,
+                                         const QStringList& columnNames,
+                                         const QList<QVariantList>& columnValues,
+                                         const QSqlDatabase& db,
+                                         int batchSize)
+{
+    const QSqlDriver* driver = db.driver();
+    const int columnCount = columnNames.size();
+    const int rowCount = columnValues.isEmpty() ? 0 : columnValues.first().size();
+
+    QStringList escapedColumnNames;
+    for (const QString& columnName : columnNames)
+        escapedColumnNames += driver->escapeIdentifier(columnName, QSqlDriver::FieldName);
+    const QString insertHeader =
+            QString("INSERT INTO %1 (%2) VALUES ")
+            .arg(driver->escapeIdentifier(tableName, QSqlDriver::TableName))
+            .arg(escapedColumnNames.join(QLatin1String(", ")));
+
+    if (driver->hasFeature(QSqlDriver::BatchOperations)) {
+        // Native batch : one statement, bound to column slices
+        QSqlQuery qry(db);
+        if (!qry.prepare(multiRowInsertSqlCode(insertHeader, columnCount, 1)))
+            throw SqlQueryError(qry);
+        for (int iRow = 0; iRow < rowCount; iRow += batchSize) {
+            const int batchRowCount = std::min(batchSize, rowCount - iRow);
+            for (int iCol = 0; iCol < columnCount; ++iCol)
+                qry.bindValue(iCol, columnValues.at(iCol).mid(iRow, batchRowCount));
+            if (!qry.execBatch())
+                throw SqlQueryError(qry);
+        }
+        return;
+    }
+
+    // Multi-row VALUES, bounded by the smallest limit of bind values per
+    // statement among common drivers (999 for SQLite)
+    const int maxBindValueCount = 999;
+    const int statementRowCount =
+            std::max(1, std::min(batchSize, maxBindValueCount / columnCount));
+    QSqlQuery qry(db);
+    int preparedRowCount = 0;
+    for (int iRow = 0; iRow < rowCount; iRow += statementRowCount) {
+        const int batchRowCount = std::min(statementRowCount, rowCount - iRow);
+        if (batchRowCount != preparedRowCount) { // Only for the first and last batches
+            const QString sqlCode =
+                    multiRowInsertSqlCode(insertHeader, columnCount, batchRowCount);
+            if (!qry.prepare(sqlCode))
+                throw SqlQueryError(qry);
+            preparedRowCount = batchRowCount;
+        }
+        int bindId = 0;
+        for (int i = iRow; i < iRow + batchRowCount; ++i) {
+            for (int iCol = 0; iCol < columnCount; ++iCol)
+                qry.bindValue(bindId++, columnValues.at(iCol).at(i));
+        }
+        if (!qry.exec())
+            throw SqlQueryError(qry);
+    }
+}
+
+} // namespace internal
+
+/*! \brief Inserts rows into table \p tableName by batches of \p batchSize rows
+ *
+ *  \p columnValues contains the values of each column of \p columnNames, in
+ *  the same order. All value lists must have the same size (the count of
+ *  rows).
+ *
+ *  If the driver of \p db supports QSqlDriver::BatchOperations, batches are
+ *  executed with QSqlQuery::execBatch(). Otherwise each batch is a single
+ *  multi-row "INSERT ... VALUES (...), (...)" statement, so the cost of
+ *  round trips and statement parsing is shared by the rows of a batch.
+ *
+ *  Insertion is done inside a transaction, unless a transaction is already
+ *  active on \p db (then the caller is responsible for commit).
+ *
+ *  \throws SqlQueryError if the connection is not open, if value lists are
+ *          inconsistent or if SQL execution fails (the transaction is then
+ *          rolled back)
+ */
+void execBatchInsert(const QString& tableName,
+                     const QStringList& columnNames,
+                     const QList<QVariantList>& columnValues,
+                     QSqlDatabase db,
+                     int batchSize)
+{
+    if (!db.isValid() || !db.isOpen()) {
+        throw SqlQueryError(QSqlError(QLatin1String("db is not valid or not open"),
+                                      QLatin1String(""),
+                                      QSqlError::ConnectionError));
+    }
+    if (columnNames.isEmpty() || columnValues.size() != columnNames.size())
+        internal::throwBatchError(QLatin1String("column names and values mismatch"));
+    for (const QVariantList& values : columnValues) {
+        if (values.size() != columnValues.first().size())
+            internal::throwBatchError(QLatin1String("columns have different row counts"));
+    }
+    if (columnValues.first().isEmpty())
+        return;
+
+    const bool isOwnTransaction = db.transaction();
+    try {
+        internal::execBatchInsertNoTransaction(
+                    tableName, columnNames, columnValues, db, std::max(batchSize, 1));
+        if (isOwnTransaction && !db.commit())
+            throw SqlQueryError(db.lastError());
+    }
+    catch (const SqlQueryError&) {
+        if (isOwnTransaction)
+            db.rollback();
+        throw;
+    }
+}
+
 //! Throw SqlQueryError if SQL query \p qry has error
 void throwIfError(const QSqlQuery& qry)
 {
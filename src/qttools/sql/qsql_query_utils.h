@@ -17,9 +17,13 @@
 
 #include "sql.h"
 #include <stdexcept>
+#include <QtCore/QList>
+#include <QtCore/QStringList>
+#include <QtCore/QVariantList>
 #include <QtSql/QSqlDatabase>
 #include <QtSql/QSqlError>
 #include <QtSql/QSqlQuery>
+#include <QtSql/QSqlRecord>
 
 namespace qtsql {
 
@@ -36,11 +40,32 @@ private:
     QSqlError m_sqlError;
 };
 
+//! Detached outcome of a SQL query, usable without the database connection
+struct QTTOOLS_SQL_EXPORT SqlQueryResult
+{
+    SqlQueryResult();
+
+    bool hasError() const;
+    static SqlQueryResult fetch(QSqlQuery* qry);
+
+    QList<QSqlRecord> records;
+    QSqlError error;
+    QVariant lastInsertId;
+    int numRowsAffected;
+};
+
 QTTOOLS_SQL_EXPORT
 QSqlQuery execSqlCode(const QString& sqlCode, const QSqlDatabase& db);
 QTTOOLS_SQL_EXPORT
 QSqlQuery execSqlCodeInTransaction(const QString& sqlCode, QSqlDatabase db);
 
+QTTOOLS_SQL_EXPORT
+void execBatchInsert(const QString& tableName,
+                     const QStringList& columnNames,
+                     const QList<QVariantList>& columnValues,
+                     QSqlDatabase db,
+                     int batchSize = 1000);
+
 QTTOOLS_SQL_EXPORT
 void throwIfError(const QSqlQuery& qry);
 
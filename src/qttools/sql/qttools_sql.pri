@@ -5,10 +5,25 @@ HEADERS += \
     $$PWD/database_manager.h \
     $$PWD/sql.h \
     $$PWD/composite_type_helper.h \
-    $$PWD/qsql_query_utils.h
+    $$PWD/qsql_query_utils.h \
+    $$PWD/prepared_query_cache.h \
+    $$PWD/query_result_cache.h \
+    $$PWD/sql_row_stream.h \
+    $$PWD/sql_log_writer.h \
+    $$PWD/pg_binary_copy.h
 
 SOURCES += \
     $$PWD/database_settings.cpp \
     $$PWD/database_manager.cpp \
     $$PWD/composite_type_helper.cpp \
-    $$PWD/qsql_query_utils.cpp
+    $$PWD/qsql_query_utils.cpp \
+    $$PWD/prepared_query_cache.cpp \
+    $$PWD/query_result_cache.cpp \
+    $$PWD/sql_row_stream.cpp \
+    $$PWD/sql_log_writer.cpp \
+    $$PWD/pg_binary_copy.cpp
+
+qttools_sql_libpq {
+    DEFINES += QTTOOLS_SQL_HAVE_LIBPQ
+    LIBS += -lpq
+}
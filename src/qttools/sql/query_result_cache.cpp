@@ -0,0 +1,295 @@
+/****************************************************************************
+**  FougTools
+**  Copyright Fougue (30 Mar. 2015)
+**  contact@fougue.pro
+**
+** This software is a computer program whose purpose is to provide utility
+** tools for the C++ language and the Qt toolkit.
+**
+** This software is governed by the CeCILL-C license under French law and
+** abiding by the rules of distribution of free software.  You can  use,
+** modify and/ or redistribute the software under the terms of the CeCILL-C
+** license as circulated by CEA, CNRS and INRIA at the following URL
+** "http://www.cecill.info".
+****************************************************************************/
+
+#include "query_result_cache.h"
+
+#include "sql_row_stream.h"
+#include <QtCore/QDataStream>
+#include <QtCore/QMutexLocker>
+#include <QtCore/QRegExp>
+#include <QtSql/QSqlRecord>
+#include <iterator>
+
+namespace qtsql {
+
+/*!
+ * \class SqlResultTable
+ * \brief Compact, detached rows of a SQL query result
+ *
+ * Column names are stored once and values in a single row-major array,
+ * instead of one QSqlRecord per row (that repeats the field descriptions).
+ * The table is implicitly shared, copies are cheap and can be read
+ * concurrently.
+ *
+ * \headerfile query_result_cache.h <qttools/sql/query_result_cache.h>
+ * \ingroup qttools_sql
+ */
+
+SqlResultTable::SqlResultTable()
+{
+}
+
+bool SqlResultTable::isEmpty() const
+{
+    return m_values.isEmpty();
+}
+
+int SqlResultTable::rowCount() const
+{
+    return !m_columnNames.isEmpty() ? m_values.size() / m_columnNames.size() : 0;
+}
+
+int SqlResultTable::columnCount() const
+{
+    return m_columnNames.size();
+}
+
+const QStringList& SqlResultTable::columnNames() const
+{
+    return m_columnNames;
+}
+
+//! Index of column \p columnName, -1 if not found
+int SqlResultTable::columnIndex(const QString& columnName) const
+{
+    return m_columnNames.indexOf(columnName);
+}
+
+//! \pre 0 <= row < rowCount() and 0 <= column < columnCount()
+const QVariant& SqlResultTable::value(int row, int column) const
+{
+    return m_values.at(row * m_columnNames.size() + column);
+}
+
+//! All values, row after row
+const QVector<QVariant>& SqlResultTable::values() const
+{
+    return m_values;
+}
+
+//! Builds the table from the remaining rows of \p rows
+SqlResultTable SqlResultTable::fetch(SqlRowStream* rows)
+{
+    SqlResultTable table;
+    const QSqlRecord record = rows->query().record();
+    const int columnCount = record.count();
+    for (int iCol = 0; iCol < columnCount; ++iCol)
+        table.m_columnNames.append(record.fieldName(iCol));
+    const int sizeHint = rows->query().size(); // -1 if not supported by the driver
+    if (sizeHint > 0)
+        table.m_values.reserve(sizeHint * columnCount);
+    while (rows->next()) {
+        for (int iCol = 0; iCol < columnCount; ++iCol)
+            table.m_values.append(rows->value(iCol));
+    }
+    table.m_values.squeeze();
+    return table;
+}
+
+/*!
+ * \class QueryResultCache
+ * \brief Provides a thread-safe LRU cache of read-only query results
+ *
+ * Results are identified by their SQL code and bind values. An entry expires
+ * after timeToLive() and is dropped when any of the tables it reads is
+ * invalidated with invalidateTable(). The least recently used entry is dropped
+ * when capacity() is exceeded.
+ *
+ * \headerfile query_result_cache.h <qttools/sql/query_result_cache.h>
+ * \ingroup qttools_sql
+ */
+
+QueryResultCache::QueryResultCache(int capacity, int timeToLiveMsec)
+    : m_capacity(qMax(capacity, 1)),
+      m_timeToLive(timeToLiveMsec),
+      m_hitCount(0),
+      m_missCount(0)
+{
+}
+
+//! Maximum count of cached results
+int QueryResultCache::capacity() const
+{
+    QMutexLocker locker(&m_mutex);
+    Q_UNUSED(locker);
+    return m_capacity;
+}
+
+void QueryResultCache::setCapacity(int capacity)
+{
+    QMutexLocker locker(&m_mutex);
+    Q_UNUSED(locker);
+    m_capacity = qMax(capacity, 1);
+    this->evictOverflow();
+}
+
+/*! \brief Duration in milliseconds after which a cached result expires
+ *
+ *  A negative value means results never expire (only invalidation drops
+ *  them). Default is 5s.
+ */
+int QueryResultCache::timeToLive() const
+{
+    QMutexLocker locker(&m_mutex);
+    Q_UNUSED(locker);
+    return m_timeToLive;
+}
+
+void QueryResultCache::setTimeToLive(int msec)
+{
+    QMutexLocker locker(&m_mutex);
+    Q_UNUSED(locker);
+    m_timeToLive = msec;
+}
+
+int QueryResultCache::count() const
+{
+    QMutexLocker locker(&m_mutex);
+    Q_UNUSED(locker);
+    return m_entryIndex.size();
+}
+
+//! Count of successful calls to find()
+quint64 QueryResultCache::hitCount() const
+{
+    return m_hitCount.load();
+}
+
+//! Count of failed calls to find()
+quint64 QueryResultCache::missCount() const
+{
+    return m_missCount.load();
+}
+
+/*! \brief Looks up the result of \p sqlCode executed with \p bindValues
+ *
+ *  Expired entries are dropped.
+ *  \returns true if the result was found (then it is assigned to \p result)
+ */
+bool QueryResultCache::find(const QString& sqlCode,
+                            const QVariantList& bindValues,
+                            SqlResultTable* result)
+{
+    const QByteArray key = QueryResultCache::entryKey(sqlCode, bindValues);
+    QMutexLocker locker(&m_mutex);
+    Q_UNUSED(locker);
+    auto itIndex = m_entryIndex.find(key);
+    if (itIndex != m_entryIndex.end()) {
+        const std::list<Entry>::iterator itEntry = itIndex.value();
+        if (m_timeToLive < 0 || !itEntry->age.hasExpired(m_timeToLive)) {
+            m_entries.splice(m_entries.begin(), m_entries, itEntry);
+            *result = itEntry->result;
+            ++m_hitCount;
+            return true;
+        }
+        this->removeEntry(itEntry);
+    }
+    ++m_missCount;
+    return false;
+}
+
+/*! \brief Caches \p result of \p sqlCode executed with \p bindValues
+ *
+ *  \p tableNames are the tables read by the query, see invalidateTable()
+ */
+void QueryResultCache::insert(const QString& sqlCode,
+                              const QVariantList& bindValues,
+                              const QStringList& tableNames,
+                              const SqlResultTable& result)
+{
+    Entry entry;
+    entry.key = QueryResultCache::entryKey(sqlCode, bindValues);
+    for (const QString& tableName : tableNames)
+        entry.tableNames.append(tableName.toLower());
+    entry.result = result;
+    entry.age.start();
+
+    QMutexLocker locker(&m_mutex);
+    Q_UNUSED(locker);
+    auto itIndex = m_entryIndex.find(entry.key);
+    if (itIndex != m_entryIndex.end())
+        this->removeEntry(itIndex.value());
+    m_entries.push_front(entry);
+    m_entryIndex.insert(entry.key, m_entries.begin());
+    this->evictOverflow();
+}
+
+//! Drops the results of all queries reading table \p tableName (case insensitive)
+void QueryResultCache::invalidateTable(const QString& tableName)
+{
+    const QString lowerTableName = tableName.toLower();
+    QMutexLocker locker(&m_mutex);
+    Q_UNUSED(locker);
+    auto itEntry = m_entries.begin();
+    while (itEntry != m_entries.end()) {
+        auto itCurrent = itEntry;
+        ++itEntry;
+        if (itCurrent->tableNames.contains(lowerTableName))
+            this->removeEntry(itCurrent);
+    }
+}
+
+void QueryResultCache::clear()
+{
+    QMutexLocker locker(&m_mutex);
+    Q_UNUSED(locker);
+    m_entryIndex.clear();
+    m_entries.clear();
+}
+
+/*! \brief Names of the tables following FROM and JOIN keywords in \p sqlCode
+ *
+ *  This is a simple lexical scan, not a SQL parser : lists of tables
+ *  ("FROM a, b"), sub-queries in other clauses or views are not understood.
+ *  For such queries, table names should be given explicitly.
+ */
+QStringList QueryResultCache::tableNamesOfSql(const QString& sqlCode)
+{
+    QStringList tableNames;
+    QRegExp rx(QLatin1String("\\b(?:FROM|JOIN)\\s+([\\w.\"]+)"), Qt::CaseInsensitive);
+    int pos = 0;
+    while ((pos = rx.indexIn(sqlCode, pos)) != -1) {
+        QString tableName = rx.cap(1);
+        tableName.remove(QLatin1Char('"'));
+        tableName = tableName.toLower();
+        if (!tableName.isEmpty() && !tableNames.contains(tableName))
+            tableNames.append(tableName);
+        pos += rx.matchedLength();
+    }
+    return tableNames;
+}
+
+QByteArray QueryResultCache::entryKey(
+        const QString& sqlCode, const QVariantList& bindValues)
+{
+    QByteArray key;
+    QDataStream stream(&key, QIODevice::WriteOnly);
+    stream << sqlCode << bindValues;
+    return key;
+}
+
+void QueryResultCache::removeEntry(std::list<Entry>::iterator itEntry)
+{
+    m_entryIndex.remove(itEntry->key);
+    m_entries.erase(itEntry);
+}
+
+void QueryResultCache::evictOverflow()
+{
+    while (m_entryIndex.size() > m_capacity)
+        this->removeEntry(std::prev(m_entries.end()));
+}
+
+} // namespace qtsql
@@ -0,0 +1,108 @@
+/****************************************************************************
+**  FougTools
+**  Copyright Fougue (30 Mar. 2015)
+**  contact@fougue.pro
+**
+** This software is a computer program whose purpose is to provide utility
+** tools for the C++ language and the Qt toolkit.
+**
+** This software is governed by the CeCILL-C license under French law and
+** abiding by the rules of distribution of free software.  You can  use,
+** modify and/ or redistribute the software under the terms of the CeCILL-C
+** license as circulated by CEA, CNRS and INRIA at the following URL
+** "http://www.cecill.info".
+****************************************************************************/
+
+#pragma once
+
+#include "sql.h"
+#include <QtCore/QByteArray>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QHash>
+#include <QtCore/QMutex>
+#include <QtCore/QStringList>
+#include <QtCore/QVariantList>
+#include <QtCore/QVector>
+#include <atomic>
+#include <list>
+
+namespace qtsql {
+
+class SqlRowStream;
+
+class QTTOOLS_SQL_EXPORT SqlResultTable
+{
+public:
+    SqlResultTable();
+
+    bool isEmpty() const;
+    int rowCount() const;
+    int columnCount() const;
+
+    const QStringList& columnNames() const;
+    int columnIndex(const QString& columnName) const;
+
+    const QVariant& value(int row, int column) const;
+    const QVector<QVariant>& values() const;
+
+    static SqlResultTable fetch(SqlRowStream* rows);
+
+private:
+    QStringList m_columnNames;
+    QVector<QVariant> m_values; // Row-major
+};
+
+class QTTOOLS_SQL_EXPORT QueryResultCache
+{
+public:
+    QueryResultCache(int capacity = 256, int timeToLiveMsec = 5000);
+
+    int capacity() const;
+    void setCapacity(int capacity);
+
+    int timeToLive() const;
+    void setTimeToLive(int msec);
+
+    int count() const;
+    quint64 hitCount() const;
+    quint64 missCount() const;
+
+    bool find(const QString& sqlCode,
+              const QVariantList& bindValues,
+              SqlResultTable* result);
+    void insert(const QString& sqlCode,
+                const QVariantList& bindValues,
+                const QStringList& tableNames,
+                const SqlResultTable& result);
+
+    void invalidateTable(const QString& tableName);
+    void clear();
+
+    static QStringList tableNamesOfSql(const QString& sqlCode);
+
+private:
+    QueryResultCache(const QueryResultCache&);
+    QueryResultCache& operator=(const QueryResultCache&);
+
+    struct Entry
+    {
+        QByteArray key;
+        QStringList tableNames; // Lower case
+        SqlResultTable result;
+        QElapsedTimer age;
+    };
+
+    static QByteArray entryKey(const QString& sqlCode, const QVariantList& bindValues);
+    void removeEntry(std::list<Entry>::iterator itEntry);
+    void evictOverflow();
+
+    mutable QMutex m_mutex;
+    int m_capacity;
+    int m_timeToLive;
+    std::list<Entry> m_entries; // Most recently used first
+    QHash<QByteArray, std::list<Entry>::iterator> m_entryIndex;
+    std::atomic<quint64> m_hitCount;
+    std::atomic<quint64> m_missCount;
+};
+
+} // namespace qtsql
@@ -0,0 +1,175 @@
+/****************************************************************************
+**  FougTools
+**  Copyright Fougue (30 Mar. 2015)
+**  contact@fougue.pro
+**
+** This software is a computer program whose purpose is to provide utility
+** tools for the C++ language and the Qt toolkit.
+**
+** This software is governed by the CeCILL-C license under French law and
+** abiding by the rules of distribution of free software.  You can  use,
+** modify and/ or redistribute the software under the terms of the CeCILL-C
+** license as circulated by CEA, CNRS and INRIA at the following URL
+** "http://www.cecill.info".
+****************************************************************************/
+
+
+#include "sql_log_writer.h"
+
+#include <QtCore/QThread>
+#include <cstddef>
+
+namespace qtsql {
+
+/*!
+ * \class SqlLogWriter
+ * \brief Provides buffered writing of SQL statements to a QIODevice by a
+ *        background thread
+ *
+ * log() only appends an entry to a pending list, formatting and device
+ * writes are done by a writer thread started on first use. So the cost
+ * for the thread executing the SQL code is roughly a mutex lock and the copy
+ * of implicitly shared strings.
+ *
+ * When maxPendingCount() entries are pending (the device is slower than the
+ * statements), new entries are dropped and their count is reported in the
+ * output.
+ *
+ * The device must support writes from a non-GUI thread (ex: QFile).
+ *
+ * \headerfile sql_log_writer.h <qttools/sql/sql_log_writer.h>
+ * \ingroup qttools_sql
+ */
+
+SqlLogWriter::SqlLogWriter()
+    : m_droppedCount(0),
+      m_maxPendingCount(100000),
+      m_isWriting(false),
+      m_isStopRequested(false)
+{
+}
+
+//! Writes the pending entries, then stops the writer thread
+SqlLogWriter::~SqlLogWriter()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_isStopRequested = true;
+    }
+    m_pendingCondition.notify_all();
+    if (m_thread.joinable())
+        m_thread.join();
+}
+
+QIODevice* SqlLogWriter::device() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stream.device();
+}
+
+//! Pending entries are written to the previous device before switching
+void SqlLogWriter::setDevice(QIODevice* device)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    this->waitIdle(lock);
+    if (m_stream.device() != device)
+        m_stream.setDevice(device);
+}
+
+int SqlLogWriter::maxPendingCount() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_maxPendingCount;
+}
+
+void SqlLogWriter::setMaxPendingCount(int count)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_maxPendingCount = qMax(count, 1);
+}
+
+/*! \brief Schedules output of \p sqlCode executed in \p inThread
+ *
+ *  \param durationUsec  Execution time in microseconds (-1 if unknown)
+ *
+ *  This function is thread-safe.
+ */
+void SqlLogWriter::log(
+        const QString& sqlCode, const QThread* inThread, qint64 durationUsec)
+{
+    Entry entry;
+    entry.sqlCode = sqlCode;
+    entry.threadName = inThread != NULL ? inThread->objectName() : QString();
+    entry.thread = inThread;
+    entry.durationUsec = durationUsec;
+
+    bool isWriterIdle = false;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_stream.device() == NULL)
+            return;
+        if (static_cast<int>(m_pendingEntries.size()) >= m_maxPendingCount) {
+            ++m_droppedCount;
+            return;
+        }
+        if (!m_thread.joinable())
+            m_thread = std::thread(&SqlLogWriter::writerLoop, this);
+        isWriterIdle = m_pendingEntries.empty() && !m_isWriting;
+        m_pendingEntries.push_back(std::move(entry));
+    }
+    if (isWriterIdle)
+        m_pendingCondition.notify_one();
+}
+
+//! Blocks until all pending entries are written
+void SqlLogWriter::flush()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    this->waitIdle(lock);
+}
+
+void SqlLogWriter::waitIdle(std::unique_lock<std::mutex>& lock)
+{
+    if (!m_thread.joinable())
+        return;
+    m_idleCondition.wait(lock, [=] {
+        return m_pendingEntries.empty() && !m_isWriting;
+    } );
+}
+
+void SqlLogWriter::writerLoop()
+{
+    std::vector<Entry> entries;
+    while (true) {
+        qint64 droppedCount = 0;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_isWriting = false;
+            if (m_pendingEntries.empty())
+                m_idleCondition.notify_all();
+            m_pendingCondition.wait(lock, [=] {
+                return m_isStopRequested || !m_pendingEntries.empty();
+            } );
+            if (m_pendingEntries.empty())
+                return; // Stop requested
+            entries.clear();
+            std::swap(entries, m_pendingEntries);
+            std::swap(droppedCount, m_droppedCount);
+            m_isWriting = true;
+        }
+
+        if (droppedCount > 0)
+            m_stream << QString("-- %1 statements dropped").arg(droppedCount) << '\n';
+        for (const Entry& entry : entries) {
+            m_stream << "[thread" << entry.threadName
+                     << " 0x" << QString::number(reinterpret_cast<std::size_t>(entry.thread), 16)
+                     << "] " << entry.sqlCode;
+            if (entry.durationUsec >= 0)
+                m_stream << " -- " << entry.durationUsec << "us";
+            m_stream << '\n';
+        }
+        m_stream.flush();
+    }
+}
+
+} // namespace qtsql
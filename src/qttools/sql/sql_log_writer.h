@@ -0,0 +1,73 @@
+/****************************************************************************
+**  FougTools
+**  Copyright Fougue (30 Mar. 2015)
+**  contact@fougue.pro
+**
+** This software is a computer program whose purpose is to provide utility
+** tools for the C++ language and the Qt toolkit.
+**
+** This software is governed by the CeCILL-C license under French law and
+** abiding by the rules of distribution of free software.  You can  use,
+** modify and/ or redistribute the software under the terms of the CeCILL-C
+** license as circulated by CEA, CNRS and INRIA at the following URL
+** "http://www.cecill.info".
+****************************************************************************/
+
+
+#pragma once
+
+#include "sql.h"
+#include <QtCore/QString>
+#include <QtCore/QTextStream>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+class QIODevice;
+class QThread;
+
+namespace qtsql {
+
+class QTTOOLS_SQL_EXPORT SqlLogWriter
+{
+public:
+    SqlLogWriter();
+    ~SqlLogWriter();
+
+    QIODevice* device() const;
+    void setDevice(QIODevice* device);
+
+    int maxPendingCount() const;
+    void setMaxPendingCount(int count);
+
+    void log(const QString& sqlCode, const QThread* inThread, qint64 durationUsec = -1);
+    void flush();
+
+private:
+    SqlLogWriter(const SqlLogWriter&);
+    SqlLogWriter& operator=(const SqlLogWriter&);
+
+    struct Entry
+    {
+        QString sqlCode;
+        QString threadName;
+        const QThread* thread;
+        qint64 durationUsec;
+    };
+
+    void writerLoop();
+    void waitIdle(std::unique_lock<std::mutex>& lock);
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_pendingCondition;
+    std::condition_variable m_idleCondition;
+    std::vector<Entry> m_pendingEntries;
+    qint64 m_droppedCount;
+    int m_maxPendingCount;
+    bool m_isWriting;
+    bool m_isStopRequested;
+    QTextStream m_stream; // Only used by the writer thread, or when idle
+    std::thread m_thread;
+};
+
+} // namespace qtsql
@@ -0,0 +1,109 @@
+/****************************************************************************
+**  FougTools
+**  Copyright Fougue (30 Mar. 2015)
+**  contact@fougue.pro
+**
+** This software is a computer program whose purpose is to provide utility
+** tools for the C++ language and the Qt toolkit.
+**
+** This software is governed by the CeCILL-C license under French law and
+** abiding by the rules of distribution of free software.  You can  use,
+** modify and/ or redistribute the software under the terms of the CeCILL-C
+** license as circulated by CEA, CNRS and INRIA at the following URL
+** "http://www.cecill.info".
+****************************************************************************/
+
+
+#include "sql_row_stream.h"
+
+#include "qsql_query_utils.h"
+#include <QtSql/QSqlRecord>
+
+namespace qtsql {
+
+/*!
+ * \class SqlRowStream
+ * \brief Provides forward-only iteration over the rows of a SQL query
+ *
+ * The query is executed with QSqlQuery::setForwardOnly(true), so the driver
+ * does not cache the rows already visited. Combined with forEachChunk(), this
+ * allows processing results of any size in constant memory.
+ *
+ * \code
+ *     qtsql::SqlRowStream rows("SELECT id, x, y FROM point", db);
+ *     rows.forEachChunk<Point>(
+ *                 4096,
+ *                 [](const qtsql::SqlRowStream& row) {
+ *                     return Point(row.get<qint64>(0), row.get<double>(1), row.get<double>(2));
+ *                 },
+ *                 [&](const std::vector<Point>& points) { exportPoints(points); } );
+ * \endcode
+ *
+ * \headerfile sql_row_stream.h <qttools/sql/sql_row_stream.h>
+ * \ingroup qttools_sql
+ */
+
+/*! \brief Executes \p sqlCode on \p db with positional \p bindValues
+ *
+ *  \throws SqlQueryError if the connection is not open or SQL execution fails
+ */
+SqlRowStream::SqlRowStream(const QString& sqlCode,
+                           const QSqlDatabase& db,
+                           const QVariantList& bindValues)
+    : m_query(db),
+      m_rowIndex(-1),
+      m_columnCount(0)
+{
+    if (!db.isValid() || !db.isOpen()) {
+        throw SqlQueryError(QSqlError(QLatin1String("db is not valid or not open"),
+                                      QLatin1String(""),
+                                      QSqlError::ConnectionError));
+    }
+
+    m_query.setForwardOnly(true);
+    if (!m_query.prepare(sqlCode))
+        throw SqlQueryError(m_query);
+    for (int i = 0; i < bindValues.size(); ++i)
+        m_query.bindValue(i, bindValues.at(i));
+    m_query.exec();
+    qtsql::throwIfError(m_query);
+    m_columnCount = m_query.record().count();
+}
+
+//! Moves to the next row, returns false once all rows are visited
+bool SqlRowStream::next()
+{
+    if (!m_query.next())
+        return false;
+    ++m_rowIndex;
+    return true;
+}
+
+//! Index of the current row, -1 before the first call to next()
+qint64 SqlRowStream::rowIndex() const
+{
+    return m_rowIndex;
+}
+
+int SqlRowStream::columnCount() const
+{
+    return m_columnCount;
+}
+
+bool SqlRowStream::isNull(int column) const
+{
+    return m_query.isNull(column);
+}
+
+QVariant SqlRowStream::value(int column) const
+{
+    return m_query.value(column);
+}
+
+//! Underlying forward-only query
+QSqlQuery& SqlRowStream::query()
+{
+    return m_query;
+}
+
+} // namespace qtsql
@@ -0,0 +1,119 @@
+/****************************************************************************
+**  FougTools
+**  Copyright Fougue (30 Mar. 2015)
+**  contact@fougue.pro
+**
+** This software is a computer program whose purpose is to provide utility
+** tools for the C++ language and the Qt toolkit.
+**
+** This software is governed by the CeCILL-C license under French law and
+** abiding by the rules of distribution of free software.  You can  use,
+** modify and/ or redistribute the software under the terms of the CeCILL-C
+** license as circulated by CEA, CNRS and INRIA at the following URL
+** "http://www.cecill.info".
+****************************************************************************/
+
+
+#pragma once
+
+#include "sql.h"
+#include <QtCore/QVariant>
+#include <QtCore/QVariantList>
+#include <QtSql/QSqlDatabase>
+#include <QtSql/QSqlQuery>
+#include <vector>
+
+namespace qtsql {
+
+class QTTOOLS_SQL_EXPORT SqlRowStream
+{
+public:
+    SqlRowStream(const QString& sqlCode,
+                 const QSqlDatabase& db,
+                 const QVariantList& bindValues = QVariantList());
+
+    bool next();
+    qint64 rowIndex() const;
+    int columnCount() const;
+
+    bool isNull(int column) const;
+    QVariant value(int column) const;
+    template<typename T> T get(int column) const;
+
+    template<typename FUNC>
+    qint64 forEachRow(FUNC fn);
+
+    template<typename ROW, typename DECODE_FUNC, typename CONSUME_FUNC>
+    qint64 forEachChunk(int chunkSize, DECODE_FUNC decodeFn, CONSUME_FUNC consumeFn);
+
+    QSqlQuery& query();
+
+private:
+    QSqlQuery m_query;
+    qint64 m_rowIndex;
+    int m_columnCount;
+};
+
+
+
+// --
+// -- Implementation
+// --
+
+/*! \brief Value of \p column in the current row, converted to T
+ *
+ *  Numeric and date types are stored inside the QVariant returned by the
+ *  driver, their conversion involves no allocation
+ */
+template<typename T>
+T SqlRowStream::get(int column) const
+{
+    return m_query.value(column).value<T>();
+}
+
+/*! \brief Calls \p fn(const SqlRowStream&) for each remaining row
+ *
+ *  \returns The count of rows processed
+ */
+template<typename FUNC>
+qint64 SqlRowStream::forEachRow(FUNC fn)
+{
+    qint64 rowCount = 0;
+    while (this->next()) {
+        fn(static_cast<const SqlRowStream&>(*this));
+        ++rowCount;
+    }
+    return rowCount;
+}
+
+/*! \brief Decodes the remaining rows by chunks of \p chunkSize rows
+ *
+ *  Each row is decoded with \p decodeFn(const SqlRowStream&) -> ROW into a
+ *  buffer passed to \p consumeFn(const std::vector<ROW>&) once full (and
+ *  for the last partial chunk). The buffer is reused, so memory stays
+ *  constant whatever the count of rows.
+ *
+ *  \returns The count of rows processed
+ */
+template<typename ROW, typename DECODE_FUNC, typename CONSUME_FUNC>
+qint64 SqlRowStream::forEachChunk(
+        int chunkSize, DECODE_FUNC decodeFn, CONSUME_FUNC consumeFn)
+{
+    const std::size_t bufferSize = chunkSize > 0 ? chunkSize : 1;
+    std::vector<ROW> buffer;
+    buffer.reserve(bufferSize);
+    qint64 rowCount = 0;
+    while (this->next()) {
+        buffer.push_back(decodeFn(static_cast<const SqlRowStream&>(*this)));
+        ++rowCount;
+        if (buffer.size() == bufferSize) {
+            consumeFn(static_cast<const std::vector<ROW>&>(buffer));
+            buffer.clear();
+        }
+    }
+    if (!buffer.empty())
+        consumeFn(static_cast<const std::vector<ROW>&>(buffer));
+    return rowCount;
+}
+
+} // namespace qtsql
@@ -16,18 +16,27 @@
 #include "base_runner.h"
 
 #include "manager.h"
+#include "../../cpptools/profiling.h"
 
 namespace qttask {
 
 BaseRunner::BaseRunner(const Manager *mgr)
     : m_mgr(mgr),
       m_taskId(0),
+      m_launchBlockerCount(1), // Released by run()
+      m_priority(NormalPriority),
+      m_deadline(Clock::time_point::max()),
       m_signals(this),
       m_progress(this)
-{ }
+{
+    m_timestamps.queued = TaskTimestamps::Clock::now();
+}
 
+//! Unregisters the task if not already done (ex: runner never run)
 BaseRunner::~BaseRunner()
-{ }
+{
+    m_mgr->m_taskRegistry.remove(m_taskId);
+}
 
 quint64 BaseRunner::taskId() const
 {
@@ -54,15 +63,108 @@ const Progress &BaseRunner::progress() const
     return m_progress;
 }
 
+/*! Launches the execution of \p func with this runner
+ *
+ *  If the runner has dependencies (see addDependency()), execution is
+ *  postponed until all prerequisite tasks are finished.
+ */
 void BaseRunner::run(std::function<void()>&& func)
 {
     m_func = func;
     if (m_func) {
+        m_timestamps.aboutToRun = TaskTimestamps::Clock::now();
         m_signals.emitAboutToRun();
-        launch();
+        this->releaseLaunchBlocker();
     }
 }
 
+/*! \brief Makes the execution of this task wait for the end of
+ *         \p prerequisite
+ *
+ *  This task is then launched directly by the thread that finishes the last of
+ *  its prerequisites, without going through the event loop of the Manager's
+ *  thread. A pipeline load -> mesh -> index is simply :
+ *  \code
+ *      mesh->addDependency(load);
+ *      index->addDependency(mesh);
+ *      index->run(...); mesh->run(...); load->run(...);
+ *  \endcode
+ *
+ *  Dependencies must be added before run() is called on \p prerequisite
+ *  and on this runner.
+ */
+void BaseRunner::addDependency(BaseRunner* prerequisite)
+{
+    ++m_launchBlockerCount;
+    prerequisite->m_dependents.push_back(this);
+}
+
+//! Token polled by isAbortRequested() and cancelled by requestAbort()
+const CancellationToken &BaseRunner::cancellationToken() const
+{
+    return m_cancellationToken;
+}
+
+/*! \brief Makes this task share abort requests with \p token
+ *
+ *  Typically \p token is the childToken() of a parent task, so aborting the
+ *  parent also aborts this task. See Manager::newSubTask()
+ */
+void BaseRunner::setCancellationToken(const CancellationToken &token)
+{
+    m_cancellationToken = token;
+}
+
+/*! \brief Urgency of this task, NormalPriority by default
+ *
+ *  Priority is honored by the runners that queue tasks :
+ *  Runner<PriorityThreadPool> (see also setDeadline()), Runner<QThreadPool>.
+ *  Runner<QThread> maps it to the priority of the thread.
+ *
+ *  Must be set before run() is called.
+ */
+BaseRunner::Priority BaseRunner::priority() const
+{
+    return m_priority;
+}
+
+void BaseRunner::setPriority(Priority priority)
+{
+    m_priority = priority;
+}
+
+/*! \brief Time point before which this task should start, none by default
+ *
+ *  Runner<PriorityThreadPool> runs tasks of the same priority in deadline
+ *  order, and a task whose deadline is reached runs before any other task.
+ *
+ *  Must be set before run() is called.
+ */
+BaseRunner::Clock::time_point BaseRunner::deadline() const
+{
+    return m_deadline;
+}
+
+void BaseRunner::setDeadline(Clock::time_point deadline)
+{
+    m_deadline = deadline;
+}
+
+bool BaseRunner::hasDeadline() const
+{
+    return m_deadline != Clock::time_point::max();
+}
+
+/*! \brief Time points in the life of this task
+ *
+ *  They are complete once the task function is finished, see also
+ *  Manager::taskTimingStats()
+ */
+const TaskTimestamps &BaseRunner::timestamps() const
+{
+    return m_timestamps;
+}
+
 BaseRunnerSignals *BaseRunner::qtSignals()
 {
     return &m_signals;
@@ -71,18 +173,38 @@ BaseRunnerSignals *BaseRunner::qtSignals()
 void BaseRunner::execRunnableFunc()
 {
     m_signals.emitStarted(m_taskTitle);
-    m_func();
+    m_timestamps.threadId = std::this_thread::get_id();
+    m_timestamps.started = TaskTimestamps::Clock::now();
+    {
+        CPPTOOLS_PROFILE_ZONE("qttask::BaseRunner::execRunnableFunc");
+        m_func();
+    }
+    m_timestamps.ended = TaskTimestamps::Clock::now();
+    m_mgr->recordTimings(this);
+    m_progress.flushValue();
+    // Runner may be destroyed as soon as emitDestroyRequest() is called
+    const std::vector<BaseRunner*> dependents = std::move(m_dependents);
+    for (BaseRunner* dependent : dependents)
+        dependent->releaseLaunchBlocker();
     m_signals.emitEnded();
     m_signals.emitDestroyRequest();
 }
 
+void BaseRunner::releaseLaunchBlocker()
+{
+    if (m_launchBlockerCount.fetch_sub(1) == 1)
+        this->launch();
+}
+
 bool BaseRunner::isAbortRequested()
 {
-    return false;
+    return m_cancellationToken.isCancellationRequested();
 }
 
 void BaseRunner::requestAbort()
-{ }
+{
+    m_cancellationToken.requestCancellation();
+}
 
 void BaseRunner::launch()
 { }
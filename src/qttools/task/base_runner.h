@@ -17,8 +17,12 @@
 
 #include "progress.h"
 #include "base_runner_signals.h"
+#include "cancellation_token.h"
+#include "task_timing.h"
 
+#include <atomic>
 #include <functional>
+#include <vector>
 
 namespace qttask {
 
@@ -31,6 +35,17 @@ class Manager;
 class BaseRunner
 {
 public:
+    //! Urgency of a task, higher values are scheduled first
+    enum Priority
+    {
+        BackgroundPriority = -1,
+        NormalPriority = 0,
+        HighPriority = 1,
+        InteractivePriority = 2
+    };
+
+    typedef TaskTimestamps::Clock Clock;
+
     virtual ~BaseRunner();
 
     quint64 taskId() const;
@@ -42,6 +57,19 @@ public:
     const Progress& progress() const;
 
     void run(std::function<void()>&& func);
+    void addDependency(BaseRunner* prerequisite);
+
+    const CancellationToken& cancellationToken() const;
+    void setCancellationToken(const CancellationToken& token);
+
+    Priority priority() const;
+    void setPriority(Priority priority);
+
+    Clock::time_point deadline() const;
+    void setDeadline(Clock::time_point deadline);
+    bool hasDeadline() const;
+
+    const TaskTimestamps& timestamps() const;
 
 protected:
     BaseRunner(const Manager* mgr);
@@ -56,6 +84,8 @@ protected:
     virtual void destroy();
 
 private:
+    void releaseLaunchBlocker();
+
     friend class BaseRunnerSignals;
     friend class Manager;
     friend class Progress;
@@ -64,6 +94,12 @@ private:
     quint64 m_taskId;
     QString m_taskTitle;
     std::function<void()> m_func;
+    std::vector<BaseRunner*> m_dependents;
+    std::atomic<int> m_launchBlockerCount;
+    CancellationToken m_cancellationToken;
+    Priority m_priority;
+    Clock::time_point m_deadline;
+    TaskTimestamps m_timestamps;
 
     BaseRunnerSignals m_signals;
     Progress m_progress;
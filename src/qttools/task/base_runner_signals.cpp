@@ -24,7 +24,6 @@ BaseRunnerSignals::BaseRunnerSignals(BaseRunner* runner, QObject *parent)
     : QObject(parent),
       m_runner(runner)
 {
-    QObject::connect(this, &BaseRunnerSignals::aboutToRun, runner->m_mgr, &Manager::onAboutToRun);
     QObject::connect(this, &BaseRunnerSignals::started, runner->m_mgr, &Manager::started);
     QObject::connect(this, &BaseRunnerSignals::progressStep, runner->m_mgr, &Manager::progressStep);
     QObject::connect(this, &BaseRunnerSignals::progress, runner->m_mgr, &Manager::progress);
@@ -0,0 +1,100 @@
+/****************************************************************************
+**  FougTools
+**  Copyright Fougue (30 Mar. 2015)
+**  contact@fougue.pro
+**
+** This software is a computer program whose purpose is to provide utility
+** tools for the C++ language and the Qt toolkit.
+**
+** This software is governed by the CeCILL-C license under French law and
+** abiding by the rules of distribution of free software.  You can  use,
+** modify and/ or redistribute the software under the terms of the CeCILL-C
+** license as circulated by CEA, CNRS and INRIA at the following URL
+** "http://www.cecill.info".
+****************************************************************************/
+
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+
+namespace qttask {
+
+/*! \brief Shared flag telling cooperating tasks to stop
+ *
+ *  Copies of a CancellationToken share the same state, so a token can be
+ *  handed to any count of threads. A token obtained with childToken() is also
+ *  cancelled when its parent is cancelled, but cancelling the child does not
+ *  affect the parent.
+ *
+ *  isCancellationRequested() only does relaxed atomic loads (one per level
+ *  of parent), so it is cheap enough to be polled in inner loops.
+ */
+class CancellationToken
+{
+public:
+    CancellationToken();
+
+    CancellationToken childToken() const;
+
+    bool isCancellationRequested() const;
+    void requestCancellation();
+
+private:
+    struct State
+    {
+        State(const std::shared_ptr<State>& parentState);
+        std::atomic<bool> isCancelled;
+        const std::shared_ptr<State> parent;
+    };
+
+    CancellationToken(const std::shared_ptr<State>& state);
+
+    std::shared_ptr<State> m_state;
+};
+
+
+
+// --
+// -- Implementation
+// --
+
+inline CancellationToken::State::State(
+        const std::shared_ptr<State>& parentState)
+    : isCancelled(false),
+      parent(parentState)
+{ }
+
+inline CancellationToken::CancellationToken()
+    : m_state(std::make_shared<State>(std::shared_ptr<State>()))
+{ }
+
+inline CancellationToken::CancellationToken(const std::shared_ptr<State>& state)
+    : m_state(state)
+{ }
+
+//! Returns a new token cancelled when either itself or this token is cancelled
+inline CancellationToken CancellationToken::childToken() const
+{
+    return CancellationToken(std::make_shared<State>(m_state));
+}
+
+inline bool CancellationToken::isCancellationRequested() const
+{
+    for (const State* state = m_state.get();
+         state != nullptr;
+         state = state->parent.get())
+    {
+        if (state->isCancelled.load(std::memory_order_relaxed))
+            return true;
+    }
+    return false;
+}
+
+inline void CancellationToken::requestCancellation()
+{
+    m_state->isCancelled.store(true, std::memory_order_relaxed);
+}
+
+} // namespace qttask
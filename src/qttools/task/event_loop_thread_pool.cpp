@@ -0,0 +1,89 @@
+/****************************************************************************
+**  FougTools
+**  Copyright Fougue (30 Mar. 2015)
+**  contact@fougue.pro
+**
+** This software is a computer program whose purpose is to provide utility
+** tools for the C++ language and the Qt toolkit.
+**
+** This software is governed by the CeCILL-C license under French law and
+** abiding by the rules of distribution of free software.  You can  use,
+** modify and/ or redistribute the software under the terms of the CeCILL-C
+** license as circulated by CEA, CNRS and INRIA at the following URL
+** "http://www.cecill.info".
+****************************************************************************/
+
+
+#include "event_loop_thread_pool.h"
+
+#include <QtCore/QGlobalStatic>
+#include <QtCore/QObject>
+#include <QtCore/QThread>
+#include <QtCore/QTimer>
+
+namespace qttask {
+
+EventLoopThreadPool::Worker::Worker()
+    : thread(new QThread),
+      context(new QObject),
+      pendingJobCount(0)
+{
+    context->moveToThread(thread.get());
+    thread->start();
+}
+
+//! Quits the event loop once the jobs already posted are run
+EventLoopThreadPool::Worker::~Worker()
+{
+    QThread* workerThread = thread.get();
+    QTimer::singleShot(0, context.get(), [=] { workerThread->quit(); } );
+    thread->wait();
+    context.reset();
+}
+
+/*! \param threadCount  Count of threads (0 means QThread::idealThreadCount())
+ */
+EventLoopThreadPool::EventLoopThreadPool(int threadCount)
+{
+    if (threadCount <= 0)
+        threadCount = QThread::idealThreadCount();
+    if (threadCount <= 0)
+        threadCount = 1;
+
+    for (int i = 0; i < threadCount; ++i)
+        m_workers.emplace_back(new Worker);
+}
+
+//! Runs the pending jobs, then stops the threads
+EventLoopThreadPool::~EventLoopThreadPool()
+{ }
+
+int EventLoopThreadPool::threadCount() const
+{
+    return static_cast<int>(m_workers.size());
+}
+
+//! Schedules \p job to be run by the event loop of some pool thread
+void EventLoopThreadPool::start(Job job)
+{
+    Worker* worker = m_workers.front().get();
+    for (const std::unique_ptr<Worker>& candidate : m_workers) {
+        if (candidate->pendingJobCount < worker->pendingJobCount)
+            worker = candidate.get();
+    }
+
+    ++worker->pendingJobCount;
+    QTimer::singleShot(0, worker->context.get(), [=] {
+        job();
+        --worker->pendingJobCount;
+    } );
+}
+
+Q_GLOBAL_STATIC(EventLoopThreadPool, eventLoopThreadPoolGlobalInstance)
+
+EventLoopThreadPool *EventLoopThreadPool::globalInstance()
+{
+    return eventLoopThreadPoolGlobalInstance();
+}
+
+} // namespace qttask
@@ -0,0 +1,68 @@
+/****************************************************************************
+**  FougTools
+**  Copyright Fougue (30 Mar. 2015)
+**  contact@fougue.pro
+**
+** This software is a computer program whose purpose is to provide utility
+** tools for the C++ language and the Qt toolkit.
+**
+** This software is governed by the CeCILL-C license under French law and
+** abiding by the rules of distribution of free software.  You can  use,
+** modify and/ or redistribute the software under the terms of the CeCILL-C
+** license as circulated by CEA, CNRS and INRIA at the following URL
+** "http://www.cecill.info".
+****************************************************************************/
+
+
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <vector>
+
+class QObject;
+class QThread;
+
+namespace qttask {
+
+/*! \brief Pool of long-lived threads, each running a Qt event loop
+ *
+ *  Jobs are run by the event loop of a pool thread, so they can use timers,
+ *  queued connections and QObject::deleteLater() like inside a QThread::run()
+ *  calling exec(). But threads and event loops are created once, not per job.
+ *
+ *  A job is dispatched to the thread having the fewest pending jobs, jobs of
+ *  the same thread are run in submission order.
+ */
+class EventLoopThreadPool
+{
+public:
+    typedef std::function<void()> Job;
+
+    explicit EventLoopThreadPool(int threadCount = 0);
+    ~EventLoopThreadPool();
+
+    int threadCount() const;
+
+    void start(Job job);
+
+    static EventLoopThreadPool* globalInstance();
+
+private:
+    EventLoopThreadPool(const EventLoopThreadPool&);
+    EventLoopThreadPool& operator=(const EventLoopThreadPool&);
+
+    struct Worker
+    {
+        Worker();
+        ~Worker();
+        std::unique_ptr<QThread> thread;
+        std::unique_ptr<QObject> context; // Lives in thread, receives the jobs
+        std::atomic<int> pendingJobCount;
+    };
+
+    std::vector<std::unique_ptr<Worker>> m_workers;
+};
+
+} // namespace qttask
@@ -18,15 +18,26 @@
 #include "base_runner.h"
 
 #include <QtCore/QGlobalStatic>
+#include <QtCore/QIODevice>
+#include <QtCore/QJsonArray>
+#include <QtCore/QJsonDocument>
+#include <QtCore/QJsonObject>
+#include <QtCore/QThreadPool>
+
+#include <unordered_map>
 
 namespace qttask {
 
 Manager::Manager(QObject *parent)
     : QObject(parent),
-      m_taskIdSeq(0)
+      m_progressSignalInterval(50),
+      m_isTimingEnabled(false),
+      m_isTraceEnabled(false),
+      m_timingEpoch(TaskTimestamps::Clock::now())
 {
 }
 
+//! Waits for the tasks running in the thread pools of this manager
 Manager::~Manager()
 { }
 
@@ -49,21 +60,157 @@ void Manager::requestAbort(quint64 taskId)
         runner->requestAbort();
 }
 
-Q_GLOBAL_STATIC(Manager, mgrGlobalInstance)
+/*! \brief Thread pool owned by this manager, identified by \p poolId
+ *
+ *  Pools are created on first request, they are distinct from
+ *  QThreadPool::globalInstance() so tasks do not starve other users of the
+ *  global pool. Each pool can be sized for its workload with
+ *  QThreadPool::setMaxThreadCount() and QThreadPool::setExpiryTimeout().
+ *
+ *  Runner<QThreadPool> uses the pool DefaultThreadPool unless another pool is
+ *  given to newTask().
+ *
+ *  This function is thread-safe.
+ */
+QThreadPool* Manager::threadPool(int poolId) const
+{
+    std::lock_guard<std::mutex> lock(m_threadPoolsMutex);
+    auto it = m_threadPools.find(poolId);
+    if (it == m_threadPools.end()) {
+        std::unique_ptr<QThreadPool> pool(new QThreadPool);
+        it = m_threadPools.emplace(poolId, std::move(pool)).first;
+    }
+    return (*it).second.get();
+}
 
-Manager *Manager::globalInstance()
+/*! \brief Minimum interval in milliseconds between two progress() signals of
+ *         a task
+ *
+ *  Default is 50ms. 0 disables throttling, progress() is then signaled for
+ *  every change of value.
+ *
+ *  \sa Progress::setValue()
+ */
+int Manager::progressSignalInterval() const
 {
-    return mgrGlobalInstance();
+    return m_progressSignalInterval;
 }
 
-void Manager::onAboutToRun(BaseRunner *runner)
+void Manager::setProgressSignalInterval(int msec)
 {
-    m_taskIdToRunner.emplace(runner->m_taskId, runner);
+    m_progressSignalInterval = msec;
+}
+
+/*! \brief Whether timings of finished tasks are aggregated into
+ *         taskTimingStats()
+ *
+ *  Disabled by default. Timestamps of each task are always available with
+ *  BaseRunner::timestamps()
+ */
+bool Manager::isTimingEnabled() const
+{
+    return m_isTimingEnabled;
+}
+
+void Manager::setTimingEnabled(bool on)
+{
+    m_isTimingEnabled = on;
+}
+
+/*! \brief Timings of the tasks finished while timing was enabled, aggregated
+ *         by task title
+ *
+ *  This function is thread-safe.
+ */
+QHash<QString, TaskTimingStats> Manager::taskTimingStats() const
+{
+    std::lock_guard<std::mutex> lock(m_timingsMutex);
+    return m_taskTimingStats;
+}
+
+/*! \brief Whether timestamps of each finished task are kept for
+ *         writeChromeTrace()
+ *
+ *  Disabled by default. Memory grows with the count of tasks until
+ *  clearTimings() is called.
+ */
+bool Manager::isTraceEnabled() const
+{
+    return m_isTraceEnabled;
+}
+
+void Manager::setTraceEnabled(bool on)
+{
+    m_isTraceEnabled = on;
+}
+
+/*! \brief Writes the tasks recorded while trace was enabled to \p device,
+ *         in the Chrome trace event format (JSON)
+ *
+ *  The output can be loaded in chrome://tracing or https://ui.perfetto.dev.
+ *  Each task is a complete event of its execution thread, its queue latency
+ *  is given in the arguments of the event.
+ *
+ *  \returns \c false if \p device could not be written
+ */
+bool Manager::writeChromeTrace(QIODevice* device) const
+{
+    typedef std::chrono::duration<double, std::micro> MicroSeconds;
+    std::vector<TraceEvent> events;
+    {
+        std::lock_guard<std::mutex> lock(m_timingsMutex);
+        events = m_traceEvents;
+    }
+
+    QJsonArray jsonEvents;
+    std::unordered_map<std::thread::id, int> threadIndexes;
+    for (const TraceEvent& event : events) {
+        const TaskTimestamps& ts = event.timestamps;
+        auto itThread = threadIndexes.emplace(
+                    ts.threadId, static_cast<int>(threadIndexes.size())).first;
+        QJsonObject jsonArgs;
+        jsonArgs.insert(QLatin1String("taskId"), QString::number(event.taskId));
+        jsonArgs.insert(QLatin1String("queueLatencyUs"),
+                        MicroSeconds(ts.started - ts.aboutToRun).count());
+        QJsonObject jsonEvent;
+        jsonEvent.insert(QLatin1String("name"), event.taskTitle);
+        jsonEvent.insert(QLatin1String("cat"), QLatin1String("task"));
+        jsonEvent.insert(QLatin1String("ph"), QLatin1String("X"));
+        jsonEvent.insert(QLatin1String("ts"),
+                         MicroSeconds(ts.started - m_timingEpoch).count());
+        jsonEvent.insert(QLatin1String("dur"),
+                         MicroSeconds(ts.ended - ts.started).count());
+        jsonEvent.insert(QLatin1String("pid"), 1);
+        jsonEvent.insert(QLatin1String("tid"), (*itThread).second);
+        jsonEvent.insert(QLatin1String("args"), jsonArgs);
+        jsonEvents.append(jsonEvent);
+    }
+
+    QJsonObject jsonTrace;
+    jsonTrace.insert(QLatin1String("traceEvents"), jsonEvents);
+    jsonTrace.insert(QLatin1String("displayTimeUnit"), QLatin1String("ms"));
+    const QByteArray json = QJsonDocument(jsonTrace).toJson(QJsonDocument::Compact);
+    return device->write(json) == json.size();
+}
+
+//! Clears taskTimingStats() and the events recorded for writeChromeTrace()
+void Manager::clearTimings()
+{
+    std::lock_guard<std::mutex> lock(m_timingsMutex);
+    m_taskTimingStats.clear();
+    m_traceEvents.clear();
+}
+
+Q_GLOBAL_STATIC(Manager, mgrGlobalInstance)
+
+Manager *Manager::globalInstance()
+{
+    return mgrGlobalInstance();
 }
 
 void Manager::onDestroyRequest(BaseRunner *runner)
 {
-    m_taskIdToRunner.erase(runner->taskId());
+    m_taskRegistry.remove(runner->taskId());
     runner->destroy();
 }
 
@@ -74,8 +221,31 @@ BaseRunner *Manager::getRunner(quint64 taskId)
 
 const BaseRunner *Manager::getRunner(quint64 taskId) const
 {
-    auto it = m_taskIdToRunner.find(taskId);
-    return it != m_taskIdToRunner.end() ? (*it).second : nullptr;
+    return m_taskRegistry.find(taskId);
+}
+
+//! Called by the thread executing \p runner, once its function is finished
+void Manager::recordTimings(const BaseRunner *runner) const
+{
+    const bool isTimingEnabled = m_isTimingEnabled;
+    const bool isTraceEnabled = m_isTraceEnabled;
+    if (!isTimingEnabled && !isTraceEnabled)
+        return;
+
+    typedef TaskDurationHistogram::Duration Duration;
+    const TaskTimestamps& ts = runner->timestamps();
+    std::lock_guard<std::mutex> lock(m_timingsMutex);
+    if (isTimingEnabled) {
+        TaskTimingStats& stats = m_taskTimingStats[runner->taskTitle()];
+        stats.queueLatency.add(
+                    std::chrono::duration_cast<Duration>(ts.started - ts.aboutToRun));
+        stats.runDuration.add(
+                    std::chrono::duration_cast<Duration>(ts.ended - ts.started));
+    }
+    if (isTraceEnabled) {
+        const TraceEvent event = { runner->taskId(), runner->taskTitle(), ts };
+        m_traceEvents.push_back(event);
+    }
 }
 
 } // namespace qttask
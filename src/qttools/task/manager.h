@@ -16,11 +16,20 @@
 #pragma once
 
 #include "runner_qthread.h"
+#include "task_registry.h"
+#include "task_timing.h"
 
+#include <QtCore/QHash>
 #include <QtCore/QObject>
 
 #include <atomic>
+#include <memory>
+#include <mutex>
 #include <unordered_map>
+#include <vector>
+
+class QIODevice;
+class QThreadPool;
 
 namespace qttask {
 
@@ -45,6 +54,14 @@ public:
      *      task->run( [=] { someFunction(task->progress()); } );
      *  \endcode
      *
+     *  Whatever the backend, urgency of the task can be set with
+     *  BaseRunner::setPriority() and BaseRunner::setDeadline() before
+     *  BaseRunner::run(). Runner<PriorityThreadPool> is the backend
+     *  scheduling on both.
+     *
+     *  Typed results are returned with runWithResult() and streamed with
+     *  runWithChannel(), see task_result.h
+     *
      *  The created Runner object will be automatically deleted at the end
      *  of BaseRunner::run().
      *  If for any reason BaseRunner::run() is not called, the Runner object
@@ -54,7 +71,20 @@ public:
     Runner<SELECTOR>* newTask(ARGS ... args)
     {
         auto runner = new Runner<SELECTOR>(this, args ...);
-        runner->m_taskId = m_taskIdSeq.fetch_add(1);
+        runner->m_taskId = m_taskRegistry.insert(runner);
+        return runner;
+    }
+
+    /*! \brief Same as newTask() but the created task is aborted along with
+     *         \p parent
+     *
+     *  Aborting the subtask does not abort \p parent
+     */
+    template<typename SELECTOR = QThread, typename ... ARGS>
+    Runner<SELECTOR>* newSubTask(const BaseRunner* parent, ARGS ... args)
+    {
+        auto runner = this->newTask<SELECTOR>(args ...);
+        runner->setCancellationToken(parent->cancellationToken().childToken());
         return runner;
     }
 
@@ -63,6 +93,22 @@ public:
 
     void requestAbort(quint64 taskId);
 
+    enum { DefaultThreadPool = 0 };
+    QThreadPool* threadPool(int poolId = DefaultThreadPool) const;
+
+    int progressSignalInterval() const;
+    void setProgressSignalInterval(int msec);
+
+    bool isTimingEnabled() const;
+    void setTimingEnabled(bool on);
+    QHash<QString, TaskTimingStats> taskTimingStats() const;
+
+    bool isTraceEnabled() const;
+    void setTraceEnabled(bool on);
+    bool writeChromeTrace(QIODevice* device) const;
+
+    void clearTimings();
+
     static Manager* globalInstance();
 
 signals:
@@ -73,15 +119,32 @@ signals:
     void ended(quint64 taskId);
 
 private:
+    friend class BaseRunner;
     friend class BaseRunnerSignals;
 
-    void onAboutToRun(BaseRunner* runner);
     void onDestroyRequest(BaseRunner* runner);
     BaseRunner* getRunner(quint64 taskId);
     const BaseRunner* getRunner(quint64 taskId) const;
+    void recordTimings(const BaseRunner* runner) const;
 
-    std::atomic<quint64> m_taskIdSeq;
-    std::unordered_map<quint64, BaseRunner*> m_taskIdToRunner;
+    struct TraceEvent
+    {
+        quint64 taskId;
+        QString taskTitle;
+        TaskTimestamps timestamps;
+    };
+
+    std::atomic<int> m_progressSignalInterval;
+    mutable TaskRegistry m_taskRegistry;
+    mutable std::mutex m_threadPoolsMutex;
+    mutable std::unordered_map<int, std::unique_ptr<QThreadPool>> m_threadPools;
+
+    std::atomic<bool> m_isTimingEnabled;
+    std::atomic<bool> m_isTraceEnabled;
+    const TaskTimestamps::Clock::time_point m_timingEpoch;
+    mutable std::mutex m_timingsMutex;
+    mutable QHash<QString, TaskTimingStats> m_taskTimingStats;
+    mutable std::vector<TraceEvent> m_traceEvents;
 };
 
 } // namespace qttask
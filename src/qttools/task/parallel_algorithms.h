@@ -0,0 +1,218 @@
+/****************************************************************************
+**  FougTools
+**  Copyright Fougue (30 Mar. 2015)
+**  contact@fougue.pro
+**
+** This software is a computer program whose purpose is to provide utility
+** tools for the C++ language and the Qt toolkit.
+**
+** This software is governed by the CeCILL-C license under French law and
+** abiding by the rules of distribution of free software.  You can  use,
+** modify and/ or redistribute the software under the terms of the CeCILL-C
+** license as circulated by CEA, CNRS and INRIA at the following URL
+** "http://www.cecill.info".
+****************************************************************************/
+
+
+#pragma once
+
+#include "cancellation_token.h"
+#include "progress.h"
+#include "work_stealing_pool.h"
+
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+namespace qttask {
+
+template<typename FUNC>
+bool parallelFor(
+        Progress& progress,
+        std::size_t count,
+        std::size_t grainSize,
+        FUNC fn,
+        WorkStealingPool* pool = WorkStealingPool::globalInstance());
+
+template<typename T, typename MAP_FUNC, typename REDUCE_FUNC>
+T parallelReduce(
+        Progress& progress,
+        std::size_t count,
+        std::size_t grainSize,
+        const T& identity,
+        MAP_FUNC mapFn,
+        REDUCE_FUNC reduceFn,
+        WorkStealingPool* pool = WorkStealingPool::globalInstance());
+
+
+
+// --
+// -- Implementation
+// --
+
+namespace internal {
+
+/*! Reports the count of processed items of a parallel loop to \p progress
+ *
+ *  Workers that find another worker already reporting just skip the report :
+ *  Progress is not thread-safe and coalesces values anyway
+ */
+class ParallelProgress
+{
+public:
+    ParallelProgress(Progress* progress, std::size_t count)
+        : m_progress(progress),
+          m_count(count),
+          m_doneCount(0)
+    { }
+
+    void addDone(std::size_t doneCount)
+    {
+        const std::size_t totalDone = m_doneCount.fetch_add(doneCount) + doneCount;
+        std::unique_lock<std::mutex> lock(m_mutex, std::try_to_lock);
+        if (lock.owns_lock())
+            this->setValue(totalDone);
+    }
+
+    void setFinalValue()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        this->setValue(m_doneCount.load());
+    }
+
+private:
+    void setValue(std::size_t doneCount)
+    {
+        const int pct = m_count > 0 ? static_cast<int>((doneCount * 100) / m_count) : 100;
+        if (pct > m_progress->value())
+            m_progress->setValue(pct);
+    }
+
+    Progress* m_progress;
+    const std::size_t m_count;
+    std::atomic<std::size_t> m_doneCount;
+    std::mutex m_mutex;
+};
+
+/*! Splits [0, count) into chunks of \p grainSize items and calls
+ *  \p fn(iChunk, chunkBegin, chunkEnd) for each chunk in \p pool
+ *
+ *  Chunks not yet started when abort is requested are skipped
+ */
+template<typename FUNC>
+bool parallelForChunks(
+        Progress& progress,
+        std::size_t count,
+        std::size_t grainSize,
+        FUNC fn,
+        WorkStealingPool* pool)
+{
+    if (grainSize == 0)
+        grainSize = 1;
+
+    const CancellationToken& token = progress.cancellationToken();
+    ParallelProgress parallelProgress(&progress, count);
+    WorkStealingPool::TaskGroup taskGroup(pool);
+    std::size_t iChunk = 0;
+    for (std::size_t chunkBegin = 0; chunkBegin < count; chunkBegin += grainSize) {
+        const std::size_t chunkEnd =
+                count - chunkBegin > grainSize ? chunkBegin + grainSize : count;
+        taskGroup.run([=, &token, &parallelProgress, &fn] {
+            if (!token.isCancellationRequested()) {
+                fn(iChunk, chunkBegin, chunkEnd);
+                parallelProgress.addDone(chunkEnd - chunkBegin);
+            }
+        } );
+        ++iChunk;
+    }
+    taskGroup.wait();
+    parallelProgress.setFinalValue();
+    return !token.isCancellationRequested();
+}
+
+//! Wrapper preventing std::vector<bool> packing, chunks write concurrently
+template<typename T>
+struct ParallelReduceResult
+{
+    T value;
+};
+
+} // namespace internal
+
+/*! \brief Calls \p fn(chunkBegin, chunkEnd) concurrently for each chunk of
+ *         \p grainSize items of [0, count)
+ *
+ *  Chunks are jobs of \p pool, the calling thread runs some of them while
+ *  waiting (so it can be a worker of \p pool, ex: a Runner<WorkStealingPool>).
+ *
+ *  The value of \p progress is updated as chunks are finished, from 0 to 100.
+ *  Remaining chunks are skipped as soon as abort is requested on the task of
+ *  \p progress.
+ *
+ *  If \p fn throws, the first exception is rethrown once started chunks are
+ *  finished.
+ *
+ *  \returns \c false if abort was requested
+ */
+template<typename FUNC>
+bool parallelFor(
+        Progress& progress,
+        std::size_t count,
+        std::size_t grainSize,
+        FUNC fn,
+        WorkStealingPool* pool)
+{
+    return internal::parallelForChunks(
+                progress,
+                count,
+                grainSize,
+                [&] (std::size_t, std::size_t chunkBegin, std::size_t chunkEnd) {
+                    fn(chunkBegin, chunkEnd);
+                },
+                pool);
+}
+
+/*! \brief Reduces the items of [0, count) concurrently, by chunks of
+ *         \p grainSize items
+ *
+ *  \p mapFn(chunkBegin, chunkEnd) returns the partial result T of a chunk.
+ *  Partial results are then reduced in chunk order with
+ *  \p reduceFn(const T&, const T&), starting with \p identity, so the result
+ *  is deterministic even if \p reduceFn is not commutative.
+ *
+ *  Progress, abort and exceptions are handled like with parallelFor(). When
+ *  aborted, the result only accounts for the finished chunks.
+ */
+template<typename T, typename MAP_FUNC, typename REDUCE_FUNC>
+T parallelReduce(
+        Progress& progress,
+        std::size_t count,
+        std::size_t grainSize,
+        const T& identity,
+        MAP_FUNC mapFn,
+        REDUCE_FUNC reduceFn,
+        WorkStealingPool* pool)
+{
+    if (grainSize == 0)
+        grainSize = 1;
+
+    const internal::ParallelReduceResult<T> identityResult = { identity };
+    std::vector<internal::ParallelReduceResult<T>> chunkResults(
+                (count + grainSize - 1) / grainSize, identityResult);
+    internal::parallelForChunks(
+                progress,
+                count,
+                grainSize,
+                [&] (std::size_t iChunk, std::size_t chunkBegin, std::size_t chunkEnd) {
+                    chunkResults[iChunk].value = mapFn(chunkBegin, chunkEnd);
+                },
+                pool);
+
+    T result = identity;
+    for (const internal::ParallelReduceResult<T>& chunkResult : chunkResults)
+        result = reduceFn(result, chunkResult.value);
+    return result;
+}
+
+} // namespace qttask
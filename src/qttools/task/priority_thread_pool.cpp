@@ -0,0 +1,146 @@
+/****************************************************************************
+**  FougTools
+**  Copyright Fougue (30 Mar. 2015)
+**  contact@fougue.pro
+**
+** This software is a computer program whose purpose is to provide utility
+** tools for the C++ language and the Qt toolkit.
+**
+** This software is governed by the CeCILL-C license under French law and
+** abiding by the rules of distribution of free software.  You can  use,
+** modify and/ or redistribute the software under the terms of the CeCILL-C
+** license as circulated by CEA, CNRS and INRIA at the following URL
+** "http://www.cecill.info".
+****************************************************************************/
+
+
+#include "priority_thread_pool.h"
+
+#include <QtCore/QGlobalStatic>
+
+#include <memory>
+
+namespace qttask {
+
+bool PriorityThreadPool::PriorityOrder::operator()(
+        const Entry* lhs, const Entry* rhs) const
+{
+    if (lhs->priority != rhs->priority)
+        return lhs->priority > rhs->priority;
+    if (lhs->deadline != rhs->deadline)
+        return lhs->deadline < rhs->deadline;
+    return lhs->seq < rhs->seq;
+}
+
+bool PriorityThreadPool::DeadlineOrder::operator()(
+        const Entry* lhs, const Entry* rhs) const
+{
+    if (lhs->deadline != rhs->deadline)
+        return lhs->deadline < rhs->deadline;
+    return lhs->seq < rhs->seq;
+}
+
+/*! \param threadCount  Count of worker threads (0 means as many as the
+ *                      hardware supports)
+ */
+PriorityThreadPool::PriorityThreadPool(unsigned threadCount)
+    : m_seq(0),
+      m_isStopRequested(false)
+{
+    if (threadCount == 0)
+        threadCount = std::thread::hardware_concurrency();
+    if (threadCount == 0)
+        threadCount = 1;
+
+    for (unsigned i = 0; i < threadCount; ++i)
+        m_threads.emplace_back(&PriorityThreadPool::workerLoop, this);
+}
+
+//! Runs all pending jobs, then joins the worker threads
+PriorityThreadPool::~PriorityThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_isStopRequested = true;
+    }
+    m_condition.notify_all();
+    for (std::thread& thread : m_threads)
+        thread.join();
+}
+
+unsigned PriorityThreadPool::threadCount() const
+{
+    return static_cast<unsigned>(m_threads.size());
+}
+
+std::size_t PriorityThreadPool::pendingJobCount() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_priorityQueue.size();
+}
+
+/*! \brief Schedules \p job to be run by some worker thread
+ *
+ *  \param priority  Jobs with higher values are run first
+ *  \param deadline  Time point before which \p job should start,
+ *                   Clock::time_point::max() means no deadline
+ */
+void PriorityThreadPool::start(
+        Job job, int priority, Clock::time_point deadline)
+{
+    std::unique_ptr<Entry> entry(new Entry);
+    entry->job = std::move(job);
+    entry->priority = priority;
+    entry->deadline = deadline;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        entry->seq = m_seq++;
+        m_priorityQueue.insert(entry.get());
+        if (deadline != Clock::time_point::max())
+            m_deadlineQueue.insert(entry.get());
+        entry.release();
+    }
+    m_condition.notify_one();
+}
+
+Q_GLOBAL_STATIC(PriorityThreadPool, priorityThreadPoolGlobalInstance)
+
+PriorityThreadPool *PriorityThreadPool::globalInstance()
+{
+    return priorityThreadPoolGlobalInstance();
+}
+
+void PriorityThreadPool::workerLoop()
+{
+    while (true) {
+        std::unique_ptr<Entry> entry;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_condition.wait(lock, [=] {
+                return m_isStopRequested || !m_priorityQueue.empty();
+            } );
+            if (m_priorityQueue.empty())
+                return; // Stop requested
+            entry.reset(this->popEntry());
+        }
+        entry->job();
+    }
+}
+
+//! Removes the next entry to run from the queues, m_mutex must be locked
+PriorityThreadPool::Entry* PriorityThreadPool::popEntry()
+{
+    Entry* entry = *m_priorityQueue.begin();
+    if (!m_deadlineQueue.empty()) {
+        Entry* earliestEntry = *m_deadlineQueue.begin();
+        if (earliestEntry->deadline <= Clock::now())
+            entry = earliestEntry;
+    }
+
+    m_priorityQueue.erase(entry);
+    if (entry->deadline != Clock::time_point::max())
+        m_deadlineQueue.erase(entry);
+    return entry;
+}
+
+} // namespace qttask
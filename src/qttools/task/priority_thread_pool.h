@@ -0,0 +1,96 @@
+/****************************************************************************
+**  FougTools
+**  Copyright Fougue (30 Mar. 2015)
+**  contact@fougue.pro
+**
+** This software is a computer program whose purpose is to provide utility
+** tools for the C++ language and the Qt toolkit.
+**
+** This software is governed by the CeCILL-C license under French law and
+** abiding by the rules of distribution of free software.  You can  use,
+** modify and/ or redistribute the software under the terms of the CeCILL-C
+** license as circulated by CEA, CNRS and INRIA at the following URL
+** "http://www.cecill.info".
+****************************************************************************/
+
+
+#pragma once
+
+#include <QtCore/QtGlobal>
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+namespace qttask {
+
+/*! \brief Pool of worker threads running jobs in priority and deadline order
+ *
+ *  An idle worker runs the pending job whose deadline is reached, if any
+ *  (earliest deadline first). Otherwise it runs the pending job with the
+ *  highest priority, then the earliest deadline, then the oldest submission.
+ *
+ *  So latency-sensitive jobs (ex: interactive previews) overtake bulk jobs
+ *  already queued, while bulk jobs given a deadline are not starved.
+ *  Running jobs are never interrupted.
+ *
+ *  Jobs must not throw.
+ */
+class PriorityThreadPool
+{
+public:
+    typedef std::function<void()> Job;
+    typedef std::chrono::steady_clock Clock;
+
+    explicit PriorityThreadPool(unsigned threadCount = 0);
+    ~PriorityThreadPool();
+
+    unsigned threadCount() const;
+    std::size_t pendingJobCount() const;
+
+    void start(
+            Job job,
+            int priority = 0,
+            Clock::time_point deadline = Clock::time_point::max());
+
+    static PriorityThreadPool* globalInstance();
+
+private:
+    PriorityThreadPool(const PriorityThreadPool&);
+    PriorityThreadPool& operator=(const PriorityThreadPool&);
+
+    struct Entry
+    {
+        Job job;
+        int priority;
+        Clock::time_point deadline;
+        quint64 seq;
+    };
+
+    struct PriorityOrder
+    {
+        bool operator()(const Entry* lhs, const Entry* rhs) const;
+    };
+
+    struct DeadlineOrder
+    {
+        bool operator()(const Entry* lhs, const Entry* rhs) const;
+    };
+
+    void workerLoop();
+    Entry* popEntry();
+
+    std::vector<std::thread> m_threads;
+    mutable std::mutex m_mutex;
+    std::condition_variable m_condition;
+    std::set<Entry*, PriorityOrder> m_priorityQueue;
+    std::set<Entry*, DeadlineOrder> m_deadlineQueue; // Entries with deadline
+    quint64 m_seq;
+    bool m_isStopRequested;
+};
+
+} // namespace qttask
@@ -16,12 +16,14 @@
 #include "progress.h"
 
 #include "base_runner.h"
+#include "manager.h"
 
 namespace qttask {
 
 Progress::Progress(BaseRunner *runner)
     : m_runner(runner),
-      m_value(0)
+      m_value(0),
+      m_emittedValue(-1)
 { }
 
 Progress::~Progress()
@@ -29,23 +31,44 @@ Progress::~Progress()
 
 int Progress::value() const
 {
-    return m_value;
+    return m_value.load(std::memory_order_relaxed);
 }
 
+/*! \brief Set the progress value, in percent
+ *
+ *  Manager::progress() is signaled only if \p pct differs from the last
+ *  value signaled, and at most once per Manager::progressSignalInterval().
+ *  Values set in the meantime are coalesced : the latest one is signaled on
+ *  the next allowed call, or at the end of the task.
+ */
 void Progress::setValue(int pct)
 {
-    m_value = pct;
-    m_runner->qtSignals()->emitProgress(pct);
+    m_value.store(pct, std::memory_order_relaxed);
+    if (pct == m_emittedValue)
+        return;
+
+    const auto now = std::chrono::steady_clock::now();
+    const std::chrono::milliseconds interval(
+                m_runner->m_mgr->progressSignalInterval());
+    if (m_emittedValue == -1 || now - m_emitTime >= interval)
+        this->emitValue(now);
 }
 
-const QString& Progress::step() const
+//! Returns a copy of the current step title, this function is thread-safe
+QString Progress::step() const
 {
-    return m_step;
+    const std::shared_ptr<const QString> step = std::atomic_load(&m_step);
+    return step ? *step : QString();
 }
 
+/*! \brief Set the current step title
+ *
+ *  The previous title stays valid for concurrent readers of step() until
+ *  they release it
+ */
 void Progress::setStep(const QString &title)
 {
-    m_step = title;
+    std::atomic_store(&m_step, std::make_shared<const QString>(title));
     m_runner->qtSignals()->emitProgressStep(title);
 }
 
@@ -62,8 +85,10 @@ void Progress::outputMessage(const QString &msg)
  */
 QVariant Progress::data(int key) const
 {
-    auto it = m_dataHash.find(key);
-    return it != m_dataHash.end() ? (*it).second : QVariant();
+    if (!m_dataHash)
+        return QVariant();
+    auto it = m_dataHash->find(key);
+    return it != m_dataHash->end() ? (*it).second : QVariant();
 }
 
 /*! \brief Set this progress' custom data for the key \p key to \p value
@@ -73,7 +98,33 @@ QVariant Progress::data(int key) const
  */
 void Progress::setData(int key, const QVariant &value)
 {
-    m_dataHash.emplace(key, value);
+    if (!m_dataHash)
+        m_dataHash.reset(new std::unordered_map<int, QVariant>);
+    (*m_dataHash)[key] = value;
+}
+
+void Progress::emitValue(std::chrono::steady_clock::time_point time)
+{
+    m_emittedValue = this->value();
+    m_emitTime = time;
+    m_runner->qtSignals()->emitProgress(m_emittedValue);
+}
+
+//! Signals the pending value that was coalesced by setValue(), if any
+void Progress::flushValue()
+{
+    if (m_emittedValue != -1 && this->value() != m_emittedValue)
+        this->emitValue(std::chrono::steady_clock::now());
+}
+
+/*! \brief Returns the cancellation token of the task
+ *
+ *  A copy of the token can be handed to worker threads spawned by the task,
+ *  they can then poll CancellationToken::isCancellationRequested()
+ */
+const CancellationToken& Progress::cancellationToken() const
+{
+    return m_runner->cancellationToken();
 }
 
 bool Progress::isAbortRequested() const
@@ -18,13 +18,21 @@
 #include <QtCore/QVariant>
 #include <QtCore/QString>
 
+#include <atomic>
+#include <chrono>
+#include <memory>
 #include <unordered_map>
 
 namespace qttask {
 
 class BaseRunner;
+class CancellationToken;
 
 /*! \brief Provides feedback on the progress of an executing operation
+ *
+ *  Progress is written by the thread executing the task. value() and step()
+ *  can be read concurrently from any thread without locking : the value is
+ *  an atomic integer and the step is published as an immutable string.
  */
 class Progress
 {
@@ -34,7 +42,7 @@ public:
     int value() const;
     void setValue(int pct);
 
-    const QString& step() const;
+    QString step() const;
     void setStep(const QString& title);
 
     void outputMessage(const QString& msg);
@@ -43,6 +51,7 @@ public:
     void setData(int key, const QVariant& value);
 
     bool isAbortRequested() const;
+    const CancellationToken& cancellationToken() const;
 
 private:
     friend class Manager;
@@ -50,10 +59,15 @@ private:
 
     Progress(BaseRunner* runner);
 
+    void emitValue(std::chrono::steady_clock::time_point time);
+    void flushValue();
+
     BaseRunner* m_runner;
-    std::unordered_map<int, QVariant> m_dataHash;
-    int m_value;
-    QString m_step;
+    std::unique_ptr<std::unordered_map<int, QVariant>> m_dataHash; // On demand
+    std::atomic<int> m_value;
+    int m_emittedValue;
+    std::chrono::steady_clock::time_point m_emitTime;
+    std::shared_ptr<const QString> m_step;
 };
 
 } // namespace qttask
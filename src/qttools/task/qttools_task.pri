@@ -3,15 +3,31 @@ INCLUDEPATH *= $$PWD/.. $$PWD/../..
 HEADERS += \
     $$PWD/base_runner.h \
     $$PWD/base_runner_signals.h \
+    $$PWD/cancellation_token.h \
+    $$PWD/event_loop_thread_pool.h \
     $$PWD/manager.h \
+    $$PWD/parallel_algorithms.h \
+    $$PWD/priority_thread_pool.h \
     $$PWD/progress.h \
     $$PWD/runner_current_thread.h \
+    $$PWD/runner_event_loop_thread_pool.h \
+    $$PWD/runner_priority_thread_pool.h \
     $$PWD/runner_qthread.h \
     $$PWD/runner_qthreadpool.h \
-    $$PWD/runner_stdasync.h
+    $$PWD/runner_stdasync.h \
+    $$PWD/runner_work_stealing_pool.h \
+    $$PWD/task_registry.h \
+    $$PWD/task_result.h \
+    $$PWD/task_timing.h \
+    $$PWD/work_stealing_pool.h
 
 SOURCES += \
     $$PWD/base_runner.cpp \
     $$PWD/base_runner_signals.cpp \
+    $$PWD/event_loop_thread_pool.cpp \
     $$PWD/manager.cpp \
-    $$PWD/progress.cpp
+    $$PWD/priority_thread_pool.cpp \
+    $$PWD/progress.cpp \
+    $$PWD/task_registry.cpp \
+    $$PWD/task_timing.cpp \
+    $$PWD/work_stealing_pool.cpp
@@ -28,22 +28,12 @@ class Runner<CurrentThread> : public BaseRunner
 {
 public:
     Runner<CurrentThread>(const Manager *mgr)
-        : BaseRunner(mgr),
-          m_isAbortRequested(false)
+        : BaseRunner(mgr)
     { }
 
 protected:
-    bool isAbortRequested() override
-    { return m_isAbortRequested; }
-
-    void requestAbort() override
-    { m_isAbortRequested = true; }
-
     void launch() override
     { this->execRunnableFunc(); }
-
-private:
-    bool m_isAbortRequested;
 };
 
 } // namespace qttask
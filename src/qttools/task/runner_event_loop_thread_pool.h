@@ -0,0 +1,48 @@
+/****************************************************************************
+**  FougTools
+**  Copyright Fougue (30 Mar. 2015)
+**  contact@fougue.pro
+**
+** This software is a computer program whose purpose is to provide utility
+** tools for the C++ language and the Qt toolkit.
+**
+** This software is governed by the CeCILL-C license under French law and
+** abiding by the rules of distribution of free software.  You can  use,
+** modify and/ or redistribute the software under the terms of the CeCILL-C
+** license as circulated by CEA, CNRS and INRIA at the following URL
+** "http://www.cecill.info".
+****************************************************************************/
+
+
+#pragma once
+
+#include "base_runner.h"
+#include "event_loop_thread_pool.h"
+
+namespace qttask {
+
+/*! \brief Task runner scheduled on an EventLoopThreadPool
+ *
+ *  Like Runner<QThread>, the task function runs inside a Qt event loop, but
+ *  no thread is created nor destroyed per task.
+ */
+template<>
+class Runner<EventLoopThreadPool> : public BaseRunner
+{
+public:
+    Runner<EventLoopThreadPool>(
+            const Manager* mgr,
+            EventLoopThreadPool* pool = EventLoopThreadPool::globalInstance())
+        : BaseRunner(mgr),
+          m_pool(pool)
+    { }
+
+protected:
+    void launch() override
+    { m_pool->start([=] { this->execRunnableFunc(); } ); }
+
+private:
+    EventLoopThreadPool* m_pool;
+};
+
+} // namespace qttask
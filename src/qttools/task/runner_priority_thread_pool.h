@@ -0,0 +1,59 @@
+/****************************************************************************
+**  FougTools
+**  Copyright Fougue (30 Mar. 2015)
+**  contact@fougue.pro
+**
+** This software is a computer program whose purpose is to provide utility
+** tools for the C++ language and the Qt toolkit.
+**
+** This software is governed by the CeCILL-C license under French law and
+** abiding by the rules of distribution of free software.  You can  use,
+** modify and/ or redistribute the software under the terms of the CeCILL-C
+** license as circulated by CEA, CNRS and INRIA at the following URL
+** "http://www.cecill.info".
+****************************************************************************/
+
+
+#pragma once
+
+#include "base_runner.h"
+#include "priority_thread_pool.h"
+
+namespace qttask {
+
+/*! \brief Task runner scheduled on a PriorityThreadPool, according to
+ *         BaseRunner::priority() and BaseRunner::deadline()
+ *
+ *  Typical use for a latency-sensitive task :
+ *  \code
+ *      auto task = mgr->newTask<qttask::PriorityThreadPool>();
+ *      task->setPriority(qttask::BaseRunner::InteractivePriority);
+ *      task->setDeadline(qttask::BaseRunner::Clock::now() + std::chrono::milliseconds(50));
+ *      task->run( [=] { ... } );
+ *  \endcode
+ */
+template<>
+class Runner<PriorityThreadPool> : public BaseRunner
+{
+public:
+    Runner<PriorityThreadPool>(
+            const Manager* mgr,
+            PriorityThreadPool* pool = PriorityThreadPool::globalInstance())
+        : BaseRunner(mgr),
+          m_pool(pool)
+    { }
+
+protected:
+    void launch() override
+    {
+        m_pool->start(
+                    [=] { this->execRunnableFunc(); },
+                    this->priority(),
+                    this->deadline());
+    }
+
+private:
+    PriorityThreadPool* m_pool;
+};
+
+} // namespace qttask
@@ -23,6 +23,9 @@
 namespace qttask {
 
 /*! \brief Task runner based on QThread
+ *
+ *  A thread and its event loop are created for each task, prefer
+ *  Runner<EventLoopThreadPool> for short tasks.
  */
 template<>
 class Runner<QThread> : public QThread, public BaseRunner
@@ -37,13 +40,38 @@ public:
 
 protected:
     bool isAbortRequested() override
-    { return this->isInterruptionRequested(); }
+    {
+        return this->isInterruptionRequested()
+                || BaseRunner::isAbortRequested();
+    }
 
     void requestAbort() override
-    { this->requestInterruption(); }
+    {
+        this->requestInterruption();
+        BaseRunner::requestAbort();
+    }
 
     void launch() override
-    { this->start(m_priority); }
+    {
+        QThread::Priority priority = m_priority;
+        if (priority == QThread::InheritPriority) {
+            // Qualified names, QThread has homonym members
+            switch (BaseRunner::priority()) {
+            case BaseRunner::BackgroundPriority:
+                priority = QThread::LowPriority;
+                break;
+            case BaseRunner::NormalPriority:
+                break;
+            case BaseRunner::HighPriority:
+                priority = QThread::HighPriority;
+                break;
+            case BaseRunner::InteractivePriority:
+                priority = QThread::HighestPriority;
+                break;
+            }
+        }
+        this->start(priority);
+    }
 
     void destroy() override
     { this->deleteLater(); }
@@ -16,26 +16,40 @@
 #pragma once
 
 #include "base_runner.h"
+#include "manager.h"
 
 #include <QtCore/QRunnable>
 #include <QtCore/QThreadPool>
 
 namespace qttask {
 
-/*! \brief Task runner using the global instance of QThreadPool
+/*! \brief Task runner using a QThreadPool
  *
- *  Internally using QThreadPool::globalInstance()->start(...)
+ *  By default the task is started in Manager::threadPool(), which is not
+ *  QThreadPool::globalInstance()
  */
 template<>
 class Runner<QThreadPool> : public QRunnable, public BaseRunner
 {
 public:
     /*! \param priority Same meaning as the second parameter of
-     *                  QThreadPool::start(QRunnable*, int priority)
+     *                  QThreadPool::start(QRunnable*, int priority), it is
+     *                  added to BaseRunner::priority()
      */
     Runner<QThreadPool>(const Manager* mgr, int priority = 0)
         : BaseRunner(mgr),
-          m_isAbortRequested(false),
+          m_pool(mgr->threadPool()),
+          m_priority(priority)
+    {
+        this->setAutoDelete(false);
+    }
+
+    /*! \param pool Thread pool where the task is started, typically one of
+     *              Manager::threadPool(poolId)
+     */
+    Runner<QThreadPool>(const Manager* mgr, QThreadPool* pool, int priority = 0)
+        : BaseRunner(mgr),
+          m_pool(pool),
           m_priority(priority)
     {
         this->setAutoDelete(false);
@@ -44,17 +58,11 @@ public:
     void run() override // -- QRunnable
     { this->execRunnableFunc(); }
 
-    bool isAbortRequested() override
-    { return m_isAbortRequested; }
-
-    void requestAbort() override
-    { m_isAbortRequested = true; }
-
     void launch() override
-    { QThreadPool::globalInstance()->start(this, m_priority); }
+    { m_pool->start(this, m_priority + this->priority()); }
 
 private:
-    bool m_isAbortRequested;
+    QThreadPool* m_pool;
     int m_priority;
 };
 
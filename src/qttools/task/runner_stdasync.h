@@ -18,12 +18,22 @@
 #include "base_runner.h"
 
 #include <future>
+#include <system_error>
+#include <thread>
 
 namespace qttask {
 
 struct StdAsync { };
 
-/*! \brief Task runner based on std::async()
+/*! \brief Task runner with the launch policies of std::async()
+ *
+ *  With std::launch::async (the default) the task runs in a new detached
+ *  thread, so launch() returns immediately. std::async() itself is not used
+ *  for that: the destructor of its discarded std::future would block until
+ *  the task is finished.
+ *
+ *  With std::launch::deferred only, the task runs in the thread calling
+ *  BaseRunner::run().
  */
 template<>
 class Runner<StdAsync> : public BaseRunner
@@ -31,22 +41,24 @@ class Runner<StdAsync> : public BaseRunner
 public:
     Runner<StdAsync>(const Manager* mgr, std::launch policy = std::launch::async)
         : BaseRunner(mgr),
-          m_isAbortRequested(false),
           m_policy(policy)
     { }
 
 protected:
-    bool isAbortRequested() override
-    { return m_isAbortRequested; }
-
-    void requestAbort() override
-    { m_isAbortRequested = true; }
-
     void launch() override
-    { std::async(m_policy, [=] { this->execRunnableFunc(); } ); }
+    {
+        if ((m_policy & std::launch::async) == std::launch::async) {
+            try {
+                std::thread([=] { this->execRunnableFunc(); } ).detach();
+                return;
+            } catch (const std::system_error&) {
+                // Thread creation failed, fallback to current thread
+            }
+        }
+        this->execRunnableFunc();
+    }
 
 private:
-    bool m_isAbortRequested;
     std::launch m_policy;
 };
 
@@ -0,0 +1,53 @@
+/****************************************************************************
+**  FougTools
+**  Copyright Fougue (30 Mar. 2015)
+**  contact@fougue.pro
+**
+** This software is a computer program whose purpose is to provide utility
+** tools for the C++ language and the Qt toolkit.
+**
+** This software is governed by the CeCILL-C license under French law and
+** abiding by the rules of distribution of free software.  You can  use,
+** modify and/ or redistribute the software under the terms of the CeCILL-C
+** license as circulated by CEA, CNRS and INRIA at the following URL
+** "http://www.cecill.info".
+****************************************************************************/
+
+
+#pragma once
+
+#include "base_runner.h"
+#include "work_stealing_pool.h"
+
+namespace qttask {
+
+/*! \brief Task runner scheduled on a WorkStealingPool
+ *
+ *  The task function can spawn fine-grained subtasks with a
+ *  WorkStealingPool::TaskGroup on pool(), they are run by the same worker
+ *  threads. Subtasks should poll Progress::isAbortRequested() (or a copy of
+ *  Progress::cancellationToken()) to stop early.
+ */
+template<>
+class Runner<WorkStealingPool> : public BaseRunner
+{
+public:
+    Runner<WorkStealingPool>(
+            const Manager* mgr,
+            WorkStealingPool* pool = WorkStealingPool::globalInstance())
+        : BaseRunner(mgr),
+          m_pool(pool)
+    { }
+
+    WorkStealingPool* pool() const
+    { return m_pool; }
+
+protected:
+    void launch() override
+    { m_pool->submit([=] { this->execRunnableFunc(); } ); }
+
+private:
+    WorkStealingPool* m_pool;
+};
+
+} // namespace qttask
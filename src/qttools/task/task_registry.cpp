@@ -0,0 +1,136 @@
+/****************************************************************************
+**  FougTools
+**  Copyright Fougue (30 Mar. 2015)
+**  contact@fougue.pro
+**
+** This software is a computer program whose purpose is to provide utility
+** tools for the C++ language and the Qt toolkit.
+**
+** This software is governed by the CeCILL-C license under French law and
+** abiding by the rules of distribution of free software.  You can  use,
+** modify and/ or redistribute the software under the terms of the CeCILL-C
+** license as circulated by CEA, CNRS and INRIA at the following URL
+** "http://www.cecill.info".
+****************************************************************************/
+
+
+#include "task_registry.h"
+
+#include <stdexcept>
+
+namespace qttask {
+
+namespace internal {
+
+static quint32 slotIdOf(quint64 taskId)
+{
+    return static_cast<quint32>(taskId & 0xFFFFFFFF);
+}
+
+static quint32 generationOf(quint64 taskId)
+{
+    return static_cast<quint32>(taskId >> 32);
+}
+
+} // namespace internal
+
+TaskRegistry::TaskRegistry()
+    : m_slotCount(0)
+{
+    for (std::atomic<Slot*>& chunk : m_chunks)
+        chunk.store(nullptr, std::memory_order_relaxed);
+}
+
+TaskRegistry::~TaskRegistry()
+{
+    for (std::atomic<Slot*>& chunk : m_chunks)
+        delete[] chunk.load(std::memory_order_relaxed);
+}
+
+/*! Registers \p runner and returns its task id
+ *
+ *  \throws std::length_error if the registry is full
+ */
+quint64 TaskRegistry::insert(BaseRunner* runner)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    quint32 slotId = 0;
+    if (!m_freeSlotIds.empty()) {
+        slotId = m_freeSlotIds.back();
+        m_freeSlotIds.pop_back();
+    }
+    else {
+        if (m_slotCount == ChunkSize * MaxChunkCount)
+            throw std::length_error("qttask::TaskRegistry is full");
+        slotId = m_slotCount;
+        if (slotId % ChunkSize == 0) {
+            Slot* chunk = new Slot[ChunkSize];
+            for (int i = 0; i < ChunkSize; ++i) {
+                chunk[i].runner.store(nullptr, std::memory_order_relaxed);
+                chunk[i].generation.store(0, std::memory_order_relaxed);
+            }
+            m_chunks[slotId / ChunkSize].store(chunk, std::memory_order_release);
+        }
+        ++m_slotCount;
+    }
+
+    Slot& slot = m_chunks[slotId / ChunkSize].load(std::memory_order_relaxed)[slotId % ChunkSize];
+    slot.runner.store(runner, std::memory_order_release);
+    const quint64 generation = slot.generation.load(std::memory_order_relaxed);
+    return (generation << 32) | slotId;
+}
+
+/*! Unregisters the runner identified by \p taskId
+ *
+ *  \returns false if \p taskId was not registered (or already removed)
+ */
+bool TaskRegistry::remove(quint64 taskId)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const quint32 slotId = internal::slotIdOf(taskId);
+    Slot* slot = const_cast<Slot*>(this->findSlot(slotId));
+    if (slot == nullptr
+            || slot->generation.load(std::memory_order_relaxed)
+               != internal::generationOf(taskId))
+    {
+        return false;
+    }
+
+    slot->runner.store(nullptr, std::memory_order_release);
+    slot->generation.store(internal::generationOf(taskId) + 1, std::memory_order_release);
+    m_freeSlotIds.push_back(slotId);
+    return true;
+}
+
+/*! Runner identified by \p taskId, or nullptr if there is none
+ *
+ *  Lock-free, can be called from any thread. The caller must ensure the
+ *  returned runner is not destroyed while in use.
+ */
+BaseRunner* TaskRegistry::find(quint64 taskId) const
+{
+    const Slot* slot = this->findSlot(internal::slotIdOf(taskId));
+    if (slot == nullptr)
+        return nullptr;
+
+    // Generation is read before and after the runner, so a slot reused
+    // concurrently is detected
+    const quint32 generation = internal::generationOf(taskId);
+    if (slot->generation.load(std::memory_order_acquire) != generation)
+        return nullptr;
+    BaseRunner* runner = slot->runner.load(std::memory_order_acquire);
+    if (slot->generation.load(std::memory_order_acquire) != generation)
+        return nullptr;
+    return runner;
+}
+
+const TaskRegistry::Slot* TaskRegistry::findSlot(quint32 slotId) const
+{
+    const quint32 chunkId = slotId / ChunkSize;
+    if (chunkId >= MaxChunkCount)
+        return nullptr;
+    const Slot* chunk = m_chunks[chunkId].load(std::memory_order_acquire);
+    return chunk != nullptr ? &chunk[slotId % ChunkSize] : nullptr;
+}
+
+} // namespace qttask
@@ -0,0 +1,74 @@
+/****************************************************************************
+**  FougTools
+**  Copyright Fougue (30 Mar. 2015)
+**  contact@fougue.pro
+**
+** This software is a computer program whose purpose is to provide utility
+** tools for the C++ language and the Qt toolkit.
+**
+** This software is governed by the CeCILL-C license under French law and
+** abiding by the rules of distribution of free software.  You can  use,
+** modify and/ or redistribute the software under the terms of the CeCILL-C
+** license as circulated by CEA, CNRS and INRIA at the following URL
+** "http://www.cecill.info".
+****************************************************************************/
+
+
+#pragma once
+
+#include <QtCore/QtGlobal>
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+namespace qttask {
+
+class BaseRunner;
+
+/*! \brief Registry of runners, indexed by generation-tagged task ids
+ *
+ *  A task id packs the index of a slot (low 32 bits) and the generation of
+ *  this slot (high 32 bits). Generation is incremented when a slot is freed,
+ *  so ids of removed tasks are never confused with the ids of tasks reusing
+ *  the slot.
+ *
+ *  find() can be called from any thread and takes no lock. Slots are stored in
+ *  chunks that are never moved nor freed before the registry is destroyed.
+ *  insert() and remove() serialize on a mutex for the free-slot list.
+ */
+class TaskRegistry
+{
+public:
+    TaskRegistry();
+    ~TaskRegistry();
+
+    quint64 insert(BaseRunner* runner);
+    bool remove(quint64 taskId);
+    BaseRunner* find(quint64 taskId) const;
+
+private:
+    TaskRegistry(const TaskRegistry&);
+    TaskRegistry& operator=(const TaskRegistry&);
+
+    struct Slot
+    {
+        std::atomic<BaseRunner*> runner;
+        std::atomic<quint32> generation;
+    };
+
+    enum
+    {
+        ChunkSize = 1024,
+        MaxChunkCount = 4096 // Up to 4M tasks running at the same time
+    };
+
+    const Slot* findSlot(quint32 slotId) const;
+
+    std::atomic<Slot*> m_chunks[MaxChunkCount];
+    std::mutex m_mutex;
+    std::vector<quint32> m_freeSlotIds;
+    quint32 m_slotCount;
+};
+
+} // namespace qttask
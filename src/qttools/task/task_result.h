@@ -0,0 +1,560 @@
+/****************************************************************************
+**  FougTools
+**  Copyright Fougue (30 Mar. 2015)
+**  contact@fougue.pro
+**
+** This software is a computer program whose purpose is to provide utility
+** tools for the C++ language and the Qt toolkit.
+**
+** This software is governed by the CeCILL-C license under French law and
+** abiding by the rules of distribution of free software.  You can  use,
+** modify and/ or redistribute the software under the terms of the CeCILL-C
+** license as circulated by CEA, CNRS and INRIA at the following URL
+** "http://www.cecill.info".
+****************************************************************************/
+
+#pragma once
+
+#include "base_runner.h"
+
+#include <QtCore/QObject>
+#include <QtCore/QPointer>
+#include <QtCore/QTimer>
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace qttask {
+
+namespace internal {
+template<typename T> class TaskResultState;
+template<typename T> class TaskChannelState;
+} // namespace internal
+
+/*! \brief Typed result of a task, see runWithResult()
+ *
+ *  The value returned by the task function is moved in and then moved out by
+ *  take(), it is never wrapped in a QVariant nor copied by queued signals.
+ *
+ *  TaskResult is a cheap handle on a shared state : copies refer to the same
+ *  result. It is safe to use from any thread.
+ *
+ *  \headerfile task_result.h <qttools/task/task_result.h>
+ *  \ingroup qttools_task
+ */
+template<typename T>
+class TaskResult
+{
+public:
+    TaskResult();
+
+    bool isValid() const;
+    bool isReady() const;
+    bool hasException() const;
+
+    void wait() const;
+    bool waitFor(int msec) const;
+
+    T take();
+
+    template<typename FUNC>
+    void onReady(QObject* context, FUNC fn) const;
+
+private:
+    template<typename FUNC>
+    friend auto runWithResult(BaseRunner* runner, FUNC fn)
+        -> TaskResult<decltype(fn())>;
+
+    std::shared_ptr<internal::TaskResultState<T>> m_state;
+};
+
+/*! \brief Stream of partial results produced by a task, see runWithChannel()
+ *
+ *  The task pushes items while it runs, the consumer pops them as they
+ *  arrive. Items are moved through the channel, never copied.
+ *
+ *  Consumer notifications posted by onDataAvailable() are coalesced : a task
+ *  pushing thousands of items triggers as many notifications as the consumer
+ *  thread can handle, not one queued call per item.
+ *
+ *  TaskChannel is a cheap handle on a shared state : copies refer to the same
+ *  channel. It is safe to use from any thread.
+ *
+ *  \headerfile task_result.h <qttools/task/task_result.h>
+ *  \ingroup qttools_task
+ */
+template<typename T>
+class TaskChannel
+{
+public:
+    TaskChannel();
+
+    bool isValid() const;
+
+    // -- Producer
+    void push(T&& item);
+    void push(const T& item);
+    void close();
+
+    // -- Consumer
+    bool tryPop(T* item);
+    std::vector<T> takeAll();
+    bool waitForData(int msec) const;
+
+    bool isClosed() const;
+    bool isFinished() const;
+    bool hasException() const;
+    void rethrowException() const;
+
+    template<typename FUNC>
+    void onDataAvailable(QObject* context, FUNC fn) const;
+
+private:
+    template<typename U, typename FUNC>
+    friend TaskChannel<U> runWithChannel(BaseRunner* runner, FUNC fn);
+
+    std::shared_ptr<internal::TaskChannelState<T>> m_state;
+};
+
+template<typename FUNC>
+auto runWithResult(BaseRunner* runner, FUNC fn) -> TaskResult<decltype(fn())>;
+
+template<typename T, typename FUNC>
+TaskChannel<T> runWithChannel(BaseRunner* runner, FUNC fn);
+
+
+
+// --
+// -- Implementation
+// --
+
+namespace internal {
+
+//! Posts \p fn to the event loop of \p context, nothing if \p context is gone
+inline void postToContext(const QPointer<QObject>& context, std::function<void()> fn)
+{
+    if (!context.isNull())
+        QTimer::singleShot(0, context.data(), fn);
+}
+
+template<typename T>
+class TaskResultState
+{
+public:
+    TaskResultState()
+        : m_isReady(false),
+          m_hasValue(false)
+    { }
+
+    ~TaskResultState()
+    {
+        if (m_hasValue)
+            this->valuePtr()->~T();
+    }
+
+    void setValue(T&& value)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        new (&m_storage) T(std::move(value));
+        m_hasValue = true;
+        this->setReady(lock);
+    }
+
+    void setException(std::exception_ptr error)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_error = error;
+        this->setReady(lock);
+    }
+
+    T* valuePtr()
+    { return reinterpret_cast<T*>(&m_storage); }
+
+    void setReady(std::unique_lock<std::mutex>& lock)
+    {
+        m_isReady = true;
+        std::vector<std::function<void()>> continuations = std::move(m_continuations);
+        lock.unlock();
+        m_readyCondition.notify_all();
+        for (const std::function<void()>& fn : continuations)
+            fn();
+    }
+
+    mutable std::mutex m_mutex;
+    mutable std::condition_variable m_readyCondition;
+    typename std::aligned_storage<sizeof(T), std::alignment_of<T>::value>::type m_storage;
+    bool m_isReady;
+    bool m_hasValue;
+    std::exception_ptr m_error;
+    std::vector<std::function<void()>> m_continuations;
+};
+
+template<typename T>
+class TaskChannelState
+{
+public:
+    TaskChannelState()
+        : m_isClosed(false),
+          m_isNotifyPending(false)
+    { }
+
+    void push(T&& item)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_items.push_back(std::move(item));
+        this->notify(lock);
+    }
+
+    void close(std::exception_ptr error = std::exception_ptr())
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        if (m_isClosed)
+            return;
+        m_isClosed = true;
+        m_error = error;
+        this->notify(lock);
+    }
+
+    //! Must be called with \p lock owning m_mutex, unlocks it
+    void notify(std::unique_lock<std::mutex>& lock)
+    {
+        const bool mustPost = m_notifyFunc && !m_isNotifyPending;
+        if (mustPost)
+            m_isNotifyPending = true;
+        std::function<void()> notifyFunc;
+        if (mustPost)
+            notifyFunc = m_notifyFunc;
+        lock.unlock();
+        m_dataCondition.notify_all();
+        if (notifyFunc)
+            notifyFunc();
+    }
+
+    mutable std::mutex m_mutex;
+    mutable std::condition_variable m_dataCondition;
+    std::deque<T> m_items;
+    bool m_isClosed;
+    bool m_isNotifyPending;
+    std::exception_ptr m_error;
+    std::function<void()> m_notifyFunc;
+};
+
+} // namespace internal
+
+//! Constructs an invalid result, not bound to any task
+template<typename T>
+TaskResult<T>::TaskResult()
+{ }
+
+template<typename T>
+bool TaskResult<T>::isValid() const
+{
+    return m_state != nullptr;
+}
+
+//! Returns true if the task function is finished (returned or threw)
+template<typename T>
+bool TaskResult<T>::isReady() const
+{
+    std::lock_guard<std::mutex> lock(m_state->m_mutex);
+    return m_state->m_isReady;
+}
+
+//! Returns true if the task function threw, take() then rethrows it
+template<typename T>
+bool TaskResult<T>::hasException() const
+{
+    std::lock_guard<std::mutex> lock(m_state->m_mutex);
+    return m_state->m_error != nullptr;
+}
+
+//! Blocks the calling thread until the task function is finished
+template<typename T>
+void TaskResult<T>::wait() const
+{
+    std::unique_lock<std::mutex> lock(m_state->m_mutex);
+    m_state->m_readyCondition.wait(lock, [=] { return m_state->m_isReady; } );
+}
+
+//! Same as wait() but gives up after \p msec milliseconds, returns isReady()
+template<typename T>
+bool TaskResult<T>::waitFor(int msec) const
+{
+    std::unique_lock<std::mutex> lock(m_state->m_mutex);
+    return m_state->m_readyCondition.wait_for(
+                lock,
+                std::chrono::milliseconds(msec),
+                [=] { return m_state->m_isReady; } );
+}
+
+/*! \brief Moves the value returned by the task function out of this result
+ *
+ *  Waits for the task to finish. If the task function threw, the exception
+ *  is rethrown here.
+ *
+ *  The value can be taken only once, it is shared by all copies of this
+ *  TaskResult.
+ */
+template<typename T>
+T TaskResult<T>::take()
+{
+    std::unique_lock<std::mutex> lock(m_state->m_mutex);
+    m_state->m_readyCondition.wait(lock, [=] { return m_state->m_isReady; } );
+    if (m_state->m_error != nullptr)
+        std::rethrow_exception(m_state->m_error);
+    Q_ASSERT(m_state->m_hasValue);
+    T* ptrValue = m_state->valuePtr();
+    T value(std::move(*ptrValue));
+    ptrValue->~T();
+    m_state->m_hasValue = false;
+    return value;
+}
+
+/*! \brief Calls \p fn(TaskResult<T>) in the thread of \p context once the
+ *         task function is finished
+ *
+ *  If the result is already ready, the call is posted right away. Nothing is
+ *  called if \p context is destroyed in the meantime.
+ */
+template<typename T>
+template<typename FUNC>
+void TaskResult<T>::onReady(QObject* context, FUNC fn) const
+{
+    const TaskResult<T> result = *this;
+    const QPointer<QObject> contextPtr(context);
+    const std::function<void()> postFunc = [=] {
+        internal::postToContext(contextPtr, [=] { fn(result); } );
+    };
+    std::unique_lock<std::mutex> lock(m_state->m_mutex);
+    if (!m_state->m_isReady) {
+        m_state->m_continuations.push_back(postFunc);
+    }
+    else {
+        lock.unlock();
+        postFunc();
+    }
+}
+
+//! Constructs an invalid channel, not bound to any task
+template<typename T>
+TaskChannel<T>::TaskChannel()
+{ }
+
+template<typename T>
+bool TaskChannel<T>::isValid() const
+{
+    return m_state != nullptr;
+}
+
+template<typename T>
+void TaskChannel<T>::push(T&& item)
+{
+    m_state->push(std::move(item));
+}
+
+template<typename T>
+void TaskChannel<T>::push(const T& item)
+{
+    T copy(item);
+    m_state->push(std::move(copy));
+}
+
+/*! \brief Marks the end of the stream
+ *
+ *  Called automatically by runWithChannel() when the task function is
+ *  finished. Items pushed after close() are still delivered.
+ */
+template<typename T>
+void TaskChannel<T>::close()
+{
+    m_state->close();
+}
+
+//! Moves the oldest pending item into \p item, returns false if none
+template<typename T>
+bool TaskChannel<T>::tryPop(T* item)
+{
+    std::lock_guard<std::mutex> lock(m_state->m_mutex);
+    if (m_state->m_items.empty())
+        return false;
+    *item = std::move(m_state->m_items.front());
+    m_state->m_items.pop_front();
+    return true;
+}
+
+//! Moves all the pending items out of the channel, in push order
+template<typename T>
+std::vector<T> TaskChannel<T>::takeAll()
+{
+    std::deque<T> items;
+    {
+        std::lock_guard<std::mutex> lock(m_state->m_mutex);
+        items.swap(m_state->m_items);
+    }
+    std::vector<T> vecItem;
+    vecItem.reserve(items.size());
+    for (T& item : items)
+        vecItem.push_back(std::move(item));
+    return vecItem;
+}
+
+/*! \brief Blocks until an item is pending or the channel is closed, at most
+ *         \p msec milliseconds
+ *
+ *  Returns true if an item is pending
+ */
+template<typename T>
+bool TaskChannel<T>::waitForData(int msec) const
+{
+    std::unique_lock<std::mutex> lock(m_state->m_mutex);
+    m_state->m_dataCondition.wait_for(
+                lock,
+                std::chrono::milliseconds(msec),
+                [=] { return !m_state->m_items.empty() || m_state->m_isClosed; } );
+    return !m_state->m_items.empty();
+}
+
+template<typename T>
+bool TaskChannel<T>::isClosed() const
+{
+    std::lock_guard<std::mutex> lock(m_state->m_mutex);
+    return m_state->m_isClosed;
+}
+
+//! Returns true if the channel is closed and all its items were popped
+template<typename T>
+bool TaskChannel<T>::isFinished() const
+{
+    std::lock_guard<std::mutex> lock(m_state->m_mutex);
+    return m_state->m_isClosed && m_state->m_items.empty();
+}
+
+//! Returns true if the task function threw, the channel is then closed
+template<typename T>
+bool TaskChannel<T>::hasException() const
+{
+    std::lock_guard<std::mutex> lock(m_state->m_mutex);
+    return m_state->m_error != nullptr;
+}
+
+//! Rethrows the exception of the task function, if any
+template<typename T>
+void TaskChannel<T>::rethrowException() const
+{
+    std::exception_ptr error;
+    {
+        std::lock_guard<std::mutex> lock(m_state->m_mutex);
+        error = m_state->m_error;
+    }
+    if (error != nullptr)
+        std::rethrow_exception(error);
+}
+
+/*! \brief Calls \p fn(TaskChannel<T>) in the thread of \p context when items
+ *         are pushed or when the channel is closed
+ *
+ *  Calls are coalesced : at most one is pending at any time, so \p fn should
+ *  consume all items with takeAll() or a tryPop() loop.
+ *
+ *  If items are already pending or the channel is already closed, a call is
+ *  posted right away.
+ */
+template<typename T>
+template<typename FUNC>
+void TaskChannel<T>::onDataAvailable(QObject* context, FUNC fn) const
+{
+    const std::weak_ptr<internal::TaskChannelState<T>> weakState = m_state;
+    const QPointer<QObject> contextPtr(context);
+    std::unique_lock<std::mutex> lock(m_state->m_mutex);
+    // Captures a weak pointer, the state owns this function
+    m_state->m_notifyFunc = [=] {
+        internal::postToContext(contextPtr, [=] {
+            const auto state = weakState.lock();
+            if (!state)
+                return;
+            {
+                std::lock_guard<std::mutex> stateLock(state->m_mutex);
+                state->m_isNotifyPending = false;
+            }
+            TaskChannel<T> channel;
+            channel.m_state = state;
+            fn(channel);
+        } );
+    };
+    if (!m_state->m_items.empty() || m_state->m_isClosed) {
+        m_state->m_isNotifyPending = false;
+        m_state->notify(lock);
+    }
+}
+
+/*! \brief Runs \p fn with \p runner and returns the typed value it will
+ *         return
+ *
+ *  \code
+ *      auto task = qttask::Manager::globalInstance()->newTask();
+ *      qttask::TaskResult<Mesh> result =
+ *              qttask::runWithResult(task, [=] { return computeMesh(shape); } );
+ *      result.onReady(this, [=](qttask::TaskResult<Mesh> res) {
+ *          this->setMesh(res.take());
+ *      } );
+ *  \endcode
+ *
+ *  An exception thrown by \p fn is captured and rethrown by
+ *  TaskResult::take(). \p runner must not be used after this call, it is
+ *  deleted at the end of the task like with BaseRunner::run()
+ */
+template<typename FUNC>
+auto runWithResult(BaseRunner* runner, FUNC fn) -> TaskResult<decltype(fn())>
+{
+    typedef decltype(fn()) ResultType;
+    static_assert(!std::is_void<ResultType>::value,
+                  "Use BaseRunner::run() for functions returning void");
+    TaskResult<ResultType> result;
+    result.m_state = std::make_shared<internal::TaskResultState<ResultType>>();
+    const auto state = result.m_state;
+    runner->run( [=] {
+        try {
+            state->setValue(fn());
+        } catch (...) {
+            state->setException(std::current_exception());
+        }
+    } );
+    return result;
+}
+
+/*! \brief Runs \p fn(TaskChannel<T>&) with \p runner and returns the channel
+ *         of the items it pushes
+ *
+ *  The channel is closed when \p fn returns. An exception thrown by \p fn
+ *  also closes the channel, see TaskChannel::rethrowException()
+ *
+ *  \p runner must not be used after this call, it is deleted at the end of
+ *  the task like with BaseRunner::run()
+ */
+template<typename T, typename FUNC>
+TaskChannel<T> runWithChannel(BaseRunner* runner, FUNC fn)
+{
+    TaskChannel<T> channel;
+    channel.m_state = std::make_shared<internal::TaskChannelState<T>>();
+    runner->run( [=] {
+        TaskChannel<T> producer = channel;
+        try {
+            fn(producer);
+            producer.m_state->close();
+        } catch (...) {
+            producer.m_state->close(std::current_exception());
+        }
+    } );
+    return channel;
+}
+
+} // namespace qttask
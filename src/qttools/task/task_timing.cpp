@@ -0,0 +1,106 @@
+/****************************************************************************
+**  FougTools
+**  Copyright Fougue (30 Mar. 2015)
+**  contact@fougue.pro
+**
+** This software is a computer program whose purpose is to provide utility
+** tools for the C++ language and the Qt toolkit.
+**
+** This software is governed by the CeCILL-C license under French law and
+** abiding by the rules of distribution of free software.  You can  use,
+** modify and/ or redistribute the software under the terms of the CeCILL-C
+** license as circulated by CEA, CNRS and INRIA at the following URL
+** "http://www.cecill.info".
+****************************************************************************/
+
+
+#include "task_timing.h"
+
+#include <algorithm>
+
+namespace qttask {
+
+TaskDurationHistogram::TaskDurationHistogram()
+    : m_count(0),
+      m_total(0),
+      m_min(0),
+      m_max(0)
+{
+    std::fill(m_buckets, m_buckets + BucketCount, 0);
+}
+
+void TaskDurationHistogram::add(Duration duration)
+{
+    if (duration.count() < 0)
+        duration = Duration(0);
+
+    int bucketId = 0;
+    for (quint64 us = duration.count(); us != 0 && bucketId < BucketCount - 1; us >>= 1)
+        ++bucketId;
+    ++m_buckets[bucketId];
+
+    m_min = m_count == 0 ? duration : std::min(m_min, duration);
+    m_max = std::max(m_max, duration);
+    m_total += duration;
+    ++m_count;
+}
+
+quint64 TaskDurationHistogram::count() const
+{
+    return m_count;
+}
+
+TaskDurationHistogram::Duration TaskDurationHistogram::total() const
+{
+    return m_total;
+}
+
+TaskDurationHistogram::Duration TaskDurationHistogram::mean() const
+{
+    if (m_count == 0)
+        return Duration(0);
+    return Duration(m_total.count() / static_cast<Duration::rep>(m_count));
+}
+
+TaskDurationHistogram::Duration TaskDurationHistogram::min() const
+{
+    return m_min;
+}
+
+TaskDurationHistogram::Duration TaskDurationHistogram::max() const
+{
+    return m_max;
+}
+
+/*! \brief Approximation of the \p p-th percentile (\p p in [0, 100])
+ *
+ *  Returns the upper bound of the bucket containing the percentile, clamped to
+ *  max()
+ */
+TaskDurationHistogram::Duration TaskDurationHistogram::percentile(double p) const
+{
+    if (m_count == 0)
+        return Duration(0);
+
+    const double rank = std::max(1., (std::min(p, 100.) / 100.) * m_count);
+    quint64 cumulCount = 0;
+    for (int bucketId = 0; bucketId < BucketCount; ++bucketId) {
+        cumulCount += m_buckets[bucketId];
+        if (cumulCount >= rank)
+            return std::min(bucketUpperBound(bucketId), m_max);
+    }
+    return m_max;
+}
+
+quint64 TaskDurationHistogram::bucketCount(int bucketId) const
+{
+    return bucketId >= 0 && bucketId < BucketCount ? m_buckets[bucketId] : 0;
+}
+
+//! Exclusive upper bound of the durations counted in \p bucketId
+TaskDurationHistogram::Duration TaskDurationHistogram::bucketUpperBound(int bucketId)
+{
+    return Duration(static_cast<Duration::rep>(1) << bucketId);
+}
+
+} // namespace qttask
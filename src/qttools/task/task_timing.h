@@ -0,0 +1,80 @@
+/****************************************************************************
+**  FougTools
+**  Copyright Fougue (30 Mar. 2015)
+**  contact@fougue.pro
+**
+** This software is a computer program whose purpose is to provide utility
+** tools for the C++ language and the Qt toolkit.
+**
+** This software is governed by the CeCILL-C license under French law and
+** abiding by the rules of distribution of free software.  You can  use,
+** modify and/ or redistribute the software under the terms of the CeCILL-C
+** license as circulated by CEA, CNRS and INRIA at the following URL
+** "http://www.cecill.info".
+****************************************************************************/
+
+
+#pragma once
+
+#include <QtCore/QtGlobal>
+
+#include <chrono>
+#include <thread>
+
+namespace qttask {
+
+//! Time points in the life of a task, see BaseRunner::timestamps()
+struct TaskTimestamps
+{
+    typedef std::chrono::steady_clock Clock;
+
+    Clock::time_point queued;     //!< Creation by Manager::newTask()
+    Clock::time_point aboutToRun; //!< Call to BaseRunner::run()
+    Clock::time_point started;    //!< Start of execution of the task function
+    Clock::time_point ended;      //!< End of execution of the task function
+    std::thread::id threadId;     //!< Thread executing the task function
+};
+
+/*! \brief Histogram of durations with power-of-two buckets
+ *
+ *  Bucket 0 counts durations below 1us, bucket i (i > 0) counts durations in
+ *  [2^(i-1), 2^i) microseconds. The last bucket also counts longer durations.
+ */
+class TaskDurationHistogram
+{
+public:
+    typedef std::chrono::microseconds Duration;
+    enum { BucketCount = 36 }; // Last bucket starts at ~9.5 hours
+
+    TaskDurationHistogram();
+
+    void add(Duration duration);
+
+    quint64 count() const;
+    Duration total() const;
+    Duration mean() const;
+    Duration min() const;
+    Duration max() const;
+    Duration percentile(double p) const;
+
+    quint64 bucketCount(int bucketId) const;
+    static Duration bucketUpperBound(int bucketId);
+
+private:
+    quint64 m_buckets[BucketCount];
+    quint64 m_count;
+    Duration m_total;
+    Duration m_min;
+    Duration m_max;
+};
+
+//! Aggregated timings of the tasks sharing the same title
+struct TaskTimingStats
+{
+    //! Duration between BaseRunner::run() and the start of execution
+    TaskDurationHistogram queueLatency;
+    //! Duration of execution of the task function
+    TaskDurationHistogram runDuration;
+};
+
+} // namespace qttask
@@ -0,0 +1,229 @@
+/****************************************************************************
+**  FougTools
+**  Copyright Fougue (30 Mar. 2015)
+**  contact@fougue.pro
+**
+** This software is a computer program whose purpose is to provide utility
+** tools for the C++ language and the Qt toolkit.
+**
+** This software is governed by the CeCILL-C license under French law and
+** abiding by the rules of distribution of free software.  You can  use,
+** modify and/ or redistribute the software under the terms of the CeCILL-C
+** license as circulated by CEA, CNRS and INRIA at the following URL
+** "http://www.cecill.info".
+****************************************************************************/
+
+
+#include "work_stealing_pool.h"
+
+#include <QtCore/QGlobalStatic>
+
+namespace qttask {
+
+/*! \param threadCount  Count of worker threads (0 means as many as the
+ *                      hardware supports)
+ */
+WorkStealingPool::WorkStealingPool(unsigned threadCount)
+    : m_pendingJobCount(0),
+      m_isStarted(false),
+      m_isStopRequested(false)
+{
+    if (threadCount == 0)
+        threadCount = std::thread::hardware_concurrency();
+    if (threadCount == 0)
+        threadCount = 1;
+
+    for (unsigned i = 0; i <= threadCount; ++i)
+        m_queues.emplace_back(new JobQueue);
+    for (unsigned i = 0; i < threadCount; ++i) {
+        m_threads.emplace_back(&WorkStealingPool::workerLoop, this, i);
+        m_threadIds.push_back(m_threads.back().get_id());
+    }
+
+    // Workers wait for m_threadIds to be complete
+    {
+        std::lock_guard<std::mutex> lock(m_sleepMutex);
+        m_isStarted = true;
+    }
+    m_sleepCondition.notify_all();
+}
+
+//! Runs all pending jobs, then joins the worker threads
+WorkStealingPool::~WorkStealingPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_sleepMutex);
+        m_isStopRequested = true;
+    }
+    m_sleepCondition.notify_all();
+    for (std::thread& thread : m_threads)
+        thread.join();
+}
+
+unsigned WorkStealingPool::threadCount() const
+{
+    return static_cast<unsigned>(m_threads.size());
+}
+
+//! Schedules \p job to be run by some worker thread
+void WorkStealingPool::submit(Job job)
+{
+    const int workerId = this->currentWorkerId();
+    JobQueue* queue = workerId >= 0 ? m_queues.at(workerId).get() : m_queues.back().get();
+    {
+        std::lock_guard<std::mutex> lock(queue->mutex);
+        queue->jobs.push_back(std::move(job));
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_sleepMutex);
+        ++m_pendingJobCount;
+    }
+    m_sleepCondition.notify_one();
+}
+
+/*! Runs one pending job in the calling thread, if any
+ *
+ *  \returns true if a job was run
+ */
+bool WorkStealingPool::tryRunPendingJob()
+{
+    Job job;
+    if (this->tryPopJob(this->currentWorkerId(), &job)) {
+        job();
+        return true;
+    }
+    return false;
+}
+
+Q_GLOBAL_STATIC(WorkStealingPool, poolGlobalInstance)
+
+WorkStealingPool* WorkStealingPool::globalInstance()
+{
+    return poolGlobalInstance();
+}
+
+void WorkStealingPool::workerLoop(unsigned workerId)
+{
+    {
+        std::unique_lock<std::mutex> lock(m_sleepMutex);
+        m_sleepCondition.wait(lock, [=] { return m_isStarted; });
+    }
+
+    Job job;
+    for (;;) {
+        if (this->tryPopJob(static_cast<int>(workerId), &job)) {
+            job();
+            job = nullptr;
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(m_sleepMutex);
+        if (m_pendingJobCount.load() == 0 && m_isStopRequested)
+            return;
+        m_sleepCondition.wait(lock, [=] {
+            return m_pendingJobCount.load() > 0 || m_isStopRequested;
+        } );
+    }
+}
+
+//! Index of the calling worker thread, -1 if the caller is not a worker
+int WorkStealingPool::currentWorkerId() const
+{
+    const std::thread::id threadId = std::this_thread::get_id();
+    for (std::size_t i = 0; i < m_threadIds.size(); ++i) {
+        if (m_threadIds[i] == threadId)
+            return static_cast<int>(i);
+    }
+    return -1;
+}
+
+/*! Takes a job for worker \p workerId (-1 for a non-worker thread) : newest
+ *  job of its own queue, or oldest job of the injection queue, or oldest job
+ *  stolen from another worker
+ */
+bool WorkStealingPool::tryPopJob(int workerId, Job* job)
+{
+    if (workerId >= 0) {
+        JobQueue* ownQueue = m_queues.at(workerId).get();
+        std::lock_guard<std::mutex> lock(ownQueue->mutex);
+        if (!ownQueue->jobs.empty()) {
+            *job = std::move(ownQueue->jobs.back());
+            ownQueue->jobs.pop_back();
+            --m_pendingJobCount;
+            return true;
+        }
+    }
+
+    // Injection queue first, then victims are visited from the next worker
+    const std::size_t workerCount = m_threads.size();
+    for (std::size_t i = 0; i <= workerCount; ++i) {
+        const std::size_t queueId =
+                i == 0 ? workerCount : (workerId + i) % workerCount;
+        if (static_cast<int>(queueId) == workerId)
+            continue;
+        JobQueue* queue = m_queues.at(queueId).get();
+        std::lock_guard<std::mutex> lock(queue->mutex);
+        if (!queue->jobs.empty()) {
+            *job = std::move(queue->jobs.front());
+            queue->jobs.pop_front();
+            --m_pendingJobCount;
+            return true;
+        }
+    }
+    return false;
+}
+
+
+// -- TaskGroup
+
+WorkStealingPool::TaskGroup::TaskGroup(WorkStealingPool* pool)
+    : m_pool(pool),
+      m_pendingJobCount(0)
+{
+}
+
+//! Waits for the jobs still pending, their exceptions are lost
+WorkStealingPool::TaskGroup::~TaskGroup()
+{
+    while (m_pendingJobCount.load() > 0) {
+        if (!m_pool->tryRunPendingJob())
+            std::this_thread::yield();
+    }
+}
+
+//! Submits \p job to the pool of the group
+void WorkStealingPool::TaskGroup::run(Job job)
+{
+    ++m_pendingJobCount;
+    m_pool->submit([=] {
+        try {
+            job();
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(m_errorMutex);
+            if (!m_error)
+                m_error = std::current_exception();
+        }
+        --m_pendingJobCount;
+    } );
+}
+
+/*! Returns when all jobs of the group are finished, the calling thread runs
+ *  pending jobs of the pool in the meantime
+ */
+void WorkStealingPool::TaskGroup::wait()
+{
+    while (m_pendingJobCount.load() > 0) {
+        if (!m_pool->tryRunPendingJob())
+            std::this_thread::yield();
+    }
+
+    std::exception_ptr error;
+    {
+        std::lock_guard<std::mutex> lock(m_errorMutex);
+        std::swap(error, m_error);
+    }
+    if (error)
+        std::rethrow_exception(error);
+}
+
+} // namespace qttask
@@ -0,0 +1,112 @@
+/****************************************************************************
+**  FougTools
+**  Copyright Fougue (30 Mar. 2015)
+**  contact@fougue.pro
+**
+** This software is a computer program whose purpose is to provide utility
+** tools for the C++ language and the Qt toolkit.
+**
+** This software is governed by the CeCILL-C license under French law and
+** abiding by the rules of distribution of free software.  You can  use,
+** modify and/ or redistribute the software under the terms of the CeCILL-C
+** license as circulated by CEA, CNRS and INRIA at the following URL
+** "http://www.cecill.info".
+****************************************************************************/
+
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace qttask {
+
+/*! \brief Pool of worker threads scheduling jobs by work stealing
+ *
+ *  Each worker thread owns a deque of jobs. A job submitted from a worker
+ *  thread (nested job) is pushed to the deque of this worker, which then
+ *  runs its own jobs in LIFO order (cache-friendly). Jobs submitted from any
+ *  other thread go to a shared injection queue. An idle worker takes jobs from
+ *  the injection queue, then steals the oldest job of another worker.
+ *
+ *  Jobs must not throw, use TaskGroup to propagate exceptions of fine-grained
+ *  subtasks.
+ */
+class WorkStealingPool
+{
+public:
+    typedef std::function<void()> Job;
+    class TaskGroup;
+
+    explicit WorkStealingPool(unsigned threadCount = 0);
+    ~WorkStealingPool();
+
+    unsigned threadCount() const;
+
+    void submit(Job job);
+    bool tryRunPendingJob();
+
+    static WorkStealingPool* globalInstance();
+
+private:
+    WorkStealingPool(const WorkStealingPool&);
+    WorkStealingPool& operator=(const WorkStealingPool&);
+
+    struct JobQueue
+    {
+        std::mutex mutex;
+        std::deque<Job> jobs;
+    };
+
+    void workerLoop(unsigned workerId);
+    int currentWorkerId() const;
+    bool tryPopJob(int workerId, Job* job);
+
+    // One queue per worker, then the injection queue
+    std::vector<std::unique_ptr<JobQueue>> m_queues;
+    std::vector<std::thread> m_threads;
+    std::vector<std::thread::id> m_threadIds;
+    std::atomic<int> m_pendingJobCount;
+
+    std::mutex m_sleepMutex;
+    std::condition_variable m_sleepCondition;
+    bool m_isStarted;
+    bool m_isStopRequested;
+};
+
+/*! \brief Group of jobs submitted to a WorkStealingPool, that can be waited
+ *         for
+ *
+ *  wait() runs pending jobs of the pool while the jobs of the group are not
+ *  finished, so a job can spawn and wait for subtasks without blocking a
+ *  worker thread.
+ *
+ *  If a job of the group throws, the first exception is rethrown by wait().
+ */
+class WorkStealingPool::TaskGroup
+{
+public:
+    explicit TaskGroup(WorkStealingPool* pool = WorkStealingPool::globalInstance());
+    ~TaskGroup();
+
+    void run(Job job);
+    void wait();
+
+private:
+    TaskGroup(const TaskGroup&);
+    TaskGroup& operator=(const TaskGroup&);
+
+    WorkStealingPool* m_pool;
+    std::atomic<int> m_pendingJobCount;
+    std::mutex m_errorMutex;
+    std::exception_ptr m_error;
+};
+
+} // namespace qttask
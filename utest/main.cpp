@@ -1,4 +1,5 @@
 #include "test_cpptools.h"
+#include "test_mathtools.h"
 #include "test_qttools.h"
 
 #ifdef FOUGTOOLS_HAVE_OCCTOOLS
@@ -19,6 +20,7 @@ int main(int argc, char** argv)
     // Run tests
     std::vector<QObject*> testObjects;
     testObjects.push_back(new TestCppTools);
+    testObjects.push_back(new TestMathTools);
     testObjects.push_back(new TestQtTools);
 #ifdef FOUGTOOLS_HAVE_OCCTOOLS
     testObjects.push_back(new TestOccTools);
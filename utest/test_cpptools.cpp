@@ -1,20 +1,48 @@
 #include "test_cpptools.h"
 
+#include "../src/cpptools/basic_intrusive_pointer.h"
 #include "../src/cpptools/basic_shared_pointer.h"
 #include "../src/cpptools/c_array_utils.h"
 #include "../src/cpptools/circular_iterator.h"
 #include "../src/cpptools/enum_string_map.h"
+#include "../src/cpptools/fixed_array.h"
 #include "../src/cpptools/hash_fnv.h"
+#include "../src/cpptools/hash_wy.h"
+#include "../src/cpptools/memory_arena.h"
 #include "../src/cpptools/memory_utils.h"
+#include "../src/cpptools/mpmc_queue.h"
+#include "../src/cpptools/profiling.h"
 #include "../src/cpptools/pusher.h"
 #include "../src/cpptools/quantity.h"
+#include "../src/cpptools/quantity_array.h"
+#include "../src/cpptools/ring_buffer.h"
 #include "../src/cpptools/scoped_value.h"
+#include "../src/cpptools/small_vector.h"
+#include "../src/cpptools/static_enum_string_map.h"
+#include "../src/cpptools/tree_bfs_explorer.h"
+#include "../src/cpptools/tree_dfs_explorer.h"
+#include "../src/cpptools/tree_parallel_bfs.h"
 #include "../src/cpptools/tuple_utils.h"
 
 #include <QtCore/QScopedPointer>
 #include <QtCore/QtDebug>
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstring>
+#include <functional>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
 #include <queue>
+#include <set>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
 
 // --
 // -- Functor<> tests
@@ -94,6 +122,295 @@ void TestCppTools::BasicSharedPointer_test()
         QCOMPARE(sharedPtr1.data(), delHook);
     }
     QCOMPARE(spyHint, -1);
+
+    // Co-allocated object and move operations
+    spyHint = 0;
+    {
+        cpp::BasicSharedPointer<DeleteHook> sharedPtr =
+                cpp::makeBasicShared<DeleteHook>(-2, &spyHint);
+        QVERIFY(!sharedPtr.isNull());
+
+        cpp::BasicSharedPointer<DeleteHook> sharedPtr1(std::move(sharedPtr));
+        QVERIFY(sharedPtr.isNull());
+        QVERIFY(!sharedPtr1.isNull());
+
+        cpp::BasicSharedPointer<DeleteHook> sharedPtr2;
+        sharedPtr2 = std::move(sharedPtr1);
+        QVERIFY(sharedPtr1.isNull());
+        QCOMPARE(spyHint, 0);
+    }
+    QCOMPARE(spyHint, -2);
+
+    // Copy assignment releases the previous reference
+    int spyHint1 = 0;
+    spyHint = 0;
+    {
+        cpp::BasicSharedPointer<DeleteHook> sharedPtr =
+                cpp::makeBasicShared<DeleteHook>(-1, &spyHint);
+        cpp::BasicSharedPointer<DeleteHook> sharedPtr1(
+                    new DeleteHook(-3, &spyHint1));
+        sharedPtr1 = sharedPtr;
+        QCOMPARE(spyHint1, -3);
+        sharedPtr1 = sharedPtr;
+        sharedPtr = cpp::BasicSharedPointer<DeleteHook>();
+        QCOMPARE(spyHint, 0);
+        sharedPtr1 = sharedPtr;
+        QCOMPARE(spyHint, -1);
+    }
+
+    // Atomic reference counting, copies destroyed concurrently
+    spyHint = 0;
+    {
+        typedef cpp::BasicSharedPointer<DeleteHook, cpp::AtomicRefCountPolicy>
+                AtomicSharedPointer;
+        AtomicSharedPointer sharedPtr =
+                cpp::makeBasicShared<DeleteHook, cpp::AtomicRefCountPolicy>(
+                    -4, &spyHint);
+        std::vector<std::thread> threads;
+        for (int i = 0; i < 4; ++i) {
+            threads.emplace_back([=] {
+                for (int j = 0; j < 10000; ++j) {
+                    AtomicSharedPointer copy = sharedPtr;
+                    AtomicSharedPointer copy1;
+                    copy1 = copy;
+                }
+            });
+        }
+        for (std::thread& thread : threads)
+            thread.join();
+        QCOMPARE(spyHint, 0);
+    }
+    QCOMPARE(spyHint, -4);
+}
+
+struct RefCountedDeleteHook : public cpp::BasicRefCounted<>, public DeleteHook
+{
+    RefCountedDeleteHook(int valOnDelete, int* spyInt)
+        : DeleteHook(valOnDelete, spyInt)
+    { }
+};
+
+void TestCppTools::BasicSharedPointer_benchmark_data()
+{
+    QTest::addColumn<int>("pointerKind");
+    QTest::newRow("BasicSharedPointer") << 0;
+    QTest::newRow("BasicSharedPointer<AtomicRefCountPolicy>") << 1;
+    QTest::newRow("std::shared_ptr") << 2;
+}
+
+namespace Internal {
+
+// Creates objectCount shared objects, then copies each of them copyCount
+// times and destroys everything
+template<typename POINTER, typename FUNC_MAKE>
+static std::size_t sharedPointerBenchmarkLoop(
+        int objectCount, int copyCount, FUNC_MAKE fnMake)
+{
+    std::vector<POINTER> ptrs;
+    ptrs.reserve(objectCount);
+    for (int i = 0; i < objectCount; ++i)
+        ptrs.push_back(fnMake(i));
+    std::vector<POINTER> copies;
+    copies.reserve(objectCount * copyCount);
+    for (int c = 0; c < copyCount; ++c) {
+        for (const POINTER& ptr : ptrs)
+            copies.push_back(ptr);
+    }
+    return copies.size();
+}
+
+} // namespace Internal
+
+void TestCppTools::BasicSharedPointer_benchmark()
+{
+    QFETCH(int, pointerKind);
+    const int objectCount = 10000;
+    const int copyCount = 8;
+    std::size_t copyTotal = 0;
+    if (pointerKind == 0) {
+        typedef cpp::BasicSharedPointer<int> Ptr;
+        QBENCHMARK {
+            copyTotal = Internal::sharedPointerBenchmarkLoop<Ptr>(
+                        objectCount, copyCount, [] (int i) { return cpp::makeBasicShared<int>(i); });
+        }
+    }
+    else if (pointerKind == 1) {
+        typedef cpp::AtomicRefCountPolicy Policy;
+        typedef cpp::BasicSharedPointer<int, Policy> Ptr;
+        QBENCHMARK {
+            copyTotal = Internal::sharedPointerBenchmarkLoop<Ptr>(
+                        objectCount, copyCount, [] (int i) { return cpp::makeBasicShared<int, Policy>(i); });
+        }
+    }
+    else {
+        typedef std::shared_ptr<int> Ptr;
+        QBENCHMARK {
+            copyTotal = Internal::sharedPointerBenchmarkLoop<Ptr>(
+                        objectCount, copyCount, [] (int i) { return std::make_shared<int>(i); });
+        }
+    }
+    QCOMPARE(copyTotal, static_cast<std::size_t>(objectCount * copyCount));
+}
+
+void TestCppTools::BasicIntrusivePointer_test()
+{
+    typedef cpp::BasicIntrusivePointer<RefCountedDeleteHook> IntrusivePointer;
+    QCOMPARE(sizeof(IntrusivePointer), sizeof(RefCountedDeleteHook*));
+
+    int spyHint = 0;
+    {
+        RefCountedDeleteHook* delHook = new RefCountedDeleteHook(-1, &spyHint);
+        IntrusivePointer sharedPtr(delHook);
+        QCOMPARE(sharedPtr.data(), delHook);
+
+        IntrusivePointer sharedPtr1;
+        QVERIFY(sharedPtr1.isNull());
+        sharedPtr1 = sharedPtr;
+        QCOMPARE(sharedPtr1.data(), delHook);
+
+        // Reference count is in the pointee, sharing from the raw pointer
+        IntrusivePointer sharedPtr2(delHook);
+        sharedPtr = IntrusivePointer();
+        sharedPtr1 = std::move(sharedPtr2);
+        QVERIFY(sharedPtr2.isNull());
+        QCOMPARE(spyHint, 0);
+    }
+    QCOMPARE(spyHint, -1);
+
+    // Copy assignment releases the previous reference
+    int spyHint1 = 0;
+    spyHint = 0;
+    {
+        IntrusivePointer sharedPtr(new RefCountedDeleteHook(-1, &spyHint));
+        IntrusivePointer sharedPtr1(new RefCountedDeleteHook(-3, &spyHint1));
+        sharedPtr1 = sharedPtr;
+        QCOMPARE(spyHint1, -3);
+        QCOMPARE(spyHint, 0);
+    }
+    QCOMPARE(spyHint, -1);
+}
+
+void TestCppTools::FixedArray_test()
+{
+    typedef cpp::FixedArray<double, 4, 32> Vec4;
+    static_assert(std::is_trivially_copyable<Vec4>::value, "Copies must be memcpy");
+    QCOMPARE(Vec4::alignment, static_cast<std::size_t>(32));
+    typedef cpp::FixedArray<double, 3> Vec3;
+    QCOMPARE(Vec3::alignment, std::alignment_of<double>::value);
+
+    Vec4 ones;
+    ones.fill(1.);
+    Vec4 vec;
+    for (unsigned i = 0; i < vec.size(); ++i)
+        vec[i] = i;
+#ifdef CPPTOOLS_HAVE_ALIGNAS
+    QCOMPARE(cpp::scalarAddress(vec.cArray()) % 32, static_cast<std::size_t>(0));
+#endif
+
+    const Vec4 res = 2. * (ones + vec) - vec / 2.;
+    for (unsigned i = 0; i < res.size(); ++i)
+        QCOMPARE(res[i], 2. * (1. + i) - i / 2.);
+    const Vec4 negRes = -res;
+    QCOMPARE(negRes[3], -res[3]);
+
+    Vec4 copy = res;
+    copy -= ones;
+    copy *= 3.;
+    QCOMPARE(copy[1], (res[1] - 1.) * 3.);
+}
+
+void TestCppTools::FixedArray_benchmark_data()
+{
+    QTest::addColumn<bool>("isFixedArray");
+    QTest::newRow("FixedArray<double, 4, 32>") << true;
+    QTest::newRow("std::array<double, 4>") << false;
+}
+
+void TestCppTools::FixedArray_benchmark()
+{
+    QFETCH(bool, isFixedArray);
+    const std::size_t count = 4096;
+    double sum = 0.;
+    if (isFixedArray) {
+        typedef cpp::FixedArray<double, 4, 32> Vec4;
+        std::vector<Vec4> vecs(count);
+        for (std::size_t i = 0; i < count; ++i)
+            vecs[i].fill(static_cast<double>(i % 7));
+        Vec4 offset;
+        offset.fill(0.5);
+        QBENCHMARK {
+            Vec4 acc;
+            acc.fill(0.);
+            for (const Vec4& vec : vecs)
+                acc += 2. * (vec + offset) - vec / 2.;
+            sum = acc[0] + acc[1] + acc[2] + acc[3];
+        }
+    }
+    else {
+        typedef std::array<double, 4> Vec4;
+        std::vector<Vec4> vecs(count);
+        for (std::size_t i = 0; i < count; ++i)
+            vecs[i].fill(static_cast<double>(i % 7));
+        Vec4 offset;
+        offset.fill(0.5);
+        QBENCHMARK {
+            Vec4 acc;
+            acc.fill(0.);
+            for (const Vec4& vec : vecs) {
+                for (std::size_t j = 0; j < 4; ++j)
+                    acc[j] += 2. * (vec[j] + offset[j]) - vec[j] / 2.;
+            }
+            sum = acc[0] + acc[1] + acc[2] + acc[3];
+        }
+    }
+    QVERIFY(sum > 0.);
+}
+
+void TestCppTools::SmallVector_test()
+{
+    cpp::SmallVector<std::string, 2> vec;
+    QVERIFY(vec.empty());
+    QVERIFY(vec.isInline());
+    vec.push_back("a");
+    vec.emplace_back(2, 'b');
+    QVERIFY(vec.isInline());
+    QCOMPARE(vec.capacity(), static_cast<std::size_t>(2));
+
+    // Spill to the heap
+    vec.push_back(vec.front());
+    QVERIFY(!vec.isInline());
+    QCOMPARE(vec.size(), static_cast<std::size_t>(3));
+    QCOMPARE(vec[0], std::string("a"));
+    QCOMPARE(vec[1], std::string("bb"));
+    QCOMPARE(vec.back(), std::string("a"));
+
+    // Heap memory is stolen by move, inline items are moved one by one
+    cpp::SmallVector<std::string, 2> vecMoved(std::move(vec));
+    QVERIFY(vec.empty());
+    QVERIFY(vec.isInline());
+    QCOMPARE(vecMoved.size(), static_cast<std::size_t>(3));
+
+    vecMoved.erase(vecMoved.begin());
+    const cpp::SmallVector<std::string, 2> vecExpected = { "bb", "a" };
+    QVERIFY(vecMoved == vecExpected);
+    cpp::SmallVector<std::string, 2> vecCopy(vecMoved);
+    QVERIFY(vecCopy.isInline());
+    QVERIFY(vecCopy == vecMoved);
+
+    vecCopy.resize(5, "c");
+    QCOMPARE(vecCopy.size(), static_cast<std::size_t>(5));
+    QCOMPARE(vecCopy.back(), std::string("c"));
+    vecCopy.clear();
+    QVERIFY(vecCopy.empty());
+
+    // (count, value) with integral arguments, not an iterator range
+    const cpp::SmallVector<int, 4> vecInt(3, 5);
+    QCOMPARE(vecInt.size(), static_cast<std::size_t>(3));
+    QVERIFY(vecInt == (cpp::SmallVector<int, 4>{ 5, 5, 5 }));
+    const int array[] = { 1, 2, 3, 4, 5, 6 };
+    const cpp::SmallVector<int, 4> vecRange(std::begin(array), std::end(array));
+    QCOMPARE(vecRange.size(), static_cast<std::size_t>(6));
+    QCOMPARE(vecRange.back(), 6);
 }
 
 void TestCppTools::cArrayUtils_test()
@@ -161,8 +478,428 @@ void TestCppTools::circularIterator_test()
     QCOMPARE(cpp::circularAdvance(0, 5, 0, 3), 3);
     QCOMPARE(cpp::circularAdvance(0, 5, 0, -3), 2);
     QCOMPARE(cpp::circularAdvance(0, 5, 0, 6), 1);
+    QCOMPARE(cpp::circularAdvance(0, 5, 2, -1000003), 4);
+
+    // Unsigned indexes, negative distances must not wrap around
+    QCOMPARE(cpp::circularAdvance(0u, 5u, 0u, -1), 4u);
+    QCOMPARE(cpp::circularAdvance(0u, 5u, 1u, -3), 3u);
+    QCOMPARE(cpp::circularAdvance(0u, 5u, 4u, 1), 0u);
+    QCOMPARE(cpp::circularAdvance(std::size_t(0), std::size_t(5), std::size_t(0), -1),
+             static_cast<std::size_t>(4));
+    QCOMPARE(cpp::circularAdvance(std::size_t(0), std::size_t(5), std::size_t(2), -1000003),
+             static_cast<std::size_t>(4));
+
+    // Random access (constant time) and bidirectional iterators
+    const std::vector<int> vec = { 0, 1, 2, 3, 4 };
+    const std::list<int> list(vec.cbegin(), vec.cend());
+    for (int d = -12; d <= 12; ++d) {
+        const int vecPos = *cpp::circularAdvance(vec.cbegin(), vec.cend(), vec.cbegin() + 3, d);
+        const int listPos = *cpp::circularAdvance(
+                    list.cbegin(), list.cend(), std::next(list.cbegin(), 3), d);
+        QCOMPARE(vecPos, cpp::circularAdvance(0, 5, 3, d));
+        QCOMPARE(listPos, vecPos);
+    }
+}
+
+void TestCppTools::RingBuffer_test()
+{
+    cpp::RingBuffer<int> ring(5);
+    QCOMPARE(ring.capacity(), static_cast<std::size_t>(8));
+    QVERIFY(ring.empty());
+
+    for (int i = 0; i < 6; ++i)
+        ring.push_back(i);
+    QCOMPARE(ring.size(), static_cast<std::size_t>(6));
+    QCOMPARE(ring.front(), 0);
+    QCOMPARE(ring.back(), 5);
+    ring.pop_front();
+    ring.pop_front();
+
+    // Bulk push wraps around the end of the slots
+    const int values[] = { 6, 7, 8, 9, 10 };
+    QCOMPARE(ring.push(values, 5), static_cast<std::size_t>(4));
+    QVERIFY(ring.full());
+    QCOMPARE(ring.back(), 9);
+    QCOMPARE(ring[0], 2);
+    QCOMPARE(std::distance(ring.begin(), ring.end()), std::ptrdiff_t(8));
+    QCOMPARE(*(ring.begin() + 7), 9);
+    QVERIFY(std::equal(ring.begin(), ring.end(), std::vector<int>({2,3,4,5,6,7,8,9}).begin()));
+
+    ring.pushOverwrite(10);
+    QCOMPARE(ring.front(), 3);
+    QCOMPARE(ring.back(), 10);
+
+    std::vector<int> popped;
+    QCOMPARE(ring.pop(std::back_inserter(popped), 3), static_cast<std::size_t>(3));
+    QVERIFY(popped == std::vector<int>({3,4,5}));
+    QCOMPARE(ring.pop(std::back_inserter(popped), 100), static_cast<std::size_t>(5));
+    QVERIFY(ring.empty());
+    QCOMPARE(popped.back(), 10);
+
+    // Single producer / single consumer
+    cpp::SpscRingBuffer<int> spsc(64);
+    const int itemCount = 100000;
+    std::thread producer([&] {
+        int items[7];
+        int next = 0;
+        while (next < itemCount) {
+            const int count = std::min(7, itemCount - next);
+            for (int i = 0; i < count; ++i)
+                items[i] = next + i;
+            next += static_cast<int>(spsc.tryPush(items, count));
+        }
+    });
+    bool inOrder = true;
+    int expected = 0;
+    while (expected < itemCount) {
+        int items[5];
+        const std::size_t count = spsc.tryPop(items, 5);
+        for (std::size_t i = 0; i < count; ++i) {
+            inOrder = inOrder && items[i] == expected;
+            ++expected;
+        }
+    }
+    producer.join();
+    QVERIFY(inOrder);
+    QCOMPARE(spsc.sizeApprox(), static_cast<std::size_t>(0));
+}
+
+namespace Internal {
+
+//! Mutex-guarded std::queue, reference of MpmcQueue_benchmark()
+template<typename T>
+class MutexQueue
+{
+public:
+    bool tryPush(const T& value)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_queue.push(value);
+        return true;
+    }
+
+    bool tryPop(T* value)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_queue.empty())
+            return false;
+        *value = m_queue.front();
+        m_queue.pop();
+        return true;
+    }
+
+private:
+    std::mutex m_mutex;
+    std::queue<T> m_queue;
+};
+
+/*! Each producer pushes values 1..itemCountPerProducer in \p queue, consumers
+ *  pop them concurrently
+ *
+ *  \returns The sum of the popped values
+ */
+template<typename QUEUE>
+long long runQueueThreads(
+        QUEUE* queue, int producerCount, int consumerCount, int itemCountPerProducer)
+{
+    const int totalCount = producerCount * itemCountPerProducer;
+    std::atomic<int> poppedCount(0);
+    std::atomic<long long> sum(0);
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producerCount; ++p) {
+        threads.emplace_back([=] {
+            for (int i = 1; i <= itemCountPerProducer; ++i) {
+                while (!queue->tryPush(i))
+                    std::this_thread::yield();
+            }
+        });
+    }
+    for (int c = 0; c < consumerCount; ++c) {
+        threads.emplace_back([&] {
+            long long localSum = 0;
+            int value = 0;
+            while (poppedCount.load() < totalCount) {
+                if (queue->tryPop(&value)) {
+                    localSum += value;
+                    ++poppedCount;
+                }
+                else {
+                    std::this_thread::yield();
+                }
+            }
+            sum += localSum;
+        });
+    }
+    for (std::thread& thread : threads)
+        thread.join();
+    return sum.load();
+}
+
+} // namespace Internal
+
+void TestCppTools::MpmcQueue_test()
+{
+    cpp::MpmcQueue<int> queue(5);
+    QCOMPARE(queue.capacity(), static_cast<std::size_t>(8));
+    int value = 0;
+    QVERIFY(!queue.tryPop(&value));
+    for (int i = 0; i < 8; ++i)
+        QVERIFY(queue.tryPush(i));
+    QVERIFY(!queue.tryPush(8)); // Full
+    QCOMPARE(queue.sizeApprox(), static_cast<std::size_t>(8));
+    QVERIFY(queue.tryPop(&value));
+    QCOMPARE(value, 0);
+    QVERIFY(queue.tryPush(8)); // Wraps around
+    for (int i = 1; i <= 8; ++i) {
+        QVERIFY(queue.tryPop(&value));
+        QCOMPARE(value, i);
+    }
+    QVERIFY(!queue.tryPop(&value));
+
+    // Move-only items
+    cpp::MpmcQueue<std::unique_ptr<int>> ptrQueue(2);
+    QVERIFY(ptrQueue.tryPush(std::unique_ptr<int>(new int(42))));
+    std::unique_ptr<int> ptr;
+    QVERIFY(ptrQueue.tryPop(&ptr));
+    QCOMPARE(*ptr, 42);
+    cpp::SpscQueue<std::unique_ptr<int>> spscPtrQueue(2);
+    QVERIFY(spscPtrQueue.tryPush(std::move(ptr)));
+    QVERIFY(spscPtrQueue.tryPop(&ptr));
+    QCOMPARE(*ptr, 42);
+
+    // Concurrent producers and consumers, no item lost nor duplicated
+    cpp::MpmcQueue<int> mpmc(64);
+    const int itemCount = 20000;
+    const long long sum = Internal::runQueueThreads(&mpmc, 4, 4, itemCount);
+    QCOMPARE(sum, 4LL * itemCount * (itemCount + 1) / 2);
+    QCOMPARE(mpmc.sizeApprox(), static_cast<std::size_t>(0));
 }
 
+void TestCppTools::MpmcQueue_benchmark_data()
+{
+    QTest::addColumn<bool>("isLockFree");
+    QTest::addColumn<int>("threadCount");
+    for (int threadCount : { 1, 2, 4 }) {
+        const QByteArray suffix = " producers=consumers=" + QByteArray::number(threadCount);
+        QTest::newRow(QByteArray("MpmcQueue" + suffix).constData())
+                << true << threadCount;
+        QTest::newRow(QByteArray("mutex+std::queue" + suffix).constData())
+                << false << threadCount;
+    }
+}
+
+void TestCppTools::MpmcQueue_benchmark()
+{
+    QFETCH(bool, isLockFree);
+    QFETCH(int, threadCount);
+    const int itemCount = 100000;
+    long long sum = 0;
+    if (isLockFree) {
+        cpp::MpmcQueue<int> queue(1024);
+        QBENCHMARK {
+            sum = Internal::runQueueThreads(&queue, threadCount, threadCount, itemCount);
+        }
+    }
+    else {
+        Internal::MutexQueue<int> queue;
+        QBENCHMARK {
+            sum = Internal::runQueueThreads(&queue, threadCount, threadCount, itemCount);
+        }
+    }
+    QCOMPARE(sum, threadCount * (itemCount * (itemCount + 1LL) / 2));
+}
+namespace Internal {
+
+struct TreeNode
+{
+    TreeNode(int nodeId = 0, int nodeDepth = 0)
+        : id(nodeId), depth(nodeDepth)
+    { }
+
+    int id;
+    int depth;
+    std::vector<TreeNode*> children;
+};
+
+struct TreeNodeBfsModel
+{
+    static bool isDeeper(const TreeNode* current, const TreeNode* previous)
+    { return current->depth > previous->depth; }
+
+    template<typename OUTPUT_ITERATOR>
+    static void enqueueChildren(OUTPUT_ITERATOR out, TreeNode* parentNode)
+    { cpp::pushRange(out, parentNode->children.begin(), parentNode->children.end()); }
+};
+
+} // namespace Internal
+
+void TestCppTools::TreeBfsExplorer_test()
+{
+    typedef Internal::TreeNode Node;
+    Node c(3, 2), d(4, 2), e(5, 2);
+    Node a(1, 1), b(2, 1);
+    Node root(0, 0);
+    a.children = { &c, &d };
+    b.children = { &e };
+    root.children = { &a, &b };
+
+    cpp::TreeBfsExplorer<Node, Internal::TreeNodeBfsModel> explorer;
+    // Explorer is reused, second pass must give the same result
+    for (int pass = 0; pass < 2; ++pass) {
+        std::vector<int> ids;
+        std::vector<unsigned> depths;
+        for (explorer.begin(&root); !explorer.atEnd(); explorer.goNext()) {
+            ids.push_back(explorer.current()->id);
+            depths.push_back(explorer.depth());
+        }
+        QVERIFY(ids == std::vector<int>({0, 1, 2, 3, 4, 5}));
+        QVERIFY(depths == std::vector<unsigned>({0, 1, 1, 2, 2, 2}));
+    }
+
+    // Wide tree, consumed nodes are dropped along the exploration
+    std::vector<Node> leaves(300);
+    Node wideRoot(-1, 0);
+    for (std::size_t i = 0; i < leaves.size(); ++i) {
+        leaves[i].id = static_cast<int>(i);
+        leaves[i].depth = i < 100 ? 1 : 2;
+        if (i < 100)
+            wideRoot.children.push_back(&leaves[i]);
+        else
+            leaves[(i - 100) / 2].children.push_back(&leaves[i]);
+    }
+    int expectedId = -1;
+    bool inOrder = true;
+    for (explorer.begin(&wideRoot); !explorer.atEnd(); explorer.goNext()) {
+        inOrder = inOrder && explorer.current()->id == expectedId;
+        ++expectedId;
+    }
+    QVERIFY(inOrder);
+    QCOMPARE(expectedId, 300);
+
+    // Pruned subtree is not visited
+    std::vector<int> prunedIds;
+    for (explorer.begin(&root); !explorer.atEnd(); explorer.goNext()) {
+        prunedIds.push_back(explorer.current()->id);
+        if (explorer.current() == &a)
+            explorer.skipChildren();
+    }
+    QVERIFY(prunedIds == std::vector<int>({0, 1, 2, 5}));
+}
+void TestCppTools::TreeBfsExplorer_benchmark_data()
+{
+    QTest::addColumn<bool>("isTreeBfsExplorer");
+    QTest::newRow("TreeBfsExplorer") << true;
+    QTest::newRow("std::queue") << false;
+}
+
+void TestCppTools::TreeBfsExplorer_benchmark()
+{
+    QFETCH(bool, isTreeBfsExplorer);
+    typedef Internal::TreeNode Node;
+
+    // Tree of depth 5 with 8 children per node (37449 nodes)
+    const std::size_t nodeCount = 37449;
+    std::vector<Node> nodes;
+    nodes.reserve(nodeCount); // Node addresses must stay valid
+    nodes.push_back(Node(0, 0));
+    for (std::size_t i = 0; nodes.size() < nodeCount; ++i) {
+        for (int c = 0; c < 8; ++c) {
+            nodes.push_back(Node(static_cast<int>(nodes.size()), nodes[i].depth + 1));
+            nodes[i].children.push_back(&nodes.back());
+        }
+    }
+
+    long long idSum = 0;
+    if (isTreeBfsExplorer) {
+        cpp::TreeBfsExplorer<Node, Internal::TreeNodeBfsModel> explorer;
+        QBENCHMARK {
+            idSum = 0;
+            for (explorer.begin(&nodes.front()); !explorer.atEnd(); explorer.goNext())
+                idSum += explorer.current()->id;
+        }
+    }
+    else {
+        QBENCHMARK {
+            idSum = 0;
+            std::queue<Node*> queue;
+            queue.push(&nodes.front());
+            while (!queue.empty()) {
+                Node* node = queue.front();
+                queue.pop();
+                idSum += node->id;
+                for (Node* child : node->children)
+                    queue.push(child);
+            }
+        }
+    }
+    QCOMPARE(idSum, static_cast<long long>(nodes.size()) * (nodes.size() - 1) / 2);
+}
+
+void TestCppTools::TreeDfsExplorer_test()
+{
+    typedef Internal::TreeNode Node;
+    Node c(2, 2), d(3, 2), e(5, 2);
+    Node a(1, 1), b(4, 1);
+    Node root(0, 0);
+    a.children = { &c, &d };
+    b.children = { &e };
+    root.children = { &a, &b };
+
+    cpp::TreeDfsExplorer<Node, Internal::TreeNodeBfsModel> explorer;
+    std::vector<int> ids;
+    std::vector<unsigned> depths;
+    for (explorer.begin(&root); !explorer.atEnd(); explorer.goNext()) {
+        ids.push_back(explorer.current()->id);
+        depths.push_back(explorer.depth());
+    }
+    QVERIFY(ids == std::vector<int>({0, 1, 2, 3, 4, 5}));
+    QVERIFY(depths == std::vector<unsigned>({0, 1, 2, 2, 1, 2}));
+
+    // Deep tree, no recursion
+    std::vector<Node> chain(100000);
+    for (std::size_t i = 0; i + 1 < chain.size(); ++i)
+        chain[i].children.push_back(&chain[i + 1]);
+    unsigned maxDepth = 0;
+    for (explorer.begin(&chain.front()); !explorer.atEnd(); explorer.goNext())
+        maxDepth = std::max(maxDepth, explorer.depth());
+    QCOMPARE(maxDepth, static_cast<unsigned>(chain.size() - 1));
+}
+
+void TestCppTools::parallelTreeBfs_test()
+{
+    typedef Internal::TreeNode Node;
+    // Complete ternary tree with 8 levels, node ids in BFS order
+    std::vector<Node> nodes(3280);
+    for (std::size_t i = 0; i < nodes.size(); ++i) {
+        nodes[i].id = static_cast<int>(i);
+        for (std::size_t iChild = 3 * i + 1; iChild <= 3 * i + 3; ++iChild) {
+            if (iChild < nodes.size()) {
+                nodes[iChild].depth = nodes[i].depth + 1;
+                nodes[i].children.push_back(&nodes[iChild]);
+            }
+        }
+    }
+
+    for (unsigned threadCount = 1; threadCount <= 4; ++threadCount) {
+        std::vector<int> visitCount(nodes.size(), 0);
+        std::vector<int> visitDepth(nodes.size(), -1);
+        cpp::parallelTreeBfs<Internal::TreeNodeBfsModel>(
+                    &nodes.front(),
+                    [&] (Node* node, unsigned depth) {
+            ++visitCount.at(node->id);
+            visitDepth.at(node->id) = depth;
+        },
+        threadCount, 8);
+
+        bool ok = true;
+        for (const Node& node : nodes)
+            ok = ok && visitCount[node.id] == 1 && visitDepth[node.id] == node.depth;
+        QVERIFY(ok);
+    }
+}
+
+
+
 namespace memoryUtils_test {
 
 struct DummyObserver
@@ -203,6 +940,115 @@ void TestCppTools::memoryUtils_test()
     QVERIFY(observer.isDummyDeleted);
 }
 
+void TestCppTools::memoryArena_test()
+{
+    // MonotonicArena
+    {
+        cpp::MonotonicArena arena(256);
+        for (std::size_t i = 0; i < 100; ++i) {
+            const std::size_t alignment = std::size_t(1) << (i % 5);
+            const void* ptr = arena.allocate(1 + i % 40, alignment);
+            QCOMPARE(cpp::scalarAddress(ptr) % alignment, static_cast<std::size_t>(0));
+        }
+        const double* dblPtr = arena.create<double>(1.5);
+        QCOMPARE(*dblPtr, 1.5);
+        arena.allocate(1000); // Larger than block size
+
+        const cpp::MemoryStats& stats = arena.stats();
+        QCOMPARE(stats.allocationCount, static_cast<std::size_t>(102));
+        QVERIFY(stats.bytesInUse >= 1000);
+        QVERIFY(stats.bytesReserved >= stats.bytesInUse);
+        const std::size_t peakBytesReserved = stats.peakBytesReserved;
+
+        arena.release();
+        QCOMPARE(stats.bytesInUse, static_cast<std::size_t>(0));
+        QVERIFY(stats.bytesReserved < peakBytesReserved);
+        QCOMPARE(stats.peakBytesReserved, peakBytesReserved);
+
+        std::vector<int, cpp::ArenaAllocator<int>> vec((cpp::ArenaAllocator<int>(arena)));
+        for (int i = 0; i < 1000; ++i)
+            vec.push_back(i);
+        QCOMPARE(vec.at(999), 999);
+    }
+
+    // ObjectPool, memory of destroyed objects is reused
+    {
+        cpp::ObjectPool<memoryUtils_test::Dummy> pool(8);
+        memoryUtils_test::DummyObserver observer;
+        std::vector<memoryUtils_test::Dummy*> dummyVec;
+        for (int i = 0; i < 20; ++i)
+            dummyVec.push_back(pool.create(&observer));
+        pool.destroy(dummyVec.back());
+        QVERIFY(observer.isDummyDeleted);
+        const std::size_t bytesReserved = pool.stats().bytesReserved;
+        QVERIFY(pool.create(&observer) == dummyVec.back());
+        QCOMPARE(pool.stats().bytesReserved, bytesReserved);
+        QCOMPARE(pool.stats().bytesInUse, pool.stats().peakBytesInUse);
+    }
+
+    // PoolAllocator with node-based containers
+    {
+        cpp::FixedSizePool pool(64);
+        typedef std::pair<const int, int> MapValue;
+        std::map<int, int, std::less<int>, cpp::PoolAllocator<MapValue>> map(
+                    (std::less<int>()), cpp::PoolAllocator<MapValue>(pool));
+        std::list<int, cpp::PoolAllocator<int>> list((cpp::PoolAllocator<int>(pool)));
+        for (int i = 0; i < 100; ++i) {
+            map[i] = i;
+            list.push_back(i);
+        }
+        QCOMPARE(pool.stats().allocationCount, static_cast<std::size_t>(200));
+        map.clear();
+        QCOMPARE(pool.stats().bytesInUse, 100 * pool.slotSize());
+    }
+}
+
+void TestCppTools::profiling_test()
+{
+    // Histogram buckets : bounds are increasing and enclose their samples
+    for (std::uint64_t nsec : { 0ull, 1ull, 5ull, 1000ull, 123456789ull }) {
+        const unsigned bucket = cpp::ProfileZoneStats::histogramBucket(nsec);
+        QVERIFY(bucket < cpp::ProfileZoneStats::histogramSize);
+        QVERIFY(nsec <= cpp::ProfileZoneStats::histogramBucketUpperBound(bucket));
+    }
+
+    cpp::ProfileZoneStats stats("stats");
+    for (std::uint64_t nsec = 1; nsec <= 1000; ++nsec)
+        stats.record(nsec * 1000);
+    QCOMPARE(stats.count, static_cast<std::uint64_t>(1000));
+    QCOMPARE(stats.minNSec, static_cast<std::uint64_t>(1000));
+    QCOMPARE(stats.maxNSec, static_cast<std::uint64_t>(1000000));
+    QCOMPARE(stats.meanNSec(), 500500.);
+    const std::uint64_t p50 = stats.percentileNSec(0.5);
+    QVERIFY(500000 <= p50 && p50 <= 625000);
+    QCOMPARE(stats.percentileNSec(1.), stats.maxNSec);
+
+    // Zones ended in several threads are aggregated by name
+    static const char zoneName[] = "TestCppTools::profiling_test";
+    cpp::profileReset();
+    auto fnRecord = [] {
+        for (int i = 0; i < 100; ++i)
+            cpp::ProfileZone zone(zoneName);
+    };
+    std::thread thread1(fnRecord);
+    std::thread thread2(fnRecord);
+    fnRecord();
+    thread1.join();
+    thread2.join();
+
+    const std::vector<cpp::ProfileZoneStats> zones = cpp::profileSnapshot();
+    auto itZone = std::find_if(
+                zones.cbegin(), zones.cend(),
+                [] (const cpp::ProfileZoneStats& zone) {
+        return std::strcmp(zone.name, zoneName) == 0;
+    });
+    QVERIFY(itZone != zones.cend());
+    QCOMPARE(itZone->count, static_cast<std::uint64_t>(300));
+
+    cpp::profileReset();
+    QVERIFY(cpp::profileSnapshot().empty());
+}
+
 void TestCppTools::pusher_test()
 {
     std::queue<int> intq;
@@ -213,6 +1059,33 @@ void TestCppTools::pusher_test()
     QCOMPARE(intq.front(), 5);
     intq.pop();
     QCOMPARE(intq.front(), 10);
+
+    // Container without push(), items are added with push_back()
+    std::vector<int> vec;
+    auto itVec = cpp::pusher(vec);
+    *itVec = 1; ++itVec;
+    QCOMPARE(vec.size(), static_cast<std::size_t>(1));
+
+    // Bulk push, with range insert() and with reserve() + push_back()
+    const int values[] = { 2, 3, 4, 5 };
+    cpp::pushRange(itVec, std::begin(values), std::end(values));
+    QVERIFY(vec == std::vector<int>({1, 2, 3, 4, 5}));
+
+    cpp::SmallVector<int, 2> smallVec;
+    cpp::pushRange(cpp::pusher(smallVec), std::begin(values), std::end(values));
+    QCOMPARE(smallVec.size(), static_cast<std::size_t>(4));
+    QVERIFY(smallVec.capacity() >= 4);
+    QCOMPARE(smallVec.back(), 5);
+
+    // Any other output iterator gets the items one by one
+    std::list<int> list;
+    cpp::pushRange(std::back_inserter(list), vec.begin(), vec.end());
+    QCOMPARE(list.size(), vec.size());
+
+    // Range without insert() nor reserve()
+    cpp::pushRange(cpp::pusher(intq), std::begin(values), std::end(values));
+    QCOMPARE(intq.size(), static_cast<std::size_t>(5));
+    QCOMPARE(intq.back(), 5);
 }
 
 namespace hash_fnv_test {
@@ -250,9 +1123,155 @@ void TestCppTools::hash_fnv_test()
         QCOMPARE(hash64(testData.byteSeq), testData.hash64_fnv_1a);
         QCOMPARE(hash64(testData.byteSeq, byteSeqLen), testData.hash64_fnv_1a);
         QCOMPARE(hash64(testData.byteSeq, testData.byteSeq + byteSeqLen), testData.hash64_fnv_1a);
+
+        QCOMPARE(cpp::hash32_fnv_1a::compute(testData.byteSeq), testData.hash32_fnv_1a);
+        QCOMPARE(cpp::hash64_fnv_1a::compute(testData.byteSeq, byteSeqLen), testData.hash64_fnv_1a);
+
+        cpp::hash32_fnv_1a_stream hashStream32;
+        QCOMPARE(hashStream32.update(testData.byteSeq).digest(), testData.hash32_fnv_1a);
+        cpp::hash64_fnv_1a_stream hashStream64;
+        QCOMPARE(hashStream64.update(testData.byteSeq, byteSeqLen).digest(), testData.hash64_fnv_1a);
+    }
+
+    // Chunked hashing
+    const char byteSeq[] = "FougTools incremental hashing";
+    const std::size_t byteSeqLen = std::strlen(byteSeq);
+    const cpp::hash64_fnv_1a_stream::uint_type byteSeqHash =
+            cpp::hash64_fnv_1a()(byteSeq, byteSeqLen);
+    for (std::size_t chunkLen = 1; chunkLen <= byteSeqLen; ++chunkLen) {
+        cpp::hash64_fnv_1a_stream hashStream;
+        for (std::size_t pos = 0; pos < byteSeqLen; pos += chunkLen) {
+            const std::size_t len = std::min(chunkLen, byteSeqLen - pos);
+            if (pos % 2 == 0)
+                hashStream.update(byteSeq + pos, len);
+            else
+                hashStream.update(byteSeq + pos, byteSeq + pos + len);
+        }
+        QCOMPARE(hashStream.digest(), byteSeqHash);
+        hashStream.reset();
+        QCOMPARE(hashStream.digest(), cpp::hash64_fnv_1a()(""));
     }
 }
 
+namespace hash_fnv_test {
+
+int switchOnHash(const char* str)
+{
+#ifdef CPPTOOLS_HAVE_CONSTEXPR
+    using namespace cpp::literals;
+    switch (cpp::hash_fnv_1a<>()(str)) {
+    case cpp::hash_fnv_1a<>::compute("started"): return 1;
+    case "running"_fnv: return 2;
+    case "finished"_fnv: return 3;
+    default: return 0;
+    }
+#else
+    Q_UNUSED(str);
+    return -1;
+#endif
+}
+
+} // namespace hash_fnv_test
+
+void TestCppTools::hash_fnv_constexpr_test()
+{
+#ifdef CPPTOOLS_HAVE_CONSTEXPR
+    static_assert(cpp::hash32_fnv_1a::compute("") == 0x811c9dc5UL, "");
+    static_assert(cpp::hash32_fnv_1a::compute("a") == 0xe40c292cUL, "");
+    static_assert(cpp::hash64_fnv_1a::compute("e", 1) == 0xaf63d84c8601e5c0ULL, "");
+
+    QCOMPARE(hash_fnv_test::switchOnHash("started"), 1);
+    QCOMPARE(hash_fnv_test::switchOnHash("running"), 2);
+    QCOMPARE(hash_fnv_test::switchOnHash("finished"), 3);
+    QCOMPARE(hash_fnv_test::switchOnHash("paused"), 0);
+
+    // Non-ASCII chars are hashed as with operator()
+    const char str[] = "\xe9t\xe9";
+    QCOMPARE(cpp::hash_fnv_1a<>::compute(str), cpp::hash_fnv_1a<>()(str));
+#else
+    QSKIP("constexpr not supported by the compiler");
+#endif
+}
+
+void TestCppTools::hash_wy_test()
+{
+    const cpp::hash_wy hash;
+    std::set<cpp::hash_wy::uint_type> hashSet;
+    std::string byteSeq;
+    // Cover empty, tail-only, full block and block + tail byte sequences
+    for (int len = 0; len <= 40; ++len) {
+        const std::list<char> byteList(byteSeq.cbegin(), byteSeq.cend());
+        const auto byteSeqHash = hash(byteSeq.c_str(), byteSeq.size());
+        QCOMPARE(hash(byteSeq.c_str()), byteSeqHash);
+        QCOMPARE(hash(byteList.cbegin(), byteList.cend()), byteSeqHash);
+        hashSet.insert(byteSeqHash);
+
+        // Zero bytes must change the hash
+        const std::string zeroSeq(len + 1, '\0');
+        hashSet.insert(hash(zeroSeq.data(), zeroSeq.size()));
+
+        byteSeq.push_back(static_cast<char>('a' + len % 26));
+    }
+    QCOMPARE(hashSet.size(), static_cast<std::size_t>(2 * 41));
+
+    QVERIFY(cpp::hash_wy(1)("seed") != cpp::hash_wy(2)("seed"));
+}
+
+void TestCppTools::hash_benchmark_data()
+{
+    QTest::addColumn<int>("hashKind");
+    QTest::addColumn<int>("len");
+
+    const char* hashNames[] = { "hash64_fnv_1a", "hash_wy", "std::hash<std::string>" };
+    const int lens[] = { 8, 32, 256, 4096 };
+    for (int hashKind : { 0, 1, 2 }) {
+        for (int len : lens) {
+            const QByteArray rowName =
+                    QByteArray(hashNames[hashKind]) + " len=" + QByteArray::number(len);
+            QTest::newRow(rowName.constData()) << hashKind << len;
+        }
+    }
+}
+
+void TestCppTools::hash_benchmark()
+{
+    QFETCH(int, hashKind);
+    QFETCH(int, len);
+    // Sliding offset to prevent hoisting of the hash computation out of loops
+    std::string byteSeq(len + 8, '\0');
+    for (std::size_t i = 0; i < byteSeq.size(); ++i)
+        byteSeq[i] = static_cast<char>(i * 31);
+
+    const int hashCount = 1000;
+    std::uint64_t hashSum = 0;
+    if (hashKind == 0) {
+        const cpp::hash64_fnv_1a hash;
+        QBENCHMARK {
+            for (int i = 0; i < hashCount; ++i)
+                hashSum += hash(byteSeq.data() + (i & 7), len);
+        }
+    }
+    else if (hashKind == 1) {
+        const cpp::hash_wy hash;
+        QBENCHMARK {
+            for (int i = 0; i < hashCount; ++i)
+                hashSum += hash(byteSeq.data() + (i & 7), len);
+        }
+    }
+    else {
+        // std::hash<> needs std::string objects, built out of the loop
+        std::string strs[8];
+        for (int i = 0; i < 8; ++i)
+            strs[i].assign(byteSeq.data() + i, len);
+        const std::hash<std::string> hash;
+        QBENCHMARK {
+            for (int i = 0; i < hashCount; ++i)
+                hashSum += hash(strs[i & 7]);
+        }
+    }
+    QVERIFY(hashSum != 0);
+}
+
 namespace Internal {
 
 enum class Status
@@ -262,6 +1281,13 @@ enum class Status
     Finished
 };
 
+enum SparseStatus
+{
+    SparseStarted = -5,
+    SparseRunning = 10,
+    SparseFinished = 2
+};
+
 } // namespace Internal
 
 void TestCppTools::EnumStringMap_test()
@@ -285,9 +1311,153 @@ void TestCppTools::EnumStringMap_test()
     QCOMPARE(enumMap.value("status_running"), Internal::Status::Running);
     QCOMPARE(enumMap.value("status_finished"), Internal::Status::Finished);
 
+    // Lookup of non NUL-terminated strings
+    const char tokens[] = "status_running status_started";
+    QCOMPARE(enumMap.value(tokens, 14), Internal::Status::Running);
+    QCOMPARE(enumMap.value(tokens + 15, 14), Internal::Status::Started);
+
     QCOMPARE(enumMap.string(Internal::Status::Started), "status_started");
     QCOMPARE(enumMap.string(Internal::Status::Running), "status_running");
     QCOMPARE(enumMap.string(Internal::Status::Finished), "status_finished");
+
+    // Contiguous enum values mapped out of order, indexes follow map() calls
+    cpp::EnumStringMap<Internal::Status> outOfOrderMap;
+    outOfOrderMap.map(Internal::Status::Started, "status_started");
+    outOfOrderMap.map(Internal::Status::Finished, "status_finished");
+    outOfOrderMap.map(Internal::Status::Running, "status_running");
+    QCOMPARE(outOfOrderMap.index(Internal::Status::Finished), static_cast<std::size_t>(1));
+    QCOMPARE(outOfOrderMap.index(Internal::Status::Running), static_cast<std::size_t>(2));
+    QCOMPARE(outOfOrderMap.valueAt(1), Internal::Status::Finished);
+    QCOMPARE(outOfOrderMap.valueAt(2), Internal::Status::Running);
+    QCOMPARE(outOfOrderMap.string(Internal::Status::Running), "status_running");
+
+    // Non contiguous enum values, mapped in any order
+    cpp::EnumStringMap<Internal::SparseStatus> sparseMap;
+    sparseMap.map(Internal::SparseRunning, "sparse_running");
+    sparseMap.map(Internal::SparseFinished, "sparse_finished");
+    sparseMap.map(Internal::SparseStarted, "sparse_started");
+    QCOMPARE(sparseMap.index(Internal::SparseRunning), static_cast<std::size_t>(0));
+    QCOMPARE(sparseMap.index(Internal::SparseStarted), static_cast<std::size_t>(2));
+    QCOMPARE(sparseMap.string(Internal::SparseFinished), "sparse_finished");
+    QCOMPARE(sparseMap.string(Internal::SparseStarted), "sparse_started");
+}
+
+void TestCppTools::EnumStringMap_benchmark_data()
+{
+    QTest::addColumn<int>("mapKind");
+    QTest::newRow("EnumStringMap") << 0;
+    QTest::newRow("std::map") << 1;
+    QTest::newRow("std::unordered_map") << 2;
+}
+
+namespace Internal {
+
+enum class Token { };
+
+} // namespace Internal
+
+// Lookups string -> enum and enum -> string in a map of 64 tokens
+void TestCppTools::EnumStringMap_benchmark()
+{
+    QFETCH(int, mapKind);
+    typedef Internal::Token Token;
+    const int tokenCount = 64;
+    std::vector<std::string> strs;
+    for (int i = 0; i < tokenCount; ++i)
+        strs.push_back("token_" + std::to_string(i * 37));
+
+    int valueSum = 0;
+    std::size_t lenSum = 0;
+    if (mapKind == 0) {
+        cpp::EnumStringMap<Token> enumMap;
+        for (int i = 0; i < tokenCount; ++i)
+            enumMap.map(static_cast<Token>(i), strs.at(i).c_str());
+        QBENCHMARK {
+            for (const std::string& str : strs)
+                valueSum += static_cast<int>(enumMap.value(str.c_str(), str.size()));
+            for (int i = 0; i < tokenCount; ++i)
+                lenSum += std::strlen(enumMap.string(static_cast<Token>(i)));
+        }
+    }
+    else if (mapKind == 1) {
+        std::map<std::string, Token> valueMap;
+        std::map<Token, std::string> stringMap;
+        for (int i = 0; i < tokenCount; ++i) {
+            valueMap.emplace(strs.at(i), static_cast<Token>(i));
+            stringMap.emplace(static_cast<Token>(i), strs.at(i));
+        }
+        QBENCHMARK {
+            for (const std::string& str : strs)
+                valueSum += static_cast<int>(valueMap.find(str)->second);
+            for (int i = 0; i < tokenCount; ++i)
+                lenSum += stringMap.find(static_cast<Token>(i))->second.size();
+        }
+    }
+    else {
+        std::unordered_map<std::string, Token> valueMap;
+        std::unordered_map<int, std::string> stringMap;
+        for (int i = 0; i < tokenCount; ++i) {
+            valueMap.emplace(strs.at(i), static_cast<Token>(i));
+            stringMap.emplace(i, strs.at(i));
+        }
+        QBENCHMARK {
+            for (const std::string& str : strs)
+                valueSum += static_cast<int>(valueMap.find(str)->second);
+            for (int i = 0; i < tokenCount; ++i)
+                lenSum += stringMap.find(i)->second.size();
+        }
+    }
+    QVERIFY(valueSum > 0);
+    QVERIFY(lenSum > 0);
+}
+
+void TestCppTools::StaticEnumStringMap_test()
+{
+    typedef cpp::StaticEnumStringMap<Internal::Status, 3> StatusStrMap;
+    const StatusStrMap::Mapping mappings[] = {
+        { Internal::Status::Running, "status_running" },
+        { Internal::Status::Started, "status_started" },
+        { Internal::Status::Finished, "status_finished" }
+    };
+    const StatusStrMap enumMap(mappings);
+
+    QCOMPARE(enumMap.size(), static_cast<std::size_t>(3));
+    QVERIFY(enumMap.hasContiguousValues());
+
+    QCOMPARE(enumMap.index(Internal::Status::Running), static_cast<std::size_t>(0));
+    QCOMPARE(enumMap.index(Internal::Status::Started), static_cast<std::size_t>(1));
+    QCOMPARE(enumMap.index(Internal::Status::Finished), static_cast<std::size_t>(2));
+
+    QCOMPARE(enumMap.valueAt(0), Internal::Status::Running);
+    QCOMPARE(enumMap.value("status_started"), Internal::Status::Started);
+    QCOMPARE(enumMap.value("status_running"), Internal::Status::Running);
+    QCOMPARE(enumMap.value("status_finished"), Internal::Status::Finished);
+    QVERIFY(!enumMap.contains("status_paused"));
+    QVERIFY(!enumMap.contains(""));
+
+    // Lookup of non NUL-terminated strings
+    const char tokens[] = "status_finished status_running";
+    QCOMPARE(enumMap.value(tokens, 15), Internal::Status::Finished);
+    QCOMPARE(enumMap.value(tokens + 16, 14), Internal::Status::Running);
+    QVERIFY(!enumMap.contains(tokens, 14));
+    QVERIFY(!enumMap.contains(tokens, 16));
+
+    QCOMPARE(enumMap.string(Internal::Status::Started), "status_started");
+    QCOMPARE(enumMap.string(Internal::Status::Running), "status_running");
+    QCOMPARE(enumMap.string(Internal::Status::Finished), "status_finished");
+
+    // Non contiguous enum values
+    typedef cpp::StaticEnumStringMap<Internal::SparseStatus, 3> SparseStrMap;
+    const SparseStrMap::Mapping sparseMappings[] = {
+        { Internal::SparseStarted, "sparse_started" },
+        { Internal::SparseRunning, "sparse_running" },
+        { Internal::SparseFinished, "sparse_finished" }
+    };
+    const SparseStrMap sparseMap(sparseMappings);
+    QVERIFY(!sparseMap.hasContiguousValues());
+    QCOMPARE(sparseMap.index(Internal::SparseRunning), static_cast<std::size_t>(1));
+    QCOMPARE(sparseMap.string(Internal::SparseFinished), "sparse_finished");
+    QCOMPARE(sparseMap.value("sparse_started"), Internal::SparseStarted);
 }
 
 namespace tupleUtils_test {
@@ -310,6 +1480,24 @@ private:
     std::vector<int>* m_intVec;
 };
 
+// Independent "stages", result type depends on the element type
+struct RunStage
+{
+    int operator()(int val) const
+    {
+        ++(*callCount);
+        return val * val;
+    }
+
+    std::string operator()(const char* str) const
+    {
+        ++(*callCount);
+        return std::string(str) + "_done";
+    }
+
+    std::atomic<int>* callCount;
+};
+
 } // namespace tupleUtils_test
 
 void TestCppTools::tupleUtils_test()
@@ -348,6 +1536,37 @@ void TestCppTools::tupleUtils_test()
     cpp::tuple_reversed_for_each(
                 tupleEmpty, tupleUtils_test::RecordInts(&intVec));
     QVERIFY(intVec.empty());
+
+    // Test with a tuple bigger than the recursion depth of older versions
+    intVec.clear();
+    const auto tupleBig = std::make_tuple(
+                0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19);
+    cpp::tuple_reversed_for_each(tupleBig, tupleUtils_test::RecordInts(&intVec));
+    QCOMPARE(intVec.size(), static_cast<std::size_t>(20));
+    QCOMPARE(intVec.front(), 19);
+    QCOMPARE(intVec.back(), 0);
+}
+
+void TestCppTools::tupleUtils_parallel_test()
+{
+    std::atomic<int> callCount(0);
+    const tupleUtils_test::RunStage runStage = { &callCount };
+    const auto stages = std::make_tuple(2, "mesh", 3, "export", 4);
+
+    cpp::tuple_parallel_for_each(stages, runStage, 4);
+    QCOMPARE(callCount.load(), 5);
+
+    const auto results = cpp::tuple_parallel_transform(stages, runStage);
+    QCOMPARE(callCount.load(), 10);
+    QCOMPARE(std::get<0>(results), 4);
+    QCOMPARE(std::get<1>(results), std::string("mesh_done"));
+    QCOMPARE(std::get<2>(results), 9);
+    QCOMPARE(std::get<3>(results), std::string("export_done"));
+    QCOMPARE(std::get<4>(results), 16);
+
+    // Empty tuple
+    cpp::tuple_parallel_for_each(std::make_tuple(), runStage);
+    QCOMPARE(callCount.load(), 10);
 }
 
 // --
@@ -361,6 +1580,14 @@ typedef cpp::Quantity<cpp::IntNumericTraits, LengthTrait> Length_i;
 struct AngleTrait {};
 typedef cpp::Quantity<cpp::DoubleNumericTraits, AngleTrait> Angle;
 
+// Dimension exponents : length, time
+typedef cpp::Quantity<cpp::DoubleNumericTraits, cpp::QuantityDimension<1, 0>> DimLength;
+typedef cpp::Quantity<cpp::DoubleNumericTraits, cpp::QuantityDimension<2, 0>> DimArea;
+typedef cpp::Quantity<cpp::DoubleNumericTraits, cpp::QuantityDimension<3, 0>> DimVolume;
+typedef cpp::Quantity<cpp::DoubleNumericTraits, cpp::QuantityDimension<0, 1>> DimTime;
+typedef cpp::Quantity<cpp::DoubleNumericTraits, cpp::QuantityDimension<1, -1>> DimSpeed;
+typedef cpp::Quantity<cpp::DoubleNumericTraits, cpp::QuantityDimension<0, 0>> DimScalar;
+
 void TestCppTools::Quantity_test()
 {
     Length length1(1.);
@@ -370,6 +1597,16 @@ void TestCppTools::Quantity_test()
     //qDebug() << length1 << length2;
 
     QCOMPARE(sizeof(Length), sizeof(double));
+    static_assert(std::is_trivially_copyable<Length>::value, "Copies must be memcpy");
+#ifdef CPPTOOLS_HAVE_CONSTEXPR
+    static_assert(noexcept(Length(1.) * 2. + Length(3.)), "Arithmetic must be noexcept");
+    constexpr Length_i constLength = Length_i(2) * 3 + Length_i(4);
+    static_assert(constLength.value() == 10, "Arithmetic must be constexpr");
+#endif
+
+    Length_i length4(5);
+    length4 += length4;
+    QCOMPARE(length4.value(), 10);
 }
 
 void TestCppTools::Quantity_operators_test()
@@ -386,22 +1623,97 @@ void TestCppTools::Quantity_operators_test()
     QCOMPARE((2 - Length_i(15)).value(), 13);
 }
 
+namespace Internal {
+
+inline double lengthValue(double length) { return length; }
+inline double lengthValue(Length length) { return length.value(); }
+
+// Same tight loops on arrays of Length and of double, timings must be equal
+template<typename LENGTH>
+double quantityBenchmarkLoop(std::vector<LENGTH>* lengths, const std::vector<LENGTH>& offsets)
+{
+    for (std::size_t i = 0; i < lengths->size(); ++i)
+        (*lengths)[i] = (*lengths)[i] * 0.5 + offsets[i];
+    LENGTH sum(0.);
+    for (const LENGTH& length : *lengths)
+        sum += length;
+    return Internal::lengthValue(sum);
+}
+
+} // namespace Internal
+
+void TestCppTools::Quantity_dimension_test()
+{
+    const DimLength length(2.);
+    const DimArea area = length * DimLength(3.);
+    const DimVolume volume = area * length;
+    QCOMPARE(area.value(), 6.);
+    QCOMPARE(volume.value(), 12.);
+    QCOMPARE((volume / area).value(), 2.);
+
+    const DimSpeed speed = DimLength(10.) / DimTime(4.);
+    QCOMPARE(speed.value(), 2.5);
+    QCOMPARE((speed * DimTime(2.)).value(), 5.);
+
+    const DimScalar ratio = length / DimLength(4.);
+    QCOMPARE(ratio.value(), 0.5);
+
+    // Other operators keep the dimension
+    QCOMPARE((area + area * 2.).value(), 18.);
+    static_assert(std::is_same<decltype(length * length), const DimArea>::value,
+                  "Length*Length must be an area");
+    static_assert(sizeof(DimVolume) == sizeof(double), "No storage overhead");
+
+    // Quantities with a plain TRAIT are unchanged by products
+    static_assert(std::is_same<decltype(Length(1.) * Length(2.)), const Length>::value,
+                  "Length*Length stays a Length without dimension");
+}
+
+void TestCppTools::QuantityArray_test()
+{
+    cpp::QuantityArray<Length> lengths(3, Length(2.));
+    QCOMPARE(lengths.size(), static_cast<std::size_t>(3));
+    lengths.set(1, Length(4.));
+    lengths.push_back(Length(8.));
+    QCOMPARE(lengths[1].value(), 4.);
+    QCOMPARE(lengths.at(3).value(), 8.);
+    QCOMPARE(lengths.data()[3], 8.);
+
+    // Batch conversion, mm -> cm
+    std::vector<double> lengthsCm(lengths.size());
+    lengths.scaledCopy(0.1, lengthsCm.data());
+    QVERIFY(lengthsCm == std::vector<double>({0.2, 0.4, 0.2, 0.8}));
+
+    lengths.scale(0.5);
+    QCOMPARE(lengths[0].value(), 1.);
+    QCOMPARE(lengths[3].value(), 4.);
+
+    lengths.clear();
+    QVERIFY(lengths.empty());
+}
+
 void TestCppTools::Quantity_benchmark1()
 {
-    //  QBENCHMARK {
-    //    Length length;
-    //    for (int i = 0; i < 100000000; ++i)
-    //      length = Length(i + length);
-    //    qDebug() << length.value();
-    //  }
+    std::vector<Length> lengths(4096, Length(1.));
+    std::vector<Length> offsets;
+    for (int i = 0; i < 4096; ++i)
+        offsets.push_back(Length(i % 7));
+    double sum = 0.;
+    QBENCHMARK {
+        sum = Internal::quantityBenchmarkLoop(&lengths, offsets);
+    }
+    QVERIFY(sum > 0.);
 }
 
 void TestCppTools::Quantity_benchmark2()
 {
-    //  QBENCHMARK {
-    //    double length = 0;
-    //    for (int i = 0; i < 100000000; ++i)
-    //      length = i + length;
-    //    qDebug() << length;
-    //  }
+    std::vector<double> lengths(4096, 1.);
+    std::vector<double> offsets;
+    for (int i = 0; i < 4096; ++i)
+        offsets.push_back(i % 7);
+    double sum = 0.;
+    QBENCHMARK {
+        sum = Internal::quantityBenchmarkLoop(&lengths, offsets);
+    }
+    QVERIFY(sum > 0.);
 }
@@ -9,18 +9,46 @@ class TestCppTools : public QObject
 
 private slots:
     void BasicSharedPointer_test();
+    void BasicSharedPointer_benchmark_data();
+    void BasicSharedPointer_benchmark();
+    void BasicIntrusivePointer_test();
 
     void cArrayUtils_test();
+    void FixedArray_test();
+    void FixedArray_benchmark_data();
+    void FixedArray_benchmark();
+    void SmallVector_test();
     void ScopedValue_test();
     void circularIterator_test();
+    void RingBuffer_test();
+    void MpmcQueue_test();
+    void MpmcQueue_benchmark_data();
+    void MpmcQueue_benchmark();
+    void TreeBfsExplorer_test();
+    void TreeBfsExplorer_benchmark_data();
+    void TreeBfsExplorer_benchmark();
+    void TreeDfsExplorer_test();
+    void parallelTreeBfs_test();
     void memoryUtils_test();
+    void memoryArena_test();
     void pusher_test();
+    void profiling_test();
     void hash_fnv_test();
+    void hash_fnv_constexpr_test();
+    void hash_wy_test();
+    void hash_benchmark_data();
+    void hash_benchmark();
     void EnumStringMap_test();
+    void EnumStringMap_benchmark_data();
+    void EnumStringMap_benchmark();
+    void StaticEnumStringMap_test();
     void tupleUtils_test();
+    void tupleUtils_parallel_test();
 
     void Quantity_test();
     void Quantity_operators_test();
+    void Quantity_dimension_test();
+    void QuantityArray_test();
     void Quantity_benchmark1();
     void Quantity_benchmark2();
 };
@@ -0,0 +1,185 @@
+#include "test_mathtools.h"
+#include "../src/mathtools/cpp_fixed_array_traits.h"
+
+#include "../src/mathtools/euclidean_norm.h"
+#include "../src/mathtools/manhattan_norm.h"
+#include "../src/mathtools/maximum_norm.h"
+#include "../src/mathtools/sqr_euclidean_norm.h"
+#include "../src/mathtools/vec_views.h"
+
+#include <cmath>
+#include <vector>
+
+void TestMathTools::Norm_test()
+{
+    const double vec3[] = { 3., -4., 12. };
+    QCOMPARE(math::EuclideanNorm::fromArray(vec3), 13.);
+    QCOMPARE(math::SqrEuclideanNorm::fromArray(vec3), 169.);
+    QCOMPARE(math::ManhattanNorm::fromArray(vec3), 19.);
+    QCOMPARE(math::MaximumNorm::fromArray(vec3), 12.);
+    QCOMPARE(math::MaximumNorm::fromRange(vec3, vec3 + 3), 12.);
+    QCOMPARE(math::KahanEuclideanNorm::fromArray(vec3), 13.);
+    QCOMPARE(math::BlockedManhattanNorm::fromRange(vec3, vec3 + 3), 19.);
+    QCOMPARE(math::EuclideanNorm::fromObject(math::StridedVecView<double, 3>(vec3)), 13.);
+
+    cpp::FixedArray<double, 3, 32> fixedVec3;
+    std::copy(vec3, vec3 + 3, fixedVec3.begin());
+    QCOMPARE(math::EuclideanNorm::fromObject(fixedVec3), 13.);
+    QCOMPARE(math::MaximumNorm::fromObject(fixedVec3 * 2.), 24.);
+
+    // Batch versions
+    const double packed[] = { 3., 4., 0., 0., -6., 8. };
+    double norms[2];
+    math::EuclideanNorm::fromPackedArray<3>(packed, 2, norms);
+    QCOMPARE(norms[0], 5.);
+    QCOMPARE(norms[1], 10.);
+    math::MaximumNorm::fromStridedArray<2>(packed + 1, 3, 2, norms);
+    QCOMPARE(norms[0], 4.);
+    QCOMPARE(norms[1], 8.);
+    const double x[] = { 3., 0. };
+    const double y[] = { 4., -6. };
+    const double z[] = { 0., 8. };
+    const double* const xyz[] = { x, y, z };
+    math::EuclideanNorm::fromSoaArrays<3>(xyz, 2, norms);
+    QCOMPARE(norms[0], 5.);
+    QCOMPARE(norms[1], 10.);
+
+    // Compensated summation of a long vector
+    const std::vector<float> vecLong(1000000, 0.1f);
+    const double exactSqrNorm = 1000000 * double(0.1f) * double(0.1f);
+    const float kahanSqrNorm =
+            math::KahanSqrEuclideanNorm::fromRange(vecLong.cbegin(), vecLong.cend());
+    QVERIFY(std::abs(kahanSqrNorm - exactSqrNorm) < 1e-3 * exactSqrNorm);
+}
+
+namespace internal {
+
+enum NormPath
+{
+    FromRangePath,
+    FromRangeBlockedPath,
+    FromRangeKahanPath,
+    FromPtrPath,
+    FromArrayPath,
+    FromObjectPath,
+    FromPackedArrayPath,
+    FromSoaArraysPath
+};
+
+// Total count of coordinates processed by each benchmark row
+static const std::size_t benchmarkCoordCount = 1 << 20;
+
+template<typename T, std::size_t N>
+static void benchmarkNorm(NormPath path)
+{
+    const std::size_t vecCount = benchmarkCoordCount / N;
+    std::vector<T> coords(vecCount * N);
+    for (std::size_t i = 0; i < coords.size(); ++i)
+        coords[i] = static_cast<T>(std::sin(static_cast<double>(i)));
+    std::vector<std::vector<T>> soaCoords(N, std::vector<T>(vecCount));
+    const T* soaPtrs[N];
+    for (std::size_t k = 0; k < N; ++k) {
+        for (std::size_t i = 0; i < vecCount; ++i)
+            soaCoords[k][i] = coords[i * N + k];
+        soaPtrs[k] = soaCoords[k].data();
+    }
+    std::vector<T> norms(vecCount);
+    const T* vecs = coords.data();
+
+    QBENCHMARK {
+        switch (path) {
+        case FromRangePath:
+            for (std::size_t i = 0; i < vecCount; ++i)
+                norms[i] = math::EuclideanNorm::fromRange(vecs + i * N, vecs + (i + 1) * N);
+            break;
+        case FromRangeBlockedPath:
+            for (std::size_t i = 0; i < vecCount; ++i)
+                norms[i] = math::BlockedEuclideanNorm::fromRange(vecs + i * N, vecs + (i + 1) * N);
+            break;
+        case FromRangeKahanPath:
+            for (std::size_t i = 0; i < vecCount; ++i)
+                norms[i] = math::KahanEuclideanNorm::fromRange(vecs + i * N, vecs + (i + 1) * N);
+            break;
+        case FromPtrPath:
+            for (std::size_t i = 0; i < vecCount; ++i)
+                norms[i] = math::EuclideanNorm::fromPtr<N, T>(vecs + i * N);
+            break;
+        case FromArrayPath:
+            for (std::size_t i = 0; i < vecCount; ++i) {
+                const T (&array)[N] = *reinterpret_cast<const T(*)[N]>(vecs + i * N);
+                norms[i] = math::EuclideanNorm::fromArray(array);
+            }
+            break;
+        case FromObjectPath:
+            for (std::size_t i = 0; i < vecCount; ++i) {
+                const math::StridedVecView<T, N> view(vecs + i * N);
+                norms[i] = math::EuclideanNorm::fromObject(view);
+            }
+            break;
+        case FromPackedArrayPath:
+            math::EuclideanNorm::fromPackedArray<N>(vecs, vecCount, norms.data());
+            break;
+        case FromSoaArraysPath:
+            math::EuclideanNorm::fromSoaArrays<N>(soaPtrs, vecCount, norms.data());
+            break;
+        }
+    }
+}
+
+template<typename T>
+static void benchmarkNorm(NormPath path, int dim)
+{
+    switch (dim) {
+    case 2: benchmarkNorm<T, 2>(path); break;
+    case 3: benchmarkNorm<T, 3>(path); break;
+    case 4: benchmarkNorm<T, 4>(path); break;
+    case 16: benchmarkNorm<T, 16>(path); break;
+    case 1024: benchmarkNorm<T, 1024>(path); break;
+    default: QFAIL("Unsupported dimension");
+    }
+}
+
+} // namespace internal
+
+void TestMathTools::Norm_benchmark_data()
+{
+    QTest::addColumn<int>("path");
+    QTest::addColumn<int>("dim");
+    QTest::addColumn<bool>("isFloat");
+
+    const struct { internal::NormPath path; const char* name; } paths[] = {
+        { internal::FromRangePath, "fromRange" },
+        { internal::FromRangeBlockedPath, "fromRange(Blocked)" },
+        { internal::FromRangeKahanPath, "fromRange(Kahan)" },
+        { internal::FromPtrPath, "fromPtr" },
+        { internal::FromArrayPath, "fromArray" },
+        { internal::FromObjectPath, "fromObject(StridedVecView)" },
+        { internal::FromPackedArrayPath, "fromPackedArray" },
+        { internal::FromSoaArraysPath, "fromSoaArrays" }
+    };
+    const int dims[] = { 2, 3, 4, 16, 1024 };
+    for (bool isFloat : { true, false }) {
+        for (int dim : dims) {
+            for (const auto& path : paths) {
+                const QByteArray rowName =
+                        QByteArray(path.name)
+                        + (isFloat ? " float" : " double")
+                        + " N=" + QByteArray::number(dim);
+                QTest::newRow(rowName.constData())
+                        << static_cast<int>(path.path) << dim << isFloat;
+            }
+        }
+    }
+}
+
+void TestMathTools::Norm_benchmark()
+{
+    QFETCH(int, path);
+    QFETCH(int, dim);
+    QFETCH(bool, isFloat);
+    const auto normPath = static_cast<internal::NormPath>(path);
+    if (isFloat)
+        internal::benchmarkNorm<float>(normPath, dim);
+    else
+        internal::benchmarkNorm<double>(normPath, dim);
+}
@@ -0,0 +1,13 @@
+#pragma once
+
+#include <QtTest/QTest>
+
+class TestMathTools : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void Norm_test();
+    void Norm_benchmark_data();
+    void Norm_benchmark();
+};
@@ -1,8 +1,59 @@
 #include "test_occtools.h"
 
+#include "../src/occtools/ais_scene_bounds.h"
+#include "../src/occtools/ais_text.h"
+#include "../src/occtools/brep_point_on_faces_projection.h"
+#include "../src/occtools/gcpnts_uniform_abscissa_sampler.h"
+#include "../src/occtools/geom_utils.h"
 #include "../src/occtools/io.h"
+#include "../src/occtools/math_utils.h"
+#include "../src/occtools/memory_report.h"
+#include "../src/occtools/mesh_deviation_analysis.h"
+#include "../src/occtools/point_on_faces_projector.h"
+#include "../src/occtools/poly_triangulation_normals.h"
+#include "../src/occtools/shape_properties_cache.h"
+#include "../src/occtools/topods_shape_maps.h"
+#include "../src/occtools/topods_utils.h"
 
+#include <AIS_Shape.hxx>
+#include <BRepAdaptor_Curve.hxx>
+#include <BRepBuilderAPI_MakeEdge.hxx>
+#include <BRepMesh_IncrementalMesh.hxx>
+#include <BRepPrimAPI_MakeBox.hxx>
+#include <BRepPrimAPI_MakeSphere.hxx>
+#include <BRep_Tool.hxx>
+#include <GCPnts_UniformAbscissa.hxx>
+#include <Geom_Circle.hxx>
+#include <GeomAdaptor_Curve.hxx>
+#include <Poly_Triangulation.hxx>
+#include <TopExp_Explorer.hxx>
+#include <TopoDS.hxx>
+#include <TopoDS_Vertex.hxx>
+#include <gp.hxx>
+#include <gp_Quaternion.hxx>
+
+#include <QtCore/QBuffer>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+#include <QtCore/QTemporaryDir>
 #include <QtCore/QtDebug>
+#include <QtCore/QtGlobal>
+
+#ifdef Q_OS_UNIX
+# include <sys/resource.h>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <map>
+#include <string>
+#include <vector>
 
 static const char igesData1[] =
         "                                                                        S0000001\n"
@@ -58,5 +109,1199 @@ void TestOccTools::IO_test()
     QCOMPARE(partFormatFromTestData(asciiStlData1), occ::IO::AsciiStlFormat);
 
     // Binary STL
+    {
+        std::vector<char> binaryStlData(84 + 2 * 50, 0);
+        binaryStlData[80] = 2; // Facet count (little-endian)
+        QCOMPARE(occ::IO::partFormatFromContents(
+                     binaryStlData.data(), binaryStlData.size(), binaryStlData.size()),
+                 occ::IO::BinaryStlFormat);
+    }
+}
+
+namespace internal {
+
+static int faceCount(const TopoDS_Shape& shape)
+{
+    int count = 0;
+    for (TopExp_Explorer exp(shape, TopAbs_FACE); exp.More(); exp.Next())
+        ++count;
+    return count;
+}
+
+// Peak resident memory of the process, in KiB (-1 if not supported)
+static long peakResidentMemoryKiB()
+{
+#ifdef Q_OS_UNIX
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) == 0) {
+# ifdef Q_OS_MAC
+        return usage.ru_maxrss / 1024; // Bytes on macOS
+# else
+        return usage.ru_maxrss;
+# endif
+    }
+#endif
+    return -1;
+}
+
+// Prints throughput of a QBENCHMARK loop and growth of the peak memory
+static void reportBenchmarkStats(
+        const char* itemName,
+        double itemCount,
+        qint64 elapsedNSec,
+        long peakMemoryBeforeKiB)
+{
+    const double itemsPerSec =
+            elapsedNSec > 0 ? itemCount / (elapsedNSec * 1e-9) : 0.;
+    const long peakMemoryKiB = internal::peakResidentMemoryKiB();
+    qDebug().nospace()
+            << "Throughput: " << itemsPerSec << " " << itemName << "/s"
+            << ", peak memory: " << peakMemoryKiB << "KiB"
+            << " (+" << (peakMemoryKiB - peakMemoryBeforeKiB) << "KiB)";
+}
+
+// Compound of sphereCount spheres and boxes (7 faces each), meshed if
+// meshDeflection > 0
+static TopoDS_Shape makeSpheresCompound(int sphereCount, double meshDeflection)
+{
+    BRep_Builder builder;
+    TopoDS_Compound shapes;
+    builder.MakeCompound(shapes);
+    for (int i = 0; i < sphereCount; ++i) {
+        const gp_Pnt center(3. * (i % 10), 3. * (i / 10), 0.);
+        BRepPrimAPI_MakeSphere makeSphere(center, 1.);
+        builder.Add(shapes, makeSphere.Shape());
+        builder.Add(shapes, BRepPrimAPI_MakeBox(center, 1., 1., 1.).Shape());
+    }
+    if (meshDeflection > 0.)
+        BRepMesh_IncrementalMesh(shapes, meshDeflection);
+    return shapes;
+}
+
+} // namespace internal
+
+void TestOccTools::IO_loadPartFiles_test()
+{
+    QTemporaryDir tempDir;
+    QVERIFY(tempDir.isValid());
+
+    const std::string boxFileName = tempDir.path().toStdString() + "/box.brep";
+    const std::string sphereFileName = tempDir.path().toStdString() + "/sphere.brep";
+    occ::IO::writeBrepFile(BRepPrimAPI_MakeBox(1., 2., 3.).Shape(), boxFileName.c_str());
+    occ::IO::writeBrepFile(BRepPrimAPI_MakeSphere(1.).Shape(), sphereFileName.c_str());
+
+    std::vector<std::string> fileNames;
+    for (int i = 0; i < 8; ++i)
+        fileNames.push_back(i % 2 == 0 ? boxFileName : sphereFileName);
+    fileNames.push_back(tempDir.path().toStdString() + "/not_existing.brep");
+
+    const std::vector<TopoDS_Shape> shapes = occ::IO::loadPartFiles(fileNames);
+    QCOMPARE(shapes.size(), fileNames.size());
+    for (int i = 0; i < 8; ++i)
+        QCOMPARE(internal::faceCount(shapes.at(i)), i % 2 == 0 ? 6 : 1);
+    QVERIFY(shapes.back().IsNull());
+}
+
+void TestOccTools::IO_loadStlFileAsTriangulation_test()
+{
+    QTemporaryDir tempDir;
+    QVERIFY(tempDir.isValid());
+
+    const TopoDS_Shape box = BRepPrimAPI_MakeBox(1., 2., 3.).Shape();
+    BRepMesh_IncrementalMesh(box, 0.1);
+    const std::string asciiFileName = tempDir.path().toStdString() + "/box_ascii.stl";
+    const std::string binaryFileName = tempDir.path().toStdString() + "/box_binary.stl";
+    occ::IO::writeAsciiStlFile(box, asciiFileName.c_str());
+    occ::IO::writeBinaryStlFile(box, binaryFileName.c_str());
+
+    for (const std::string& fileName : { asciiFileName, binaryFileName }) {
+        const Handle_Poly_Triangulation mesh =
+                occ::IO::loadStlFileAsTriangulation(fileName.c_str());
+        QVERIFY(!mesh.IsNull());
+        QCOMPARE(mesh->NbTriangles(), 12);
+        QCOMPARE(mesh->NbNodes(), 8); // Box corners are merged
+    }
+
+    // Shape with no triangulation is meshed while written
+    const std::string sphereFileName = tempDir.path().toStdString() + "/sphere.stl";
+    occ::IO::writeBinaryStlFile(BRepPrimAPI_MakeSphere(1.).Shape(), sphereFileName.c_str());
+    const Handle_Poly_Triangulation sphereMesh =
+            occ::IO::loadStlFileAsTriangulation(sphereFileName.c_str());
+    QVERIFY(!sphereMesh.IsNull());
+    QVERIFY(sphereMesh->NbTriangles() > 0);
+
+    const std::string notExistingFileName = tempDir.path().toStdString() + "/none.stl";
+    QVERIFY(occ::IO::loadStlFileAsTriangulation(notExistingFileName.c_str()).IsNull());
+}
+
+void TestOccTools::IO_loadPartFromContents_test()
+{
+    QTemporaryDir tempDir;
+    QVERIFY(tempDir.isValid());
+
+    const TopoDS_Shape box = BRepPrimAPI_MakeBox(1., 2., 3.).Shape();
+    const QString brepFileName = tempDir.path() + "/box.brep";
+    const QString stepFileName = tempDir.path() + "/box.step";
+    occ::IO::writeBrepFile(box, brepFileName.toLocal8Bit().constData());
+    occ::IO::writeStepFile(box, stepFileName.toLocal8Bit().constData());
+
+    for (const QString& fileName : { brepFileName, stepFileName }) {
+        QFile file(fileName);
+        QVERIFY(file.open(QIODevice::ReadOnly));
+        QByteArray contents = file.readAll();
+        const TopoDS_Shape shape =
+                occ::IO::loadPartFromContents(contents.constData(), contents.size());
+        QCOMPARE(internal::faceCount(shape), 6);
+
+        QBuffer buffer(&contents);
+        QVERIFY(buffer.open(QIODevice::ReadOnly));
+        QCOMPARE(occ::IO::partFormatFromDevice(&buffer),
+                 fileName == brepFileName ? occ::IO::OccBrepFormat : occ::IO::StepFormat);
+        QCOMPARE(buffer.pos(), qint64(0));
+        QCOMPARE(internal::faceCount(occ::IO::loadPartFromDevice(&buffer)), 6);
+    }
+}
+
+void TestOccTools::IO_loadStepFileByRoots_test()
+{
+    QTemporaryDir tempDir;
+    QVERIFY(tempDir.isValid());
+
+    const QString stepFileName = tempDir.path() + "/box.step";
+    QVERIFY(occ::IO::writeStepFile(
+                BRepPrimAPI_MakeBox(1., 2., 3.).Shape(),
+                stepFileName.toLocal8Bit().constData()));
+
+    int rootShapeFaceCount = 0;
+    int lastRootIndex = 0;
+    const TopoDS_Shape shape = occ::IO::loadStepFileByRoots(
+                stepFileName.toLocal8Bit().constData(),
+                [&] (const TopoDS_Shape& rootShape, int rootIndex, int rootCount) {
+        QVERIFY(rootIndex > lastRootIndex && rootIndex <= rootCount);
+        lastRootIndex = rootIndex;
+        rootShapeFaceCount += internal::faceCount(rootShape);
+    });
+    QVERIFY(lastRootIndex > 0);
+    QCOMPARE(rootShapeFaceCount, 6);
+    QCOMPARE(internal::faceCount(shape), 6);
+}
+
+void TestOccTools::IO_loadPartFileCached_test()
+{
+    QTemporaryDir tempDir;
+    QVERIFY(tempDir.isValid());
+
+    const QString stepFileName = tempDir.path() + "/box.step";
+    occ::IO::writeStepFile(
+                BRepPrimAPI_MakeBox(1., 2., 3.).Shape(),
+                stepFileName.toLocal8Bit().constData());
+    const std::string cacheDirPath = tempDir.path().toStdString() + "/cache";
+
+    // Cache miss then hit
+    for (int i = 0; i < 2; ++i) {
+        const TopoDS_Shape shape = occ::IO::loadPartFileCached(
+                    stepFileName.toLocal8Bit().constData(), cacheDirPath);
+        QCOMPARE(internal::faceCount(shape), 6);
+        QCOMPARE(QDir(QString::fromStdString(cacheDirPath)).entryList(QDir::Files).size(), 1);
+    }
+}
+
+void TestOccTools::IO_loadPartFile_benchmark_data()
+{
+    QTest::addColumn<int>("format");
+    QTest::newRow("IGES") << static_cast<int>(occ::IO::IgesFormat);
+    QTest::newRow("STEP") << static_cast<int>(occ::IO::StepFormat);
+    QTest::newRow("OccBrep") << static_cast<int>(occ::IO::OccBrepFormat);
+    QTest::newRow("AsciiStl") << static_cast<int>(occ::IO::AsciiStlFormat);
+    QTest::newRow("BinaryStl") << static_cast<int>(occ::IO::BinaryStlFormat);
+}
+
+void TestOccTools::IO_loadPartFile_benchmark()
+{
+    QFETCH(int, format);
+    QTemporaryDir tempDir;
+    QVERIFY(tempDir.isValid());
+
+    const TopoDS_Shape shapes = internal::makeSpheresCompound(20, 0.01);
+    const std::string fileName = tempDir.path().toStdString() + "/shapes.part";
+    switch (format) {
+    case occ::IO::IgesFormat:
+        occ::IO::writeIgesFile(shapes, fileName.c_str());
+        break;
+    case occ::IO::StepFormat:
+        occ::IO::writeStepFile(shapes, fileName.c_str());
+        break;
+    case occ::IO::OccBrepFormat:
+        occ::IO::writeBrepFile(shapes, fileName.c_str());
+        break;
+    case occ::IO::AsciiStlFormat:
+        occ::IO::writeAsciiStlFile(shapes, fileName.c_str());
+        break;
+    case occ::IO::BinaryStlFormat:
+        occ::IO::writeBinaryStlFile(shapes, fileName.c_str());
+        break;
+    }
+    QCOMPARE(static_cast<int>(occ::IO::partFormat(fileName.c_str())), format);
+    const qint64 fileSize = QFileInfo(QString::fromStdString(fileName)).size();
+
+    const long peakMemoryBeforeKiB = internal::peakResidentMemoryKiB();
+    int iterationCount = 0;
+    QElapsedTimer chrono;
+    chrono.start();
+    QBENCHMARK {
+        const TopoDS_Shape shape = occ::IO::loadPartFile(fileName.c_str());
+        QVERIFY(!shape.IsNull());
+        ++iterationCount;
+    }
+    internal::reportBenchmarkStats(
+                "bytes",
+                static_cast<double>(iterationCount) * fileSize,
+                chrono.nsecsElapsed(),
+                peakMemoryBeforeKiB);
+}
+
+void TestOccTools::PointOnFacesProjector_test()
+{
+    const TopoDS_Shape box = BRepPrimAPI_MakeBox(10., 10., 10.).Shape();
+    BRepMesh_IncrementalMesh(box, 0.1);
+
+    occ::PointOnFacesProjector projector(
+                box, occ::PointOnFacesProjector::TriangleBvhIndex);
+    const gp_Pnt pnt(5., 5., 20.);
+    const occ::PointOnFacesProjector::Result result = projector.projected(pnt);
+    QVERIFY(result.isValid);
+    QVERIFY(result.point.IsEqual(gp_Pnt(5., 5., 10.), 1e-6));
+    QVERIFY(result.normal.Z() > 0.);
+    QVERIFY(projector.faceOfProjection(pnt)->IsSame(result.face));
+
+    // Batch projection
+    std::vector<gp_Pnt> points;
+    for (int i = 0; i < 1000; ++i)
+        points.emplace_back(i * 0.01, 5., 20. + i * 0.02);
+    std::vector<occ::PointOnFacesProjector::Result> results(points.size());
+    projector.projected(points.data(), points.size(), results.data());
+    for (std::size_t i = 0; i < points.size(); ++i)
+        QVERIFY(results.at(i).point.IsEqual(projector.projected(points.at(i)).point, 1e-9));
+
+    // Face queries on bounding boxes
+    QVERIFY(projector.candidateFaces(pnt, 0.).empty());
+    const std::vector<const TopoDS_Face*> candidates = projector.candidateFaces(pnt, 12.);
+    QCOMPARE(candidates.size(), static_cast<std::size_t>(5)); // All but the bottom face
+    QVERIFY(candidates.front()->IsSame(result.face));
+    QCOMPARE(projector.candidateFaces(gp_Pnt(5., 5., 5.), 5.).size(), static_cast<std::size_t>(6));
+    for (const gp_Pnt& point : { gp_Pnt(5., 5., 10.01), gp_Pnt(-1., 5., 5.), gp_Pnt(3., 4., 0.) })
+        QVERIFY(projector.faceOfProjection(point)->IsSame(projector.projected(point).face));
+
+    // Add/remove faces, returned face pointers stay valid
+    const TopoDS_Face* ptrSideFace = projector.faceOfProjection(gp_Pnt(-1., 5., 5.));
+    const TopoDS_Face sideFace = *ptrSideFace;
+    QVERIFY(projector.removeFace(result.face));
+    QVERIFY(!projector.removeFace(result.face));
+    const occ::PointOnFacesProjector::Result resultRemoved = projector.projected(pnt);
+    QVERIFY(resultRemoved.isValid);
+    QVERIFY(!resultRemoved.face.IsSame(result.face));
+    projector.addFaces(result.face);
+    QVERIFY(projector.projected(pnt).face.IsSame(result.face));
+    QVERIFY(ptrSideFace->IsSame(sideFace));
+
+    // Meshing integrated in prepare
+    const TopoDS_Shape otherBox = BRepPrimAPI_MakeBox(10., 10., 10.).Shape();
+    occ::PointOnFacesProjector meshingProjector;
+    meshingProjector.prepareWithMeshing(
+                otherBox, 0.1, occ::PointOnFacesProjector::TriangleBvhIndex);
+    QCOMPARE(meshingProjector.prepareStats().faceCount, static_cast<std::size_t>(6));
+    QVERIFY(meshingProjector.prepareStats().meshingTimeMsec >= 0.);
+    QVERIFY(meshingProjector.projected(pnt).point.IsEqual(gp_Pnt(5., 5., 10.), 1e-6));
+
+    // Serialized index, used in place
+    for (occ::PointOnFacesProjector::SpatialIndex index :
+         { occ::PointOnFacesProjector::NodeBvhIndex,
+           occ::PointOnFacesProjector::TriangleBvhIndex })
+    {
+        const occ::PointOnFacesProjector savingProjector(box, index);
+        const std::string blob = savingProjector.saveIndex();
+        QVERIFY(!blob.empty());
+        std::vector<std::uint64_t> alignedBlob(blob.size() / 8 + 1);
+        std::memcpy(alignedBlob.data(), blob.data(), blob.size());
+        const char* blobData = reinterpret_cast<const char*>(alignedBlob.data());
+
+        occ::PointOnFacesProjector loadedProjector;
+        QVERIFY(loadedProjector.loadIndex(box, blobData, blob.size()));
+        QCOMPARE(loadedProjector.prepareStats().faceCount, static_cast<std::size_t>(6));
+        for (const gp_Pnt& point : points) {
+            const occ::PointOnFacesProjector::Result loadedResult =
+                    loadedProjector.projected(point);
+            QVERIFY(loadedResult.isValid);
+            QVERIFY(loadedResult.point.IsEqual(savingProjector.projected(point).point, 1e-9));
+        }
+
+        // Modifications do not write to the blob
+        QVERIFY(loadedProjector.removeFace(result.face));
+        loadedProjector.addFaces(result.face);
+        QVERIFY(std::memcmp(blobData, blob.data(), blob.size()) == 0);
+
+        // Mismatching faces or data
+        QVERIFY(!loadedProjector.loadIndex(result.face, blobData, blob.size()));
+        QVERIFY(!loadedProjector.projected(pnt).isValid);
+        QVERIFY(!loadedProjector.loadIndex(box, blobData, blob.size() / 2));
+
+        // Corrupted data : an out-of-range value in any index array must be
+        // rejected, other corruptions (ex: coordinates) must be safe to query
+        std::size_t rejectedCount = 0;
+        std::vector<std::uint64_t> corruptedBlob(alignedBlob);
+        std::uint32_t* words = reinterpret_cast<std::uint32_t*>(corruptedBlob.data());
+        for (std::size_t i = 0; i < blob.size() / sizeof(std::uint32_t); ++i) {
+            const std::uint32_t word = words[i];
+            words[i] = 0xFFFFFFFF;
+            occ::PointOnFacesProjector corruptedProjector;
+            const char* corruptedData = reinterpret_cast<const char*>(corruptedBlob.data());
+            if (corruptedProjector.loadIndex(box, corruptedData, blob.size())) {
+                for (const gp_Pnt& point : points)
+                    corruptedProjector.projected(point);
+            }
+            else {
+                ++rejectedCount;
+            }
+            words[i] = word;
+        }
+        QVERIFY(rejectedCount > 0);
+    }
+    const occ::PointOnFacesProjector ubTreeProjector(box, occ::PointOnFacesProjector::UBTreeIndex);
+    QVERIFY(ubTreeProjector.saveIndex().empty());
+}
+
+void TestOccTools::PointOnFacesProjector_nodeQueries_test()
+{
+    const TopoDS_Shape box = BRepPrimAPI_MakeBox(10., 10., 10.).Shape();
+    BRepMesh_IncrementalMesh(box, 0.5);
+
+    // Reference : distances to all the triangulation nodes
+    const gp_Pnt pnt(2., 3., 11.);
+    std::vector<double> nodeDistances;
+    for (TopExp_Explorer exp(box, TopAbs_FACE); exp.More(); exp.Next()) {
+        TopLoc_Location loc;
+        const Handle_Poly_Triangulation& triangulation =
+                BRep_Tool::Triangulation(TopoDS::Face(exp.Current()), loc);
+        const TColgp_Array1OfPnt& nodes = triangulation->Nodes();
+        for (int i = nodes.Lower(); i <= nodes.Upper(); ++i)
+            nodeDistances.push_back(nodes(i).Transformed(loc.Transformation()).Distance(pnt));
+    }
+    std::sort(nodeDistances.begin(), nodeDistances.end());
+    const double radius = 2.5;
+    const auto radiusCount = static_cast<std::size_t>(
+                std::upper_bound(nodeDistances.begin(), nodeDistances.end(), radius)
+                - nodeDistances.begin());
+    QVERIFY(radiusCount > 0);
+
+    for (occ::PointOnFacesProjector::SpatialIndex index :
+         { occ::PointOnFacesProjector::UBTreeIndex,
+           occ::PointOnFacesProjector::NodeBvhIndex,
+           occ::PointOnFacesProjector::TriangleBvhIndex })
+    {
+        const occ::PointOnFacesProjector projector(box, index);
+        const std::vector<occ::PointOnFacesProjector::NodeHit> nearest =
+                projector.nearestNodes(pnt, 10);
+        QCOMPARE(nearest.size(), static_cast<std::size_t>(10));
+        for (std::size_t i = 0; i < nearest.size(); ++i) {
+            QVERIFY(std::abs(nearest.at(i).distance - nodeDistances.at(i)) < 1e-9);
+            QVERIFY(std::abs(nearest.at(i).point.Distance(pnt) - nearest.at(i).distance) < 1e-9);
+            QVERIFY(nearest.at(i).face != nullptr);
+        }
+
+        const std::vector<occ::PointOnFacesProjector::NodeHit> inRadius =
+                projector.nodesInRadius(pnt, radius);
+        QCOMPARE(inRadius.size(), radiusCount);
+        QVERIFY(inRadius.back().distance <= radius);
+
+        // A box corner is a node of three faces
+        const std::vector<occ::PointOnFacesProjector::NodeHit> corner =
+                projector.nearestNodes(gp_Pnt(0., 0., 0.), 3);
+        QCOMPARE(corner.size(), static_cast<std::size_t>(3));
+        for (const occ::PointOnFacesProjector::NodeHit& hit : corner)
+            QVERIFY(hit.distance < 1e-9);
+        QVERIFY(!corner.at(0).face->IsSame(*corner.at(1).face));
+
+        // Batch queries
+        const std::vector<gp_Pnt> points(300, pnt);
+        std::vector<std::vector<occ::PointOnFacesProjector::NodeHit>> results(points.size());
+        projector.nearestNodes(points.data(), points.size(), 10, results.data());
+        QCOMPARE(results.back().size(), static_cast<std::size_t>(10));
+        projector.nodesInRadius(points.data(), points.size(), radius, results.data());
+        QCOMPARE(results.front().size(), radiusCount);
+    }
+}
+
+void TestOccTools::MeshDeviationAnalysis_test()
+{
+    const TopoDS_Shape box = BRepPrimAPI_MakeBox(10., 10., 10.).Shape();
+    BRepMesh_IncrementalMesh(box, 0.1);
+    const occ::PointOnFacesProjector projector(
+                box, occ::PointOnFacesProjector::TriangleBvhIndex);
+
+    // 500 points 0.3 above the top face, 500 points 0.6 below (inside)
+    std::vector<gp_Pnt> points;
+    for (int i = 0; i < 1000; ++i) {
+        const double x = 2. + (i % 25) * 0.24;
+        const double y = 2. + (i / 40) * 0.24;
+        points.emplace_back(x, y, i % 2 == 0 ? 10.3 : 9.4);
+    }
+
+    occ::MeshDeviationAnalysis analysis(&projector);
+    analysis.setHistogramRange(-1., 1., 8);
+    analysis.setChunkSize(100);
+    std::vector<double> distances(points.size());
+    const occ::MeshDeviationAnalysis::Stats stats =
+            analysis.analyze(points.data(), points.size(), distances.data());
+    QCOMPARE(stats.vertexCount, points.size());
+    QCOMPARE(stats.projectedCount, points.size());
+    QVERIFY(std::abs(distances.at(0) - 0.3) < 1e-6);
+    QVERIFY(std::abs(distances.at(1) + 0.6) < 1e-6);
+    QVERIFY(std::abs(stats.minSignedDistance + 0.6) < 1e-6);
+    QVERIFY(std::abs(stats.maxSignedDistance - 0.3) < 1e-6);
+    QVERIFY(std::abs(stats.maxAbsDistance - 0.6) < 1e-6);
+    QVERIFY(std::abs(stats.meanSignedDistance + 0.15) < 1e-6);
+    QVERIFY(std::abs(stats.rmsDistance - std::sqrt((0.3 * 0.3 + 0.6 * 0.6) / 2.)) < 1e-6);
+
+    const occ::MeshDeviationAnalysis::Histogram& histo = stats.histogram;
+    QCOMPARE(histo.binCounts.size(), static_cast<std::size_t>(8));
+    QCOMPARE(histo.binWidth(), 0.25);
+    QCOMPARE(histo.binCounts.at(1), static_cast<std::size_t>(500)); // [-0.75, -0.5[
+    QCOMPARE(histo.binCounts.at(5), static_cast<std::size_t>(500)); // [0.25, 0.5[
+    QCOMPARE(histo.underflowCount + histo.overflowCount, static_cast<std::size_t>(0));
+
+    // Same results when vertices are streamed from a triangulation
+    const Handle_Poly_Triangulation mesh =
+            new Poly_Triangulation(static_cast<int>(points.size()), 1, Standard_False);
+    for (std::size_t i = 0; i < points.size(); ++i)
+        mesh->ChangeNodes().SetValue(static_cast<int>(i) + 1, points.at(i));
+    const occ::MeshDeviationAnalysis::Stats meshStats = analysis.analyze(mesh);
+    QCOMPARE(meshStats.projectedCount, stats.projectedCount);
+    QVERIFY(meshStats.histogram.binCounts == stats.histogram.binCounts);
+    QVERIFY(std::abs(meshStats.rmsDistance - stats.rmsDistance) < 1e-9);
+}
+
+void TestOccTools::PointOnFacesProjector_benchmark_data()
+{
+    QTest::addColumn<int>("spatialIndex");
+    QTest::newRow("UBTreeIndex") << static_cast<int>(occ::PointOnFacesProjector::UBTreeIndex);
+    QTest::newRow("NodeBvhIndex") << static_cast<int>(occ::PointOnFacesProjector::NodeBvhIndex);
+    QTest::newRow("TriangleBvhIndex") << static_cast<int>(occ::PointOnFacesProjector::TriangleBvhIndex);
+}
+
+void TestOccTools::PointOnFacesProjector_benchmark()
+{
+    QFETCH(int, spatialIndex);
+    const TopoDS_Shape sphere = BRepPrimAPI_MakeSphere(10.).Shape();
+    BRepMesh_IncrementalMesh(sphere, 0.01);
+    const occ::PointOnFacesProjector projector(
+                sphere,
+                static_cast<occ::PointOnFacesProjector::SpatialIndex>(spatialIndex));
+
+    // Points on a spiral around the sphere
+    std::vector<gp_Pnt> points;
+    for (int i = 0; i < 1000; ++i) {
+        const double t = i * 0.01;
+        points.emplace_back(12. * std::cos(3. * t), 12. * std::sin(3. * t), 10. - 2. * t);
+    }
+
+    QBENCHMARK {
+        for (const gp_Pnt& pnt : points)
+            projector.faceOfProjection(pnt);
+    }
+}
+
+void TestOccTools::PointOnFacesProjector_faceLookup_benchmark_data()
+{
+    QTest::addColumn<bool>("isDenseIndex");
+    QTest::newRow("std::map") << false;
+    QTest::newRow("DenseIndex") << true;
+}
+
+/* Cost of mapping query hits back to their face : std::map keyed on the
+ * triangulation (the former lookup) against direct access by slot index */
+void TestOccTools::PointOnFacesProjector_faceLookup_benchmark()
+{
+    QFETCH(bool, isDenseIndex);
+    const TopoDS_Shape shapes = internal::makeSpheresCompound(50, 0.01);
+    const occ::PointOnFacesProjector projector(
+                shapes, occ::PointOnFacesProjector::TriangleBvhIndex);
+
+    std::vector<TopoDS_Face> faces;
+    std::map<const Poly_Triangulation*, TopoDS_Face> faceMap;
+    for (TopExp_Explorer exp(shapes, TopAbs_FACE); exp.More(); exp.Next()) {
+        const TopoDS_Face& face = TopoDS::Face(exp.Current());
+        TopLoc_Location loc;
+        faceMap.emplace(BRep_Tool::Triangulation(face, loc).operator->(), face);
+        faces.push_back(face);
+    }
+
+    // Hits of points above the grid of shapes, same query set for both rows
+    std::vector<const Poly_Triangulation*> hitTriangulations;
+    std::vector<std::size_t> hitSlotIds;
+    for (int i = 0; i < 1000; ++i) {
+        const gp_Pnt pnt(0.027 * i, 12. * std::fabs(std::sin(0.01 * i)), 2.);
+        const TopoDS_Face* face = projector.faceOfProjection(pnt);
+        QVERIFY(face != nullptr);
+        TopLoc_Location loc;
+        hitTriangulations.push_back(BRep_Tool::Triangulation(*face, loc).operator->());
+        const auto itFace = std::find_if(
+                    faces.cbegin(), faces.cend(),
+                    [=] (const TopoDS_Face& other) { return other.IsSame(*face); } );
+        hitSlotIds.push_back(itFace - faces.cbegin());
+    }
+
+    std::size_t foundCount = 0;
+    QBENCHMARK {
+        foundCount = 0;
+        if (isDenseIndex) {
+            for (std::size_t slotId : hitSlotIds)
+                foundCount += faces[slotId].IsNull() ? 0 : 1;
+        }
+        else {
+            for (const Poly_Triangulation* triangulation : hitTriangulations)
+                foundCount += faceMap.find(triangulation)->second.IsNull() ? 0 : 1;
+        }
+    }
+    QCOMPARE(foundCount, hitSlotIds.size());
+}
+
+void TestOccTools::PointOnFacesProjector_prepare_benchmark_data()
+{
+    this->PointOnFacesProjector_benchmark_data();
+}
+
+void TestOccTools::PointOnFacesProjector_prepare_benchmark()
+{
+    QFETCH(int, spatialIndex);
+    const TopoDS_Shape shapes = internal::makeSpheresCompound(50, 0.01);
+
+    const long peakMemoryBeforeKiB = internal::peakResidentMemoryKiB();
+    int iterationCount = 0;
+    std::size_t faceCount = 0;
+    QElapsedTimer chrono;
+    chrono.start();
+    QBENCHMARK {
+        occ::PointOnFacesProjector projector;
+        projector.prepare(
+                    shapes,
+                    static_cast<occ::PointOnFacesProjector::SpatialIndex>(spatialIndex));
+        faceCount = projector.prepareStats().faceCount;
+        ++iterationCount;
+    }
+    internal::reportBenchmarkStats(
+                "faces",
+                static_cast<double>(iterationCount) * faceCount,
+                chrono.nsecsElapsed(),
+                peakMemoryBeforeKiB);
+}
+
+void TestOccTools::PointOnFacesProjector_batchProjected_benchmark_data()
+{
+    this->PointOnFacesProjector_benchmark_data();
+}
+
+void TestOccTools::PointOnFacesProjector_batchProjected_benchmark()
+{
+    QFETCH(int, spatialIndex);
+    const TopoDS_Shape sphere = BRepPrimAPI_MakeSphere(10.).Shape();
+    BRepMesh_IncrementalMesh(sphere, 0.01);
+    const occ::PointOnFacesProjector projector(
+                sphere,
+                static_cast<occ::PointOnFacesProjector::SpatialIndex>(spatialIndex));
+
+    // Points on a spiral around the sphere
+    std::vector<gp_Pnt> points;
+    for (int i = 0; i < 100000; ++i) {
+        const double t = i * 0.0001;
+        points.emplace_back(12. * std::cos(30. * t), 12. * std::sin(30. * t), 10. - 2. * t);
+    }
+    std::vector<occ::PointOnFacesProjector::Result> results(points.size());
+
+    const long peakMemoryBeforeKiB = internal::peakResidentMemoryKiB();
+    int iterationCount = 0;
+    QElapsedTimer chrono;
+    chrono.start();
+    QBENCHMARK {
+        projector.projected(points.data(), points.size(), results.data());
+        ++iterationCount;
+    }
+    internal::reportBenchmarkStats(
+                "points",
+                static_cast<double>(iterationCount) * points.size(),
+                chrono.nsecsElapsed(),
+                peakMemoryBeforeKiB);
+}
+
+void TestOccTools::BRepPointOnFacesProjection_test()
+{
+    const TopoDS_Shape box = BRepPrimAPI_MakeBox(10., 10., 10.).Shape();
+    occ::BRepPointOnFacesProjection projection(box);
+
+    const gp_Pnt pnt(5., 5., 20.);
+    QVERIFY(projection.compute(pnt).isDone());
+    QVERIFY(projection.solutionPoint().IsEqual(gp_Pnt(5., 5., 10.), 1e-6));
+
+    const occ::BRepPointOnFacesProjection::Result result = projection.projected(pnt);
+    QVERIFY(result.isValid);
+    QVERIFY(result.face.IsSame(projection.solutionFace()));
+    QVERIFY(result.point.IsEqual(projection.solutionPoint(), 1e-9));
+
+    // Batch projection
+    std::vector<gp_Pnt> points;
+    for (int i = 0; i < 100; ++i)
+        points.emplace_back(-5. + i * 0.2, 5., 15. - i * 0.1);
+    std::vector<occ::BRepPointOnFacesProjection::Result> results(points.size());
+    projection.projected(points.data(), points.size(), results.data());
+    for (std::size_t i = 0; i < points.size(); ++i) {
+        projection.compute(points.at(i));
+        QVERIFY(results.at(i).isValid);
+        QVERIFY(results.at(i).point.IsEqual(projection.solutionPoint(), 1e-9));
+    }
+
+    // Coherent queries give the same results as the full search
+    projection.setCoherentQueryEnabled(true);
+    for (int i = 0; i <= 80; ++i) {
+        const gp_Pnt pathPnt(1. + i * 0.1, 5., 20.);
+        QVERIFY(projection.compute(pathPnt).isDone());
+        QVERIFY(projection.solutionPoint().IsEqual(gp_Pnt(1. + i * 0.1, 5., 10.), 1e-6));
+        QVERIFY(projection.solutionFace().IsSame(projection.projected(pathPnt).face));
+    }
+
+    // Lazy allocation of projectors
+    projection.prepare(box, occ::BRepPointOnFacesProjection::LazyAllocation);
+    QCOMPARE(projection.projectorCount(), std::size_t(0));
+    QVERIFY(projection.compute(pnt).isDone());
+    QVERIFY(projection.projectorCount() > 0);
+    QVERIFY(projection.projectorCount() < 6); // Faces far from pnt are pruned
+    projection.setMaxProjectorCount(1);
+    QCOMPARE(projection.projectorCount(), std::size_t(1));
+    QVERIFY(projection.compute(gp_Pnt(5., 5., -10.)).isDone());
+    QVERIFY(projection.solutionPoint().IsEqual(gp_Pnt(5., 5., 0.), 1e-6));
+    QCOMPARE(projection.projectorCount(), std::size_t(1));
+}
+
+void TestOccTools::BRepPointOnFacesProjection_benchmark_data()
+{
+    QTest::addColumn<bool>("isCoherentQuery");
+    QTest::newRow("full_search") << false;
+    QTest::newRow("coherent_query") << true;
+}
+
+void TestOccTools::BRepPointOnFacesProjection_benchmark()
+{
+    QFETCH(bool, isCoherentQuery);
+    const TopoDS_Shape shapes = internal::makeSpheresCompound(20, 0.);
+    occ::BRepPointOnFacesProjection projection(shapes);
+    projection.setCoherentQueryEnabled(isCoherentQuery);
+
+    // Path above the row of spheres
+    std::vector<gp_Pnt> points;
+    for (int i = 0; i < 1000; ++i)
+        points.emplace_back(i * 0.027, 1.5, 2.);
+
+    const long peakMemoryBeforeKiB = internal::peakResidentMemoryKiB();
+    int iterationCount = 0;
+    QElapsedTimer chrono;
+    chrono.start();
+    QBENCHMARK {
+        for (const gp_Pnt& pnt : points)
+            projection.compute(pnt);
+        ++iterationCount;
+    }
+    internal::reportBenchmarkStats(
+                "points",
+                static_cast<double>(iterationCount) * points.size(),
+                chrono.nsecsElapsed(),
+                peakMemoryBeforeKiB);
+}
+
+void TestOccTools::GeomUtils_curveLengths_test()
+{
+    const Handle_Geom_Curve circle1 = new Geom_Circle(gp::XOY(), 1.);
+    const Handle_Geom_Curve circle2 = new Geom_Circle(gp::XOY(), 2.);
+    const double pi = std::acos(-1.);
+
+    const occ::GeomUtils::ParamRange ranges[] = {
+        { 0., pi / 2. }, { pi, pi / 2. }, { 0., 2 * pi }, { 1., 1. },
+        { pi / 4., 3 * pi / 4. }, { 0., pi }
+    };
+    const std::size_t rangeCount = sizeof(ranges) / sizeof(ranges[0]);
+
+    // Many ranges on the same curve
+    double lengths[rangeCount];
+    occ::GeomUtils::curveLengthsBetweenParams(circle1, ranges, rangeCount, lengths);
+    for (std::size_t i = 0; i < rangeCount; ++i) {
+        const double expected = std::abs(ranges[i].second - ranges[i].first);
+        QVERIFY(std::abs(lengths[i] - expected) < 1e-9);
+    }
+
+    // Ranges grouped by curve
+    const Handle_Geom_Curve curves[] = {
+        circle1, circle1, circle1, circle2, circle2, circle2
+    };
+    occ::GeomUtils::curveLengthsBetweenParams(curves, ranges, rangeCount, lengths, 2);
+    for (std::size_t i = 0; i < rangeCount; ++i) {
+        const double radius = i < 3 ? 1. : 2.;
+        const double expected = radius * std::abs(ranges[i].second - ranges[i].first);
+        QVERIFY(std::abs(lengths[i] - expected) < 1e-9);
+    }
+
+    // Full curves
+    const Handle_Geom_Curve fullCurves[] = { circle1, circle2, Handle_Geom_Curve() };
+    double fullLengths[3];
+    occ::GeomUtils::curveLengths(fullCurves, 3, fullLengths, 2);
+    QVERIFY(std::abs(fullLengths[0] - 2 * pi) < 1e-9);
+    QVERIFY(std::abs(fullLengths[1] - 4 * pi) < 1e-9);
+    QCOMPARE(fullLengths[2], 0.);
+}
+
+void TestOccTools::GCPnts_UniformAbscissaSampler_test()
+{
+    const Handle_Geom_Curve circle = new Geom_Circle(gp::XOY(), 2.);
+    const GeomAdaptor_Curve adaptor(circle);
+    const GCPnts_UniformAbscissa ua(adaptor, 9);
+    QVERIFY(ua.IsDone());
+
+    const occ::GCPnts_UniformAbscissaSampler paramSampler(ua);
+    QCOMPARE(paramSampler.count(), static_cast<std::size_t>(ua.NbPoints()));
+    QVERIFY(!paramSampler.hasPoints());
+    QVERIFY(paramSampler.points() == NULL);
+    for (int i = 1; i <= ua.NbPoints(); ++i)
+        QCOMPARE(paramSampler.parameter(i - 1), ua.Parameter(i));
+
+    const occ::GCPnts_UniformAbscissaSampler sampler(ua, circle);
+    QVERIFY(sampler.hasPoints());
+    QCOMPARE(sampler.pointsEnd() - sampler.points(), ua.NbPoints());
+    const double* itParam = sampler.parameters();
+    for (const gp_Pnt* itPnt = sampler.points(); itPnt != sampler.pointsEnd(); ++itPnt) {
+        QVERIFY(itPnt->Distance(circle->Value(*itParam)) < 1e-12);
+        ++itParam;
+    }
+    QVERIFY(itParam == sampler.parametersEnd());
+
+    occ::GCPnts_UniformAbscissaSampler emptySampler;
+    QVERIFY(emptySampler.isEmpty());
+    QVERIFY(emptySampler.parameters() == emptySampler.parametersEnd());
+}
+
+void TestOccTools::GCPnts_UniformAbscissaShapeSampler_test()
+{
+    const TopoDS_Shape box = BRepPrimAPI_MakeBox(1., 2., 3.).Shape();
+    occ::GCPnts_UniformAbscissaShapeSampler sampler;
+    sampler.sampleByPointCount(box, 5, -1., 3);
+    QCOMPARE(sampler.edgeCount(), static_cast<std::size_t>(12));
+    QCOMPARE(sampler.count(), static_cast<std::size_t>(12 * 5));
+    QCOMPARE(sampler.offsets()[12], sampler.count());
+    for (std::size_t i = 0; i < sampler.edgeCount(); ++i) {
+        QCOMPARE(sampler.edgeSampleCount(i), static_cast<std::size_t>(5));
+        const BRepAdaptor_Curve curve(sampler.edge(i));
+        for (std::size_t p = sampler.offsets()[i]; p < sampler.offsets()[i + 1]; ++p)
+            QVERIFY(sampler.points()[p].Distance(curve.Value(sampler.parameters()[p])) < 1e-12);
+    }
+
+    // Edges of length 1, 2 and 3 (4 each), spaced by 0.5
+    sampler.sampleByAbscissa(box, 0.5);
+    QCOMPARE(sampler.count(), static_cast<std::size_t>(4 * (3 + 5 + 7)));
+
+    sampler.clear();
+    QCOMPARE(sampler.edgeCount(), static_cast<std::size_t>(0));
+    QVERIFY(sampler.offsets() == NULL);
+}
+
+void TestOccTools::MathUtils_transformPoints_test()
+{
+    gp_Trsf trsf = occ::MathUtils::transformation(
+                gp_Quaternion(gp_Vec(1., 2., 3.), 0.7), gp_Vec(10., -5., 2.));
+    trsf.SetScaleFactor(1.5);
+
+    const std::size_t count = 7;
+    std::vector<double> xyz(3 * count);
+    std::vector<double> x(count), y(count), z(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        x[i] = xyz[3*i] = 0.5 * i;
+        y[i] = xyz[3*i + 1] = 1. - i;
+        z[i] = xyz[3*i + 2] = 2. * i * i;
+    }
+
+    std::vector<double> xyzTrsf(3 * count);
+    occ::MathUtils::transformPoints(trsf, xyz.data(), xyzTrsf.data(), count);
+    occ::MathUtils::transformPoints(
+                trsf, x.data(), y.data(), z.data(),
+                x.data(), y.data(), z.data(), count);
+    for (std::size_t i = 0; i < count; ++i) {
+        const gp_Pnt expected =
+                gp_Pnt(xyz[3*i], xyz[3*i + 1], xyz[3*i + 2]).Transformed(trsf);
+        QVERIFY(expected.Distance(
+                    gp_Pnt(xyzTrsf[3*i], xyzTrsf[3*i + 1], xyzTrsf[3*i + 2]))
+                < 1e-12);
+        QVERIFY(expected.Distance(gp_Pnt(x[i], y[i], z[i])) < 1e-12);
+    }
+
+    const gp_Vec n = gp_Vec(1., 1., 0.).Normalized();
+    occ::MathUtils::projectPointsOnPlane(n, xyz.data(), xyzTrsf.data(), count);
+    for (std::size_t i = 0; i < count; ++i) {
+        const gp_Pnt expected = occ::MathUtils::projectPointOnPlane(
+                    gp_Pnt(xyz[3*i], xyz[3*i + 1], xyz[3*i + 2]), n);
+        QVERIFY(expected.Distance(
+                    gp_Pnt(xyzTrsf[3*i], xyzTrsf[3*i + 1], xyzTrsf[3*i + 2]))
+                < 1e-12);
+    }
+}
+
+void TestOccTools::MathUtils_projectPointOnTriangles_test()
+{
+    // 11 triangles, so the last block of the kernel is partial
+    const std::size_t count = 11;
+    std::vector<double> v0x, v0y, v0z, v1x, v1y, v1z, v2x, v2y, v2z;
+    std::vector<gp_Pnt> v0, v1, v2;
+    for (std::size_t i = 0; i < count; ++i) {
+        const double k = static_cast<double>(i);
+        v0.push_back(gp_Pnt(k, 0.5 * k, std::cos(k)));
+        v1.push_back(gp_Pnt(k + 1., std::sin(k), 2.));
+        v2.push_back(gp_Pnt(k - 0.5, 3. + k, -1. - k));
+        v0x.push_back(v0.back().X()); v0y.push_back(v0.back().Y()); v0z.push_back(v0.back().Z());
+        v1x.push_back(v1.back().X()); v1y.push_back(v1.back().Y()); v1z.push_back(v1.back().Z());
+        v2x.push_back(v2.back().X()); v2y.push_back(v2.back().Y()); v2z.push_back(v2.back().Z());
+    }
+    const occ::MathUtils::TriangleArrays triangles = {
+        v0x.data(), v0y.data(), v0z.data(),
+        v1x.data(), v1y.data(), v1z.data(),
+        v2x.data(), v2y.data(), v2z.data()
+    };
+
+    const gp_Pnt points[] = {
+        gp_Pnt(0., 0., 0.), gp_Pnt(5., 2., 1.), gp_Pnt(-3., 7., 4.),
+        gp_Pnt(10., 10., -10.), gp_Pnt(20., 0., 0.)
+    };
+    for (const gp_Pnt& pnt : points) {
+        double minSqrDist = std::numeric_limits<double>::max();
+        for (std::size_t i = 0; i < count; ++i) {
+            const gp_Pnt proj =
+                    occ::MathUtils::projectPointOnTriangle(pnt, v0[i], v1[i], v2[i]).first;
+            minSqrDist = std::min(minSqrDist, pnt.SquareDistance(proj));
+        }
+        const occ::MathUtils::TriangleProjection triProj =
+                occ::MathUtils::projectPointOnTriangles(pnt, triangles, count);
+        QVERIFY(triProj.triangleId < count);
+        QVERIFY(std::abs(triProj.squareDistance - minSqrDist) < 1e-9);
+        QVERIFY(triProj.u >= 0. && triProj.v >= 0. && triProj.u + triProj.v <= 1. + 1e-12);
+    }
+
+    QCOMPARE(occ::MathUtils::projectPointOnTriangles(points[0], triangles, 0).squareDistance,
+             std::numeric_limits<double>::max());
+}
+
+void TestOccTools::Poly_TriangulationNormals_test()
+{
+    const TopoDS_Shape box = BRepPrimAPI_MakeBox(10., 10., 10.);
+    BRepMesh_IncrementalMesh mesher(box, 0.1);
+    for (TopExp_Explorer exp(box, TopAbs_FACE); exp.More(); exp.Next()) {
+        const TopoDS_Face& face = TopoDS::Face(exp.Current());
+        TopLoc_Location loc;
+        const Handle_Poly_Triangulation& triangulation =
+                BRep_Tool::Triangulation(face, loc);
+        QVERIFY(!triangulation.IsNull());
+
+        const occ::Poly_TriangulationNormals normals(
+                    triangulation, face.Orientation());
+        QVERIFY(normals.hasTriangleNormals());
+        QVERIFY(normals.hasNodeNormals());
+        const Poly_Array1OfTriangle& triangles = triangulation->Triangles();
+        for (int i = triangles.Lower(); i <= triangles.Upper(); ++i) {
+            const gp_Vec expected = occ::MathUtils::triangleNormal(
+                        triangulation->Nodes(), triangles(i), face.Orientation());
+            QVERIFY(normals.triangleNormal(i).IsEqual(expected, 1e-12, 1e-12));
+        }
+
+        // Face is planar : node normals are the unit face normal
+        const gp_Vec faceNormal =
+                normals.triangleNormal(triangles.Lower()).Normalized();
+        const TColgp_Array1OfPnt& nodes = triangulation->Nodes();
+        for (int i = nodes.Lower(); i <= nodes.Upper(); ++i)
+            QVERIFY(normals.nodeNormal(i).IsEqual(faceNormal, 1e-9, 1e-9));
+    }
+
+    occ::Poly_TriangulationNormals normals;
+    QVERIFY(normals.isEmpty());
+    normals.load(Handle_Poly_Triangulation());
+    QVERIFY(normals.isEmpty());
+}
+
+void TestOccTools::TopoDsUtils_shapeBinaryString_test()
+{
+    const TopoDS_Shape box = BRepPrimAPI_MakeBox(1., 2., 3.).Shape();
+    for (occ::TopoDsUtils::BinaryCompression compression :
+         { occ::TopoDsUtils::NoCompression, occ::TopoDsUtils::ZlibCompression })
+    {
+        const std::string str = occ::TopoDsUtils::shapeToBinaryString(box, compression);
+        const TopoDS_Shape shape = occ::TopoDsUtils::shapeFromBinaryString(str);
+        QCOMPARE(internal::faceCount(shape), 6);
+    }
+
+    // Text representation is not accepted
+    const std::string text = occ::TopoDsUtils::shapeToString(box);
+    QVERIFY(occ::TopoDsUtils::shapeFromBinaryString(text).IsNull());
+    QVERIFY(occ::TopoDsUtils::shapeFromBinaryString(std::string()).IsNull());
+}
+
+void TestOccTools::TopoDsUtils_parallelForEach_test()
+{
+    const TopoDS_Shape box = BRepPrimAPI_MakeBox(1., 2., 3.).Shape();
+
+    // Explorer visits shared edges once per face
+    int exploredEdgeCount = 0;
+    occ::TopoDsUtils::forEachEdge(box, [&] (const TopoDS_Shape&) { ++exploredEdgeCount; });
+    QCOMPARE(exploredEdgeCount, 24);
+
+    std::atomic<int> edgeCount(0);
+    occ::TopoDsUtils::parallelForEachEdge(box, [&] (const TopoDS_Shape&) { ++edgeCount; });
+    QCOMPARE(edgeCount.load(), 12);
+
+    std::atomic<int> faceCount(0);
+    occ::TopoDsUtils::parallelForEachFace(
+                box, [&] (const TopoDS_Shape&) { ++faceCount; }, 2, 3);
+    QCOMPARE(faceCount.load(), 6);
+}
+
+void TestOccTools::TopoDsUtils_makeWireFromEdges_test()
+{
+    // Closed polygon, edges don't share vertices, shuffled and some reversed
+    const int edgeCount = 50;
+    const double twoPi = 2 * 3.14159265358979323846;
+    std::vector<TopoDS_Edge> edges;
+    for (int i = 0; i < edgeCount; ++i) {
+        const double a1 = twoPi * i / edgeCount;
+        const double a2 = twoPi * (i + 1) / edgeCount;
+        const gp_Pnt p1(10 * std::cos(a1), 10 * std::sin(a1), 0.);
+        const gp_Pnt p2(10 * std::cos(a2), 10 * std::sin(a2), 0.);
+        const TopoDS_Edge edge = BRepBuilderAPI_MakeEdge(p1, p2);
+        edges.push_back(i % 3 == 0 ? TopoDS::Edge(edge.Reversed()) : edge);
+    }
+    for (int i = 0; i < edgeCount; ++i)
+        std::swap(edges.at(i), edges.at((i * 17) % edgeCount));
+
+    std::vector<TopoDS_Edge> sortedEdges = edges;
+    QCOMPARE(occ::TopoDsUtils::sortConnectedEdges(&sortedEdges, 1e-6),
+             static_cast<std::size_t>(1));
+    QCOMPARE(sortedEdges.size(), edges.size());
+    for (std::size_t i = 0; i < sortedEdges.size(); ++i) {
+        TopoDS_Vertex last;
+        TopoDS_Vertex nextFirst;
+        TopoDS_Vertex unused;
+        TopExp::Vertices(sortedEdges.at(i), unused, last, Standard_True);
+        TopExp::Vertices(
+                    sortedEdges.at((i + 1) % sortedEdges.size()), nextFirst, unused, Standard_True);
+        QVERIFY(BRep_Tool::Pnt(last).Distance(BRep_Tool::Pnt(nextFirst)) < 1e-6);
+    }
+
+    // Two disconnected chains
+    std::vector<TopoDS_Edge> twoChains(edges.begin(), edges.end());
+    twoChains.push_back(BRepBuilderAPI_MakeEdge(gp_Pnt(50, 0, 0), gp_Pnt(60, 0, 0)));
+    QCOMPARE(occ::TopoDsUtils::sortConnectedEdges(&twoChains, 1e-6),
+             static_cast<std::size_t>(2));
+
+    // Batch
+    std::vector<std::vector<TopoDS_Edge>> edgeSets(4, edges);
+    std::vector<TopoDS_Wire> wires(edgeSets.size());
+    occ::TopoDsUtils::makeWires(edgeSets.data(), edgeSets.size(), wires.data(), -1., 2);
+    for (const TopoDS_Wire& wire : wires) {
+        QVERIFY(!wire.IsNull());
+        int wireEdgeCount = 0;
+        occ::TopoDsUtils::forEachEdge(wire, [&] (const TopoDS_Shape&) { ++wireEdgeCount; });
+        QCOMPARE(wireEdgeCount, edgeCount);
+    }
+}
+
+void TestOccTools::TopoDsShapeMaps_test()
+{
+    const TopoDS_Shape box = BRepPrimAPI_MakeBox(1., 2., 3.).Shape();
+    const occ::TopoDsShapeMaps maps(box);
+    QCOMPARE(maps.subShapes(TopAbs_VERTEX).Extent(), 8);
+    QCOMPARE(maps.subShapes(TopAbs_EDGE).Extent(), 12);
+    QCOMPARE(maps.subShapes(TopAbs_FACE).Extent(), 6);
+
+    int edgeCount = 0;
+    maps.forEachEdge([&] (const TopoDS_Shape& edge) {
+        ++edgeCount;
+        QCOMPARE(maps.ancestors(edge, TopAbs_FACE).Extent(), 2);
+    });
+    QCOMPARE(edgeCount, 12);
+
+    // Not a sub-shape
+    const TopoDS_Shape otherBox = BRepPrimAPI_MakeBox(1., 1., 1.).Shape();
+    TopExp_Explorer expOther(otherBox, TopAbs_EDGE);
+    QVERIFY(maps.ancestors(expOther.Current(), TopAbs_FACE).IsEmpty());
+}
+
+void TestOccTools::ShapePropertiesCache_test()
+{
+    const TopoDS_Shape box = BRepPrimAPI_MakeBox(10., 10., 10.).Shape();
+    const TopoDS_Shape otherBox = BRepPrimAPI_MakeBox(gp_Pnt(20., 0., 0.), 5., 5., 5.).Shape();
+    const std::vector<TopoDS_Shape> boxes = { box, otherBox };
+    const TopoDS_Compound compound =
+            occ::TopoDsUtils::makeCompoundFromShapeContainer(boxes);
+
+    const occ::ShapePropertiesCache::MassProperties props =
+            occ::ShapePropertiesCache::computeMassProperties(compound, 4);
+    QCOMPARE(props.faceCount, static_cast<std::size_t>(12));
+    QVERIFY(std::abs(props.area - (600. + 150.)) < 1e-6);
+    QVERIFY(std::abs(props.volume - (1000. + 125.)) < 1e-6);
+    const double centerX = (1000. * 5. + 125. * 22.5) / 1125.;
+    QVERIFY(props.centerOfMass.IsEqual(gp_Pnt(centerX, (5000. + 312.5) / 1125., (5000. + 312.5) / 1125.), 1e-6));
+
+    const Bnd_Box bndBox = occ::ShapePropertiesCache::computeBoundingBox(compound, 4);
+    double xMin, yMin, zMin, xMax, yMax, zMax;
+    bndBox.Get(xMin, yMin, zMin, xMax, yMax, zMax);
+    QVERIFY(xMin <= 0. && xMax >= 25. && zMax >= 10.);
+    QVERIFY(xMax < 25.1 && zMax < 10.1);
+
+    // Cache keyed on shape identity
+    occ::ShapePropertiesCache cache;
+    QVERIFY(!cache.contains(compound));
+    QVERIFY(std::abs(cache.massProperties(compound).volume - props.volume) < 1e-9);
+    cache.boundingBox(compound);
+    cache.boundingBox(box);
+    QCOMPARE(cache.count(), static_cast<std::size_t>(2));
+    QVERIFY(cache.contains(box));
+    QVERIFY(!cache.contains(BRepPrimAPI_MakeBox(10., 10., 10.).Shape()));
+    QVERIFY(std::abs(cache.massProperties(box).volume - 1000.) < 1e-6);
+    QVERIFY(std::abs(cache.massProperties(box.Reversed()).volume + 1000.) < 1e-6);
+    cache.invalidate(box);
+    QVERIFY(!cache.contains(box));
+    cache.clear();
+    QCOMPARE(cache.count(), static_cast<std::size_t>(0));
+}
+
+void TestOccTools::AisSceneBounds_test()
+{
+    const Handle_AIS_Shape aisBox = new AIS_Shape(BRepPrimAPI_MakeBox(10., 10., 10.).Shape());
+    const Handle_AIS_Shape aisOtherBox =
+            new AIS_Shape(BRepPrimAPI_MakeBox(gp_Pnt(20., 0., 0.), 5., 5., 5.).Shape());
+
+    occ::AisSceneBounds bounds;
+    QVERIFY(bounds.isVoid());
+    occ::ShapePropertiesCache cache;
+    bounds.setShapePropertiesCache(&cache);
+    bounds.add(aisBox);
+    bounds.add(aisOtherBox);
+    QCOMPARE(bounds.count(), static_cast<std::size_t>(2));
+    QVERIFY(bounds.contains(aisOtherBox));
+    QCOMPARE(cache.count(), static_cast<std::size_t>(2));
+
+    double xMin, yMin, zMin, xMax, yMax, zMax;
+    bounds.box().Get(xMin, yMin, zMin, xMax, yMax, zMax);
+    QVERIFY(xMin <= 0. && xMax >= 25. && zMax >= 10.);
+    QVERIFY(xMax < 25.1 && zMax < 10.1);
+
+    // Scene box shrinks after removal
+    bounds.remove(aisBox);
+    QVERIFY(!bounds.contains(aisBox));
+    bounds.box().Get(xMin, yMin, zMin, xMax, yMax, zMax);
+    QVERIFY(xMin > 19.9 && zMax < 5.1);
+
+    // Explicit box
+    Bnd_Box explicitBox;
+    explicitBox.Update(-50., -50., -50., -40., -40., -40.);
+    bounds.add(aisBox, explicitBox);
+    bounds.box().Get(xMin, yMin, zMin, xMax, yMax, zMax);
+    QVERIFY(xMin <= -50. && xMax >= 25.);
+
+    bounds.clear();
+    QVERIFY(bounds.isVoid());
+    QCOMPARE(bounds.count(), static_cast<std::size_t>(0));
+}
+
+void TestOccTools::AIS_Text_sharedAspects_test()
+{
+    const occ::Handle_AIS_Text aisText = new occ::AIS_Text;
+    for (int i = 0; i < 1000; ++i)
+        aisText->addText("label", gp_Pnt(i, 0., 0.));
+    QCOMPARE(aisText->textsCount(), 1000u);
+    QCOMPARE(aisText->sharedTextAspectCount(), 1u);
+    QVERIFY(aisText->presentationTextAspect(0) == aisText->presentationTextAspect(999));
+
+    // Per-text attribute doesn't modify the aspect of other texts
+    aisText->setTextStyle(Aspect_TOST_ANNOTATION, 1);
+    QCOMPARE(aisText->sharedTextAspectCount(), 2u);
+    QVERIFY(aisText->graphicTextAspect(1) != aisText->graphicTextAspect(0));
+    aisText->setTextStyle(Aspect_TOST_ANNOTATION, 2);
+    QCOMPARE(aisText->sharedTextAspectCount(), 2u);
+    QVERIFY(aisText->graphicTextAspect(1) == aisText->graphicTextAspect(2));
+    aisText->setTextStyle(Aspect_TOST_NORMAL, 1);
+    QVERIFY(aisText->graphicTextAspect(1) == aisText->graphicTextAspect(0));
+}
+
+void TestOccTools::MemoryReport_test()
+{
+    const TopoDS_Shape box = BRepPrimAPI_MakeBox(1., 2., 3.).Shape();
+    BRepMesh_IncrementalMesh(box, 0.1);
+
+    occ::MemoryReport report;
+    report.addShape(box);
+    // 8 vertices + 12 edges + 6 wires + 6 faces + 1 shell + 1 solid
+    QCOMPARE(report.item(occ::MemoryReport::TopologyCategory).count, static_cast<std::size_t>(34));
+    QCOMPARE(report.item(occ::MemoryReport::SurfaceCategory).count, static_cast<std::size_t>(6));
+    QCOMPARE(report.item(occ::MemoryReport::TriangulationCategory).count, static_cast<std::size_t>(6));
+    QVERIFY(report.bytes(occ::MemoryReport::TriangulationCategory) > 0);
+    QVERIFY(report.bytes(occ::MemoryReport::PolygonCategory) > 0);
+
+    // Shared data is counted once
+    const std::size_t shapeBytes = report.totalBytes();
+    report.addShape(box);
+    QCOMPARE(report.totalBytes(), shapeBytes);
+
+    const occ::PointOnFacesProjector projector(
+                box, occ::PointOnFacesProjector::TriangleBvhIndex);
+    report.addProjector(projector);
+    QVERIFY(report.bytes(occ::MemoryReport::ProjectorIndexCategory) > 0);
+    QCOMPARE(report.bytes(occ::MemoryReport::MappedIndexCategory), static_cast<std::size_t>(0));
+
+    std::size_t sumBytes = 0;
+    for (int i = 0; i < occ::MemoryReport::CategoryCount; ++i)
+        sumBytes += report.bytes(static_cast<occ::MemoryReport::Category>(i));
+    QCOMPARE(report.totalBytes(), sumBytes);
+    QVERIFY(report.toText().find("triangulations") != std::string::npos);
+
+    report.clear();
+    QCOMPARE(report.totalBytes(), static_cast<std::size_t>(0));
+}
+
+void TestOccTools::TopoDsUtils_shapeString_benchmark_data()
+{
+    QTest::addColumn<int>("encoding");
+    QTest::newRow("text") << -1;
+    QTest::newRow("binary") << static_cast<int>(occ::TopoDsUtils::NoCompression);
+    QTest::newRow("binary_zlib") << static_cast<int>(occ::TopoDsUtils::ZlibCompression);
+}
+
+void TestOccTools::TopoDsUtils_shapeString_benchmark()
+{
+    QFETCH(int, encoding);
+    BRep_Builder builder;
+    TopoDS_Compound shapes;
+    builder.MakeCompound(shapes);
+    for (int i = 0; i < 100; ++i)
+        builder.Add(shapes, BRepPrimAPI_MakeSphere(gp_Pnt(3 * i, 0, 0), 1.).Shape());
 
+    const long peakMemoryBeforeKiB = internal::peakResidentMemoryKiB();
+    double byteCount = 0.;
+    QElapsedTimer chrono;
+    chrono.start();
+    QBENCHMARK {
+        if (encoding == -1) {
+            const std::string str = occ::TopoDsUtils::shapeToString(shapes);
+            occ::TopoDsUtils::shapeFromString(str);
+            byteCount += str.size();
+        }
+        else {
+            const auto compression =
+                    static_cast<occ::TopoDsUtils::BinaryCompression>(encoding);
+            const std::string str =
+                    occ::TopoDsUtils::shapeToBinaryString(shapes, compression);
+            occ::TopoDsUtils::shapeFromBinaryString(str);
+            byteCount += str.size();
+        }
+    }
+    internal::reportBenchmarkStats(
+                "bytes", byteCount, chrono.nsecsElapsed(), peakMemoryBeforeKiB);
 }
@@ -8,4 +8,46 @@ class TestOccTools : public QObject
 
 private slots:
     void IO_test();
+    void IO_loadPartFiles_test();
+    void IO_loadStlFileAsTriangulation_test();
+    void IO_loadPartFromContents_test();
+    void IO_loadPartFileCached_test();
+    void IO_loadStepFileByRoots_test();
+    void IO_loadPartFile_benchmark_data();
+    void IO_loadPartFile_benchmark();
+
+    void PointOnFacesProjector_test();
+    void PointOnFacesProjector_nodeQueries_test();
+    void PointOnFacesProjector_benchmark_data();
+    void PointOnFacesProjector_benchmark();
+    void PointOnFacesProjector_faceLookup_benchmark_data();
+    void PointOnFacesProjector_faceLookup_benchmark();
+    void PointOnFacesProjector_prepare_benchmark_data();
+    void PointOnFacesProjector_prepare_benchmark();
+    void PointOnFacesProjector_batchProjected_benchmark_data();
+    void PointOnFacesProjector_batchProjected_benchmark();
+
+    void MeshDeviationAnalysis_test();
+
+    void BRepPointOnFacesProjection_test();
+    void BRepPointOnFacesProjection_benchmark_data();
+    void BRepPointOnFacesProjection_benchmark();
+
+    void GeomUtils_curveLengths_test();
+    void GCPnts_UniformAbscissaSampler_test();
+    void GCPnts_UniformAbscissaShapeSampler_test();
+    void MathUtils_transformPoints_test();
+    void MathUtils_projectPointOnTriangles_test();
+    void Poly_TriangulationNormals_test();
+
+    void TopoDsUtils_shapeBinaryString_test();
+    void TopoDsUtils_parallelForEach_test();
+    void TopoDsUtils_makeWireFromEdges_test();
+    void TopoDsShapeMaps_test();
+    void ShapePropertiesCache_test();
+    void AisSceneBounds_test();
+    void AIS_Text_sharedAspects_test();
+    void MemoryReport_test();
+    void TopoDsUtils_shapeString_benchmark_data();
+    void TopoDsUtils_shapeString_benchmark();
 };
@@ -1,37 +1,87 @@
 #include "test_qttools.h"
 
+#include "../src/qttools/core/binary_ring_log_handler.h"
+#include "../src/qttools/core/grid_numbering.h"
+#include "../src/qttools/core/item_model_data_index.h"
+#include "../src/qttools/core/log.h"
 #include "../src/qttools/core/qlocale_utils.h"
 #include "../src/qttools/core/qobject_wrap.h"
 #include "../src/qttools/core/qstring_hfunc.h"
+#include "../src/qttools/core/qstring_utils.h"
+#include "../src/qttools/core/qvariant_utils.h"
+#include "../src/qttools/core/signal_coalescer.h"
+#include "../src/qttools/core/sleep.h"
+#include "../src/qttools/gui/abstract_length_editor.h"
+#include "../src/qttools/gui/indexed_selection_model.h"
+#include "../src/qttools/gui/lazy_tree_model.h"
+#include "../src/qttools/gui/length_formatter.h"
 #include "../src/qttools/gui/qstandard_item_explorer.h"
+#include "../src/qttools/gui/qstandard_item_tree_snapshot.h"
 #include "../src/qttools/script/calculator.h"
 
 #ifdef FOUGTOOLS_HAVE_QTTOOLS_TASK
 # include "../src/qttools/task/runner_current_thread.h"
+# include "../src/qttools/task/runner_event_loop_thread_pool.h"
+# include "../src/qttools/task/runner_priority_thread_pool.h"
 # include "../src/qttools/task/runner_qthreadpool.h"
 # include "../src/qttools/task/runner_stdasync.h"
+# include "../src/qttools/task/runner_work_stealing_pool.h"
+# include "../src/qttools/task/cancellation_token.h"
 # include "../src/qttools/task/manager.h"
+# include "../src/qttools/task/parallel_algorithms.h"
+# include "../src/qttools/gui/qstandard_item_parallel.h"
+# include "../src/qttools/task/task_registry.h"
+# include "../src/qttools/task/task_result.h"
 #endif // FOUGTOOLS_HAVE_QTTOOLS_TASK
 
+#ifdef FOUGTOOLS_HAVE_QTTOOLS_SQL
+# include "../src/qttools/sql/database_manager.h"
+#endif // FOUGTOOLS_HAVE_QTTOOLS_SQL
+
 #include "../src/mathtools/consts.h"
 
+#include <QtCore/QBuffer>
 #include <QtCore/QCoreApplication>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QJsonArray>
+#include <QtCore/QJsonDocument>
+#include <QtCore/QJsonObject>
+#include <QtCore/QSet>
+#include <QtCore/QTemporaryDir>
 #include <QtCore/QtDebug>
+#include <QtCore/QThread>
 #include <QtCore/QTime>
 #include <QtCore/QTimer>
 #include <QtGui/QStandardItem>
 #include <QtGui/QStandardItemModel>
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <climits>
 #include <cmath>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
 #include <unordered_map>
+#include <vector>
 
 void TestQtTools::core_QLocaleUtils_test()
 {
     QCOMPARE(static_cast<int>(QLocale::France), 74);
     QCOMPARE(qtcore::QLocaleUtils::toCountry(74), QLocale::France);
-    //  foreach (auto country, qttools::QLocaleTools::allCountries()) {
-    //    qDebug() << QLocale::countryToString(country);
-    //  }
+    QVERIFY(qtcore::QLocaleUtils::isCountry(74));
+    QVERIFY(!qtcore::QLocaleUtils::isCountry(-1));
+
+    const std::vector<QLocale::Country>& countries = qtcore::QLocaleUtils::allCountries();
+    QVERIFY(std::find(countries.begin(), countries.end(), QLocale::France) != countries.end());
+    QCOMPARE(&qtcore::QLocaleUtils::allCountries(), &countries);
+
+    QCOMPARE(qtcore::QLocaleUtils::measurementSystem(QLocale::France), QLocale::MetricSystem);
+    const std::vector<QLocale::Country>& metricCountries =
+            qtcore::QLocaleUtils::countriesOfMeasurementSystem(QLocale::MetricSystem);
+    QVERIFY(std::find(metricCountries.begin(), metricCountries.end(), QLocale::France)
+            != metricCountries.end());
 }
 
 void TestQtTools::core_QStringHFunc_test()
@@ -41,6 +91,146 @@ void TestQtTools::core_QStringHFunc_test()
     map.emplace(QString::fromLatin1("test2"), 2);
     QCOMPARE(map.at(QString::fromLatin1("test1")), 1);
     QCOMPARE(map.at(QString::fromLatin1("test2")), 2);
+
+    // Seeded word-at-a-time hash
+    const qtcore::QStringHashWy hashWy;
+    QCOMPARE(hashWy(QString("Record 42")), hashWy(QString("Record ") + QString::number(42)));
+    QVERIFY(hashWy(QString("Record 42")) != hashWy(QString("Record 24")));
+    QVERIFY(hashWy(QString("Record 42")) != qtcore::QStringHashWy(1)(QString("Record 42")));
+}
+
+void TestQtTools::core_QStringUtils_test()
+{
+    const QString strs[] = {
+        QString(), QString("a"), QString("Hello World, this is a long string"),
+        QString("hello world, THIS is a long string"), QString("hello world, this is a long strinG!"),
+        QString::fromUtf8("ÉCOLE élève Œuvre"), QString::fromUtf8("école ÉLÈVE œuvre"),
+        QString::fromUtf8("abcdefgh µ ×÷ ÿ"), QString::fromUtf8("ABCDEFGH Μ ×÷ Ÿ"),
+        QString::fromUtf8("ABCDEFGH μ ×÷ ÿ"), QString::fromUtf8("save_ΣΑΣ"), QString::fromUtf8("SAVE_σας")
+    };
+    for (const QString& s1 : strs) {
+        for (const QString& s2 : strs) {
+            const bool expected = QString::compare(s1, s2, Qt::CaseInsensitive) == 0;
+            QCOMPARE(qtcore::QStringUtils::iequals(s1, s2), expected);
+            if (expected)
+                QCOMPARE(qtcore::QStringUtils::ihash(s1), qtcore::QStringUtils::ihash(s2));
+        }
+    }
+
+    std::unordered_map<QString, int,
+            qtcore::QStringCaseInsensitiveHash,
+            qtcore::QStringCaseInsensitiveEqual> symbols;
+    symbols.emplace(QString("Alpha"), 1);
+    symbols.emplace(QString("BETA"), 2);
+    QCOMPARE(symbols.at(QString("alpha")), 1);
+    QCOMPARE(symbols.at(QString("Beta")), 2);
+    QVERIFY(symbols.find(QString("gamma")) == symbols.end());
+
+#if QT_VERSION >= 0x050200
+    // Sort with collation keys
+    const QStringList names =
+            QStringList() << "zoe" << "Émile" << "adam" << "Zack" << "eve" << "Bob" << "adam";
+    QCollator collator;
+    QStringList expected = names;
+    std::sort(expected.begin(), expected.end(), [&] (const QString& lhs, const QString& rhs) {
+        return collator.compare(lhs, rhs) < 0;
+    });
+
+    QStringList sorted = names;
+    qtcore::QStringUtils::localeAwareSort(&sorted, collator);
+    QCOMPARE(sorted, expected);
+
+    qtcore::QStringSortKeyCache cache(collator);
+    sorted = names;
+    std::sort(sorted.begin(), sorted.end(), qtcore::QStringSortKeyLess(&cache));
+    QCOMPARE(sorted, expected);
+    QCOMPARE(cache.count(), names.size() - 1); // "adam" is there twice
+#endif // QT_VERSION
+}
+
+void TestQtTools::core_QVariantUtils_test()
+{
+    const QList<int> ints = QList<int>() << 1 << 2 << 3;
+    const QList<QVariant> variants = qtcore::QVariantUtils::toContainerOfVariants(ints);
+    QCOMPARE(variants.size(), 3);
+    QCOMPARE(variants.at(2), QVariant(3));
+    QCOMPARE(qtcore::QVariantUtils::toTypedContainer<int>(variants), ints);
+
+    // Move-out
+    QList<QVariant> strVariants =
+            QList<QVariant>() << QString("one") << QString("two") << 3;
+    const QList<QString> strs =
+            qtcore::QVariantUtils::toTypedContainer<QString>(std::move(strVariants));
+    QCOMPARE(strs, QList<QString>() << "one" << "two" << "3");
+
+    // Lazy view
+    auto view = qtcore::QVariantUtils::typedView<double>(variants);
+    QCOMPARE(view.size(), std::size_t(3));
+    QCOMPARE(view.at(1), 2.);
+    double sum = 0.;
+    for (double value : view)
+        sum += value;
+    QCOMPARE(sum, 6.);
+}
+
+void TestQtTools::core_SignalCoalescer_test()
+{
+    qtcore::SignalCoalescer coalescer;
+    QList<int> activations;
+    QObject::connect(
+                &coalescer, &qtcore::SignalCoalescer::activated,
+                [&] (int count) { activations.push_back(count); });
+    for (int i = 0; i < 5; ++i)
+        coalescer.trigger();
+    QVERIFY(activations.isEmpty());
+    QCOMPARE(coalescer.pendingCount(), 5);
+    QTRY_COMPARE(activations, QList<int>() << 5);
+    QVERIFY(!coalescer.isPending());
+
+    coalescer.trigger();
+    coalescer.flush();
+    QCOMPARE(activations, QList<int>() << 5 << 1);
+    coalescer.trigger();
+    coalescer.cancel();
+    QTest::qWait(10);
+    QCOMPARE(activations.size(), 2);
+
+    std::vector<int> batch;
+    int batchCount = 0;
+    qtcore::SignalBatcher<int> batcher([&] (const std::vector<int>& values) {
+        batch = values;
+        ++batchCount;
+    });
+    batcher.add(1);
+    batcher.add(2);
+    batcher.add(3);
+    QTRY_COMPARE(batchCount, 1);
+    QCOMPARE(batch, std::vector<int>({ 1, 2, 3 }));
+}
+
+void TestQtTools::core_WaitEvent_test()
+{
+    qtcore::WaitEvent event;
+    qint64 elapsed = -1;
+    QVERIFY(!event.wait(20, &elapsed));
+    QVERIFY(elapsed >= 19);
+
+    // Set from another thread wakes the waiter before the deadline
+    std::thread setter([&] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        event.set();
+    });
+    QVERIFY(event.wait(5000, &elapsed));
+    setter.join();
+    QVERIFY(elapsed < 5000);
+    QVERIFY(!event.isSet()); // AutoReset
+
+    qtcore::WaitEvent manualEvent(qtcore::WaitEvent::ManualReset);
+    manualEvent.set();
+    QVERIFY(manualEvent.wait(0));
+    QVERIFY(manualEvent.isSet());
+    manualEvent.reset();
+    QVERIFY(!manualEvent.wait(0));
 }
 
 void TestQtTools::core_QObjectWrap_test()
@@ -55,6 +245,201 @@ void TestQtTools::core_QObjectWrap_test()
     auto wrap2 = qtcore::wrapAsQObject(std::move(qstr));
     QCOMPARE(wrap2->value(), QString(str));
     delete wrap2;
+
+    // Move and in-place construction, no copy of the payload
+    struct MoveOnly {
+        MoveOnly(int v) : value(v) {}
+        MoveOnly(MoveOnly&& other) : value(other.value) { other.value = 0; }
+        MoveOnly(const MoveOnly&) = delete;
+        int value;
+    };
+    auto wrap3 = qtcore::wrapAsQObject(MoveOnly(42));
+    QCOMPARE(wrap3->value().value, 42);
+    const MoveOnly taken = wrap3->takeValue();
+    QCOMPARE(taken.value, 42);
+    delete wrap3;
+    auto wrap4 = qtcore::emplaceAsQObject<MoveOnly>(nullptr, 7);
+    QCOMPARE(wrap4->value().value, 7);
+    delete wrap4;
+}
+
+void TestQtTools::core_AsyncLog_test()
+{
+    struct CountLogHandler : public qtcore::AbstractLogHandler {
+        void handle(qtcore::Log::MessageType, const QString&) override {
+            ++count;
+            handlerThreads.insert(QThread::currentThread());
+        }
+        int count = 0; // Handlers are called by one thread at a time
+        QSet<QThread*> handlerThreads;
+    };
+
+    CountLogHandler handler;
+    qtcore::attachGlobalLogHandler(&handler);
+    qtcore::enableAsyncGlobalLog(64, qtcore::BlockOnLogOverflow);
+    QVERIFY(qtcore::isAsyncGlobalLogEnabled());
+
+    const int threadCount = 4;
+    const int msgCountPerThread = 1000;
+    std::vector<std::thread> threads;
+    for (int i = 0; i < threadCount; ++i) {
+        threads.emplace_back([=] {
+            for (int j = 0; j < msgCountPerThread; ++j)
+                qtcore::debugLog() << "thread" << i << "message" << j;
+        });
+    }
+    for (std::thread& thread : threads)
+        thread.join();
+    qtcore::flushGlobalLog();
+    QCOMPARE(handler.count, threadCount * msgCountPerThread);
+    QCOMPARE(handler.handlerThreads.size(), 1);
+    QVERIFY(!handler.handlerThreads.contains(QThread::currentThread()));
+    QCOMPARE(qtcore::globalLogDroppedMessageCount(), Q_UINT64_C(0));
+
+    qtcore::disableAsyncGlobalLog();
+    QVERIFY(!qtcore::isAsyncGlobalLogEnabled());
+    qtcore::infoLog() << "synchronous";
+    QCOMPARE(handler.count, threadCount * msgCountPerThread + 1);
+    QVERIFY(handler.handlerThreads.contains(QThread::currentThread()));
+    qtcore::detachGlobalLogHandler(&handler);
+}
+
+void TestQtTools::core_LogFilter_test()
+{
+    struct LastLogHandler : public qtcore::AbstractLogHandler {
+        void handle(qtcore::Log::MessageType, const QString& msg) override {
+            lastMsg = msg;
+        }
+        QString lastMsg;
+    };
+
+    LastLogHandler handler;
+    qtcore::attachGlobalLogHandler(&handler);
+    int evalCount = 0;
+    auto countedArg = [&] { ++evalCount; return "arg"; };
+
+    qtcore::Log::setMinimumMessageType(qtcore::Log::WarningMessage);
+    QVERIFY(!qtcore::Log::isEnabled(qtcore::Log::InfoMessage));
+    QVERIFY(qtcore::Log::isEnabled(qtcore::Log::WarningMessage));
+    QTTOOLS_DEBUG_LOG() << countedArg();
+    QTTOOLS_INFO_LOG() << countedArg();
+    QCOMPARE(evalCount, 0);
+    qtcore::infoLog() << "filtered";
+    QVERIFY(handler.lastMsg.isEmpty());
+    QTTOOLS_WARNING_LOG() << countedArg();
+    QCOMPARE(evalCount, 1);
+    QCOMPARE(handler.lastMsg.trimmed(), QString("arg"));
+
+    qtcore::Log::setMinimumMessageType(qtcore::Log::DebugMessage);
+    QTTOOLS_DEBUG_LOG() << countedArg();
+    QCOMPARE(evalCount, 2);
+    qtcore::detachGlobalLogHandler(&handler);
+}
+
+void TestQtTools::core_BinaryRingLogHandler_test()
+{
+    QTemporaryDir tempDir;
+    QVERIFY(tempDir.isValid());
+    const QString filePath = tempDir.path() + QLatin1String("/log.ring");
+    const int msgCount = 500;
+    {
+        qtcore::BinaryRingLogHandler handler;
+        QVERIFY(handler.open(filePath, 4096));
+        for (int i = 0; i < msgCount; ++i)
+            handler.handle(qtcore::Log::InfoMessage, QString("message %1").arg(i));
+        QCOMPARE(handler.recordCount(), quint64(msgCount));
+    }
+
+    // Reopening continues the ring
+    {
+        qtcore::BinaryRingLogHandler handler;
+        QVERIFY(handler.open(filePath, 4096));
+        handler.handle(qtcore::Log::WarningMessage, QLatin1String("last"));
+        QCOMPARE(handler.recordCount(), quint64(msgCount + 1));
+    }
+
+    QString errorString;
+    const QList<qtcore::BinaryRingLogHandler::Record> records =
+            qtcore::BinaryRingLogHandler::readRecords(filePath, &errorString);
+    QVERIFY(errorString.isEmpty());
+    QVERIFY(records.size() > 1 && records.size() < msgCount); // Overwritten
+    QCOMPARE(records.last().msg, QString("last"));
+    QCOMPARE(records.last().msgType, qtcore::Log::WarningMessage);
+    const int firstId = msgCount + 1 - records.size();
+    for (int i = 0; i < records.size() - 1; ++i) {
+        QCOMPARE(records.at(i).msg, QString("message %1").arg(firstId + i));
+        QVERIFY(records.at(i).timestampUsec <= records.at(i + 1).timestampUsec);
+    }
+}
+
+void TestQtTools::core_GridNumbering_test()
+{
+    const qtcore::GridNumbering gridNb(
+                Qt::TopRightCorner, Qt::Vertical, qtcore::GridNumbering::OneWay);
+    const QVector< QVector<int> > grid =
+            qtcore::GridNumbering::gridIndexes(gridNb, 4, 4);
+    QCOMPARE(grid.at(0), QVector<int>() << 12 << 8 << 4 << 0);
+    QCOMPARE(grid.at(3), QVector<int>() << 15 << 11 << 7 << 3);
+
+    const int rowCount = 5;
+    const int colCount = 7;
+    const Qt::Corner corners[] = {
+        Qt::TopLeftCorner, Qt::TopRightCorner,
+        Qt::BottomLeftCorner, Qt::BottomRightCorner };
+    for (Qt::Corner corner : corners) {
+        for (Qt::Orientation orientation : { Qt::Horizontal, Qt::Vertical }) {
+            for (auto sweep : { qtcore::GridNumbering::OneWay,
+                                qtcore::GridNumbering::ZigZag })
+            {
+                const qtcore::GridNumbering nb(corner, orientation, sweep);
+                const QVector<int> flatGrid =
+                        qtcore::GridNumbering::flatGridIndexes(nb, rowCount, colCount, 1);
+                QCOMPARE(flatGrid.size(), rowCount * colCount);
+                for (int row = 0; row < rowCount; ++row) {
+                    for (int col = 0; col < colCount; ++col) {
+                        const int index = flatGrid.at(row * colCount + col);
+                        QCOMPARE(nb.cellIndex(row, col, rowCount, colCount, 1), index);
+                        int cellRow = -1;
+                        int cellCol = -1;
+                        QVERIFY(nb.cellAt(index, rowCount, colCount, &cellRow, &cellCol, 1));
+                        QCOMPARE(cellRow, row);
+                        QCOMPARE(cellCol, col);
+                    }
+                }
+                QVERIFY(!nb.cellAt(0, rowCount, colCount, NULL, NULL, 1));
+            }
+        }
+    }
+}
+
+void TestQtTools::core_ItemModelDataIndex_test()
+{
+    QStandardItemModel model;
+    for (int i = 0; i < 100; ++i) {
+        model.appendRow(QList<QStandardItem*>()
+                        << new QStandardItem(QString::number(i))
+                        << new QStandardItem(QString("item_%1").arg(i % 10)));
+    }
+
+    qtcore::ItemModelDataIndex dataIndex(&model, 1);
+    QCOMPARE(dataIndex.findRow(QString("item_3")), 3);
+    QCOMPARE(dataIndex.findRows(QString("item_3")).size(), 10);
+    QCOMPARE(dataIndex.findRow(QString("none")), -1);
+
+    // Incremental updates
+    model.item(0, 1)->setText(QLatin1String("changed"));
+    QCOMPARE(dataIndex.findRow(QString("changed")), 0);
+    QCOMPARE(dataIndex.findRow(QString("item_0")), 10);
+    model.appendRow(QList<QStandardItem*>()
+                    << new QStandardItem(QLatin1String("100"))
+                    << new QStandardItem(QLatin1String("appended")));
+    QCOMPARE(dataIndex.findRow(QString("appended")), 100);
+
+    // Invalidating changes
+    model.removeRows(0, 5);
+    QCOMPARE(dataIndex.findRow(QString("item_5")), 0);
+    QCOMPARE(dataIndex.findRow(QString("changed")), -1);
+    QCOMPARE(dataIndex.findRow(QString("appended")), 95);
 }
 
 void TestQtTools::gui_QStandardItemExplorer_test()
@@ -91,6 +476,182 @@ void TestQtTools::gui_QStandardItemExplorer_test()
     QCOMPARE(explorer.atEnd(), true);
 }
 
+void TestQtTools::gui_QStandardItemTreeSnapshot_test()
+{
+    QStandardItemModel itemModel;
+    auto item1 = new QStandardItem(QLatin1String("item_1"));
+    auto item2 = new QStandardItem(QLatin1String("item_2"));
+    itemModel.appendRow(item1);
+    itemModel.appendRow(item2);
+    for (int i = 0; i < 100; ++i) {
+        auto child = new QStandardItem(QString::number(i));
+        child->appendRow(new QStandardItem(QString::number(1000 + i)));
+        item1->appendRow(child);
+    }
+
+    const qtgui::QStandardItemTreeSnapshot snapshot(&itemModel);
+    QCOMPARE(snapshot.size(), std::size_t(202));
+    QCOMPARE(snapshot.item(0), item1);
+    QCOMPARE(snapshot.item(1), item2);
+    QCOMPARE(snapshot.item(2), item1->child(0));
+    QCOMPARE(snapshot.depth(1), 0u);
+    QCOMPARE(snapshot.depth(101), 1u);
+    QCOMPARE(snapshot.item(102), item1->child(0)->child(0));
+    QCOMPARE(snapshot.depth(201), 2u);
+
+    const qtgui::QStandardItemTreeSnapshot subSnapshot(item1->child(5));
+    QCOMPARE(subSnapshot.size(), std::size_t(2));
+    QCOMPARE(subSnapshot.depth(0), 0u);
+    QCOMPARE(subSnapshot.depth(1), 1u);
+
+#ifdef FOUGTOOLS_HAVE_QTTOOLS_TASK
+    qttask::Manager taskMgr;
+    QHash<const QStandardItem*, int> textSizes;
+    std::vector<QStandardItem*> leaves;
+    auto task = taskMgr.newTask<qttask::CurrentThread>();
+    task->run( [&] {
+        textSizes = qtgui::parallelMapItems<int>(
+                    task->progress(), snapshot,
+                    [](const QStandardItem* item, unsigned) {
+            return item->text().size();
+        }, 16);
+        leaves = qtgui::parallelFilterItems(
+                    task->progress(), snapshot,
+                    [](const QStandardItem* item, unsigned) {
+            return !item->hasChildren();
+        }, 16);
+    } );
+    QCOMPARE(textSizes.size(), 202);
+    QCOMPARE(textSizes.value(item1), 6);
+    QCOMPARE(textSizes.value(item1->child(99)->child(0)), 4);
+    QCOMPARE(leaves.size(), std::size_t(101));
+    QCOMPARE(leaves.front(), item2);
+    QCOMPARE(leaves.back(), item1->child(99)->child(0));
+#endif // FOUGTOOLS_HAVE_QTTOOLS_TASK
+}
+
+void TestQtTools::gui_IndexedSelectionModel_test()
+{
+    qtgui::IndexedSelectionModel selModel;
+    int itemsChangedCount = 0;
+    QObject::connect(&selModel, &qtgui::IndexedSelectionModel::itemsChanged,
+                     [&](int, int) { ++itemsChangedCount; } );
+
+    // Sparse indexes do not allocate up to the highest one
+    selModel.toggleItem(INT_MAX);
+    selModel.toggleItem(-1); // Invalid by default
+    QVERIFY(selModel.isSelected(INT_MAX));
+    QVERIFY(!selModel.isSelected(-1));
+    QCOMPARE(selModel.selectedCount(), 1);
+
+    // Ranges spanning several chunks
+    selModel.setItemsSelected(10, 10000, true);
+    QCOMPARE(selModel.selectedCount(), 1 + 9991);
+    QVERIFY(selModel.isSelected(4095) && selModel.isSelected(4096));
+    QVERIFY(!selModel.isSelected(9) && !selModel.isSelected(10001));
+    selModel.toggleItems(5000, 5001);
+    QVERIFY(!selModel.isSelected(5000));
+    QCOMPARE(itemsChangedCount, 2);
+
+    const QVector<int> vecSelected = selModel.selectedItemVector();
+    QCOMPARE(vecSelected.size(), selModel.selectedCount());
+    QVERIFY(std::is_sorted(vecSelected.cbegin(), vecSelected.cend()));
+    QCOMPARE(vecSelected.back(), INT_MAX);
+
+    selModel.setItemsSelected(0, INT_MAX, false);
+    QCOMPARE(selModel.selectedCount(), 0);
+    QVERIFY(!selModel.hasSelection());
+}
+
+void TestQtTools::gui_LazyTreeModel_test()
+{
+    // Tree of 1110 nodes, 10 children per node down to depth 3
+    class DecimalTreeSource : public qtgui::LazyTreeModel::Source
+    {
+    public:
+        typedef qtgui::LazyTreeModel::NodeId NodeId;
+        int childCount(NodeId parent) const override
+        { return parent < 111 ? 10 : 0; }
+        NodeId childId(NodeId parent, int row) const override
+        { return parent * 10 + row + 1; }
+        QVariant data(NodeId node, int role) const override
+        { return role == Qt::DisplayRole ? QString("node_%1").arg(node) : QVariant(); }
+    };
+
+    DecimalTreeSource source;
+    qtgui::LazyTreeModel model;
+    model.setSource(&source);
+    QCOMPARE(model.rowCount(), 0);
+    QVERIFY(model.hasChildren());
+    QVERIFY(model.canFetchMore(QModelIndex()));
+    model.fetchMore(QModelIndex());
+    QCOMPARE(model.rowCount(), 10);
+    QVERIFY(!model.canFetchMore(QModelIndex()));
+    const QModelIndex item3 = model.index(2, 0);
+    QCOMPARE(model.nodeId(item3), qtgui::LazyTreeModel::NodeId(3));
+    QCOMPARE(item3.data().toString(), QString("node_3"));
+    QVERIFY(model.hasChildren(item3));
+    QCOMPARE(model.rowCount(item3), 0);
+    QCOMPARE(model.loadedNodeCount(), 10);
+
+    // Search the source, only the ancestors of the match get loaded
+    const QModelIndexList hits = model.match(
+                model.index(0, 0),
+                Qt::DisplayRole,
+                QString("node_1110"),
+                1,
+                Qt::MatchExactly | Qt::MatchRecursive);
+    QCOMPARE(hits.size(), 1);
+    QCOMPARE(hits.first().data().toString(), QString("node_1110"));
+    QCOMPARE(hits.first().row(), 9);
+    QCOMPARE(hits.first().parent().row(), 9);
+    QCOMPARE(hits.first().parent().parent().row(), 9);
+    QCOMPARE(model.loadedNodeCount(), 30);
+
+    model.setFetchBatchSize(4);
+    model.reload();
+    QCOMPARE(model.loadedNodeCount(), 0);
+    model.fetchMore(QModelIndex());
+    QCOMPARE(model.rowCount(), 4);
+    model.fetchMore(QModelIndex());
+    model.fetchMore(QModelIndex());
+    QCOMPARE(model.rowCount(), 10);
+    QVERIFY(!model.canFetchMore(QModelIndex()));
+}
+
+void TestQtTools::gui_AbstractLengthEditor_test()
+{
+    typedef qtgui::AbstractLengthEditor Editor;
+    const double lensMm[] = { 25.4, 254., 914.4, 1000. };
+    double lens[4];
+
+    Editor::asMetricLengths(lensMm, 4, Editor::CentimeterUnit, lens);
+    for (int i = 0; i < 4; ++i)
+        QCOMPARE(lens[i], Editor::asMetricLength(lensMm[i], Editor::CentimeterUnit));
+
+    Editor::asImperialLengths(lensMm, 4, Editor::InchUnit, lens);
+    QCOMPARE(lens[0], 1.);
+    QCOMPARE(lens[1], 10.);
+    for (int i = 0; i < 4; ++i)
+        QCOMPARE(lens[i], Editor::asImperialLength(lensMm[i], Editor::InchUnit));
+
+    // Shared formatters
+    const QLocale cLocale = QLocale::c();
+    const qtgui::LengthFormatter* fmtCm =
+            qtgui::LengthFormatter::metric(Editor::CentimeterUnit, cLocale, 1);
+    QCOMPARE(qtgui::LengthFormatter::metric(Editor::CentimeterUnit, cLocale, 1), fmtCm);
+    QVERIFY(qtgui::LengthFormatter::metric(Editor::CentimeterUnit, cLocale, 2) != fmtCm);
+    QCOMPARE(fmtCm->toUnitValue(254.), 25.4);
+    QCOMPARE(fmtCm->toMmValue(25.4), 254.);
+    QCOMPARE(fmtCm->formatLength(25.), QString("2.5 cm"));
+    const qtgui::LengthFormatter* fmtFt =
+            qtgui::LengthFormatter::forMeasurementSystem(
+                QLocale::ImperialSystem, Editor::MeterUnit, Editor::FootUnit, cLocale, 2);
+    QVERIFY(fmtFt->isImperial());
+    QCOMPARE(fmtFt->unitText(), QString("ft"));
+    QCOMPARE(fmtFt->formatValue(fmtFt->toUnitValue(914.4)), QString("3.00"));
+}
+
 void TestQtTools::script_Calculator_test()
 {
     qtscript::Calculator calc;
@@ -108,6 +669,81 @@ void TestQtTools::script_Calculator_test()
     QVERIFY(!calc.hasResult());
     QVERIFY(!calc.lastErrorText().isEmpty());
     //qDebug() << calc.lastErrorText();
+
+    // Variables and compiled programs cache
+    calc.clearProgramCache();
+    qtscript::Calculator::Variables vars;
+    for (int i = 0; i < 10; ++i) {
+        vars.insert("x", i);
+        calc.evaluate("2*(3.5+x)", vars);
+        QVERIFY(calc.hasResult());
+        QCOMPARE(calc.lastResult(), 2 * (3.5 + i));
+    }
+    QCOMPARE(calc.programCacheCount(), 1);
+    calc.evaluate("x");
+    QVERIFY(!calc.hasResult());
+
+    calc.setProgramCacheCapacity(2);
+    calc.evaluate("1+1");
+    calc.evaluate("2+2");
+    QCOMPARE(calc.programCacheCount(), 2);
+
+    // Native evaluation must give the same results as the script engine
+    const char* exprs[] = {
+        "2*(3.5+x)", "-x*-2 + 7%3", "atan2(1, x)*RAD_TO_DEG", "pow(x, 3)/4",
+        "sqrt(2)*sqrt(2)", "round(-2.5) + floor(x/3)", "1e3 + .5", "PI"
+    };
+    vars.insert("x", 1.5);
+    for (const char* expr : exprs) {
+        calc.setNativeEvaluationEnabled(true);
+        calc.evaluate(expr, vars);
+        QVERIFY(calc.hasResult());
+        const double nativeResult = calc.lastResult();
+        calc.setNativeEvaluationEnabled(false);
+        calc.evaluate(expr, vars);
+        QVERIFY(calc.hasResult());
+        QCOMPARE(nativeResult, calc.lastResult());
+    }
+    calc.setNativeEvaluationEnabled(true);
+    calc.evaluate("var y = 4");
+    calc.evaluate("y*2"); // Global variable, left to the script engine
+    QVERIFY(calc.hasResult());
+    QCOMPARE(calc.lastResult(), 8.0);
+
+    // Evaluation over columns
+    std::vector<double> xColumn(10000);
+    for (std::size_t i = 0; i < xColumn.size(); ++i)
+        xColumn[i] = static_cast<double>(i);
+    qtscript::Calculator::VariableColumns columns;
+    columns.insert("x", xColumn.data());
+    qtscript::Calculator::Variables scalars;
+    scalars.insert("z", 0.5);
+    std::vector<double> results(xColumn.size());
+    QVERIFY(calc.evaluateColumns(
+                "2*x + z", columns, xColumn.size(), results.data(), scalars, 0));
+    for (std::size_t i = 0; i < results.size(); ++i)
+        QCOMPARE(results[i], 2. * i + 0.5);
+    // Same through the script engine
+    std::vector<double> engineResults(100);
+    QVERIFY(calc.evaluateColumns(
+                "2*x + z + y", columns, engineResults.size(), engineResults.data(), scalars));
+    for (std::size_t i = 0; i < engineResults.size(); ++i)
+        QCOMPARE(engineResults[i], 2. * i + 4.5);
+
+    // Per-thread instances
+    qtscript::Calculator* threadCalc = qtscript::Calculator::forCurrentThread();
+    QVERIFY(threadCalc != NULL);
+    QCOMPARE(qtscript::Calculator::forCurrentThread(), threadCalc);
+    qtscript::Calculator* otherThreadCalc = NULL;
+    double otherThreadResult = 0.;
+    std::thread otherThread([&] {
+        otherThreadCalc = qtscript::Calculator::forCurrentThread();
+        otherThreadCalc->evaluate("cos(0)*3");
+        otherThreadResult = otherThreadCalc->lastResult();
+    });
+    otherThread.join();
+    QVERIFY(otherThreadCalc != threadCalc);
+    QCOMPARE(otherThreadResult, 3.0);
 }
 
 #ifdef FOUGTOOLS_HAVE_QTTOOLS_TASK
@@ -127,6 +763,363 @@ static qttask::BaseRunner* newTaskRunner(
 
 } // namespace Internal
 
+void TestQtTools::task_TaskRegistry_test()
+{
+    // Registry never dereferences runners, fake addresses are fine
+    auto runner1 = reinterpret_cast<qttask::BaseRunner*>(0x10);
+    auto runner2 = reinterpret_cast<qttask::BaseRunner*>(0x20);
+
+    qttask::TaskRegistry registry;
+    const quint64 taskId1 = registry.insert(runner1);
+    QCOMPARE(registry.find(taskId1), runner1);
+    QVERIFY(registry.remove(taskId1));
+    QVERIFY(!registry.remove(taskId1));
+    QCOMPARE(registry.find(taskId1), static_cast<qttask::BaseRunner*>(nullptr));
+
+    // Slot is reused with another generation, taskId1 stays invalid
+    const quint64 taskId2 = registry.insert(runner2);
+    QCOMPARE(taskId2 & 0xFFFFFFFF, taskId1 & 0xFFFFFFFF);
+    QVERIFY(taskId2 != taskId1);
+    QCOMPARE(registry.find(taskId2), runner2);
+    QCOMPARE(registry.find(taskId1), static_cast<qttask::BaseRunner*>(nullptr));
+
+    // Concurrent insert/remove while another thread looks up
+    std::atomic<bool> isLookupValid(true);
+    std::atomic<bool> isStopRequested(false);
+    std::thread lookupThread([&] {
+        while (!isStopRequested) {
+            if (registry.find(taskId2) != runner2)
+                isLookupValid = false;
+        }
+    } );
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 4; ++i) {
+        threads.emplace_back([&] {
+            for (int j = 0; j < 1000; ++j)
+                registry.remove(registry.insert(runner1));
+        } );
+    }
+    for (std::thread& thread : threads)
+        thread.join();
+    isStopRequested = true;
+    lookupThread.join();
+    QVERIFY(isLookupValid);
+}
+
+// Must run before task_Manager_test(), which connects lambdas to the global
+// Manager that capture its local variables
+void TestQtTools::task_StdAsyncRunner_test()
+{
+    auto taskMgr = qttask::Manager::globalInstance();
+    std::atomic<bool> isRunReturned(false);
+    std::atomic<bool> isRunAsync(false);
+    std::atomic<bool> isTaskDone(false);
+
+    auto task = taskMgr->newTask<qttask::StdAsync>();
+    task->run( [&] {
+        QTime chrono;
+        chrono.start();
+        while (!isRunReturned && chrono.elapsed() < 2000)
+            std::this_thread::yield();
+        isRunAsync = isRunReturned.load();
+        isTaskDone = true;
+    } );
+    isRunReturned = true;
+
+    QTime chrono;
+    chrono.start();
+    while (!isTaskDone && chrono.elapsed() < 5000)
+        QCoreApplication::processEvents();
+    QCoreApplication::processEvents(); // Destroy request of the runner
+    QVERIFY(isTaskDone);
+    QVERIFY(isRunAsync);
+}
+
+void TestQtTools::task_Dependency_test()
+{
+    auto taskMgr = qttask::Manager::globalInstance();
+    std::atomic<int> stageCount(0);
+    std::atomic<bool> isLoadDone(false);
+    std::atomic<bool> isMeshDone(false);
+    std::atomic<bool> isOrderValid(false);
+
+    // load and mesh run concurrently, index waits for both of them
+    auto load = taskMgr->newTask<QThreadPool>();
+    auto mesh = taskMgr->newTask<qttask::StdAsync>();
+    auto index = taskMgr->newTask<qttask::WorkStealingPool>();
+    index->addDependency(load);
+    index->addDependency(mesh);
+
+    index->run( [&] {
+        isOrderValid = isLoadDone && isMeshDone;
+        ++stageCount;
+    } );
+    QCOMPARE(stageCount.load(), 0);
+    load->run( [&] { isLoadDone = true; ++stageCount; } );
+    mesh->run( [&] { isMeshDone = true; ++stageCount; } );
+
+    QTime chrono;
+    chrono.start();
+    while (stageCount < 3 && chrono.elapsed() < 5000)
+        QCoreApplication::processEvents();
+    QCoreApplication::processEvents(); // Destroy requests of the runners
+    QCOMPARE(stageCount.load(), 3);
+    QVERIFY(isOrderValid);
+}
+
+void TestQtTools::task_ProgressThrottle_test()
+{
+    qttask::Manager taskMgr;
+    std::vector<int> signaledValues;
+    QObject::connect(&taskMgr, &qttask::Manager::progress,
+                     [&](quint64, int pct) { signaledValues.push_back(pct); } );
+
+    // Tight loop, only first and last values are signaled
+    taskMgr.setProgressSignalInterval(60 * 1000);
+    auto task = taskMgr.newTask<qttask::CurrentThread>();
+    task->run( [=] {
+        for (int pct = 0; pct <= 100; ++pct)
+            task->progress().setValue(pct);
+    } );
+    QCOMPARE(signaledValues.size(), static_cast<std::size_t>(2));
+    QCOMPARE(signaledValues.front(), 0);
+    QCOMPARE(signaledValues.back(), 100);
+
+    // No throttling, repeated values are still filtered
+    signaledValues.clear();
+    taskMgr.setProgressSignalInterval(0);
+    task = taskMgr.newTask<qttask::CurrentThread>();
+    task->run( [=] {
+        for (int pct = 0; pct <= 100; ++pct) {
+            task->progress().setValue(pct);
+            task->progress().setValue(pct);
+        }
+    } );
+    QCOMPARE(signaledValues.size(), static_cast<std::size_t>(101));
+}
+
+void TestQtTools::task_Progress_test()
+{
+    qttask::Manager taskMgr;
+    auto task = taskMgr.newTask<qttask::CurrentThread>();
+    QString readerStep;
+    int readerValue = -1;
+    QVariant dataBefore;
+    task->run( [&] {
+        qttask::Progress& progress = task->progress();
+        dataBefore = progress.data(1);
+        progress.setData(1, 10);
+        progress.setData(1, 20);
+        progress.setStep(QLatin1String("first"));
+        progress.setStep(QLatin1String("second"));
+        progress.setValue(42);
+        // Lock-free reads from another thread
+        std::thread reader([&] {
+            readerStep = progress.step();
+            readerValue = progress.value();
+        } );
+        reader.join();
+        QCOMPARE(progress.data(1).toInt(), 20);
+    } );
+    QVERIFY(!dataBefore.isValid());
+    QCOMPARE(readerStep, QString(QLatin1String("second")));
+    QCOMPARE(readerValue, 42);
+}
+
+void TestQtTools::task_CancellationToken_test()
+{
+    qttask::CancellationToken token;
+    qttask::CancellationToken tokenCopy = token;
+    qttask::CancellationToken child = token.childToken();
+    qttask::CancellationToken grandChild = child.childToken();
+    QVERIFY(!token.isCancellationRequested());
+    grandChild.requestCancellation();
+    QVERIFY(grandChild.isCancellationRequested());
+    QVERIFY(!child.isCancellationRequested());
+    tokenCopy.requestCancellation();
+    QVERIFY(token.isCancellationRequested());
+    QVERIFY(child.isCancellationRequested());
+
+    // Aborting a task aborts its subtasks, not the reverse
+    qttask::Manager taskMgr;
+    auto task = taskMgr.newTask<qttask::CurrentThread>();
+    bool isSubTaskAborted = false;
+    bool isTaskAborted = true;
+    task->run( [&] {
+        auto subTask1 = taskMgr.newSubTask<qttask::CurrentThread>(task);
+        subTask1->run( [&] {
+            taskMgr.requestAbort(subTask1->taskId());
+            isTaskAborted = task->progress().isAbortRequested();
+        } );
+        auto subTask2 = taskMgr.newSubTask<qttask::CurrentThread>(task);
+        taskMgr.requestAbort(task->taskId());
+        subTask2->run( [&] {
+            isSubTaskAborted = subTask2->progress().isAbortRequested();
+        } );
+    } );
+    QVERIFY(!isTaskAborted);
+    QVERIFY(isSubTaskAborted);
+}
+
+void TestQtTools::task_ParallelAlgorithms_test()
+{
+    qttask::Manager taskMgr;
+    std::vector<int> values(10000, 0);
+    bool isForComplete = false;
+    long long sum = 0;
+    int pct = 0;
+    auto task = taskMgr.newTask<qttask::CurrentThread>();
+    task->run( [&] {
+        isForComplete = qttask::parallelFor(
+                    task->progress(), values.size(), 64,
+                    [&](std::size_t chunkBegin, std::size_t chunkEnd) {
+            for (std::size_t i = chunkBegin; i < chunkEnd; ++i)
+                values[i] = static_cast<int>(i);
+        } );
+        sum = qttask::parallelReduce(
+                    task->progress(), values.size(), 100, 0LL,
+                    [&](std::size_t chunkBegin, std::size_t chunkEnd) {
+            long long chunkSum = 0;
+            for (std::size_t i = chunkBegin; i < chunkEnd; ++i)
+                chunkSum += values[i];
+            return chunkSum;
+        },
+                    [](long long lhs, long long rhs) { return lhs + rhs; } );
+        pct = task->progress().value();
+    } );
+    QVERIFY(isForComplete);
+    QCOMPARE(sum, 9999LL * 10000 / 2);
+    QCOMPARE(pct, 100);
+
+    // Chunks are skipped once the task is aborted
+    std::atomic<int> chunkCount(0);
+    bool isForAborted = false;
+    task = taskMgr.newTask<qttask::CurrentThread>();
+    task->run( [&] {
+        const quint64 taskId = task->taskId();
+        isForAborted = !qttask::parallelFor(
+                    task->progress(), 1000, 1,
+                    [&](std::size_t, std::size_t) {
+            ++chunkCount;
+            taskMgr.requestAbort(taskId);
+        } );
+    } );
+    QVERIFY(isForAborted);
+    QVERIFY(chunkCount < 1000);
+}
+
+void TestQtTools::task_Timing_test()
+{
+    qttask::Manager taskMgr;
+    taskMgr.setTimingEnabled(true);
+    taskMgr.setTraceEnabled(true);
+    for (int i = 0; i < 3; ++i) {
+        auto task = taskMgr.newTask<qttask::CurrentThread>();
+        task->setTaskTitle(QLatin1String("sleep"));
+        task->run( [] {
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        } );
+    }
+
+    typedef qttask::TaskDurationHistogram::Duration Duration;
+    const qttask::TaskTimingStats stats =
+            taskMgr.taskTimingStats().value(QLatin1String("sleep"));
+    QCOMPARE(stats.runDuration.count(), static_cast<quint64>(3));
+    QCOMPARE(stats.queueLatency.count(), static_cast<quint64>(3));
+    QVERIFY(stats.runDuration.min() >= Duration(2000));
+    QVERIFY(stats.runDuration.percentile(50) >= stats.runDuration.min());
+
+    QBuffer buffer;
+    buffer.open(QIODevice::WriteOnly);
+    QVERIFY(taskMgr.writeChromeTrace(&buffer));
+    const QJsonArray jsonEvents =
+            QJsonDocument::fromJson(buffer.data()).object()
+            .value(QLatin1String("traceEvents")).toArray();
+    QCOMPARE(jsonEvents.size(), 3);
+    const QJsonObject jsonEvent = jsonEvents.first().toObject();
+    QCOMPARE(jsonEvent.value(QLatin1String("name")).toString(),
+             QString(QLatin1String("sleep")));
+    QVERIFY(jsonEvent.value(QLatin1String("dur")).toDouble() >= 2000.);
+
+    taskMgr.clearTimings();
+    QVERIFY(taskMgr.taskTimingStats().isEmpty());
+}
+
+void TestQtTools::task_EventLoopThreadPool_test()
+{
+    qttask::EventLoopThreadPool pool(2);
+    QCOMPARE(pool.threadCount(), 2);
+
+    qttask::Manager taskMgr;
+    std::mutex threadsMutex;
+    std::vector<QThread*> threads;
+    std::atomic<int> eventLoopJobCount(0);
+    std::atomic<int> endedCount(0);
+    QObject::connect(&taskMgr, &qttask::Manager::ended,
+                     [&](quint64) { ++endedCount; } );
+    for (int i = 0; i < 10; ++i) {
+        auto task = taskMgr.newTask<qttask::EventLoopThreadPool>(&pool);
+        task->run( [&] {
+            QThread* thread = QThread::currentThread();
+            if (thread->eventDispatcher() != nullptr)
+                ++eventLoopJobCount;
+            std::lock_guard<std::mutex> lock(threadsMutex);
+            if (std::find(threads.begin(), threads.end(), thread) == threads.end())
+                threads.push_back(thread);
+        } );
+    }
+
+    QTime chrono;
+    chrono.start();
+    while (endedCount < 10 && chrono.elapsed() < 5000)
+        QCoreApplication::processEvents();
+    QCoreApplication::processEvents(); // Destroy requests of the runners
+    QCOMPARE(endedCount.load(), 10);
+    QCOMPARE(eventLoopJobCount.load(), 10);
+    QVERIFY(threads.size() <= 2);
+    QVERIFY(std::find(threads.begin(), threads.end(), QThread::currentThread())
+            == threads.end());
+}
+
+void TestQtTools::task_PriorityThreadPool_test()
+{
+    typedef qttask::PriorityThreadPool::Clock Clock;
+    std::mutex orderMutex;
+    std::vector<int> order;
+    {
+        qttask::PriorityThreadPool pool(1);
+        // Keep the single worker busy while jobs are queued
+        std::atomic<bool> isReleased(false);
+        pool.start([&] {
+            while (!isReleased)
+                std::this_thread::yield();
+        } );
+        while (pool.pendingJobCount() != 0)
+            std::this_thread::yield();
+
+        auto fnRecord = [&](int id) {
+            return [&, id] {
+                std::lock_guard<std::mutex> lock(orderMutex);
+                order.push_back(id);
+            };
+        };
+        const Clock::time_point now = Clock::now();
+        pool.start(fnRecord(1), qttask::BaseRunner::BackgroundPriority);
+        pool.start(fnRecord(2), qttask::BaseRunner::NormalPriority);
+        pool.start(fnRecord(3), qttask::BaseRunner::InteractivePriority);
+        pool.start(fnRecord(4), qttask::BaseRunner::NormalPriority,
+                   now + std::chrono::hours(1));
+        // Deadline reached, overtakes higher priorities
+        pool.start(fnRecord(5), qttask::BaseRunner::BackgroundPriority,
+                   now - std::chrono::seconds(1));
+        QCOMPARE(pool.pendingJobCount(), static_cast<std::size_t>(5));
+        isReleased = true;
+    } // Pending jobs are run by ~PriorityThreadPool()
+
+    const std::vector<int> expectedOrder = { 5, 3, 4, 2, 1 };
+    QCOMPARE(order, expectedOrder);
+}
+
 void TestQtTools::task_Manager_test()
 {
     auto taskMgr = qttask::Manager::globalInstance();
@@ -148,12 +1141,22 @@ void TestQtTools::task_Manager_test()
             qDebug() << "Message:" << taskId << msg;
     } );
 
+    // Thread pools owned by the manager
+    QVERIFY(taskMgr->threadPool() != QThreadPool::globalInstance());
+    QVERIFY(taskMgr->threadPool(1) != taskMgr->threadPool());
+    QCOMPARE(taskMgr->threadPool(1), taskMgr->threadPool(1));
+    taskMgr->threadPool(1)->setMaxThreadCount(2);
+
     std::vector<qttask::BaseRunner*> taskVec;
     for (int i = 0; i < 5; ++i) {
         taskVec.push_back(Internal::newTaskRunner<QThreadPool>(taskMgr, "QThreadPool"));
+        taskVec.push_back(Internal::newTaskRunner<QThreadPool>(taskMgr, "QThreadPool(1)", taskMgr->threadPool(1)));
         taskVec.push_back(Internal::newTaskRunner<QThread>(taskMgr, "QThread", QThread::HighestPriority));
         taskVec.push_back(Internal::newTaskRunner<qttask::StdAsync>(taskMgr, "std::async()"));
         taskVec.push_back(Internal::newTaskRunner<qttask::CurrentThread>(taskMgr, "CurrentThread"));
+        taskVec.push_back(Internal::newTaskRunner<qttask::WorkStealingPool>(taskMgr, "WorkStealingPool"));
+        taskVec.push_back(Internal::newTaskRunner<qttask::EventLoopThreadPool>(taskMgr, "EventLoopThreadPool"));
+        taskVec.push_back(Internal::newTaskRunner<qttask::PriorityThreadPool>(taskMgr, "PriorityThreadPool"));
     }
 
     std::size_t taskCount = taskVec.size();
@@ -192,4 +1195,312 @@ void TestQtTools::task_Manager_test()
         QCOMPARE(taskMgr->taskProgress(mapPair.first), static_cast<qttask::Progress*>(nullptr));
     }
 }
+namespace Internal {
+
+// Sum of [begin, end) split recursively in nested subtasks
+static long long parallelSum(qttask::WorkStealingPool* pool, int begin, int end)
+{
+    if (end - begin <= 64) {
+        long long sum = 0;
+        for (int i = begin; i < end; ++i)
+            sum += i;
+        return sum;
+    }
+    const int middle = begin + (end - begin) / 2;
+    long long sumLeft = 0;
+    qttask::WorkStealingPool::TaskGroup group(pool);
+    group.run([&] { sumLeft = parallelSum(pool, begin, middle); } );
+    const long long sumRight = parallelSum(pool, middle, end);
+    group.wait();
+    return sumLeft + sumRight;
+}
+
+} // namespace Internal
+
+void TestQtTools::task_TaskResult_test()
+{
+    qttask::Manager taskMgr;
+
+    // Value moved out of the worker thread
+    {
+        auto task = taskMgr.newTask<qttask::StdAsync>();
+        qttask::TaskResult<std::vector<int>> result =
+                qttask::runWithResult(task, [] { return std::vector<int>(1000, 5); } );
+        QVERIFY(result.isValid());
+        QVERIFY(result.waitFor(5000));
+        QVERIFY(!result.hasException());
+        const std::vector<int> vec = result.take();
+        QCOMPARE(vec.size(), static_cast<std::size_t>(1000));
+        QCOMPARE(vec.back(), 5);
+    }
+
+    // Exception rethrown by take()
+    {
+        auto task = taskMgr.newTask<qttask::CurrentThread>();
+        auto result = qttask::runWithResult(task, []() -> int {
+            throw std::runtime_error("task failure");
+        } );
+        QVERIFY(result.isReady());
+        QVERIFY(result.hasException());
+        bool isThrown = false;
+        try {
+            result.take();
+        } catch (const std::runtime_error&) {
+            isThrown = true;
+        }
+        QVERIFY(isThrown);
+    }
+
+    // Continuation called in the thread of the context object
+    {
+        QObject context;
+        int readyValue = 0;
+        QThread* readyThread = nullptr;
+        auto task = taskMgr.newTask<QThread>();
+        auto result = qttask::runWithResult(task, [] { return 42; } );
+        result.onReady(&context, [&](qttask::TaskResult<int> res) {
+            readyThread = QThread::currentThread();
+            readyValue = res.take();
+        } );
+        QTime chrono;
+        chrono.start();
+        while (readyValue == 0 && chrono.elapsed() < 5000)
+            QCoreApplication::processEvents();
+        QCOMPARE(readyValue, 42);
+        QCOMPARE(readyThread, QThread::currentThread());
+    }
+
+    // Streamed partial results, notifications coalesced
+    {
+        QObject context;
+        const int itemCount = 10000;
+        std::vector<int> vecItem;
+        int notifyCount = 0;
+        auto task = taskMgr.newTask<qttask::StdAsync>();
+        auto channel = qttask::runWithChannel<int>(
+                    task, [=](qttask::TaskChannel<int>& producer) {
+            for (int i = 0; i < itemCount; ++i)
+                producer.push(i);
+        } );
+        channel.onDataAvailable(&context, [&](qttask::TaskChannel<int> consumer) {
+            ++notifyCount;
+            for (int item : consumer.takeAll())
+                vecItem.push_back(item);
+        } );
+        QTime chrono;
+        chrono.start();
+        while (!channel.isFinished() && chrono.elapsed() < 5000)
+            QCoreApplication::processEvents();
+        QCoreApplication::processEvents(); // Destroy request of the runner
+        QVERIFY(channel.isFinished());
+        QVERIFY(!channel.hasException());
+        QCOMPARE(vecItem.size(), static_cast<std::size_t>(itemCount));
+        QVERIFY(std::is_sorted(vecItem.cbegin(), vecItem.cend()));
+        QVERIFY(notifyCount < itemCount);
+    }
+}
+
+void TestQtTools::task_WorkStealingPool_test()
+{
+    qttask::WorkStealingPool pool(4);
+    QCOMPARE(pool.threadCount(), 4u);
+    QCOMPARE(Internal::parallelSum(&pool, 0, 100000), 4999950000LL);
+
+    // Exception of a subtask is rethrown by TaskGroup::wait()
+    qttask::WorkStealingPool::TaskGroup group(&pool);
+    group.run([] { throw std::runtime_error("subtask error"); } );
+    bool hasThrown = false;
+    try {
+        group.wait();
+    } catch (const std::runtime_error&) {
+        hasThrown = true;
+    }
+    QVERIFY(hasThrown);
+}
+
+namespace Internal {
+
+enum TaskBackend
+{
+    QThreadBackend,
+    QThreadPoolBackend,
+    StdAsyncBackend,
+    CurrentThreadBackend,
+    WorkStealingPoolBackend,
+    EventLoopThreadPoolBackend,
+    PriorityThreadPoolBackend
+};
+
+static void addTaskBackendRows()
+{
+    QTest::addColumn<int>("backend");
+    QTest::newRow("QThread") << static_cast<int>(QThreadBackend);
+    QTest::newRow("QThreadPool") << static_cast<int>(QThreadPoolBackend);
+    QTest::newRow("StdAsync") << static_cast<int>(StdAsyncBackend);
+    QTest::newRow("CurrentThread") << static_cast<int>(CurrentThreadBackend);
+    QTest::newRow("WorkStealingPool") << static_cast<int>(WorkStealingPoolBackend);
+    QTest::newRow("EventLoopThreadPool") << static_cast<int>(EventLoopThreadPoolBackend);
+    QTest::newRow("PriorityThreadPool") << static_cast<int>(PriorityThreadPoolBackend);
+}
+
+static qttask::BaseRunner* newBackendTask(qttask::Manager* mgr, int backend)
+{
+    switch (backend) {
+    case QThreadBackend: return mgr->newTask<QThread>();
+    case QThreadPoolBackend: return mgr->newTask<QThreadPool>();
+    case StdAsyncBackend: return mgr->newTask<qttask::StdAsync>();
+    case CurrentThreadBackend: return mgr->newTask<qttask::CurrentThread>();
+    case WorkStealingPoolBackend: return mgr->newTask<qttask::WorkStealingPool>();
+    case EventLoopThreadPoolBackend: return mgr->newTask<qttask::EventLoopThreadPool>();
+    case PriorityThreadPoolBackend: return mgr->newTask<qttask::PriorityThreadPool>();
+    }
+    return nullptr;
+}
+
+// Runs taskCount tasks of function fn on backend and waits for all of them to
+// end (ie Manager::ended() received)
+template<typename FUNC>
+static bool runBackendTasksAndWait(
+        qttask::Manager* mgr, int backend, int taskCount, FUNC fn)
+{
+    int endedCount = 0;
+    const QMetaObject::Connection connection =
+            QObject::connect(mgr, &qttask::Manager::ended, [&] { ++endedCount; } );
+    for (int i = 0; i < taskCount; ++i) {
+        qttask::BaseRunner* task = Internal::newBackendTask(mgr, backend);
+        task->run( [=] { fn(task); } );
+    }
+
+    QElapsedTimer chrono;
+    chrono.start();
+    while (endedCount < taskCount && chrono.elapsed() < 60000)
+        QCoreApplication::processEvents();
+    QObject::disconnect(connection);
+    QCoreApplication::processEvents(); // Destroy requests of the runners
+    return endedCount == taskCount;
+}
+
+} // namespace Internal
+
+void TestQtTools::task_RunnerLatency_benchmark_data()
+{
+    Internal::addTaskBackendRows();
+}
+
+// Mean delay between BaseRunner::run() and the start of the task function
+void TestQtTools::task_RunnerLatency_benchmark()
+{
+    QFETCH(int, backend);
+    auto taskMgr = qttask::Manager::globalInstance();
+    const int launchCount = 100;
+    qint64 totalLatencyNSec = 0;
+    for (int i = 0; i < launchCount; ++i) {
+        std::atomic<qint64> latencyNSec(-1);
+        QElapsedTimer chrono;
+        chrono.start();
+        const bool isDone = Internal::runBackendTasksAndWait(
+                    taskMgr, backend, 1,
+                    [&] (qttask::BaseRunner*) { latencyNSec = chrono.nsecsElapsed(); } );
+        QVERIFY(isDone);
+        totalLatencyNSec += latencyNSec;
+    }
+    QTest::setBenchmarkResult(
+                static_cast<qreal>(totalLatencyNSec) / launchCount,
+                QTest::WalltimeNanoseconds);
+}
+
+void TestQtTools::task_RunnerThroughput_benchmark_data()
+{
+    Internal::addTaskBackendRows();
+}
+
+// Wall time to run 10k tiny tasks, from first run() to last Manager::ended()
+void TestQtTools::task_RunnerThroughput_benchmark()
+{
+    QFETCH(int, backend);
+    auto taskMgr = qttask::Manager::globalInstance();
+    const int taskCount = 10000;
+    std::atomic<int> workCount(0);
+    QBENCHMARK_ONCE {
+        const bool isDone = Internal::runBackendTasksAndWait(
+                    taskMgr, backend, taskCount,
+                    [&] (qttask::BaseRunner*) { ++workCount; } );
+        QVERIFY(isDone);
+    }
+    QCOMPARE(workCount.load(), taskCount);
+}
+
+void TestQtTools::task_RunnerProgress_benchmark_data()
+{
+    Internal::addTaskBackendRows();
+}
+
+// Wall time of one task reporting 100k progress values, including delivery of
+// the (throttled) progress signals to the main thread
+void TestQtTools::task_RunnerProgress_benchmark()
+{
+    QFETCH(int, backend);
+    auto taskMgr = qttask::Manager::globalInstance();
+    const int progressCount = 100000;
+    int progressSignalCount = 0;
+    const QMetaObject::Connection connection =
+            QObject::connect(taskMgr, &qttask::Manager::progress,
+                             [&] { ++progressSignalCount; } );
+    QBENCHMARK_ONCE {
+        const bool isDone = Internal::runBackendTasksAndWait(
+                    taskMgr, backend, 1,
+                    [=] (qttask::BaseRunner* task) {
+            for (int i = 0; i < progressCount; ++i)
+                task->progress().setValue((i * 100) / progressCount);
+        } );
+        QVERIFY(isDone);
+    }
+    QObject::disconnect(connection);
+    if (Internal::debugOutput)
+        qDebug() << "Progress signals received:" << progressSignalCount;
+}
+
 #endif // FOUGTOOLS_HAVE_QTTOOLS_TASK
+
+#ifdef FOUGTOOLS_HAVE_QTTOOLS_SQL
+
+void TestQtTools::sql_DatabaseManagerPool_test()
+{
+    if (!QSqlDatabase::isDriverAvailable(QLatin1String("QSQLITE")))
+        QSKIP("QSQLITE driver not available");
+
+    const QString refConnectionName = QLatin1String("utest-pool-ref");
+    auto fnPooledConnectionCount = [=] {
+        int count = 0;
+        for (const QString& name : QSqlDatabase::connectionNames()) {
+            if (name != refConnectionName)
+                ++count;
+        }
+        return count;
+    };
+
+    {
+        QSqlDatabase refDb =
+                QSqlDatabase::addDatabase(QLatin1String("QSQLITE"), refConnectionName);
+        refDb.setDatabaseName(QLatin1String(":memory:"));
+        qtsql::DatabaseManager dbMgr(refDb);
+        dbMgr.setIdleTimeout(-1); // Never expires
+
+        QSqlDatabase db1 = dbMgr.checkoutDatabase();
+        QSqlDatabase db2 = dbMgr.checkoutDatabase();
+        QVERIFY(db1.isOpen());
+        QVERIFY(db2.isOpen());
+        dbMgr.returnDatabase(db1);
+        dbMgr.returnDatabase(db2);
+        db1 = QSqlDatabase();
+        db2 = QSqlDatabase();
+        dbMgr.evictIdleDatabases();
+        QCOMPARE(fnPooledConnectionCount(), 2);
+    }
+
+    // Idle connections are closed and removed by the manager's destructor
+    QCOMPARE(fnPooledConnectionCount(), 0);
+    QSqlDatabase::removeDatabase(refConnectionName);
+}
+
+#endif // FOUGTOOLS_HAVE_QTTOOLS_SQL
@@ -10,16 +10,52 @@ private slots:
     // Core
     void core_QLocaleUtils_test();
     void core_QStringHFunc_test();
+    void core_QStringUtils_test();
+    void core_QVariantUtils_test();
+    void core_SignalCoalescer_test();
+    void core_WaitEvent_test();
     void core_QObjectWrap_test();
+    void core_AsyncLog_test();
+    void core_LogFilter_test();
+    void core_BinaryRingLogHandler_test();
+    void core_GridNumbering_test();
+    void core_ItemModelDataIndex_test();
 
     // Gui
     void gui_QStandardItemExplorer_test();
+    void gui_QStandardItemTreeSnapshot_test();
+    void gui_LazyTreeModel_test();
+    void gui_IndexedSelectionModel_test();
+    void gui_AbstractLengthEditor_test();
 
     // Script
     void script_Calculator_test();
 
 #ifdef FOUGTOOLS_HAVE_QTTOOLS_TASK
     // Task
+    void task_TaskRegistry_test();
+    void task_StdAsyncRunner_test();
+    void task_Dependency_test();
+    void task_ProgressThrottle_test();
+    void task_Progress_test();
+    void task_CancellationToken_test();
+    void task_ParallelAlgorithms_test();
+    void task_Timing_test();
+    void task_EventLoopThreadPool_test();
+    void task_PriorityThreadPool_test();
     void task_Manager_test();
+    void task_TaskResult_test();
+    void task_WorkStealingPool_test();
+    void task_RunnerLatency_benchmark_data();
+    void task_RunnerLatency_benchmark();
+    void task_RunnerThroughput_benchmark_data();
+    void task_RunnerThroughput_benchmark();
+    void task_RunnerProgress_benchmark_data();
+    void task_RunnerProgress_benchmark();
 #endif // FOUGTOOLS_HAVE_QTTOOLS_TASK
+
+#ifdef FOUGTOOLS_HAVE_QTTOOLS_SQL
+    // Sql
+    void sql_DatabaseManagerPool_test();
+#endif // FOUGTOOLS_HAVE_QTTOOLS_SQL
 };
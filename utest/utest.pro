@@ -6,24 +6,55 @@ TARGET = utest$$TARGET_SUFFIX
 
 CONFIG += console
 QT += testlib  gui  script
+isEqual(QT_MAJOR_VERSION, 5): QT += widgets
 
 HEADERS += \
     $$PWD/test_cpptools.h \
+    $$PWD/test_mathtools.h \
     $$PWD/test_qttools.h \
     \
     $$PWD/../src/cpptools/enum_string_map.h \
     \
+    $$PWD/../src/qttools/core/binary_ring_log_handler.h \
+    $$PWD/../src/qttools/core/grid_numbering.h \
+    $$PWD/../src/qttools/core/item_model_data_index.h \
+    $$PWD/../src/qttools/core/log.h \
     $$PWD/../src/qttools/core/qlocale_utils.h \
+    $$PWD/../src/qttools/core/qstring_utils.h \
+    $$PWD/../src/qttools/core/signal_coalescer.h \
+    $$PWD/../src/qttools/core/sleep.h \
+    $$PWD/../src/qttools/gui/abstract_length_editor.h \
+    $$PWD/../src/qttools/gui/abstract_quantity_editor.h \
+    $$PWD/../src/qttools/gui/indexed_selection_model.h \
+    $$PWD/../src/qttools/gui/lazy_tree_model.h \
+    $$PWD/../src/qttools/gui/length_formatter.h \
+    $$PWD/../src/qttools/gui/quantity_editor_manager.h \
     $$PWD/../src/qttools/gui/qstandard_item_explorer.h \
+    $$PWD/../src/qttools/gui/qstandard_item_tree_snapshot.h \
     $$PWD/../src/qttools/script/calculator.h
 
 SOURCES += \
     $$PWD/main.cpp \
     $$PWD/test_cpptools.cpp \
+    $$PWD/test_mathtools.cpp \
     $$PWD/test_qttools.cpp \
     \
+    $$PWD/../src/qttools/core/binary_ring_log_handler.cpp \
+    $$PWD/../src/qttools/core/grid_numbering.cpp \
+    $$PWD/../src/qttools/core/item_model_data_index.cpp \
+    $$PWD/../src/qttools/core/log.cpp \
     $$PWD/../src/qttools/core/qlocale_utils.cpp \
+    $$PWD/../src/qttools/core/qstring_utils.cpp \
+    $$PWD/../src/qttools/core/signal_coalescer.cpp \
+    $$PWD/../src/qttools/core/sleep.cpp \
+    $$PWD/../src/qttools/gui/abstract_length_editor.cpp \
+    $$PWD/../src/qttools/gui/abstract_quantity_editor.cpp \
+    $$PWD/../src/qttools/gui/indexed_selection_model.cpp \
+    $$PWD/../src/qttools/gui/lazy_tree_model.cpp \
+    $$PWD/../src/qttools/gui/length_formatter.cpp \
+    $$PWD/../src/qttools/gui/quantity_editor_manager.cpp \
     $$PWD/../src/qttools/gui/qstandard_item_explorer.cpp \
+    $$PWD/../src/qttools/gui/qstandard_item_tree_snapshot.cpp \
     $$PWD/../src/qttools/script/calculator.cpp
 
 occtools {
@@ -33,20 +64,51 @@ occtools {
 
     HEADERS += \
         $$PWD/test_occtools.h \
-        $$PWD/../src/occtools/io.h
+        $$PWD/../src/occtools/ais_scene_bounds.h \
+        $$PWD/../src/occtools/ais_text.h \
+        $$PWD/../src/occtools/brep_point_on_faces_projection.h \
+        $$PWD/../src/occtools/gcpnts_uniform_abscissa_sampler.h \
+        $$PWD/../src/occtools/geom_utils.h \
+        $$PWD/../src/occtools/io.h \
+        $$PWD/../src/occtools/math_utils.h \
+        $$PWD/../src/occtools/memory_report.h \
+        $$PWD/../src/occtools/mesh_deviation_analysis.h \
+        $$PWD/../src/occtools/point_on_faces_projector.h \
+        $$PWD/../src/occtools/poly_triangulation_normals.h \
+        $$PWD/../src/occtools/shape_properties_cache.h \
+        $$PWD/../src/occtools/topods_shape_maps.h \
+        $$PWD/../src/occtools/topods_utils.h
 
     SOURCES += \
         $$PWD/test_occtools.cpp \
-        $$PWD/../src/occtools/io.cpp
+        $$PWD/../src/occtools/ais_scene_bounds.cpp \
+        $$PWD/../src/occtools/ais_text.cpp \
+        $$PWD/../src/occtools/brep_point_on_faces_projection.cpp \
+        $$PWD/../src/occtools/gcpnts_uniform_abscissa_sampler.cpp \
+        $$PWD/../src/occtools/geom_utils.cpp \
+        $$PWD/../src/occtools/io.cpp \
+        $$PWD/../src/occtools/math_utils.cpp \
+        $$PWD/../src/occtools/memory_report.cpp \
+        $$PWD/../src/occtools/mesh_deviation_analysis.cpp \
+        $$PWD/../src/occtools/point_on_faces_projector.cpp \
+        $$PWD/../src/occtools/poly_triangulation_normals.cpp \
+        $$PWD/../src/occtools/shape_properties_cache.cpp \
+        $$PWD/../src/occtools/topods_shape_maps.cpp \
+        $$PWD/../src/occtools/topods_utils.cpp
 
     LIBS += \
         -lTKBRep -lTKernel -lTKG2d -lTKG3d -lTKGeomAlgo -lTKGeomBase \
-        -lTKIGES -lTKMath -lTKPrim -lTKService -lTKShHealing \
+        -lTKIGES -lTKMath -lTKMesh -lTKPrim -lTKService -lTKShHealing \
         -lTKSTEP -lTKSTEPAttr -lTKSTEPBase -lTKSTEP209 -lTKSTL -lTKTopAlgo \
-        -lTKXSBase
+        -lTKV3d -lTKXSBase
 } # occtools
 
 qttools_task {
     DEFINES += FOUGTOOLS_HAVE_QTTOOLS_TASK
     include(../src/qttools/task/qttools_task.pri)
 } # qttools_task
+
+qttools_sql {
+    DEFINES += FOUGTOOLS_HAVE_QTTOOLS_SQL
+    include(../src/qttools/sql/qttools_sql.pri)
+} # qttools_sql